@@ -31,8 +31,8 @@ macro(libgav1_set_build_definitions)
   # passed to libtool.
   #
   # We set LIBGAV1_SOVERSION = [c-a].a.r
-  set(LT_CURRENT 0)
-  set(LT_REVISION 1)
+  set(LT_CURRENT 1)
+  set(LT_REVISION 0)
   set(LT_AGE 0)
   math(EXPR LIBGAV1_SOVERSION_MAJOR "${LT_CURRENT} - ${LT_AGE}")
   set(LIBGAV1_SOVERSION "${LIBGAV1_SOVERSION_MAJOR}.${LT_AGE}.${LT_REVISION}")
@@ -161,6 +161,7 @@ macro(libgav1_set_build_definitions)
   # Source file names ending in these suffixes will have the appropriate
   # compiler flags added to their compile commands to enable intrinsics.
   set(libgav1_avx2_source_file_suffix "avx2(_test)?.cc")
+  set(libgav1_avx512_source_file_suffix "avx512(_test)?.cc")
   set(libgav1_neon_source_file_suffix "neon(_test)?.cc")
   set(libgav1_sse4_source_file_suffix "sse4(_test)?.cc")
 endmacro()
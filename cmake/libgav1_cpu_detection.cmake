@@ -24,6 +24,7 @@ macro(libgav1_optimization_detect)
     if(cpu_lowercase MATCHES "^arm|^aarch64")
       set(libgav1_have_neon ON)
     elseif(cpu_lowercase MATCHES "^x86|amd64")
+      set(libgav1_have_avx512 ON)
       set(libgav1_have_avx2 ON)
       set(libgav1_have_sse4 ON)
     endif()
@@ -36,6 +37,13 @@ macro(libgav1_optimization_detect)
     set(libgav1_have_avx2 OFF)
   endif()
 
+  if(libgav1_have_avx512 AND libgav1_have_avx2 AND LIBGAV1_ENABLE_AVX512)
+    list(APPEND libgav1_defines "LIBGAV1_ENABLE_AVX512=1")
+  else()
+    list(APPEND libgav1_defines "LIBGAV1_ENABLE_AVX512=0")
+    set(libgav1_have_avx512 OFF)
+  endif()
+
   if(libgav1_have_neon AND LIBGAV1_ENABLE_NEON)
     list(APPEND libgav1_defines "LIBGAV1_ENABLE_NEON=1")
   else()
@@ -46,6 +46,12 @@ struct Options {
   uint8_t post_filter_mask = 0x1f;
   int threads = 1;
   bool frame_parallel = false;
+  bool adaptive_threading = false;
+  bool share_threads = false;
+  int max_frame_width = 0;
+  int max_frame_height = 0;
+  bool use_huge_pages = false;
+  int memory_budget_mb = 0;
   bool output_all_layers = false;
   int operating_point = 0;
   int limit = 0;
@@ -72,6 +78,21 @@ void PrintHelp(FILE* const fout) {
   fprintf(fout, "  -h, --help This help message.\n");
   fprintf(fout, "  --threads <positive integer> (Default 1).\n");
   fprintf(fout, "  --frame_parallel.\n");
+  fprintf(fout,
+          "  --adaptive_threading Rebalance the frame parallel threads using"
+          " measured\n   stage costs.\n");
+  fprintf(fout,
+          "  --share_threads Share the non frame threads between the frames"
+          " decoded\n   in parallel.\n");
+  fprintf(fout,
+          "  --max_frame_size <width>x<height> Allocate the buffers for frames"
+          " of up to\n   this size before decoding.\n");
+  fprintf(fout,
+          "  --huge_pages Back the frame buffers with transparent huge pages"
+          " (Linux).\n");
+  fprintf(fout,
+          "  --memory_budget <integer> Limit the frames decoded in parallel so"
+          " that\n   their estimated memory fits in N MiB (0 = no limit).\n");
   fprintf(fout,
           "  --limit <integer> Stop decoding after N frames (0 = all).\n");
   fprintf(fout, "  --skip <integer> Skip initial N frames (Default 0).\n");
@@ -140,6 +161,28 @@ void ParseOptions(int argc, char* argv[], Options* const options) {
       options->threads = value;
     } else if (strcmp(argv[i], "--frame_parallel") == 0) {
       options->frame_parallel = true;
+    } else if (strcmp(argv[i], "--adaptive_threading") == 0) {
+      options->adaptive_threading = true;
+    } else if (strcmp(argv[i], "--share_threads") == 0) {
+      options->share_threads = true;
+    } else if (strcmp(argv[i], "--huge_pages") == 0) {
+      options->use_huge_pages = true;
+    } else if (strcmp(argv[i], "--memory_budget") == 0) {
+      if (++i >= argc || !absl::SimpleAtoi(argv[i], &value) || value < 0) {
+        fprintf(stderr, "Missing/Invalid value for --memory_budget.\n");
+        PrintHelp(stderr);
+        exit(EXIT_FAILURE);
+      }
+      options->memory_budget_mb = value;
+    } else if (strcmp(argv[i], "--max_frame_size") == 0) {
+      if (++i >= argc ||
+          sscanf(argv[i], "%dx%d", &options->max_frame_width,
+                 &options->max_frame_height) != 2 ||
+          options->max_frame_width <= 0 || options->max_frame_height <= 0) {
+        fprintf(stderr, "Missing/Invalid value for --max_frame_size.\n");
+        PrintHelp(stderr);
+        exit(EXIT_FAILURE);
+      }
     } else if (strcmp(argv[i], "--all_layers") == 0) {
       options->output_all_layers = true;
     } else if (strcmp(argv[i], "--operating_point") == 0) {
@@ -280,6 +323,12 @@ int main(int argc, char* argv[]) {
   settings.post_filter_mask = options.post_filter_mask;
   settings.threads = options.threads;
   settings.frame_parallel = options.frame_parallel;
+  settings.adaptive_threading = options.adaptive_threading;
+  settings.share_threads_between_frames = options.share_threads;
+  settings.max_frame_width = options.max_frame_width;
+  settings.max_frame_height = options.max_frame_height;
+  settings.use_huge_pages = options.use_huge_pages;
+  settings.memory_budget = static_cast<size_t>(options.memory_budget_mb) << 20;
   settings.output_all_layers = options.output_all_layers;
   settings.operating_point = options.operating_point;
   settings.blocking_dequeue = true;
@@ -449,6 +498,12 @@ int main(int argc, char* argv[]) {
         (decode_time_us == 0) ? 0.0 : 1.0e6 * decoded_frames / decode_time_us;
     fprintf(stderr, "time to decode input: %d us (%d frames, %.2f fps)\n",
             decode_time_us, decoded_frames, decode_fps);
+    size_t peak_memory_bytes;
+    if (decoder.GetMemoryUsage(nullptr, &peak_memory_bytes) ==
+        libgav1::kStatusOk) {
+      fprintf(stderr, "peak decoder memory: %zu KiB\n",
+              peak_memory_bytes >> 10);
+    }
   }
 
   return EXIT_SUCCESS;
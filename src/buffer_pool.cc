@@ -16,10 +16,13 @@
 
 #include <cassert>
 #include <cstring>
+#include <mutex>  // NOLINT (unapproved c++11 header)
+#include <new>
 
 #include "src/utils/common.h"
 #include "src/utils/constants.h"
 #include "src/utils/logging.h"
+#include "src/utils/memory.h"
 
 namespace libgav1 {
 
@@ -41,6 +44,39 @@ RefCountedBuffer::RefCountedBuffer() = default;
 
 RefCountedBuffer::~RefCountedBuffer() = default;
 
+void RefCountedBuffer::WaitSlow(Waiter* const waiter) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  num_waiters_.fetch_add(1);
+  // Check again after the increment of |num_waiters_| in case the state was
+  // updated by a thread that did not see it.
+  if (!IsSatisfied(*waiter)) {
+    waiter->next = waiters_;
+    waiters_ = waiter;
+    do {
+      waiter->condvar.wait(lock);
+      ++num_wakeups_;
+    } while (!waiter->woken);
+  }
+  num_waiters_.fetch_sub(1);
+}
+
+void RefCountedBuffer::WakeWaitersSlow() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Waiter** link = &waiters_;
+  while (*link != nullptr) {
+    Waiter* const waiter = *link;
+    if (!IsSatisfied(*waiter)) {
+      link = &waiter->next;
+      continue;
+    }
+    *link = waiter->next;
+    waiter->woken = true;
+    // Notify while holding |mutex_|: |waiter| is on the stack of the waiting
+    // thread and goes away as soon as that thread returns.
+    waiter->condvar.notify_one();
+  }
+}
+
 bool RefCountedBuffer::Realloc(int bitdepth, bool is_monochrome, int width,
                                int height, int subsampling_x, int subsampling_y,
                                int left_border, int right_border,
@@ -167,8 +203,14 @@ RefCountedBufferPtr BufferPool::GetFreeBuffer() {
   for (auto buffer : buffers_) {
     if (!buffer->in_use_) {
       buffer->in_use_ = true;
-      buffer->progress_row_ = -1;
-      buffer->frame_state_ = kFrameStateUnknown;
+      buffer->progress_row_.store(-1);
+      buffer->frame_state_.store(kFrameStateUnknown);
+      {
+        // No thread waits on a free buffer, so this only orders the reset with
+        // the reads of |num_wakeups_|.
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex_);
+        buffer->num_wakeups_ = 0;
+      }
       lock.unlock();
       return RefCountedBufferPtr(buffer, RefCountedBuffer::ReturnToBufferPool);
     }
@@ -181,8 +223,8 @@ RefCountedBufferPtr BufferPool::GetFreeBuffer() {
   }
   buffer->SetBufferPool(this);
   buffer->in_use_ = true;
-  buffer->progress_row_ = -1;
-  buffer->frame_state_ = kFrameStateUnknown;
+  buffer->progress_row_.store(-1);
+  buffer->frame_state_.store(kFrameStateUnknown);
   lock.lock();
   const bool ok = buffers_.push_back(buffer);
   lock.unlock();
@@ -196,6 +238,61 @@ RefCountedBufferPtr BufferPool::GetFreeBuffer() {
   return RefCountedBufferPtr(buffer, RefCountedBuffer::ReturnToBufferPool);
 }
 
+bool BufferPool::Preallocate(int num_buffers, int bitdepth,
+                             Libgav1ImageFormat image_format, int width,
+                             int height, int left_border, int right_border,
+                             int top_border, int bottom_border) {
+  if (callback_private_data_ == &internal_frame_buffers_) {
+    if (internal_frame_buffers_.Preallocate(
+            num_buffers, bitdepth, image_format, width, height, left_border,
+            right_border, top_border, bottom_border,
+            /*stride_alignment=*/16) != kStatusOk) {
+      LIBGAV1_DLOG(ERROR, "Failed to preallocate the internal frame buffers.");
+      return false;
+    }
+  } else if (!OnFrameBufferSizeChanged(bitdepth, image_format, width, height,
+                                       left_border, right_border, top_border,
+                                       bottom_border)) {
+    LIBGAV1_DLOG(ERROR, "Frame buffer size changed callback failed.");
+    return false;
+  }
+
+  // Same as the computation of MiRows and MiCols in the spec.
+  const int rows4x4 = ((height + 7) >> 3) << 1;
+  const int columns4x4 = ((width + 7) >> 3) << 1;
+  std::lock_guard<std::mutex> lock(mutex_);
+  int num_free_buffers = 0;
+  for (const auto* buffer : buffers_) {
+    if (!buffer->in_use_) ++num_free_buffers;
+  }
+  if (num_free_buffers < num_buffers &&
+      !buffers_.reserve(buffers_.size() + num_buffers - num_free_buffers)) {
+    return false;
+  }
+  for (; num_free_buffers < num_buffers; ++num_free_buffers) {
+    auto* const buffer = new (std::nothrow) RefCountedBuffer();
+    if (buffer == nullptr) {
+      LIBGAV1_DLOG(ERROR, "Failed to allocate a new reference counted buffer.");
+      return false;
+    }
+    buffer->SetBufferPool(this);
+    buffers_.push_back_unchecked(buffer);
+  }
+  for (auto* const buffer : buffers_) {
+    if (buffer->in_use_) continue;
+    ReferenceInfo& reference_info = buffer->reference_info_;
+    if (!reference_info.Reset(DivideBy2(rows4x4), DivideBy2(columns4x4)) ||
+        !buffer->segmentation_map_.Allocate(rows4x4, columns4x4)) {
+      return false;
+    }
+    PrefaultPages(reference_info.motion_field_mv.data(),
+                  reference_info.motion_field_mv.size() *
+                      sizeof(*reference_info.motion_field_mv.data()));
+    buffer->segmentation_map_.Clear();
+  }
+  return true;
+}
+
 void BufferPool::Abort() {
   std::unique_lock<std::mutex> lock(mutex_);
   for (auto buffer : buffers_) {
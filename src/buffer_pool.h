@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <climits>
 #include <condition_variable>  // NOLINT (unapproved c++11 header)
@@ -33,6 +34,7 @@
 #include "src/symbol_decoder_context.h"
 #include "src/utils/compiler_attributes.h"
 #include "src/utils/constants.h"
+#include "src/utils/memory_usage.h"
 #include "src/utils/reference_info.h"
 #include "src/utils/segmentation.h"
 #include "src/utils/segmentation_map.h"
@@ -188,43 +190,27 @@ class RefCountedBuffer : public MaxAlignedAllocable {
 
   // This will wake up the WaitUntil*() functions and make them return false.
   void Abort() {
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      abort_ = true;
-    }
-    parsed_condvar_.notify_all();
-    decoded_condvar_.notify_all();
-    progress_row_condvar_.notify_all();
+    abort_.store(true);
+    WakeWaiters();
   }
 
   void SetFrameState(FrameState frame_state) {
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      frame_state_ = frame_state;
-    }
-    if (frame_state == kFrameStateParsed) {
-      parsed_condvar_.notify_all();
-    } else if (frame_state == kFrameStateDecoded) {
-      decoded_condvar_.notify_all();
-      progress_row_condvar_.notify_all();
-    }
+    frame_state_.store(frame_state);
+    if (frame_state >= kFrameStateParsed) WakeWaiters();
   }
 
-  // Sets the progress of this frame to |progress_row| and notifies any threads
-  // that may be waiting on rows <= |progress_row|.
+  // Sets the progress of this frame to |progress_row| and wakes up the threads
+  // that are waiting on rows <= |progress_row|. Must only be called by the
+  // thread decoding the frame.
   void SetProgress(int progress_row) {
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      if (progress_row_ >= progress_row) return;
-      progress_row_ = progress_row;
-    }
-    progress_row_condvar_.notify_all();
+    if (progress_row_.load(std::memory_order_relaxed) >= progress_row) return;
+    progress_row_.store(progress_row);
+    WakeWaiters();
   }
 
   void MarkFrameAsStarted() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (frame_state_ != kFrameStateUnknown) return;
-    frame_state_ = kFrameStateStarted;
+    FrameState expected = kFrameStateUnknown;
+    frame_state_.compare_exchange_strong(expected, kFrameStateStarted);
   }
 
   // All the WaitUntil* functions will return true if the desired wait state was
@@ -234,11 +220,8 @@ class RefCountedBuffer : public MaxAlignedAllocable {
 
   // Waits until the frame has been parsed.
   bool WaitUntilParsed() {
-    std::unique_lock<std::mutex> lock(mutex_);
-    while (frame_state_ < kFrameStateParsed && !abort_) {
-      parsed_condvar_.wait(lock);
-    }
-    return !abort_;
+    Waiter waiter(kFrameStateParsed, INT_MAX);
+    return Wait(&waiter);
   }
 
   // Waits until the |progress_row| has been decoded (as indicated either by
@@ -253,27 +236,28 @@ class RefCountedBuffer : public MaxAlignedAllocable {
     // If |progress_row| is negative, it means that the wait is on the top
     // border to be available. The top border will be available when row 0 has
     // been decoded. So we can simply wait on row 0 instead.
-    progress_row = std::max(progress_row, 0);
-    std::unique_lock<std::mutex> lock(mutex_);
-    while (progress_row_ < progress_row && frame_state_ != kFrameStateDecoded &&
-           !abort_) {
-      progress_row_condvar_.wait(lock);
-    }
+    Waiter waiter(kFrameStateDecoded, std::max(progress_row, 0));
+    const bool ok = Wait(&waiter);
     // Once |frame_state_| reaches kFrameStateDecoded, |progress_row_| may no
     // longer be updated. So we set |*progress_row_cache| to INT_MAX in that
     // case.
-    *progress_row_cache =
-        (frame_state_ != kFrameStateDecoded) ? progress_row_ : INT_MAX;
-    return !abort_;
+    *progress_row_cache = (frame_state_.load() != kFrameStateDecoded)
+                              ? progress_row_.load()
+                              : INT_MAX;
+    return ok;
   }
 
   // Waits until the entire frame has been decoded.
   bool WaitUntilDecoded() {
-    std::unique_lock<std::mutex> lock(mutex_);
-    while (frame_state_ != kFrameStateDecoded && !abort_) {
-      decoded_condvar_.wait(lock);
-    }
-    return !abort_;
+    Waiter waiter(kFrameStateDecoded, INT_MAX);
+    return Wait(&waiter);
+  }
+
+  // Returns the number of times a thread blocked in one of the WaitUntil*()
+  // functions was woken up. Used for testing and benchmarking.
+  int64_t num_wakeups() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_wakeups_;
   }
 
  private:
@@ -291,17 +275,54 @@ class RefCountedBuffer : public MaxAlignedAllocable {
   YuvBuffer yuv_buffer_;
   bool in_use_ = false;  // Only used by BufferPool.
 
+  // A thread blocked in one of the WaitUntil*() functions. It is woken up when
+  // |frame_state_| reaches |frame_state|, when |progress_row_| reaches
+  // |progress_row|, or on abort. Waiters live on the stack of the waiting
+  // thread and are linked in |waiters_| while it is blocked.
+  struct Waiter {
+    Waiter(FrameState frame_state, int progress_row)
+        : frame_state(frame_state), progress_row(progress_row) {}
+
+    const FrameState frame_state;
+    const int progress_row;
+    std::condition_variable condvar;
+    bool woken = false;
+    Waiter* next = nullptr;
+  };
+
+  bool IsSatisfied(const Waiter& waiter) const {
+    return frame_state_.load() >= waiter.frame_state ||
+           progress_row_.load() >= waiter.progress_row || abort_.load();
+  }
+
+  // Blocks until |waiter| is satisfied. Returns false on abort.
+  bool Wait(Waiter* waiter) {
+    if (!IsSatisfied(*waiter)) WaitSlow(waiter);
+    return !abort_.load();
+  }
+  void WaitSlow(Waiter* waiter);
+
+  // Wakes up the satisfied waiters. Must be called after updating
+  // |frame_state_|, |progress_row_| or |abort_|.
+  void WakeWaiters() {
+    // The updates of the state and of |num_waiters_| are sequentially
+    // consistent, so either this thread sees the increment of |num_waiters_| by
+    // a thread about to block, or that thread sees the updated state and does
+    // not block.
+    if (num_waiters_.load() != 0) WakeWaitersSlow();
+  }
+  void WakeWaitersSlow();
+
+  // The frame state, progress and abort flag are atomic so that the satisfied
+  // waits and the progress updates without waiters do not take |mutex_|.
+  std::atomic<FrameState> frame_state_{kFrameStateUnknown};
+  std::atomic<int> progress_row_{-1};
+  std::atomic<bool> abort_{false};
+  // The number of threads that are blocked or about to block in WaitSlow().
+  std::atomic<int> num_waiters_{0};
   std::mutex mutex_;
-  FrameState frame_state_ = kFrameStateUnknown LIBGAV1_GUARDED_BY(mutex_);
-  int progress_row_ = -1 LIBGAV1_GUARDED_BY(mutex_);
-  // Signaled when progress_row_ is updated or when frame_state_ is set to
-  // kFrameStateDecoded.
-  std::condition_variable progress_row_condvar_;
-  // Signaled when the frame state is set to kFrameStateParsed.
-  std::condition_variable parsed_condvar_;
-  // Signaled when the frame state is set to kFrameStateDecoded.
-  std::condition_variable decoded_condvar_;
-  bool abort_ = false LIBGAV1_GUARDED_BY(mutex_);
+  Waiter* waiters_ LIBGAV1_GUARDED_BY(mutex_) = nullptr;
+  int64_t num_wakeups_ LIBGAV1_GUARDED_BY(mutex_) = 0;
 
   FrameType frame_type_ = kFrameKey;
   ChromaSamplePosition chroma_sample_position_ = kChromaSamplePositionUnknown;
@@ -369,9 +390,42 @@ class BufferPool {
   // is thread safe.
   RefCountedBufferPtr GetFreeBuffer();
 
+  // Makes sure that the pool has at least |num_buffers| free buffers, and
+  // allocates their per-frame state for frames of up to |width| by |height|
+  // pixels. With the internal frame buffers, it also allocates a frame buffer
+  // of the given parameters for each of them. Otherwise it calls the frame
+  // buffer size changed callback with the given parameters. Must not be called
+  // while another thread may call GetFreeBuffer(). Returns true on success.
+  LIBGAV1_MUST_USE_RESULT bool Preallocate(int num_buffers, int bitdepth,
+                                           Libgav1ImageFormat image_format,
+                                           int width, int height,
+                                           int left_border, int right_border,
+                                           int top_border, int bottom_border);
+
   // Aborts all the buffers that are in use.
   void Abort();
 
+  // Places the internal frame buffers allocated from now on according to
+  // |affinity| (see InternalFrameBufferList::set_cpu_affinity()). Has no effect
+  // on frame buffers allocated by the application callbacks.
+  void set_cpu_affinity(const CpuAffinity* affinity) {
+    internal_frame_buffers_.set_cpu_affinity(affinity);
+  }
+
+  // Backs the internal frame buffers allocated from now on with huge pages
+  // (see InternalFrameBufferList::set_use_huge_pages()). Has no effect on frame
+  // buffers allocated by the application callbacks.
+  void set_use_huge_pages(bool use_huge_pages) {
+    internal_frame_buffers_.set_use_huge_pages(use_huge_pages);
+  }
+
+  // Accounts the internal frame buffers in |memory_usage| (see
+  // InternalFrameBufferList::set_memory_usage()). Must be called before any
+  // frame buffer is allocated.
+  void set_memory_usage(MemoryUsage* memory_usage) {
+    internal_frame_buffers_.set_memory_usage(memory_usage);
+  }
+
  private:
   friend class RefCountedBuffer;
 
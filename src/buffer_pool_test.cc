@@ -14,13 +14,22 @@
 
 #include "src/buffer_pool.h"
 
+#include <algorithm>
 #include <climits>
+#include <condition_variable>  // NOLINT (unapproved c++11 header)
 #include <cstdint>
+#include <cstdio>
+#include <functional>
 #include <memory>
+#include <mutex>  // NOLINT (unapproved c++11 header)
 #include <ostream>
+#include <thread>  // NOLINT (unapproved c++11 header)
 #include <tuple>
 #include <utility>
+#include <vector>
 
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "gtest/gtest.h"
 #include "src/frame_buffer_utils.h"
 #include "src/gav1/decoder_buffer.h"
@@ -103,6 +112,177 @@ TEST(RefCountedBuffertTest, WaitUntil) {
   EXPECT_FALSE(buffer_ptr->WaitUntil(50, &progress_row_cache));
 }
 
+TEST(RefCountedBuffertTest, WaitUntilFromManyThreads) {
+  constexpr int kNumWaiters = 8;
+  constexpr int kRowsPerWaiter = 8;
+  InternalFrameBufferList buffer_list;
+  BufferPool buffer_pool(OnInternalFrameBufferSizeChanged,
+                         GetInternalFrameBuffer, ReleaseInternalFrameBuffer,
+                         &buffer_list);
+  RefCountedBufferPtr buffer_ptr = buffer_pool.GetFreeBuffer();
+  ASSERT_NE(buffer_ptr, nullptr);
+  RefCountedBuffer* const buffer = buffer_ptr.get();
+
+  std::vector<int> progress_row_caches(kNumWaiters, INT_MIN);
+  // Not a std::vector<bool> since the elements are written concurrently.
+  bool results[kNumWaiters + 1] = {};
+  std::vector<std::thread> waiters;
+  for (int i = 0; i < kNumWaiters; ++i) {
+    waiters.emplace_back([buffer, i, &progress_row_caches, &results]() {
+      results[i] = buffer->WaitUntil((i + 1) * kRowsPerWaiter,
+                                     &progress_row_caches[i]);
+    });
+  }
+  waiters.emplace_back([buffer, &results]() {
+    results[kNumWaiters] = buffer->WaitUntilParsed();
+  });
+  buffer->SetFrameState(kFrameStateParsed);
+  for (int row = 0; row < kNumWaiters * kRowsPerWaiter; ++row) {
+    buffer->SetProgress(row);
+  }
+  buffer->SetFrameState(kFrameStateDecoded);
+  for (auto& waiter : waiters) waiter.join();
+  for (int i = 0; i < kNumWaiters; ++i) {
+    SCOPED_TRACE(i);
+    EXPECT_TRUE(results[i]);
+    EXPECT_GE(progress_row_caches[i], (i + 1) * kRowsPerWaiter - 1);
+  }
+  EXPECT_TRUE(results[kNumWaiters]);
+}
+
+TEST(RefCountedBuffertTest, AbortWakesUpWaiters) {
+  InternalFrameBufferList buffer_list;
+  BufferPool buffer_pool(OnInternalFrameBufferSizeChanged,
+                         GetInternalFrameBuffer, ReleaseInternalFrameBuffer,
+                         &buffer_list);
+  RefCountedBufferPtr buffer_ptr = buffer_pool.GetFreeBuffer();
+  ASSERT_NE(buffer_ptr, nullptr);
+  RefCountedBuffer* const buffer = buffer_ptr.get();
+
+  bool parsed = true;
+  bool decoded = true;
+  std::thread parsed_waiter(
+      [buffer, &parsed]() { parsed = buffer->WaitUntilParsed(); });
+  std::thread decoded_waiter(
+      [buffer, &decoded]() { decoded = buffer->WaitUntilDecoded(); });
+  buffer->SetProgress(10);
+  buffer->Abort();
+  parsed_waiter.join();
+  decoded_waiter.join();
+  EXPECT_FALSE(parsed);
+  EXPECT_FALSE(decoded);
+}
+
+// The frame progress signaling used before the waiters were woken up
+// selectively: one condition variable notified on every update.
+class NotifyAllProgress {
+ public:
+  void SetProgress(int progress_row) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      progress_row_ = progress_row;
+    }
+    condvar_.notify_all();
+  }
+
+  void WaitUntil(int progress_row, int* progress_row_cache) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (progress_row_ < progress_row) {
+      condvar_.wait(lock);
+      ++num_wakeups_;
+    }
+    *progress_row_cache = progress_row_;
+  }
+
+  int64_t num_wakeups() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_wakeups_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable condvar_;
+  int progress_row_ = -1;
+  int64_t num_wakeups_ = 0;
+};
+
+// Simulates the frame parallel decoding of one frame, which takes |row_time|
+// to decode each of its |num_rows| superblock rows. |num_waiters| frames
+// reference it and decode their rows four times faster. Waiter i needs the
+// rows up to i * |num_rows| / |num_waiters| rows below its current row (large
+// motion vectors pointing down). Returns the time taken.
+absl::Duration RunFrame(int num_waiters, int num_rows, absl::Duration row_time,
+                        const std::function<void(int)>& set_progress,
+                        const std::function<void(int, int*)>& wait_until) {
+  const absl::Time start = absl::Now();
+  std::vector<std::thread> waiters;
+  for (int i = 0; i < num_waiters; ++i) {
+    const int lag = i * num_rows / num_waiters;
+    waiters.emplace_back([num_rows, lag, row_time, &wait_until]() {
+      int progress_row_cache = INT_MIN;
+      for (int row = 0; row < num_rows; ++row) {
+        const int needed_row = std::min(row + lag, num_rows - 1);
+        if (progress_row_cache < needed_row) {
+          wait_until(needed_row, &progress_row_cache);
+        }
+        absl::SleepFor(row_time / 4);
+      }
+    });
+  }
+  for (int row = 0; row < num_rows; ++row) {
+    absl::SleepFor(row_time);
+    set_progress(row);
+  }
+  for (auto& waiter : waiters) waiter.join();
+  return absl::Now() - start;
+}
+
+TEST(RefCountedBuffertTest, DISABLED_WakeupsPerFrame) {
+  constexpr int kNumFrames = 50;
+  constexpr int kNumWaiters = 8;
+  // The number of 64x64 superblock rows in a 1080p frame.
+  constexpr int kNumRows = 17;
+  const absl::Duration row_time = absl::Microseconds(400);
+  InternalFrameBufferList buffer_list;
+  BufferPool buffer_pool(OnInternalFrameBufferSizeChanged,
+                         GetInternalFrameBuffer, ReleaseInternalFrameBuffer,
+                         &buffer_list);
+
+  int64_t num_wakeups = 0;
+  absl::Duration elapsed_time;
+  for (int i = 0; i < kNumFrames; ++i) {
+    RefCountedBufferPtr buffer_ptr = buffer_pool.GetFreeBuffer();
+    ASSERT_NE(buffer_ptr, nullptr);
+    RefCountedBuffer* const buffer = buffer_ptr.get();
+    elapsed_time += RunFrame(
+        kNumWaiters, kNumRows, row_time,
+        [buffer](int row) { buffer->SetProgress(row); },
+        [buffer](int row, int* progress_row_cache) {
+          buffer->WaitUntil(row, progress_row_cache);
+        });
+    num_wakeups += buffer->num_wakeups();
+  }
+  printf("RefCountedBuffer: %5.1f wakeups/frame, %5d us\n",
+         static_cast<double>(num_wakeups) / kNumFrames,
+         static_cast<int>(absl::ToInt64Microseconds(elapsed_time)));
+
+  num_wakeups = 0;
+  elapsed_time = absl::ZeroDuration();
+  for (int i = 0; i < kNumFrames; ++i) {
+    NotifyAllProgress progress;
+    elapsed_time += RunFrame(
+        kNumWaiters, kNumRows, row_time,
+        [&progress](int row) { progress.SetProgress(row); },
+        [&progress](int row, int* progress_row_cache) {
+          progress.WaitUntil(row, progress_row_cache);
+        });
+    num_wakeups += progress.num_wakeups();
+  }
+  printf("notify_all:       %5.1f wakeups/frame, %5d us\n",
+         static_cast<double>(num_wakeups) / kNumFrames,
+         static_cast<int>(absl::ToInt64Microseconds(elapsed_time)));
+}
+
 constexpr struct Params {
   int width;
   int height;
@@ -19,6 +19,42 @@
 
 #include "src/decoder_impl.h"
 
+namespace {
+
+void ConvertSettings(const Libgav1DecoderSettings* const settings,
+                     libgav1::DecoderSettings* const cxx_settings) {
+  cxx_settings->threads = settings->threads;
+  cxx_settings->frame_parallel = settings->frame_parallel != 0;
+  cxx_settings->blocking_dequeue = settings->blocking_dequeue != 0;
+  cxx_settings->on_frame_buffer_size_changed =
+      settings->on_frame_buffer_size_changed;
+  cxx_settings->get_frame_buffer = settings->get_frame_buffer;
+  cxx_settings->release_frame_buffer = settings->release_frame_buffer;
+  cxx_settings->release_input_buffer = settings->release_input_buffer;
+  cxx_settings->callback_private_data = settings->callback_private_data;
+  cxx_settings->output_all_layers = settings->output_all_layers != 0;
+  cxx_settings->operating_point = settings->operating_point;
+  cxx_settings->post_filter_mask = settings->post_filter_mask;
+  cxx_settings->schedule_job = settings->schedule_job;
+  cxx_settings->executor_private_data = settings->executor_private_data;
+  cxx_settings->affinity_policy = settings->affinity_policy;
+  cxx_settings->affinity_cpus = settings->affinity_cpus;
+  cxx_settings->num_affinity_cpus = settings->num_affinity_cpus;
+  cxx_settings->numa_node = settings->numa_node;
+  cxx_settings->adaptive_threading = settings->adaptive_threading != 0;
+  cxx_settings->share_threads_between_frames =
+      settings->share_threads_between_frames != 0;
+  cxx_settings->max_frame_width = settings->max_frame_width;
+  cxx_settings->max_frame_height = settings->max_frame_height;
+  cxx_settings->max_bitdepth = settings->max_bitdepth;
+  cxx_settings->image_format = settings->image_format;
+  cxx_settings->max_tile_count = settings->max_tile_count;
+  cxx_settings->use_huge_pages = settings->use_huge_pages != 0;
+  cxx_settings->memory_budget = settings->memory_budget;
+}
+
+}  // namespace
+
 extern "C" {
 
 Libgav1StatusCode Libgav1DecoderCreate(const Libgav1DecoderSettings* settings,
@@ -28,18 +64,7 @@ Libgav1StatusCode Libgav1DecoderCreate(const Libgav1DecoderSettings* settings,
   if (cxx_decoder == nullptr) return kLibgav1StatusOutOfMemory;
 
   libgav1::DecoderSettings cxx_settings;
-  cxx_settings.threads = settings->threads;
-  cxx_settings.frame_parallel = settings->frame_parallel != 0;
-  cxx_settings.blocking_dequeue = settings->blocking_dequeue != 0;
-  cxx_settings.on_frame_buffer_size_changed =
-      settings->on_frame_buffer_size_changed;
-  cxx_settings.get_frame_buffer = settings->get_frame_buffer;
-  cxx_settings.release_frame_buffer = settings->release_frame_buffer;
-  cxx_settings.release_input_buffer = settings->release_input_buffer;
-  cxx_settings.callback_private_data = settings->callback_private_data;
-  cxx_settings.output_all_layers = settings->output_all_layers != 0;
-  cxx_settings.operating_point = settings->operating_point;
-  cxx_settings.post_filter_mask = settings->post_filter_mask;
+  ConvertSettings(settings, &cxx_settings);
 
   const Libgav1StatusCode status = cxx_decoder->Init(&cxx_settings);
   if (status == kLibgav1StatusOk) {
@@ -73,6 +98,22 @@ Libgav1StatusCode Libgav1DecoderSignalEOS(Libgav1Decoder* decoder) {
   return cxx_decoder->SignalEOS();
 }
 
+Libgav1StatusCode Libgav1DecoderGetMemoryUsage(const Libgav1Decoder* decoder,
+                                               size_t* current_bytes,
+                                               size_t* peak_bytes) {
+  const auto* cxx_decoder = reinterpret_cast<const libgav1::Decoder*>(decoder);
+  return cxx_decoder->GetMemoryUsage(current_bytes, peak_bytes);
+}
+
+Libgav1StatusCode Libgav1DecoderReset(Libgav1Decoder* decoder,
+                                      const Libgav1DecoderSettings* settings) {
+  auto* cxx_decoder = reinterpret_cast<libgav1::Decoder*>(decoder);
+  if (settings == nullptr) return cxx_decoder->Reset(nullptr);
+  libgav1::DecoderSettings cxx_settings;
+  ConvertSettings(settings, &cxx_settings);
+  return cxx_decoder->Reset(&cxx_settings);
+}
+
 int Libgav1DecoderGetMaxBitdepth() {
   return libgav1::Decoder::GetMaxBitdepth();
 }
@@ -113,6 +154,27 @@ StatusCode Decoder::SignalEOS() {
   return DecoderImpl::Create(&settings_, &impl_);
 }
 
+StatusCode Decoder::Reset(const DecoderSettings* const settings) {
+  if (impl_ == nullptr) return kStatusNotInitialized;
+  const DecoderSettings new_settings =
+      (settings != nullptr) ? *settings : settings_;
+  // |impl_| refers to |settings_|, so |settings_| can only be updated once
+  // |impl_| is idle (after DecoderImpl::Reset()) or gone.
+  if (impl_->Reset(new_settings)) {
+    settings_ = new_settings;
+    return kStatusOk;
+  }
+  impl_ = nullptr;
+  settings_ = new_settings;
+  return DecoderImpl::Create(&settings_, &impl_);
+}
+
+StatusCode Decoder::GetMemoryUsage(size_t* current_bytes,
+                                   size_t* peak_bytes) const {
+  if (impl_ == nullptr) return kStatusNotInitialized;
+  return impl_->GetMemoryUsage(current_bytes, peak_bytes);
+}
+
 // static.
 int Decoder::GetMaxBitdepth() { return DecoderImpl::GetMaxBitdepth(); }
 
@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <chrono>  // NOLINT (unapproved c++11 header)
 #include <iterator>
 #include <new>
 #include <utility>
@@ -47,6 +48,13 @@ namespace {
 constexpr int kMaxBlockWidth4x4 = 32;
 constexpr int kMaxBlockHeight4x4 = 32;
 
+using Clock = std::chrono::steady_clock;
+
+int64_t ToMicroseconds(Clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration)
+      .count();
+}
+
 // Computes the bottom border size in pixels. If CDEF, loop restoration or
 // SuperRes is enabled, adds extra border pixels to facilitate those steps to
 // happen nearly in-place (a few extra rows instead of an entire frame buffer).
@@ -218,8 +226,10 @@ StatusCode DecodeTilesFrameParallel(
     const SymbolDecoderContext& saved_symbol_decoder_context,
     const SegmentationMap* const prev_segment_ids,
     FrameScratchBuffer* const frame_scratch_buffer,
-    PostFilter* const post_filter, RefCountedBuffer* const current_frame) {
+    PostFilter* const post_filter, RefCountedBuffer* const current_frame,
+    FrameStageCosts* const stage_costs) {
   // Parse the frame.
+  const Clock::time_point parse_start = Clock::now();
   for (const auto& tile : tiles) {
     if (!tile->Parse()) {
       LIBGAV1_DLOG(ERROR, "Failed to parse tile number: %d\n", tile->number());
@@ -233,6 +243,9 @@ StatusCode DecodeTilesFrameParallel(
   SetSegmentationMap(frame_header, prev_segment_ids, current_frame);
   // Mark frame as parsed.
   current_frame->SetFrameState(kFrameStateParsed);
+  const Clock::duration parse_time = Clock::now() - parse_start;
+  Clock::duration reconstruction_time = Clock::duration::zero();
+  Clock::duration post_filter_time = Clock::duration::zero();
   std::unique_ptr<TileScratchBuffer> tile_scratch_buffer =
       frame_scratch_buffer->tile_scratch_buffer_pool.Get();
   if (tile_scratch_buffer == nullptr) {
@@ -243,6 +256,7 @@ StatusCode DecodeTilesFrameParallel(
   // block until the required superblocks in the reference frame are decoded).
   for (int row4x4 = 0; row4x4 < frame_header.rows4x4;
        row4x4 += block_width4x4) {
+    const Clock::time_point row_start = Clock::now();
     for (const auto& tile_ptr : tiles) {
       if (!tile_ptr->ProcessSuperBlockRow<kProcessingModeDecodeOnly, false>(
               row4x4, tile_scratch_buffer.get())) {
@@ -251,9 +265,12 @@ StatusCode DecodeTilesFrameParallel(
         return kStatusUnknownError;
       }
     }
+    const Clock::time_point post_filter_start = Clock::now();
+    reconstruction_time += post_filter_start - row_start;
     const int progress_row = post_filter->ApplyFilteringForOneSuperBlockRow(
         row4x4, block_width4x4, row4x4 + block_width4x4 >= frame_header.rows4x4,
         /*do_deblock=*/true);
+    post_filter_time += Clock::now() - post_filter_start;
     if (progress_row >= 0) {
       current_frame->SetProgress(progress_row);
     }
@@ -263,6 +280,11 @@ StatusCode DecodeTilesFrameParallel(
   current_frame->SetFrameState(kFrameStateDecoded);
   frame_scratch_buffer->tile_scratch_buffer_pool.Release(
       std::move(tile_scratch_buffer));
+  if (stage_costs != nullptr) {
+    stage_costs->parse = ToMicroseconds(parse_time);
+    stage_costs->reconstruction = ToMicroseconds(reconstruction_time);
+    stage_costs->post_filter = ToMicroseconds(post_filter_time);
+  }
   return kStatusOk;
 }
 
@@ -417,8 +439,10 @@ StatusCode DecodeTilesThreadedFrameParallel(
     const SymbolDecoderContext& saved_symbol_decoder_context,
     const SegmentationMap* const prev_segment_ids,
     FrameScratchBuffer* const frame_scratch_buffer,
-    PostFilter* const post_filter, RefCountedBuffer* const current_frame) {
+    PostFilter* const post_filter, RefCountedBuffer* const current_frame,
+    FrameStageCosts* const stage_costs) {
   // Parse the frame.
+  const Clock::time_point parse_start = Clock::now();
   ThreadPool& thread_pool =
       *frame_scratch_buffer->threading_strategy.thread_pool();
   std::atomic<int> tile_counter(0);
@@ -459,7 +483,10 @@ StatusCode DecodeTilesThreadedFrameParallel(
   }
 
   // Wait until all the parse workers are done. This ensures that all the tiles
-  // have been parsed.
+  // have been parsed. If the threads of |thread_pool| are shared with the
+  // other frames, they may all be busy or waiting for this frame, so the
+  // current thread runs the jobs that have not started yet.
+  thread_pool.RunJobsUntilIdle();
   if (!parse_workers.Wait() || failed) {
     return kLibgav1StatusUnknownError;
   }
@@ -471,6 +498,7 @@ StatusCode DecodeTilesThreadedFrameParallel(
   current_frame->SetFrameState(kFrameStateParsed);
 
   // Decode the frame.
+  const Clock::time_point decode_start = Clock::now();
   const int block_width4x4 = sequence_header.use_128x128_superblock ? 32 : 16;
   const int block_width4x4_log2 =
       sequence_header.use_128x128_superblock ? 5 : 4;
@@ -487,8 +515,11 @@ StatusCode DecodeTilesThreadedFrameParallel(
          superblock_rows * sizeof(superblock_row_progress[0]));
   frame_scratch_buffer->tile_decoding_failed = false;
   const int tile_columns = frame_header.tile_info.tile_columns;
+  // With a nested thread pool, the superblock row jobs let the current thread
+  // notice the progress of the rows when the jobs finish (see below).
   const bool decode_entire_tiles_in_worker_threads =
-      num_workers >= tile_columns;
+      num_workers >= tile_columns &&
+      thread_pool.type() != ThreadPool::kTypeNested;
   BlockingCounter pending_jobs(
       decode_entire_tiles_in_worker_threads ? num_workers : tile_columns);
   if (decode_entire_tiles_in_worker_threads) {
@@ -530,7 +561,10 @@ StatusCode DecodeTilesThreadedFrameParallel(
     }
   }
 
-  // Current thread will do the post filters.
+  // Current thread will do the post filters. The reconstruction is considered
+  // done when the last superblock row is available to it.
+  Clock::time_point reconstruction_end = decode_start;
+  Clock::duration post_filter_time = Clock::duration::zero();
   std::condition_variable* const superblock_row_progress_condvar =
       frame_scratch_buffer->superblock_row_progress_condvar.get();
   const std::unique_ptr<Tile>* tile_row_base = &tiles[0];
@@ -539,6 +573,15 @@ StatusCode DecodeTilesThreadedFrameParallel(
     if (!tile_row_base[0]->IsRow4x4Inside(row4x4)) {
       tile_row_base += tile_columns;
     }
+    // The row is complete when the job decoding its last part finishes, so the
+    // current thread can run the queued jobs until then.
+    thread_pool.RunJobsUntil([frame_scratch_buffer, superblock_row_progress,
+                              index, tile_columns]() {
+      std::lock_guard<std::mutex> lock(
+          frame_scratch_buffer->superblock_row_mutex);
+      return superblock_row_progress[index] == tile_columns ||
+             frame_scratch_buffer->tile_decoding_failed;
+    });
     {
       std::unique_lock<std::mutex> lock(
           frame_scratch_buffer->superblock_row_mutex);
@@ -548,6 +591,7 @@ StatusCode DecodeTilesThreadedFrameParallel(
       }
       if (frame_scratch_buffer->tile_decoding_failed) break;
     }
+    reconstruction_end = Clock::now();
     if (post_filter->DoDeblock()) {
       // Apply deblocking filter for the tile boundaries of this superblock row.
       // The deblocking filter for the internal blocks will be applied in the
@@ -561,12 +605,14 @@ StatusCode DecodeTilesThreadedFrameParallel(
     const int progress_row = post_filter->ApplyFilteringForOneSuperBlockRow(
         row4x4, block_width4x4, row4x4 + block_width4x4 >= frame_header.rows4x4,
         /*do_deblock=*/false);
+    post_filter_time += Clock::now() - reconstruction_end;
     if (progress_row >= 0) {
       current_frame->SetProgress(progress_row);
     }
   }
   // Wait until all the pending jobs are done. This ensures that all the tiles
   // have been decoded and wrapped up.
+  thread_pool.RunJobsUntilIdle();
   pending_jobs.Wait();
   {
     std::lock_guard<std::mutex> lock(
@@ -577,9 +623,117 @@ StatusCode DecodeTilesThreadedFrameParallel(
   }
 
   current_frame->SetFrameState(kFrameStateDecoded);
+  if (stage_costs != nullptr) {
+    stage_costs->parse = ToMicroseconds(decode_start - parse_start);
+    stage_costs->reconstruction =
+        ToMicroseconds(reconstruction_end - decode_start);
+    stage_costs->post_filter = ToMicroseconds(post_filter_time);
+  }
   return kStatusOk;
 }
 
+template <typename T>
+void PrefaultArray2D(Array2D<T>* const array) {
+  PrefaultPages(array->data(), array->size() * sizeof(T));
+}
+
+// Returns the size in bytes of a frame buffer for |width|x|height| frames of
+// the sequence of |sequence_header|, with the largest borders that the post
+// filters may need. Returns 0 if the dimensions are invalid.
+size_t GetFrameBufferSize(const ObuSequenceHeader& sequence_header,
+                          const int width, const int height) {
+  const ColorConfig& color_config = sequence_header.color_config;
+  FrameBufferInfo info;
+  if (ComputeFrameBufferInfo(
+          color_config.bitdepth,
+          ComposeImageFormat(color_config.is_monochrome,
+                             color_config.subsampling_x,
+                             color_config.subsampling_y),
+          width, height, kBorderPixels, kBorderPixels, kBorderPixels,
+          GetBottomBorderPixels(/*do_cdef=*/true, /*do_restoration=*/true,
+                                /*do_superres=*/true,
+                                color_config.subsampling_y),
+          /*stride_alignment=*/16, &info) != kStatusOk) {
+    return 0;
+  }
+  return info.y_buffer_size + 2 * info.uv_buffer_size;
+}
+
+// Returns an upper bound on the size in bytes of the members of a
+// FrameScratchBuffer that grow with the frame dimensions, for |width|x|height|
+// frames of the sequence of |sequence_header|. The row based post filter
+// buffers are small in comparison and are not included.
+size_t EstimateFrameScratchBufferSize(const ObuSequenceHeader& sequence_header,
+                                      const int width, const int height,
+                                      const bool frame_parallel) {
+  const size_t rows4x4 = ((height + 7) >> 3) << 1;
+  const size_t columns4x4 = ((width + 7) >> 3) << 1;
+  const size_t num_blocks =
+      (rows4x4 + kMaxBlockHeight4x4) * (columns4x4 + kMaxBlockWidth4x4);
+  // |block_parameters_holder| has a cache entry, a DeblockParameters entry
+  // and at most one BlockParameters object per 4x4 block, and
+  // |inter_transform_sizes| has one TransformSize per 4x4 block.
+  size_t size = num_blocks *
+                (2 * sizeof(BlockParameters*) + sizeof(BlockParameters) +
+                 sizeof(DeblockParameters) + sizeof(TransformSize));
+  // |motion_field| has one entry per 8x8 block.
+  size += DivideBy2(rows4x4) * DivideBy2(columns4x4) *
+          (sizeof(MotionVector) + sizeof(int8_t));
+  // In frame parallel mode, the whole frame is parsed before it is
+  // reconstructed, which takes one residual buffer per superblock.
+  if (frame_parallel) {
+    const ColorConfig& color_config = sequence_header.color_config;
+    const int superblock_size_log2 =
+        sequence_header.use_128x128_superblock ? 7 : 6;
+    const int superblock_size = 1 << superblock_size_log2;
+    const size_t num_superblocks =
+        static_cast<size_t>(RightShiftWithCeiling(width, superblock_size_log2)) *
+        RightShiftWithCeiling(height, superblock_size_log2);
+    size += num_superblocks *
+            GetResidualBufferSize(superblock_size, superblock_size,
+                                  color_config.subsampling_x,
+                                  color_config.subsampling_y,
+                                  color_config.bitdepth == 8 ? sizeof(int16_t)
+                                                             : sizeof(int32_t));
+  }
+  return size;
+}
+
+// Returns true if a decoder created with |settings| can be reused with
+// |new_settings|. Only the settings that are read as the frames are decoded may
+// differ; the others shape the thread pools and buffers made in Init() and on
+// the first frame.
+bool CanReuseDecoder(const DecoderSettings& settings,
+                     const DecoderSettings& new_settings) {
+  if (new_settings.frame_parallel &&
+      new_settings.release_input_buffer == nullptr) {
+    return false;
+  }
+  return settings.threads == new_settings.threads &&
+         settings.frame_parallel == new_settings.frame_parallel &&
+         settings.on_frame_buffer_size_changed ==
+             new_settings.on_frame_buffer_size_changed &&
+         settings.get_frame_buffer == new_settings.get_frame_buffer &&
+         settings.release_frame_buffer == new_settings.release_frame_buffer &&
+         settings.callback_private_data == new_settings.callback_private_data &&
+         settings.schedule_job == new_settings.schedule_job &&
+         settings.executor_private_data == new_settings.executor_private_data &&
+         settings.affinity_policy == new_settings.affinity_policy &&
+         settings.affinity_cpus == new_settings.affinity_cpus &&
+         settings.num_affinity_cpus == new_settings.num_affinity_cpus &&
+         settings.numa_node == new_settings.numa_node &&
+         settings.adaptive_threading == new_settings.adaptive_threading &&
+         settings.share_threads_between_frames ==
+             new_settings.share_threads_between_frames &&
+         settings.max_frame_width == new_settings.max_frame_width &&
+         settings.max_frame_height == new_settings.max_frame_height &&
+         settings.max_bitdepth == new_settings.max_bitdepth &&
+         settings.image_format == new_settings.image_format &&
+         settings.max_tile_count == new_settings.max_tile_count &&
+         settings.use_huge_pages == new_settings.use_huge_pages &&
+         settings.memory_budget == new_settings.memory_budget;
+}
+
 }  // namespace
 
 // static
@@ -614,6 +768,8 @@ DecoderImpl::DecoderImpl(const DecoderSettings* settings)
                    settings->callback_private_data),
       settings_(*settings) {
   dsp::DspInit();
+  external_scheduler_.schedule_job = settings_.schedule_job;
+  external_scheduler_.private_data = settings_.executor_private_data;
 }
 
 DecoderImpl::~DecoderImpl() {
@@ -634,12 +790,155 @@ StatusCode DecoderImpl::Init() {
     LIBGAV1_DLOG(ERROR, "output_frame_queue_.Init() failed.");
     return kStatusOutOfMemory;
   }
+  if (!cpu_affinity_.Init(
+          static_cast<CpuAffinity::Policy>(settings_.affinity_policy),
+          settings_.affinity_cpus, settings_.num_affinity_cpus,
+          settings_.numa_node)) {
+    LIBGAV1_DLOG(ERROR, "Invalid CPU affinity settings.");
+    return kStatusInvalidArgument;
+  }
+  buffer_pool_.set_cpu_affinity(GetCpuAffinity());
+  buffer_pool_.set_use_huge_pages(settings_.use_huge_pages);
+  buffer_pool_.set_memory_usage(&memory_usage_);
+  if (settings_.max_frame_width > 0 && settings_.max_frame_height > 0) {
+    return Preallocate();
+  }
+  return kStatusOk;
+}
+
+StatusCode DecoderImpl::Preallocate() {
+  const int bitdepth = settings_.max_bitdepth;
+  const auto image_format =
+      static_cast<Libgav1ImageFormat>(settings_.image_format);
+  if ((bitdepth != 8 && bitdepth != 10) || bitdepth > GetMaxBitdepth() ||
+      image_format < kLibgav1ImageFormatYuv420 ||
+      image_format > kLibgav1ImageFormatMonochrome400 ||
+      settings_.max_tile_count < 1 ||
+      settings_.max_tile_count > kMaxTileColumns * kMaxTileRows ||
+      settings_.max_frame_width > 65536 || settings_.max_frame_height > 65536) {
+    LIBGAV1_DLOG(ERROR, "Invalid stream limits.");
+    return kStatusInvalidArgument;
+  }
+  if (!MaybeInitializeWedgeMasks(kFrameInter)) {
+    LIBGAV1_DLOG(ERROR, "InitializeWedgeMasks() failed.");
+    return kStatusOutOfMemory;
+  }
+
+  // The sequence and frame headers of the largest frame that the limits allow,
+  // with all the coding tools that need scratch buffers enabled.
+  ObuSequenceHeader sequence_header = {};
+  sequence_header.color_config.bitdepth = bitdepth;
+  DecomposeImageFormat(image_format,
+                       &sequence_header.color_config.is_monochrome,
+                       &sequence_header.color_config.subsampling_x,
+                       &sequence_header.color_config.subsampling_y);
+  const int8_t subsampling_x = sequence_header.color_config.subsampling_x;
+  const int8_t subsampling_y = sequence_header.color_config.subsampling_y;
+  const bool film_grain = (settings_.post_filter_mask & 0x10) != 0;
+  sequence_header.film_grain_params_present = film_grain;
+  ObuFrameHeader frame_header = {};
+  frame_header.frame_type = kFrameInter;
+  frame_header.width = settings_.max_frame_width;
+  frame_header.upscaled_width = settings_.max_frame_width;
+  frame_header.height = settings_.max_frame_height;
+  frame_header.columns4x4 = ((frame_header.width + 7) >> 3) << 1;
+  frame_header.rows4x4 = ((frame_header.height + 7) >> 3) << 1;
+  frame_header.use_ref_frame_mvs = true;
+  frame_header.cdef.bits = 3;
+  frame_header.tile_info.tile_count = settings_.max_tile_count;
+  frame_header.tile_info.tile_rows = settings_.max_tile_count;
+  frame_header.tile_info.tile_columns = 1;
+  for (int plane = kPlaneY; plane < kMaxPlanes; ++plane) {
+    frame_header.loop_restoration.type[plane] = kLoopRestorationTypeSwitchable;
+    // The smallest restoration units, which give the most units.
+    frame_header.loop_restoration.unit_size_log2[plane] =
+        (plane == kPlaneY || subsampling_x == 0 || subsampling_y == 0) ? 6 : 5;
+  }
+
+  // In frame parallel mode, up to one frame per thread is decoded at a time,
+  // as long as they fit in the memory budget.
+  const bool frame_parallel = settings_.frame_parallel && settings_.threads > 1;
+  const int num_frames =
+      frame_parallel
+          ? GetMaxFramesInFlight(
+                sequence_header, frame_header.width, frame_header.height,
+                std::min(settings_.threads, static_cast<int>(kMaxThreads)))
+          : 1;
+  // The reference frames, the frame held by |output_frame_|, and the frames
+  // being decoded along with their film grain applied copies.
+  const int num_frame_buffers =
+      kNumReferenceFrameTypes + 1 + num_frames * (film_grain ? 2 : 1);
+  const int max_bottom_border =
+      GetBottomBorderPixels(/*do_cdef=*/true, /*do_restoration=*/true,
+                            /*do_superres=*/true, subsampling_y);
+  if (!buffer_pool_.Preallocate(num_frame_buffers, bitdepth, image_format,
+                                frame_header.width, frame_header.height,
+                                kBorderPixels, kBorderPixels, kBorderPixels,
+                                max_bottom_border)) {
+    LIBGAV1_DLOG(ERROR, "Failed to preallocate the frame buffers.");
+    return kStatusOutOfMemory;
+  }
+
+  std::unique_ptr<FrameScratchBuffer> frame_scratch_buffers[kMaxThreads];
+  StatusCode status = kStatusOk;
+  int i = 0;
+  for (; i < num_frames; ++i) {
+    frame_scratch_buffers[i] = frame_scratch_buffer_pool_.Get();
+    FrameScratchBuffer* const frame_scratch_buffer =
+        frame_scratch_buffers[i].get();
+    if (frame_scratch_buffer == nullptr) {
+      status = kStatusOutOfMemory;
+      break;
+    }
+    // In frame parallel mode, the threading strategies are set up when the
+    // first frame is enqueued (see InitializeThreadPoolsForFrameParallel()).
+    if (!frame_parallel) {
+      ThreadingStrategy& threading_strategy =
+          frame_scratch_buffer->threading_strategy;
+      threading_strategy.set_external_scheduler(GetExternalScheduler());
+      threading_strategy.set_cpu_affinity(GetCpuAffinity());
+      if (!threading_strategy.Reset(frame_header, settings_.threads)) {
+        status = kStatusOutOfMemory;
+        break;
+      }
+    }
+    status = AllocateFrameScratchBuffer(sequence_header, frame_header,
+                                        frame_parallel, frame_scratch_buffer);
+    if (status != kStatusOk) break;
+    if (!frame_scratch_buffer->block_parameters_holder.Preallocate() ||
+        !frame_scratch_buffer->tile_scratch_buffer_pool.Preallocate(
+            frame_parallel ? 1
+                           : std::min(settings_.threads,
+                                      static_cast<int>(kMaxThreads)))) {
+      status = kStatusOutOfMemory;
+      break;
+    }
+    PrefaultArray2D(&frame_scratch_buffer->inter_transform_sizes);
+    PrefaultArray2D(&frame_scratch_buffer->motion_field.mv);
+    PrefaultArray2D(&frame_scratch_buffer->motion_field.reference_offset);
+  }
+  while (--i >= 0) {
+    frame_scratch_buffer_pool_.Release(std::move(frame_scratch_buffers[i]));
+  }
+  if (status != kStatusOk) {
+    LIBGAV1_DLOG(ERROR, "Failed to preallocate the frame scratch buffers.");
+    return status;
+  }
+  if (!settings_.frame_parallel) {
+    // Nothing in the first temporal unit depends on the stream in non frame
+    // parallel mode, so the per stream initialization can be done now. In
+    // frame parallel mode it parses the first frame, even with one thread.
+    status = InitializeFrameThreadPoolAndTemporalUnitQueue(nullptr, 0);
+    if (status != kStatusOk) return status;
+    seen_first_frame_ = true;
+  }
   return kStatusOk;
 }
 
 StatusCode DecoderImpl::InitializeFrameThreadPoolAndTemporalUnitQueue(
     const uint8_t* data, size_t size) {
   is_frame_parallel_ = false;
+  int max_allowed_frames = 1;
   if (settings_.frame_parallel) {
     DecoderState state;
     std::unique_ptr<ObuParser> obu(new (std::nothrow) ObuParser(
@@ -661,13 +960,25 @@ StatusCode DecoderImpl::InitializeFrameThreadPoolAndTemporalUnitQueue(
     if (settings_.threads > 1 &&
         !InitializeThreadPoolsForFrameParallel(
             settings_.threads, obu->frame_header().tile_info.tile_count,
-            obu->frame_header().tile_info.tile_columns, &frame_thread_pool_,
-            &frame_scratch_buffer_pool_)) {
+            obu->frame_header().tile_info.tile_columns, GetExternalScheduler(),
+            GetCpuAffinity(),
+            UseAdaptiveThreading() ? &thread_allocator_ : nullptr,
+            settings_.share_threads_between_frames ? &shared_thread_pool_
+                                                   : nullptr,
+            &frame_thread_pool_, &frame_scratch_buffer_pool_)) {
       return kStatusOutOfMemory;
     }
+    // With adaptive threading, the frame thread pool is larger than the number
+    // of frames that are decoded in parallel (see EnqueueFrame()). The memory
+    // budget may allow even fewer frames; the remaining frame threads then
+    // stay idle.
+    if (frame_thread_pool_ != nullptr) {
+      const ObuSequenceHeader& sequence_header = obu->sequence_header();
+      max_allowed_frames = GetMaxFramesInFlight(
+          sequence_header, sequence_header.max_frame_width,
+          sequence_header.max_frame_height, frame_thread_pool_->num_threads());
+    }
   }
-  const int max_allowed_frames =
-      (frame_thread_pool_ != nullptr) ? frame_thread_pool_->num_threads() : 1;
   assert(max_allowed_frames > 0);
   if (!temporal_units_.Init(max_allowed_frames)) {
     LIBGAV1_DLOG(ERROR, "temporal_units_.Init() failed.");
@@ -677,6 +988,32 @@ StatusCode DecoderImpl::InitializeFrameThreadPoolAndTemporalUnitQueue(
   return kStatusOk;
 }
 
+int DecoderImpl::GetMaxFramesInFlight(const ObuSequenceHeader& sequence_header,
+                                      int width, int height,
+                                      int max_frames) const {
+  if (settings_.memory_budget == 0) return max_frames;
+  const size_t frame_buffer_size =
+      GetFrameBufferSize(sequence_header, width, height);
+  const bool film_grain = sequence_header.film_grain_params_present &&
+                          (settings_.post_filter_mask & 0x10) != 0;
+  const size_t fixed_size = (kNumReferenceFrameTypes + 1) * frame_buffer_size;
+  const size_t frame_size =
+      frame_buffer_size * (film_grain ? 2 : 1) +
+      EstimateFrameScratchBufferSize(sequence_header, width, height,
+                                     /*frame_parallel=*/true);
+  if (settings_.memory_budget < fixed_size + frame_size) {
+    LIBGAV1_DLOG(WARNING,
+                 "memory_budget (%zu) is less than the estimated memory needed "
+                 "to decode one %dx%d frame (%zu).",
+                 settings_.memory_budget, width, height,
+                 fixed_size + frame_size);
+    return 1;
+  }
+  const size_t num_frames = (settings_.memory_budget - fixed_size) / frame_size;
+  return static_cast<int>(
+      std::min(num_frames, static_cast<size_t>(max_frames)));
+}
+
 StatusCode DecoderImpl::EnqueueFrame(const uint8_t* data, size_t size,
                                      int64_t user_private_data,
                                      void* buffer_private_data) {
@@ -690,7 +1027,10 @@ StatusCode DecoderImpl::EnqueueFrame(const uint8_t* data, size_t size,
       return SignalFailure(status);
     }
   }
-  if (temporal_units_.Full()) {
+  if (temporal_units_.Full() ||
+      (is_frame_parallel_ && UseAdaptiveThreading() &&
+       temporal_units_.Size() >=
+           static_cast<size_t>(thread_allocator_.frame_threads()))) {
     return kStatusTryAgain;
   }
   if (is_frame_parallel_) {
@@ -707,12 +1047,10 @@ StatusCode DecoderImpl::SignalFailure(StatusCode status) {
   // Set the |failure_status_| first so that any pending jobs in
   // |frame_thread_pool_| will exit right away when the thread pool is being
   // released below.
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    failure_status_ = status;
-  }
+  failure_status_.store(status, std::memory_order_release);
   // Make sure all waiting threads exit.
   buffer_pool_.Abort();
+  NotifyAdaptiveThreadsFailure();
   frame_thread_pool_ = nullptr;
   while (!temporal_units_.Empty()) {
     if (settings_.release_input_buffer != nullptr) {
@@ -725,6 +1063,59 @@ StatusCode DecoderImpl::SignalFailure(StatusCode status) {
   return status;
 }
 
+bool DecoderImpl::Reset(const DecoderSettings& settings) {
+  if (HasFailure() || !CanReuseDecoder(settings_, settings)) return false;
+  if (is_frame_parallel_) {
+    // Wait until the frame threads are done with the temporal units.
+    waiting_for_reset_.store(true);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!temporal_units_.Empty()) {
+      TemporalUnit& temporal_unit = temporal_units_.Front();
+      while (!temporal_unit.decoded.load() &&
+             failure_status_.load() == kStatusOk) {
+        decoded_condvar_.wait(lock);
+      }
+      if (HasFailure()) break;
+      if (settings_.release_input_buffer != nullptr &&
+          !temporal_unit.released_input_buffer) {
+        settings_.release_input_buffer(settings_.callback_private_data,
+                                       temporal_unit.buffer_private_data);
+      }
+      temporal_units_.Pop();
+    }
+    lock.unlock();
+    waiting_for_reset_.store(false);
+    if (HasFailure()) return false;
+  } else {
+    // The input buffer of the temporal unit whose output frames are in
+    // |output_frame_queue_| has already been released.
+    if (!output_frame_queue_.Empty()) {
+      output_frame_queue_.Clear();
+      temporal_units_.Pop();
+    }
+    while (!temporal_units_.Empty()) {
+      if (settings_.release_input_buffer != nullptr) {
+        settings_.release_input_buffer(
+            settings_.callback_private_data,
+            temporal_units_.Front().buffer_private_data);
+      }
+      temporal_units_.Pop();
+    }
+  }
+  ReleaseOutputFrame();
+  state_ = {};
+  sequence_header_ = {};
+  has_sequence_header_ = false;
+  return true;
+}
+
+StatusCode DecoderImpl::GetMemoryUsage(size_t* const current_bytes,
+                                       size_t* const peak_bytes) const {
+  if (current_bytes != nullptr) *current_bytes = memory_usage_.current();
+  if (peak_bytes != nullptr) *peak_bytes = memory_usage_.peak();
+  return kStatusOk;
+}
+
 // DequeueFrame() follows the following policy to avoid holding unnecessary
 // frame buffer references in output_frame_: output_frame_ must be null when
 // DequeueFrame() returns false.
@@ -775,23 +1166,18 @@ StatusCode DecoderImpl::DequeueFrame(const DecoderBuffer** out_ptr) {
     }
     return status;
   }
-  {
+  if (!temporal_unit.decoded.load(std::memory_order_acquire) &&
+      !HasFailure()) {
+    if (!settings_.blocking_dequeue) return kStatusTryAgain;
     std::unique_lock<std::mutex> lock(mutex_);
-    if (settings_.blocking_dequeue) {
-      while (!temporal_unit.decoded && failure_status_ == kStatusOk) {
-        decoded_condvar_.wait(lock);
-      }
-    } else {
-      if (!temporal_unit.decoded && failure_status_ == kStatusOk) {
-        return kStatusTryAgain;
-      }
-    }
-    if (failure_status_ != kStatusOk) {
-      const StatusCode failure_status = failure_status_;
-      lock.unlock();
-      return SignalFailure(failure_status);
+    while (!temporal_unit.decoded.load(std::memory_order_acquire) &&
+           !HasFailure()) {
+      decoded_condvar_.wait(lock);
     }
   }
+  const StatusCode failure_status =
+      failure_status_.load(std::memory_order_acquire);
+  if (failure_status != kStatusOk) return SignalFailure(failure_status);
   if (settings_.release_input_buffer != nullptr &&
       !temporal_unit.released_input_buffer) {
     temporal_unit.released_input_buffer = true;
@@ -895,42 +1281,63 @@ StatusCode DecoderImpl::ParseAndSchedule(const uint8_t* data, size_t size,
   // |temporal_unit| into |temporal_units_| queue.
   temporal_units_.Push(std::move(temporal_unit));
   if (temporal_units_.Back().frames.empty()) {
-    std::lock_guard<std::mutex> lock(mutex_);
     temporal_units_.Back().has_displayable_frame = false;
-    temporal_units_.Back().decoded = true;
+    temporal_units_.Back().decoded.store(true, std::memory_order_release);
     return kStatusOk;
   }
   for (auto& frame : temporal_units_.Back().frames) {
     EncodedFrame* const encoded_frame = &frame;
     encoded_frame->temporal_unit = &temporal_units_.Back();
+    encoded_frame->decode_order = scheduled_frame_count_++;
     frame_thread_pool_->Schedule([this, encoded_frame]() {
       if (HasFailure()) return;
       const StatusCode status = DecodeFrame(encoded_frame);
       encoded_frame->state = {};
       encoded_frame->frame = nullptr;
       TemporalUnit& temporal_unit = *encoded_frame->temporal_unit;
-      std::lock_guard<std::mutex> lock(mutex_);
-      if (failure_status_ != kStatusOk) return;
+      if (HasFailure()) return;
       // temporal_unit's status defaults to kStatusOk. So we need to set it only
       // on error. If |failure_status_| is not kStatusOk at this point, it means
       // that there has already been a failure. So we don't care about this
       // subsequent failure.  We will simply return the error code of the first
-      // failure.
+      // failure. Only the thread that records the first failure writes
+      // |temporal_unit.status|, so frames of the same temporal unit that fail
+      // at the same time do not race on it.
+      bool failed = false;
       if (status != kStatusOk) {
-        temporal_unit.status = status;
-        if (failure_status_ == kStatusOk) {
-          failure_status_ = status;
+        StatusCode expected = kStatusOk;
+        if (failure_status_.compare_exchange_strong(
+                expected, status, std::memory_order_acq_rel)) {
+          temporal_unit.status = status;
+          NotifyAdaptiveThreadsFailure();
         }
+        failed = true;
       }
-      temporal_unit.decoded =
-          ++temporal_unit.decoded_count == temporal_unit.frames.size();
-      if (temporal_unit.decoded && settings_.output_all_layers &&
-          temporal_unit.output_layer_count > 1) {
-        std::sort(
-            temporal_unit.output_layers,
-            temporal_unit.output_layers + temporal_unit.output_layer_count);
+      // The acquire-release increments make the writes of all the frame threads
+      // of the temporal unit visible to the last one.
+      const bool decoded = temporal_unit.decoded_count.fetch_add(
+                               1, std::memory_order_acq_rel) ==
+                           temporal_unit.frames.size() - 1;
+      // Read before the temporal unit is marked as decoded, after which
+      // Reset() may return and the settings may change.
+      const bool blocking_dequeue = settings_.blocking_dequeue;
+      if (decoded) {
+        if (settings_.output_all_layers &&
+            temporal_unit.output_layer_count > 1) {
+          std::sort(
+              temporal_unit.output_layers,
+              temporal_unit.output_layers + temporal_unit.output_layer_count);
+        }
+        // Sequentially consistent so that either Reset() sees the temporal
+        // unit decoded or this thread sees |waiting_for_reset_|.
+        temporal_unit.decoded.store(true);
       }
-      if (temporal_unit.decoded || failure_status_ != kStatusOk) {
+      // Only a blocking DequeueFrame() and Reset() wait. Taking the mutex
+      // before notifying ensures that the wake-up is not lost between their
+      // check and their wait.
+      if ((decoded || failed) &&
+          (blocking_dequeue || waiting_for_reset_.load())) {
+        std::lock_guard<std::mutex> lock(mutex_);
         decoded_condvar_.notify_one();
       }
     });
@@ -938,11 +1345,39 @@ StatusCode DecoderImpl::ParseAndSchedule(const uint8_t* data, size_t size,
   return kStatusOk;
 }
 
+// Helper class that returns the threads acquired by
+// DecoderImpl::AcquireAdaptiveThreads() in the destructor.
+class DecoderImpl::AdaptiveThreadsReleaser {
+ public:
+  // Does nothing if |decoder| is nullptr.
+  AdaptiveThreadsReleaser(DecoderImpl* decoder, int threads_per_frame)
+      : decoder_(decoder), threads_per_frame_(threads_per_frame) {}
+  ~AdaptiveThreadsReleaser() {
+    if (decoder_ != nullptr) {
+      decoder_->ReleaseAdaptiveThreads(threads_per_frame_);
+    }
+  }
+
+ private:
+  DecoderImpl* const decoder_;
+  const int threads_per_frame_;
+};
+
 StatusCode DecoderImpl::DecodeFrame(EncodedFrame* const encoded_frame) {
   const ObuSequenceHeader& sequence_header = encoded_frame->sequence_header;
   const ObuFrameHeader& frame_header = encoded_frame->frame_header;
   RefCountedBufferPtr current_frame = std::move(encoded_frame->frame);
 
+  int threads_per_frame = 0;
+  if (UseAdaptiveThreading()) {
+    threads_per_frame = AcquireAdaptiveThreads(encoded_frame->decode_order);
+    if (threads_per_frame < 0) return kStatusUnknownError;
+  }
+  // Declared before |frame_scratch_buffer_releaser| so that the threads are
+  // returned after the thread pool of the frame scratch buffer is idle.
+  AdaptiveThreadsReleaser adaptive_threads_releaser(
+      UseAdaptiveThreading() ? this : nullptr, threads_per_frame);
+
   std::unique_ptr<FrameScratchBuffer> frame_scratch_buffer =
       frame_scratch_buffer_pool_.Get();
   if (frame_scratch_buffer == nullptr) {
@@ -954,6 +1389,20 @@ StatusCode DecoderImpl::DecodeFrame(EncodedFrame* const encoded_frame) {
   FrameScratchBufferReleaser frame_scratch_buffer_releaser(
       &frame_scratch_buffer_pool_, &frame_scratch_buffer);
 
+  if (UseAdaptiveThreading()) {
+    // Apply the split of the threads with which the frame was started. The
+    // thread pool of |frame_scratch_buffer| is idle here, so it can be
+    // recreated. This is also done for the frames that are shown again, since
+    // the film grain is applied with this thread pool.
+    ThreadingStrategy& threading_strategy =
+        frame_scratch_buffer->threading_strategy;
+    threading_strategy.set_external_scheduler(GetExternalScheduler());
+    threading_strategy.set_cpu_affinity(GetCpuAffinity());
+    if (!threading_strategy.Reset(threads_per_frame)) {
+      return kStatusOutOfMemory;
+    }
+  }
+
   StatusCode status;
   if (!frame_header.show_existing_frame) {
     if (encoded_frame->tile_buffers.empty()) {
@@ -963,12 +1412,31 @@ StatusCode DecoderImpl::DecodeFrame(EncodedFrame* const encoded_frame) {
       // not have a reason to handle those cases, so we simply continue.
       return kStatusOk;
     }
-    status = DecodeTiles(sequence_header, frame_header,
-                         encoded_frame->tile_buffers, encoded_frame->state,
-                         frame_scratch_buffer.get(), current_frame.get());
+    FrameStageCosts stage_costs;
+    if (shared_thread_pool_ != nullptr) {
+      // The frame scratch buffers created after the initialization of the
+      // frame parallel mode do not have a thread pool yet.
+      if (!frame_scratch_buffer->threading_strategy.Reset(
+              shared_thread_pool_.get())) {
+        return kStatusOutOfMemory;
+      }
+      // The threads of |shared_thread_pool_| run the jobs of the oldest frame
+      // first, since the frames are output in decode order.
+      frame_scratch_buffer->threading_strategy.thread_pool()->set_priority(
+          encoded_frame->decode_order);
+    }
+    status = DecodeTiles(
+        sequence_header, frame_header, encoded_frame->tile_buffers,
+        encoded_frame->state, frame_scratch_buffer.get(), current_frame.get(),
+        UseAdaptiveThreading() ? &stage_costs : nullptr);
     if (status != kStatusOk) {
       return status;
     }
+    if (UseAdaptiveThreading()) {
+      thread_allocator_.AddFrame(stage_costs,
+                                 frame_header.tile_info.tile_count,
+                                 threads_per_frame);
+    }
   } else {
     if (!current_frame->WaitUntilDecoded()) {
       return kStatusUnknownError;
@@ -1014,6 +1482,51 @@ StatusCode DecoderImpl::DecodeFrame(EncodedFrame* const encoded_frame) {
   return kStatusOk;
 }
 
+int DecoderImpl::AcquireAdaptiveThreads(int64_t decode_order) {
+  // The frames are scheduled in decode order on the shared queue of
+  // |frame_thread_pool_|, so the frame that may start next is never left in the
+  // queue behind frames waiting here.
+  std::unique_lock<std::mutex> lock(adaptive_threads_mutex_);
+  int threads_per_frame;
+  while (true) {
+    if (HasFailure()) return -1;
+    if (decode_order == next_adaptive_decode_order_) {
+      // The split may have changed while waiting, so it is read again.
+      threads_per_frame = thread_allocator_.threads_per_frame();
+      // A frame always starts when no other frame is being decoded.
+      if (adaptive_threads_in_use_ == 0 ||
+          adaptive_threads_in_use_ + 1 + threads_per_frame <=
+              settings_.threads) {
+        break;
+      }
+    }
+    adaptive_threads_condvar_.wait(lock);
+  }
+  adaptive_threads_in_use_ += 1 + threads_per_frame;
+  ++next_adaptive_decode_order_;
+  lock.unlock();
+  // The next frame may now be able to start.
+  adaptive_threads_condvar_.notify_all();
+  return threads_per_frame;
+}
+
+void DecoderImpl::ReleaseAdaptiveThreads(int threads_per_frame) {
+  {
+    std::lock_guard<std::mutex> lock(adaptive_threads_mutex_);
+    adaptive_threads_in_use_ -= 1 + threads_per_frame;
+    assert(adaptive_threads_in_use_ >= 0);
+  }
+  adaptive_threads_condvar_.notify_all();
+}
+
+void DecoderImpl::NotifyAdaptiveThreadsFailure() {
+  if (!UseAdaptiveThreading()) return;
+  // Taking the mutex ensures that the wake-up is not lost between the check
+  // of the failure status and the wait in AcquireAdaptiveThreads().
+  { std::lock_guard<std::mutex> lock(adaptive_threads_mutex_); }
+  adaptive_threads_condvar_.notify_all();
+}
+
 StatusCode DecoderImpl::DecodeTemporalUnit(const TemporalUnit& temporal_unit,
                                            const DecoderBuffer** out_ptr) {
   std::unique_ptr<ObuParser> obu(new (std::nothrow) ObuParser(
@@ -1080,7 +1593,8 @@ StatusCode DecoderImpl::DecodeTemporalUnit(const TemporalUnit& temporal_unit,
       }
       status = DecodeTiles(obu->sequence_header(), obu->frame_header(),
                            obu->tile_buffers(), state_,
-                           frame_scratch_buffer.get(), current_frame.get());
+                           frame_scratch_buffer.get(), current_frame.get(),
+                           /*stage_costs=*/nullptr);
       if (status != kStatusOk) {
         return status;
       }
@@ -1182,11 +1696,10 @@ void DecoderImpl::ReleaseOutputFrame() {
   output_frame_ = nullptr;
 }
 
-StatusCode DecoderImpl::DecodeTiles(
+StatusCode DecoderImpl::AllocateFrameScratchBuffer(
     const ObuSequenceHeader& sequence_header,
-    const ObuFrameHeader& frame_header, const Vector<TileBuffer>& tile_buffers,
-    const DecoderState& state, FrameScratchBuffer* const frame_scratch_buffer,
-    RefCountedBuffer* const current_frame) {
+    const ObuFrameHeader& frame_header, bool frame_parallel,
+    FrameScratchBuffer* const frame_scratch_buffer) {
   frame_scratch_buffer->tile_scratch_buffer_pool.Reset(
       sequence_header.color_config.bitdepth);
   if (!frame_scratch_buffer->loop_restoration_info.Reset(
@@ -1198,12 +1711,8 @@ StatusCode DecoderImpl::DecodeTiles(
                  "Failed to allocate memory for loop restoration info units.");
     return kStatusOutOfMemory;
   }
-  ThreadingStrategy& threading_strategy =
+  const ThreadingStrategy& threading_strategy =
       frame_scratch_buffer->threading_strategy;
-  if (!is_frame_parallel_ &&
-      !threading_strategy.Reset(frame_header, settings_.threads)) {
-    return kStatusOutOfMemory;
-  }
   const bool do_cdef =
       PostFilter::DoCdef(frame_header, settings_.post_filter_mask);
   const int num_planes = sequence_header.color_config.is_monochrome
@@ -1213,25 +1722,6 @@ StatusCode DecoderImpl::DecodeTiles(
       frame_header.loop_restoration, settings_.post_filter_mask, num_planes);
   const bool do_superres =
       PostFilter::DoSuperRes(frame_header, settings_.post_filter_mask);
-  // Use kBorderPixels for the left, right, and top borders. Only the bottom
-  // border may need to be bigger. Cdef border is needed only if we apply Cdef
-  // without multithreading.
-  const int bottom_border = GetBottomBorderPixels(
-      do_cdef && threading_strategy.post_filter_thread_pool() == nullptr,
-      do_restoration, do_superres, sequence_header.color_config.subsampling_y);
-  current_frame->set_chroma_sample_position(
-      sequence_header.color_config.chroma_sample_position);
-  if (!current_frame->Realloc(sequence_header.color_config.bitdepth,
-                              sequence_header.color_config.is_monochrome,
-                              frame_header.upscaled_width, frame_header.height,
-                              sequence_header.color_config.subsampling_x,
-                              sequence_header.color_config.subsampling_y,
-                              /*left_border=*/kBorderPixels,
-                              /*right_border=*/kBorderPixels,
-                              /*top_border=*/kBorderPixels, bottom_border)) {
-    LIBGAV1_DLOG(ERROR, "Failed to allocate memory for the decoder buffer.");
-    return kStatusOutOfMemory;
-  }
   if (frame_header.cdef.bits > 0) {
     if (!frame_scratch_buffer->cdef_index.Reset(
             DivideBy16(frame_header.rows4x4 + kMaxBlockHeight4x4),
@@ -1268,21 +1758,6 @@ StatusCode DecoderImpl::DecodeTiles(
                    "Failed to allocate memory for temporal motion vectors.");
       return kStatusOutOfMemory;
     }
-
-    // For each motion vector, only mv[0] needs to be initialized to
-    // kInvalidMvValue, mv[1] is not necessary to be initialized and can be
-    // set to an arbitrary value. For simplicity, mv[1] is set to 0.
-    // The following memory initialization of contiguous memory is very fast. It
-    // is not recommended to make the initialization multi-threaded, unless the
-    // memory which needs to be initialized in each thread is still contiguous.
-    MotionVector invalid_mv;
-    invalid_mv.mv[0] = kInvalidMvValue;
-    invalid_mv.mv[1] = 0;
-    MotionVector* const motion_field_mv =
-        &frame_scratch_buffer->motion_field.mv[0][0];
-    std::fill(motion_field_mv,
-              motion_field_mv + frame_scratch_buffer->motion_field.mv.size(),
-              invalid_mv);
   }
 
   // The addition of kMaxBlockHeight4x4 and kMaxBlockWidth4x4 is necessary so
@@ -1293,23 +1768,8 @@ StatusCode DecoderImpl::DecodeTiles(
           frame_header.columns4x4 + kMaxBlockWidth4x4)) {
     return kStatusOutOfMemory;
   }
-  const dsp::Dsp* const dsp =
-      dsp::GetDspTable(sequence_header.color_config.bitdepth);
-  if (dsp == nullptr) {
-    LIBGAV1_DLOG(ERROR, "Failed to get the dsp table for bitdepth %d.",
-                 sequence_header.color_config.bitdepth);
-    return kStatusInternalError;
-  }
-
-  const int tile_count = frame_header.tile_info.tile_count;
-  assert(tile_count >= 1);
-  Vector<std::unique_ptr<Tile>> tiles;
-  if (!tiles.reserve(tile_count)) {
-    LIBGAV1_DLOG(ERROR, "tiles.reserve(%d) failed.\n", tile_count);
-    return kStatusOutOfMemory;
-  }
 
-  if (threading_strategy.row_thread_pool(0) != nullptr || is_frame_parallel_) {
+  if (threading_strategy.row_thread_pool(0) != nullptr || frame_parallel) {
     if (frame_scratch_buffer->residual_buffer_pool == nullptr) {
       frame_scratch_buffer->residual_buffer_pool.reset(
           new (std::nothrow) ResidualBufferPool(
@@ -1408,19 +1868,27 @@ StatusCode DecoderImpl::DecodeTiles(
 #endif
   }
 
+  if (threading_strategy.post_filter_thread_pool() != nullptr) {
+    const int num_unit_rows = RightShiftWithCeiling(frame_header.rows4x4, 4);
+    if (!frame_scratch_buffer->post_filter_row_states.Resize(num_unit_rows) ||
+        !frame_scratch_buffer->post_filter_ready_rows.Resize(num_unit_rows)) {
+      LIBGAV1_DLOG(ERROR, "Failed to resize post filter row states.\n");
+      return kStatusOutOfMemory;
+    }
+  }
+
   if (do_superres && threading_strategy.post_filter_thread_pool() != nullptr) {
-    const int num_threads =
-        threading_strategy.post_filter_thread_pool()->num_threads() + 1;
+    const int num_unit_rows = RightShiftWithCeiling(frame_header.rows4x4, 4);
     // subsampling_y is set to zero irrespective of the actual frame's
-    // subsampling since we need to store exactly |num_threads| rows of the
-    // down-scaled pixels.
+    // subsampling since we need to store exactly |num_unit_rows| rows of the
+    // down-scaled pixels (the last input row of each 64x64 unit row).
     // Left and right borders are for line extension. They are doubled for the Y
     // plane to make sure the U and V planes have enough space after possible
     // subsampling.
     if (!frame_scratch_buffer->superres_line_buffer.Realloc(
             sequence_header.color_config.bitdepth,
             sequence_header.color_config.is_monochrome,
-            MultiplyBy4(frame_header.columns4x4), num_threads,
+            MultiplyBy4(frame_header.columns4x4), num_unit_rows,
             sequence_header.color_config.subsampling_x,
             /*subsampling_y=*/0, 2 * kSuperResHorizontalBorder,
             2 * (kSuperResHorizontalBorder + kSuperResHorizontalPadding), 0, 0,
@@ -1430,45 +1898,15 @@ StatusCode DecoderImpl::DecodeTiles(
     }
   }
 
-  if (is_frame_parallel_ && !IsIntraFrame(frame_header.frame_type)) {
-    // We can parse the current frame if all the reference frames have been
-    // parsed.
-    for (const int index : frame_header.reference_frame_index) {
-      if (!state.reference_frame[index]->WaitUntilParsed()) {
-        return kStatusUnknownError;
-      }
-    }
-  }
-
-  // If prev_segment_ids is a null pointer, it is treated as if it pointed to
-  // a segmentation map containing all 0s.
-  const SegmentationMap* prev_segment_ids = nullptr;
-  if (frame_header.primary_reference_frame == kPrimaryReferenceNone) {
-    frame_scratch_buffer->symbol_decoder_context.Initialize(
-        frame_header.quantizer.base_index);
-  } else {
-    const int index =
-        frame_header
-            .reference_frame_index[frame_header.primary_reference_frame];
-    assert(index != -1);
-    const RefCountedBuffer* prev_frame = state.reference_frame[index].get();
-    frame_scratch_buffer->symbol_decoder_context = prev_frame->FrameContext();
-    if (frame_header.segmentation.enabled &&
-        prev_frame->columns4x4() == frame_header.columns4x4 &&
-        prev_frame->rows4x4() == frame_header.rows4x4) {
-      prev_segment_ids = prev_frame->segmentation_map();
-    }
-  }
-
   // The Tile class must make use of a separate buffer to store the unfiltered
   // pixels for the intra prediction of the next superblock row. This is done
   // only when one of the following conditions are true:
-  //   * is_frame_parallel_ is true.
+  //   * the frame is decoded in frame parallel mode.
   //   * settings_.threads == 1.
   // In the non-frame-parallel multi-threaded case, we do not run the post
   // filters in the decode loop. So this buffer need not be used.
   const bool use_intra_prediction_buffer =
-      is_frame_parallel_ || settings_.threads == 1;
+      frame_parallel || settings_.threads == 1;
   if (use_intra_prediction_buffer) {
     if (!frame_scratch_buffer->intra_prediction_buffers.Resize(
             frame_header.tile_info.tile_rows)) {
@@ -1498,6 +1936,127 @@ StatusCode DecoderImpl::DecodeTiles(
     }
   }
 
+  const size_t estimated_size = EstimateFrameScratchBufferSize(
+      sequence_header, frame_header.upscaled_width, frame_header.height,
+      frame_parallel);
+  if (estimated_size > frame_scratch_buffer->accounted_size) {
+    memory_usage_.Add(estimated_size - frame_scratch_buffer->accounted_size);
+    frame_scratch_buffer->accounted_size = estimated_size;
+  }
+  return kStatusOk;
+}
+
+StatusCode DecoderImpl::DecodeTiles(
+    const ObuSequenceHeader& sequence_header,
+    const ObuFrameHeader& frame_header, const Vector<TileBuffer>& tile_buffers,
+    const DecoderState& state, FrameScratchBuffer* const frame_scratch_buffer,
+    RefCountedBuffer* const current_frame, FrameStageCosts* const stage_costs) {
+  ThreadingStrategy& threading_strategy =
+      frame_scratch_buffer->threading_strategy;
+  if (!is_frame_parallel_) {
+    threading_strategy.set_external_scheduler(GetExternalScheduler());
+    threading_strategy.set_cpu_affinity(GetCpuAffinity());
+    if (!threading_strategy.Reset(frame_header, settings_.threads)) {
+      return kStatusOutOfMemory;
+    }
+  }
+  StatusCode status = AllocateFrameScratchBuffer(
+      sequence_header, frame_header, is_frame_parallel_, frame_scratch_buffer);
+  if (status != kStatusOk) return status;
+  const bool do_cdef =
+      PostFilter::DoCdef(frame_header, settings_.post_filter_mask);
+  const int num_planes = sequence_header.color_config.is_monochrome
+                             ? kMaxPlanesMonochrome
+                             : kMaxPlanes;
+  const bool do_restoration = PostFilter::DoRestoration(
+      frame_header.loop_restoration, settings_.post_filter_mask, num_planes);
+  const bool do_superres =
+      PostFilter::DoSuperRes(frame_header, settings_.post_filter_mask);
+  // Use kBorderPixels for the left, right, and top borders. Only the bottom
+  // border may need to be bigger. Cdef border is needed only if we apply Cdef
+  // without multithreading.
+  const int bottom_border = GetBottomBorderPixels(
+      do_cdef && threading_strategy.post_filter_thread_pool() == nullptr,
+      do_restoration, do_superres, sequence_header.color_config.subsampling_y);
+  current_frame->set_chroma_sample_position(
+      sequence_header.color_config.chroma_sample_position);
+  if (!current_frame->Realloc(sequence_header.color_config.bitdepth,
+                              sequence_header.color_config.is_monochrome,
+                              frame_header.upscaled_width, frame_header.height,
+                              sequence_header.color_config.subsampling_x,
+                              sequence_header.color_config.subsampling_y,
+                              /*left_border=*/kBorderPixels,
+                              /*right_border=*/kBorderPixels,
+                              /*top_border=*/kBorderPixels, bottom_border)) {
+    LIBGAV1_DLOG(ERROR, "Failed to allocate memory for the decoder buffer.");
+    return kStatusOutOfMemory;
+  }
+  if (frame_header.use_ref_frame_mvs) {
+    // For each motion vector, only mv[0] needs to be initialized to
+    // kInvalidMvValue, mv[1] is not necessary to be initialized and can be
+    // set to an arbitrary value. For simplicity, mv[1] is set to 0.
+    // The following memory initialization of contiguous memory is very fast. It
+    // is not recommended to make the initialization multi-threaded, unless the
+    // memory which needs to be initialized in each thread is still contiguous.
+    MotionVector invalid_mv;
+    invalid_mv.mv[0] = kInvalidMvValue;
+    invalid_mv.mv[1] = 0;
+    MotionVector* const motion_field_mv =
+        &frame_scratch_buffer->motion_field.mv[0][0];
+    std::fill(motion_field_mv,
+              motion_field_mv + frame_scratch_buffer->motion_field.mv.size(),
+              invalid_mv);
+  }
+
+  const dsp::Dsp* const dsp =
+      dsp::GetDspTable(sequence_header.color_config.bitdepth);
+  if (dsp == nullptr) {
+    LIBGAV1_DLOG(ERROR, "Failed to get the dsp table for bitdepth %d.",
+                 sequence_header.color_config.bitdepth);
+    return kStatusInternalError;
+  }
+
+  const int tile_count = frame_header.tile_info.tile_count;
+  assert(tile_count >= 1);
+  Vector<std::unique_ptr<Tile>> tiles;
+  if (!tiles.reserve(tile_count)) {
+    LIBGAV1_DLOG(ERROR, "tiles.reserve(%d) failed.\n", tile_count);
+    return kStatusOutOfMemory;
+  }
+
+  if (is_frame_parallel_ && !IsIntraFrame(frame_header.frame_type)) {
+    // We can parse the current frame if all the reference frames have been
+    // parsed.
+    for (const int index : frame_header.reference_frame_index) {
+      if (!state.reference_frame[index]->WaitUntilParsed()) {
+        return kStatusUnknownError;
+      }
+    }
+  }
+
+  // If prev_segment_ids is a null pointer, it is treated as if it pointed to
+  // a segmentation map containing all 0s.
+  const SegmentationMap* prev_segment_ids = nullptr;
+  if (frame_header.primary_reference_frame == kPrimaryReferenceNone) {
+    frame_scratch_buffer->symbol_decoder_context.Initialize(
+        frame_header.quantizer.base_index);
+  } else {
+    const int index =
+        frame_header
+            .reference_frame_index[frame_header.primary_reference_frame];
+    assert(index != -1);
+    const RefCountedBuffer* prev_frame = state.reference_frame[index].get();
+    frame_scratch_buffer->symbol_decoder_context = prev_frame->FrameContext();
+    if (frame_header.segmentation.enabled &&
+        prev_frame->columns4x4() == frame_header.columns4x4 &&
+        prev_frame->rows4x4() == frame_header.rows4x4) {
+      prev_segment_ids = prev_frame->segmentation_map();
+    }
+  }
+
+  // See the comment in AllocateFrameScratchBuffer().
+  const bool use_intra_prediction_buffer =
+      is_frame_parallel_ || settings_.threads == 1;
   PostFilter post_filter(frame_header, sequence_header, frame_scratch_buffer,
                          current_frame->buffer(), dsp,
                          settings_.post_filter_mask);
@@ -1522,13 +2081,14 @@ StatusCode DecoderImpl::DecodeTiles(
     if (frame_scratch_buffer->threading_strategy.thread_pool() == nullptr) {
       return DecodeTilesFrameParallel(
           sequence_header, frame_header, tiles, saved_symbol_decoder_context,
-          prev_segment_ids, frame_scratch_buffer, &post_filter, current_frame);
+          prev_segment_ids, frame_scratch_buffer, &post_filter, current_frame,
+          stage_costs);
     }
     return DecodeTilesThreadedFrameParallel(
         sequence_header, frame_header, tiles, saved_symbol_decoder_context,
-        prev_segment_ids, frame_scratch_buffer, &post_filter, current_frame);
+        prev_segment_ids, frame_scratch_buffer, &post_filter, current_frame,
+        stage_costs);
   }
-  StatusCode status;
   if (settings_.threads == 1) {
     status = DecodeTilesNonFrameParallel(sequence_header, frame_header, tiles,
                                          frame_scratch_buffer, &post_filter);
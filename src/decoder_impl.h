@@ -18,6 +18,7 @@
 #define LIBGAV1_SRC_DECODER_IMPL_H_
 
 #include <array>
+#include <atomic>
 #include <condition_variable>  // NOLINT (unapproved c++11 header)
 #include <cstddef>
 #include <cstdint>
@@ -35,12 +36,14 @@
 #include "src/quantizer.h"
 #include "src/residual_buffer_pool.h"
 #include "src/symbol_decoder_context.h"
+#include "src/threading_strategy.h"
 #include "src/tile.h"
 #include "src/utils/array_2d.h"
 #include "src/utils/block_parameters_holder.h"
 #include "src/utils/compiler_attributes.h"
 #include "src/utils/constants.h"
 #include "src/utils/memory.h"
+#include "src/utils/memory_usage.h"
 #include "src/utils/queue.h"
 #include "src/utils/segmentation_map.h"
 #include "src/utils/types.h"
@@ -57,7 +60,8 @@ struct EncodedFrame {
         state(state),
         temporal_unit(nullptr),
         frame(frame),
-        position_in_temporal_unit(position_in_temporal_unit) {
+        position_in_temporal_unit(position_in_temporal_unit),
+        decode_order(0) {
     obu->MoveTileBuffers(&tile_buffers);
     frame->MarkFrameAsStarted();
   }
@@ -69,6 +73,27 @@ struct EncodedFrame {
   TemporalUnit* temporal_unit;
   RefCountedBufferPtr frame;
   const int position_in_temporal_unit;
+  // The position of the frame in the sequence of frames scheduled for
+  // decoding in frame parallel mode. Used as the priority of its jobs.
+  int64_t decode_order;
+};
+
+// A std::atomic that can be moved, so that it can be a member of an element of
+// a Queue. Moving it is not atomic: no other thread may access either object
+// at the same time.
+template <typename T>
+class MovableAtomic : public std::atomic<T> {
+ public:
+  MovableAtomic() = default;
+  explicit MovableAtomic(T value) : std::atomic<T>(value) {}
+
+  MovableAtomic(MovableAtomic&& other) noexcept
+      : std::atomic<T>(other.load(std::memory_order_relaxed)) {}
+  MovableAtomic& operator=(MovableAtomic&& other) noexcept {
+    this->store(other.load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+    return *this;
+  }
 };
 
 struct TemporalUnit : public Allocable {
@@ -96,13 +121,16 @@ struct TemporalUnit : public Allocable {
   void* buffer_private_data;
 
   // The following members are used only in frame parallel mode.
-  bool decoded;
+  // Set with release semantics by the frame thread that finishes the last
+  // frame of the temporal unit, after the other members have been written.
+  MovableAtomic<bool> decoded;
   StatusCode status;
   bool has_displayable_frame;
   int output_frame_position;
 
   Vector<EncodedFrame> frames;
-  size_t decoded_count;
+  // The number of frames that have been decoded (or have failed).
+  MovableAtomic<size_t> decoded_count;
 
   // The struct (and the counter) is used to support output of multiple layers
   // within a single temporal unit. The decoding process will store the output
@@ -140,6 +168,15 @@ class DecoderImpl : public Allocable {
   StatusCode EnqueueFrame(const uint8_t* data, size_t size,
                           int64_t user_private_data, void* buffer_private_data);
   StatusCode DequeueFrame(const DecoderBuffer** out_ptr);
+  StatusCode GetMemoryUsage(size_t* current_bytes, size_t* peak_bytes) const;
+  // Discards all the state of the current stream so that the decoder can be
+  // reused for a new stream with |settings|, keeping the thread pools and the
+  // buffers. In frame parallel mode, first waits until the frames in flight are
+  // decoded. Returns false, without waiting, if |settings| are not compatible
+  // with the current settings, and false if the decoder has failed. The
+  // decoder must then be recreated. The caller must update the settings
+  // referred to by this object to |settings| after a successful call.
+  LIBGAV1_MUST_USE_RESULT bool Reset(const DecoderSettings& settings);
   static constexpr int GetMaxBitdepth() {
     static_assert(LIBGAV1_MAX_BITDEPTH == 8 || LIBGAV1_MAX_BITDEPTH == 10,
                   "LIBGAV1_MAX_BITDEPTH must be 8 or 10.");
@@ -147,8 +184,15 @@ class DecoderImpl : public Allocable {
   }
 
  private:
+  class AdaptiveThreadsReleaser;
+
   explicit DecoderImpl(const DecoderSettings* settings);
   StatusCode Init();
+  // Called by Init() when the settings declare the maximum frame size.
+  // Allocates the frame buffers and the scratch buffers for frames of up to
+  // the declared limits and maps their pages, so that decoding such frames
+  // does not grow them.
+  StatusCode Preallocate();
   // Called when the first frame is enqueued. It does the OBU parsing for one
   // temporal unit to retrieve the tile configuration and sets up the frame
   // threading if frame parallel mode is allowed. It also initializes the
@@ -162,6 +206,15 @@ class DecoderImpl : public Allocable {
   //    sequence (i.e.) a new sequence header.
   StatusCode InitializeFrameThreadPoolAndTemporalUnitQueue(const uint8_t* data,
                                                            size_t size);
+  // Used only in frame parallel mode. Returns the number of frames, between 1
+  // and |max_frames|, that can be decoded at the same time within
+  // |settings_.memory_budget|, for frames of up to |width|x|height| in the
+  // sequence of |sequence_header|. The frame buffers
+  // of the reference frames and of |output_frame_| are always needed; each
+  // frame in flight adds its frame buffer, its film grain frame buffer and a
+  // frame scratch buffer.
+  int GetMaxFramesInFlight(const ObuSequenceHeader& sequence_header, int width,
+                           int height, int max_frames) const;
   // Used only in frame parallel mode. Signals failure and waits until the
   // worker threads are aborted if |status| is a failure status. If |status| is
   // equal to kStatusOk or kStatusTryAgain, this function does not do anything.
@@ -186,16 +239,40 @@ class DecoderImpl : public Allocable {
   // |encoded_frame->temporal_unit|'s parameters if the decoded frame is a
   // displayable frame. Used only in frame parallel mode.
   StatusCode DecodeFrame(EncodedFrame* encoded_frame);
+  // Used only in frame parallel mode with adaptive threading. Waits until the
+  // frames before the frame with |decode_order| have started and the frame
+  // thread plus the current number of intra-frame threads per frame fit in
+  // |settings_.threads| along with the threads of the frames being decoded.
+  // Returns the number of intra-frame threads of the frame, or -1 if the
+  // decoder failed while waiting.
+  int AcquireAdaptiveThreads(int64_t decode_order);
+  // Returns the threads of a frame acquired by AcquireAdaptiveThreads().
+  void ReleaseAdaptiveThreads(int threads_per_frame);
+  // Wakes up the frame threads waiting in AcquireAdaptiveThreads() so that
+  // they see the failure.
+  void NotifyAdaptiveThreadsFailure();
 
   // Populates |buffer_| with values from |frame|. Adds a reference to |frame|
   // in |output_frame_|.
   StatusCode CopyFrameToOutputBuffer(const RefCountedBufferPtr& frame);
+  // If |stage_costs| is not nullptr, it is populated with the time spent in
+  // each decoding stage. This is only supported in frame parallel mode.
   StatusCode DecodeTiles(const ObuSequenceHeader& sequence_header,
                          const ObuFrameHeader& frame_header,
                          const Vector<TileBuffer>& tile_buffers,
                          const DecoderState& state,
                          FrameScratchBuffer* frame_scratch_buffer,
-                         RefCountedBuffer* current_frame);
+                         RefCountedBuffer* current_frame,
+                         FrameStageCosts* stage_costs);
+  // Allocates the members of |frame_scratch_buffer| that depend on the frame
+  // dimensions. Buffers that are already large enough are reused.
+  // |frame_parallel| is true if the frame is
+  // decoded in frame parallel mode. The threading strategy of
+  // |frame_scratch_buffer| must be set up before this call.
+  StatusCode AllocateFrameScratchBuffer(
+      const ObuSequenceHeader& sequence_header,
+      const ObuFrameHeader& frame_header, bool frame_parallel,
+      FrameScratchBuffer* frame_scratch_buffer);
   // Applies film grain synthesis to the |displayable_frame| and stores the film
   // grain applied frame into |film_grain_frame|. Returns kStatusOk on success.
   StatusCode ApplyFilmGrain(const ObuSequenceHeader& sequence_header,
@@ -206,9 +283,31 @@ class DecoderImpl : public Allocable {
 
   bool IsNewSequenceHeader(const ObuParser& obu);
 
-  bool HasFailure() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return failure_status_ != kStatusOk;
+  bool HasFailure() const {
+    return failure_status_.load(std::memory_order_acquire) != kStatusOk;
+  }
+
+  // Returns the placement of the decoder threads, or nullptr if they are not
+  // pinned.
+  const CpuAffinity* GetCpuAffinity() const {
+    return (cpu_affinity_.policy() != CpuAffinity::kPolicyNone)
+               ? &cpu_affinity_
+               : nullptr;
+  }
+
+  // Returns the scheduler supplied by the application, or nullptr if the
+  // decoder should create its own threads.
+  const ExternalScheduler* GetExternalScheduler() const {
+    return (external_scheduler_.schedule_job != nullptr) ? &external_scheduler_
+                                                         : nullptr;
+  }
+
+  // Returns true if the frame parallel threads are rebalanced from the
+  // measured stage costs. Sharing the threads between the frames takes
+  // precedence.
+  bool UseAdaptiveThreading() const {
+    return settings_.adaptive_threading &&
+           !settings_.share_threads_between_frames;
   }
 
   // Initializes the |quantizer_matrix_| if necessary and sets
@@ -234,20 +333,55 @@ class DecoderImpl : public Allocable {
   // more than 1 element. This queue is used only when |is_frame_parallel_| is
   // false.
   Queue<RefCountedBufferPtr> output_frame_queue_;
+  // Resolved from the affinity settings. Declared before the members whose
+  // thread pools and frame buffers point to it.
+  CpuAffinity cpu_affinity_;
+  // Declared before the members whose buffers are accounted in it.
+  MemoryUsage memory_usage_;
 
   BufferPool buffer_pool_;
   WedgeMaskArray wedge_masks_;
   bool wedge_masks_initialized_ = false;
   QuantizerMatrix quantizer_matrix_;
   bool quantizer_matrix_initialized_ = false;
+  // Wraps |settings_.schedule_job|. Declared before
+  // |frame_scratch_buffer_pool_| because the thread pools in the frame scratch
+  // buffers point to it.
+  ExternalScheduler external_scheduler_;
+  // Used only if |settings_.share_threads_between_frames| is true. Runs the
+  // jobs of the thread pools of all the frame scratch buffers, so it is
+  // declared before |frame_scratch_buffer_pool_|.
+  std::unique_ptr<ThreadPool> shared_thread_pool_;
   FrameScratchBufferPool frame_scratch_buffer_pool_;
 
-  // Used to synchronize the accesses into |temporal_units_| in order to update
-  // the "decoded" state of an temporal unit.
+  // |temporal_units_| is only accessed by the application thread, and the frame
+  // threads mark the temporal units as decoded with atomic operations. The
+  // mutex only serializes the frame threads that store output layers into the
+  // same temporal unit, and lets a blocking DequeueFrame() wait on
+  // |decoded_condvar_|.
   std::mutex mutex_;
   std::condition_variable decoded_condvar_;
+  // True while Reset() waits on |decoded_condvar_|, so that the frame threads
+  // notify it even if |settings_.blocking_dequeue| is false.
+  std::atomic<bool> waiting_for_reset_{false};
   bool is_frame_parallel_;
+  // Used only if UseAdaptiveThreading() returns true.
+  AdaptiveThreadAllocator thread_allocator_;
+  // Used only if UseAdaptiveThreading() returns true. The frames in flight
+  // may have been started with different splits of the threads, so the frame
+  // threads and intra-frame threads of the frames being decoded are counted in
+  // |adaptive_threads_in_use_| and kept within |settings_.threads|. The frames
+  // start in decode order, so a frame never waits for threads held by the
+  // frames that reference it.
+  std::mutex adaptive_threads_mutex_;
+  std::condition_variable adaptive_threads_condvar_;
+  int adaptive_threads_in_use_ LIBGAV1_GUARDED_BY(adaptive_threads_mutex_) = 0;
+  // The decode order of the next frame that may start.
+  int64_t next_adaptive_decode_order_
+      LIBGAV1_GUARDED_BY(adaptive_threads_mutex_) = 0;
   std::unique_ptr<ThreadPool> frame_thread_pool_;
+  // The number of frames scheduled on |frame_thread_pool_|.
+  int64_t scheduled_frame_count_ = 0;
 
   // In frame parallel mode, there are two primary points of failure:
   //  1) ParseAndSchedule()
@@ -256,7 +390,7 @@ class DecoderImpl : public Allocable {
   // aborting whatever they are doing. This variable is used to accomplish that.
   // If |failure_status_| is not kStatusOk, then the two functions will try to
   // abort as early as they can.
-  StatusCode failure_status_ = kStatusOk LIBGAV1_GUARDED_BY(mutex_);
+  std::atomic<StatusCode> failure_status_{kStatusOk};
 
   ObuSequenceHeader sequence_header_ = {};
   // If true, sequence_header is valid.
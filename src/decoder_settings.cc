@@ -28,6 +28,21 @@ void Libgav1DecoderSettingsInitDefault(Libgav1DecoderSettings* settings) {
   settings->output_all_layers = 0;  // false
   settings->operating_point = 0;
   settings->post_filter_mask = 0x1f;
+  settings->schedule_job = nullptr;
+  settings->executor_private_data = nullptr;
+  settings->affinity_policy = kLibgav1CpuAffinityNone;
+  settings->affinity_cpus = nullptr;
+  settings->num_affinity_cpus = 0;
+  settings->numa_node = -1;
+  settings->adaptive_threading = 0;  // false
+  settings->share_threads_between_frames = 0;  // false
+  settings->max_frame_width = 0;
+  settings->max_frame_height = 0;
+  settings->max_bitdepth = 8;
+  settings->image_format = kLibgav1ImageFormatYuv420;
+  settings->max_tile_count = 1;
+  settings->use_huge_pages = 0;  // false
+  settings->memory_budget = 0;
 }
 
 }  // extern "C"
@@ -14,12 +14,22 @@
 
 #include "src/gav1/decoder.h"
 
+#include <chrono>  // NOLINT (unapproved c++11 header)
+#include <condition_variable>  // NOLINT (unapproved c++11 header)
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
 #include <memory>
+#include <mutex>  // NOLINT (unapproved c++11 header)
 #include <new>
+#include <thread>  // NOLINT (unapproved c++11 header)
+#include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
+#include "tests/allocation_counter.h"
 
 namespace libgav1 {
 namespace {
@@ -59,6 +69,98 @@ constexpr uint8_t kFrame2[] = {
     0x2d, 0x7a, 0x53, 0x24, 0x26, 0x20, 0xa6, 0x11, 0x7,  0x49, 0x76,
     0xa3, 0xc7, 0x62, 0xf8, 0x3,  0x32, 0xb0, 0x98, 0x17, 0x3d, 0x80};
 
+// The temporal units of tests/data/five-frames.ivf, a 352x288 stream.
+constexpr uint8_t kFiveFramesUnit1[] = {
+    0x12, 0x0,  0xa,  0xb,  0x0,  0x0,  0x0,  0x4,  0x45, 0x7e, 0x3e, 0x7d,
+    0xfc, 0xc0, 0x20, 0x32, 0xa8, 0x4,  0x10, 0x1,  0x9f, 0xe0, 0x0,  0x0,
+    0xc0, 0xe,  0xd0, 0x80, 0x2a, 0xaf, 0x70, 0xf7, 0x82, 0x0,  0xf5, 0x3d,
+    0x83, 0x8b, 0x71, 0xc8, 0x16, 0x88, 0x73, 0x79, 0xde, 0xaf, 0x4e, 0x9,
+    0xe7, 0x58, 0xdd, 0x72, 0xfb, 0x87, 0xf3, 0xf1, 0xd1, 0xdc, 0x73, 0x3d,
+    0x4d, 0x32, 0x95, 0x25, 0xc0, 0xa7, 0x92, 0x60, 0x12, 0xe4, 0x2c, 0xa2,
+    0xef, 0xf8, 0x6b, 0x82, 0xad, 0x90, 0x24, 0xfa, 0xa0, 0xe2, 0x5d, 0x59,
+    0xe6, 0x21, 0x22, 0xf6, 0xe1, 0x1a, 0xe,  0x8b, 0x5b, 0x10, 0x7,  0x14,
+    0x50, 0x76, 0xe5, 0xd7, 0xf0, 0x25, 0x63, 0xca, 0x6a, 0xeb, 0x6e, 0xf2,
+    0x18, 0x52, 0x56, 0x49, 0xda, 0xba, 0xc3, 0x80, 0xc2, 0xed, 0xab, 0xb,
+    0x54, 0x3f, 0x4d, 0x27, 0xd,  0xee, 0x71, 0xb7, 0x38, 0xf1, 0xe4, 0xc6,
+    0xf,  0x23, 0x9f, 0x2d, 0xde, 0x8e, 0x64, 0xe0, 0x44, 0xd0, 0x9e, 0x9a,
+    0x8a, 0xd5, 0x8a, 0xf3, 0xe0, 0xf0, 0x47, 0x2,  0xfc, 0xa4, 0x0,  0xc2,
+    0x86, 0xe3, 0x35, 0xbb, 0x64, 0xfa, 0x25, 0x22, 0xef, 0x27, 0x8d, 0xe0,
+    0x21, 0x82, 0x35, 0x9,  0x87, 0x37, 0x44, 0xb6, 0x1,  0xb4, 0x9b, 0xb8,
+    0xfb, 0x84, 0x2,  0x8a, 0xd4, 0x89, 0xc3, 0xe5, 0x94, 0xec, 0xc6, 0x51,
+    0x36, 0x71, 0x96, 0xeb, 0xad, 0x39, 0xf6, 0x6c, 0xb1, 0xc6, 0x68, 0x5d,
+    0x95, 0x3f, 0x91, 0xe4, 0x2c, 0x4b, 0x6f, 0x2b, 0x8,  0x5,  0xc8, 0xdf,
+    0x54, 0xa,  0xc7, 0x8a, 0x9b, 0xe0, 0x10, 0xef, 0xe9, 0x89, 0x5d, 0xf6,
+    0xd4, 0x83, 0xaa, 0x97, 0x3c, 0xc1, 0xaa, 0x84, 0x56, 0xa3, 0x8b, 0x2f,
+    0x13, 0xa3, 0xcb, 0xa5, 0x7,  0x14, 0x90, 0x3,  0xc7, 0xed, 0xe3, 0x4,
+    0x93, 0x3d, 0xa,  0x27, 0x8e, 0xed, 0x35, 0xe0, 0x94, 0x22, 0x6f, 0xd4,
+    0xab, 0x24, 0xf6, 0x6c, 0x41, 0x55, 0x4a, 0x7d, 0xcc, 0x84, 0x2b, 0xa8,
+    0x23, 0x17, 0xd,  0xa,  0x4f, 0xed, 0x3f, 0x75, 0xfc, 0x89, 0x94, 0x8b,
+    0x75, 0x14, 0xae, 0x63, 0xbb, 0x98, 0x43, 0x14, 0x5,  0xda, 0x3,  0x7a,
+    0x9b, 0x4d, 0x41, 0xf2, 0x2b, 0x14, 0x75, 0x8b, 0xdc, 0x43, 0xdf, 0x20,
+    0xc5, 0x55, 0x3d, 0xf4, 0xe7, 0x83, 0xce, 0x75, 0x51, 0x20, 0xe6, 0xed,
+    0xd0, 0x8b, 0x7,  0xa4, 0x10, 0x79, 0xaa, 0xa3, 0x58, 0x35, 0x4b, 0x2b,
+    0x23, 0xd4, 0xaf, 0xef, 0x70, 0x38, 0x77, 0x2f, 0x2a, 0x2d, 0x68, 0x96,
+    0x54, 0xd3, 0x74, 0x6c, 0x79, 0x43, 0xf2, 0x69, 0x10, 0x61, 0xfb, 0xce,
+    0x90, 0x64, 0x4f, 0x7c, 0x41, 0x43, 0x28, 0xd2, 0xb7, 0x17, 0x12, 0xf4,
+    0x8b, 0x62, 0x65, 0x15, 0x97, 0xe2, 0x1,  0xc,  0x24, 0xa8, 0x99, 0x99,
+    0x10, 0x9,  0x56, 0xa8, 0x14, 0x99, 0xbe, 0xf5, 0x5e, 0x52, 0x65, 0x7c,
+    0xbe, 0xa5, 0xf0, 0xe0, 0x14, 0x19, 0x69, 0x1c, 0xf2, 0x12, 0xfb, 0x1b,
+    0x2c, 0x13, 0x4d, 0xc1, 0x1b, 0x66, 0xd8, 0xa9, 0x4b, 0x25, 0xd8, 0xa3,
+    0xe8, 0xc5, 0xb9, 0x33, 0xde, 0x58, 0x2b, 0xf7, 0x9b, 0xf7, 0x34, 0xf7,
+    0xb1, 0x50, 0x27, 0x93, 0x41, 0x83, 0xbe, 0xd8, 0xdf, 0x98, 0xff, 0x4e,
+    0xcf, 0xdc, 0x7c, 0x2d, 0x1,  0x7a, 0x82, 0xbf, 0x3,  0x81, 0xbe, 0xda,
+    0x2,  0xcf, 0xda, 0xf5, 0xcf, 0xfd, 0x83, 0x47, 0xde, 0xbc, 0xef, 0x71,
+    0xa3, 0xac, 0x7,  0xe6, 0xb5, 0x1,  0x36, 0x3b, 0xb1, 0xd8, 0x74, 0xaa,
+    0x45, 0xa5, 0x5c, 0x1c, 0x87, 0x4d, 0x49, 0xfa, 0x54, 0x9b, 0x65, 0xd8,
+    0x4b, 0xc5, 0x79, 0x38, 0xb5, 0x51, 0x68, 0xed, 0xfd, 0xab, 0xc0, 0xab,
+    0xd7, 0xc1, 0xff, 0xaf, 0x6b, 0x66, 0x6f, 0xf3, 0xd6, 0x52, 0x4c, 0x96,
+    0x7b, 0xaf, 0x12, 0xfa, 0xeb, 0xea, 0xe6, 0xf4, 0x2b, 0x93, 0x51, 0xf2,
+    0x35, 0x96, 0xef, 0xe,  0xca, 0x3b, 0xfa, 0x6f, 0x7b, 0xfa, 0x60, 0xc1,
+    0x1,  0xaa, 0xd9, 0x9e, 0x19, 0x33, 0x4e, 0xdd, 0x9a, 0x5c, 0x90, 0xa9,
+    0xd8, 0xb9, 0xfc, 0xb,  0x54, 0xb2, 0x25, 0x9,  0x6e, 0xe8, 0xcf, 0xa6,
+    0xd8, 0xfd, 0xa0, 0x17, 0x89, 0x52};
+
+constexpr uint8_t kFiveFramesUnit2[] = {
+    0x12, 0x0,  0x32, 0x26, 0x30, 0x2,  0x1,  0x0,  0xa7, 0x2e, 0x7,  0x9f,
+    0xe0, 0x0,  0x0,  0xb0, 0x0,  0x0,  0x20, 0x0,  0x98, 0xff, 0xa3, 0xa7,
+    0x4,  0xd8, 0xcd, 0xd9, 0x38, 0x66, 0x45, 0xc0, 0xd1, 0x23, 0xad, 0xe7,
+    0xed, 0x94, 0x96, 0x41, 0x6b, 0xae};
+
+constexpr uint8_t kFiveFramesUnit3[] = {
+    0x12, 0x0,  0x32, 0x2e, 0x30, 0x4,  0x0,  0x88, 0x17, 0x2e, 0x7,  0x9f,
+    0xe0, 0x0,  0x0,  0xb0, 0x1,  0xc0, 0x20, 0x0,  0x98, 0xf8, 0x77, 0xaa,
+    0x2b, 0xf1, 0xf9, 0xd0, 0x10, 0xcc, 0x2f, 0xd6, 0xd5, 0x47, 0x69, 0x16,
+    0x11, 0xab, 0x35, 0xfc, 0x4,  0x31, 0x6f, 0x1e, 0xb9, 0xa0, 0xa4, 0xa8,
+    0x96, 0x68};
+
+constexpr uint8_t kFiveFramesUnit4[] = {
+    0x12, 0x0,  0x32, 0x30, 0x30, 0x6,  0x0,  0x45, 0x7,  0x2e, 0x7,  0x9f,
+    0xe0, 0x0,  0x0,  0xb0, 0x3,  0x40, 0x20, 0x0,  0x99, 0x1d, 0xbe, 0x11,
+    0x4b, 0x3d, 0xda, 0x22, 0xf6, 0xa,  0xa3, 0x84, 0xa2, 0x2d, 0x1a, 0xc2,
+    0x35, 0xd7, 0x34, 0x1f, 0x50, 0xa1, 0xb2, 0x41, 0x22, 0x17, 0xcb, 0x24,
+    0xba, 0x16, 0xe6, 0xef};
+
+constexpr uint8_t kFiveFramesUnit5[] = {
+    0x12, 0x0,  0x32, 0x49, 0x30, 0x9,  0xc3, 0x0,  0xa7, 0x2e, 0x7,  0x9f,
+    0xe0, 0x0,  0x0,  0xc0, 0xc,  0x13, 0x50, 0x8,  0x0,  0xce, 0xb4, 0xb7,
+    0xf6, 0xa4, 0xf4, 0xba, 0x1a, 0x1e, 0x35, 0xb5, 0x1f, 0x31, 0xd5, 0xe3,
+    0xd0, 0x6c, 0x7,  0x98, 0x8c, 0x7,  0x91, 0x96, 0xed, 0xca, 0xf5, 0xc8,
+    0xe6, 0x3b, 0xb6, 0x3f, 0x93, 0xa0, 0x7d, 0x5e, 0x69, 0x5d, 0x2b, 0x7d,
+    0x42, 0x8a, 0x44, 0x8a, 0xba, 0xab, 0xb3, 0xc6, 0x73, 0x16, 0xda, 0xbf,
+    0x10, 0x69, 0x13, 0x87, 0x19};
+
+struct TemporalUnit {
+  const uint8_t* data;
+  size_t size;
+};
+
+constexpr TemporalUnit kFiveFrames[] = {
+    {kFiveFramesUnit1, sizeof(kFiveFramesUnit1)},
+    {kFiveFramesUnit2, sizeof(kFiveFramesUnit2)},
+    {kFiveFramesUnit3, sizeof(kFiveFramesUnit3)},
+    {kFiveFramesUnit4, sizeof(kFiveFramesUnit4)},
+    {kFiveFramesUnit5, sizeof(kFiveFramesUnit5)}};
+
 class DecoderTest : public testing::Test {
  public:
   void SetUp() override;
@@ -348,5 +450,519 @@ TEST_F(DecoderTest, NonFrameParallelModeInvalidFrameAfterEOS) {
   EXPECT_EQ(frames_in_use_, 0);
 }
 
+// A minimal thread pool standing in for an executor owned by the application.
+class HostExecutor {
+ public:
+  explicit HostExecutor(int num_threads) {
+    for (int i = 0; i < num_threads; ++i) {
+      threads_.emplace_back([this]() { WorkerFunction(); });
+    }
+  }
+
+  ~HostExecutor() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      exit_ = true;
+    }
+    condition_.notify_all();
+    for (auto& thread : threads_) thread.join();
+  }
+
+  static void ScheduleJob(void* executor_private_data, RunJobFunction run_job,
+                          void* job) {
+    auto* const executor = static_cast<HostExecutor*>(executor_private_data);
+    {
+      std::lock_guard<std::mutex> lock(executor->mutex_);
+      executor->jobs_.emplace_back(run_job, job);
+      ++executor->num_scheduled_jobs_;
+    }
+    executor->condition_.notify_one();
+  }
+
+  int num_scheduled_jobs() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_scheduled_jobs_;
+  }
+
+ private:
+  void WorkerFunction() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      if (jobs_.empty()) {
+        if (exit_) break;
+        condition_.wait(lock);
+        continue;
+      }
+      const std::pair<RunJobFunction, void*> job = jobs_.front();
+      jobs_.pop_front();
+      lock.unlock();
+      job.first(job.second);
+      lock.lock();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::deque<std::pair<RunJobFunction, void*>> jobs_;
+  int num_scheduled_jobs_ = 0;
+  bool exit_ = false;
+  std::vector<std::thread> threads_;
+};
+
+// Decodes |kFrame1| and returns a copy of the luma plane.
+std::vector<uint8_t> DecodeLuma(const DecoderSettings& settings) {
+  Decoder decoder;
+  std::vector<uint8_t> luma;
+  if (decoder.Init(&settings) != kStatusOk) return luma;
+  if (decoder.EnqueueFrame(kFrame1, sizeof(kFrame1), 0, nullptr) !=
+      kStatusOk) {
+    return luma;
+  }
+  const DecoderBuffer* buffer;
+  if (decoder.DequeueFrame(&buffer) != kStatusOk || buffer == nullptr) {
+    return luma;
+  }
+  const int width = buffer->displayed_width[0];
+  for (int y = 0; y < buffer->displayed_height[0]; ++y) {
+    const uint8_t* const row = buffer->plane[0] + y * buffer->stride[0];
+    luma.insert(luma.end(), row, row + width);
+  }
+  return luma;
+}
+
+// Two decoders share one executor supplied through DecoderSettings.
+TEST(DecoderExternalExecutorTest, SharedExecutor) {
+  DecoderSettings settings;
+  const std::vector<uint8_t> expected = DecodeLuma(settings);
+  ASSERT_FALSE(expected.empty());
+
+  HostExecutor executor(4);
+  settings.threads = 4;
+  settings.schedule_job = HostExecutor::ScheduleJob;
+  settings.executor_private_data = &executor;
+  std::vector<uint8_t> luma[2];
+  std::thread decoder_thread([&settings, &luma]() {
+    luma[1] = DecodeLuma(settings);
+  });
+  luma[0] = DecodeLuma(settings);
+  decoder_thread.join();
+  EXPECT_EQ(luma[0], expected);
+  EXPECT_EQ(luma[1], expected);
+  EXPECT_GT(executor.num_scheduled_jobs(), 0);
+}
+
+void IgnoreInputBuffer(void* /*private_data*/, void* /*input_buffer*/) {}
+
+// Decodes kFrame1, kFrame2, kFrame1, kFrame2 and stores the number of
+// allocations made by each temporal unit in |num_allocations_per_frame|.
+void CountAllocations(const DecoderSettings& settings,
+                      int num_allocations_per_frame[4]) {
+  Decoder decoder;
+  ASSERT_EQ(decoder.Init(&settings), kStatusOk);
+  for (int i = 0; i < 4; ++i) {
+    const uint8_t* const data = (i % 2 == 0) ? kFrame1 : kFrame2;
+    const size_t size = (i % 2 == 0) ? sizeof(kFrame1) : sizeof(kFrame2);
+    test_utils::StartCountingAllocations();
+    const StatusCode status = decoder.EnqueueFrame(data, size, 0, nullptr);
+    const DecoderBuffer* buffer = nullptr;
+    StatusCode dequeue_status;
+    // In frame parallel mode the frame may still be decoding.
+    while ((dequeue_status = decoder.DequeueFrame(&buffer)) ==
+           kStatusTryAgain) {
+    }
+    num_allocations_per_frame[i] = test_utils::StopCountingAllocations();
+    ASSERT_EQ(status, kStatusOk);
+    ASSERT_EQ(dequeue_status, kStatusOk);
+    ASSERT_NE(buffer, nullptr);
+  }
+}
+
+// With the stream limits declared, the first temporal units allocate no more
+// memory than the same temporal units later in the stream: only the per
+// temporal unit objects (the OBU parser, the tiles) are allocated. In frame
+// parallel mode the first temporal unit is also parsed once more to set up the
+// frame threads, so it is only checked to allocate less than without the
+// limits.
+TEST(DecoderPreallocationTest, StreamLimits) {
+  for (const bool frame_parallel : {false, true}) {
+    for (const int threads : {1, 4}) {
+      SCOPED_TRACE(testing::Message() << "frame_parallel: " << frame_parallel
+                                      << " threads: " << threads);
+      DecoderSettings settings;
+      settings.threads = threads;
+      settings.frame_parallel = frame_parallel;
+      settings.release_input_buffer = IgnoreInputBuffer;
+      int num_allocations_per_frame[4];
+      CountAllocations(settings, num_allocations_per_frame);
+      EXPECT_GT(num_allocations_per_frame[0], num_allocations_per_frame[2]);
+      const int num_first_frame_allocations = num_allocations_per_frame[0];
+
+      settings.max_frame_width = 32;
+      settings.max_frame_height = 32;
+      CountAllocations(settings, num_allocations_per_frame);
+      if (frame_parallel) {
+        EXPECT_LT(num_allocations_per_frame[0], num_first_frame_allocations);
+      } else {
+        EXPECT_EQ(num_allocations_per_frame[0], num_allocations_per_frame[2]);
+      }
+      EXPECT_EQ(num_allocations_per_frame[1], num_allocations_per_frame[3]);
+    }
+  }
+}
+
+// Decodes kFrame1 and kFrame2 |num_warm_up_units| times each, then returns the
+// number of allocations made while decoding them 4 more times each.
+int CountSteadyStateAllocations(const DecoderSettings& settings,
+                                int num_warm_up_units) {
+  Decoder decoder;
+  EXPECT_EQ(decoder.Init(&settings), kStatusOk);
+  for (int i = 0; i < 2 * (num_warm_up_units + 4); ++i) {
+    if (i == 2 * num_warm_up_units) test_utils::StartCountingAllocations();
+    const uint8_t* const data = (i % 2 == 0) ? kFrame1 : kFrame2;
+    const size_t size = (i % 2 == 0) ? sizeof(kFrame1) : sizeof(kFrame2);
+    const DecoderBuffer* buffer = nullptr;
+    if (decoder.EnqueueFrame(data, size, 0, nullptr) != kStatusOk ||
+        decoder.DequeueFrame(&buffer) != kStatusOk || buffer == nullptr) {
+      ADD_FAILURE() << "Decoding temporal unit " << i << " failed.";
+      break;
+    }
+  }
+  return test_utils::StopCountingAllocations();
+}
+
+// Once the decoder is warm, the tile and post filter jobs scheduled on the
+// thread pool do not allocate: a threaded decode makes the same per temporal
+// unit allocations (the OBU parser, the tiles) as a single threaded one. With 4
+// threads this stream schedules jobs (see DecoderExternalExecutorTest).
+TEST(DecoderAllocationTest, ThreadedDecodeSchedulesWithoutAllocating) {
+  DecoderSettings settings;
+  settings.release_input_buffer = IgnoreInputBuffer;
+  settings.threads = 1;
+  const int expected = CountSteadyStateAllocations(settings, 2);
+  ASSERT_GT(expected, 0);
+  for (const int threads : {2, 4, 8}) {
+    SCOPED_TRACE(threads);
+    settings.threads = threads;
+    EXPECT_EQ(CountSteadyStateAllocations(settings, 2), expected);
+  }
+}
+
+TEST(DecoderPreallocationTest, InvalidStreamLimits) {
+  DecoderSettings settings;
+  settings.max_frame_width = 32;
+  settings.max_frame_height = 32;
+  settings.max_bitdepth = 12;
+  Decoder decoder;
+  EXPECT_EQ(decoder.Init(&settings), kStatusInvalidArgument);
+}
+
+TEST(DecoderMemoryUsageTest, GetMemoryUsage) {
+  Decoder decoder;
+  size_t current_bytes;
+  size_t peak_bytes;
+  EXPECT_EQ(decoder.GetMemoryUsage(&current_bytes, &peak_bytes),
+            kStatusNotInitialized);
+  ASSERT_EQ(decoder.Init(nullptr), kStatusOk);
+  ASSERT_EQ(decoder.GetMemoryUsage(&current_bytes, &peak_bytes), kStatusOk);
+  EXPECT_EQ(current_bytes, 0);
+  EXPECT_EQ(peak_bytes, 0);
+  ASSERT_EQ(decoder.EnqueueFrame(kFrame1, sizeof(kFrame1), 0, nullptr),
+            kStatusOk);
+  const DecoderBuffer* buffer;
+  ASSERT_EQ(decoder.DequeueFrame(&buffer), kStatusOk);
+  ASSERT_NE(buffer, nullptr);
+  ASSERT_EQ(decoder.GetMemoryUsage(&current_bytes, &peak_bytes), kStatusOk);
+  EXPECT_GT(current_bytes, 0);
+  EXPECT_GE(peak_bytes, current_bytes);
+  EXPECT_EQ(decoder.GetMemoryUsage(nullptr, nullptr), kStatusOk);
+}
+
+// Enqueues |kFrame1| in frame parallel mode until the decoder asks to try
+// again, then decodes all the frames. Returns the number of frames that were
+// in flight, and stores the peak memory usage in |*peak_bytes|.
+int DecodeFramesInFlight(size_t memory_budget, size_t* peak_bytes) {
+  DecoderSettings settings;
+  settings.threads = 8;
+  settings.frame_parallel = true;
+  settings.release_input_buffer = IgnoreInputBuffer;
+  settings.memory_budget = memory_budget;
+  Decoder decoder;
+  EXPECT_EQ(decoder.Init(&settings), kStatusOk);
+  int num_frames = 0;
+  StatusCode status;
+  while ((status = decoder.EnqueueFrame(kFrame1, sizeof(kFrame1), 0,
+                                        nullptr)) == kStatusOk) {
+    ++num_frames;
+  }
+  EXPECT_EQ(status, kStatusTryAgain);
+  for (int num_dequeued = 0; num_dequeued < num_frames;) {
+    const DecoderBuffer* buffer;
+    status = decoder.DequeueFrame(&buffer);
+    if (status == kStatusTryAgain) continue;
+    EXPECT_EQ(status, kStatusOk);
+    if (status != kStatusOk) break;
+    EXPECT_NE(buffer, nullptr);
+    ++num_dequeued;
+  }
+  EXPECT_EQ(decoder.GetMemoryUsage(nullptr, peak_bytes), kStatusOk);
+  return num_frames;
+}
+
+// A memory budget too small for even one frame still decodes, one frame at a
+// time, and uses less memory than decoding one frame per frame thread.
+TEST(DecoderMemoryUsageTest, FrameParallelBudget) {
+  size_t unlimited_peak_bytes;
+  const int unlimited_frames = DecodeFramesInFlight(0, &unlimited_peak_bytes);
+  ASSERT_GT(unlimited_frames, 1);
+
+  size_t limited_peak_bytes;
+  EXPECT_EQ(DecodeFramesInFlight(1, &limited_peak_bytes), 1);
+  EXPECT_LT(limited_peak_bytes, unlimited_peak_bytes);
+
+  size_t large_budget_peak_bytes;
+  EXPECT_EQ(DecodeFramesInFlight(size_t{1} << 40, &large_budget_peak_bytes),
+            unlimited_frames);
+}
+
+void CountInputBuffer(void* private_data, void* /*input_buffer*/) {
+  ++*static_cast<int*>(private_data);
+}
+
+TEST(DecoderResetTest, NotInitialized) {
+  Decoder decoder;
+  EXPECT_EQ(decoder.Reset(nullptr), kStatusNotInitialized);
+}
+
+// Reset() releases the input buffers of the enqueued frames and the reference
+// frames: kFrame2 cannot be decoded without them.
+TEST(DecoderResetTest, DiscardsStreamState) {
+  for (const bool frame_parallel : {false, true}) {
+    SCOPED_TRACE(frame_parallel);
+    int num_released_input_buffers = 0;
+    DecoderSettings settings;
+    settings.threads = 4;
+    settings.frame_parallel = frame_parallel;
+    settings.release_input_buffer = CountInputBuffer;
+    settings.callback_private_data = &num_released_input_buffers;
+    Decoder decoder;
+    ASSERT_EQ(decoder.Init(&settings), kStatusOk);
+    ASSERT_EQ(decoder.EnqueueFrame(kFrame1, sizeof(kFrame1), 0, nullptr),
+              kStatusOk);
+    const DecoderBuffer* buffer;
+    StatusCode status;
+    while ((status = decoder.DequeueFrame(&buffer)) == kStatusTryAgain) {
+    }
+    ASSERT_EQ(status, kStatusOk);
+    ASSERT_NE(buffer, nullptr);
+    // In frame parallel mode, Reset() waits for kFrame2 to be decoded.
+    ASSERT_EQ(decoder.EnqueueFrame(kFrame2, sizeof(kFrame2), 0, nullptr),
+              kStatusOk);
+    EXPECT_EQ(decoder.Reset(nullptr), kStatusOk);
+    EXPECT_EQ(num_released_input_buffers, 2);
+    EXPECT_EQ(decoder.DequeueFrame(&buffer), kStatusNothingToDequeue);
+
+    if (!frame_parallel) {
+      ASSERT_EQ(decoder.EnqueueFrame(kFrame2, sizeof(kFrame2), 0, nullptr),
+                kStatusOk);
+      EXPECT_NE(decoder.DequeueFrame(&buffer), kStatusOk);
+      EXPECT_EQ(num_released_input_buffers, 3);
+      ASSERT_EQ(decoder.Reset(nullptr), kStatusOk);
+    }
+    for (int i = 0; i < 2; ++i) {
+      const uint8_t* const data = (i == 0) ? kFrame1 : kFrame2;
+      const size_t size = (i == 0) ? sizeof(kFrame1) : sizeof(kFrame2);
+      ASSERT_EQ(decoder.EnqueueFrame(data, size, 0, nullptr), kStatusOk);
+      while ((status = decoder.DequeueFrame(&buffer)) == kStatusTryAgain) {
+      }
+      ASSERT_EQ(status, kStatusOk);
+      ASSERT_NE(buffer, nullptr);
+    }
+  }
+}
+
+// Reset() reuses the decoder when the settings allow it, so the next stream
+// allocates less memory than after SignalEOS(), which recreates the decoder.
+// Incompatible settings still give a working decoder.
+TEST(DecoderResetTest, ReusesDecoder) {
+  DecoderSettings settings;
+  settings.threads = 4;
+  settings.release_input_buffer = IgnoreInputBuffer;
+  Decoder decoder;
+  ASSERT_EQ(decoder.Init(&settings), kStatusOk);
+  const DecoderBuffer* buffer;
+  int num_allocations_after_reset[2];
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(decoder.EnqueueFrame(kFrame1, sizeof(kFrame1), 0, nullptr),
+              kStatusOk);
+    ASSERT_EQ(decoder.DequeueFrame(&buffer), kStatusOk);
+    ASSERT_NE(buffer, nullptr);
+    if (i == 2) break;
+    test_utils::StartCountingAllocations();
+    // The output_all_layers setting does not prevent the reuse.
+    settings.output_all_layers = (i == 0);
+    const StatusCode status =
+        (i == 0) ? decoder.Reset(&settings) : decoder.SignalEOS();
+    ASSERT_EQ(decoder.EnqueueFrame(kFrame1, sizeof(kFrame1), 0, nullptr),
+              kStatusOk);
+    num_allocations_after_reset[i] = test_utils::StopCountingAllocations();
+    ASSERT_EQ(status, kStatusOk);
+    ASSERT_EQ(decoder.DequeueFrame(&buffer), kStatusOk);
+    ASSERT_NE(buffer, nullptr);
+  }
+  EXPECT_LT(num_allocations_after_reset[0], num_allocations_after_reset[1]);
+
+  settings.threads = 2;
+  settings.frame_parallel = true;
+  ASSERT_EQ(decoder.Reset(&settings), kStatusOk);
+  ASSERT_EQ(decoder.EnqueueFrame(kFrame1, sizeof(kFrame1), 0, nullptr),
+            kStatusOk);
+  StatusCode status;
+  while ((status = decoder.DequeueFrame(&buffer)) == kStatusTryAgain) {
+  }
+  ASSERT_EQ(status, kStatusOk);
+  EXPECT_NE(buffer, nullptr);
+}
+
+// Decodes |kFiveFrames| and returns the displayed pixels of each output frame,
+// in output order.
+std::vector<std::vector<uint8_t>> DecodeFiveFrames(
+    const DecoderSettings& settings) {
+  std::vector<std::vector<uint8_t>> frames;
+  DecoderSettings decoder_settings = settings;
+  decoder_settings.release_input_buffer = IgnoreInputBuffer;
+  Decoder decoder;
+  if (decoder.Init(&decoder_settings) != kStatusOk) {
+    ADD_FAILURE() << "Decoder initialization failed.";
+    return frames;
+  }
+  size_t num_enqueued = 0;
+  constexpr size_t kNumTemporalUnits =
+      sizeof(kFiveFrames) / sizeof(kFiveFrames[0]);
+  while (true) {
+    if (num_enqueued < kNumTemporalUnits) {
+      const TemporalUnit& unit = kFiveFrames[num_enqueued];
+      const StatusCode status =
+          decoder.EnqueueFrame(unit.data, unit.size, 0, nullptr);
+      if (status == kStatusOk) {
+        ++num_enqueued;
+        continue;
+      }
+      if (status != kStatusTryAgain) {
+        ADD_FAILURE() << "EnqueueFrame() failed: " << GetErrorString(status);
+        break;
+      }
+    }
+    const DecoderBuffer* buffer;
+    const StatusCode status = decoder.DequeueFrame(&buffer);
+    if (status == kStatusNothingToDequeue) {
+      if (num_enqueued == kNumTemporalUnits) break;
+      continue;
+    }
+    if (status == kStatusTryAgain) continue;
+    if (status != kStatusOk) {
+      ADD_FAILURE() << "DequeueFrame() failed: " << GetErrorString(status);
+      break;
+    }
+    if (buffer == nullptr) continue;
+    const int pixel_size = (buffer->bitdepth == 8) ? 1 : 2;
+    frames.emplace_back();
+    for (int plane = 0; plane < buffer->NumPlanes(); ++plane) {
+      const int width = buffer->displayed_width[plane] * pixel_size;
+      for (int y = 0; y < buffer->displayed_height[plane]; ++y) {
+        const uint8_t* const row =
+            buffer->plane[plane] + y * buffer->stride[plane];
+        frames.back().insert(frames.back().end(), row, row + width);
+      }
+    }
+  }
+  return frames;
+}
+
+// Adaptive threading only changes how the threads are split between the frames,
+// so the output matches a single threaded decode.
+TEST(DecoderFrameParallelTest, AdaptiveThreading) {
+  DecoderSettings settings;
+  const std::vector<std::vector<uint8_t>> expected = DecodeFiveFrames(settings);
+  ASSERT_EQ(expected.size(), 5);
+
+  settings.frame_parallel = true;
+  settings.adaptive_threading = true;
+  for (const int threads : {2, 3, 4, 8}) {
+    SCOPED_TRACE(threads);
+    settings.threads = threads;
+    EXPECT_EQ(DecodeFiveFrames(settings), expected);
+  }
+}
+
+// Sharing the tile and post filter threads between the frames gives the same
+// output as a single threaded decode.
+TEST(DecoderFrameParallelTest, ShareThreadsBetweenFrames) {
+  DecoderSettings settings;
+  const std::vector<std::vector<uint8_t>> expected = DecodeFiveFrames(settings);
+  ASSERT_EQ(expected.size(), 5);
+
+  settings.frame_parallel = true;
+  settings.share_threads_between_frames = true;
+  for (const int threads : {2, 3, 4, 8}) {
+    SCOPED_TRACE(threads);
+    settings.threads = threads;
+    EXPECT_EQ(DecodeFiveFrames(settings), expected);
+  }
+}
+
+// Measures the time spent in EnqueueFrame() and DequeueFrame() in frame
+// parallel mode when the application polls for output, with a stream of small
+// frames such as those of a high frame rate screen capture.
+TEST(DecoderFrameParallelTest, DISABLED_QueueLatency) {
+  using Clock = std::chrono::steady_clock;
+  constexpr int kNumFrames = 5000;
+  DecoderSettings settings;
+  settings.threads = 8;
+  settings.frame_parallel = true;
+  settings.release_input_buffer = IgnoreInputBuffer;
+  Decoder decoder;
+  ASSERT_EQ(decoder.Init(&settings), kStatusOk);
+  Clock::duration enqueue_time = Clock::duration::zero();
+  Clock::duration dequeue_time = Clock::duration::zero();
+  int num_dequeue_calls = 0;
+  int num_enqueued = 0;
+  int num_dequeued = 0;
+  while (num_dequeued < kNumFrames) {
+    if (num_enqueued < kNumFrames) {
+      const Clock::time_point start = Clock::now();
+      const StatusCode status =
+          decoder.EnqueueFrame(kFrame1, sizeof(kFrame1), 0, nullptr);
+      enqueue_time += Clock::now() - start;
+      if (status == kStatusOk) {
+        ++num_enqueued;
+        continue;
+      }
+      ASSERT_EQ(status, kStatusTryAgain);
+    }
+    const DecoderBuffer* buffer;
+    const Clock::time_point start = Clock::now();
+    const StatusCode status = decoder.DequeueFrame(&buffer);
+    dequeue_time += Clock::now() - start;
+    ++num_dequeue_calls;
+    if (status == kStatusOk) {
+      ASSERT_NE(buffer, nullptr);
+      ++num_dequeued;
+    } else {
+      ASSERT_EQ(status, kStatusTryAgain);
+    }
+  }
+  const auto average_ns = [](Clock::duration time, int count) {
+    return static_cast<double>(
+               std::chrono::duration_cast<std::chrono::nanoseconds>(time)
+                   .count()) /
+           count;
+  };
+  printf("EnqueueFrame: %.0f ns/frame, DequeueFrame: %.0f ns/call (%d calls "
+         "for %d frames)\n",
+         average_ns(enqueue_time, kNumFrames),
+         average_ns(dequeue_time, num_dequeue_calls), num_dequeue_calls,
+         kNumFrames);
+}
+
 }  // namespace
 }  // namespace libgav1
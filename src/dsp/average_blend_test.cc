@@ -78,6 +78,10 @@ class AverageBlendTest : public testing::TestWithParam<BlockSize>,
       if ((GetCpuInfo() & kSSE4_1) != 0) {
         AverageBlendInit_SSE4_1();
       }
+    } else if (absl::StartsWith(test_case, "AVX2/")) {
+      if ((GetCpuInfo() & kAVX2) != 0) {
+        AverageBlendInit_AVX2();
+      }
     } else if (absl::StartsWith(test_case, "NEON/")) {
       AverageBlendInit_NEON();
     } else {
@@ -215,6 +219,10 @@ INSTANTIATE_TEST_SUITE_P(C, AverageBlendTest8bpp,
 INSTANTIATE_TEST_SUITE_P(SSE41, AverageBlendTest8bpp,
                          testing::ValuesIn(kTestParam));
 #endif
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, AverageBlendTest8bpp,
+                         testing::ValuesIn(kTestParam));
+#endif  // LIBGAV1_ENABLE_AVX2
 #if LIBGAV1_ENABLE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, AverageBlendTest8bpp,
                          testing::ValuesIn(kTestParam));
@@ -276,6 +284,10 @@ INSTANTIATE_TEST_SUITE_P(C, AverageBlendTest10bpp,
 INSTANTIATE_TEST_SUITE_P(SSE41, AverageBlendTest10bpp,
                          testing::ValuesIn(kTestParam));
 #endif
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, AverageBlendTest10bpp,
+                         testing::ValuesIn(kTestParam));
+#endif  // LIBGAV1_ENABLE_AVX2
 #if LIBGAV1_ENABLE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, AverageBlendTest10bpp,
                          testing::ValuesIn(kTestParam));
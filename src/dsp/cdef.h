@@ -26,10 +26,11 @@
 #include "src/dsp/arm/cdef_neon.h"
 
 // x86:
-// Note includes should be sorted in logical order avx2/avx/sse4, etc.
+// Note includes should be sorted in logical order avx512/avx2/avx/sse4, etc.
 // The order of includes is important as each tests for a superior version
 // before setting the base.
 // clang-format off
+#include "src/dsp/x86/cdef_avx512.h"
 #include "src/dsp/x86/cdef_avx2.h"
 #include "src/dsp/x86/cdef_sse4.h"
 // clang-format on
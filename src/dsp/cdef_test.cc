@@ -82,6 +82,10 @@ class CdefDirectionTest : public testing::TestWithParam<int> {
       if ((GetCpuInfo() & kAVX2) != 0) {
         CdefInit_AVX2();
       }
+    } else if (absl::StartsWith(test_case, "AVX512/")) {
+      if ((GetCpuInfo() & kAVX512) != 0) {
+        CdefInit_AVX512();
+      }
     } else if (absl::StartsWith(test_case, "NEON/")) {
       CdefInit_NEON();
     } else {
@@ -151,6 +155,10 @@ INSTANTIATE_TEST_SUITE_P(SSE41, CdefDirectionTest8bpp, testing::Values(0));
 INSTANTIATE_TEST_SUITE_P(AVX2, CdefDirectionTest8bpp, testing::Values(0));
 #endif  // LIBGAV1_ENABLE_AVX2
 
+#if LIBGAV1_ENABLE_AVX512
+INSTANTIATE_TEST_SUITE_P(AVX512, CdefDirectionTest8bpp, testing::Values(0));
+#endif  // LIBGAV1_ENABLE_AVX512
+
 #if LIBGAV1_MAX_BITDEPTH >= 10
 using CdefDirectionTest10bpp = CdefDirectionTest<10, uint16_t>;
 
@@ -165,6 +173,18 @@ INSTANTIATE_TEST_SUITE_P(C, CdefDirectionTest10bpp, testing::Values(0));
 #if LIBGAV1_ENABLE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, CdefDirectionTest10bpp, testing::Values(0));
 #endif
+
+#if LIBGAV1_ENABLE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(SSE41, CdefDirectionTest10bpp, testing::Values(0));
+#endif
+
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, CdefDirectionTest10bpp, testing::Values(0));
+#endif  // LIBGAV1_ENABLE_AVX2
+
+#if LIBGAV1_ENABLE_AVX512
+INSTANTIATE_TEST_SUITE_P(AVX512, CdefDirectionTest10bpp, testing::Values(0));
+#endif  // LIBGAV1_ENABLE_AVX512
 #endif  // LIBGAV1_MAX_BITDEPTH >= 10
 
 const char* GetDigest8bpp(int id) {
@@ -248,6 +268,10 @@ class CdefFilteringTest : public testing::TestWithParam<CdefTestParam> {
       if ((GetCpuInfo() & kAVX2) != 0) {
         CdefInit_AVX2();
       }
+    } else if (absl::StartsWith(test_case, "AVX512/")) {
+      if ((GetCpuInfo() & kAVX512) != 0) {
+        CdefInit_AVX512();
+      }
     } else {
       FAIL() << "Unrecognized architecture prefix in test case name: "
              << test_case;
@@ -378,6 +402,11 @@ INSTANTIATE_TEST_SUITE_P(AVX2, CdefFilteringTest8bpp,
                          testing::ValuesIn(cdef_test_param));
 #endif  // LIBGAV1_ENABLE_AVX2
 
+#if LIBGAV1_ENABLE_AVX512
+INSTANTIATE_TEST_SUITE_P(AVX512, CdefFilteringTest8bpp,
+                         testing::ValuesIn(cdef_test_param));
+#endif  // LIBGAV1_ENABLE_AVX512
+
 #if LIBGAV1_MAX_BITDEPTH >= 10
 using CdefFilteringTest10bpp = CdefFilteringTest<10, uint16_t>;
 
@@ -394,6 +423,21 @@ INSTANTIATE_TEST_SUITE_P(C, CdefFilteringTest10bpp,
 INSTANTIATE_TEST_SUITE_P(NEON, CdefFilteringTest10bpp,
                          testing::ValuesIn(cdef_test_param));
 #endif
+
+#if LIBGAV1_ENABLE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(SSE41, CdefFilteringTest10bpp,
+                         testing::ValuesIn(cdef_test_param));
+#endif
+
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, CdefFilteringTest10bpp,
+                         testing::ValuesIn(cdef_test_param));
+#endif  // LIBGAV1_ENABLE_AVX2
+
+#if LIBGAV1_ENABLE_AVX512
+INSTANTIATE_TEST_SUITE_P(AVX512, CdefFilteringTest10bpp,
+                         testing::ValuesIn(cdef_test_param));
+#endif  // LIBGAV1_ENABLE_AVX512
 #endif  // LIBGAV1_MAX_BITDEPTH >= 10
 
 }  // namespace
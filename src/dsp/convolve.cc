@@ -839,15 +839,15 @@ void Init10bpp() {
 #ifndef LIBGAV1_Dsp10bpp_ConvolveIntraBlockCopy
   dsp->convolve[1][0][0][0] = ConvolveCopy_C<10, uint16_t>;
 #endif
-#ifndef LIBGAV1_Dsp10bpp_ConvolveIntraBlockHorizontal
+#ifndef LIBGAV1_Dsp10bpp_ConvolveIntraBlockCopyHorizontal
   dsp->convolve[1][0][0][1] =
       ConvolveIntraBlockCopy1D_C<10, uint16_t, /*is_horizontal=*/true>;
 #endif
-#ifndef LIBGAV1_Dsp10bpp_ConvolveIntraBlockVertical
+#ifndef LIBGAV1_Dsp10bpp_ConvolveIntraBlockCopyVertical
   dsp->convolve[1][0][1][0] =
       ConvolveIntraBlockCopy1D_C<10, uint16_t, /*is_horizontal=*/false>;
 #endif
-#ifndef LIBGAV1_Dsp10bpp_ConvolveIntraBlock2D
+#ifndef LIBGAV1_Dsp10bpp_ConvolveIntraBlockCopy2D
   dsp->convolve[1][0][1][1] = ConvolveIntraBlockCopy2D_C<10, uint16_t>;
 #endif
 
@@ -465,10 +465,23 @@ class ConvolveTest : public testing::TestWithParam<
     } else if (absl::StartsWith(test_case, "SSE41/")) {
       if ((GetCpuInfo() & kSSE4_1) != 0) {
         ConvolveInit_SSE4_1();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+        ConvolveInit10bpp_SSE4_1();
+#endif
       }
     } else if (absl::StartsWith(test_case, "AVX2/")) {
       if ((GetCpuInfo() & kAVX2) != 0) {
         ConvolveInit_AVX2();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+        ConvolveInit10bpp_AVX2();
+#endif
+      }
+    } else if (absl::StartsWith(test_case, "AVX512/")) {
+      if ((GetCpuInfo() & kAVX512) != 0) {
+        ConvolveInit_AVX512();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+        ConvolveInit10bpp_AVX512();
+#endif
       }
     } else if (absl::StartsWith(test_case, "NEON/")) {
       ConvolveInit_NEON();
@@ -914,10 +927,16 @@ class ConvolveScaleTest
     } else if (absl::StartsWith(test_case, "SSE41/")) {
       if ((GetCpuInfo() & kSSE4_1) != 0) {
         ConvolveInit_SSE4_1();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+        ConvolveInit10bpp_SSE4_1();
+#endif
       }
     } else if (absl::StartsWith(test_case, "AVX2/")) {
       if ((GetCpuInfo() & kAVX2) != 0) {
         ConvolveInit_AVX2();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+        ConvolveInit10bpp_AVX2();
+#endif
       }
     } else if (absl::StartsWith(test_case, "NEON/")) {
       ConvolveInit_NEON();
@@ -1271,6 +1290,12 @@ INSTANTIATE_TEST_SUITE_P(AVX2, ConvolveScaleTest8bpp,
                                           testing::ValuesIn(kConvolveParam)));
 #endif  // LIBGAV1_ENABLE_AVX2
 
+#if LIBGAV1_ENABLE_AVX512
+INSTANTIATE_TEST_SUITE_P(AVX512, ConvolveTest8bpp,
+                         testing::Combine(testing::ValuesIn(kConvolveTypeParam),
+                                          testing::ValuesIn(kConvolveParam)));
+#endif  // LIBGAV1_ENABLE_AVX512
+
 #if LIBGAV1_MAX_BITDEPTH >= 10
 using ConvolveTest10bpp = ConvolveTest<10, uint16_t>;
 
@@ -1320,6 +1345,27 @@ INSTANTIATE_TEST_SUITE_P(NEON, ConvolveScaleTest10bpp,
                                           testing::ValuesIn(kConvolveParam)));
 #endif  // LIBGAV1_ENABLE_NEON
 
+#if LIBGAV1_ENABLE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(SSE41, ConvolveTest10bpp,
+                         testing::Combine(testing::ValuesIn(kConvolveTypeParam),
+                                          testing::ValuesIn(kConvolveParam)));
+INSTANTIATE_TEST_SUITE_P(SSE41, ConvolveScaleTest10bpp,
+                         testing::Combine(testing::Bool(),
+                                          testing::ValuesIn(kConvolveParam)));
+#endif  // LIBGAV1_ENABLE_SSE4_1
+
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, ConvolveTest10bpp,
+                         testing::Combine(testing::ValuesIn(kConvolveTypeParam),
+                                          testing::ValuesIn(kConvolveParam)));
+#endif  // LIBGAV1_ENABLE_AVX2
+
+#if LIBGAV1_ENABLE_AVX512
+INSTANTIATE_TEST_SUITE_P(AVX512, ConvolveTest10bpp,
+                         testing::Combine(testing::ValuesIn(kConvolveTypeParam),
+                                          testing::ValuesIn(kConvolveParam)));
+#endif  // LIBGAV1_ENABLE_AVX512
+
 #endif  // LIBGAV1_MAX_BITDEPTH >= 10
 
 }  // namespace
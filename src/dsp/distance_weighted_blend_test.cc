@@ -65,6 +65,10 @@ class DistanceWeightedBlendTest : public testing::TestWithParam<BlockSize>,
       if ((GetCpuInfo() & kSSE4_1) != 0) {
         DistanceWeightedBlendInit_SSE4_1();
       }
+    } else if (absl::StartsWith(test_case, "AVX2/")) {
+      if ((GetCpuInfo() & kAVX2) != 0) {
+        DistanceWeightedBlendInit_AVX2();
+      }
     } else if (absl::StartsWith(test_case, "NEON/")) {
       DistanceWeightedBlendInit_NEON();
     } else {
@@ -208,6 +212,10 @@ INSTANTIATE_TEST_SUITE_P(NEON, DistanceWeightedBlendTest8bpp,
 INSTANTIATE_TEST_SUITE_P(SSE41, DistanceWeightedBlendTest8bpp,
                          testing::ValuesIn(kTestParam));
 #endif
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, DistanceWeightedBlendTest8bpp,
+                         testing::ValuesIn(kTestParam));
+#endif  // LIBGAV1_ENABLE_AVX2
 
 #if LIBGAV1_MAX_BITDEPTH >= 10
 const char* GetDistanceWeightedBlendDigest10bpp(const BlockSize block_size) {
@@ -262,6 +270,10 @@ INSTANTIATE_TEST_SUITE_P(C, DistanceWeightedBlendTest10bpp,
 INSTANTIATE_TEST_SUITE_P(SSE41, DistanceWeightedBlendTest10bpp,
                          testing::ValuesIn(kTestParam));
 #endif
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, DistanceWeightedBlendTest10bpp,
+                         testing::ValuesIn(kTestParam));
+#endif  // LIBGAV1_ENABLE_AVX2
 #if LIBGAV1_ENABLE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, DistanceWeightedBlendTest10bpp,
                          testing::ValuesIn(kTestParam));
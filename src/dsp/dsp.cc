@@ -117,20 +117,50 @@ void DspInit() {
       WarpInit_SSE4_1();
       WeightMaskInit_SSE4_1();
 #if LIBGAV1_MAX_BITDEPTH >= 10
+      ConvolveInit10bpp_SSE4_1();
+      InverseTransformInit10bpp_SSE4_1();
       LoopRestorationInit10bpp_SSE4_1();
 #endif  // LIBGAV1_MAX_BITDEPTH >= 10
     }
 #endif  // LIBGAV1_ENABLE_SSE4_1
 #if LIBGAV1_ENABLE_AVX2
     if ((cpu_features & kAVX2) != 0) {
+      AverageBlendInit_AVX2();
       CdefInit_AVX2();
       ConvolveInit_AVX2();
+      DistanceWeightedBlendInit_AVX2();
+      IntraPredDirectionalInit_AVX2();
+      IntraPredInit_AVX2();
+      IntraPredSmoothInit_AVX2();
+      InverseTransformInit_AVX2();
+      LoopFilterInit_AVX2();
       LoopRestorationInit_AVX2();
+      MaskBlendInit_AVX2();
+      MotionFieldProjectionInit_AVX2();
+      MotionVectorSearchInit_AVX2();
+      ObmcInit_AVX2();
+      WarpInit_AVX2();
+      WeightMaskInit_AVX2();
 #if LIBGAV1_MAX_BITDEPTH >= 10
+      ConvolveInit10bpp_AVX2();
+      InverseTransformInit10bpp_AVX2();
       LoopRestorationInit10bpp_AVX2();
 #endif  // LIBGAV1_MAX_BITDEPTH >= 10
     }
 #endif  // LIBGAV1_ENABLE_AVX2
+#if LIBGAV1_ENABLE_AVX512
+    if ((cpu_features & kAVX512) != 0) {
+      CdefInit_AVX512();
+      ConvolveInit_AVX512();
+      InverseTransformInit_AVX512();
+      LoopRestorationInit_AVX512();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+      ConvolveInit10bpp_AVX512();
+      InverseTransformInit10bpp_AVX512();
+      LoopRestorationInit10bpp_AVX512();
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+    }
+#endif  // LIBGAV1_ENABLE_AVX512
 #endif  // LIBGAV1_ENABLE_SSE4_1 || LIBGAV1_ENABLE_AVX2
 #if LIBGAV1_ENABLE_NEON
     AverageBlendInit_NEON();
@@ -344,6 +344,20 @@ using LoopFilterFunc = void (*)(void* dst, ptrdiff_t stride, int outer_thresh,
 using LoopFilterFuncs =
     LoopFilterFunc[kNumLoopFilterSizes][kNumLoopFilterTypes];
 
+// Batched loop filter function signature. Section 7.14.
+// Filters |num_segments| adjacent 4-pixel edge segments which share the same
+// filter size and thresholds. For horizontal edges the segments run to the
+// right of |dst|, for vertical edges they run downward. The thresholds are as
+// described for LoopFilterFunc. The result must match |num_segments| calls to
+// the corresponding LoopFilterFunc, each 4 pixels further along the edge.
+// These are optional; when an entry is nullptr the caller falls back to
+// LoopFilterFunc.
+using LoopFilterBatchFunc = void (*)(void* dst, ptrdiff_t stride,
+                                     int num_segments, int outer_thresh,
+                                     int inner_thresh, int hev_thresh);
+using LoopFilterBatchFuncs =
+    LoopFilterBatchFunc[kNumLoopFilterSizes][kNumLoopFilterTypes];
+
 // Cdef direction function signature. Section 7.15.2.
 // |src| is a pointer to the source block. Pixel size is determined by bitdepth
 // with |stride| given in bytes. |direction| and |variance| are output
@@ -886,6 +900,7 @@ struct Dsp {
   IntraEdgeUpsamplerFunc intra_edge_upsampler;
   IntraPredictorFuncs intra_predictors;
   InverseTransformAddFuncs inverse_transforms;
+  LoopFilterBatchFuncs loop_filter_batches;
   LoopFilterFuncs loop_filters;
   LoopRestorationFuncs loop_restorations;
   MaskBlendFuncs mask_blend;
@@ -935,6 +950,12 @@ namespace dsp_internal {
 //  NEON support is the only extension available for ARM and it is always
 //  required. Because of this restriction DSP_ENABLED_8BPP_NEON(func) is always
 //  true and can be omitted.
+#define DSP_ENABLED_8BPP_AVX512(func)  \
+  (LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS || \
+   LIBGAV1_Dsp8bpp_##func == LIBGAV1_CPU_AVX512)
+#define DSP_ENABLED_10BPP_AVX512(func) \
+  (LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS || \
+   LIBGAV1_Dsp10bpp_##func == LIBGAV1_CPU_AVX512)
 #define DSP_ENABLED_8BPP_AVX2(func)    \
   (LIBGAV1_ENABLE_ALL_DSP_FUNCTIONS || \
    LIBGAV1_Dsp8bpp_##func == LIBGAV1_CPU_AVX2)
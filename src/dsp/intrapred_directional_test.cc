@@ -188,6 +188,10 @@ class DirectionalIntraPredTest : public IntraPredTestBase<bitdepth, Pixel> {
       if ((GetCpuInfo() & kSSE4_1) != 0) {
         IntraPredDirectionalInit_SSE4_1();
       }
+    } else if (absl::StartsWith(test_case, "AVX2/")) {
+      if ((GetCpuInfo() & kAVX2) != 0) {
+        IntraPredDirectionalInit_AVX2();
+      }
     } else {
       FAIL() << "Unrecognized architecture prefix in test case name: "
              << test_case;
@@ -922,6 +926,10 @@ INSTANTIATE_TEST_SUITE_P(C, DirectionalIntraPredTest8bpp,
 INSTANTIATE_TEST_SUITE_P(SSE41, DirectionalIntraPredTest8bpp,
                          testing::ValuesIn(kTransformSizes));
 #endif  // LIBGAV1_ENABLE_SSE4_1
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, DirectionalIntraPredTest8bpp,
+                         testing::ValuesIn(kTransformSizes));
+#endif  // LIBGAV1_ENABLE_AVX2
 #if LIBGAV1_ENABLE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, DirectionalIntraPredTest8bpp,
                          testing::ValuesIn(kTransformSizes));
@@ -934,6 +942,10 @@ INSTANTIATE_TEST_SUITE_P(C, DirectionalIntraPredTest10bpp,
 INSTANTIATE_TEST_SUITE_P(SSE41, DirectionalIntraPredTest10bpp,
                          testing::ValuesIn(kTransformSizes));
 #endif  // LIBGAV1_ENABLE_SSE4_1
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, DirectionalIntraPredTest10bpp,
+                         testing::ValuesIn(kTransformSizes));
+#endif  // LIBGAV1_ENABLE_AVX2
 #if LIBGAV1_ENABLE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, DirectionalIntraPredTest10bpp,
                          testing::ValuesIn(kTransformSizes));
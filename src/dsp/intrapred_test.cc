@@ -156,6 +156,11 @@ class IntraPredTest : public IntraPredTestBase<bitdepth, Pixel> {
         IntraPredInit_SSE4_1();
         IntraPredSmoothInit_SSE4_1();
       }
+    } else if (absl::StartsWith(test_case, "AVX2/")) {
+      if ((GetCpuInfo() & kAVX2) != 0) {
+        IntraPredInit_AVX2();
+        IntraPredSmoothInit_AVX2();
+      }
     } else if (absl::StartsWith(test_case, "NEON/")) {
       IntraPredInit_NEON();
       IntraPredSmoothInit_NEON();
@@ -681,6 +686,10 @@ INSTANTIATE_TEST_SUITE_P(C, IntraPredTest8bpp,
 INSTANTIATE_TEST_SUITE_P(SSE41, IntraPredTest8bpp,
                          testing::ValuesIn(kTransformSizes));
 #endif  // LIBGAV1_ENABLE_SSE4_1
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, IntraPredTest8bpp,
+                         testing::ValuesIn(kTransformSizes));
+#endif  // LIBGAV1_ENABLE_AVX2
 #if LIBGAV1_ENABLE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, IntraPredTest8bpp,
                          testing::ValuesIn(kTransformSizes));
@@ -693,6 +702,10 @@ INSTANTIATE_TEST_SUITE_P(C, IntraPredTest10bpp,
 INSTANTIATE_TEST_SUITE_P(SSE41, IntraPredTest10bpp,
                          testing::ValuesIn(kTransformSizes));
 #endif  // LIBGAV1_ENABLE_SSE4_1
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, IntraPredTest10bpp,
+                         testing::ValuesIn(kTransformSizes));
+#endif  // LIBGAV1_ENABLE_AVX2
 #if LIBGAV1_ENABLE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, IntraPredTest10bpp,
                          testing::ValuesIn(kTransformSizes));
@@ -181,6 +181,27 @@ class InverseTransformTest
     } else if (absl::StartsWith(test_case, "SSE41/")) {
       if ((GetCpuInfo() & kSSE4_1) != 0) {
         InverseTransformInit_SSE4_1();
+        InverseTransformInit10bpp_SSE4_1();
+      }
+    } else if (absl::StartsWith(test_case, "AVX2/")) {
+      if ((GetCpuInfo() & kAVX2) != 0) {
+        // The avx2 versions only cover the larger dct sizes. Pair them with
+        // the sse4 versions so the remaining 1d transforms are exercised too.
+        InverseTransformInit_SSE4_1();
+        InverseTransformInit10bpp_SSE4_1();
+        InverseTransformInit_AVX2();
+        InverseTransformInit10bpp_AVX2();
+      }
+    } else if (absl::StartsWith(test_case, "AVX512/")) {
+      if ((GetCpuInfo() & kAVX512) != 0) {
+        // As with avx2, only the larger dct sizes have avx512 versions. Layer
+        // them over sse4 and avx2 so every 1d transform is covered.
+        InverseTransformInit_SSE4_1();
+        InverseTransformInit10bpp_SSE4_1();
+        InverseTransformInit_AVX2();
+        InverseTransformInit10bpp_AVX2();
+        InverseTransformInit_AVX512();
+        InverseTransformInit10bpp_AVX512();
       }
     } else if (absl::StartsWith(test_case, "NEON/")) {
       InverseTransformInit_NEON();
@@ -216,6 +237,7 @@ class InverseTransformTest
   // These tests modify inverse_transform_mem_.
   void TestRandomValues(int num_tests);
   void TestDcOnlyRandomValue(int num_tests);
+  void TestFourRowsRandomValues();
 
   Array2DView<DstPixel> base_frame_buffer_;
   Array2DView<DstPixel> cur_frame_buffer_;
@@ -487,6 +509,61 @@ void InverseTransformTest<bitdepth, Pixel, DstPixel>::TestDcOnlyRandomValue(
   }
 }
 
+// The decoder passes an |adjusted_tx_height| of 4 when only the first 4 rows
+// hold nonzero coefficients. The 32 and 64 point row transforms otherwise
+// only see 1 or a multiple of 8 rows from the other tests.
+template <int bitdepth, typename Pixel, typename DstPixel>
+void InverseTransformTest<bitdepth, Pixel,
+                          DstPixel>::TestFourRowsRandomValues() {
+  if (tx_size_1d_row_ < kTransform1dSize32) return;
+  const Transform1d row_transform = kTransform1dDct;
+  const Transform1d column_transform = kTransform1dDct;
+  if (base_inverse_transforms_[row_transform][tx_size_1d_row_][kRow] ==
+          nullptr ||
+      cur_inverse_transforms_[row_transform][tx_size_1d_row_][kRow] ==
+          nullptr ||
+      base_inverse_transforms_[column_transform][tx_size_1d_column_]
+                              [kColumn] == nullptr ||
+      cur_inverse_transforms_[column_transform][tx_size_1d_column_]
+                             [kColumn] == nullptr) {
+    return;
+  }
+
+  libvpx_test::ACMRandom rnd(libvpx_test::ACMRandom::DeterministicSeed());
+  constexpr int kAdjustedTxHeight = 4;
+  for (int n = 0; n < 100; ++n) {
+    inverse_transform_mem_.Reset(&rnd, block_width_, kAdjustedTxHeight);
+    memcpy(inverse_transform_mem_.base_residual, inverse_transform_mem_.ref_src,
+           sizeof(inverse_transform_mem_.ref_src));
+    memcpy(inverse_transform_mem_.cur_residual, inverse_transform_mem_.ref_src,
+           sizeof(inverse_transform_mem_.ref_src));
+
+    base_inverse_transforms_[row_transform][tx_size_1d_row_][kRow](
+        kTransformTypeDctDct, tx_size_, kAdjustedTxHeight,
+        inverse_transform_mem_.base_residual, 0, 0, &base_frame_buffer_);
+    cur_inverse_transforms_[row_transform][tx_size_1d_row_][kRow](
+        kTransformTypeDctDct, tx_size_, kAdjustedTxHeight,
+        inverse_transform_mem_.cur_residual, 0, 0, &cur_frame_buffer_);
+    base_inverse_transforms_[column_transform][tx_size_1d_column_][kColumn](
+        kTransformTypeDctDct, tx_size_, kAdjustedTxHeight,
+        inverse_transform_mem_.base_residual, 0, 0, &base_frame_buffer_);
+    cur_inverse_transforms_[column_transform][tx_size_1d_column_][kColumn](
+        kTransformTypeDctDct, tx_size_, kAdjustedTxHeight,
+        inverse_transform_mem_.cur_residual, 0, 0, &cur_frame_buffer_);
+
+    if (!test_utils::CompareBlocks(inverse_transform_mem_.base_frame,
+                                   inverse_transform_mem_.cur_frame,
+                                   block_width_, block_height_, kMaxBlockSize,
+                                   kMaxBlockSize, false)) {
+      ADD_FAILURE() << "Result from optimized version of "
+                    << ToString(static_cast<Transform1dSize>(tx_size_1d_row_))
+                    << " with 4 rows differs from reference in iteration #"
+                    << n;
+      break;
+    }
+  }
+}
+
 using InverseTransformTest8bpp = InverseTransformTest<8, int16_t, uint8_t>;
 
 TEST_P(InverseTransformTest8bpp, Random) { TestRandomValues(1); }
@@ -495,6 +572,8 @@ TEST_P(InverseTransformTest8bpp, DISABLED_Speed) { TestRandomValues(10000); }
 
 TEST_P(InverseTransformTest8bpp, DcRandom) { TestDcOnlyRandomValue(1); }
 
+TEST_P(InverseTransformTest8bpp, FourRowsRandom) { TestFourRowsRandomValues(); }
+
 constexpr TransformSize kTransformSizesAll[] = {
     kTransformSize4x4,   kTransformSize4x8,   kTransformSize4x16,
     kTransformSize8x4,   kTransformSize8x8,   kTransformSize8x16,
@@ -514,6 +593,14 @@ INSTANTIATE_TEST_SUITE_P(NEON, InverseTransformTest8bpp,
 INSTANTIATE_TEST_SUITE_P(SSE41, InverseTransformTest8bpp,
                          testing::ValuesIn(kTransformSizesAll));
 #endif
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, InverseTransformTest8bpp,
+                         testing::ValuesIn(kTransformSizesAll));
+#endif
+#if LIBGAV1_ENABLE_AVX512
+INSTANTIATE_TEST_SUITE_P(AVX512, InverseTransformTest8bpp,
+                         testing::ValuesIn(kTransformSizesAll));
+#endif
 
 #if LIBGAV1_MAX_BITDEPTH >= 10
 using InverseTransformTest10bpp = InverseTransformTest<10, int32_t, uint16_t>;
@@ -524,6 +611,10 @@ TEST_P(InverseTransformTest10bpp, DISABLED_Speed) { TestRandomValues(10000); }
 
 TEST_P(InverseTransformTest10bpp, DcRandom) { TestDcOnlyRandomValue(1); }
 
+TEST_P(InverseTransformTest10bpp, FourRowsRandom) {
+  TestFourRowsRandomValues();
+}
+
 INSTANTIATE_TEST_SUITE_P(C, InverseTransformTest10bpp,
                          testing::ValuesIn(kTransformSizesAll));
 
@@ -531,6 +622,18 @@ INSTANTIATE_TEST_SUITE_P(C, InverseTransformTest10bpp,
 INSTANTIATE_TEST_SUITE_P(NEON, InverseTransformTest10bpp,
                          testing::ValuesIn(kTransformSizesAll));
 #endif
+#if LIBGAV1_ENABLE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(SSE41, InverseTransformTest10bpp,
+                         testing::ValuesIn(kTransformSizesAll));
+#endif
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, InverseTransformTest10bpp,
+                         testing::ValuesIn(kTransformSizesAll));
+#endif
+#if LIBGAV1_ENABLE_AVX512
+INSTANTIATE_TEST_SUITE_P(AVX512, InverseTransformTest10bpp,
+                         testing::ValuesIn(kTransformSizesAll));
+#endif
 #endif  // LIBGAV1_MAX_BITDEPTH >= 10
 
 }  // namespace
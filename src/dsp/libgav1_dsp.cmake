@@ -76,13 +76,60 @@ list(APPEND libgav1_dsp_sources
 
 list(APPEND libgav1_dsp_sources_avx2
             ${libgav1_dsp_sources_avx2}
+            "${libgav1_source}/dsp/x86/average_blend_avx2.cc"
+            "${libgav1_source}/dsp/x86/average_blend_avx2.h"
             "${libgav1_source}/dsp/x86/cdef_avx2.cc"
             "${libgav1_source}/dsp/x86/cdef_avx2.h"
+            "${libgav1_source}/dsp/x86/convolve_10bit_avx2.cc"
+            "${libgav1_source}/dsp/x86/convolve_10bit_avx2.inc"
             "${libgav1_source}/dsp/x86/convolve_avx2.cc"
             "${libgav1_source}/dsp/x86/convolve_avx2.h"
+            "${libgav1_source}/dsp/x86/convolve_avx2.inc"
+            "${libgav1_source}/dsp/x86/distance_weighted_blend_avx2.cc"
+            "${libgav1_source}/dsp/x86/distance_weighted_blend_avx2.h"
+            "${libgav1_source}/dsp/x86/intrapred_avx2.cc"
+            "${libgav1_source}/dsp/x86/intrapred_avx2.h"
+            "${libgav1_source}/dsp/x86/intrapred_directional_avx2.cc"
+            "${libgav1_source}/dsp/x86/intrapred_directional_avx2.h"
+            "${libgav1_source}/dsp/x86/intrapred_smooth_avx2.cc"
+            "${libgav1_source}/dsp/x86/intrapred_smooth_avx2.h"
+            "${libgav1_source}/dsp/x86/inverse_transform_10bit_avx2.cc"
+            "${libgav1_source}/dsp/x86/inverse_transform_avx2.cc"
+            "${libgav1_source}/dsp/x86/inverse_transform_avx2.h"
+            "${libgav1_source}/dsp/x86/loop_filter_avx2.cc"
+            "${libgav1_source}/dsp/x86/loop_filter_avx2.h"
             "${libgav1_source}/dsp/x86/loop_restoration_10bit_avx2.cc"
             "${libgav1_source}/dsp/x86/loop_restoration_avx2.cc"
-            "${libgav1_source}/dsp/x86/loop_restoration_avx2.h")
+            "${libgav1_source}/dsp/x86/loop_restoration_avx2.h"
+            "${libgav1_source}/dsp/x86/mask_blend_avx2.cc"
+            "${libgav1_source}/dsp/x86/mask_blend_avx2.h"
+            "${libgav1_source}/dsp/x86/motion_field_projection_avx2.cc"
+            "${libgav1_source}/dsp/x86/motion_field_projection_avx2.h"
+            "${libgav1_source}/dsp/x86/motion_vector_search_avx2.cc"
+            "${libgav1_source}/dsp/x86/motion_vector_search_avx2.h"
+            "${libgav1_source}/dsp/x86/obmc_avx2.cc"
+            "${libgav1_source}/dsp/x86/obmc_avx2.h"
+            "${libgav1_source}/dsp/x86/warp_avx2.cc"
+            "${libgav1_source}/dsp/x86/warp_avx2.h"
+            "${libgav1_source}/dsp/x86/weight_mask_avx2.cc"
+            "${libgav1_source}/dsp/x86/weight_mask_avx2.h")
+
+list(APPEND libgav1_dsp_sources_avx512
+            ${libgav1_dsp_sources_avx512}
+            "${libgav1_source}/dsp/x86/cdef_avx512.cc"
+            "${libgav1_source}/dsp/x86/cdef_avx512.h"
+            "${libgav1_source}/dsp/x86/common_avx512.h"
+            "${libgav1_source}/dsp/x86/common_avx512.inc"
+            "${libgav1_source}/dsp/x86/convolve_10bit_avx512.cc"
+            "${libgav1_source}/dsp/x86/convolve_avx512.cc"
+            "${libgav1_source}/dsp/x86/convolve_avx512.h"
+            "${libgav1_source}/dsp/x86/inverse_transform_10bit_avx512.cc"
+            "${libgav1_source}/dsp/x86/inverse_transform_avx512.cc"
+            "${libgav1_source}/dsp/x86/inverse_transform_avx512.h"
+            "${libgav1_source}/dsp/x86/loop_restoration_10bit_avx512.cc"
+            "${libgav1_source}/dsp/x86/loop_restoration_avx512.cc"
+            "${libgav1_source}/dsp/x86/loop_restoration_avx512.h"
+            "${libgav1_source}/dsp/x86/loop_restoration_avx512.inc")
 
 list(APPEND libgav1_dsp_sources_neon
             ${libgav1_dsp_sources_neon}
@@ -140,6 +187,8 @@ list(APPEND libgav1_dsp_sources_sse4
             "${libgav1_source}/dsp/x86/common_sse4.h"
             "${libgav1_source}/dsp/x86/cdef_sse4.cc"
             "${libgav1_source}/dsp/x86/cdef_sse4.h"
+            "${libgav1_source}/dsp/x86/convolve_10bit_sse4.cc"
+            "${libgav1_source}/dsp/x86/convolve_10bit_sse4.inc"
             "${libgav1_source}/dsp/x86/convolve_sse4.cc"
             "${libgav1_source}/dsp/x86/convolve_sse4.h"
             "${libgav1_source}/dsp/x86/convolve_sse4.inc"
@@ -159,6 +208,7 @@ list(APPEND libgav1_dsp_sources_sse4
             "${libgav1_source}/dsp/x86/intrapred_sse4.h"
             "${libgav1_source}/dsp/x86/intrapred_smooth_sse4.cc"
             "${libgav1_source}/dsp/x86/intrapred_smooth_sse4.h"
+            "${libgav1_source}/dsp/x86/inverse_transform_10bit_sse4.cc"
             "${libgav1_source}/dsp/x86/inverse_transform_sse4.cc"
             "${libgav1_source}/dsp/x86/inverse_transform_sse4.h"
             "${libgav1_source}/dsp/x86/loop_filter_sse4.cc"
@@ -186,6 +236,7 @@ macro(libgav1_add_dsp_targets)
   unset(dsp_sources)
   list(APPEND dsp_sources ${libgav1_dsp_sources}
               ${libgav1_dsp_sources_neon}
+              ${libgav1_dsp_sources_avx512}
               ${libgav1_dsp_sources_avx2}
               ${libgav1_dsp_sources_sse4})
 
@@ -30,6 +30,7 @@
 // The order of includes is important as each tests for a superior version
 // before setting the base.
 // clang-format off
+#include "src/dsp/x86/loop_filter_avx2.h"
 #include "src/dsp/x86/loop_filter_sse4.h"
 // clang-format on
 
@@ -38,7 +39,8 @@
 namespace libgav1 {
 namespace dsp {
 
-// Initializes Dsp::loop_filters. This function is not thread-safe.
+// Initializes Dsp::loop_filters. Dsp::loop_filter_batches are left as nullptr
+// by the C implementation. This function is not thread-safe.
 void LoopFilterInit_C();
 
 }  // namespace dsp
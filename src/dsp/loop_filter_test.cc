@@ -341,6 +341,146 @@ INSTANTIATE_TEST_SUITE_P(NEON, LoopFilterTest10bpp,
 #endif
 #endif
 
+//------------------------------------------------------------------------------
+// Batched filters are compared against the C single segment filters applied
+// to each segment in turn.
+
+// Up to kMaxBatchSegments segments (64 pixels) along the edge with 8 pixels
+// on either side.
+constexpr int kMaxBatchSegments = 16;
+constexpr int kBatchBlockSize = 80;
+constexpr int kNumBatchTests = 5000;
+
+template <int bitdepth, typename Pixel>
+class LoopFilterBatchTest : public testing::TestWithParam<LoopFilterSize> {
+ public:
+  LoopFilterBatchTest() = default;
+  LoopFilterBatchTest(const LoopFilterBatchTest&) = delete;
+  LoopFilterBatchTest& operator=(const LoopFilterBatchTest&) = delete;
+  ~LoopFilterBatchTest() override = default;
+
+ protected:
+  void SetUp() override {
+    test_utils::ResetDspTable(bitdepth);
+    LoopFilterInit_C();
+
+    const Dsp* const dsp = GetDspTable(bitdepth);
+    ASSERT_NE(dsp, nullptr);
+    memcpy(base_loop_filters_, dsp->loop_filters[size_],
+           sizeof(base_loop_filters_));
+
+    const testing::TestInfo* const test_info =
+        testing::UnitTest::GetInstance()->current_test_info();
+    const char* const test_case = test_info->test_suite_name();
+    if (absl::StartsWith(test_case, "AVX2/")) {
+      if ((GetCpuInfo() & kAVX2) != 0) {
+        LoopFilterInit_AVX2();
+      }
+    } else {
+      FAIL() << "Unrecognized architecture prefix in test case name: "
+             << test_case;
+    }
+
+    memcpy(cur_loop_filter_batches_, dsp->loop_filter_batches[size_],
+           sizeof(cur_loop_filter_batches_));
+  }
+
+  // Fills |block| with a smooth gradient plus noise and an optional step
+  // across the edge so that all of the filter paths are exercised.
+  void InitBlock(Pixel* block, LoopFilterType type,
+                 libvpx_test::ACMRandom& rnd) const;
+  void TestRandomValues(int num_runs) const;
+
+  const LoopFilterSize size_ = GetParam();
+  LoopFilterFunc base_loop_filters_[kNumLoopFilterTypes];
+  LoopFilterBatchFunc cur_loop_filter_batches_[kNumLoopFilterTypes];
+};
+
+template <int bitdepth, typename Pixel>
+void LoopFilterBatchTest<bitdepth, Pixel>::InitBlock(
+    Pixel* const block, const LoopFilterType type,
+    libvpx_test::ACMRandom& rnd) const {
+  const int max_pixel = (1 << bitdepth) - 1;
+  const int shift = bitdepth - 8;
+  static constexpr int kNoise[] = {0, 1, 2, 4, 16, 255};
+  const int noise = (kNoise[rnd(6)] << shift) + 1;
+  const int step = static_cast<int>(rnd(32 << shift)) - (16 << shift);
+  const int slope_x = rnd(3);
+  const int slope_y = rnd(3);
+  const int base = rnd(max_pixel + 1);
+  for (int y = 0; y < kBatchBlockSize; ++y) {
+    for (int x = 0; x < kBatchBlockSize; ++x) {
+      const bool q_side =
+          (type == kLoopFilterTypeVertical) ? x >= 8 : y >= 8;
+      const int value = base + slope_x * x + slope_y * y + rnd(noise) +
+                        (q_side ? step : 0);
+      block[y * kBatchBlockSize + x] =
+          static_cast<Pixel>(std::max(std::min(value, max_pixel), 0));
+    }
+  }
+}
+
+template <int bitdepth, typename Pixel>
+void LoopFilterBatchTest<bitdepth, Pixel>::TestRandomValues(
+    const int num_runs) const {
+  for (int i = 0; i < kNumLoopFilterTypes; ++i) {
+    if (cur_loop_filter_batches_[i] == nullptr) continue;
+    const auto type = static_cast<LoopFilterType>(i);
+    libvpx_test::ACMRandom rnd(libvpx_test::ACMRandom::DeterministicSeed());
+    // Distance in pixels between the starts of neighboring segments.
+    const int segment_step =
+        (type == kLoopFilterTypeVertical) ? 4 * kBatchBlockSize : 4;
+    const ptrdiff_t stride = kBatchBlockSize * sizeof(Pixel);
+    for (int n = 0; n < num_runs; ++n) {
+      Pixel ref[kBatchBlockSize * kBatchBlockSize];
+      Pixel dst[kBatchBlockSize * kBatchBlockSize];
+      const int outer_thresh = rnd(3 * kMaxLoopFilterValue - 2) + 7;
+      const int inner_thresh = rnd(kMaxLoopFilterValue) + 1;
+      const int hev_thresh = rnd(kMaxLoopFilterValue + 1) >> 4;
+      const int num_segments = rnd(kMaxBatchSegments) + 1;
+      InitBlock(ref, type, rnd);
+      memcpy(dst, ref, sizeof(dst));
+
+      const int offset = 8 * kBatchBlockSize + 8;
+      for (int j = 0; j < num_segments; ++j) {
+        base_loop_filters_[i](ref + offset + j * segment_step, stride,
+                              outer_thresh, inner_thresh, hev_thresh);
+      }
+      cur_loop_filter_batches_[i](dst + offset, stride, num_segments,
+                                  outer_thresh, inner_thresh, hev_thresh);
+      ASSERT_TRUE(test_utils::CompareBlocks(ref, dst, kBatchBlockSize,
+                                            kBatchBlockSize, kBatchBlockSize,
+                                            kBatchBlockSize, false))
+          << ToString(size_) << "[" << ToString(type)
+          << "]: batch of " << num_segments << " segments doesn't match";
+    }
+  }
+}
+
+using LoopFilterBatchTest8bpp = LoopFilterBatchTest<8, uint8_t>;
+
+TEST_P(LoopFilterBatchTest8bpp, RandomValues) {
+  TestRandomValues(kNumBatchTests);
+}
+
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, LoopFilterBatchTest8bpp,
+                         testing::ValuesIn(kLoopFilterSizes));
+#endif
+
+#if LIBGAV1_MAX_BITDEPTH >= 10
+using LoopFilterBatchTest10bpp = LoopFilterBatchTest<10, uint16_t>;
+
+TEST_P(LoopFilterBatchTest10bpp, RandomValues) {
+  TestRandomValues(kNumBatchTests);
+}
+
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, LoopFilterBatchTest10bpp,
+                         testing::ValuesIn(kLoopFilterSizes));
+#endif
+#endif
+
 }  // namespace
 
 static std::ostream& operator<<(std::ostream& os, const LoopFilterSize size) {
@@ -72,6 +72,13 @@ class SelfGuidedFilterTest : public testing::TestWithParam<int>,
         LoopRestorationInit_AVX2();
 #if LIBGAV1_MAX_BITDEPTH >= 10
         LoopRestorationInit10bpp_AVX2();
+#endif
+      }
+    } else if (absl::StartsWith(test_case, "AVX512/")) {
+      if ((GetCpuInfo() & kAVX512) != 0) {
+        LoopRestorationInit_AVX512();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+        LoopRestorationInit10bpp_AVX512();
 #endif
       }
     } else if (absl::StartsWith(test_case, "SSE41/")) {
@@ -284,6 +291,10 @@ INSTANTIATE_TEST_SUITE_P(C, SelfGuidedFilterTest8bpp,
 INSTANTIATE_TEST_SUITE_P(AVX2, SelfGuidedFilterTest8bpp,
                          testing::ValuesIn(kUnitWidths));
 #endif
+#if LIBGAV1_ENABLE_AVX512
+INSTANTIATE_TEST_SUITE_P(AVX512, SelfGuidedFilterTest8bpp,
+                         testing::ValuesIn(kUnitWidths));
+#endif
 #if LIBGAV1_ENABLE_SSE4_1
 INSTANTIATE_TEST_SUITE_P(SSE41, SelfGuidedFilterTest8bpp,
                          testing::ValuesIn(kUnitWidths));
@@ -348,6 +359,13 @@ class WienerFilterTest : public testing::TestWithParam<int>,
         LoopRestorationInit_AVX2();
 #if LIBGAV1_MAX_BITDEPTH >= 10
         LoopRestorationInit10bpp_AVX2();
+#endif
+      }
+    } else if (absl::StartsWith(test_case, "AVX512/")) {
+      if ((GetCpuInfo() & kAVX512) != 0) {
+        LoopRestorationInit_AVX512();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+        LoopRestorationInit10bpp_AVX512();
 #endif
       }
     } else if (absl::StartsWith(test_case, "SSE41/")) {
@@ -591,6 +609,10 @@ INSTANTIATE_TEST_SUITE_P(C, WienerFilterTest8bpp,
 INSTANTIATE_TEST_SUITE_P(AVX2, WienerFilterTest8bpp,
                          testing::ValuesIn(kUnitWidths));
 #endif
+#if LIBGAV1_ENABLE_AVX512
+INSTANTIATE_TEST_SUITE_P(AVX512, WienerFilterTest8bpp,
+                         testing::ValuesIn(kUnitWidths));
+#endif
 #if LIBGAV1_ENABLE_SSE4_1
 INSTANTIATE_TEST_SUITE_P(SSE41, WienerFilterTest8bpp,
                          testing::ValuesIn(kUnitWidths));
@@ -622,6 +644,10 @@ INSTANTIATE_TEST_SUITE_P(C, WienerFilterTest10bpp,
 INSTANTIATE_TEST_SUITE_P(AVX2, WienerFilterTest10bpp,
                          testing::ValuesIn(kUnitWidths));
 #endif
+#if LIBGAV1_ENABLE_AVX512
+INSTANTIATE_TEST_SUITE_P(AVX512, WienerFilterTest10bpp,
+                         testing::ValuesIn(kUnitWidths));
+#endif
 #if LIBGAV1_ENABLE_SSE4_1
 INSTANTIATE_TEST_SUITE_P(SSE41, WienerFilterTest10bpp,
                          testing::ValuesIn(kUnitWidths));
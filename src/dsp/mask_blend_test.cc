@@ -210,6 +210,10 @@ class MaskBlendTest : public testing::TestWithParam<MaskBlendTestParam>,
       if ((GetCpuInfo() & kSSE4_1) != 0) {
         MaskBlendInit_SSE4_1();
       }
+    } else if (absl::StartsWith(test_case, "AVX2/")) {
+      if ((GetCpuInfo() & kAVX2) != 0) {
+        MaskBlendInit_AVX2();
+      }
     } else {
       FAIL() << "Unrecognized architecture prefix in test case name: "
              << test_case;
@@ -497,6 +501,10 @@ INSTANTIATE_TEST_SUITE_P(NEON, MaskBlendTest8bpp,
 INSTANTIATE_TEST_SUITE_P(SSE41, MaskBlendTest8bpp,
                          testing::ValuesIn(kMaskBlendTestParam));
 #endif
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, MaskBlendTest8bpp,
+                         testing::ValuesIn(kMaskBlendTestParam));
+#endif  // LIBGAV1_ENABLE_AVX2
 
 #if LIBGAV1_MAX_BITDEPTH >= 10
 using MaskBlendTest10bpp = MaskBlendTest<10, uint16_t>;
@@ -514,6 +522,10 @@ INSTANTIATE_TEST_SUITE_P(C, MaskBlendTest10bpp,
 INSTANTIATE_TEST_SUITE_P(SSE41, MaskBlendTest10bpp,
                          testing::ValuesIn(kMaskBlendTestParam));
 #endif
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, MaskBlendTest10bpp,
+                         testing::ValuesIn(kMaskBlendTestParam));
+#endif  // LIBGAV1_ENABLE_AVX2
 #if LIBGAV1_ENABLE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, MaskBlendTest10bpp,
                          testing::ValuesIn(kMaskBlendTestParam));
@@ -66,6 +66,10 @@ class MotionFieldProjectionTest : public testing::TestWithParam<int> {
       if ((GetCpuInfo() & kSSE4_1) != 0) {
         MotionFieldProjectionInit_SSE4_1();
       }
+    } else if (absl::StartsWith(test_case, "AVX2/")) {
+      if ((GetCpuInfo() & kAVX2) != 0) {
+        MotionFieldProjectionInit_AVX2();
+      }
     } else {
       FAIL() << "Unrecognized architecture prefix in test case name: "
              << test_case;
@@ -208,6 +212,10 @@ INSTANTIATE_TEST_SUITE_P(NEON, MotionFieldProjectionTest, testing::Values(0));
 INSTANTIATE_TEST_SUITE_P(SSE41, MotionFieldProjectionTest, testing::Values(0));
 #endif
 
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, MotionFieldProjectionTest, testing::Values(0));
+#endif  // LIBGAV1_ENABLE_AVX2
+
 }  // namespace
 }  // namespace dsp
 }  // namespace libgav1
@@ -58,6 +58,10 @@ class MotionVectorSearchTest : public testing::TestWithParam<int>,
       if ((GetCpuInfo() & kSSE4_1) != 0) {
         MotionVectorSearchInit_SSE4_1();
       }
+    } else if (absl::StartsWith(test_case, "AVX2/")) {
+      if ((GetCpuInfo() & kAVX2) != 0) {
+        MotionVectorSearchInit_AVX2();
+      }
     } else {
       FAIL() << "Unrecognized architecture prefix in test case name: "
              << test_case;
@@ -192,6 +196,10 @@ INSTANTIATE_TEST_SUITE_P(NEON, MotionVectorSearchTest, testing::Values(0));
 INSTANTIATE_TEST_SUITE_P(SSE41, MotionVectorSearchTest, testing::Values(0));
 #endif
 
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, MotionVectorSearchTest, testing::Values(0));
+#endif  // LIBGAV1_ENABLE_AVX2
+
 }  // namespace
 }  // namespace dsp
 }  // namespace libgav1
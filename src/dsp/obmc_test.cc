@@ -146,6 +146,10 @@ class ObmcBlendTest : public testing::TestWithParam<ObmcTestParam> {
       if ((GetCpuInfo() & kSSE4_1) != 0) {
         ObmcInit_SSE4_1();
       }
+    } else if (absl::StartsWith(test_case, "AVX2/")) {
+      if ((GetCpuInfo() & kAVX2) != 0) {
+        ObmcInit_AVX2();
+      }
     } else if (absl::StartsWith(test_case, "NEON/")) {
       ObmcInit_NEON();
     } else {
@@ -304,6 +308,10 @@ INSTANTIATE_TEST_SUITE_P(C, ObmcBlendTest8bpp,
 INSTANTIATE_TEST_SUITE_P(SSE41, ObmcBlendTest8bpp,
                          testing::ValuesIn(kObmcTestParam));
 #endif
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, ObmcBlendTest8bpp,
+                         testing::ValuesIn(kObmcTestParam));
+#endif  // LIBGAV1_ENABLE_AVX2
 
 #if LIBGAV1_ENABLE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, ObmcBlendTest8bpp,
@@ -332,6 +340,10 @@ INSTANTIATE_TEST_SUITE_P(C, ObmcBlendTest10bpp,
 INSTANTIATE_TEST_SUITE_P(SSE41, ObmcBlendTest10bpp,
                          testing::ValuesIn(kObmcTestParam));
 #endif
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, ObmcBlendTest10bpp,
+                         testing::ValuesIn(kObmcTestParam));
+#endif  // LIBGAV1_ENABLE_AVX2
 #if LIBGAV1_ENABLE_NEON
 INSTANTIATE_TEST_SUITE_P(NEON, ObmcBlendTest10bpp,
                          testing::ValuesIn(kObmcTestParam));
@@ -244,6 +244,10 @@ class WarpTest : public testing::TestWithParam<WarpTestParam> {
       WarpInit_NEON();
     } else if (absl::StartsWith(test_case, "SSE41/")) {
       WarpInit_SSE4_1();
+    } else if (absl::StartsWith(test_case, "AVX2/")) {
+      if ((GetCpuInfo() & kAVX2) != 0) {
+        WarpInit_AVX2();
+      }
     } else {
       FAIL() << "Unrecognized architecture prefix in test case name: "
              << test_case;
@@ -625,6 +629,11 @@ INSTANTIATE_TEST_SUITE_P(SSE41, WarpTest8bpp,
                          testing::ValuesIn(warp_test_param));
 #endif
 
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, WarpTest8bpp,
+                         testing::ValuesIn(warp_test_param));
+#endif
+
 #if LIBGAV1_MAX_BITDEPTH >= 10
 using WarpTest10bpp = WarpTest</*is_compound=*/false, 10, uint16_t>;
 // TODO(jzern): Coverage could be added for kInterRoundBitsCompoundVertical via
@@ -643,6 +652,16 @@ INSTANTIATE_TEST_SUITE_P(C, WarpTest10bpp, testing::ValuesIn(warp_test_param));
 INSTANTIATE_TEST_SUITE_P(NEON, WarpTest10bpp,
                          testing::ValuesIn(warp_test_param));
 #endif
+
+#if LIBGAV1_ENABLE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(SSE41, WarpTest10bpp,
+                         testing::ValuesIn(warp_test_param));
+#endif
+
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, WarpTest10bpp,
+                         testing::ValuesIn(warp_test_param));
+#endif
 #endif
 
 std::ostream& operator<<(std::ostream& os, const WarpTestParam& warp_param) {
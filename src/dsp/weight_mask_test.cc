@@ -177,6 +177,10 @@ class WeightMaskTest : public testing::TestWithParam<WeightMaskTestParam>,
       WeightMaskInit_NEON();
     } else if (absl::StartsWith(test_case, "SSE41/")) {
       WeightMaskInit_SSE4_1();
+    } else if (absl::StartsWith(test_case, "AVX2/")) {
+      if ((GetCpuInfo() & kAVX2) != 0) {
+        WeightMaskInit_AVX2();
+      }
     }
     func_ = dsp->weight_mask[width_index][height_index][mask_is_inverse_];
   }
@@ -354,6 +358,10 @@ INSTANTIATE_TEST_SUITE_P(NEON, WeightMaskTest8bpp,
 INSTANTIATE_TEST_SUITE_P(SSE41, WeightMaskTest8bpp,
                          testing::ValuesIn(weight_mask_test_param));
 #endif
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, WeightMaskTest8bpp,
+                         testing::ValuesIn(weight_mask_test_param));
+#endif  // LIBGAV1_ENABLE_AVX2
 
 #if LIBGAV1_MAX_BITDEPTH >= 10
 using WeightMaskTest10bpp = WeightMaskTest<10>;
@@ -383,6 +391,10 @@ INSTANTIATE_TEST_SUITE_P(NEON, WeightMaskTest10bpp,
 INSTANTIATE_TEST_SUITE_P(SSE41, WeightMaskTest10bpp,
                          testing::ValuesIn(weight_mask_test_param));
 #endif
+#if LIBGAV1_ENABLE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, WeightMaskTest10bpp,
+                         testing::ValuesIn(weight_mask_test_param));
+#endif  // LIBGAV1_ENABLE_AVX2
 #endif  // LIBGAV1_MAX_BITDEPTH >= 10
 
 }  // namespace
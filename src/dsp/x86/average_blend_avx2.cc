@@ -0,0 +1,252 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/average_blend.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/utils/common.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace low_bitdepth {
+namespace {
+
+constexpr int kInterPostRoundBit = 4;
+
+// The predictions are stored contiguously with a stride of |width|, so for
+// blocks narrower than 16 one vector covers several rows.
+inline __m256i AverageBlend16(const int16_t* LIBGAV1_RESTRICT prediction_0,
+                              const int16_t* LIBGAV1_RESTRICT prediction_1) {
+  const __m256i pred_0 = LoadUnaligned32(prediction_0);
+  const __m256i pred_1 = LoadUnaligned32(prediction_1);
+  const __m256i res = _mm256_add_epi16(pred_0, pred_1);
+  return RightShiftWithRounding_S16(res, kInterPostRoundBit + 1);
+}
+
+// Packs 16 results to 8 bits, preserving their order.
+inline __m128i PackResult16(const __m256i res) {
+  return _mm_packus_epi16(_mm256_castsi256_si128(res),
+                          _mm256_extracti128_si256(res, 1));
+}
+
+void AverageBlend_AVX2(const void* LIBGAV1_RESTRICT prediction_0,
+                       const void* LIBGAV1_RESTRICT prediction_1,
+                       const int width, const int height,
+                       void* LIBGAV1_RESTRICT const dest,
+                       const ptrdiff_t dest_stride) {
+  auto* dst = static_cast<uint8_t*>(dest);
+  const auto* pred_0 = static_cast<const int16_t*>(prediction_0);
+  const auto* pred_1 = static_cast<const int16_t*>(prediction_1);
+  int y = height;
+
+  if (width == 4) {
+    do {
+      const __m128i res = PackResult16(AverageBlend16(pred_0, pred_1));
+      Store4(dst, res);
+      Store4(dst + dest_stride, _mm_srli_si128(res, 4));
+      Store4(dst + 2 * dest_stride, _mm_srli_si128(res, 8));
+      Store4(dst + 3 * dest_stride, _mm_srli_si128(res, 12));
+      dst += dest_stride << 2;
+      pred_0 += 16;
+      pred_1 += 16;
+      y -= 4;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 8) {
+    do {
+      const __m128i res = PackResult16(AverageBlend16(pred_0, pred_1));
+      StoreLo8(dst, res);
+      StoreHi8(dst + dest_stride, res);
+      dst += dest_stride << 1;
+      pred_0 += 16;
+      pred_1 += 16;
+      y -= 2;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 16) {
+    do {
+      StoreUnaligned16(dst, PackResult16(AverageBlend16(pred_0, pred_1)));
+      dst += dest_stride;
+      pred_0 += 16;
+      pred_1 += 16;
+    } while (--y != 0);
+    return;
+  }
+
+  do {
+    int x = 0;
+    do {
+      const __m256i res_0 = AverageBlend16(pred_0 + x, pred_1 + x);
+      const __m256i res_1 = AverageBlend16(pred_0 + x + 16, pred_1 + x + 16);
+      const __m256i res = _mm256_packus_epi16(res_0, res_1);
+      StoreUnaligned32(dst + x, _mm256_permute4x64_epi64(res, 0xd8));
+      x += 32;
+    } while (x < width);
+    dst += dest_stride;
+    pred_0 += width;
+    pred_1 += width;
+  } while (--y != 0);
+}
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_8BPP_AVX2(AverageBlend)
+  dsp->average_blend = AverageBlend_AVX2;
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+constexpr int kInterPostRoundBitPlusOne = 5;
+
+// Computes
+//   Clip3(RightShiftWithRounding(pred_0 + pred_1 - 2 * kCompoundOffset, 5), 0,
+//         1023)
+// in 16-bit lanes. The unsigned sum may not fit in 16 bits, so it is halved
+// first with an average corrected for its rounding bit. 2 * kCompoundOffset is
+// a multiple of 32 and can be removed after the shift.
+inline __m256i AverageBlend16(const uint16_t* LIBGAV1_RESTRICT prediction_0,
+                              const uint16_t* LIBGAV1_RESTRICT prediction_1,
+                              const __m256i& one, const __m256i& round,
+                              const __m256i& compound_offset,
+                              const __m256i& zero, const __m256i& max) {
+  const __m256i pred_0 = LoadUnaligned32(prediction_0);
+  const __m256i pred_1 = LoadUnaligned32(prediction_1);
+  // (pred_0 + pred_1) >> 1.
+  const __m256i half_sum =
+      _mm256_sub_epi16(_mm256_avg_epu16(pred_0, pred_1),
+                       _mm256_and_si256(_mm256_xor_si256(pred_0, pred_1), one));
+  // Saturation only affects values that are clipped to |max| below.
+  const __m256i shifted = _mm256_srli_epi16(_mm256_adds_epu16(half_sum, round),
+                                            kInterPostRoundBitPlusOne - 1);
+  const __m256i res = _mm256_sub_epi16(shifted, compound_offset);
+  return _mm256_min_epi16(_mm256_max_epi16(res, zero), max);
+}
+
+void AverageBlend10bpp_AVX2(const void* LIBGAV1_RESTRICT prediction_0,
+                            const void* LIBGAV1_RESTRICT prediction_1,
+                            const int width, const int height,
+                            void* LIBGAV1_RESTRICT const dest,
+                            const ptrdiff_t dst_stride) {
+  auto* dst = static_cast<uint16_t*>(dest);
+  const ptrdiff_t dest_stride = dst_stride / sizeof(dst[0]);
+  const auto* pred_0 = static_cast<const uint16_t*>(prediction_0);
+  const auto* pred_1 = static_cast<const uint16_t*>(prediction_1);
+  const __m256i one = _mm256_set1_epi16(1);
+  const __m256i round =
+      _mm256_set1_epi16((1 << kInterPostRoundBitPlusOne) >> 2);
+  const __m256i compound_offset = _mm256_set1_epi16(
+      (kCompoundOffset + kCompoundOffset) >> kInterPostRoundBitPlusOne);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i max = _mm256_set1_epi16((1 << kBitdepth10) - 1);
+  int y = height;
+
+  if (width == 4) {
+    do {
+      const __m256i res = AverageBlend16(pred_0, pred_1, one, round,
+                                         compound_offset, zero, max);
+      const __m128i res_lo = _mm256_castsi256_si128(res);
+      const __m128i res_hi = _mm256_extracti128_si256(res, 1);
+      StoreLo8(dst, res_lo);
+      StoreHi8(dst + dest_stride, res_lo);
+      StoreLo8(dst + 2 * dest_stride, res_hi);
+      StoreHi8(dst + 3 * dest_stride, res_hi);
+      dst += dest_stride << 2;
+      pred_0 += 16;
+      pred_1 += 16;
+      y -= 4;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 8) {
+    do {
+      const __m256i res = AverageBlend16(pred_0, pred_1, one, round,
+                                         compound_offset, zero, max);
+      StoreUnaligned16(dst, _mm256_castsi256_si128(res));
+      StoreUnaligned16(dst + dest_stride, _mm256_extracti128_si256(res, 1));
+      dst += dest_stride << 1;
+      pred_0 += 16;
+      pred_1 += 16;
+      y -= 2;
+    } while (y != 0);
+    return;
+  }
+
+  do {
+    int x = 0;
+    do {
+      StoreUnaligned32(dst + x,
+                       AverageBlend16(pred_0 + x, pred_1 + x, one, round,
+                                      compound_offset, zero, max));
+      x += 16;
+    } while (x < width);
+    dst += dest_stride;
+    pred_0 += width;
+    pred_1 += width;
+  } while (--y != 0);
+}
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_10BPP_AVX2(AverageBlend)
+  dsp->average_blend = AverageBlend10bpp_AVX2;
+#endif
+}
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void AverageBlendInit_AVX2() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+}
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !LIBGAV1_TARGETING_AVX2
+
+namespace libgav1 {
+namespace dsp {
+
+void AverageBlendInit_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2
@@ -32,7 +32,6 @@
 
 namespace libgav1 {
 namespace dsp {
-namespace low_bitdepth {
 namespace {
 
 #include "src/dsp/cdef.inc"
@@ -269,8 +268,11 @@ LIBGAV1_ALWAYS_INLINE void AddPartial_D7_D5(__m256i* v_src, __m256i* partial_lo,
       _mm256_add_epi16(*partial_hi, _mm256_srli_si256(v_pair_add[3], 10));
 }
 
-LIBGAV1_ALWAYS_INLINE void AddPartial(const uint8_t* LIBGAV1_RESTRICT src,
+template <int bitdepth>
+LIBGAV1_ALWAYS_INLINE void AddPartial(const void* LIBGAV1_RESTRICT const source,
                                       ptrdiff_t stride, __m256i* partial) {
+  const auto* src = static_cast<const uint8_t*>(source);
+
   // 8x8 input
   // 00 01 02 03 04 05 06 07
   // 10 11 12 13 14 15 16 17
@@ -282,7 +284,15 @@ LIBGAV1_ALWAYS_INLINE void AddPartial(const uint8_t* LIBGAV1_RESTRICT src,
   // 70 71 72 73 74 75 76 77
   __m256i v_src[8];
   for (auto& i : v_src) {
-    i = _mm256_castsi128_si256(LoadLo8(src));
+    if (bitdepth == kBitdepth8) {
+      i = _mm256_castsi128_si256(LoadLo8(src));
+    } else {
+      // Reduce the input to 8 bits, matching (src[j] >> (bitdepth - 8)) in
+      // CdefDirection_C(). The results are packed into the low 8 bytes.
+      constexpr int src_shift = bitdepth - 8;
+      const __m128i v_src_16 = _mm_srli_epi16(LoadUnaligned16(src), src_shift);
+      i = _mm256_castsi128_si256(_mm_packus_epi16(v_src_16, v_src_16));
+    }
     // Dup lower lane.
     i = _mm256_permute2x128_si256(i, i, 0x0);
     src += stride;
@@ -451,6 +461,7 @@ inline void Cost2And6_Pair(uint32_t* cost, const __m256i partial_a,
   cost[6] = _mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
 }
 
+template <int bitdepth>
 void CdefDirection_AVX2(const void* LIBGAV1_RESTRICT const source,
                         ptrdiff_t stride,
                         uint8_t* LIBGAV1_RESTRICT const direction,
@@ -470,7 +481,7 @@ void CdefDirection_AVX2(const void* LIBGAV1_RESTRICT const source,
   // partial[7] = add partial 7,5 low
   __m256i partial[8];
 
-  AddPartial(src, stride, partial);
+  AddPartial<bitdepth>(src, stride, partial);
 
   const __m256i division_table = LoadUnaligned32(kCdefDivisionTable);
   const __m256i division_table_7 =
@@ -572,7 +583,29 @@ inline __m256i ApplyConstrainAndTap(const __m256i& pixel, const __m256i& val,
   return _mm256_mullo_epi16(constrained, tap);
 }
 
-template <int width, bool enable_primary = true, bool enable_secondary = true>
+template <typename Pixel, int width>
+inline void StorePixels(uint8_t* LIBGAV1_RESTRICT dst,
+                        const ptrdiff_t dst_stride, const __m128i result) {
+  if (sizeof(Pixel) == 1) {
+    const __m128i dst_pixel = _mm_packus_epi16(result, result);
+    if (width == 8) {
+      StoreLo8(dst, dst_pixel);
+    } else {
+      Store4(dst, dst_pixel);
+      Store4(dst + dst_stride, _mm_srli_si128(dst_pixel, 4));
+    }
+  } else {
+    if (width == 8) {
+      StoreUnaligned16(dst, result);
+    } else {
+      StoreLo8(dst, result);
+      StoreHi8(dst + dst_stride, result);
+    }
+  }
+}
+
+template <int width, typename Pixel, bool enable_primary = true,
+          bool enable_secondary = true>
 void CdefFilter_AVX2(const uint16_t* LIBGAV1_RESTRICT src,
                      const ptrdiff_t src_stride, const int height,
                      const int primary_strength, const int secondary_strength,
@@ -586,23 +619,33 @@ void CdefFilter_AVX2(const uint16_t* LIBGAV1_RESTRICT src,
 
   // FloorLog2() requires input to be > 0.
   // 8-bit damping range: Y: [3, 6], UV: [2, 5].
+  // 10-bit damping range: Y: [3, 6 + 2], UV: [2, 5 + 2].
   if (enable_primary) {
-    // primary_strength: [0, 15] -> FloorLog2: [0, 3] so a clamp is necessary
-    // for UV filtering.
+    // 8-bit primary_strength: [0, 15] -> FloorLog2: [0, 3] so a clamp is
+    // necessary for UV filtering.
+    // 10-bit primary_strength: [0, 15 << 2].
     primary_damping_shift =
         _mm_cvtsi32_si128(std::max(0, damping - FloorLog2(primary_strength)));
   }
   if (enable_secondary) {
-    // secondary_strength: [0, 4] -> FloorLog2: [0, 2] so no clamp to 0 is
-    // necessary.
-    assert(damping - FloorLog2(secondary_strength) >= 0);
-    secondary_damping_shift =
-        _mm_cvtsi32_si128(damping - FloorLog2(secondary_strength));
+    if (sizeof(Pixel) == 1) {
+      // secondary_strength: [0, 4] -> FloorLog2: [0, 2] so no clamp to 0 is
+      // necessary.
+      assert(damping - FloorLog2(secondary_strength) >= 0);
+      secondary_damping_shift =
+          _mm_cvtsi32_si128(damping - FloorLog2(secondary_strength));
+    } else {
+      // secondary_strength: [0, 4 << 2]
+      secondary_damping_shift = _mm_cvtsi32_si128(
+          std::max(0, damping - FloorLog2(secondary_strength)));
+    }
   }
+  constexpr int coeff_shift = (sizeof(Pixel) == 1) ? 0 : kBitdepth10 - 8;
+  const int primary_tap_index = (primary_strength >> coeff_shift) & 1;
   const __m256i primary_tap_0 = _mm256_broadcastw_epi16(
-      _mm_cvtsi32_si128(kCdefPrimaryTaps[primary_strength & 1][0]));
+      _mm_cvtsi32_si128(kCdefPrimaryTaps[primary_tap_index][0]));
   const __m256i primary_tap_1 = _mm256_broadcastw_epi16(
-      _mm_cvtsi32_si128(kCdefPrimaryTaps[primary_strength & 1][1]));
+      _mm_cvtsi32_si128(kCdefPrimaryTaps[primary_tap_index][1]));
   const __m256i secondary_tap_0 =
       _mm256_broadcastw_epi16(_mm_cvtsi32_si128(kCdefSecondaryTap0));
   const __m256i secondary_tap_1 =
@@ -646,13 +689,22 @@ void CdefFilter_AVX2(const uint16_t* LIBGAV1_RESTRICT src,
         min = _mm256_min_epu16(min, primary_val[0]);
         min = _mm256_min_epu16(min, primary_val[1]);
 
-        // The source is 16 bits, however, we only really care about the lower
-        // 8 bits.  The upper 8 bits contain the "large" flag.  After the final
-        // primary max has been calculated, zero out the upper 8 bits.  Use this
-        // to find the "16 bit" max.
-        const __m256i max_p01 = _mm256_max_epu8(primary_val[0], primary_val[1]);
-        max = _mm256_max_epu16(
-            max, _mm256_and_si256(max_p01, cdef_large_value_mask));
+        if (sizeof(Pixel) == 1) {
+          // The source is 16 bits, however, we only really care about the
+          // lower 8 bits.  The upper 8 bits contain the "large" flag.  After
+          // the final primary max has been calculated, zero out the upper 8
+          // bits.  Use this to find the "16 bit" max.
+          const __m256i max_p01 =
+              _mm256_max_epu8(primary_val[0], primary_val[1]);
+          max = _mm256_max_epu16(
+              max, _mm256_and_si256(max_p01, cdef_large_value_mask));
+        } else {
+          // Convert kCdefLargeValue to 0 before calculating max.
+          max = _mm256_max_epu16(
+              max, _mm256_and_si256(primary_val[0], cdef_large_value_mask));
+          max = _mm256_max_epu16(
+              max, _mm256_and_si256(primary_val[1], cdef_large_value_mask));
+        }
       }
 
       sum_pair = ApplyConstrainAndTap(pixel, primary_val[0], primary_tap_0,
@@ -688,13 +740,20 @@ void CdefFilter_AVX2(const uint16_t* LIBGAV1_RESTRICT src,
         min = _mm256_min_epu16(min, secondary_val[2]);
         min = _mm256_min_epu16(min, secondary_val[3]);
 
-        const __m256i max_s01 =
-            _mm256_max_epu8(secondary_val[0], secondary_val[1]);
-        const __m256i max_s23 =
-            _mm256_max_epu8(secondary_val[2], secondary_val[3]);
-        const __m256i max_s = _mm256_max_epu8(max_s01, max_s23);
-        max = _mm256_max_epu8(max,
-                              _mm256_and_si256(max_s, cdef_large_value_mask));
+        if (sizeof(Pixel) == 1) {
+          const __m256i max_s01 =
+              _mm256_max_epu8(secondary_val[0], secondary_val[1]);
+          const __m256i max_s23 =
+              _mm256_max_epu8(secondary_val[2], secondary_val[3]);
+          const __m256i max_s = _mm256_max_epu8(max_s01, max_s23);
+          max = _mm256_max_epu8(
+              max, _mm256_and_si256(max_s, cdef_large_value_mask));
+        } else {
+          for (const auto& val : secondary_val) {
+            max = _mm256_max_epu16(
+                max, _mm256_and_si256(val, cdef_large_value_mask));
+          }
+        }
       }
 
       sum_pair = _mm256_add_epi16(
@@ -738,42 +797,74 @@ void CdefFilter_AVX2(const uint16_t* LIBGAV1_RESTRICT src,
       sum = _mm_max_epi16(sum, min_128);
     }
 
-    const __m128i result = _mm_packus_epi16(sum, sum);
-    if (width == 8) {
-      src += src_stride;
-      StoreLo8(dst, result);
-      dst += dst_stride;
-      --y;
-    } else {
-      src += src_stride << 1;
-      Store4(dst, result);
-      dst += dst_stride;
-      Store4(dst, _mm_srli_si128(result, 4));
-      dst += dst_stride;
-      y -= 2;
-    }
+    StorePixels<Pixel, width>(dst, dst_stride, sum);
+
+    src += (width == 8) ? src_stride : src_stride << 1;
+    dst += (width == 8) ? dst_stride : dst_stride << 1;
+    y -= (width == 8) ? 1 : 2;
   } while (y != 0);
 }
 
+}  // namespace
+
+namespace low_bitdepth {
+namespace {
+
 void Init8bpp() {
-  Dsp* const dsp = dsp_internal::GetWritableDspTable(8);
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
   assert(dsp != nullptr);
-  dsp->cdef_direction = CdefDirection_AVX2;
+  dsp->cdef_direction = CdefDirection_AVX2<kBitdepth8>;
 
-  dsp->cdef_filters[0][0] = CdefFilter_AVX2<4>;
+  dsp->cdef_filters[0][0] = CdefFilter_AVX2<4, uint8_t>;
   dsp->cdef_filters[0][1] =
-      CdefFilter_AVX2<4, /*enable_primary=*/true, /*enable_secondary=*/false>;
-  dsp->cdef_filters[0][2] = CdefFilter_AVX2<4, /*enable_primary=*/false>;
-  dsp->cdef_filters[1][0] = CdefFilter_AVX2<8>;
+      CdefFilter_AVX2<4, uint8_t, /*enable_primary=*/true,
+                      /*enable_secondary=*/false>;
+  dsp->cdef_filters[0][2] =
+      CdefFilter_AVX2<4, uint8_t, /*enable_primary=*/false>;
+  dsp->cdef_filters[1][0] = CdefFilter_AVX2<8, uint8_t>;
   dsp->cdef_filters[1][1] =
-      CdefFilter_AVX2<8, /*enable_primary=*/true, /*enable_secondary=*/false>;
-  dsp->cdef_filters[1][2] = CdefFilter_AVX2<8, /*enable_primary=*/false>;
+      CdefFilter_AVX2<8, uint8_t, /*enable_primary=*/true,
+                      /*enable_secondary=*/false>;
+  dsp->cdef_filters[1][2] =
+      CdefFilter_AVX2<8, uint8_t, /*enable_primary=*/false>;
 }
 
 }  // namespace
 }  // namespace low_bitdepth
 
-void CdefInit_AVX2() { low_bitdepth::Init8bpp(); }
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+  dsp->cdef_direction = CdefDirection_AVX2<kBitdepth10>;
+
+  dsp->cdef_filters[0][0] = CdefFilter_AVX2<4, uint16_t>;
+  dsp->cdef_filters[0][1] =
+      CdefFilter_AVX2<4, uint16_t, /*enable_primary=*/true,
+                      /*enable_secondary=*/false>;
+  dsp->cdef_filters[0][2] =
+      CdefFilter_AVX2<4, uint16_t, /*enable_primary=*/false>;
+  dsp->cdef_filters[1][0] = CdefFilter_AVX2<8, uint16_t>;
+  dsp->cdef_filters[1][1] =
+      CdefFilter_AVX2<8, uint16_t, /*enable_primary=*/true,
+                      /*enable_secondary=*/false>;
+  dsp->cdef_filters[1][2] =
+      CdefFilter_AVX2<8, uint16_t, /*enable_primary=*/false>;
+}
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void CdefInit_AVX2() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif
+}
 
 }  // namespace dsp
 }  // namespace libgav1
@@ -0,0 +1,625 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/cdef.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX512
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx512.h"
+#include "src/utils/common.h"
+#include "src/utils/constants.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace {
+
+#include "src/dsp/cdef.inc"
+
+// -------------------------------------------------------------------------
+// CdefDirection
+//
+// Every partial sum of CdefDirection_C() has at most 15 entries and, with the
+// input reduced to 8 bits, each entry fits in 16 bits, so a 512-bit register
+// holds a pair of partial sums. The pixels of a row (or a group of summed
+// pixels) are scattered to their partial sum positions with a single masked
+// vpermw, replacing the shift and add ladders of the AVX2 version. As in
+// CdefDirection_AVX2(), the pixels are not offset by 128. This only adds the
+// same amount to all the costs.
+
+// Holds the weights of the odd directions. The costs of the odd directions are
+// the squared entries, multiplied by elements 1 3 5 7 7 7 7 7 5 3 1 of
+// |kCdefDivisionTable|.
+constexpr uint32_t kCdefDivisionTableOddPadded[16] = {
+    420, 210, 140, 105, 105, 105, 105, 105, 140, 210, 420, 0, 0, 0, 0, 0};
+
+// Directions 2 and 6 have 8 entries, all weighted with kCdefDivisionTable[7].
+constexpr uint32_t kCdefDivisionTable2And6Padded[16] = {
+    105, 105, 105, 105, 105, 105, 105, 105, 0, 0, 0, 0, 0, 0, 0, 0};
+
+// Base permutation indices of a pair of partial sums.
+constexpr int16_t kCdefDirectionIota[32] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+
+constexpr int16_t kCdefDirectionIotaX4[32] = {
+    0, 4, 8, 12, 16, 20, 24, 28, 32, 36, 40, 44, 48, 52, 56, 60,
+    0, 4, 8, 12, 16, 20, 24, 28, 32, 36, 40, 44, 48, 52, 56, 60};
+
+// Adds the elements of |src| selected by |base| + |offset_lo| to the lower
+// partial sum and those selected by |base| + |offset_hi| to the upper one.
+// |first_lo| and |first_hi| are the first of the 8 positions written in each
+// partial sum. The arguments are template parameters so the index vectors and
+// masks are compile time constants.
+template <int offset_lo, int offset_hi, int first_lo, int first_hi>
+inline __m512i AddPartialPair(const __m512i partial, const __m512i src,
+                              const __m512i base) {
+  const __m512i upper_half = _mm512_set_epi64(-1, -1, -1, -1, 0, 0, 0, 0);
+  const __m512i index = _mm512_add_epi16(
+      _mm512_add_epi16(base, _mm512_set1_epi16(offset_lo)),
+      _mm512_and_si512(upper_half, _mm512_set1_epi16(offset_hi - offset_lo)));
+  constexpr auto kMask = static_cast<__mmask32>((0xffu << first_lo) |
+                                                (0xffu << (16 + first_hi)));
+  return _mm512_add_epi16(partial,
+                          _mm512_maskz_permutexvar_epi16(kMask, index, src));
+}
+
+// partial[0][i + j] += x;
+// partial[4][7 + i - j] += x;
+// Adds row |i|, which is held in lane i & 3 of |rows|. partial[4] is stored
+// mirrored, i.e., partial[4][14 - k] is held in position k. This does not
+// change its cost.
+template <int i>
+inline __m512i AddPartial_D0_D4(const __m512i partial, const __m512i rows) {
+  constexpr int kRowOffset = 8 * (i & 3);
+  return AddPartialPair<kRowOffset - i, kRowOffset - 7 + i, i, 7 - i>(
+      partial, rows, LoadUnaligned64(kCdefDirectionIota));
+}
+
+// partial[1][i + j / 2] += x;
+// partial[3][3 + i - j / 2] += x;
+// Adds src[i][2 * k] + src[i][2 * k + 1] for all i. They are held in element
+// 4 * i + k of |pair_sums|.
+template <int k>
+inline __m512i AddPartial_D1_D3(const __m512i partial,
+                                const __m512i pair_sums) {
+  return AddPartialPair<-3 * k, 5 * k - 12, k, 3 - k>(
+      partial, pair_sums, LoadUnaligned64(kCdefDirectionIotaX4));
+}
+
+// partial[7][i / 2 + j] += x;
+// partial[5][3 - i / 2 + j] += x;
+// Adds src[2 * k][j] + src[2 * k + 1][j] for all j. They are held in element
+// 8 * k + j of |row_pair_sums|.
+template <int k>
+inline __m512i AddPartial_D7_D5(const __m512i partial,
+                                const __m512i row_pair_sums) {
+  return AddPartialPair<7 * k, 9 * k - 3, k, 3 - k>(
+      partial, row_pair_sums, LoadUnaligned64(kCdefDirectionIota));
+}
+
+// Squares the entries of the two partial sums in |partial|, weights them and
+// reduces each partial sum to 8 values.
+inline void CostPair(const __m512i partial, const __m512i division_table,
+                     __m256i* const cost_lo, __m256i* const cost_hi) {
+  __m512i lo = _mm512_cvtepu16_epi32(_mm512_castsi512_si256(partial));
+  __m512i hi = _mm512_cvtepu16_epi32(_mm512_extracti64x4_epi64(partial, 1));
+  // The entries are at most 8 * 255, the 16-bit multiply-add squares them
+  // exactly.
+  lo = _mm512_mullo_epi32(_mm512_madd_epi16(lo, lo), division_table);
+  hi = _mm512_mullo_epi32(_mm512_madd_epi16(hi, hi), division_table);
+  *cost_lo = _mm256_add_epi32(_mm512_castsi512_si256(lo),
+                              _mm512_extracti64x4_epi64(lo, 1));
+  *cost_hi = _mm256_add_epi32(_mm512_castsi512_si256(hi),
+                              _mm512_extracti64x4_epi64(hi, 1));
+}
+
+template <int bitdepth>
+void CdefDirection_AVX512(const void* LIBGAV1_RESTRICT const source,
+                          ptrdiff_t stride,
+                          uint8_t* LIBGAV1_RESTRICT const direction,
+                          int* LIBGAV1_RESTRICT const variance) {
+  assert(direction != nullptr);
+  assert(variance != nullptr);
+  const auto* src = static_cast<const uint8_t*>(source);
+
+  // Row i of the 8x8 input is held in the 8 bytes at 8 * i.
+  __m512i pixels;
+  if (bitdepth == kBitdepth8) {
+    pixels = SetrM128ix4(LoadHi8(LoadLo8(src), src + stride),
+                         LoadHi8(LoadLo8(src + 2 * stride), src + 3 * stride),
+                         LoadHi8(LoadLo8(src + 4 * stride), src + 5 * stride),
+                         LoadHi8(LoadLo8(src + 6 * stride), src + 7 * stride));
+  } else {
+    // Reduce the input to 8 bits, matching (src[j] >> (bitdepth - 8)) in
+    // CdefDirection_C().
+    constexpr int src_shift = bitdepth - 8;
+    const __m512i rows_0_3 = _mm512_srli_epi16(
+        SetrM128ix4(LoadUnaligned16(src), LoadUnaligned16(src + stride),
+                    LoadUnaligned16(src + 2 * stride),
+                    LoadUnaligned16(src + 3 * stride)),
+        src_shift);
+    const __m512i rows_4_7 = _mm512_srli_epi16(
+        SetrM128ix4(LoadUnaligned16(src + 4 * stride),
+                    LoadUnaligned16(src + 5 * stride),
+                    LoadUnaligned16(src + 6 * stride),
+                    LoadUnaligned16(src + 7 * stride)),
+        src_shift);
+    // The packed rows are ordered 0 4 1 5 2 6 3 7.
+    pixels = _mm512_permutexvar_epi64(_mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7),
+                                      _mm512_packus_epi16(rows_0_3, rows_4_7));
+  }
+  // Row i is held in lane i & 3 of |rows_0_3| or |rows_4_7|.
+  const __m512i rows_0_3 =
+      _mm512_cvtepu8_epi16(_mm512_castsi512_si256(pixels));
+  const __m512i rows_4_7 =
+      _mm512_cvtepu8_epi16(_mm512_extracti64x4_epi64(pixels, 1));
+
+  // partial[2][i] += x;
+  const __m128i partial_2 =
+      _mm512_cvtepi64_epi16(_mm512_sad_epu8(pixels, _mm512_setzero_si512()));
+  // partial[6][j] += x;
+  const __m512i column_sum = _mm512_add_epi16(rows_0_3, rows_4_7);
+  const __m256i column_sum_256 =
+      _mm256_add_epi16(_mm512_castsi512_si256(column_sum),
+                       _mm512_extracti64x4_epi64(column_sum, 1));
+  const __m128i partial_6 =
+      _mm_add_epi16(_mm256_castsi256_si128(column_sum_256),
+                    _mm256_extracti128_si256(column_sum_256, 1));
+  const __m128i zero = _mm_setzero_si128();
+  const __m512i partial_2_6 = SetrM128ix4(partial_2, zero, partial_6, zero);
+
+  __m512i partial_0_4 = _mm512_setzero_si512();
+  partial_0_4 = AddPartial_D0_D4<0>(partial_0_4, rows_0_3);
+  partial_0_4 = AddPartial_D0_D4<1>(partial_0_4, rows_0_3);
+  partial_0_4 = AddPartial_D0_D4<2>(partial_0_4, rows_0_3);
+  partial_0_4 = AddPartial_D0_D4<3>(partial_0_4, rows_0_3);
+  partial_0_4 = AddPartial_D0_D4<4>(partial_0_4, rows_4_7);
+  partial_0_4 = AddPartial_D0_D4<5>(partial_0_4, rows_4_7);
+  partial_0_4 = AddPartial_D0_D4<6>(partial_0_4, rows_4_7);
+  partial_0_4 = AddPartial_D0_D4<7>(partial_0_4, rows_4_7);
+
+  const __m512i pair_sums = _mm512_maddubs_epi16(pixels, _mm512_set1_epi8(1));
+  __m512i partial_1_3 = _mm512_setzero_si512();
+  partial_1_3 = AddPartial_D1_D3<0>(partial_1_3, pair_sums);
+  partial_1_3 = AddPartial_D1_D3<1>(partial_1_3, pair_sums);
+  partial_1_3 = AddPartial_D1_D3<2>(partial_1_3, pair_sums);
+  partial_1_3 = AddPartial_D1_D3<3>(partial_1_3, pair_sums);
+
+  const __m512i row_pair_sums = _mm512_add_epi16(
+      _mm512_shuffle_i64x2(rows_0_3, rows_4_7, _MM_SHUFFLE(2, 0, 2, 0)),
+      _mm512_shuffle_i64x2(rows_0_3, rows_4_7, _MM_SHUFFLE(3, 1, 3, 1)));
+  __m512i partial_7_5 = _mm512_setzero_si512();
+  partial_7_5 = AddPartial_D7_D5<0>(partial_7_5, row_pair_sums);
+  partial_7_5 = AddPartial_D7_D5<1>(partial_7_5, row_pair_sums);
+  partial_7_5 = AddPartial_D7_D5<2>(partial_7_5, row_pair_sums);
+  partial_7_5 = AddPartial_D7_D5<3>(partial_7_5, row_pair_sums);
+
+  __m256i costs[8];
+  CostPair(partial_0_4, LoadUnaligned64(kCdefDivisionTable), &costs[0],
+           &costs[4]);
+  CostPair(partial_1_3, LoadUnaligned64(kCdefDivisionTableOddPadded), &costs[1],
+           &costs[3]);
+  CostPair(partial_2_6, LoadUnaligned64(kCdefDivisionTable2And6Padded),
+           &costs[2], &costs[6]);
+  CostPair(partial_7_5, LoadUnaligned64(kCdefDivisionTableOddPadded), &costs[7],
+           &costs[5]);
+
+  // Transpose and sum the 8 values of each cost.
+  const __m256i sum_0_1 = _mm256_hadd_epi32(costs[0], costs[1]);
+  const __m256i sum_2_3 = _mm256_hadd_epi32(costs[2], costs[3]);
+  const __m256i sum_4_5 = _mm256_hadd_epi32(costs[4], costs[5]);
+  const __m256i sum_6_7 = _mm256_hadd_epi32(costs[6], costs[7]);
+  const __m256i sum_0_3 = _mm256_hadd_epi32(sum_0_1, sum_2_3);
+  const __m256i sum_4_7 = _mm256_hadd_epi32(sum_4_5, sum_6_7);
+  alignas(32) uint32_t cost[8];
+  StoreAligned32(cost,
+                 _mm256_add_epi32(_mm256_permute2x128_si256(sum_0_3, sum_4_7,
+                                                            0x20),
+                                  _mm256_permute2x128_si256(sum_0_3, sum_4_7,
+                                                            0x31)));
+
+  uint32_t best_cost = 0;
+  *direction = 0;
+  for (int i = 0; i < 8; ++i) {
+    if (cost[i] > best_cost) {
+      best_cost = cost[i];
+      *direction = i;
+    }
+  }
+  *variance = (best_cost - cost[(*direction + 4) & 7]) >> 10;
+}
+
+// -------------------------------------------------------------------------
+// CdefFilter
+//
+// Each 128-bit lane of a 512-bit register holds one row of an 8 wide block or
+// two rows of a 4 wide block, so a register covers 4 rows (width 8) or 8 rows
+// (width 4). Unlike the AVX2 version, which spreads the taps of a single row
+// across both 128-bit lanes, every tap is applied to all 32 pixels at once and
+// no horizontal reduction is needed.
+
+template <int width>
+inline __m128i LoadLane(const uint16_t* LIBGAV1_RESTRICT const src,
+                        const ptrdiff_t stride) {
+  if (width == 8) return LoadUnaligned16(src);
+  return LoadHi8(LoadLo8(src), src + stride);
+}
+
+// |upper_offset| is the distance to the rows held in lanes 2 and 3. It is 0
+// for 4x4 blocks, in which case the lower half is duplicated.
+template <int width>
+inline __m512i LoadLanes(const uint16_t* LIBGAV1_RESTRICT const src,
+                         const ptrdiff_t stride, const ptrdiff_t upper_offset) {
+  const ptrdiff_t lane_stride = (width == 8) ? stride : stride << 1;
+  return SetrM128ix4(LoadLane<width>(src, stride),
+                     LoadLane<width>(src + lane_stride, stride),
+                     LoadLane<width>(src + upper_offset, stride),
+                     LoadLane<width>(src + upper_offset + lane_stride, stride));
+}
+
+// Load 4 vectors based on the given |direction|. See LoadDirection() in
+// cdef_avx2.cc for the layout.
+template <int width>
+inline void LoadDirection(const uint16_t* LIBGAV1_RESTRICT const src,
+                          const ptrdiff_t stride, const ptrdiff_t upper_offset,
+                          __m512i* output, const int direction) {
+  const int y_0 = kCdefDirections[direction][0][0];
+  const int x_0 = kCdefDirections[direction][0][1];
+  const int y_1 = kCdefDirections[direction][1][0];
+  const int x_1 = kCdefDirections[direction][1][1];
+  output[0] = LoadLanes<width>(src - y_0 * stride - x_0, stride, upper_offset);
+  output[1] = LoadLanes<width>(src + y_0 * stride + x_0, stride, upper_offset);
+  output[2] = LoadLanes<width>(src - y_1 * stride - x_1, stride, upper_offset);
+  output[3] = LoadLanes<width>(src + y_1 * stride + x_1, stride, upper_offset);
+}
+
+inline __m512i Constrain(const __m512i& pixel, const __m512i& reference,
+                         const __m128i& damping, const __m512i& threshold) {
+  const __m512i diff = _mm512_sub_epi16(pixel, reference);
+  const __m512i abs_diff = _mm512_abs_epi16(diff);
+  // sign(diff) * Clip3(threshold - (std::abs(diff) >> damping),
+  //                    0, std::abs(diff))
+  const __m512i shifted_diff = _mm512_srl_epi16(abs_diff, damping);
+  // See Constrain() in cdef_avx2.cc for the handling of kCdefLargeValue.
+  static_assert(kCdefLargeValue == 0x4000, "Invalid kCdefLargeValue");
+  const __m512i thresh_minus_shifted_diff =
+      _mm512_subs_epu16(threshold, shifted_diff);
+  const __m512i clamp_abs_diff =
+      _mm512_min_epi16(thresh_minus_shifted_diff, abs_diff);
+  // Restore the sign. There is no 512-bit equivalent of _mm256_sign_epi16(),
+  // negate the lanes where |diff| is negative instead.
+  return _mm512_mask_sub_epi16(clamp_abs_diff, _mm512_movepi16_mask(diff),
+                               _mm512_setzero_si512(), clamp_abs_diff);
+}
+
+inline __m512i ApplyConstrainAndTap(const __m512i& pixel, const __m512i& val,
+                                    const __m512i& tap, const __m128i& damping,
+                                    const __m512i& threshold) {
+  const __m512i constrained = Constrain(val, pixel, damping, threshold);
+  return _mm512_mullo_epi16(constrained, tap);
+}
+
+// Stores |num_rows| rows. |num_rows| is 4 for width 8 and 4 or 8 for width 4.
+template <typename Pixel, int width>
+inline void StorePixels(uint8_t* LIBGAV1_RESTRICT dst,
+                        const ptrdiff_t dst_stride, const __m512i result,
+                        const int num_rows) {
+  if (sizeof(Pixel) == 1) {
+    // The results are in the range [0, 255], truncation is sufficient.
+    const __m256i dst_pixel = _mm512_cvtepi16_epi8(result);
+    const __m128i lo = _mm256_castsi256_si128(dst_pixel);
+    if (width == 8) {
+      const __m128i hi = _mm256_extracti128_si256(dst_pixel, 1);
+      StoreLo8(dst, lo);
+      StoreHi8(dst + dst_stride, lo);
+      StoreLo8(dst + 2 * dst_stride, hi);
+      StoreHi8(dst + 3 * dst_stride, hi);
+    } else {
+      Store4(dst, lo);
+      Store4(dst + dst_stride, _mm_srli_si128(lo, 4));
+      Store4(dst + 2 * dst_stride, _mm_srli_si128(lo, 8));
+      Store4(dst + 3 * dst_stride, _mm_srli_si128(lo, 12));
+      if (num_rows == 8) {
+        const __m128i hi = _mm256_extracti128_si256(dst_pixel, 1);
+        dst += 4 * dst_stride;
+        Store4(dst, hi);
+        Store4(dst + dst_stride, _mm_srli_si128(hi, 4));
+        Store4(dst + 2 * dst_stride, _mm_srli_si128(hi, 8));
+        Store4(dst + 3 * dst_stride, _mm_srli_si128(hi, 12));
+      }
+    }
+  } else {
+    const __m128i lane0 = _mm512_castsi512_si128(result);
+    const __m128i lane1 = _mm512_extracti32x4_epi32(result, 1);
+    if (width == 8) {
+      StoreUnaligned16(dst, lane0);
+      StoreUnaligned16(dst + dst_stride, lane1);
+      StoreUnaligned16(dst + 2 * dst_stride,
+                       _mm512_extracti32x4_epi32(result, 2));
+      StoreUnaligned16(dst + 3 * dst_stride,
+                       _mm512_extracti32x4_epi32(result, 3));
+    } else {
+      StoreLo8(dst, lane0);
+      StoreHi8(dst + dst_stride, lane0);
+      StoreLo8(dst + 2 * dst_stride, lane1);
+      StoreHi8(dst + 3 * dst_stride, lane1);
+      if (num_rows == 8) {
+        const __m128i lane2 = _mm512_extracti32x4_epi32(result, 2);
+        const __m128i lane3 = _mm512_extracti32x4_epi32(result, 3);
+        dst += 4 * dst_stride;
+        StoreLo8(dst, lane2);
+        StoreHi8(dst + dst_stride, lane2);
+        StoreLo8(dst + 2 * dst_stride, lane3);
+        StoreHi8(dst + 3 * dst_stride, lane3);
+      }
+    }
+  }
+}
+
+template <int width, typename Pixel, bool enable_primary = true,
+          bool enable_secondary = true>
+void CdefFilter_AVX512(const uint16_t* LIBGAV1_RESTRICT src,
+                       const ptrdiff_t src_stride, const int height,
+                       const int primary_strength, const int secondary_strength,
+                       const int damping, const int direction,
+                       void* LIBGAV1_RESTRICT dest, const ptrdiff_t dst_stride) {
+  static_assert(width == 8 || width == 4, "Invalid CDEF width.");
+  static_assert(enable_primary || enable_secondary, "");
+  assert(height % 4 == 0);
+  constexpr bool clipping_required = enable_primary && enable_secondary;
+  constexpr int kRowsPerLoop = (width == 8) ? 4 : 8;
+  auto* dst = static_cast<uint8_t*>(dest);
+  __m128i primary_damping_shift, secondary_damping_shift;
+
+  // See CdefFilter_AVX2() for the ranges of the damping shifts.
+  if (enable_primary) {
+    primary_damping_shift =
+        _mm_cvtsi32_si128(std::max(0, damping - FloorLog2(primary_strength)));
+  }
+  if (enable_secondary) {
+    if (sizeof(Pixel) == 1) {
+      assert(damping - FloorLog2(secondary_strength) >= 0);
+      secondary_damping_shift =
+          _mm_cvtsi32_si128(damping - FloorLog2(secondary_strength));
+    } else {
+      secondary_damping_shift = _mm_cvtsi32_si128(
+          std::max(0, damping - FloorLog2(secondary_strength)));
+    }
+  }
+  constexpr int coeff_shift = (sizeof(Pixel) == 1) ? 0 : kBitdepth10 - 8;
+  const int primary_tap_index = (primary_strength >> coeff_shift) & 1;
+  const __m512i primary_tap_0 =
+      _mm512_set1_epi16(kCdefPrimaryTaps[primary_tap_index][0]);
+  const __m512i primary_tap_1 =
+      _mm512_set1_epi16(kCdefPrimaryTaps[primary_tap_index][1]);
+  const __m512i secondary_tap_0 = _mm512_set1_epi16(kCdefSecondaryTap0);
+  const __m512i secondary_tap_1 = _mm512_set1_epi16(kCdefSecondaryTap1);
+  const __m512i cdef_large_value_mask =
+      _mm512_set1_epi16(static_cast<int16_t>(~kCdefLargeValue));
+  const __m512i primary_threshold = _mm512_set1_epi16(primary_strength);
+  const __m512i secondary_threshold = _mm512_set1_epi16(secondary_strength);
+
+  int y = height;
+  do {
+    const int num_rows = std::min(y, kRowsPerLoop);
+    const ptrdiff_t upper_offset =
+        (num_rows == kRowsPerLoop) ? src_stride * (kRowsPerLoop >> 1) : 0;
+    const __m512i pixel = LoadLanes<width>(src, src_stride, upper_offset);
+
+    __m512i min = pixel;
+    __m512i max = pixel;
+    __m512i sum;
+
+    if (enable_primary) {
+      // Primary |direction|.
+      __m512i primary_val[4];
+      LoadDirection<width>(src, src_stride, upper_offset, primary_val,
+                           direction);
+
+      if (clipping_required) {
+        min = _mm512_min_epu16(min, primary_val[0]);
+        min = _mm512_min_epu16(min, primary_val[1]);
+        min = _mm512_min_epu16(min, primary_val[2]);
+        min = _mm512_min_epu16(min, primary_val[3]);
+
+        if (sizeof(Pixel) == 1) {
+          // Only the lower 8 bits matter, the upper 8 bits hold the "large"
+          // flag which is cleared after the byte-wise max.
+          const __m512i max_p01 =
+              _mm512_max_epu8(primary_val[0], primary_val[1]);
+          const __m512i max_p23 =
+              _mm512_max_epu8(primary_val[2], primary_val[3]);
+          const __m512i max_p = _mm512_max_epu8(max_p01, max_p23);
+          max = _mm512_max_epu16(
+              max, _mm512_and_si512(max_p, cdef_large_value_mask));
+        } else {
+          // Convert kCdefLargeValue to 0 before calculating max.
+          for (const auto& val : primary_val) {
+            max = _mm512_max_epu16(
+                max, _mm512_and_si512(val, cdef_large_value_mask));
+          }
+        }
+      }
+
+      sum = ApplyConstrainAndTap(pixel, primary_val[0], primary_tap_0,
+                                 primary_damping_shift, primary_threshold);
+      sum = _mm512_add_epi16(
+          sum, ApplyConstrainAndTap(pixel, primary_val[1], primary_tap_0,
+                                    primary_damping_shift, primary_threshold));
+      sum = _mm512_add_epi16(
+          sum, ApplyConstrainAndTap(pixel, primary_val[2], primary_tap_1,
+                                    primary_damping_shift, primary_threshold));
+      sum = _mm512_add_epi16(
+          sum, ApplyConstrainAndTap(pixel, primary_val[3], primary_tap_1,
+                                    primary_damping_shift, primary_threshold));
+    } else {
+      sum = _mm512_setzero_si512();
+    }
+
+    if (enable_secondary) {
+      // Secondary |direction| values (+/- 2). Clamp |direction|.
+      __m512i secondary_val[8];
+      LoadDirection<width>(src, src_stride, upper_offset, secondary_val,
+                           direction + 2);
+      LoadDirection<width>(src, src_stride, upper_offset, secondary_val + 4,
+                           direction - 2);
+
+      if (clipping_required) {
+        for (const auto& val : secondary_val) {
+          min = _mm512_min_epu16(min, val);
+        }
+
+        if (sizeof(Pixel) == 1) {
+          const __m512i max_s01 =
+              _mm512_max_epu8(secondary_val[0], secondary_val[1]);
+          const __m512i max_s23 =
+              _mm512_max_epu8(secondary_val[2], secondary_val[3]);
+          const __m512i max_s45 =
+              _mm512_max_epu8(secondary_val[4], secondary_val[5]);
+          const __m512i max_s67 =
+              _mm512_max_epu8(secondary_val[6], secondary_val[7]);
+          const __m512i max_s = _mm512_max_epu8(
+              _mm512_max_epu8(max_s01, max_s23),
+              _mm512_max_epu8(max_s45, max_s67));
+          max = _mm512_max_epu8(
+              max, _mm512_and_si512(max_s, cdef_large_value_mask));
+        } else {
+          for (const auto& val : secondary_val) {
+            max = _mm512_max_epu16(
+                max, _mm512_and_si512(val, cdef_large_value_mask));
+          }
+        }
+      }
+
+      for (int i = 0; i < 8; i += 2) {
+        const __m512i& tap = (i & 2) ? secondary_tap_1 : secondary_tap_0;
+        sum = _mm512_add_epi16(
+            sum,
+            ApplyConstrainAndTap(pixel, secondary_val[i], tap,
+                                 secondary_damping_shift, secondary_threshold));
+        sum = _mm512_add_epi16(
+            sum, ApplyConstrainAndTap(pixel, secondary_val[i + 1], tap,
+                                      secondary_damping_shift,
+                                      secondary_threshold));
+      }
+    }
+
+    // Clip3(pixel + ((8 + sum - (sum < 0)) >> 4), min, max))
+    const __m512i sum_lt_0 = _mm512_srai_epi16(sum, 15);
+    // 8 + sum
+    sum = _mm512_add_epi16(sum, _mm512_set1_epi16(8));
+    // (... - (sum < 0)) >> 4
+    sum = _mm512_add_epi16(sum, sum_lt_0);
+    sum = _mm512_srai_epi16(sum, 4);
+    // pixel + ...
+    sum = _mm512_add_epi16(sum, pixel);
+    if (clipping_required) {
+      // Clip3
+      sum = _mm512_min_epi16(sum, max);
+      sum = _mm512_max_epi16(sum, min);
+    }
+
+    StorePixels<Pixel, width>(dst, dst_stride, sum, num_rows);
+
+    src += src_stride * num_rows;
+    dst += dst_stride * num_rows;
+    y -= num_rows;
+  } while (y != 0);
+}
+
+}  // namespace
+
+namespace low_bitdepth {
+namespace {
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_8BPP_AVX512(CdefDirection)
+  dsp->cdef_direction = CdefDirection_AVX512<kBitdepth8>;
+#endif
+#if DSP_ENABLED_8BPP_AVX512(CdefFilters)
+  dsp->cdef_filters[0][0] = CdefFilter_AVX512<4, uint8_t>;
+  dsp->cdef_filters[0][1] =
+      CdefFilter_AVX512<4, uint8_t, /*enable_primary=*/true,
+                        /*enable_secondary=*/false>;
+  dsp->cdef_filters[0][2] =
+      CdefFilter_AVX512<4, uint8_t, /*enable_primary=*/false>;
+  dsp->cdef_filters[1][0] = CdefFilter_AVX512<8, uint8_t>;
+  dsp->cdef_filters[1][1] =
+      CdefFilter_AVX512<8, uint8_t, /*enable_primary=*/true,
+                        /*enable_secondary=*/false>;
+  dsp->cdef_filters[1][2] =
+      CdefFilter_AVX512<8, uint8_t, /*enable_primary=*/false>;
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_10BPP_AVX512(CdefDirection)
+  dsp->cdef_direction = CdefDirection_AVX512<kBitdepth10>;
+#endif
+#if DSP_ENABLED_10BPP_AVX512(CdefFilters)
+  dsp->cdef_filters[0][0] = CdefFilter_AVX512<4, uint16_t>;
+  dsp->cdef_filters[0][1] =
+      CdefFilter_AVX512<4, uint16_t, /*enable_primary=*/true,
+                        /*enable_secondary=*/false>;
+  dsp->cdef_filters[0][2] =
+      CdefFilter_AVX512<4, uint16_t, /*enable_primary=*/false>;
+  dsp->cdef_filters[1][0] = CdefFilter_AVX512<8, uint16_t>;
+  dsp->cdef_filters[1][1] =
+      CdefFilter_AVX512<8, uint16_t, /*enable_primary=*/true,
+                        /*enable_secondary=*/false>;
+  dsp->cdef_filters[1][2] =
+      CdefFilter_AVX512<8, uint16_t, /*enable_primary=*/false>;
+#endif
+}
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void CdefInit_AVX512() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif
+}
+
+}  // namespace dsp
+}  // namespace libgav1
+#else   // !LIBGAV1_TARGETING_AVX512
+namespace libgav1 {
+namespace dsp {
+
+void CdefInit_AVX512() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX512
@@ -0,0 +1,287 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/convolve.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2 && LIBGAV1_MAX_BITDEPTH >= 10
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/utils/common.h"
+#include "src/utils/compiler_attributes.h"
+#include "src/utils/constants.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace {
+
+// The 128 bit versions are used for blocks narrower than 16 pixels.
+#include "src/dsp/x86/convolve_10bit_sse4.inc"
+// The 256 bit versions are used for blocks 16 pixels and wider.
+#include "src/dsp/x86/convolve_10bit_avx2.inc"
+
+template <int num_taps, bool is_2d, bool is_compound>
+LIBGAV1_ALWAYS_INLINE void DoHorizontalPass(
+    const uint16_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
+    void* LIBGAV1_RESTRICT const dst, const ptrdiff_t dst_stride,
+    const int width, const int height, const int8_t* const filter) {
+  // Use 256 bits for width > 8.
+  if (width > 8) {
+    __m256i v_tap[4];
+    SetupTaps10bpp<num_taps>(filter, v_tap);
+    FilterHorizontal16<num_taps, is_2d, is_compound>(
+        src + FirstTap(num_taps), src_stride, dst, dst_stride, width, height,
+        v_tap);
+    return;
+  }
+  __m128i v_tap[4];
+  SetupTaps10bpp<num_taps>(filter, v_tap);
+  FilterHorizontal<num_taps, is_2d, is_compound>(src + FirstTap(num_taps),
+                                                 src_stride, dst, dst_stride,
+                                                 width, height, v_tap);
+}
+
+// |src| points to the outermost tap of the first pixel, i.e., it has been
+// offset by kHorizontalOffset.
+template <bool is_2d = false, bool is_compound = false>
+LIBGAV1_ALWAYS_INLINE void DoHorizontalPass(
+    const uint16_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
+    void* LIBGAV1_RESTRICT const dst, const ptrdiff_t dst_stride,
+    const int width, const int height, const int filter_id,
+    const int filter_index) {
+  assert(filter_id != 0);
+  const int8_t* const filter = kHalfSubPixelFilters[filter_index][filter_id];
+  const int num_taps = GetNumTapsInFilter(filter_index);
+  if (num_taps == 8) {
+    DoHorizontalPass<8, is_2d, is_compound>(src, src_stride, dst, dst_stride,
+                                            width, height, filter);
+  } else if (num_taps == 6) {
+    DoHorizontalPass<6, is_2d, is_compound>(src, src_stride, dst, dst_stride,
+                                            width, height, filter);
+  } else if (num_taps == 4) {
+    DoHorizontalPass<4, is_2d, is_compound>(src, src_stride, dst, dst_stride,
+                                            width, height, filter);
+  } else {  // num_taps == 2
+    DoHorizontalPass<2, is_2d, is_compound>(src, src_stride, dst, dst_stride,
+                                            width, height, filter);
+  }
+}
+
+template <int num_taps, bool is_2d, bool is_compound>
+LIBGAV1_ALWAYS_INLINE void DoVerticalPass(
+    const uint16_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
+    void* LIBGAV1_RESTRICT const dst, const ptrdiff_t dst_stride,
+    const int width, const int height, const int8_t* const filter) {
+  // Use 256 bits for width > 8.
+  if (width > 8) {
+    __m256i v_tap[4];
+    SetupTaps10bpp<num_taps>(filter, v_tap);
+    FilterVertical16<num_taps, is_2d, is_compound>(src, src_stride, dst,
+                                                   dst_stride, width, height,
+                                                   v_tap);
+    return;
+  }
+  __m128i v_tap[4];
+  SetupTaps10bpp<num_taps>(filter, v_tap);
+  FilterVertical<num_taps, is_2d, is_compound>(src, src_stride, dst,
+                                               dst_stride, width, height,
+                                               v_tap);
+}
+
+// |src| points to the row of the first non-zero tap.
+template <bool is_2d = false, bool is_compound = false>
+LIBGAV1_ALWAYS_INLINE void DoVerticalPass(
+    const uint16_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
+    void* LIBGAV1_RESTRICT const dst, const ptrdiff_t dst_stride,
+    const int width, const int height, const int filter_id,
+    const int filter_index) {
+  assert(filter_id != 0);
+  const int8_t* const filter = kHalfSubPixelFilters[filter_index][filter_id];
+  const int num_taps = GetNumTapsInFilter(filter_index);
+  if (num_taps == 8) {
+    DoVerticalPass<8, is_2d, is_compound>(src, src_stride, dst, dst_stride,
+                                          width, height, filter);
+  } else if (num_taps == 6) {
+    DoVerticalPass<6, is_2d, is_compound>(src, src_stride, dst, dst_stride,
+                                          width, height, filter);
+  } else if (num_taps == 4) {
+    DoVerticalPass<4, is_2d, is_compound>(src, src_stride, dst, dst_stride,
+                                          width, height, filter);
+  } else {  // num_taps == 2
+    DoVerticalPass<2, is_2d, is_compound>(src, src_stride, dst, dst_stride,
+                                          width, height, filter);
+  }
+}
+
+void ConvolveHorizontal_AVX2(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int horizontal_filter_index,
+    const int /*vertical_filter_index*/, const int horizontal_filter_id,
+    const int /*vertical_filter_id*/, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t pred_stride) {
+  const int filter_index = GetFilterIndex(horizontal_filter_index, width);
+  // Set |src| to the outermost tap.
+  const auto* const src =
+      static_cast<const uint16_t*>(reference) - kHorizontalOffset;
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  const ptrdiff_t dest_stride = pred_stride >> 1;
+  DoHorizontalPass(src, src_stride, prediction, dest_stride, width, height,
+                   horizontal_filter_id, filter_index);
+}
+
+void ConvolveCompoundHorizontal_AVX2(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int horizontal_filter_index,
+    const int /*vertical_filter_index*/, const int horizontal_filter_id,
+    const int /*vertical_filter_id*/, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t /*pred_stride*/) {
+  const int filter_index = GetFilterIndex(horizontal_filter_index, width);
+  const auto* const src =
+      static_cast<const uint16_t*>(reference) - kHorizontalOffset;
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  DoHorizontalPass</*is_2d=*/false, /*is_compound=*/true>(
+      src, src_stride, prediction, width, width, height, horizontal_filter_id,
+      filter_index);
+}
+
+void ConvolveVertical_AVX2(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int /*horizontal_filter_index*/,
+    const int vertical_filter_index, const int /*horizontal_filter_id*/,
+    const int vertical_filter_id, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t pred_stride) {
+  const int filter_index = GetFilterIndex(vertical_filter_index, height);
+  const int vertical_taps = GetNumTapsInFilter(filter_index);
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  const auto* const src = static_cast<const uint16_t*>(reference) -
+                          (vertical_taps / 2 - 1) * src_stride;
+  const ptrdiff_t dest_stride = pred_stride >> 1;
+  DoVerticalPass(src, src_stride, prediction, dest_stride, width, height,
+                 vertical_filter_id, filter_index);
+}
+
+void ConvolveCompoundVertical_AVX2(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int /*horizontal_filter_index*/,
+    const int vertical_filter_index, const int /*horizontal_filter_id*/,
+    const int vertical_filter_id, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t /*pred_stride*/) {
+  const int filter_index = GetFilterIndex(vertical_filter_index, height);
+  const int vertical_taps = GetNumTapsInFilter(filter_index);
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  const auto* const src = static_cast<const uint16_t*>(reference) -
+                          (vertical_taps / 2 - 1) * src_stride;
+  DoVerticalPass</*is_2d=*/false, /*is_compound=*/true>(
+      src, src_stride, prediction, width, width, height, vertical_filter_id,
+      filter_index);
+}
+
+template <bool is_compound>
+void Convolve2D(const void* LIBGAV1_RESTRICT const reference,
+                const ptrdiff_t reference_stride,
+                const int horizontal_filter_index,
+                const int vertical_filter_index,
+                const int horizontal_filter_id, const int vertical_filter_id,
+                const int width, const int height,
+                void* LIBGAV1_RESTRICT const prediction,
+                const ptrdiff_t dest_stride) {
+  const int horiz_filter_index = GetFilterIndex(horizontal_filter_index, width);
+  const int vert_filter_index = GetFilterIndex(vertical_filter_index, height);
+  const int vertical_taps = GetNumTapsInFilter(vert_filter_index);
+  // The output of the horizontal filter is guaranteed to fit in 16 bits.
+  alignas(32) int16_t
+      intermediate_result[kMaxSuperBlockSizeInPixels *
+                          (kMaxSuperBlockSizeInPixels + kSubPixelTaps - 1)];
+#if LIBGAV1_MSAN
+  // Quiet msan warnings. Set with random non-zero value to aid in debugging.
+  memset(intermediate_result, 0x33, sizeof(intermediate_result));
+#endif
+  const int intermediate_height = height + vertical_taps - 1;
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  const auto* const src = static_cast<const uint16_t*>(reference) -
+                          (vertical_taps / 2 - 1) * src_stride -
+                          kHorizontalOffset;
+
+  DoHorizontalPass</*is_2d=*/true>(src, src_stride, intermediate_result, width,
+                                   width, intermediate_height,
+                                   horizontal_filter_id, horiz_filter_index);
+  DoVerticalPass</*is_2d=*/true, is_compound>(
+      reinterpret_cast<const uint16_t*>(intermediate_result), width,
+      prediction, dest_stride, width, height, vertical_filter_id,
+      vert_filter_index);
+}
+
+void Convolve2D_AVX2(const void* LIBGAV1_RESTRICT const reference,
+                     const ptrdiff_t reference_stride,
+                     const int horizontal_filter_index,
+                     const int vertical_filter_index,
+                     const int horizontal_filter_id,
+                     const int vertical_filter_id, const int width,
+                     const int height, void* LIBGAV1_RESTRICT const prediction,
+                     const ptrdiff_t pred_stride) {
+  Convolve2D</*is_compound=*/false>(
+      reference, reference_stride, horizontal_filter_index,
+      vertical_filter_index, horizontal_filter_id, vertical_filter_id, width,
+      height, prediction, pred_stride >> 1);
+}
+
+void ConvolveCompound2D_AVX2(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int horizontal_filter_index,
+    const int vertical_filter_index, const int horizontal_filter_id,
+    const int vertical_filter_id, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t /*pred_stride*/) {
+  Convolve2D</*is_compound=*/true>(reference, reference_stride,
+                                   horizontal_filter_index,
+                                   vertical_filter_index, horizontal_filter_id,
+                                   vertical_filter_id, width, height,
+                                   prediction, width);
+}
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+  dsp->convolve[0][0][0][1] = ConvolveHorizontal_AVX2;
+  dsp->convolve[0][0][1][0] = ConvolveVertical_AVX2;
+  dsp->convolve[0][0][1][1] = Convolve2D_AVX2;
+
+  dsp->convolve[0][1][0][1] = ConvolveCompoundHorizontal_AVX2;
+  dsp->convolve[0][1][1][0] = ConvolveCompoundVertical_AVX2;
+  dsp->convolve[0][1][1][1] = ConvolveCompound2D_AVX2;
+}
+
+}  // namespace
+
+void ConvolveInit10bpp_AVX2() { Init10bpp(); }
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !(LIBGAV1_TARGETING_AVX2 && LIBGAV1_MAX_BITDEPTH >= 10)
+namespace libgav1 {
+namespace dsp {
+
+void ConvolveInit10bpp_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2 && LIBGAV1_MAX_BITDEPTH >= 10
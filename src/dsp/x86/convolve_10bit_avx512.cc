@@ -0,0 +1,495 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/convolve.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX512 && LIBGAV1_MAX_BITDEPTH >= 10
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx512.h"
+#include "src/utils/common.h"
+#include "src/utils/compiler_attributes.h"
+#include "src/utils/constants.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace {
+
+// The 128 bit versions are used for blocks narrower than 16 pixels.
+#include "src/dsp/x86/convolve_10bit_sse4.inc"
+// The 256 bit versions are used for blocks 16 pixels wide.
+#include "src/dsp/x86/convolve_10bit_avx2.inc"
+
+// The 512 bit functions below mirror those in convolve_10bit_avx2.inc. The
+// rows are processed as four 128-bit lanes of 8 pixels.
+
+template <int num_taps>
+LIBGAV1_ALWAYS_INLINE void SetupTaps10bpp(
+    const int8_t* LIBGAV1_RESTRICT const filter, __m512i* const v_tap) {
+  __m128i v_tap_128[4];
+  SetupTaps10bpp<num_taps>(filter, v_tap_128);
+  for (int i = 0; i < num_taps / 2; ++i) {
+    v_tap[i] = _mm512_broadcast_i32x4(v_tap_128[i]);
+  }
+}
+
+// Returns the filter sums for 32 consecutive pixels starting at |src|, which
+// points to the first non-zero tap. In each lane |sum[0]| holds pixels 0-3 and
+// |sum[1]| pixels 4-7.
+template <int num_taps>
+LIBGAV1_ALWAYS_INLINE void SumHorizontalTaps32(
+    const uint16_t* LIBGAV1_RESTRICT const src, const __m512i* const v_tap,
+    __m512i sum[2]) {
+  const __m512i s0 = LoadUnaligned64(src);
+  const __m512i s8 = LoadUnaligned64(src + 8);
+  const __m512i s1 = _mm512_alignr_epi8(s8, s0, 2);
+  sum[0] = _mm512_madd_epi16(_mm512_unpacklo_epi16(s0, s1), v_tap[0]);
+  sum[1] = _mm512_madd_epi16(_mm512_unpackhi_epi16(s0, s1), v_tap[0]);
+  if (num_taps >= 4) {
+    const __m512i s2 = _mm512_alignr_epi8(s8, s0, 4);
+    const __m512i s3 = _mm512_alignr_epi8(s8, s0, 6);
+    sum[0] = _mm512_add_epi32(
+        sum[0], _mm512_madd_epi16(_mm512_unpacklo_epi16(s2, s3), v_tap[1]));
+    sum[1] = _mm512_add_epi32(
+        sum[1], _mm512_madd_epi16(_mm512_unpackhi_epi16(s2, s3), v_tap[1]));
+  }
+  if (num_taps >= 6) {
+    const __m512i s4 = _mm512_alignr_epi8(s8, s0, 8);
+    const __m512i s5 = _mm512_alignr_epi8(s8, s0, 10);
+    sum[0] = _mm512_add_epi32(
+        sum[0], _mm512_madd_epi16(_mm512_unpacklo_epi16(s4, s5), v_tap[2]));
+    sum[1] = _mm512_add_epi32(
+        sum[1], _mm512_madd_epi16(_mm512_unpackhi_epi16(s4, s5), v_tap[2]));
+  }
+  if (num_taps == 8) {
+    const __m512i s6 = _mm512_alignr_epi8(s8, s0, 12);
+    const __m512i s7 = _mm512_alignr_epi8(s8, s0, 14);
+    sum[0] = _mm512_add_epi32(
+        sum[0], _mm512_madd_epi16(_mm512_unpacklo_epi16(s6, s7), v_tap[3]));
+    sum[1] = _mm512_add_epi32(
+        sum[1], _mm512_madd_epi16(_mm512_unpackhi_epi16(s6, s7), v_tap[3]));
+  }
+}
+
+inline __m512i HorizontalRound2D(const __m512i sum_lo, const __m512i sum_hi) {
+  return _mm512_packs_epi32(
+      RightShiftWithRounding_S32(sum_lo, kInterRoundBitsHorizontal - 1),
+      RightShiftWithRounding_S32(sum_hi, kInterRoundBitsHorizontal - 1));
+}
+
+template <int round_bits>
+inline __m512i CompoundRound(const __m512i sum_lo, const __m512i sum_hi) {
+  const __m512i v_offset = _mm512_set1_epi32(kCompoundOffset);
+  const __m512i lo = _mm512_add_epi32(
+      RightShiftWithRounding_S32(sum_lo, round_bits), v_offset);
+  const __m512i hi = _mm512_add_epi32(
+      RightShiftWithRounding_S32(sum_hi, round_bits), v_offset);
+  return _mm512_packus_epi32(lo, hi);
+}
+
+template <int round_bits>
+inline __m512i PixelRound(const __m512i sum_lo, const __m512i sum_hi) {
+  const __m512i lo = RightShiftWithRounding_S32(sum_lo, round_bits);
+  const __m512i hi = RightShiftWithRounding_S32(sum_hi, round_bits);
+  return _mm512_min_epu16(_mm512_packus_epi32(lo, hi),
+                          _mm512_set1_epi16((1 << kBitdepth10) - 1));
+}
+
+inline __m512i HorizontalPixelRound(const __m512i sum_lo,
+                                    const __m512i sum_hi) {
+  const __m512i v_first_shift_rounding_bit =
+      _mm512_set1_epi32(1 << (kInterRoundBitsHorizontal - 2));
+  return PixelRound<kFilterBits - 1>(
+      _mm512_add_epi32(sum_lo, v_first_shift_rounding_bit),
+      _mm512_add_epi32(sum_hi, v_first_shift_rounding_bit));
+}
+
+template <bool is_2d, bool is_compound>
+inline __m512i VerticalRound(const __m512i sum_lo, const __m512i sum_hi) {
+  if (is_2d) {
+    if (is_compound) {
+      return CompoundRound<kInterRoundBitsCompoundVertical - 1>(sum_lo,
+                                                                sum_hi);
+    }
+    return PixelRound<kInterRoundBitsVertical - 1>(sum_lo, sum_hi);
+  }
+  if (is_compound) {
+    return CompoundRound<kInterRoundBitsHorizontal - 1>(sum_lo, sum_hi);
+  }
+  return PixelRound<kFilterBits - 1>(sum_lo, sum_hi);
+}
+
+// |width| must be a multiple of 32.
+template <int num_taps, bool is_2d = false, bool is_compound = false>
+void FilterHorizontal32(const uint16_t* LIBGAV1_RESTRICT src,
+                        const ptrdiff_t src_stride,
+                        void* LIBGAV1_RESTRICT const dest,
+                        const ptrdiff_t pred_stride, const int width,
+                        const int height, const __m512i* const v_tap) {
+  auto* dest16 = static_cast<uint16_t*>(dest);
+  int y = height;
+  do {
+    int x = 0;
+    do {
+      __m512i sum[2];
+      SumHorizontalTaps32<num_taps>(src + x, v_tap, sum);
+      __m512i result;
+      if (is_2d) {
+        result = HorizontalRound2D(sum[0], sum[1]);
+      } else if (is_compound) {
+        result = CompoundRound<kInterRoundBitsHorizontal - 1>(sum[0], sum[1]);
+      } else {
+        result = HorizontalPixelRound(sum[0], sum[1]);
+      }
+      StoreUnaligned64(dest16 + x, result);
+      x += 32;
+    } while (x < width);
+    src += src_stride;
+    dest16 += pred_stride;
+  } while (--y != 0);
+}
+
+// |width| must be a multiple of 32.
+template <int num_taps, bool is_2d = false, bool is_compound = false>
+void FilterVertical32(const uint16_t* LIBGAV1_RESTRICT const src,
+                      const ptrdiff_t src_stride,
+                      void* LIBGAV1_RESTRICT const dst,
+                      const ptrdiff_t dst_stride, const int width,
+                      const int height, const __m512i* const v_tap) {
+  auto* const dest16 = static_cast<uint16_t*>(dst);
+  __m512i srcs[num_taps];
+  int x = 0;
+  do {
+    const uint16_t* s = src + x;
+    uint16_t* d = dest16 + x;
+    for (int i = 0; i < num_taps - 1; ++i) {
+      srcs[i] = LoadUnaligned64(s);
+      s += src_stride;
+    }
+    int y = height;
+    do {
+      srcs[num_taps - 1] = LoadUnaligned64(s);
+      s += src_stride;
+      __m512i sum[2];
+      sum[0] =
+          _mm512_madd_epi16(_mm512_unpacklo_epi16(srcs[0], srcs[1]), v_tap[0]);
+      sum[1] =
+          _mm512_madd_epi16(_mm512_unpackhi_epi16(srcs[0], srcs[1]), v_tap[0]);
+      for (int i = 1; i < num_taps / 2; ++i) {
+        sum[0] = _mm512_add_epi32(
+            sum[0],
+            _mm512_madd_epi16(
+                _mm512_unpacklo_epi16(srcs[2 * i], srcs[2 * i + 1]),
+                v_tap[i]));
+        sum[1] = _mm512_add_epi32(
+            sum[1],
+            _mm512_madd_epi16(
+                _mm512_unpackhi_epi16(srcs[2 * i], srcs[2 * i + 1]),
+                v_tap[i]));
+      }
+      StoreUnaligned64(d, VerticalRound<is_2d, is_compound>(sum[0], sum[1]));
+      d += dst_stride;
+      for (int i = 0; i < num_taps - 1; ++i) {
+        srcs[i] = srcs[i + 1];
+      }
+    } while (--y != 0);
+    x += 32;
+  } while (x < width);
+}
+
+template <int num_taps, bool is_2d, bool is_compound>
+LIBGAV1_ALWAYS_INLINE void DoHorizontalPass(
+    const uint16_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
+    void* LIBGAV1_RESTRICT const dst, const ptrdiff_t dst_stride,
+    const int width, const int height, const int8_t* const filter) {
+  // Use 512 bits for width >= 32.
+  if (width >= 32) {
+    __m512i v_tap[4];
+    SetupTaps10bpp<num_taps>(filter, v_tap);
+    FilterHorizontal32<num_taps, is_2d, is_compound>(
+        src + FirstTap(num_taps), src_stride, dst, dst_stride, width, height,
+        v_tap);
+    return;
+  }
+  // Use 256 bits for width == 16.
+  if (width > 8) {
+    __m256i v_tap[4];
+    SetupTaps10bpp<num_taps>(filter, v_tap);
+    FilterHorizontal16<num_taps, is_2d, is_compound>(
+        src + FirstTap(num_taps), src_stride, dst, dst_stride, width, height,
+        v_tap);
+    return;
+  }
+  __m128i v_tap[4];
+  SetupTaps10bpp<num_taps>(filter, v_tap);
+  FilterHorizontal<num_taps, is_2d, is_compound>(src + FirstTap(num_taps),
+                                                 src_stride, dst, dst_stride,
+                                                 width, height, v_tap);
+}
+
+// |src| points to the outermost tap of the first pixel, i.e., it has been
+// offset by kHorizontalOffset.
+template <bool is_2d = false, bool is_compound = false>
+LIBGAV1_ALWAYS_INLINE void DoHorizontalPass(
+    const uint16_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
+    void* LIBGAV1_RESTRICT const dst, const ptrdiff_t dst_stride,
+    const int width, const int height, const int filter_id,
+    const int filter_index) {
+  assert(filter_id != 0);
+  const int8_t* const filter = kHalfSubPixelFilters[filter_index][filter_id];
+  const int num_taps = GetNumTapsInFilter(filter_index);
+  if (num_taps == 8) {
+    DoHorizontalPass<8, is_2d, is_compound>(src, src_stride, dst, dst_stride,
+                                            width, height, filter);
+  } else if (num_taps == 6) {
+    DoHorizontalPass<6, is_2d, is_compound>(src, src_stride, dst, dst_stride,
+                                            width, height, filter);
+  } else if (num_taps == 4) {
+    DoHorizontalPass<4, is_2d, is_compound>(src, src_stride, dst, dst_stride,
+                                            width, height, filter);
+  } else {  // num_taps == 2
+    DoHorizontalPass<2, is_2d, is_compound>(src, src_stride, dst, dst_stride,
+                                            width, height, filter);
+  }
+}
+
+template <int num_taps, bool is_2d, bool is_compound>
+LIBGAV1_ALWAYS_INLINE void DoVerticalPass(
+    const uint16_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
+    void* LIBGAV1_RESTRICT const dst, const ptrdiff_t dst_stride,
+    const int width, const int height, const int8_t* const filter) {
+  // Use 512 bits for width >= 32.
+  if (width >= 32) {
+    __m512i v_tap[4];
+    SetupTaps10bpp<num_taps>(filter, v_tap);
+    FilterVertical32<num_taps, is_2d, is_compound>(src, src_stride, dst,
+                                                   dst_stride, width, height,
+                                                   v_tap);
+    return;
+  }
+  // Use 256 bits for width == 16.
+  if (width > 8) {
+    __m256i v_tap[4];
+    SetupTaps10bpp<num_taps>(filter, v_tap);
+    FilterVertical16<num_taps, is_2d, is_compound>(src, src_stride, dst,
+                                                   dst_stride, width, height,
+                                                   v_tap);
+    return;
+  }
+  __m128i v_tap[4];
+  SetupTaps10bpp<num_taps>(filter, v_tap);
+  FilterVertical<num_taps, is_2d, is_compound>(src, src_stride, dst,
+                                               dst_stride, width, height,
+                                               v_tap);
+}
+
+// |src| points to the row of the first non-zero tap.
+template <bool is_2d = false, bool is_compound = false>
+LIBGAV1_ALWAYS_INLINE void DoVerticalPass(
+    const uint16_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
+    void* LIBGAV1_RESTRICT const dst, const ptrdiff_t dst_stride,
+    const int width, const int height, const int filter_id,
+    const int filter_index) {
+  assert(filter_id != 0);
+  const int8_t* const filter = kHalfSubPixelFilters[filter_index][filter_id];
+  const int num_taps = GetNumTapsInFilter(filter_index);
+  if (num_taps == 8) {
+    DoVerticalPass<8, is_2d, is_compound>(src, src_stride, dst, dst_stride,
+                                          width, height, filter);
+  } else if (num_taps == 6) {
+    DoVerticalPass<6, is_2d, is_compound>(src, src_stride, dst, dst_stride,
+                                          width, height, filter);
+  } else if (num_taps == 4) {
+    DoVerticalPass<4, is_2d, is_compound>(src, src_stride, dst, dst_stride,
+                                          width, height, filter);
+  } else {  // num_taps == 2
+    DoVerticalPass<2, is_2d, is_compound>(src, src_stride, dst, dst_stride,
+                                          width, height, filter);
+  }
+}
+
+void ConvolveHorizontal_AVX512(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int horizontal_filter_index,
+    const int /*vertical_filter_index*/, const int horizontal_filter_id,
+    const int /*vertical_filter_id*/, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t pred_stride) {
+  const int filter_index = GetFilterIndex(horizontal_filter_index, width);
+  // Set |src| to the outermost tap.
+  const auto* const src =
+      static_cast<const uint16_t*>(reference) - kHorizontalOffset;
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  const ptrdiff_t dest_stride = pred_stride >> 1;
+  DoHorizontalPass(src, src_stride, prediction, dest_stride, width, height,
+                   horizontal_filter_id, filter_index);
+}
+
+void ConvolveCompoundHorizontal_AVX512(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int horizontal_filter_index,
+    const int /*vertical_filter_index*/, const int horizontal_filter_id,
+    const int /*vertical_filter_id*/, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t /*pred_stride*/) {
+  const int filter_index = GetFilterIndex(horizontal_filter_index, width);
+  const auto* const src =
+      static_cast<const uint16_t*>(reference) - kHorizontalOffset;
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  DoHorizontalPass</*is_2d=*/false, /*is_compound=*/true>(
+      src, src_stride, prediction, width, width, height, horizontal_filter_id,
+      filter_index);
+}
+
+void ConvolveVertical_AVX512(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int /*horizontal_filter_index*/,
+    const int vertical_filter_index, const int /*horizontal_filter_id*/,
+    const int vertical_filter_id, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t pred_stride) {
+  const int filter_index = GetFilterIndex(vertical_filter_index, height);
+  const int vertical_taps = GetNumTapsInFilter(filter_index);
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  const auto* const src = static_cast<const uint16_t*>(reference) -
+                          (vertical_taps / 2 - 1) * src_stride;
+  const ptrdiff_t dest_stride = pred_stride >> 1;
+  DoVerticalPass(src, src_stride, prediction, dest_stride, width, height,
+                 vertical_filter_id, filter_index);
+}
+
+void ConvolveCompoundVertical_AVX512(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int /*horizontal_filter_index*/,
+    const int vertical_filter_index, const int /*horizontal_filter_id*/,
+    const int vertical_filter_id, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t /*pred_stride*/) {
+  const int filter_index = GetFilterIndex(vertical_filter_index, height);
+  const int vertical_taps = GetNumTapsInFilter(filter_index);
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  const auto* const src = static_cast<const uint16_t*>(reference) -
+                          (vertical_taps / 2 - 1) * src_stride;
+  DoVerticalPass</*is_2d=*/false, /*is_compound=*/true>(
+      src, src_stride, prediction, width, width, height, vertical_filter_id,
+      filter_index);
+}
+
+template <bool is_compound>
+void Convolve2D(const void* LIBGAV1_RESTRICT const reference,
+                const ptrdiff_t reference_stride,
+                const int horizontal_filter_index,
+                const int vertical_filter_index,
+                const int horizontal_filter_id, const int vertical_filter_id,
+                const int width, const int height,
+                void* LIBGAV1_RESTRICT const prediction,
+                const ptrdiff_t dest_stride) {
+  const int horiz_filter_index = GetFilterIndex(horizontal_filter_index, width);
+  const int vert_filter_index = GetFilterIndex(vertical_filter_index, height);
+  const int vertical_taps = GetNumTapsInFilter(vert_filter_index);
+  // The output of the horizontal filter is guaranteed to fit in 16 bits.
+  alignas(64) int16_t
+      intermediate_result[kMaxSuperBlockSizeInPixels *
+                          (kMaxSuperBlockSizeInPixels + kSubPixelTaps - 1)];
+#if LIBGAV1_MSAN
+  // Quiet msan warnings. Set with random non-zero value to aid in debugging.
+  memset(intermediate_result, 0x33, sizeof(intermediate_result));
+#endif
+  const int intermediate_height = height + vertical_taps - 1;
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  const auto* const src = static_cast<const uint16_t*>(reference) -
+                          (vertical_taps / 2 - 1) * src_stride -
+                          kHorizontalOffset;
+
+  DoHorizontalPass</*is_2d=*/true>(src, src_stride, intermediate_result, width,
+                                   width, intermediate_height,
+                                   horizontal_filter_id, horiz_filter_index);
+  DoVerticalPass</*is_2d=*/true, is_compound>(
+      reinterpret_cast<const uint16_t*>(intermediate_result), width,
+      prediction, dest_stride, width, height, vertical_filter_id,
+      vert_filter_index);
+}
+
+void Convolve2D_AVX512(const void* LIBGAV1_RESTRICT const reference,
+                       const ptrdiff_t reference_stride,
+                       const int horizontal_filter_index,
+                       const int vertical_filter_index,
+                       const int horizontal_filter_id,
+                       const int vertical_filter_id, const int width,
+                       const int height,
+                       void* LIBGAV1_RESTRICT const prediction,
+                       const ptrdiff_t pred_stride) {
+  Convolve2D</*is_compound=*/false>(
+      reference, reference_stride, horizontal_filter_index,
+      vertical_filter_index, horizontal_filter_id, vertical_filter_id, width,
+      height, prediction, pred_stride >> 1);
+}
+
+void ConvolveCompound2D_AVX512(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int horizontal_filter_index,
+    const int vertical_filter_index, const int horizontal_filter_id,
+    const int vertical_filter_id, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t /*pred_stride*/) {
+  Convolve2D</*is_compound=*/true>(reference, reference_stride,
+                                   horizontal_filter_index,
+                                   vertical_filter_index, horizontal_filter_id,
+                                   vertical_filter_id, width, height,
+                                   prediction, width);
+}
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_10BPP_AVX512(ConvolveHorizontal)
+  dsp->convolve[0][0][0][1] = ConvolveHorizontal_AVX512;
+#endif
+#if DSP_ENABLED_10BPP_AVX512(ConvolveVertical)
+  dsp->convolve[0][0][1][0] = ConvolveVertical_AVX512;
+#endif
+#if DSP_ENABLED_10BPP_AVX512(Convolve2D)
+  dsp->convolve[0][0][1][1] = Convolve2D_AVX512;
+#endif
+
+#if DSP_ENABLED_10BPP_AVX512(ConvolveCompoundHorizontal)
+  dsp->convolve[0][1][0][1] = ConvolveCompoundHorizontal_AVX512;
+#endif
+#if DSP_ENABLED_10BPP_AVX512(ConvolveCompoundVertical)
+  dsp->convolve[0][1][1][0] = ConvolveCompoundVertical_AVX512;
+#endif
+#if DSP_ENABLED_10BPP_AVX512(ConvolveCompound2D)
+  dsp->convolve[0][1][1][1] = ConvolveCompound2D_AVX512;
+#endif
+}
+
+}  // namespace
+
+void ConvolveInit10bpp_AVX512() { Init10bpp(); }
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !(LIBGAV1_TARGETING_AVX512 && LIBGAV1_MAX_BITDEPTH >= 10)
+namespace libgav1 {
+namespace dsp {
+
+void ConvolveInit10bpp_AVX512() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX512 && LIBGAV1_MAX_BITDEPTH >= 10
@@ -0,0 +1,577 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/convolve.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_SSE4_1 && LIBGAV1_MAX_BITDEPTH >= 10
+#include <smmintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_sse4.h"
+#include "src/utils/common.h"
+#include "src/utils/compiler_attributes.h"
+#include "src/utils/constants.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace {
+
+#include "src/dsp/x86/convolve_10bit_sse4.inc"
+
+// |src| points to the outermost tap of the first pixel, i.e., it has been
+// offset by kHorizontalOffset.
+template <bool is_2d = false, bool is_compound = false>
+LIBGAV1_ALWAYS_INLINE void DoHorizontalPass(
+    const uint16_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
+    void* LIBGAV1_RESTRICT const dst, const ptrdiff_t dst_stride,
+    const int width, const int height, const int filter_id,
+    const int filter_index) {
+  assert(filter_id != 0);
+  const int8_t* const filter = kHalfSubPixelFilters[filter_index][filter_id];
+  __m128i v_tap[4];
+  const int num_taps = GetNumTapsInFilter(filter_index);
+  if (num_taps == 8) {
+    SetupTaps10bpp<8>(filter, v_tap);
+    FilterHorizontal<8, is_2d, is_compound>(
+        src + FirstTap(8), src_stride, dst, dst_stride, width, height, v_tap);
+  } else if (num_taps == 6) {
+    SetupTaps10bpp<6>(filter, v_tap);
+    FilterHorizontal<6, is_2d, is_compound>(
+        src + FirstTap(6), src_stride, dst, dst_stride, width, height, v_tap);
+  } else if (num_taps == 4) {
+    SetupTaps10bpp<4>(filter, v_tap);
+    FilterHorizontal<4, is_2d, is_compound>(
+        src + FirstTap(4), src_stride, dst, dst_stride, width, height, v_tap);
+  } else {  // num_taps == 2
+    SetupTaps10bpp<2>(filter, v_tap);
+    FilterHorizontal<2, is_2d, is_compound>(
+        src + FirstTap(2), src_stride, dst, dst_stride, width, height, v_tap);
+  }
+}
+
+// |src| points to the row of the first non-zero tap.
+template <bool is_2d = false, bool is_compound = false>
+LIBGAV1_ALWAYS_INLINE void DoVerticalPass(
+    const uint16_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
+    void* LIBGAV1_RESTRICT const dst, const ptrdiff_t dst_stride,
+    const int width, const int height, const int filter_id,
+    const int filter_index) {
+  assert(filter_id != 0);
+  const int8_t* const filter = kHalfSubPixelFilters[filter_index][filter_id];
+  __m128i v_tap[4];
+  const int num_taps = GetNumTapsInFilter(filter_index);
+  if (num_taps == 8) {
+    SetupTaps10bpp<8>(filter, v_tap);
+    FilterVertical<8, is_2d, is_compound>(src, src_stride, dst, dst_stride,
+                                          width, height, v_tap);
+  } else if (num_taps == 6) {
+    SetupTaps10bpp<6>(filter, v_tap);
+    FilterVertical<6, is_2d, is_compound>(src, src_stride, dst, dst_stride,
+                                          width, height, v_tap);
+  } else if (num_taps == 4) {
+    SetupTaps10bpp<4>(filter, v_tap);
+    FilterVertical<4, is_2d, is_compound>(src, src_stride, dst, dst_stride,
+                                          width, height, v_tap);
+  } else {  // num_taps == 2
+    SetupTaps10bpp<2>(filter, v_tap);
+    FilterVertical<2, is_2d, is_compound>(src, src_stride, dst, dst_stride,
+                                          width, height, v_tap);
+  }
+}
+
+void ConvolveHorizontal_SSE4_1(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int horizontal_filter_index,
+    const int /*vertical_filter_index*/, const int horizontal_filter_id,
+    const int /*vertical_filter_id*/, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t pred_stride) {
+  const int filter_index = GetFilterIndex(horizontal_filter_index, width);
+  // Set |src| to the outermost tap.
+  const auto* const src =
+      static_cast<const uint16_t*>(reference) - kHorizontalOffset;
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  const ptrdiff_t dest_stride = pred_stride >> 1;
+  DoHorizontalPass(src, src_stride, prediction, dest_stride, width, height,
+                   horizontal_filter_id, filter_index);
+}
+
+void ConvolveCompoundHorizontal_SSE4_1(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int horizontal_filter_index,
+    const int /*vertical_filter_index*/, const int horizontal_filter_id,
+    const int /*vertical_filter_id*/, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t /*pred_stride*/) {
+  const int filter_index = GetFilterIndex(horizontal_filter_index, width);
+  const auto* const src =
+      static_cast<const uint16_t*>(reference) - kHorizontalOffset;
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  DoHorizontalPass</*is_2d=*/false, /*is_compound=*/true>(
+      src, src_stride, prediction, width, width, height, horizontal_filter_id,
+      filter_index);
+}
+
+void ConvolveVertical_SSE4_1(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int /*horizontal_filter_index*/,
+    const int vertical_filter_index, const int /*horizontal_filter_id*/,
+    const int vertical_filter_id, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t pred_stride) {
+  const int filter_index = GetFilterIndex(vertical_filter_index, height);
+  const int vertical_taps = GetNumTapsInFilter(filter_index);
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  const auto* const src = static_cast<const uint16_t*>(reference) -
+                          (vertical_taps / 2 - 1) * src_stride;
+  const ptrdiff_t dest_stride = pred_stride >> 1;
+  DoVerticalPass(src, src_stride, prediction, dest_stride, width, height,
+                 vertical_filter_id, filter_index);
+}
+
+void ConvolveCompoundVertical_SSE4_1(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int /*horizontal_filter_index*/,
+    const int vertical_filter_index, const int /*horizontal_filter_id*/,
+    const int vertical_filter_id, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t /*pred_stride*/) {
+  const int filter_index = GetFilterIndex(vertical_filter_index, height);
+  const int vertical_taps = GetNumTapsInFilter(filter_index);
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  const auto* const src = static_cast<const uint16_t*>(reference) -
+                          (vertical_taps / 2 - 1) * src_stride;
+  DoVerticalPass</*is_2d=*/false, /*is_compound=*/true>(
+      src, src_stride, prediction, width, width, height, vertical_filter_id,
+      filter_index);
+}
+
+template <bool is_compound>
+void Convolve2D(const void* LIBGAV1_RESTRICT const reference,
+                const ptrdiff_t reference_stride,
+                const int horizontal_filter_index,
+                const int vertical_filter_index,
+                const int horizontal_filter_id, const int vertical_filter_id,
+                const int width, const int height,
+                void* LIBGAV1_RESTRICT const prediction,
+                const ptrdiff_t dest_stride) {
+  const int horiz_filter_index = GetFilterIndex(horizontal_filter_index, width);
+  const int vert_filter_index = GetFilterIndex(vertical_filter_index, height);
+  const int vertical_taps = GetNumTapsInFilter(vert_filter_index);
+  // The output of the horizontal filter is guaranteed to fit in 16 bits.
+  alignas(16) int16_t
+      intermediate_result[kMaxSuperBlockSizeInPixels *
+                          (kMaxSuperBlockSizeInPixels + kSubPixelTaps - 1)];
+#if LIBGAV1_MSAN
+  // Quiet msan warnings. Set with random non-zero value to aid in debugging.
+  memset(intermediate_result, 0x33, sizeof(intermediate_result));
+#endif
+  const int intermediate_height = height + vertical_taps - 1;
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  const auto* const src = static_cast<const uint16_t*>(reference) -
+                          (vertical_taps / 2 - 1) * src_stride -
+                          kHorizontalOffset;
+
+  DoHorizontalPass</*is_2d=*/true>(src, src_stride, intermediate_result, width,
+                                   width, intermediate_height,
+                                   horizontal_filter_id, horiz_filter_index);
+  DoVerticalPass</*is_2d=*/true, is_compound>(
+      reinterpret_cast<const uint16_t*>(intermediate_result), width,
+      prediction, dest_stride, width, height, vertical_filter_id,
+      vert_filter_index);
+}
+
+void Convolve2D_SSE4_1(const void* LIBGAV1_RESTRICT const reference,
+                       const ptrdiff_t reference_stride,
+                       const int horizontal_filter_index,
+                       const int vertical_filter_index,
+                       const int horizontal_filter_id,
+                       const int vertical_filter_id, const int width,
+                       const int height, void* LIBGAV1_RESTRICT const prediction,
+                       const ptrdiff_t pred_stride) {
+  Convolve2D</*is_compound=*/false>(
+      reference, reference_stride, horizontal_filter_index,
+      vertical_filter_index, horizontal_filter_id, vertical_filter_id, width,
+      height, prediction, pred_stride >> 1);
+}
+
+void ConvolveCompound2D_SSE4_1(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int horizontal_filter_index,
+    const int vertical_filter_index, const int horizontal_filter_id,
+    const int vertical_filter_id, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t /*pred_stride*/) {
+  Convolve2D</*is_compound=*/true>(reference, reference_stride,
+                                   horizontal_filter_index,
+                                   vertical_filter_index, horizontal_filter_id,
+                                   vertical_filter_id, width, height,
+                                   prediction, width);
+}
+
+void ConvolveCompoundCopy_SSE4_1(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int /*horizontal_filter_index*/,
+    const int /*vertical_filter_index*/, const int /*horizontal_filter_id*/,
+    const int /*vertical_filter_id*/, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t /*pred_stride*/) {
+  // Compound functions start at 4x4.
+  assert(width >= 4 && height >= 4);
+  constexpr int kRoundBitsVertical =
+      kInterRoundBitsVertical - kInterRoundBitsCompoundVertical;
+  const __m128i v_offset =
+      _mm_set1_epi16((1 << kBitdepth10) + (1 << (kBitdepth10 - 1)));
+  const auto* src = static_cast<const uint16_t*>(reference);
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  auto* dest = static_cast<uint16_t*>(prediction);
+  int y = height;
+  if (width == 4) {
+    do {
+      const __m128i v_src = LoadLo8(src);
+      StoreLo8(dest, _mm_slli_epi16(_mm_add_epi16(v_src, v_offset),
+                                    kRoundBitsVertical));
+      src += src_stride;
+      dest += width;
+    } while (--y != 0);
+    return;
+  }
+  do {
+    int x = 0;
+    do {
+      const __m128i v_src = LoadUnaligned16(src + x);
+      StoreUnaligned16(dest + x,
+                       _mm_slli_epi16(_mm_add_epi16(v_src, v_offset),
+                                      kRoundBitsVertical));
+      x += 8;
+    } while (x < width);
+    src += src_stride;
+    dest += width;
+  } while (--y != 0);
+}
+
+// The filtering of intra block copy is the average of the current and the next
+// pixel, horizontally or vertically depending on |src_offset|.
+void IntraBlockCopy1D(const uint16_t* LIBGAV1_RESTRICT src,
+                      const ptrdiff_t src_stride, const ptrdiff_t src_offset,
+                      uint16_t* LIBGAV1_RESTRICT dest,
+                      const ptrdiff_t dest_stride, const int width,
+                      const int height) {
+  int y = height;
+  if (width == 4) {
+    do {
+      StoreLo8(dest, _mm_avg_epu16(LoadLo8(src), LoadLo8(src + src_offset)));
+      src += src_stride;
+      dest += dest_stride;
+    } while (--y != 0);
+    return;
+  }
+  do {
+    int x = 0;
+    do {
+      StoreUnaligned16(dest + x,
+                       _mm_avg_epu16(LoadUnaligned16(src + x),
+                                     LoadUnaligned16(src + x + src_offset)));
+      x += 8;
+    } while (x < width);
+    src += src_stride;
+    dest += dest_stride;
+  } while (--y != 0);
+}
+
+void ConvolveIntraBlockCopyHorizontal_SSE4_1(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int /*horizontal_filter_index*/,
+    const int /*vertical_filter_index*/, const int /*horizontal_filter_id*/,
+    const int /*vertical_filter_id*/, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t pred_stride) {
+  assert(width >= 4 && width <= kMaxSuperBlockSizeInPixels);
+  assert(height >= 4 && height <= kMaxSuperBlockSizeInPixels);
+  IntraBlockCopy1D(static_cast<const uint16_t*>(reference),
+                   reference_stride >> 1, /*src_offset=*/1,
+                   static_cast<uint16_t*>(prediction), pred_stride >> 1, width,
+                   height);
+}
+
+void ConvolveIntraBlockCopyVertical_SSE4_1(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int /*horizontal_filter_index*/,
+    const int /*vertical_filter_index*/, const int /*horizontal_filter_id*/,
+    const int /*vertical_filter_id*/, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t pred_stride) {
+  assert(width >= 4 && width <= kMaxSuperBlockSizeInPixels);
+  assert(height >= 4 && height <= kMaxSuperBlockSizeInPixels);
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  IntraBlockCopy1D(static_cast<const uint16_t*>(reference), src_stride,
+                   /*src_offset=*/src_stride,
+                   static_cast<uint16_t*>(prediction), pred_stride >> 1, width,
+                   height);
+}
+
+// Returns the rounded average of the 4 pixels formed by the sums of
+// horizontally adjacent pixels in |row0| and |row1|.
+inline __m128i IntraBlockCopy2DRound(const __m128i row0, const __m128i row1) {
+  return _mm_srli_epi16(
+      _mm_add_epi16(_mm_add_epi16(row0, row1), _mm_set1_epi16(2)), 2);
+}
+
+void ConvolveIntraBlockCopy2D_SSE4_1(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int /*horizontal_filter_index*/,
+    const int /*vertical_filter_index*/, const int /*horizontal_filter_id*/,
+    const int /*vertical_filter_id*/, const int width, const int height,
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t pred_stride) {
+  assert(width >= 4 && width <= kMaxSuperBlockSizeInPixels);
+  assert(height >= 4 && height <= kMaxSuperBlockSizeInPixels);
+  const auto* const src = static_cast<const uint16_t*>(reference);
+  const ptrdiff_t src_stride = reference_stride >> 1;
+  auto* const dest = static_cast<uint16_t*>(prediction);
+  const ptrdiff_t dest_stride = pred_stride >> 1;
+  // Note: allow vertical access to height + 1. Because this function is only
+  // for u/v plane of intra block copy, such access is guaranteed to be within
+  // the prediction block.
+  if (width == 4) {
+    const uint16_t* s = src;
+    uint16_t* d = dest;
+    __m128i row0 = _mm_add_epi16(LoadLo8(s), LoadLo8(s + 1));
+    int y = height;
+    do {
+      s += src_stride;
+      const __m128i row1 = _mm_add_epi16(LoadLo8(s), LoadLo8(s + 1));
+      StoreLo8(d, IntraBlockCopy2DRound(row0, row1));
+      row0 = row1;
+      d += dest_stride;
+    } while (--y != 0);
+    return;
+  }
+  int x = 0;
+  do {
+    const uint16_t* s = src + x;
+    uint16_t* d = dest + x;
+    __m128i row0 =
+        _mm_add_epi16(LoadUnaligned16(s), LoadUnaligned16(s + 1));
+    int y = height;
+    do {
+      s += src_stride;
+      const __m128i row1 =
+          _mm_add_epi16(LoadUnaligned16(s), LoadUnaligned16(s + 1));
+      StoreUnaligned16(d, IntraBlockCopy2DRound(row0, row1));
+      row0 = row1;
+      d += dest_stride;
+    } while (--y != 0);
+    x += 8;
+  } while (x < width);
+}
+
+// Applies the horizontal filter of the scaled convolution. The filter position
+// changes for every pixel but is constant over the rows, so the taps are
+// computed once per column. Each pixel applies all 8 taps with
+// _mm_madd_epi16() followed by horizontal adds.
+void ConvolveHorizontalScale(const uint16_t* LIBGAV1_RESTRICT src,
+                             const ptrdiff_t src_stride, const int width,
+                             const int subpixel_x, const int step_x,
+                             const int filter_index,
+                             const int intermediate_height,
+                             int16_t* LIBGAV1_RESTRICT intermediate) {
+  const int ref_x = subpixel_x >> kScaleSubPixelBits;
+  int offsets[kMaxSuperBlockSizeInPixels];
+  __m128i taps[kMaxSuperBlockSizeInPixels];
+  int p = subpixel_x;
+  for (int x = 0; x < width; ++x, p += step_x) {
+    offsets[x] = (p >> kScaleSubPixelBits) - ref_x;
+    const int filter_id = (p >> kFilterIndexShift) & kSubPixelMask;
+    taps[x] = _mm_cvtepi8_epi16(
+        LoadLo8(kHalfSubPixelFilters[filter_index][filter_id]));
+  }
+
+  int y = intermediate_height;
+  if (width == 2) {
+    do {
+      const __m128i sum0 =
+          _mm_madd_epi16(LoadUnaligned16(src + offsets[0]), taps[0]);
+      const __m128i sum1 =
+          _mm_madd_epi16(LoadUnaligned16(src + offsets[1]), taps[1]);
+      const __m128i sum01 = _mm_hadd_epi32(sum0, sum1);
+      const __m128i sum = _mm_hadd_epi32(sum01, sum01);
+      const __m128i result =
+          RightShiftWithRounding_S32(sum, kInterRoundBitsHorizontal - 1);
+      Store4(intermediate, _mm_packs_epi32(result, result));
+      src += src_stride;
+      intermediate += width;
+    } while (--y != 0);
+    return;
+  }
+
+  do {
+    int x = 0;
+    do {
+      const __m128i sum0 =
+          _mm_madd_epi16(LoadUnaligned16(src + offsets[x + 0]), taps[x + 0]);
+      const __m128i sum1 =
+          _mm_madd_epi16(LoadUnaligned16(src + offsets[x + 1]), taps[x + 1]);
+      const __m128i sum2 =
+          _mm_madd_epi16(LoadUnaligned16(src + offsets[x + 2]), taps[x + 2]);
+      const __m128i sum3 =
+          _mm_madd_epi16(LoadUnaligned16(src + offsets[x + 3]), taps[x + 3]);
+      const __m128i sum = _mm_hadd_epi32(_mm_hadd_epi32(sum0, sum1),
+                                         _mm_hadd_epi32(sum2, sum3));
+      const __m128i result =
+          RightShiftWithRounding_S32(sum, kInterRoundBitsHorizontal - 1);
+      StoreLo8(intermediate + x, _mm_packs_epi32(result, result));
+      x += 4;
+    } while (x < width);
+    src += src_stride;
+    intermediate += width;
+  } while (--y != 0);
+}
+
+// Applies the vertical filter of the scaled convolution. The filter is
+// constant across each row of |width| values.
+template <int num_taps, bool is_compound>
+void ConvolveVerticalScale(const int16_t* LIBGAV1_RESTRICT const intermediate,
+                           const int width, const int height,
+                           const int subpixel_y, const int step_y,
+                           const int filter_index,
+                           void* LIBGAV1_RESTRICT const prediction,
+                           const ptrdiff_t dest_stride) {
+  auto* dest = static_cast<uint16_t*>(prediction);
+  const auto* const src = reinterpret_cast<const uint16_t*>(intermediate);
+  __m128i v_tap[4];
+  __m128i srcs[num_taps];
+  int p = subpixel_y & 1023;
+  int y = height;
+  do {
+    const int filter_id = (p >> kFilterIndexShift) & kSubPixelMask;
+    SetupTaps10bpp<num_taps>(kHalfSubPixelFilters[filter_index][filter_id],
+                             v_tap);
+    const uint16_t* const rows =
+        src + ((p >> kScaleSubPixelBits) + FirstTap(num_taps)) * width;
+    if (width == 2) {
+      for (int i = 0; i < num_taps; ++i) srcs[i] = Load4(rows + i * width);
+      const __m128i sum = SumVerticalTaps4<num_taps>(srcs, v_tap);
+      Store4(dest, VerticalRound</*is_2d=*/true, is_compound>(sum, sum));
+    } else if (width == 4) {
+      for (int i = 0; i < num_taps; ++i) srcs[i] = LoadLo8(rows + i * width);
+      const __m128i sum = SumVerticalTaps4<num_taps>(srcs, v_tap);
+      StoreLo8(dest, VerticalRound</*is_2d=*/true, is_compound>(sum, sum));
+    } else {
+      int x = 0;
+      do {
+        for (int i = 0; i < num_taps; ++i) {
+          srcs[i] = LoadUnaligned16(rows + i * width + x);
+        }
+        __m128i sum[2];
+        SumVerticalTaps8<num_taps>(srcs, v_tap, sum);
+        StoreUnaligned16(
+            dest + x,
+            VerticalRound</*is_2d=*/true, is_compound>(sum[0], sum[1]));
+        x += 8;
+      } while (x < width);
+    }
+    dest += dest_stride;
+    p += step_y;
+  } while (--y != 0);
+}
+
+template <bool is_compound>
+void ConvolveScale2D_SSE4_1(const void* LIBGAV1_RESTRICT const reference,
+                            const ptrdiff_t reference_stride,
+                            const int horizontal_filter_index,
+                            const int vertical_filter_index,
+                            const int subpixel_x, const int subpixel_y,
+                            const int step_x, const int step_y, const int width,
+                            const int height,
+                            void* LIBGAV1_RESTRICT const prediction,
+                            const ptrdiff_t pred_stride) {
+  // Compound functions start at 4x4.
+  assert(!is_compound || (width >= 4 && height >= 4));
+  const int horiz_filter_index = GetFilterIndex(horizontal_filter_index, width);
+  const int vert_filter_index = GetFilterIndex(vertical_filter_index, height);
+  const int intermediate_height =
+      (((height - 1) * step_y + (1 << kScaleSubPixelBits) - 1) >>
+       kScaleSubPixelBits) +
+      kSubPixelTaps;
+  // The output of the horizontal filter is guaranteed to fit in 16 bits.
+  alignas(16) int16_t
+      intermediate_result[kMaxSuperBlockSizeInPixels *
+                          (2 * kMaxSuperBlockSizeInPixels + kSubPixelTaps)];
+#if LIBGAV1_MSAN
+  // Quiet msan warnings. Set with random non-zero value to aid in debugging.
+  memset(intermediate_result, 0x44, sizeof(intermediate_result));
+#endif
+  // Note: assume the input src is already aligned to the correct start
+  // position.
+  ConvolveHorizontalScale(static_cast<const uint16_t*>(reference),
+                          reference_stride >> 1, width, subpixel_x, step_x,
+                          horiz_filter_index, intermediate_height,
+                          intermediate_result);
+
+  const ptrdiff_t dest_stride = is_compound ? pred_stride : pred_stride >> 1;
+  const int vertical_taps = GetNumTapsInFilter(vert_filter_index);
+  if (vertical_taps == 8) {
+    ConvolveVerticalScale<8, is_compound>(
+        intermediate_result, width, height, subpixel_y, step_y,
+        vert_filter_index, prediction, dest_stride);
+  } else if (vertical_taps == 6) {
+    ConvolveVerticalScale<6, is_compound>(
+        intermediate_result, width, height, subpixel_y, step_y,
+        vert_filter_index, prediction, dest_stride);
+  } else if (vertical_taps == 4) {
+    ConvolveVerticalScale<4, is_compound>(
+        intermediate_result, width, height, subpixel_y, step_y,
+        vert_filter_index, prediction, dest_stride);
+  } else {  // vertical_taps == 2
+    ConvolveVerticalScale<2, is_compound>(
+        intermediate_result, width, height, subpixel_y, step_y,
+        vert_filter_index, prediction, dest_stride);
+  }
+}
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+  dsp->convolve[0][0][0][1] = ConvolveHorizontal_SSE4_1;
+  dsp->convolve[0][0][1][0] = ConvolveVertical_SSE4_1;
+  dsp->convolve[0][0][1][1] = Convolve2D_SSE4_1;
+
+  dsp->convolve[0][1][0][0] = ConvolveCompoundCopy_SSE4_1;
+  dsp->convolve[0][1][0][1] = ConvolveCompoundHorizontal_SSE4_1;
+  dsp->convolve[0][1][1][0] = ConvolveCompoundVertical_SSE4_1;
+  dsp->convolve[0][1][1][1] = ConvolveCompound2D_SSE4_1;
+
+  dsp->convolve[1][0][0][1] = ConvolveIntraBlockCopyHorizontal_SSE4_1;
+  dsp->convolve[1][0][1][0] = ConvolveIntraBlockCopyVertical_SSE4_1;
+  dsp->convolve[1][0][1][1] = ConvolveIntraBlockCopy2D_SSE4_1;
+
+  dsp->convolve_scale[0] = ConvolveScale2D_SSE4_1<false>;
+  dsp->convolve_scale[1] = ConvolveScale2D_SSE4_1<true>;
+}
+
+}  // namespace
+
+void ConvolveInit10bpp_SSE4_1() { Init10bpp(); }
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !(LIBGAV1_TARGETING_SSE4_1 && LIBGAV1_MAX_BITDEPTH >= 10)
+namespace libgav1 {
+namespace dsp {
+
+void ConvolveInit10bpp_SSE4_1() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_SSE4_1 && LIBGAV1_MAX_BITDEPTH >= 10
@@ -0,0 +1,707 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/convolve.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX512
+#include <immintrin.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx512.h"
+#include "src/utils/common.h"
+#include "src/utils/compiler_attributes.h"
+#include "src/utils/constants.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace low_bitdepth {
+namespace {
+
+// The 128 and 256 bit versions are used for blocks narrower than the 512 bit
+// paths below.
+#include "src/dsp/x86/convolve_sse4.inc"
+#include "src/dsp/x86/convolve_avx2.inc"
+
+// The 512 bit functions below mirror those in convolve_avx2.inc. The
+// _mm512_alignr_epi8(), _mm512_unpack*() and _mm512_pack*() instructions
+// operate within each 128-bit lane, so every lane is filtered exactly as in the
+// 256 bit code and only the loads and stores change.
+
+template <int filter_index>
+__m512i SumOnePassTaps(const __m512i* const src, const __m512i* const taps) {
+  __m512i sum;
+  if (filter_index < 2) {
+    // 6 taps.
+    const __m512i v_madd_21 = _mm512_maddubs_epi16(src[0], taps[0]);  // k2k1
+    const __m512i v_madd_43 = _mm512_maddubs_epi16(src[1], taps[1]);  // k4k3
+    const __m512i v_madd_65 = _mm512_maddubs_epi16(src[2], taps[2]);  // k6k5
+    sum = _mm512_add_epi16(v_madd_21, v_madd_43);
+    sum = _mm512_add_epi16(sum, v_madd_65);
+  } else if (filter_index == 2) {
+    // 8 taps.
+    const __m512i v_madd_10 = _mm512_maddubs_epi16(src[0], taps[0]);  // k1k0
+    const __m512i v_madd_32 = _mm512_maddubs_epi16(src[1], taps[1]);  // k3k2
+    const __m512i v_madd_54 = _mm512_maddubs_epi16(src[2], taps[2]);  // k5k4
+    const __m512i v_madd_76 = _mm512_maddubs_epi16(src[3], taps[3]);  // k7k6
+    const __m512i v_sum_3210 = _mm512_add_epi16(v_madd_10, v_madd_32);
+    const __m512i v_sum_7654 = _mm512_add_epi16(v_madd_54, v_madd_76);
+    sum = _mm512_add_epi16(v_sum_7654, v_sum_3210);
+  } else if (filter_index == 3) {
+    // 2 taps.
+    sum = _mm512_maddubs_epi16(src[0], taps[0]);  // k4k3
+  } else {
+    // 4 taps.
+    const __m512i v_madd_32 = _mm512_maddubs_epi16(src[0], taps[0]);  // k3k2
+    const __m512i v_madd_54 = _mm512_maddubs_epi16(src[1], taps[1]);  // k5k4
+    sum = _mm512_add_epi16(v_madd_32, v_madd_54);
+  }
+  return sum;
+}
+
+template <int filter_index>
+__m512i SumHorizontalTaps(const __m512i* const src,
+                          const __m512i* const v_tap) {
+  __m512i v_src[4];
+  const __m512i src_long = *src;
+  const __m512i src_long_dup_lo = _mm512_unpacklo_epi8(src_long, src_long);
+  const __m512i src_long_dup_hi = _mm512_unpackhi_epi8(src_long, src_long);
+
+  if (filter_index < 2) {
+    // 6 taps.
+    v_src[0] = _mm512_alignr_epi8(src_long_dup_hi, src_long_dup_lo, 3);   // _21
+    v_src[1] = _mm512_alignr_epi8(src_long_dup_hi, src_long_dup_lo, 7);   // _43
+    v_src[2] = _mm512_alignr_epi8(src_long_dup_hi, src_long_dup_lo, 11);  // _65
+  } else if (filter_index == 2) {
+    // 8 taps.
+    v_src[0] = _mm512_alignr_epi8(src_long_dup_hi, src_long_dup_lo, 1);   // _10
+    v_src[1] = _mm512_alignr_epi8(src_long_dup_hi, src_long_dup_lo, 5);   // _32
+    v_src[2] = _mm512_alignr_epi8(src_long_dup_hi, src_long_dup_lo, 9);   // _54
+    v_src[3] = _mm512_alignr_epi8(src_long_dup_hi, src_long_dup_lo, 13);  // _76
+  } else if (filter_index == 3) {
+    // 2 taps.
+    v_src[0] = _mm512_alignr_epi8(src_long_dup_hi, src_long_dup_lo, 7);  // _43
+  } else if (filter_index > 3) {
+    // 4 taps.
+    v_src[0] = _mm512_alignr_epi8(src_long_dup_hi, src_long_dup_lo, 5);  // _32
+    v_src[1] = _mm512_alignr_epi8(src_long_dup_hi, src_long_dup_lo, 9);  // _54
+  }
+  return SumOnePassTaps<filter_index>(v_src, v_tap);
+}
+
+template <int filter_index>
+__m512i SimpleHorizontalTaps(const __m512i* const src,
+                             const __m512i* const v_tap) {
+  __m512i sum = SumHorizontalTaps<filter_index>(src, v_tap);
+
+  // See the 256 bit version for the combined rounding.
+  constexpr int first_shift_rounding_bit = 1 << (kInterRoundBitsHorizontal - 2);
+
+  sum = _mm512_add_epi16(sum, _mm512_set1_epi16(first_shift_rounding_bit));
+  sum = RightShiftWithRounding_S16(sum, kFilterBits - 1);
+  return _mm512_packus_epi16(sum, sum);
+}
+
+template <int filter_index>
+__m512i HorizontalTaps8To16(const __m512i* const src,
+                            const __m512i* const v_tap) {
+  const __m512i sum = SumHorizontalTaps<filter_index>(src, v_tap);
+
+  return RightShiftWithRounding_S16(sum, kInterRoundBitsHorizontal - 1);
+}
+
+// Filter widths >= 32 for the 2d and compound passes and widths >= 64
+// otherwise.
+template <int filter_index, bool is_2d = false, bool is_compound = false>
+void FilterHorizontalWide(const uint8_t* LIBGAV1_RESTRICT src,
+                          const ptrdiff_t src_stride,
+                          void* LIBGAV1_RESTRICT const dest,
+                          const ptrdiff_t pred_stride, const int width,
+                          const int height, const __m512i* const v_tap) {
+  auto* dest8 = static_cast<uint8_t*>(dest);
+  auto* dest16 = static_cast<uint16_t*>(dest);
+
+  int y = height;
+  do {
+    if (is_2d || is_compound) {
+      assert(width >= 32);
+      int x = 0;
+      do {
+        // Load into 4 128 bit lanes.
+        const __m512i src_long = SetrM128ix4(
+            LoadUnaligned16(&src[x]), LoadUnaligned16(&src[x + 8]),
+            LoadUnaligned16(&src[x + 16]), LoadUnaligned16(&src[x + 24]));
+        const __m512i result =
+            HorizontalTaps8To16<filter_index>(&src_long, v_tap);
+        StoreUnaligned64(&dest16[x], result);
+        x += 32;
+      } while (x < width);
+    } else {
+      assert(width >= 64);
+      int x = 0;
+      do {
+        // Load src used to calculate dest8[16 * k + 7 : 16 * k] in lane k.
+        const __m512i src_long = LoadUnaligned64(&src[x]);
+        const __m512i result =
+            SimpleHorizontalTaps<filter_index>(&src_long, v_tap);
+        // Load src used to calculate dest8[16 * k + 15 : 16 * k + 8].
+        const __m512i src_long2 = LoadUnaligned64(&src[x + 8]);
+        const __m512i result2 =
+            SimpleHorizontalTaps<filter_index>(&src_long2, v_tap);
+        // Combine results and store.
+        StoreUnaligned64(&dest8[x], _mm512_unpacklo_epi64(result, result2));
+        x += 64;
+      } while (x < width);
+    }
+    src += src_stride;
+    dest8 += pred_stride;
+    dest16 += pred_stride;
+  } while (--y != 0);
+}
+
+template <int num_taps, bool is_2d_vertical = false>
+LIBGAV1_ALWAYS_INLINE void SetupTaps(const __m128i* const filter,
+                                     __m512i* v_tap) {
+  if (num_taps == 8) {
+    if (is_2d_vertical) {
+      v_tap[0] = _mm512_broadcastd_epi32(*filter);                      // k1k0
+      v_tap[1] = _mm512_broadcastd_epi32(_mm_srli_si128(*filter, 4));   // k3k2
+      v_tap[2] = _mm512_broadcastd_epi32(_mm_srli_si128(*filter, 8));   // k5k4
+      v_tap[3] = _mm512_broadcastd_epi32(_mm_srli_si128(*filter, 12));  // k7k6
+    } else {
+      v_tap[0] = _mm512_broadcastw_epi16(*filter);                     // k1k0
+      v_tap[1] = _mm512_broadcastw_epi16(_mm_srli_si128(*filter, 2));  // k3k2
+      v_tap[2] = _mm512_broadcastw_epi16(_mm_srli_si128(*filter, 4));  // k5k4
+      v_tap[3] = _mm512_broadcastw_epi16(_mm_srli_si128(*filter, 6));  // k7k6
+    }
+  } else if (num_taps == 6) {
+    if (is_2d_vertical) {
+      v_tap[0] = _mm512_broadcastd_epi32(_mm_srli_si128(*filter, 2));   // k2k1
+      v_tap[1] = _mm512_broadcastd_epi32(_mm_srli_si128(*filter, 6));   // k4k3
+      v_tap[2] = _mm512_broadcastd_epi32(_mm_srli_si128(*filter, 10));  // k6k5
+    } else {
+      v_tap[0] = _mm512_broadcastw_epi16(_mm_srli_si128(*filter, 1));  // k2k1
+      v_tap[1] = _mm512_broadcastw_epi16(_mm_srli_si128(*filter, 3));  // k4k3
+      v_tap[2] = _mm512_broadcastw_epi16(_mm_srli_si128(*filter, 5));  // k6k5
+    }
+  } else if (num_taps == 4) {
+    if (is_2d_vertical) {
+      v_tap[0] = _mm512_broadcastd_epi32(_mm_srli_si128(*filter, 4));  // k3k2
+      v_tap[1] = _mm512_broadcastd_epi32(_mm_srli_si128(*filter, 8));  // k5k4
+    } else {
+      v_tap[0] = _mm512_broadcastw_epi16(_mm_srli_si128(*filter, 2));  // k3k2
+      v_tap[1] = _mm512_broadcastw_epi16(_mm_srli_si128(*filter, 4));  // k5k4
+    }
+  } else {  // num_taps == 2
+    if (is_2d_vertical) {
+      v_tap[0] = _mm512_broadcastd_epi32(_mm_srli_si128(*filter, 6));  // k4k3
+    } else {
+      v_tap[0] = _mm512_broadcastw_epi16(_mm_srli_si128(*filter, 3));  // k4k3
+    }
+  }
+}
+
+template <int num_taps, bool is_compound>
+__m512i SimpleSum2DVerticalTaps(const __m512i* const src,
+                                const __m512i* const taps) {
+  __m512i sum_lo =
+      _mm512_madd_epi16(_mm512_unpacklo_epi16(src[0], src[1]), taps[0]);
+  __m512i sum_hi =
+      _mm512_madd_epi16(_mm512_unpackhi_epi16(src[0], src[1]), taps[0]);
+  if (num_taps >= 4) {
+    __m512i madd_lo =
+        _mm512_madd_epi16(_mm512_unpacklo_epi16(src[2], src[3]), taps[1]);
+    __m512i madd_hi =
+        _mm512_madd_epi16(_mm512_unpackhi_epi16(src[2], src[3]), taps[1]);
+    sum_lo = _mm512_add_epi32(sum_lo, madd_lo);
+    sum_hi = _mm512_add_epi32(sum_hi, madd_hi);
+    if (num_taps >= 6) {
+      madd_lo =
+          _mm512_madd_epi16(_mm512_unpacklo_epi16(src[4], src[5]), taps[2]);
+      madd_hi =
+          _mm512_madd_epi16(_mm512_unpackhi_epi16(src[4], src[5]), taps[2]);
+      sum_lo = _mm512_add_epi32(sum_lo, madd_lo);
+      sum_hi = _mm512_add_epi32(sum_hi, madd_hi);
+      if (num_taps == 8) {
+        madd_lo =
+            _mm512_madd_epi16(_mm512_unpacklo_epi16(src[6], src[7]), taps[3]);
+        madd_hi =
+            _mm512_madd_epi16(_mm512_unpackhi_epi16(src[6], src[7]), taps[3]);
+        sum_lo = _mm512_add_epi32(sum_lo, madd_lo);
+        sum_hi = _mm512_add_epi32(sum_hi, madd_hi);
+      }
+    }
+  }
+
+  if (is_compound) {
+    return _mm512_packs_epi32(
+        RightShiftWithRounding_S32(sum_lo, kInterRoundBitsCompoundVertical - 1),
+        RightShiftWithRounding_S32(sum_hi,
+                                   kInterRoundBitsCompoundVertical - 1));
+  }
+
+  return _mm512_packs_epi32(
+      RightShiftWithRounding_S32(sum_lo, kInterRoundBitsVertical - 1),
+      RightShiftWithRounding_S32(sum_hi, kInterRoundBitsVertical - 1));
+}
+
+template <int num_taps, bool is_compound = false>
+void Filter2DVertical32xH(const uint16_t* LIBGAV1_RESTRICT src,
+                          void* LIBGAV1_RESTRICT const dst,
+                          const ptrdiff_t dst_stride, const int width,
+                          const int height, const __m512i* const taps) {
+  assert(width >= 32);
+  constexpr int next_row = num_taps - 1;
+  // The Horizontal pass uses |width| as |stride| for the intermediate buffer.
+  const ptrdiff_t src_stride = width;
+
+  auto* dst8 = static_cast<uint8_t*>(dst);
+  auto* dst16 = static_cast<uint16_t*>(dst);
+  const __m512i v_zero = _mm512_setzero_si512();
+
+  int x = 0;
+  do {
+    __m512i srcs[8];
+    const uint16_t* src_x = src + x;
+    for (int i = 0; i < next_row; ++i) {
+      srcs[i] = LoadUnaligned64(src_x);
+      src_x += src_stride;
+    }
+
+    auto* dst8_x = dst8 + x;
+    auto* dst16_x = dst16 + x;
+    int y = height;
+    do {
+      srcs[next_row] = LoadUnaligned64(src_x);
+      src_x += src_stride;
+
+      const __m512i sum =
+          SimpleSum2DVerticalTaps<num_taps, is_compound>(srcs, taps);
+      if (is_compound) {
+        StoreUnaligned64(dst16_x, sum);
+        dst16_x += dst_stride;
+      } else {
+        // Clamping negative values to zero lets the unsigned saturating
+        // narrow act as packus without the per-lane reordering.
+        StoreUnaligned32(dst8_x,
+                         _mm512_cvtusepi16_epi8(_mm512_max_epi16(sum, v_zero)));
+        dst8_x += dst_stride;
+      }
+
+      for (int i = 0; i < next_row; ++i) {
+        srcs[i] = srcs[i + 1];
+      }
+    } while (--y != 0);
+    x += 32;
+  } while (x < width);
+}
+
+// The 1D compound shift is always |kInterRoundBitsHorizontal|, even for 1D
+// Vertical calculations.
+__m512i Compound1DShift(const __m512i sum) {
+  return RightShiftWithRounding_S16(sum, kInterRoundBitsHorizontal - 1);
+}
+
+template <int filter_index, bool unpack_high = false>
+__m512i SumVerticalTaps(const __m512i* const srcs, const __m512i* const v_tap) {
+  const int num_taps = GetNumTapsInFilter(filter_index);
+  __m512i v_src[4];
+  for (int i = 0; i < num_taps / 2; ++i) {
+    v_src[i] = unpack_high ? _mm512_unpackhi_epi8(srcs[2 * i], srcs[2 * i + 1])
+                           : _mm512_unpacklo_epi8(srcs[2 * i], srcs[2 * i + 1]);
+  }
+  return SumOnePassTaps<filter_index>(v_src, v_tap);
+}
+
+// Filter widths >= 64.
+template <int filter_index, bool is_compound = false>
+void FilterVertical64xH(const uint8_t* LIBGAV1_RESTRICT src,
+                        const ptrdiff_t src_stride,
+                        void* LIBGAV1_RESTRICT const dst,
+                        const ptrdiff_t dst_stride, const int width,
+                        const int height, const __m512i* const v_tap) {
+  const int num_taps = GetNumTapsInFilter(filter_index);
+  const int next_row = num_taps - 1;
+  auto* dst8 = static_cast<uint8_t*>(dst);
+  auto* dst16 = static_cast<uint16_t*>(dst);
+  // Selects the low (high) halves of lanes k of |sums| and |sums_hi|, which
+  // hold pixels [16 * k, 16 * k + 8) and [16 * k + 8, 16 * k + 16), for lanes
+  // 0 and 1 (2 and 3).
+  const __m512i v_order_lo = _mm512_setr_epi64(0, 1, 8, 9, 2, 3, 10, 11);
+  const __m512i v_order_hi = _mm512_setr_epi64(4, 5, 12, 13, 6, 7, 14, 15);
+  assert(width >= 64);
+  int x = 0;
+  do {
+    const uint8_t* src_x = src + x;
+    __m512i srcs[8];
+    for (int i = 0; i < next_row; ++i) {
+      srcs[i] = LoadUnaligned64(src_x);
+      src_x += src_stride;
+    }
+
+    auto* dst8_x = dst8 + x;
+    auto* dst16_x = dst16 + x;
+    int y = height;
+    do {
+      srcs[next_row] = LoadUnaligned64(src_x);
+      src_x += src_stride;
+
+      const __m512i sums = SumVerticalTaps<filter_index>(srcs, v_tap);
+      const __m512i sums_hi =
+          SumVerticalTaps<filter_index, /*unpack_high=*/true>(srcs, v_tap);
+      if (is_compound) {
+        const __m512i results = Compound1DShift(
+            _mm512_permutex2var_epi64(sums, v_order_lo, sums_hi));
+        const __m512i results_hi = Compound1DShift(
+            _mm512_permutex2var_epi64(sums, v_order_hi, sums_hi));
+        StoreUnaligned64(dst16_x, results);
+        StoreUnaligned64(dst16_x + 32, results_hi);
+        dst16_x += dst_stride;
+      } else {
+        const __m512i results =
+            RightShiftWithRounding_S16(sums, kFilterBits - 1);
+        const __m512i results_hi =
+            RightShiftWithRounding_S16(sums_hi, kFilterBits - 1);
+        const __m512i packed_results = _mm512_packus_epi16(results, results_hi);
+
+        StoreUnaligned64(dst8_x, packed_results);
+        dst8_x += dst_stride;
+      }
+
+      for (int i = 0; i < next_row; ++i) {
+        srcs[i] = srcs[i + 1];
+      }
+    } while (--y != 0);
+    x += 64;
+  } while (x < width);
+}
+
+template <bool is_2d = false, bool is_compound = false>
+LIBGAV1_ALWAYS_INLINE void DoWideHorizontalPass(
+    const uint8_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
+    void* LIBGAV1_RESTRICT const dst, const ptrdiff_t dst_stride,
+    const int width, const int height, const int filter_id,
+    const int filter_index) {
+  assert(filter_id != 0);
+  __m512i v_tap[4];
+  const __m128i v_horizontal_filter =
+      LoadLo8(kHalfSubPixelFilters[filter_index][filter_id]);
+
+  if (filter_index == 2) {  // 8 tap.
+    SetupTaps<8>(&v_horizontal_filter, v_tap);
+    FilterHorizontalWide<2, is_2d, is_compound>(src, src_stride, dst,
+                                                dst_stride, width, height,
+                                                v_tap);
+  } else if (filter_index == 1) {  // 6 tap.
+    SetupTaps<6>(&v_horizontal_filter, v_tap);
+    FilterHorizontalWide<1, is_2d, is_compound>(src, src_stride, dst,
+                                                dst_stride, width, height,
+                                                v_tap);
+  } else if (filter_index == 0) {  // 6 tap.
+    SetupTaps<6>(&v_horizontal_filter, v_tap);
+    FilterHorizontalWide<0, is_2d, is_compound>(src, src_stride, dst,
+                                                dst_stride, width, height,
+                                                v_tap);
+  } else if (filter_index == 4) {  // 4 tap.
+    SetupTaps<4>(&v_horizontal_filter, v_tap);
+    FilterHorizontalWide<4, is_2d, is_compound>(src, src_stride, dst,
+                                                dst_stride, width, height,
+                                                v_tap);
+  } else if (filter_index == 5) {  // 4 tap.
+    SetupTaps<4>(&v_horizontal_filter, v_tap);
+    FilterHorizontalWide<5, is_2d, is_compound>(src, src_stride, dst,
+                                                dst_stride, width, height,
+                                                v_tap);
+  } else {  // 2 tap.
+    SetupTaps<2>(&v_horizontal_filter, v_tap);
+    FilterHorizontalWide<3, is_2d, is_compound>(src, src_stride, dst,
+                                                dst_stride, width, height,
+                                                v_tap);
+  }
+}
+
+template <bool is_compound = false>
+LIBGAV1_ALWAYS_INLINE void DoWideVerticalPass(
+    const uint8_t* LIBGAV1_RESTRICT const src, const ptrdiff_t src_stride,
+    void* LIBGAV1_RESTRICT const dst, const ptrdiff_t dst_stride,
+    const int width, const int height, const int filter_id,
+    const int filter_index) {
+  assert(filter_id != 0);
+  __m512i v_tap[4];
+  const __m128i v_filter =
+      LoadLo8(kHalfSubPixelFilters[filter_index][filter_id]);
+
+  if (filter_index < 2) {  // 6 tap.
+    SetupTaps<6>(&v_filter, v_tap);
+    FilterVertical64xH<0, is_compound>(src, src_stride, dst, dst_stride, width,
+                                       height, v_tap);
+  } else if (filter_index == 2) {  // 8 tap.
+    SetupTaps<8>(&v_filter, v_tap);
+    FilterVertical64xH<2, is_compound>(src, src_stride, dst, dst_stride, width,
+                                       height, v_tap);
+  } else if (filter_index == 3) {  // 2 tap.
+    SetupTaps<2>(&v_filter, v_tap);
+    FilterVertical64xH<3, is_compound>(src, src_stride, dst, dst_stride, width,
+                                       height, v_tap);
+  } else if (filter_index == 4) {  // 4 tap.
+    SetupTaps<4>(&v_filter, v_tap);
+    FilterVertical64xH<4, is_compound>(src, src_stride, dst, dst_stride, width,
+                                       height, v_tap);
+  } else {  // 4 tap.
+    SetupTaps<4>(&v_filter, v_tap);
+    FilterVertical64xH<5, is_compound>(src, src_stride, dst, dst_stride, width,
+                                       height, v_tap);
+  }
+}
+
+template <bool is_compound = false>
+LIBGAV1_ALWAYS_INLINE void DoWide2DVerticalPass(
+    const uint16_t* LIBGAV1_RESTRICT const src,
+    void* LIBGAV1_RESTRICT const dst, const ptrdiff_t dst_stride,
+    const int width, const int height, const int filter_id,
+    const int filter_index) {
+  assert(filter_id != 0);
+  __m512i taps[4];
+  const __m128i v_filter_ext = _mm_cvtepi8_epi16(
+      LoadLo8(kHalfSubPixelFilters[filter_index][filter_id]));
+  const int vertical_taps = GetNumTapsInFilter(filter_index);
+
+  if (vertical_taps == 8) {
+    SetupTaps<8, /*is_2d_vertical=*/true>(&v_filter_ext, taps);
+    Filter2DVertical32xH<8, is_compound>(src, dst, dst_stride, width, height,
+                                         taps);
+  } else if (vertical_taps == 6) {
+    SetupTaps<6, /*is_2d_vertical=*/true>(&v_filter_ext, taps);
+    Filter2DVertical32xH<6, is_compound>(src, dst, dst_stride, width, height,
+                                         taps);
+  } else if (vertical_taps == 4) {
+    SetupTaps<4, /*is_2d_vertical=*/true>(&v_filter_ext, taps);
+    Filter2DVertical32xH<4, is_compound>(src, dst, dst_stride, width, height,
+                                         taps);
+  } else {  // |vertical_taps| == 2
+    SetupTaps<2, /*is_2d_vertical=*/true>(&v_filter_ext, taps);
+    Filter2DVertical32xH<2, is_compound>(src, dst, dst_stride, width, height,
+                                         taps);
+  }
+}
+
+void ConvolveHorizontal_AVX512(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int horizontal_filter_index,
+    const int vertical_filter_index, const int horizontal_filter_id,
+    const int vertical_filter_id, const int width, const int height,
+    void* LIBGAV1_RESTRICT prediction, const ptrdiff_t pred_stride) {
+  if (width < 64) {
+    ConvolveHorizontal_AVX2(reference, reference_stride,
+                            horizontal_filter_index, vertical_filter_index,
+                            horizontal_filter_id, vertical_filter_id, width,
+                            height, prediction, pred_stride);
+    return;
+  }
+  const int filter_index = GetFilterIndex(horizontal_filter_index, width);
+  // Set |src| to the outermost tap.
+  const auto* src = static_cast<const uint8_t*>(reference) - kHorizontalOffset;
+  DoWideHorizontalPass(src, reference_stride, prediction, pred_stride, width,
+                       height, horizontal_filter_id, filter_index);
+}
+
+void ConvolveCompoundHorizontal_AVX512(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int horizontal_filter_index,
+    const int vertical_filter_index, const int horizontal_filter_id,
+    const int vertical_filter_id, const int width, const int height,
+    void* LIBGAV1_RESTRICT prediction, const ptrdiff_t pred_stride) {
+  if (width < 32) {
+    ConvolveCompoundHorizontal_AVX2(
+        reference, reference_stride, horizontal_filter_index,
+        vertical_filter_index, horizontal_filter_id, vertical_filter_id, width,
+        height, prediction, pred_stride);
+    return;
+  }
+  const int filter_index = GetFilterIndex(horizontal_filter_index, width);
+  // Set |src| to the outermost tap.
+  const auto* src = static_cast<const uint8_t*>(reference) - kHorizontalOffset;
+  // All compound functions output to the predictor buffer with |pred_stride|
+  // equal to |width|.
+  assert(pred_stride == width);
+  DoWideHorizontalPass</*is_2d=*/false, /*is_compound=*/true>(
+      src, reference_stride, prediction, width, width, height,
+      horizontal_filter_id, filter_index);
+}
+
+void ConvolveVertical_AVX512(const void* LIBGAV1_RESTRICT const reference,
+                             const ptrdiff_t reference_stride,
+                             const int horizontal_filter_index,
+                             const int vertical_filter_index,
+                             const int horizontal_filter_id,
+                             const int vertical_filter_id, const int width,
+                             const int height,
+                             void* LIBGAV1_RESTRICT prediction,
+                             const ptrdiff_t pred_stride) {
+  if (width < 64) {
+    ConvolveVertical_AVX2(reference, reference_stride, horizontal_filter_index,
+                          vertical_filter_index, horizontal_filter_id,
+                          vertical_filter_id, width, height, prediction,
+                          pred_stride);
+    return;
+  }
+  const int filter_index = GetFilterIndex(vertical_filter_index, height);
+  const int vertical_taps = GetNumTapsInFilter(filter_index);
+  const auto* src = static_cast<const uint8_t*>(reference) -
+                    (vertical_taps / 2 - 1) * reference_stride;
+  DoWideVerticalPass(src, reference_stride, prediction, pred_stride, width,
+                     height, vertical_filter_id, filter_index);
+}
+
+void ConvolveCompoundVertical_AVX512(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int horizontal_filter_index,
+    const int vertical_filter_index, const int horizontal_filter_id,
+    const int vertical_filter_id, const int width, const int height,
+    void* LIBGAV1_RESTRICT prediction, const ptrdiff_t pred_stride) {
+  if (width < 64) {
+    ConvolveCompoundVertical_AVX2(
+        reference, reference_stride, horizontal_filter_index,
+        vertical_filter_index, horizontal_filter_id, vertical_filter_id, width,
+        height, prediction, pred_stride);
+    return;
+  }
+  const int filter_index = GetFilterIndex(vertical_filter_index, height);
+  const int vertical_taps = GetNumTapsInFilter(filter_index);
+  const auto* src = static_cast<const uint8_t*>(reference) -
+                    (vertical_taps / 2 - 1) * reference_stride;
+  DoWideVerticalPass</*is_compound=*/true>(src, reference_stride, prediction,
+                                           width, width, height,
+                                           vertical_filter_id, filter_index);
+}
+
+template <bool is_compound>
+void Convolve2DWide(const void* LIBGAV1_RESTRICT const reference,
+                    const ptrdiff_t reference_stride,
+                    const int horizontal_filter_index,
+                    const int vertical_filter_index,
+                    const int horizontal_filter_id,
+                    const int vertical_filter_id, const int width,
+                    const int height, void* LIBGAV1_RESTRICT prediction,
+                    const ptrdiff_t pred_stride) {
+  const int horiz_filter_index = GetFilterIndex(horizontal_filter_index, width);
+  const int vert_filter_index = GetFilterIndex(vertical_filter_index, height);
+  const int vertical_taps = GetNumTapsInFilter(vert_filter_index);
+
+  // The output of the horizontal filter is guaranteed to fit in 16 bits.
+  alignas(64) uint16_t
+      intermediate_result[kMaxSuperBlockSizeInPixels *
+                          (kMaxSuperBlockSizeInPixels + kSubPixelTaps - 1)];
+  const int intermediate_height = height + vertical_taps - 1;
+
+  const auto* src = static_cast<const uint8_t*>(reference) -
+                    (vertical_taps / 2 - 1) * reference_stride -
+                    kHorizontalOffset;
+  DoWideHorizontalPass</*is_2d=*/true>(src, reference_stride,
+                                       intermediate_result, width, width,
+                                       intermediate_height,
+                                       horizontal_filter_id,
+                                       horiz_filter_index);
+  DoWide2DVerticalPass<is_compound>(intermediate_result, prediction,
+                                    pred_stride, width, height,
+                                    vertical_filter_id, vert_filter_index);
+}
+
+void Convolve2D_AVX512(const void* LIBGAV1_RESTRICT const reference,
+                       const ptrdiff_t reference_stride,
+                       const int horizontal_filter_index,
+                       const int vertical_filter_index,
+                       const int horizontal_filter_id,
+                       const int vertical_filter_id, const int width,
+                       const int height, void* LIBGAV1_RESTRICT prediction,
+                       const ptrdiff_t pred_stride) {
+  if (width < 32) {
+    Convolve2D_AVX2(reference, reference_stride, horizontal_filter_index,
+                    vertical_filter_index, horizontal_filter_id,
+                    vertical_filter_id, width, height, prediction, pred_stride);
+    return;
+  }
+  Convolve2DWide</*is_compound=*/false>(
+      reference, reference_stride, horizontal_filter_index,
+      vertical_filter_index, horizontal_filter_id, vertical_filter_id, width,
+      height, prediction, pred_stride);
+}
+
+void ConvolveCompound2D_AVX512(
+    const void* LIBGAV1_RESTRICT const reference,
+    const ptrdiff_t reference_stride, const int horizontal_filter_index,
+    const int vertical_filter_index, const int horizontal_filter_id,
+    const int vertical_filter_id, const int width, const int height,
+    void* LIBGAV1_RESTRICT prediction, const ptrdiff_t pred_stride) {
+  if (width < 32) {
+    ConvolveCompound2D_AVX2(reference, reference_stride,
+                            horizontal_filter_index, vertical_filter_index,
+                            horizontal_filter_id, vertical_filter_id, width,
+                            height, prediction, pred_stride);
+    return;
+  }
+  Convolve2DWide</*is_compound=*/true>(
+      reference, reference_stride, horizontal_filter_index,
+      vertical_filter_index, horizontal_filter_id, vertical_filter_id, width,
+      height, prediction, pred_stride);
+}
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_8BPP_AVX512(ConvolveHorizontal)
+  dsp->convolve[0][0][0][1] = ConvolveHorizontal_AVX512;
+#endif
+#if DSP_ENABLED_8BPP_AVX512(ConvolveVertical)
+  dsp->convolve[0][0][1][0] = ConvolveVertical_AVX512;
+#endif
+#if DSP_ENABLED_8BPP_AVX512(Convolve2D)
+  dsp->convolve[0][0][1][1] = Convolve2D_AVX512;
+#endif
+
+#if DSP_ENABLED_8BPP_AVX512(ConvolveCompoundHorizontal)
+  dsp->convolve[0][1][0][1] = ConvolveCompoundHorizontal_AVX512;
+#endif
+#if DSP_ENABLED_8BPP_AVX512(ConvolveCompoundVertical)
+  dsp->convolve[0][1][1][0] = ConvolveCompoundVertical_AVX512;
+#endif
+#if DSP_ENABLED_8BPP_AVX512(ConvolveCompound2D)
+  dsp->convolve[0][1][1][1] = ConvolveCompound2D_AVX512;
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+void ConvolveInit_AVX512() { low_bitdepth::Init8bpp(); }
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !LIBGAV1_TARGETING_AVX512
+namespace libgav1 {
+namespace dsp {
+
+void ConvolveInit_AVX512() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX512
@@ -0,0 +1,272 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/distance_weighted_blend.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/utils/common.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace low_bitdepth {
+namespace {
+
+constexpr int kInterPostRoundBit = 4;
+
+// The predictions are stored contiguously with a stride of |width|, so for
+// blocks narrower than 16 one vector covers several rows. The unpack/pack pair
+// keeps the results in memory order within each 128-bit lane.
+inline __m256i ComputeWeightedAverage16(
+    const int16_t* LIBGAV1_RESTRICT prediction_0,
+    const int16_t* LIBGAV1_RESTRICT prediction_1, const __m256i& weights) {
+  const __m256i pred_0 = LoadUnaligned32(prediction_0);
+  const __m256i pred_1 = LoadUnaligned32(prediction_1);
+  const __m256i preds_lo = _mm256_unpacklo_epi16(pred_0, pred_1);
+  const __m256i mult_lo = _mm256_madd_epi16(preds_lo, weights);
+  const __m256i result_lo =
+      RightShiftWithRounding_S32(mult_lo, kInterPostRoundBit + 4);
+
+  const __m256i preds_hi = _mm256_unpackhi_epi16(pred_0, pred_1);
+  const __m256i mult_hi = _mm256_madd_epi16(preds_hi, weights);
+  const __m256i result_hi =
+      RightShiftWithRounding_S32(mult_hi, kInterPostRoundBit + 4);
+
+  return _mm256_packs_epi32(result_lo, result_hi);
+}
+
+// Packs 16 results to 8 bits, preserving their order.
+inline __m128i PackResult16(const __m256i res) {
+  return _mm_packus_epi16(_mm256_castsi256_si128(res),
+                          _mm256_extracti128_si256(res, 1));
+}
+
+void DistanceWeightedBlend_AVX2(const void* LIBGAV1_RESTRICT prediction_0,
+                                const void* LIBGAV1_RESTRICT prediction_1,
+                                const uint8_t weight_0, const uint8_t weight_1,
+                                const int width, const int height,
+                                void* LIBGAV1_RESTRICT const dest,
+                                const ptrdiff_t dest_stride) {
+  auto* dst = static_cast<uint8_t*>(dest);
+  const auto* pred_0 = static_cast<const int16_t*>(prediction_0);
+  const auto* pred_1 = static_cast<const int16_t*>(prediction_1);
+  const __m256i weights = _mm256_set1_epi32(weight_0 | (weight_1 << 16));
+  int y = height;
+
+  if (width == 4) {
+    do {
+      const __m128i res =
+          PackResult16(ComputeWeightedAverage16(pred_0, pred_1, weights));
+      Store4(dst, res);
+      Store4(dst + dest_stride, _mm_srli_si128(res, 4));
+      Store4(dst + 2 * dest_stride, _mm_srli_si128(res, 8));
+      Store4(dst + 3 * dest_stride, _mm_srli_si128(res, 12));
+      dst += dest_stride << 2;
+      pred_0 += 16;
+      pred_1 += 16;
+      y -= 4;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 8) {
+    do {
+      const __m128i res =
+          PackResult16(ComputeWeightedAverage16(pred_0, pred_1, weights));
+      StoreLo8(dst, res);
+      StoreHi8(dst + dest_stride, res);
+      dst += dest_stride << 1;
+      pred_0 += 16;
+      pred_1 += 16;
+      y -= 2;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 16) {
+    do {
+      StoreUnaligned16(
+          dst, PackResult16(ComputeWeightedAverage16(pred_0, pred_1, weights)));
+      dst += dest_stride;
+      pred_0 += 16;
+      pred_1 += 16;
+    } while (--y != 0);
+    return;
+  }
+
+  do {
+    int x = 0;
+    do {
+      const __m256i res_0 =
+          ComputeWeightedAverage16(pred_0 + x, pred_1 + x, weights);
+      const __m256i res_1 =
+          ComputeWeightedAverage16(pred_0 + x + 16, pred_1 + x + 16, weights);
+      const __m256i res = _mm256_packus_epi16(res_0, res_1);
+      StoreUnaligned32(dst + x, _mm256_permute4x64_epi64(res, 0xd8));
+      x += 32;
+    } while (x < width);
+    dst += dest_stride;
+    pred_0 += width;
+    pred_1 += width;
+  } while (--y != 0);
+}
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_8BPP_AVX2(DistanceWeightedBlend)
+  dsp->distance_weighted_blend = DistanceWeightedBlend_AVX2;
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+constexpr int kMax10bppSample = (1 << 10) - 1;
+constexpr int kInterPostRoundBit = 4;
+constexpr int kSignBit = 0x8000;
+
+// The unsigned predictions are biased by -32768 so that _mm256_madd_epi16 can
+// be used. weight_0 + weight_1 == 16, so the bias is restored with a constant
+// which also combines the rounding and -kCompoundOffset terms.
+inline __m256i ComputeWeightedAverage16(
+    const uint16_t* LIBGAV1_RESTRICT prediction_0,
+    const uint16_t* LIBGAV1_RESTRICT prediction_1, const __m256i& weights,
+    const __m256i& sign_bit, const __m256i& bias, const __m256i& clip_high) {
+  const __m256i pred_0 =
+      _mm256_xor_si256(LoadUnaligned32(prediction_0), sign_bit);
+  const __m256i pred_1 =
+      _mm256_xor_si256(LoadUnaligned32(prediction_1), sign_bit);
+  const __m256i preds_lo = _mm256_unpacklo_epi16(pred_0, pred_1);
+  const __m256i mult_lo = _mm256_madd_epi16(preds_lo, weights);
+  const __m256i result_lo = _mm256_srai_epi32(_mm256_add_epi32(mult_lo, bias),
+                                              kInterPostRoundBit + 4);
+  const __m256i preds_hi = _mm256_unpackhi_epi16(pred_0, pred_1);
+  const __m256i mult_hi = _mm256_madd_epi16(preds_hi, weights);
+  const __m256i result_hi = _mm256_srai_epi32(_mm256_add_epi32(mult_hi, bias),
+                                              kInterPostRoundBit + 4);
+  return _mm256_min_epi16(_mm256_packus_epi32(result_lo, result_hi),
+                          clip_high);
+}
+
+void DistanceWeightedBlend10bpp_AVX2(const void* LIBGAV1_RESTRICT prediction_0,
+                                     const void* LIBGAV1_RESTRICT prediction_1,
+                                     const uint8_t weight_0,
+                                     const uint8_t weight_1, const int width,
+                                     const int height,
+                                     void* LIBGAV1_RESTRICT const dest,
+                                     const ptrdiff_t dest_stride) {
+  auto* dst = static_cast<uint16_t*>(dest);
+  const ptrdiff_t dst_stride = dest_stride / sizeof(dst[0]);
+  const auto* pred_0 = static_cast<const uint16_t*>(prediction_0);
+  const auto* pred_1 = static_cast<const uint16_t*>(prediction_1);
+  const __m256i weights = _mm256_set1_epi32(weight_0 | (weight_1 << 16));
+  const __m256i sign_bit = _mm256_set1_epi16(static_cast<int16_t>(kSignBit));
+  const __m256i bias =
+      _mm256_set1_epi32((kSignBit << 4) - (kCompoundOffset << 4) +
+                        ((1 << (kInterPostRoundBit + 4)) >> 1));
+  const __m256i clip_high = _mm256_set1_epi16(kMax10bppSample);
+  int y = height;
+
+  if (width == 4) {
+    do {
+      const __m256i res = ComputeWeightedAverage16(pred_0, pred_1, weights,
+                                                   sign_bit, bias, clip_high);
+      const __m128i res_lo = _mm256_castsi256_si128(res);
+      const __m128i res_hi = _mm256_extracti128_si256(res, 1);
+      StoreLo8(dst, res_lo);
+      StoreHi8(dst + dst_stride, res_lo);
+      StoreLo8(dst + 2 * dst_stride, res_hi);
+      StoreHi8(dst + 3 * dst_stride, res_hi);
+      dst += dst_stride << 2;
+      pred_0 += 16;
+      pred_1 += 16;
+      y -= 4;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 8) {
+    do {
+      const __m256i res = ComputeWeightedAverage16(pred_0, pred_1, weights,
+                                                   sign_bit, bias, clip_high);
+      StoreUnaligned16(dst, _mm256_castsi256_si128(res));
+      StoreUnaligned16(dst + dst_stride, _mm256_extracti128_si256(res, 1));
+      dst += dst_stride << 1;
+      pred_0 += 16;
+      pred_1 += 16;
+      y -= 2;
+    } while (y != 0);
+    return;
+  }
+
+  do {
+    int x = 0;
+    do {
+      StoreUnaligned32(
+          dst + x, ComputeWeightedAverage16(pred_0 + x, pred_1 + x, weights,
+                                            sign_bit, bias, clip_high));
+      x += 16;
+    } while (x < width);
+    dst += dst_stride;
+    pred_0 += width;
+    pred_1 += width;
+  } while (--y != 0);
+}
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_10BPP_AVX2(DistanceWeightedBlend)
+  dsp->distance_weighted_blend = DistanceWeightedBlend10bpp_AVX2;
+#endif
+}
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void DistanceWeightedBlendInit_AVX2() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif
+}
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !LIBGAV1_TARGETING_AVX2
+
+namespace libgav1 {
+namespace dsp {
+
+void DistanceWeightedBlendInit_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2
@@ -0,0 +1,618 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/intrapred.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/utils/common.h"
+#include "src/utils/constants.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace {
+
+//------------------------------------------------------------------------------
+// Utility Functions
+
+// See intrapred_sse4.cc. Divides by a number of the form 2^n + 2^k, n > k, by
+// shifting out 2^k and multiplying by the inverse of 3 or 5 in the high bits.
+// The shifted sum must stay below 2^14, which holds for the largest 10bpp
+// blocks.
+constexpr int kThreeInverse = 0x5556;
+constexpr int kFiveInverse = 0x3334;
+template <int shiftk, int multiplier>
+inline __m128i DivideByMultiplyShift_U32(const __m128i dividend) {
+  const __m128i interm = _mm_srli_epi32(dividend, shiftk);
+  return _mm_mulhi_epi16(interm, _mm_cvtsi32_si128(multiplier));
+}
+
+// Adds the 8 32-bit values of |sums|, returning the total in the low lane.
+inline __m128i HorizontalAdd_U32(const __m256i sums) {
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(sums),
+                              _mm256_extracti128_si256(sums, 1));
+  sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+  return _mm_add_epi32(sum, _mm_srli_si128(sum, 4));
+}
+
+//------------------------------------------------------------------------------
+// DcPredFuncs_AVX2
+
+using DcSumFunc = __m128i (*)(const void* ref);
+using DcStoreFunc = void (*)(void* dest, ptrdiff_t stride, const __m128i dc);
+
+// DC intra-predictors for blocks 32 and 64 pixels wide. The sums are returned
+// in the low 32 bits of an __m128i.
+template <int width_log2, int height_log2, DcSumFunc top_sumfn,
+          DcSumFunc left_sumfn, DcStoreFunc storefn, int shiftk, int dc_mult>
+struct DcPredFuncs_AVX2 {
+  DcPredFuncs_AVX2() = delete;
+
+  static void DcTop(void* dest, ptrdiff_t stride, const void* top_row,
+                    const void* left_column);
+  static void DcLeft(void* dest, ptrdiff_t stride, const void* top_row,
+                     const void* left_column);
+  static void Dc(void* dest, ptrdiff_t stride, const void* top_row,
+                 const void* left_column);
+};
+
+template <int width_log2, int height_log2, DcSumFunc top_sumfn,
+          DcSumFunc left_sumfn, DcStoreFunc storefn, int shiftk, int dc_mult>
+void DcPredFuncs_AVX2<
+    width_log2, height_log2, top_sumfn, left_sumfn, storefn, shiftk,
+    dc_mult>::DcTop(void* LIBGAV1_RESTRICT const dest, ptrdiff_t stride,
+                    const void* LIBGAV1_RESTRICT const top_row,
+                    const void* /*left_column*/) {
+  const __m128i rounder = _mm_set1_epi32(1 << (width_log2 - 1));
+  const __m128i sum = top_sumfn(top_row);
+  const __m128i dc = _mm_srli_epi32(_mm_add_epi32(sum, rounder), width_log2);
+  storefn(dest, stride, dc);
+}
+
+template <int width_log2, int height_log2, DcSumFunc top_sumfn,
+          DcSumFunc left_sumfn, DcStoreFunc storefn, int shiftk, int dc_mult>
+void DcPredFuncs_AVX2<
+    width_log2, height_log2, top_sumfn, left_sumfn, storefn, shiftk,
+    dc_mult>::DcLeft(void* LIBGAV1_RESTRICT const dest, ptrdiff_t stride,
+                     const void* /*top_row*/,
+                     const void* LIBGAV1_RESTRICT const left_column) {
+  const __m128i rounder = _mm_set1_epi32(1 << (height_log2 - 1));
+  const __m128i sum = left_sumfn(left_column);
+  const __m128i dc = _mm_srli_epi32(_mm_add_epi32(sum, rounder), height_log2);
+  storefn(dest, stride, dc);
+}
+
+template <int width_log2, int height_log2, DcSumFunc top_sumfn,
+          DcSumFunc left_sumfn, DcStoreFunc storefn, int shiftk, int dc_mult>
+void DcPredFuncs_AVX2<
+    width_log2, height_log2, top_sumfn, left_sumfn, storefn, shiftk,
+    dc_mult>::Dc(void* LIBGAV1_RESTRICT const dest, ptrdiff_t stride,
+                 const void* LIBGAV1_RESTRICT const top_row,
+                 const void* LIBGAV1_RESTRICT const left_column) {
+  const __m128i rounder =
+      _mm_set1_epi32((1 << (width_log2 - 1)) + (1 << (height_log2 - 1)));
+  const __m128i sum_top = top_sumfn(top_row);
+  const __m128i sum_left = left_sumfn(left_column);
+  const __m128i sum = _mm_add_epi32(sum_top, sum_left);
+  if (width_log2 == height_log2) {
+    const __m128i dc =
+        _mm_srli_epi32(_mm_add_epi32(sum, rounder), width_log2 + 1);
+    storefn(dest, stride, dc);
+  } else {
+    const __m128i dc =
+        DivideByMultiplyShift_U32<shiftk, dc_mult>(_mm_add_epi32(sum, rounder));
+    storefn(dest, stride, dc);
+  }
+}
+
+// Fills a |width| x |height| block with the low pixel of |dc|.
+template <typename Pixel, int width, int height>
+inline void DcStore_AVX2(void* const dest, ptrdiff_t stride,
+                         const __m128i dc) {
+  const __m256i dc_dup = (sizeof(Pixel) == 1) ? _mm256_broadcastb_epi8(dc)
+                                              : _mm256_broadcastw_epi16(dc);
+  constexpr int kStoresPerRow = width * sizeof(Pixel) / 32;
+  auto* dst = static_cast<uint8_t*>(dest);
+  int y = height;
+  do {
+    for (int i = 0; i < kStoresPerRow; ++i) {
+      StoreUnaligned32(dst + i * 32, dc_dup);
+    }
+    dst += stride;
+  } while (--y != 0);
+}
+
+//------------------------------------------------------------------------------
+// Paeth
+
+// 7.11.2.2. Computes the Paeth predictor for 16 pixels of a row, one pixel per
+// 16-bit lane. With base = top + left - top_left, the distances reduce to
+// p_left = |top - top_left|, which is fixed per column, p_top =
+// |left - top_left|, which is fixed per row, and p_top_left =
+// |top_diffs + left_diff|. The sums fit in int16_t for 8bpp and 10bpp.
+inline __m256i Paeth16(const __m256i top, const __m256i top_left,
+                       const __m256i top_diffs, const __m256i p_left,
+                       const __m256i left, const __m256i left_diff,
+                       const __m256i p_top) {
+  const __m256i p_top_left =
+      _mm256_abs_epi16(_mm256_add_epi16(top_diffs, left_diff));
+  // The less-or-equal operation is unavailable, so the logic for selecting
+  // top, left, or top_left is inverted.
+  const __m256i not_select_left =
+      _mm256_or_si256(_mm256_cmpgt_epi16(p_left, p_top),
+                      _mm256_cmpgt_epi16(p_left, p_top_left));
+  const __m256i not_select_top = _mm256_cmpgt_epi16(p_top, p_top_left);
+  const __m256i top_or_top_left =
+      _mm256_blendv_epi8(top, top_left, not_select_top);
+  return _mm256_blendv_epi8(left, top_or_top_left, not_select_left);
+}
+
+}  // namespace
+
+//------------------------------------------------------------------------------
+namespace low_bitdepth {
+namespace {
+
+inline __m128i DcSum8(const void* const ref) {
+  return _mm_sad_epu8(LoadLo8(ref), _mm_setzero_si128());
+}
+
+inline __m128i DcSum16(const void* const ref) {
+  const __m128i sum = _mm_sad_epu8(LoadUnaligned16(ref), _mm_setzero_si128());
+  return _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+}
+
+// _mm256_sad_epu8 produces 4 partial sums, one per 64-bit lane, which fit in
+// the low 32 bits.
+inline __m128i DcSum32(const void* const ref) {
+  const __m256i sum =
+      _mm256_sad_epu8(LoadUnaligned32(ref), _mm256_setzero_si256());
+  return HorizontalAdd_U32(sum);
+}
+
+inline __m128i DcSum64(const void* const ref) {
+  const auto* const ref_ptr = static_cast<const uint8_t*>(ref);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i sum0 = _mm256_sad_epu8(LoadUnaligned32(ref_ptr), zero);
+  const __m256i sum1 = _mm256_sad_epu8(LoadUnaligned32(ref_ptr + 32), zero);
+  return HorizontalAdd_U32(_mm256_add_epi32(sum0, sum1));
+}
+
+struct DcDefs {
+  DcDefs() = delete;
+
+  // shiftk is the smaller of width_log2 and height_log2.
+  // dc_mult corresponds to the ratio of the smaller block size to the larger.
+  using _32x8 =
+      DcPredFuncs_AVX2<5, 3, DcSum32, DcSum8,
+                       DcStore_AVX2<uint8_t, 32, 8>, 3, kFiveInverse>;
+  using _32x16 =
+      DcPredFuncs_AVX2<5, 4, DcSum32, DcSum16,
+                       DcStore_AVX2<uint8_t, 32, 16>, 4, kThreeInverse>;
+  using _32x32 =
+      DcPredFuncs_AVX2<5, 5, DcSum32, DcSum32,
+                       DcStore_AVX2<uint8_t, 32, 32>, 0, 0>;
+  using _32x64 =
+      DcPredFuncs_AVX2<5, 6, DcSum32, DcSum64,
+                       DcStore_AVX2<uint8_t, 32, 64>, 5, kThreeInverse>;
+  using _64x16 =
+      DcPredFuncs_AVX2<6, 4, DcSum64, DcSum16,
+                       DcStore_AVX2<uint8_t, 64, 16>, 4, kFiveInverse>;
+  using _64x32 =
+      DcPredFuncs_AVX2<6, 5, DcSum64, DcSum32,
+                       DcStore_AVX2<uint8_t, 64, 32>, 5, kThreeInverse>;
+  using _64x64 =
+      DcPredFuncs_AVX2<6, 6, DcSum64, DcSum64,
+                       DcStore_AVX2<uint8_t, 64, 64>, 0, 0>;
+};
+
+template <int width, int height>
+void Paeth_AVX2(void* LIBGAV1_RESTRICT const dest, ptrdiff_t stride,
+                const void* LIBGAV1_RESTRICT const top_row,
+                const void* LIBGAV1_RESTRICT const left_column) {
+  static_assert(width == 32 || width == 64, "");
+  constexpr int kNumVectors = width / 16;
+  const auto* const top_ptr = static_cast<const uint8_t*>(top_row);
+  const auto* const left_ptr = static_cast<const uint8_t*>(left_column);
+  const __m256i top_left = _mm256_set1_epi16(top_ptr[-1]);
+  __m256i top[kNumVectors], top_diffs[kNumVectors], p_left[kNumVectors];
+  for (int i = 0; i < kNumVectors; ++i) {
+    top[i] = _mm256_cvtepu8_epi16(LoadUnaligned16(top_ptr + i * 16));
+    top_diffs[i] = _mm256_sub_epi16(top[i], top_left);
+    p_left[i] = _mm256_abs_epi16(top_diffs[i]);
+  }
+  auto* dst = static_cast<uint8_t*>(dest);
+  int y = 0;
+  do {
+    const __m256i left = _mm256_set1_epi16(left_ptr[y]);
+    const __m256i left_diff = _mm256_sub_epi16(left, top_left);
+    const __m256i p_top = _mm256_abs_epi16(left_diff);
+    for (int i = 0; i < kNumVectors; i += 2) {
+      const __m256i pred0 = Paeth16(top[i], top_left, top_diffs[i], p_left[i],
+                                    left, left_diff, p_top);
+      const __m256i pred1 =
+          Paeth16(top[i + 1], top_left, top_diffs[i + 1], p_left[i + 1], left,
+                  left_diff, p_top);
+      // _mm256_packus_epi16() interleaves the 128-bit lanes of its inputs.
+      const __m256i pred = _mm256_permute4x64_epi64(
+          _mm256_packus_epi16(pred0, pred1), 0xd8);
+      StoreUnaligned32(dst + i * 16, pred);
+    }
+    dst += stride;
+  } while (++y < height);
+}
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+  static_cast<void>(dsp);
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x8_IntraPredictorDcTop)
+  dsp->intra_predictors[kTransformSize32x8][kIntraPredictorDcTop] =
+      DcDefs::_32x8::DcTop;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x16_IntraPredictorDcTop)
+  dsp->intra_predictors[kTransformSize32x16][kIntraPredictorDcTop] =
+      DcDefs::_32x16::DcTop;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x32_IntraPredictorDcTop)
+  dsp->intra_predictors[kTransformSize32x32][kIntraPredictorDcTop] =
+      DcDefs::_32x32::DcTop;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x64_IntraPredictorDcTop)
+  dsp->intra_predictors[kTransformSize32x64][kIntraPredictorDcTop] =
+      DcDefs::_32x64::DcTop;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x16_IntraPredictorDcTop)
+  dsp->intra_predictors[kTransformSize64x16][kIntraPredictorDcTop] =
+      DcDefs::_64x16::DcTop;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x32_IntraPredictorDcTop)
+  dsp->intra_predictors[kTransformSize64x32][kIntraPredictorDcTop] =
+      DcDefs::_64x32::DcTop;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x64_IntraPredictorDcTop)
+  dsp->intra_predictors[kTransformSize64x64][kIntraPredictorDcTop] =
+      DcDefs::_64x64::DcTop;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x8_IntraPredictorDcLeft)
+  dsp->intra_predictors[kTransformSize32x8][kIntraPredictorDcLeft] =
+      DcDefs::_32x8::DcLeft;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x16_IntraPredictorDcLeft)
+  dsp->intra_predictors[kTransformSize32x16][kIntraPredictorDcLeft] =
+      DcDefs::_32x16::DcLeft;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x32_IntraPredictorDcLeft)
+  dsp->intra_predictors[kTransformSize32x32][kIntraPredictorDcLeft] =
+      DcDefs::_32x32::DcLeft;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x64_IntraPredictorDcLeft)
+  dsp->intra_predictors[kTransformSize32x64][kIntraPredictorDcLeft] =
+      DcDefs::_32x64::DcLeft;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x16_IntraPredictorDcLeft)
+  dsp->intra_predictors[kTransformSize64x16][kIntraPredictorDcLeft] =
+      DcDefs::_64x16::DcLeft;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x32_IntraPredictorDcLeft)
+  dsp->intra_predictors[kTransformSize64x32][kIntraPredictorDcLeft] =
+      DcDefs::_64x32::DcLeft;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x64_IntraPredictorDcLeft)
+  dsp->intra_predictors[kTransformSize64x64][kIntraPredictorDcLeft] =
+      DcDefs::_64x64::DcLeft;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x8_IntraPredictorDc)
+  dsp->intra_predictors[kTransformSize32x8][kIntraPredictorDc] =
+      DcDefs::_32x8::Dc;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x16_IntraPredictorDc)
+  dsp->intra_predictors[kTransformSize32x16][kIntraPredictorDc] =
+      DcDefs::_32x16::Dc;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x32_IntraPredictorDc)
+  dsp->intra_predictors[kTransformSize32x32][kIntraPredictorDc] =
+      DcDefs::_32x32::Dc;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x64_IntraPredictorDc)
+  dsp->intra_predictors[kTransformSize32x64][kIntraPredictorDc] =
+      DcDefs::_32x64::Dc;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x16_IntraPredictorDc)
+  dsp->intra_predictors[kTransformSize64x16][kIntraPredictorDc] =
+      DcDefs::_64x16::Dc;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x32_IntraPredictorDc)
+  dsp->intra_predictors[kTransformSize64x32][kIntraPredictorDc] =
+      DcDefs::_64x32::Dc;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x64_IntraPredictorDc)
+  dsp->intra_predictors[kTransformSize64x64][kIntraPredictorDc] =
+      DcDefs::_64x64::Dc;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x8_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize32x8][kIntraPredictorPaeth] =
+      Paeth_AVX2<32, 8>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x16_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize32x16][kIntraPredictorPaeth] =
+      Paeth_AVX2<32, 16>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x32_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize32x32][kIntraPredictorPaeth] =
+      Paeth_AVX2<32, 32>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x64_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize32x64][kIntraPredictorPaeth] =
+      Paeth_AVX2<32, 64>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x16_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize64x16][kIntraPredictorPaeth] =
+      Paeth_AVX2<64, 16>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x32_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize64x32][kIntraPredictorPaeth] =
+      Paeth_AVX2<64, 32>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x64_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize64x64][kIntraPredictorPaeth] =
+      Paeth_AVX2<64, 64>;
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+//------------------------------------------------------------------------------
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+inline __m128i DcSum8(const void* const ref) {
+  const __m128i sum = _mm_madd_epi16(LoadUnaligned16(ref), _mm_set1_epi16(1));
+  const __m128i sum2 = _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+  return _mm_add_epi32(sum2, _mm_srli_si128(sum2, 4));
+}
+
+inline __m128i DcSum16(const void* const ref) {
+  return HorizontalAdd_U32(
+      _mm256_madd_epi16(LoadUnaligned32(ref), _mm256_set1_epi16(1)));
+}
+
+// Up to 4 pixels are added in each 16-bit lane before widening, which cannot
+// overflow.
+inline __m128i DcSum32(const void* const ref) {
+  const auto* const ref_ptr = static_cast<const uint16_t*>(ref);
+  const __m256i vals = _mm256_add_epi16(LoadUnaligned32(ref_ptr),
+                                        LoadUnaligned32(ref_ptr + 16));
+  return HorizontalAdd_U32(_mm256_madd_epi16(vals, _mm256_set1_epi16(1)));
+}
+
+inline __m128i DcSum64(const void* const ref) {
+  const auto* const ref_ptr = static_cast<const uint16_t*>(ref);
+  const __m256i vals0 = _mm256_add_epi16(LoadUnaligned32(ref_ptr),
+                                         LoadUnaligned32(ref_ptr + 16));
+  const __m256i vals1 = _mm256_add_epi16(LoadUnaligned32(ref_ptr + 32),
+                                         LoadUnaligned32(ref_ptr + 48));
+  return HorizontalAdd_U32(_mm256_madd_epi16(_mm256_add_epi16(vals0, vals1),
+                                             _mm256_set1_epi16(1)));
+}
+
+struct DcDefs {
+  DcDefs() = delete;
+
+  using _32x8 =
+      DcPredFuncs_AVX2<5, 3, DcSum32, DcSum8,
+                       DcStore_AVX2<uint16_t, 32, 8>, 3, kFiveInverse>;
+  using _32x16 =
+      DcPredFuncs_AVX2<5, 4, DcSum32, DcSum16,
+                       DcStore_AVX2<uint16_t, 32, 16>, 4, kThreeInverse>;
+  using _32x32 =
+      DcPredFuncs_AVX2<5, 5, DcSum32, DcSum32,
+                       DcStore_AVX2<uint16_t, 32, 32>, 0, 0>;
+  using _32x64 =
+      DcPredFuncs_AVX2<5, 6, DcSum32, DcSum64,
+                       DcStore_AVX2<uint16_t, 32, 64>, 5, kThreeInverse>;
+  using _64x16 =
+      DcPredFuncs_AVX2<6, 4, DcSum64, DcSum16,
+                       DcStore_AVX2<uint16_t, 64, 16>, 4, kFiveInverse>;
+  using _64x32 =
+      DcPredFuncs_AVX2<6, 5, DcSum64, DcSum32,
+                       DcStore_AVX2<uint16_t, 64, 32>, 5, kThreeInverse>;
+  using _64x64 =
+      DcPredFuncs_AVX2<6, 6, DcSum64, DcSum64,
+                       DcStore_AVX2<uint16_t, 64, 64>, 0, 0>;
+};
+
+template <int width, int height>
+void Paeth_AVX2(void* LIBGAV1_RESTRICT const dest, ptrdiff_t stride,
+                const void* LIBGAV1_RESTRICT const top_row,
+                const void* LIBGAV1_RESTRICT const left_column) {
+  static_assert(width == 32 || width == 64, "");
+  constexpr int kNumVectors = width / 16;
+  const auto* const top_ptr = static_cast<const uint16_t*>(top_row);
+  const auto* const left_ptr = static_cast<const uint16_t*>(left_column);
+  const __m256i top_left = _mm256_set1_epi16(top_ptr[-1]);
+  __m256i top[kNumVectors], top_diffs[kNumVectors], p_left[kNumVectors];
+  for (int i = 0; i < kNumVectors; ++i) {
+    top[i] = LoadUnaligned32(top_ptr + i * 16);
+    top_diffs[i] = _mm256_sub_epi16(top[i], top_left);
+    p_left[i] = _mm256_abs_epi16(top_diffs[i]);
+  }
+  auto* dst = static_cast<uint16_t*>(dest);
+  stride /= sizeof(dst[0]);
+  int y = 0;
+  do {
+    const __m256i left = _mm256_set1_epi16(left_ptr[y]);
+    const __m256i left_diff = _mm256_sub_epi16(left, top_left);
+    const __m256i p_top = _mm256_abs_epi16(left_diff);
+    for (int i = 0; i < kNumVectors; ++i) {
+      StoreUnaligned32(dst + i * 16,
+                       Paeth16(top[i], top_left, top_diffs[i], p_left[i], left,
+                               left_diff, p_top));
+    }
+    dst += stride;
+  } while (++y < height);
+}
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+  static_cast<void>(dsp);
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x8_IntraPredictorDcTop)
+  dsp->intra_predictors[kTransformSize32x8][kIntraPredictorDcTop] =
+      DcDefs::_32x8::DcTop;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x16_IntraPredictorDcTop)
+  dsp->intra_predictors[kTransformSize32x16][kIntraPredictorDcTop] =
+      DcDefs::_32x16::DcTop;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x32_IntraPredictorDcTop)
+  dsp->intra_predictors[kTransformSize32x32][kIntraPredictorDcTop] =
+      DcDefs::_32x32::DcTop;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x64_IntraPredictorDcTop)
+  dsp->intra_predictors[kTransformSize32x64][kIntraPredictorDcTop] =
+      DcDefs::_32x64::DcTop;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x16_IntraPredictorDcTop)
+  dsp->intra_predictors[kTransformSize64x16][kIntraPredictorDcTop] =
+      DcDefs::_64x16::DcTop;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x32_IntraPredictorDcTop)
+  dsp->intra_predictors[kTransformSize64x32][kIntraPredictorDcTop] =
+      DcDefs::_64x32::DcTop;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x64_IntraPredictorDcTop)
+  dsp->intra_predictors[kTransformSize64x64][kIntraPredictorDcTop] =
+      DcDefs::_64x64::DcTop;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x8_IntraPredictorDcLeft)
+  dsp->intra_predictors[kTransformSize32x8][kIntraPredictorDcLeft] =
+      DcDefs::_32x8::DcLeft;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x16_IntraPredictorDcLeft)
+  dsp->intra_predictors[kTransformSize32x16][kIntraPredictorDcLeft] =
+      DcDefs::_32x16::DcLeft;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x32_IntraPredictorDcLeft)
+  dsp->intra_predictors[kTransformSize32x32][kIntraPredictorDcLeft] =
+      DcDefs::_32x32::DcLeft;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x64_IntraPredictorDcLeft)
+  dsp->intra_predictors[kTransformSize32x64][kIntraPredictorDcLeft] =
+      DcDefs::_32x64::DcLeft;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x16_IntraPredictorDcLeft)
+  dsp->intra_predictors[kTransformSize64x16][kIntraPredictorDcLeft] =
+      DcDefs::_64x16::DcLeft;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x32_IntraPredictorDcLeft)
+  dsp->intra_predictors[kTransformSize64x32][kIntraPredictorDcLeft] =
+      DcDefs::_64x32::DcLeft;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x64_IntraPredictorDcLeft)
+  dsp->intra_predictors[kTransformSize64x64][kIntraPredictorDcLeft] =
+      DcDefs::_64x64::DcLeft;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x8_IntraPredictorDc)
+  dsp->intra_predictors[kTransformSize32x8][kIntraPredictorDc] =
+      DcDefs::_32x8::Dc;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x16_IntraPredictorDc)
+  dsp->intra_predictors[kTransformSize32x16][kIntraPredictorDc] =
+      DcDefs::_32x16::Dc;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x32_IntraPredictorDc)
+  dsp->intra_predictors[kTransformSize32x32][kIntraPredictorDc] =
+      DcDefs::_32x32::Dc;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x64_IntraPredictorDc)
+  dsp->intra_predictors[kTransformSize32x64][kIntraPredictorDc] =
+      DcDefs::_32x64::Dc;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x16_IntraPredictorDc)
+  dsp->intra_predictors[kTransformSize64x16][kIntraPredictorDc] =
+      DcDefs::_64x16::Dc;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x32_IntraPredictorDc)
+  dsp->intra_predictors[kTransformSize64x32][kIntraPredictorDc] =
+      DcDefs::_64x32::Dc;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x64_IntraPredictorDc)
+  dsp->intra_predictors[kTransformSize64x64][kIntraPredictorDc] =
+      DcDefs::_64x64::Dc;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x8_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize32x8][kIntraPredictorPaeth] =
+      Paeth_AVX2<32, 8>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x16_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize32x16][kIntraPredictorPaeth] =
+      Paeth_AVX2<32, 16>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x32_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize32x32][kIntraPredictorPaeth] =
+      Paeth_AVX2<32, 32>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x64_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize32x64][kIntraPredictorPaeth] =
+      Paeth_AVX2<32, 64>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x16_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize64x16][kIntraPredictorPaeth] =
+      Paeth_AVX2<64, 16>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x32_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize64x32][kIntraPredictorPaeth] =
+      Paeth_AVX2<64, 32>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x64_IntraPredictorPaeth)
+  dsp->intra_predictors[kTransformSize64x64][kIntraPredictorPaeth] =
+      Paeth_AVX2<64, 64>;
+#endif
+}
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void IntraPredInit_AVX2() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif
+}
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !LIBGAV1_TARGETING_AVX2
+namespace libgav1 {
+namespace dsp {
+
+void IntraPredInit_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2
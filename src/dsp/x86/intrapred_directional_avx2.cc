@@ -0,0 +1,479 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/intrapred_directional.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2
+#include <immintrin.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/utils/common.h"
+#include "src/utils/memory.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace {
+
+//------------------------------------------------------------------------------
+// 7.11.2.4. Directional intra prediction process
+
+// An |xstep| of 64 corresponds to a 45 degree prediction, for which |shift| is
+// always 0 and each row is a copy of |top| offset by 1 pixel per row.
+template <typename Pixel>
+inline void DirectionalZone1_Step64(Pixel* dst, ptrdiff_t stride,
+                                    const Pixel* const top, const int width,
+                                    const int height) {
+  const Pixel* top_ptr = top + 1;
+  int y = height;
+  do {
+    memcpy(dst, top_ptr, width * sizeof(dst[0]));
+    dst += stride;
+    ++top_ptr;
+  } while (--y != 0);
+}
+
+// Returns the number of rows, starting from the top, in which every pixel is
+// computed from |top| without reaching |max_base_x|. The rows are not
+// upsampled. For row y, top_base_x = ((y + 1) * xstep) >> 6 and the last
+// pixel reads top[top_base_x + width], which must not exceed
+// top[max_base_x] = top[width + height - 1].
+inline int GetMaxNoCornerRows(const int height, const int xstep) {
+  return std::min(((height << 6) - 1) / xstep, height);
+}
+
+// Returns a vector of 16-bit lanes which are set where the pixel at
+// top_base_x + |offsets| is at or beyond |max_base_x|. |limits| holds
+// max_base_x - top_base_x - 1 for the row of each 128-bit lane.
+inline __m256i PastMaxBaseX(const __m256i offsets, const int limit0,
+                            const int limit1) {
+  const __m256i limits =
+      SetrM128i(_mm_set1_epi16(limit0), _mm_set1_epi16(limit1));
+  return _mm256_cmpgt_epi16(offsets, limits);
+}
+
+}  // namespace
+
+namespace low_bitdepth {
+namespace {
+
+// Returns the (32 - shift, shift) byte pairs for _mm256_maddubs_epi16().
+inline __m256i GetShifts(const int shift) {
+  return _mm256_set1_epi16(static_cast<int16_t>((shift << 8) | (32 - shift)));
+}
+
+// Interpolates 16 16-bit results from the byte pairs in |pairs| and rounds
+// them. The weights sum to 32, so the result fits in 13 bits.
+inline __m256i Interpolate(const __m256i pairs, const __m256i shifts) {
+  const __m256i sums = _mm256_maddubs_epi16(pairs, shifts);
+  return _mm256_srli_epi16(_mm256_add_epi16(sums, _mm256_set1_epi16(16)), 5);
+}
+
+// Computes 32 pixels from |a| = top[top_base_x + x] and
+// |b| = top[top_base_x + x + 1].
+inline __m256i Interpolate32(const __m256i a, const __m256i b,
+                             const __m256i shifts) {
+  // The unpacked pairs hold pixels {0-7, 16-23} and {8-15, 24-31}. Packing
+  // them restores the pixel order.
+  const __m256i lo = Interpolate(_mm256_unpacklo_epi8(a, b), shifts);
+  const __m256i hi = Interpolate(_mm256_unpackhi_epi8(a, b), shifts);
+  return _mm256_packus_epi16(lo, hi);
+}
+
+// Computes 16 pixels. See Interpolate32().
+inline __m128i Interpolate16(const __m128i a, const __m128i b,
+                             const __m256i shifts) {
+  const __m256i pairs =
+      SetrM128i(_mm_unpacklo_epi8(a, b), _mm_unpackhi_epi8(a, b));
+  const __m256i vals = Interpolate(pairs, shifts);
+  return _mm_packus_epi16(_mm256_castsi256_si128(vals),
+                          _mm256_extracti128_si256(vals, 1));
+}
+
+// Width 4 and 8. Each 128-bit lane computes 8 pixels of one row so that 2 rows
+// are produced per iteration. These are the only block widths which may be
+// upsampled.
+inline void DirectionalZone1_4xH_8xH(uint8_t* dst, ptrdiff_t stride,
+                                     const uint8_t* const top, const int width,
+                                     const int height, const int xstep,
+                                     const bool upsampled) {
+  assert(width == 4 || width == 8);
+  assert(height % 2 == 0);
+  const int upsample_shift = static_cast<int>(upsampled);
+  const int scale_bits = 6 - upsample_shift;
+  const int max_base_x = ((width + height) - 1) << upsample_shift;
+  // Upsampled pixels are already paired in |top|, otherwise pixel i uses
+  // top[i] and top[i + 1].
+  const __m128i sampler =
+      upsampled ? _mm_set_epi32(0x0F0E0D0C, 0x0B0A0908, 0x07060504, 0x03020100)
+                : _mm_set_epi32(0x08070706, 0x06050504, 0x04030302, 0x02010100);
+  const __m256i samplers = SetrM128i(sampler, sampler);
+  const __m256i offsets = _mm256_slli_epi16(
+      _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7),
+      upsample_shift);
+  const __m256i final_top_val = _mm256_set1_epi16(top[max_base_x]);
+
+  int top_x = xstep;
+  int y = 0;
+  do {
+    const int top_base_x0 = top_x >> scale_bits;
+    if (top_base_x0 >= max_base_x) break;
+    const int top_x1 = top_x + xstep;
+    // The values loaded for a row which is past |max_base_x| are replaced,
+    // limit the read to the end of |top|.
+    const int top_base_x1 = std::min(top_x1 >> scale_bits, max_base_x);
+    // Permit negative values of |top_x|.
+    const int shift0 = (LeftShift(top_x, upsample_shift) & 0x3F) >> 1;
+    const int shift1 = (LeftShift(top_x1, upsample_shift) & 0x3F) >> 1;
+    const __m256i shifts = _mm256_permute2x128_si256(
+        GetShifts(shift0), GetShifts(shift1), 0x20);
+    const __m256i vals = SetrM128i(LoadUnaligned16(top + top_base_x0),
+                                   LoadUnaligned16(top + top_base_x1));
+    __m256i pred = Interpolate(_mm256_shuffle_epi8(vals, samplers), shifts);
+    const __m256i past_max =
+        PastMaxBaseX(offsets, max_base_x - top_base_x0 - 1,
+                     max_base_x - (top_x1 >> scale_bits) - 1);
+    pred = _mm256_blendv_epi8(pred, final_top_val, past_max);
+    pred = _mm256_packus_epi16(pred, pred);
+    if (width == 4) {
+      Store4(dst, _mm256_castsi256_si128(pred));
+      Store4(dst + stride, _mm256_extracti128_si256(pred, 1));
+    } else {
+      StoreLo8(dst, _mm256_castsi256_si128(pred));
+      StoreLo8(dst + stride, _mm256_extracti128_si256(pred, 1));
+    }
+    dst += stride << 1;
+    top_x = top_x1 + xstep;
+    y += 2;
+  } while (y < height);
+
+  // Fill in corner-only rows.
+  for (; y < height; ++y) {
+    memset(dst, top[max_base_x], width);
+    dst += stride;
+  }
+}
+
+// Width 16 and above. These blocks are never upsampled.
+inline void DirectionalZone1_Large(uint8_t* dst, ptrdiff_t stride,
+                                   const uint8_t* const top, const int width,
+                                   const int height, const int xstep) {
+  const int max_base_x = (width + height) - 1;
+  const int max_no_corner_y = GetMaxNoCornerRows(height, xstep);
+
+  int top_x = xstep;
+  int y = 0;
+  if (width == 16) {
+    for (; y < max_no_corner_y; ++y, dst += stride, top_x += xstep) {
+      const uint8_t* const top_ptr = top + (top_x >> 6);
+      const __m256i shifts = GetShifts((top_x & 0x3F) >> 1);
+      StoreUnaligned16(dst, Interpolate16(LoadUnaligned16(top_ptr),
+                                          LoadUnaligned16(top_ptr + 1),
+                                          shifts));
+    }
+  } else {
+    for (; y < max_no_corner_y; ++y, dst += stride, top_x += xstep) {
+      const uint8_t* const top_ptr = top + (top_x >> 6);
+      const __m256i shifts = GetShifts((top_x & 0x3F) >> 1);
+      int x = 0;
+      do {
+        const __m256i a = LoadUnaligned32(top_ptr + x);
+        const __m256i b = LoadUnaligned32(top_ptr + x + 1);
+        StoreUnaligned32(dst + x, Interpolate32(a, b, shifts));
+        x += 32;
+      } while (x < width);
+    }
+  }
+
+  // The remaining rows reach |max_base_x|. They are computed 8 pixels at a
+  // time so that at most 7 pixels are read beyond |max_base_x|.
+  const __m128i offsets = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m128i final_top_val = _mm_set1_epi16(top[max_base_x]);
+  for (; y < height; ++y, dst += stride, top_x += xstep) {
+    const int top_base_x = top_x >> 6;
+    if (top_base_x >= max_base_x) break;
+    const __m128i shifts =
+        _mm256_castsi256_si128(GetShifts((top_x & 0x3F) >> 1));
+    const int num_pixels = max_base_x - top_base_x;
+    assert(num_pixels < width);
+    int x = 0;
+    do {
+      const __m128i a = LoadLo8(top + top_base_x + x);
+      const __m128i b = LoadLo8(top + top_base_x + x + 1);
+      const __m128i sums = _mm_maddubs_epi16(_mm_unpacklo_epi8(a, b), shifts);
+      const __m128i vals =
+          _mm_srli_epi16(_mm_add_epi16(sums, _mm_set1_epi16(16)), 5);
+      const __m128i past_max =
+          _mm_cmpgt_epi16(offsets, _mm_set1_epi16(num_pixels - x - 1));
+      const __m128i pred = _mm_blendv_epi8(vals, final_top_val, past_max);
+      StoreLo8(dst + x, _mm_packus_epi16(pred, pred));
+      x += 8;
+    } while (x < num_pixels);
+    memset(dst + x, top[max_base_x], width - x);
+  }
+
+  // Fill in corner-only rows.
+  for (; y < height; ++y) {
+    memset(dst, top[max_base_x], width);
+    dst += stride;
+  }
+}
+
+void DirectionalIntraPredictorZone1_AVX2(void* const dest, ptrdiff_t stride,
+                                         const void* const top_row,
+                                         const int width, const int height,
+                                         const int xstep,
+                                         const bool upsampled_top) {
+  const auto* const top = static_cast<const uint8_t*>(top_row);
+  auto* dst = static_cast<uint8_t*>(dest);
+  if (xstep == 64) {
+    assert(!upsampled_top);
+    DirectionalZone1_Step64(dst, stride, top, width, height);
+    return;
+  }
+  if (width <= 8) {
+    DirectionalZone1_4xH_8xH(dst, stride, top, width, height, xstep,
+                             upsampled_top);
+    return;
+  }
+  assert(!upsampled_top);
+  DirectionalZone1_Large(dst, stride, top, width, height, xstep);
+}
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+  static_cast<void>(dsp);
+#if DSP_ENABLED_8BPP_AVX2(DirectionalIntraPredictorZone1)
+  dsp->directional_intra_predictor_zone1 = DirectionalIntraPredictorZone1_AVX2;
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+//------------------------------------------------------------------------------
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+// 10bpp interpolation is computed in 16 bits as
+//   ((a << 5) + (b - a) * shift + 16) >> 5.
+// The true value before rounding is in [0, 1023 * 32], so the products and
+// sums cannot overflow.
+inline __m256i Interpolate(const __m256i a, const __m256i b,
+                           const __m256i shift) {
+  const __m256i sums =
+      _mm256_add_epi16(_mm256_slli_epi16(a, 5),
+                       _mm256_mullo_epi16(_mm256_sub_epi16(b, a), shift));
+  return _mm256_srli_epi16(_mm256_add_epi16(sums, _mm256_set1_epi16(16)), 5);
+}
+
+inline __m128i Interpolate8(const __m128i a, const __m128i b,
+                            const __m128i shift) {
+  const __m128i sums = _mm_add_epi16(
+      _mm_slli_epi16(a, 5), _mm_mullo_epi16(_mm_sub_epi16(b, a), shift));
+  return _mm_srli_epi16(_mm_add_epi16(sums, _mm_set1_epi16(16)), 5);
+}
+
+// Width 4 and 8. Each 128-bit lane computes 8 pixels of one row so that 2 rows
+// are produced per iteration. These are the only block widths which may be
+// upsampled.
+inline void DirectionalZone1_4xH_8xH(uint16_t* dst, ptrdiff_t stride,
+                                     const uint16_t* const top,
+                                     const int width, const int height,
+                                     const int xstep, const bool upsampled) {
+  assert(width == 4 || width == 8);
+  assert(height % 2 == 0);
+  const int upsample_shift = static_cast<int>(upsampled);
+  const int scale_bits = 6 - upsample_shift;
+  const int max_base_x = ((width + height) - 1) << upsample_shift;
+  const __m256i offsets = _mm256_slli_epi16(
+      _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7),
+      upsample_shift);
+  const __m256i final_top_val = _mm256_set1_epi16(top[max_base_x]);
+
+  int top_x = xstep;
+  int y = 0;
+  do {
+    const int top_base_x0 = top_x >> scale_bits;
+    if (top_base_x0 >= max_base_x) break;
+    const int top_x1 = top_x + xstep;
+    // The values loaded for a row which is past |max_base_x| are replaced,
+    // limit the read to the end of |top|.
+    const int top_base_x1 = std::min(top_x1 >> scale_bits, max_base_x);
+    // Permit negative values of |top_x|.
+    const int shift0 = (LeftShift(top_x, upsample_shift) & 0x3F) >> 1;
+    const int shift1 = (LeftShift(top_x1, upsample_shift) & 0x3F) >> 1;
+    const uint16_t* const top0 = top + top_base_x0;
+    const uint16_t* const top1 = top + top_base_x1;
+    __m256i pred;
+    if (upsampled) {
+      // The pixels are already paired in |top|: (32 - shift, shift) pairs.
+      const __m256i shifts = SetrM128i(
+          _mm_set1_epi32(((shift0 << 16) | (32 - shift0))),
+          _mm_set1_epi32(((shift1 << 16) | (32 - shift1))));
+      const __m256i rounding = _mm256_set1_epi32(16);
+      const __m256i sums_lo = _mm256_madd_epi16(
+          SetrM128i(LoadUnaligned16(top0), LoadUnaligned16(top1)), shifts);
+      const __m256i sums_hi = _mm256_madd_epi16(
+          SetrM128i(LoadUnaligned16(top0 + 8), LoadUnaligned16(top1 + 8)),
+          shifts);
+      pred = _mm256_packus_epi32(
+          _mm256_srli_epi32(_mm256_add_epi32(sums_lo, rounding), 5),
+          _mm256_srli_epi32(_mm256_add_epi32(sums_hi, rounding), 5));
+    } else {
+      const __m256i shifts =
+          SetrM128i(_mm_set1_epi16(shift0), _mm_set1_epi16(shift1));
+      const __m256i a = SetrM128i(LoadUnaligned16(top0), LoadUnaligned16(top1));
+      const __m256i b =
+          SetrM128i(LoadUnaligned16(top0 + 1), LoadUnaligned16(top1 + 1));
+      pred = Interpolate(a, b, shifts);
+    }
+    const __m256i past_max =
+        PastMaxBaseX(offsets, max_base_x - top_base_x0 - 1,
+                     max_base_x - (top_x1 >> scale_bits) - 1);
+    pred = _mm256_blendv_epi8(pred, final_top_val, past_max);
+    if (width == 4) {
+      StoreLo8(dst, _mm256_castsi256_si128(pred));
+      StoreLo8(dst + stride, _mm256_extracti128_si256(pred, 1));
+    } else {
+      StoreUnaligned16(dst, _mm256_castsi256_si128(pred));
+      StoreUnaligned16(dst + stride, _mm256_extracti128_si256(pred, 1));
+    }
+    dst += stride << 1;
+    top_x = top_x1 + xstep;
+    y += 2;
+  } while (y < height);
+
+  // Fill in corner-only rows.
+  for (; y < height; ++y) {
+    Memset(dst, top[max_base_x], width);
+    dst += stride;
+  }
+}
+
+// Width 16 and above. These blocks are never upsampled.
+inline void DirectionalZone1_Large(uint16_t* dst, ptrdiff_t stride,
+                                   const uint16_t* const top, const int width,
+                                   const int height, const int xstep) {
+  const int max_base_x = (width + height) - 1;
+  const int max_no_corner_y = GetMaxNoCornerRows(height, xstep);
+
+  int top_x = xstep;
+  int y = 0;
+  for (; y < max_no_corner_y; ++y, dst += stride, top_x += xstep) {
+    const uint16_t* const top_ptr = top + (top_x >> 6);
+    const __m256i shift = _mm256_set1_epi16((top_x & 0x3F) >> 1);
+    int x = 0;
+    do {
+      StoreUnaligned32(dst + x, Interpolate(LoadUnaligned32(top_ptr + x),
+                                            LoadUnaligned32(top_ptr + x + 1),
+                                            shift));
+      x += 16;
+    } while (x < width);
+  }
+
+  // The remaining rows reach |max_base_x|. They are computed 8 pixels at a
+  // time so that at most 7 pixels are read beyond |max_base_x|.
+  const __m128i offsets = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m128i final_top_val = _mm_set1_epi16(top[max_base_x]);
+  for (; y < height; ++y, dst += stride, top_x += xstep) {
+    const int top_base_x = top_x >> 6;
+    if (top_base_x >= max_base_x) break;
+    const __m128i shift = _mm_set1_epi16((top_x & 0x3F) >> 1);
+    const int num_pixels = max_base_x - top_base_x;
+    assert(num_pixels < width);
+    int x = 0;
+    do {
+      const uint16_t* const top_ptr = top + top_base_x + x;
+      const __m128i vals = Interpolate8(LoadUnaligned16(top_ptr),
+                                        LoadUnaligned16(top_ptr + 1), shift);
+      const __m128i past_max =
+          _mm_cmpgt_epi16(offsets, _mm_set1_epi16(num_pixels - x - 1));
+      StoreUnaligned16(dst + x, _mm_blendv_epi8(vals, final_top_val, past_max));
+      x += 8;
+    } while (x < num_pixels);
+    Memset(dst + x, top[max_base_x], width - x);
+  }
+
+  // Fill in corner-only rows.
+  for (; y < height; ++y) {
+    Memset(dst, top[max_base_x], width);
+    dst += stride;
+  }
+}
+
+void DirectionalIntraPredictorZone1_AVX2(void* const dest, ptrdiff_t stride,
+                                         const void* const top_row,
+                                         const int width, const int height,
+                                         const int xstep,
+                                         const bool upsampled_top) {
+  const auto* const top = static_cast<const uint16_t*>(top_row);
+  auto* dst = static_cast<uint16_t*>(dest);
+  stride /= sizeof(dst[0]);
+  if (xstep == 64) {
+    assert(!upsampled_top);
+    DirectionalZone1_Step64(dst, stride, top, width, height);
+    return;
+  }
+  if (width <= 8) {
+    DirectionalZone1_4xH_8xH(dst, stride, top, width, height, xstep,
+                             upsampled_top);
+    return;
+  }
+  assert(!upsampled_top);
+  DirectionalZone1_Large(dst, stride, top, width, height, xstep);
+}
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+  static_cast<void>(dsp);
+#if DSP_ENABLED_10BPP_AVX2(DirectionalIntraPredictorZone1)
+  dsp->directional_intra_predictor_zone1 = DirectionalIntraPredictorZone1_AVX2;
+#endif
+}
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void IntraPredDirectionalInit_AVX2() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif
+}
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !LIBGAV1_TARGETING_AVX2
+namespace libgav1 {
+namespace dsp {
+
+void IntraPredDirectionalInit_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2
@@ -0,0 +1,544 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/intrapred_smooth.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/utils/common.h"
+#include "src/utils/constants.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace {
+
+// Note these constants are duplicated from intrapred.cc to allow the compiler
+// to have visibility of the values.
+constexpr uint8_t kSmoothWeights[] = {
+#include "src/dsp/smooth_weights.inc"
+};
+
+// Packs |lo| and |hi| into one 32-bit lane as (lo, hi) 16-bit pairs for use
+// with _mm256_madd_epi16().
+inline __m256i SetPair_epi16(const int lo, const int hi) {
+  return _mm256_set1_epi32(static_cast<int>(
+      static_cast<uint16_t>(lo) | (static_cast<uint32_t>(hi) << 16)));
+}
+
+// Loads 16 weights, zero extended to 16 bits.
+inline __m256i LoadWeights16(const uint8_t* const weights) {
+  return _mm256_cvtepu8_epi16(LoadUnaligned16(weights));
+}
+
+}  // namespace
+
+//------------------------------------------------------------------------------
+namespace low_bitdepth {
+namespace {
+
+// The weights are scaled by 2^8 (kSmoothWeightScale).
+//
+// SmoothVertical and SmoothHorizontal are computed as
+//   ((base << 8) + 128 + weight * (pixel - base)) >> 8
+// modulo 2^16. The true value before the shift is in [0, 65408], so the
+// wrapped 16-bit arithmetic is exact.
+
+// Packs two sets of 16 16-bit predictions into 32 bytes in column order and
+// stores them.
+inline void StorePacked32(uint8_t* const dst, const __m256i pred0,
+                          const __m256i pred1) {
+  // _mm256_packus_epi16() interleaves the 128-bit lanes of its inputs.
+  StoreUnaligned32(
+      dst, _mm256_permute4x64_epi64(_mm256_packus_epi16(pred0, pred1), 0xd8));
+}
+
+template <int width, int height>
+void SmoothVertical_AVX2(void* LIBGAV1_RESTRICT const dest, ptrdiff_t stride,
+                         const void* LIBGAV1_RESTRICT const top_row,
+                         const void* LIBGAV1_RESTRICT const left_column) {
+  static_assert(width == 32 || width == 64, "");
+  constexpr int kNumVectors = width / 16;
+  const auto* const top_ptr = static_cast<const uint8_t*>(top_row);
+  const auto* const left_ptr = static_cast<const uint8_t*>(left_column);
+  const uint8_t* const weights_y = kSmoothWeights + height - 4;
+  const int bottom_left = left_ptr[height - 1];
+  const __m256i bottom_left_v = _mm256_set1_epi16(bottom_left);
+  const __m256i round_bottom_left =
+      _mm256_set1_epi16(static_cast<int16_t>((bottom_left << 8) + 128));
+  __m256i top_diffs[kNumVectors];
+  for (int i = 0; i < kNumVectors; ++i) {
+    top_diffs[i] = _mm256_sub_epi16(
+        _mm256_cvtepu8_epi16(LoadUnaligned16(top_ptr + i * 16)),
+        bottom_left_v);
+  }
+  auto* dst = static_cast<uint8_t*>(dest);
+  int y = 0;
+  do {
+    const __m256i weight = _mm256_set1_epi16(weights_y[y]);
+    for (int i = 0; i < kNumVectors; i += 2) {
+      const __m256i pred0 = _mm256_srli_epi16(
+          _mm256_add_epi16(_mm256_mullo_epi16(top_diffs[i], weight),
+                           round_bottom_left),
+          8);
+      const __m256i pred1 = _mm256_srli_epi16(
+          _mm256_add_epi16(_mm256_mullo_epi16(top_diffs[i + 1], weight),
+                           round_bottom_left),
+          8);
+      StorePacked32(dst + i * 16, pred0, pred1);
+    }
+    dst += stride;
+  } while (++y < height);
+}
+
+template <int width, int height>
+void SmoothHorizontal_AVX2(void* LIBGAV1_RESTRICT const dest,
+                           ptrdiff_t stride,
+                           const void* LIBGAV1_RESTRICT const top_row,
+                           const void* LIBGAV1_RESTRICT const left_column) {
+  static_assert(width == 32 || width == 64, "");
+  constexpr int kNumVectors = width / 16;
+  const auto* const top_ptr = static_cast<const uint8_t*>(top_row);
+  const auto* const left_ptr = static_cast<const uint8_t*>(left_column);
+  const uint8_t* const weights_x = kSmoothWeights + width - 4;
+  const int top_right = top_ptr[width - 1];
+  const __m256i round_top_right =
+      _mm256_set1_epi16(static_cast<int16_t>((top_right << 8) + 128));
+  __m256i weights[kNumVectors];
+  for (int i = 0; i < kNumVectors; ++i) {
+    weights[i] = LoadWeights16(weights_x + i * 16);
+  }
+  auto* dst = static_cast<uint8_t*>(dest);
+  int y = 0;
+  do {
+    const __m256i left_diff = _mm256_set1_epi16(left_ptr[y] - top_right);
+    for (int i = 0; i < kNumVectors; i += 2) {
+      const __m256i pred0 = _mm256_srli_epi16(
+          _mm256_add_epi16(_mm256_mullo_epi16(weights[i], left_diff),
+                           round_top_right),
+          8);
+      const __m256i pred1 = _mm256_srli_epi16(
+          _mm256_add_epi16(_mm256_mullo_epi16(weights[i + 1], left_diff),
+                           round_top_right),
+          8);
+      StorePacked32(dst + i * 16, pred0, pred1);
+    }
+    dst += stride;
+  } while (++y < height);
+}
+
+// Smooth is computed in 32 bits as
+//   (w_y * (top - bottom_left) + w_x * (left - top_right) +
+//    ((bottom_left + top_right) << 8) + 256) >> 9
+// with one _mm256_madd_epi16() per 8 pixels. The per column terms
+// (top - bottom_left, w_x) are interleaved in an order that allows the results
+// to be packed back to bytes without a permute.
+template <int width, int height>
+void Smooth_AVX2(void* LIBGAV1_RESTRICT const dest, ptrdiff_t stride,
+                 const void* LIBGAV1_RESTRICT const top_row,
+                 const void* LIBGAV1_RESTRICT const left_column) {
+  static_assert(width == 32 || width == 64, "");
+  constexpr int kNumVectors = width / 8;
+  const auto* const top_ptr = static_cast<const uint8_t*>(top_row);
+  const auto* const left_ptr = static_cast<const uint8_t*>(left_column);
+  const uint8_t* const weights_x = kSmoothWeights + width - 4;
+  const uint8_t* const weights_y = kSmoothWeights + height - 4;
+  const int top_right = top_ptr[width - 1];
+  const int bottom_left = left_ptr[height - 1];
+  const __m256i bottom_left_v = _mm256_set1_epi16(bottom_left);
+  const __m256i round = _mm256_set1_epi32(((bottom_left + top_right) << 8) +
+                                          (1 << kSmoothWeightScale));
+  // For each group of 32 columns, |columns| holds the pairs for columns
+  // {0-3, 16-19}, {4-7, 20-23}, {8-11, 24-27} and {12-15, 28-31}.
+  __m256i columns[kNumVectors];
+  for (int i = 0; i < kNumVectors; i += 4) {
+    const int x = i * 8;
+    const __m256i top0 = _mm256_sub_epi16(
+        _mm256_cvtepu8_epi16(LoadUnaligned16(top_ptr + x)), bottom_left_v);
+    const __m256i top1 = _mm256_sub_epi16(
+        _mm256_cvtepu8_epi16(LoadUnaligned16(top_ptr + x + 16)),
+        bottom_left_v);
+    const __m256i weights0 = LoadWeights16(weights_x + x);
+    const __m256i weights1 = LoadWeights16(weights_x + x + 16);
+    const __m256i top_lo = _mm256_permute2x128_si256(top0, top1, 0x20);
+    const __m256i top_hi = _mm256_permute2x128_si256(top0, top1, 0x31);
+    const __m256i weights_lo =
+        _mm256_permute2x128_si256(weights0, weights1, 0x20);
+    const __m256i weights_hi =
+        _mm256_permute2x128_si256(weights0, weights1, 0x31);
+    columns[i + 0] = _mm256_unpacklo_epi16(top_lo, weights_lo);
+    columns[i + 1] = _mm256_unpackhi_epi16(top_lo, weights_lo);
+    columns[i + 2] = _mm256_unpacklo_epi16(top_hi, weights_hi);
+    columns[i + 3] = _mm256_unpackhi_epi16(top_hi, weights_hi);
+  }
+  auto* dst = static_cast<uint8_t*>(dest);
+  int y = 0;
+  do {
+    const __m256i row = SetPair_epi16(weights_y[y], left_ptr[y] - top_right);
+    for (int i = 0; i < kNumVectors; i += 4) {
+      __m256i pred[4];
+      for (int j = 0; j < 4; ++j) {
+        pred[j] = _mm256_srli_epi32(
+            _mm256_add_epi32(_mm256_madd_epi16(columns[i + j], row), round),
+            kSmoothWeightScale + 1);
+      }
+      const __m256i pred_lo = _mm256_packs_epi32(pred[0], pred[1]);
+      const __m256i pred_hi = _mm256_packs_epi32(pred[2], pred[3]);
+      StoreUnaligned32(dst + i * 8, _mm256_packus_epi16(pred_lo, pred_hi));
+    }
+    dst += stride;
+  } while (++y < height);
+}
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+  static_cast<void>(dsp);
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x8_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize32x8][kIntraPredictorSmooth] =
+      Smooth_AVX2<32, 8>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x16_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize32x16][kIntraPredictorSmooth] =
+      Smooth_AVX2<32, 16>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x32_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize32x32][kIntraPredictorSmooth] =
+      Smooth_AVX2<32, 32>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x64_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize32x64][kIntraPredictorSmooth] =
+      Smooth_AVX2<32, 64>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x16_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize64x16][kIntraPredictorSmooth] =
+      Smooth_AVX2<64, 16>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x32_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize64x32][kIntraPredictorSmooth] =
+      Smooth_AVX2<64, 32>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x64_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize64x64][kIntraPredictorSmooth] =
+      Smooth_AVX2<64, 64>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x8_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize32x8][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<32, 8>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x16_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize32x16][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<32, 16>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x32_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize32x32][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<32, 32>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x64_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize32x64][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<32, 64>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x16_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize64x16][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<64, 16>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x32_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize64x32][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<64, 32>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x64_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize64x64][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<64, 64>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x8_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize32x8][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<32, 8>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x16_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize32x16][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<32, 16>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x32_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize32x32][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<32, 32>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize32x64_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize32x64][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<32, 64>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x16_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize64x16][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<64, 16>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x32_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize64x32][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<64, 32>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(TransformSize64x64_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize64x64][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<64, 64>;
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+//------------------------------------------------------------------------------
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+// 10bpp products do not fit in 16 bits, so each predictor uses one
+// _mm256_madd_epi16() per 8 pixels. The pairs for 16 columns are split with
+// _mm256_unpack{lo,hi}_epi16() into columns {0-3, 8-11} and {4-7, 12-15},
+// which _mm256_packus_epi32() restores to column order.
+
+// Computes (madd(pairs, |row|) + |round|) >> |shift| for the two halves of 16
+// columns and stores the packed result.
+template <int shift>
+inline void WriteSmooth16(uint16_t* const dst, const __m256i pairs0,
+                          const __m256i pairs1, const __m256i row,
+                          const __m256i round) {
+  const __m256i pred0 = _mm256_srli_epi32(
+      _mm256_add_epi32(_mm256_madd_epi16(pairs0, row), round), shift);
+  const __m256i pred1 = _mm256_srli_epi32(
+      _mm256_add_epi32(_mm256_madd_epi16(pairs1, row), round), shift);
+  StoreUnaligned32(dst, _mm256_packus_epi32(pred0, pred1));
+}
+
+template <int width, int height>
+void SmoothVertical_AVX2(void* LIBGAV1_RESTRICT const dest, ptrdiff_t stride,
+                         const void* LIBGAV1_RESTRICT const top_row,
+                         const void* LIBGAV1_RESTRICT const left_column) {
+  static_assert(width == 32 || width == 64, "");
+  constexpr int kNumVectors = width / 8;
+  const auto* const top_ptr = static_cast<const uint16_t*>(top_row);
+  const auto* const left_ptr = static_cast<const uint16_t*>(left_column);
+  const uint8_t* const weights_y = kSmoothWeights + height - 4;
+  const __m256i bottom_left = _mm256_set1_epi16(left_ptr[height - 1]);
+  const __m256i round = _mm256_set1_epi32(1 << (kSmoothWeightScale - 1));
+  // (top, bottom_left) pairs.
+  __m256i columns[kNumVectors];
+  for (int i = 0; i < kNumVectors; i += 2) {
+    const __m256i top = LoadUnaligned32(top_ptr + i * 8);
+    columns[i + 0] = _mm256_unpacklo_epi16(top, bottom_left);
+    columns[i + 1] = _mm256_unpackhi_epi16(top, bottom_left);
+  }
+  auto* dst = static_cast<uint16_t*>(dest);
+  stride /= sizeof(dst[0]);
+  int y = 0;
+  do {
+    const __m256i row = SetPair_epi16(
+        weights_y[y], (1 << kSmoothWeightScale) - weights_y[y]);
+    for (int i = 0; i < kNumVectors; i += 2) {
+      WriteSmooth16<kSmoothWeightScale>(dst + i * 8, columns[i],
+                                        columns[i + 1], row, round);
+    }
+    dst += stride;
+  } while (++y < height);
+}
+
+template <int width, int height>
+void SmoothHorizontal_AVX2(void* LIBGAV1_RESTRICT const dest,
+                           ptrdiff_t stride,
+                           const void* LIBGAV1_RESTRICT const top_row,
+                           const void* LIBGAV1_RESTRICT const left_column) {
+  static_assert(width == 32 || width == 64, "");
+  constexpr int kNumVectors = width / 8;
+  const auto* const top_ptr = static_cast<const uint16_t*>(top_row);
+  const auto* const left_ptr = static_cast<const uint16_t*>(left_column);
+  const uint8_t* const weights_x = kSmoothWeights + width - 4;
+  const int top_right = top_ptr[width - 1];
+  const __m256i scale = _mm256_set1_epi16(1 << kSmoothWeightScale);
+  const __m256i round = _mm256_set1_epi32(1 << (kSmoothWeightScale - 1));
+  // (w_x, 256 - w_x) pairs.
+  __m256i columns[kNumVectors];
+  for (int i = 0; i < kNumVectors; i += 2) {
+    const __m256i weights = LoadWeights16(weights_x + i * 8);
+    const __m256i inverted_weights = _mm256_sub_epi16(scale, weights);
+    columns[i + 0] = _mm256_unpacklo_epi16(weights, inverted_weights);
+    columns[i + 1] = _mm256_unpackhi_epi16(weights, inverted_weights);
+  }
+  auto* dst = static_cast<uint16_t*>(dest);
+  stride /= sizeof(dst[0]);
+  int y = 0;
+  do {
+    const __m256i row = SetPair_epi16(left_ptr[y], top_right);
+    for (int i = 0; i < kNumVectors; i += 2) {
+      WriteSmooth16<kSmoothWeightScale>(dst + i * 8, columns[i],
+                                        columns[i + 1], row, round);
+    }
+    dst += stride;
+  } while (++y < height);
+}
+
+// See the 8bpp version. The (top - bottom_left, w_x) pairs use the same
+// formulation.
+template <int width, int height>
+void Smooth_AVX2(void* LIBGAV1_RESTRICT const dest, ptrdiff_t stride,
+                 const void* LIBGAV1_RESTRICT const top_row,
+                 const void* LIBGAV1_RESTRICT const left_column) {
+  static_assert(width == 32 || width == 64, "");
+  constexpr int kNumVectors = width / 8;
+  const auto* const top_ptr = static_cast<const uint16_t*>(top_row);
+  const auto* const left_ptr = static_cast<const uint16_t*>(left_column);
+  const uint8_t* const weights_x = kSmoothWeights + width - 4;
+  const uint8_t* const weights_y = kSmoothWeights + height - 4;
+  const int top_right = top_ptr[width - 1];
+  const int bottom_left = left_ptr[height - 1];
+  const __m256i bottom_left_v = _mm256_set1_epi16(bottom_left);
+  const __m256i round = _mm256_set1_epi32(((bottom_left + top_right) << 8) +
+                                          (1 << kSmoothWeightScale));
+  __m256i columns[kNumVectors];
+  for (int i = 0; i < kNumVectors; i += 2) {
+    const __m256i top =
+        _mm256_sub_epi16(LoadUnaligned32(top_ptr + i * 8), bottom_left_v);
+    const __m256i weights = LoadWeights16(weights_x + i * 8);
+    columns[i + 0] = _mm256_unpacklo_epi16(top, weights);
+    columns[i + 1] = _mm256_unpackhi_epi16(top, weights);
+  }
+  auto* dst = static_cast<uint16_t*>(dest);
+  stride /= sizeof(dst[0]);
+  int y = 0;
+  do {
+    const __m256i row = SetPair_epi16(weights_y[y], left_ptr[y] - top_right);
+    for (int i = 0; i < kNumVectors; i += 2) {
+      WriteSmooth16<kSmoothWeightScale + 1>(dst + i * 8, columns[i],
+                                            columns[i + 1], row, round);
+    }
+    dst += stride;
+  } while (++y < height);
+}
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+  static_cast<void>(dsp);
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x8_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize32x8][kIntraPredictorSmooth] =
+      Smooth_AVX2<32, 8>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x16_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize32x16][kIntraPredictorSmooth] =
+      Smooth_AVX2<32, 16>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x32_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize32x32][kIntraPredictorSmooth] =
+      Smooth_AVX2<32, 32>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x64_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize32x64][kIntraPredictorSmooth] =
+      Smooth_AVX2<32, 64>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x16_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize64x16][kIntraPredictorSmooth] =
+      Smooth_AVX2<64, 16>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x32_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize64x32][kIntraPredictorSmooth] =
+      Smooth_AVX2<64, 32>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x64_IntraPredictorSmooth)
+  dsp->intra_predictors[kTransformSize64x64][kIntraPredictorSmooth] =
+      Smooth_AVX2<64, 64>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x8_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize32x8][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<32, 8>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x16_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize32x16][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<32, 16>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x32_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize32x32][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<32, 32>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x64_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize32x64][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<32, 64>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x16_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize64x16][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<64, 16>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x32_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize64x32][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<64, 32>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x64_IntraPredictorSmoothVertical)
+  dsp->intra_predictors[kTransformSize64x64][kIntraPredictorSmoothVertical] =
+      SmoothVertical_AVX2<64, 64>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x8_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize32x8][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<32, 8>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x16_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize32x16][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<32, 16>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x32_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize32x32][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<32, 32>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize32x64_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize32x64][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<32, 64>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x16_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize64x16][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<64, 16>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x32_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize64x32][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<64, 32>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(TransformSize64x64_IntraPredictorSmoothHorizontal)
+  dsp->intra_predictors[kTransformSize64x64][kIntraPredictorSmoothHorizontal] =
+      SmoothHorizontal_AVX2<64, 64>;
+#endif
+}
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void IntraPredSmoothInit_AVX2() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif
+}
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !LIBGAV1_TARGETING_AVX2
+namespace libgav1 {
+namespace dsp {
+
+void IntraPredSmoothInit_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2
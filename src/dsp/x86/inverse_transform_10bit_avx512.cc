@@ -0,0 +1,1071 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/inverse_transform.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX512 && LIBGAV1_MAX_BITDEPTH >= 10
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx512.h"
+#include "src/utils/array_2d.h"
+#include "src/utils/common.h"
+#include "src/utils/compiler_attributes.h"
+#include "src/utils/constants.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace {
+
+// Include the constants and utility functions inside the anonymous namespace.
+#include "src/dsp/inverse_transform.inc"
+
+//------------------------------------------------------------------------------
+
+// Transposes the 8x8 blocks held in each 256-bit half.
+LIBGAV1_ALWAYS_INLINE void Transpose8x8(const __m512i in[8], __m512i out[8]) {
+  // Transpose the 4x4 blocks held in each 128-bit lane.
+  const __m512i a0 = _mm512_unpacklo_epi32(in[0], in[1]);
+  const __m512i a1 = _mm512_unpackhi_epi32(in[0], in[1]);
+  const __m512i a2 = _mm512_unpacklo_epi32(in[2], in[3]);
+  const __m512i a3 = _mm512_unpackhi_epi32(in[2], in[3]);
+  const __m512i a4 = _mm512_unpacklo_epi32(in[4], in[5]);
+  const __m512i a5 = _mm512_unpackhi_epi32(in[4], in[5]);
+  const __m512i a6 = _mm512_unpacklo_epi32(in[6], in[7]);
+  const __m512i a7 = _mm512_unpackhi_epi32(in[6], in[7]);
+
+  const __m512i b0 = _mm512_unpacklo_epi64(a0, a2);
+  const __m512i b1 = _mm512_unpackhi_epi64(a0, a2);
+  const __m512i b2 = _mm512_unpacklo_epi64(a1, a3);
+  const __m512i b3 = _mm512_unpackhi_epi64(a1, a3);
+  const __m512i b4 = _mm512_unpacklo_epi64(a4, a6);
+  const __m512i b5 = _mm512_unpackhi_epi64(a4, a6);
+  const __m512i b6 = _mm512_unpacklo_epi64(a5, a7);
+  const __m512i b7 = _mm512_unpackhi_epi64(a5, a7);
+
+  // Swap the off-diagonal 4x4 blocks within each 256-bit half.
+  const __m512i lo = _mm512_setr_epi64(0, 1, 8, 9, 4, 5, 12, 13);
+  const __m512i hi = _mm512_setr_epi64(2, 3, 10, 11, 6, 7, 14, 15);
+  out[0] = _mm512_permutex2var_epi64(b0, lo, b4);
+  out[1] = _mm512_permutex2var_epi64(b1, lo, b5);
+  out[2] = _mm512_permutex2var_epi64(b2, lo, b6);
+  out[3] = _mm512_permutex2var_epi64(b3, lo, b7);
+  out[4] = _mm512_permutex2var_epi64(b0, hi, b4);
+  out[5] = _mm512_permutex2var_epi64(b1, hi, b5);
+  out[6] = _mm512_permutex2var_epi64(b2, hi, b6);
+  out[7] = _mm512_permutex2var_epi64(b3, hi, b7);
+}
+
+//------------------------------------------------------------------------------
+// Stores |store_count| rows of |num_lanes| int32_t values.
+template <int num_lanes, int store_count>
+LIBGAV1_ALWAYS_INLINE void StoreDst(int32_t* LIBGAV1_RESTRICT dst,
+                                    int32_t stride, int32_t idx,
+                                    const __m512i* const s) {
+  assert(store_count % 4 == 0);
+  for (int i = 0; i < store_count; ++i) {
+    if (num_lanes == 16) {
+      StoreUnaligned64(&dst[i * stride + idx], s[i]);
+    } else {
+      StoreUnaligned32(&dst[i * stride + idx], _mm512_castsi512_si256(s[i]));
+    }
+  }
+}
+
+// Loads |load_count| rows of |num_lanes| int32_t values. When |num_lanes| is 8
+// the upper 256 bits are left undefined.
+template <int num_lanes, int load_count>
+LIBGAV1_ALWAYS_INLINE void LoadSrc(const int32_t* LIBGAV1_RESTRICT src,
+                                   int32_t stride, int32_t idx, __m512i* x) {
+  assert(load_count % 4 == 0);
+  for (int i = 0; i < load_count; ++i) {
+    if (num_lanes == 16) {
+      x[i] = LoadUnaligned64(&src[i * stride + idx]);
+    } else {
+      x[i] = _mm512_castsi256_si512(LoadUnaligned32(&src[i * stride + idx]));
+    }
+  }
+}
+
+// Loads an 8x8 block from each of the |num_rows| / 8 row groups starting at
+// column |idx| of |src|. Rows [0, 8) go in the lower 256 bits and rows [8, 16)
+// in the upper 256 bits, which are left undefined when |num_rows| is 8.
+template <int num_rows>
+LIBGAV1_ALWAYS_INLINE void LoadRows8x8(const int32_t* LIBGAV1_RESTRICT src,
+                                       int32_t stride, int32_t idx,
+                                       __m512i* x) {
+  for (int i = 0; i < 8; ++i) {
+    const __m256i lo = LoadUnaligned32(&src[i * stride + idx]);
+    x[i] = (num_rows == 16)
+               ? SetrM256i(lo, LoadUnaligned32(&src[(i + 8) * stride + idx]))
+               : _mm512_castsi256_si512(lo);
+  }
+}
+
+template <int num_rows>
+LIBGAV1_ALWAYS_INLINE void StoreRows8x8(int32_t* LIBGAV1_RESTRICT dst,
+                                        int32_t stride, int32_t idx,
+                                        const __m512i* s) {
+  for (int i = 0; i < 8; ++i) {
+    StoreUnaligned32(&dst[i * stride + idx], _mm512_castsi512_si256(s[i]));
+    if (num_rows == 16) {
+      StoreUnaligned32(&dst[(i + 8) * stride + idx],
+                       _mm512_extracti64x4_epi64(s[i], 1));
+    }
+  }
+}
+
+// Returns |x| * |multiplier| using 32 bit lanes.
+LIBGAV1_ALWAYS_INLINE __m512i MultiplyBy(const __m512i x,
+                                         const int32_t multiplier) {
+  return _mm512_mullo_epi32(x, _mm512_set1_epi32(multiplier));
+}
+
+// Returns RightShiftWithRounding(|x| * kTransformRowMultiplier, 12).
+LIBGAV1_ALWAYS_INLINE __m512i ApplyRowMultiplier(const __m512i x) {
+  return RightShiftWithRounding_S32(MultiplyBy(x, kTransformRowMultiplier),
+                                    12);
+}
+
+// Saturates the 32 bit lanes of |x| to the int16_t range.
+LIBGAV1_ALWAYS_INLINE __m512i ClampToInt16(const __m512i x) {
+  return _mm512_max_epi32(_mm512_min_epi32(x, _mm512_set1_epi32(INT16_MAX)),
+                          _mm512_set1_epi32(INT16_MIN));
+}
+
+// Applies the row shift with rounding and saturates the result to the int16_t
+// range. |v_row_shift_add| is equal to |row_shift| as the max row_shift is 2.
+LIBGAV1_ALWAYS_INLINE __m512i ShiftResidual(const __m512i residual,
+                                            const __m512i v_row_shift_add,
+                                            const __m128i v_row_shift) {
+  const __m512i x = _mm512_add_epi32(residual, v_row_shift_add);
+  return ClampToInt16(_mm512_sra_epi32(x, v_row_shift));
+}
+
+// Butterfly rotate 16 values.
+LIBGAV1_ALWAYS_INLINE void ButterflyRotation_16(__m512i* a, __m512i* b,
+                                                const int angle,
+                                                const bool flip) {
+  const int32_t cos128 = Cos128(angle);
+  const int32_t sin128 = Sin128(angle);
+  const __m512i acc_x = MultiplyBy(*a, cos128);
+  const __m512i acc_y = MultiplyBy(*a, sin128);
+  // The max range for the input is 18 bits. The cos128/sin128 is 13 bits,
+  // which leaves 1 bit for the add/subtract. For 10bpp, x/y will fit in a 32
+  // bit lane.
+  const __m512i x0 = _mm512_sub_epi32(acc_x, MultiplyBy(*b, sin128));
+  const __m512i y0 = _mm512_add_epi32(acc_y, MultiplyBy(*b, cos128));
+  const __m512i x = RightShiftWithRounding_S32(x0, 12);
+  const __m512i y = RightShiftWithRounding_S32(y0, 12);
+  if (flip) {
+    *a = y;
+    *b = x;
+  } else {
+    *a = x;
+    *b = y;
+  }
+}
+
+LIBGAV1_ALWAYS_INLINE void ButterflyRotation_FirstIsZero(__m512i* a,
+                                                         __m512i* b,
+                                                         const int angle,
+                                                         const bool flip) {
+  const int32_t cos128 = Cos128(angle);
+  const int32_t sin128 = Sin128(angle);
+  assert(sin128 <= 0xfff);
+  const __m512i x0 = MultiplyBy(*b, -sin128);
+  const __m512i y0 = MultiplyBy(*b, cos128);
+  const __m512i x = RightShiftWithRounding_S32(x0, 12);
+  const __m512i y = RightShiftWithRounding_S32(y0, 12);
+  if (flip) {
+    *a = y;
+    *b = x;
+  } else {
+    *a = x;
+    *b = y;
+  }
+}
+
+LIBGAV1_ALWAYS_INLINE void ButterflyRotation_SecondIsZero(__m512i* a,
+                                                          __m512i* b,
+                                                          const int angle,
+                                                          const bool flip) {
+  const int32_t cos128 = Cos128(angle);
+  const int32_t sin128 = Sin128(angle);
+  const __m512i x0 = MultiplyBy(*a, cos128);
+  const __m512i y0 = MultiplyBy(*a, sin128);
+  const __m512i x = RightShiftWithRounding_S32(x0, 12);
+  const __m512i y = RightShiftWithRounding_S32(y0, 12);
+  if (flip) {
+    *a = y;
+    *b = x;
+  } else {
+    *a = x;
+    *b = y;
+  }
+}
+
+LIBGAV1_ALWAYS_INLINE void HadamardRotation(__m512i* a, __m512i* b, bool flip) {
+  __m512i x, y;
+  if (flip) {
+    y = _mm512_add_epi32(*b, *a);
+    x = _mm512_sub_epi32(*b, *a);
+  } else {
+    x = _mm512_add_epi32(*a, *b);
+    y = _mm512_sub_epi32(*a, *b);
+  }
+  *a = x;
+  *b = y;
+}
+
+LIBGAV1_ALWAYS_INLINE void HadamardRotation(__m512i* a, __m512i* b, bool flip,
+                                            const __m512i min,
+                                            const __m512i max) {
+  __m512i x, y;
+  if (flip) {
+    y = _mm512_add_epi32(*b, *a);
+    x = _mm512_sub_epi32(*b, *a);
+  } else {
+    x = _mm512_add_epi32(*a, *b);
+    y = _mm512_sub_epi32(*a, *b);
+  }
+  *a = _mm512_max_epi32(_mm512_min_epi32(x, max), min);
+  *b = _mm512_max_epi32(_mm512_min_epi32(y, max), min);
+}
+
+using ButterflyRotationFunc = void (*)(__m512i* a, __m512i* b, int angle,
+                                       bool flip);
+
+//------------------------------------------------------------------------------
+// Discrete Cosine Transforms (DCT).
+
+template <int width>
+LIBGAV1_ALWAYS_INLINE bool DctDcOnly(void* dest, int adjusted_tx_height,
+                                     bool should_round, int row_shift) {
+  if (adjusted_tx_height > 1) return false;
+
+  auto* dst = static_cast<int32_t*>(dest);
+  const __m512i v_src = _mm512_set1_epi32(dst[0]);
+  const __m512i s0 = should_round ? ApplyRowMultiplier(v_src) : v_src;
+  const int32_t cos128 = Cos128(32);
+  const __m512i xy = RightShiftWithRounding_S32(MultiplyBy(s0, cos128), 12);
+  const __m512i v_row_shift_add = _mm512_set1_epi32(row_shift);
+  const __m128i v_row_shift = _mm_cvtsi32_si128(row_shift);
+  const __m512i result = ShiftResidual(xy, v_row_shift_add, v_row_shift);
+  for (int i = 0; i < width; i += 16) {
+    StoreUnaligned64(dst, result);
+    dst += 16;
+  }
+  return true;
+}
+
+template <int height>
+LIBGAV1_ALWAYS_INLINE bool DctDcOnlyColumn(void* dest, int adjusted_tx_height,
+                                           int width) {
+  if (adjusted_tx_height > 1) return false;
+
+  auto* dst = static_cast<int32_t*>(dest);
+  const int32_t cos128 = Cos128(32);
+
+  // Calculate dc values for first row.
+  if (width == 8) {
+    const __m256i v_src = LoadUnaligned32(dst);
+    const __m256i xy = RightShiftWithRounding_S32(
+        _mm256_mullo_epi32(v_src, _mm256_set1_epi32(cos128)), 12);
+    StoreUnaligned32(dst, xy);
+  } else {
+    int i = 0;
+    do {
+      const __m512i v_src = LoadUnaligned64(&dst[i]);
+      const __m512i xy =
+          RightShiftWithRounding_S32(MultiplyBy(v_src, cos128), 12);
+      StoreUnaligned64(&dst[i], xy);
+      i += 16;
+    } while (i < width);
+  }
+
+  // Copy first row to the rest of the block.
+  for (int y = 1; y < height; ++y) {
+    memcpy(&dst[y * width], dst, width * sizeof(dst[0]));
+  }
+  return true;
+}
+
+template <ButterflyRotationFunc butterfly_rotation,
+          bool is_fast_butterfly = false>
+LIBGAV1_ALWAYS_INLINE void Dct4Stages(__m512i* s, const __m512i min,
+                                      const __m512i max,
+                                      const bool is_last_stage) {
+  // stage 12.
+  if (is_fast_butterfly) {
+    ButterflyRotation_SecondIsZero(&s[0], &s[1], 32, true);
+    ButterflyRotation_SecondIsZero(&s[2], &s[3], 48, false);
+  } else {
+    butterfly_rotation(&s[0], &s[1], 32, true);
+    butterfly_rotation(&s[2], &s[3], 48, false);
+  }
+
+  // stage 17.
+  if (is_last_stage) {
+    HadamardRotation(&s[0], &s[3], false);
+    HadamardRotation(&s[1], &s[2], false);
+  } else {
+    HadamardRotation(&s[0], &s[3], false, min, max);
+    HadamardRotation(&s[1], &s[2], false, min, max);
+  }
+}
+
+template <ButterflyRotationFunc butterfly_rotation,
+          bool is_fast_butterfly = false>
+LIBGAV1_ALWAYS_INLINE void Dct8Stages(__m512i* s, const __m512i min,
+                                      const __m512i max,
+                                      const bool is_last_stage) {
+  // stage 8.
+  if (is_fast_butterfly) {
+    ButterflyRotation_SecondIsZero(&s[4], &s[7], 56, false);
+    ButterflyRotation_FirstIsZero(&s[5], &s[6], 24, false);
+  } else {
+    butterfly_rotation(&s[4], &s[7], 56, false);
+    butterfly_rotation(&s[5], &s[6], 24, false);
+  }
+
+  // stage 13.
+  HadamardRotation(&s[4], &s[5], false, min, max);
+  HadamardRotation(&s[6], &s[7], true, min, max);
+
+  // stage 18.
+  butterfly_rotation(&s[6], &s[5], 32, true);
+
+  // stage 22.
+  if (is_last_stage) {
+    HadamardRotation(&s[0], &s[7], false);
+    HadamardRotation(&s[1], &s[6], false);
+    HadamardRotation(&s[2], &s[5], false);
+    HadamardRotation(&s[3], &s[4], false);
+  } else {
+    HadamardRotation(&s[0], &s[7], false, min, max);
+    HadamardRotation(&s[1], &s[6], false, min, max);
+    HadamardRotation(&s[2], &s[5], false, min, max);
+    HadamardRotation(&s[3], &s[4], false, min, max);
+  }
+}
+
+template <ButterflyRotationFunc butterfly_rotation,
+          bool is_fast_butterfly = false>
+LIBGAV1_ALWAYS_INLINE void Dct16Stages(__m512i* s, const __m512i min,
+                                       const __m512i max,
+                                       const bool is_last_stage) {
+  // stage 5.
+  if (is_fast_butterfly) {
+    ButterflyRotation_SecondIsZero(&s[8], &s[15], 60, false);
+    ButterflyRotation_FirstIsZero(&s[9], &s[14], 28, false);
+    ButterflyRotation_SecondIsZero(&s[10], &s[13], 44, false);
+    ButterflyRotation_FirstIsZero(&s[11], &s[12], 12, false);
+  } else {
+    butterfly_rotation(&s[8], &s[15], 60, false);
+    butterfly_rotation(&s[9], &s[14], 28, false);
+    butterfly_rotation(&s[10], &s[13], 44, false);
+    butterfly_rotation(&s[11], &s[12], 12, false);
+  }
+
+  // stage 9.
+  HadamardRotation(&s[8], &s[9], false, min, max);
+  HadamardRotation(&s[10], &s[11], true, min, max);
+  HadamardRotation(&s[12], &s[13], false, min, max);
+  HadamardRotation(&s[14], &s[15], true, min, max);
+
+  // stage 14.
+  butterfly_rotation(&s[14], &s[9], 48, true);
+  butterfly_rotation(&s[13], &s[10], 112, true);
+
+  // stage 19.
+  HadamardRotation(&s[8], &s[11], false, min, max);
+  HadamardRotation(&s[9], &s[10], false, min, max);
+  HadamardRotation(&s[12], &s[15], true, min, max);
+  HadamardRotation(&s[13], &s[14], true, min, max);
+
+  // stage 23.
+  butterfly_rotation(&s[13], &s[10], 32, true);
+  butterfly_rotation(&s[12], &s[11], 32, true);
+
+  // stage 26.
+  if (is_last_stage) {
+    HadamardRotation(&s[0], &s[15], false);
+    HadamardRotation(&s[1], &s[14], false);
+    HadamardRotation(&s[2], &s[13], false);
+    HadamardRotation(&s[3], &s[12], false);
+    HadamardRotation(&s[4], &s[11], false);
+    HadamardRotation(&s[5], &s[10], false);
+    HadamardRotation(&s[6], &s[9], false);
+    HadamardRotation(&s[7], &s[8], false);
+  } else {
+    HadamardRotation(&s[0], &s[15], false, min, max);
+    HadamardRotation(&s[1], &s[14], false, min, max);
+    HadamardRotation(&s[2], &s[13], false, min, max);
+    HadamardRotation(&s[3], &s[12], false, min, max);
+    HadamardRotation(&s[4], &s[11], false, min, max);
+    HadamardRotation(&s[5], &s[10], false, min, max);
+    HadamardRotation(&s[6], &s[9], false, min, max);
+    HadamardRotation(&s[7], &s[8], false, min, max);
+  }
+}
+
+template <ButterflyRotationFunc butterfly_rotation,
+          bool is_fast_butterfly = false>
+LIBGAV1_ALWAYS_INLINE void Dct32Stages(__m512i* s, const __m512i min,
+                                       const __m512i max,
+                                       const bool is_last_stage) {
+  // stage 3
+  if (is_fast_butterfly) {
+    ButterflyRotation_SecondIsZero(&s[16], &s[31], 62, false);
+    ButterflyRotation_FirstIsZero(&s[17], &s[30], 30, false);
+    ButterflyRotation_SecondIsZero(&s[18], &s[29], 46, false);
+    ButterflyRotation_FirstIsZero(&s[19], &s[28], 14, false);
+    ButterflyRotation_SecondIsZero(&s[20], &s[27], 54, false);
+    ButterflyRotation_FirstIsZero(&s[21], &s[26], 22, false);
+    ButterflyRotation_SecondIsZero(&s[22], &s[25], 38, false);
+    ButterflyRotation_FirstIsZero(&s[23], &s[24], 6, false);
+  } else {
+    butterfly_rotation(&s[16], &s[31], 62, false);
+    butterfly_rotation(&s[17], &s[30], 30, false);
+    butterfly_rotation(&s[18], &s[29], 46, false);
+    butterfly_rotation(&s[19], &s[28], 14, false);
+    butterfly_rotation(&s[20], &s[27], 54, false);
+    butterfly_rotation(&s[21], &s[26], 22, false);
+    butterfly_rotation(&s[22], &s[25], 38, false);
+    butterfly_rotation(&s[23], &s[24], 6, false);
+  }
+
+  // stage 6.
+  HadamardRotation(&s[16], &s[17], false, min, max);
+  HadamardRotation(&s[18], &s[19], true, min, max);
+  HadamardRotation(&s[20], &s[21], false, min, max);
+  HadamardRotation(&s[22], &s[23], true, min, max);
+  HadamardRotation(&s[24], &s[25], false, min, max);
+  HadamardRotation(&s[26], &s[27], true, min, max);
+  HadamardRotation(&s[28], &s[29], false, min, max);
+  HadamardRotation(&s[30], &s[31], true, min, max);
+
+  // stage 10.
+  butterfly_rotation(&s[30], &s[17], 24 + 32, true);
+  butterfly_rotation(&s[29], &s[18], 24 + 64 + 32, true);
+  butterfly_rotation(&s[26], &s[21], 24, true);
+  butterfly_rotation(&s[25], &s[22], 24 + 64, true);
+
+  // stage 15.
+  HadamardRotation(&s[16], &s[19], false, min, max);
+  HadamardRotation(&s[17], &s[18], false, min, max);
+  HadamardRotation(&s[20], &s[23], true, min, max);
+  HadamardRotation(&s[21], &s[22], true, min, max);
+  HadamardRotation(&s[24], &s[27], false, min, max);
+  HadamardRotation(&s[25], &s[26], false, min, max);
+  HadamardRotation(&s[28], &s[31], true, min, max);
+  HadamardRotation(&s[29], &s[30], true, min, max);
+
+  // stage 20.
+  butterfly_rotation(&s[29], &s[18], 48, true);
+  butterfly_rotation(&s[28], &s[19], 48, true);
+  butterfly_rotation(&s[27], &s[20], 48 + 64, true);
+  butterfly_rotation(&s[26], &s[21], 48 + 64, true);
+
+  // stage 24.
+  HadamardRotation(&s[16], &s[23], false, min, max);
+  HadamardRotation(&s[17], &s[22], false, min, max);
+  HadamardRotation(&s[18], &s[21], false, min, max);
+  HadamardRotation(&s[19], &s[20], false, min, max);
+  HadamardRotation(&s[24], &s[31], true, min, max);
+  HadamardRotation(&s[25], &s[30], true, min, max);
+  HadamardRotation(&s[26], &s[29], true, min, max);
+  HadamardRotation(&s[27], &s[28], true, min, max);
+
+  // stage 27.
+  butterfly_rotation(&s[27], &s[20], 32, true);
+  butterfly_rotation(&s[26], &s[21], 32, true);
+  butterfly_rotation(&s[25], &s[22], 32, true);
+  butterfly_rotation(&s[24], &s[23], 32, true);
+
+  // stage 29.
+  if (is_last_stage) {
+    HadamardRotation(&s[0], &s[31], false);
+    HadamardRotation(&s[1], &s[30], false);
+    HadamardRotation(&s[2], &s[29], false);
+    HadamardRotation(&s[3], &s[28], false);
+    HadamardRotation(&s[4], &s[27], false);
+    HadamardRotation(&s[5], &s[26], false);
+    HadamardRotation(&s[6], &s[25], false);
+    HadamardRotation(&s[7], &s[24], false);
+    HadamardRotation(&s[8], &s[23], false);
+    HadamardRotation(&s[9], &s[22], false);
+    HadamardRotation(&s[10], &s[21], false);
+    HadamardRotation(&s[11], &s[20], false);
+    HadamardRotation(&s[12], &s[19], false);
+    HadamardRotation(&s[13], &s[18], false);
+    HadamardRotation(&s[14], &s[17], false);
+    HadamardRotation(&s[15], &s[16], false);
+  } else {
+    HadamardRotation(&s[0], &s[31], false, min, max);
+    HadamardRotation(&s[1], &s[30], false, min, max);
+    HadamardRotation(&s[2], &s[29], false, min, max);
+    HadamardRotation(&s[3], &s[28], false, min, max);
+    HadamardRotation(&s[4], &s[27], false, min, max);
+    HadamardRotation(&s[5], &s[26], false, min, max);
+    HadamardRotation(&s[6], &s[25], false, min, max);
+    HadamardRotation(&s[7], &s[24], false, min, max);
+    HadamardRotation(&s[8], &s[23], false, min, max);
+    HadamardRotation(&s[9], &s[22], false, min, max);
+    HadamardRotation(&s[10], &s[21], false, min, max);
+    HadamardRotation(&s[11], &s[20], false, min, max);
+    HadamardRotation(&s[12], &s[19], false, min, max);
+    HadamardRotation(&s[13], &s[18], false, min, max);
+    HadamardRotation(&s[14], &s[17], false, min, max);
+    HadamardRotation(&s[15], &s[16], false, min, max);
+  }
+}
+
+
+// Process dct32 rows or columns, depending on the |is_row| flag. |num_lanes|
+// is the number of rows or columns processed in parallel, either 8 or 16.
+template <int num_lanes>
+LIBGAV1_ALWAYS_INLINE void Dct32_AVX512(void* dest, const int32_t step,
+                                        const bool is_row, int row_shift) {
+  auto* const dst = static_cast<int32_t*>(dest);
+  const int32_t range = is_row ? kBitdepth10 + 7 : 15;
+  const __m512i min = _mm512_set1_epi32(-(1 << range));
+  const __m512i max = _mm512_set1_epi32((1 << range) - 1);
+  __m512i s[32], x[32];
+
+  if (is_row) {
+    for (int idx = 0; idx < 32; idx += 8) {
+      __m512i input[8];
+      LoadRows8x8<num_lanes>(dst, step, idx, input);
+      Transpose8x8(input, &x[idx]);
+    }
+  } else {
+    LoadSrc<num_lanes, 32>(dst, step, 0, &x[0]);
+  }
+
+  // stage 1
+  // kBitReverseLookup
+  // 0, 16, 8, 24, 4, 20, 12, 28, 2, 18, 10, 26, 6, 22, 14, 30,
+  s[0] = x[0];
+  s[1] = x[16];
+  s[2] = x[8];
+  s[3] = x[24];
+  s[4] = x[4];
+  s[5] = x[20];
+  s[6] = x[12];
+  s[7] = x[28];
+  s[8] = x[2];
+  s[9] = x[18];
+  s[10] = x[10];
+  s[11] = x[26];
+  s[12] = x[6];
+  s[13] = x[22];
+  s[14] = x[14];
+  s[15] = x[30];
+
+  // 1, 17, 9, 25, 5, 21, 13, 29, 3, 19, 11, 27, 7, 23, 15, 31,
+  s[16] = x[1];
+  s[17] = x[17];
+  s[18] = x[9];
+  s[19] = x[25];
+  s[20] = x[5];
+  s[21] = x[21];
+  s[22] = x[13];
+  s[23] = x[29];
+  s[24] = x[3];
+  s[25] = x[19];
+  s[26] = x[11];
+  s[27] = x[27];
+  s[28] = x[7];
+  s[29] = x[23];
+  s[30] = x[15];
+  s[31] = x[31];
+
+  Dct4Stages<ButterflyRotation_16>(s, min, max, /*is_last_stage=*/false);
+  Dct8Stages<ButterflyRotation_16>(s, min, max, /*is_last_stage=*/false);
+  Dct16Stages<ButterflyRotation_16>(s, min, max, /*is_last_stage=*/false);
+  Dct32Stages<ButterflyRotation_16>(s, min, max, /*is_last_stage=*/true);
+
+
+  if (is_row) {
+    const __m512i v_row_shift_add = _mm512_set1_epi32(row_shift);
+    const __m128i v_row_shift = _mm_cvtsi32_si128(row_shift);
+    for (int idx = 0; idx < 32; idx += 8) {
+      __m512i output[8];
+      Transpose8x8(&s[idx], output);
+      for (auto& o : output) {
+        o = ShiftResidual(o, v_row_shift_add, v_row_shift);
+      }
+      StoreRows8x8<num_lanes>(dst, step, idx, output);
+    }
+  } else {
+    StoreDst<num_lanes, 32>(dst, step, 0, &s[0]);
+  }
+}
+
+// Process dct64 rows or columns, depending on the |is_row| flag. |num_lanes|
+// is the number of rows or columns processed in parallel, either 8 or 16.
+template <int num_lanes>
+void Dct64_AVX512(void* dest, int32_t step, bool is_row, int row_shift) {
+  auto* const dst = static_cast<int32_t*>(dest);
+  const int32_t range = is_row ? kBitdepth10 + 7 : 15;
+  const __m512i min = _mm512_set1_epi32(-(1 << range));
+  const __m512i max = _mm512_set1_epi32((1 << range) - 1);
+  __m512i s[64], x[32];
+
+  if (is_row) {
+    // The last 32 values of every row are always zero if the |tx_width| is
+    // 64.
+    for (int idx = 0; idx < 32; idx += 8) {
+      __m512i input[8];
+      LoadRows8x8<num_lanes>(dst, step, idx, input);
+      Transpose8x8(input, &x[idx]);
+    }
+  } else {
+    // The last 32 values of every column are always zero if the |tx_height| is
+    // 64.
+    LoadSrc<num_lanes, 32>(dst, step, 0, &x[0]);
+  }
+
+  // stage 1
+  // kBitReverseLookup
+  // 0, 32, 16, 48, 8, 40, 24, 56, 4, 36, 20, 52, 12, 44, 28, 60,
+  s[0] = x[0];
+  s[2] = x[16];
+  s[4] = x[8];
+  s[6] = x[24];
+  s[8] = x[4];
+  s[10] = x[20];
+  s[12] = x[12];
+  s[14] = x[28];
+
+  // 2, 34, 18, 50, 10, 42, 26, 58, 6, 38, 22, 54, 14, 46, 30, 62,
+  s[16] = x[2];
+  s[18] = x[18];
+  s[20] = x[10];
+  s[22] = x[26];
+  s[24] = x[6];
+  s[26] = x[22];
+  s[28] = x[14];
+  s[30] = x[30];
+
+  // 1, 33, 17, 49, 9, 41, 25, 57, 5, 37, 21, 53, 13, 45, 29, 61,
+  s[32] = x[1];
+  s[34] = x[17];
+  s[36] = x[9];
+  s[38] = x[25];
+  s[40] = x[5];
+  s[42] = x[21];
+  s[44] = x[13];
+  s[46] = x[29];
+
+  // 3, 35, 19, 51, 11, 43, 27, 59, 7, 39, 23, 55, 15, 47, 31, 63
+  s[48] = x[3];
+  s[50] = x[19];
+  s[52] = x[11];
+  s[54] = x[27];
+  s[56] = x[7];
+  s[58] = x[23];
+  s[60] = x[15];
+  s[62] = x[31];
+
+  Dct4Stages<ButterflyRotation_16, /*is_fast_butterfly=*/true>(
+      s, min, max, /*is_last_stage=*/false);
+  Dct8Stages<ButterflyRotation_16, /*is_fast_butterfly=*/true>(
+      s, min, max, /*is_last_stage=*/false);
+  Dct16Stages<ButterflyRotation_16, /*is_fast_butterfly=*/true>(
+      s, min, max, /*is_last_stage=*/false);
+  Dct32Stages<ButterflyRotation_16, /*is_fast_butterfly=*/true>(
+      s, min, max, /*is_last_stage=*/false);
+
+  //-- start dct 64 stages
+  // stage 2.
+  ButterflyRotation_SecondIsZero(&s[32], &s[63], 63 - 0, false);
+  ButterflyRotation_FirstIsZero(&s[33], &s[62], 63 - 32, false);
+  ButterflyRotation_SecondIsZero(&s[34], &s[61], 63 - 16, false);
+  ButterflyRotation_FirstIsZero(&s[35], &s[60], 63 - 48, false);
+  ButterflyRotation_SecondIsZero(&s[36], &s[59], 63 - 8, false);
+  ButterflyRotation_FirstIsZero(&s[37], &s[58], 63 - 40, false);
+  ButterflyRotation_SecondIsZero(&s[38], &s[57], 63 - 24, false);
+  ButterflyRotation_FirstIsZero(&s[39], &s[56], 63 - 56, false);
+  ButterflyRotation_SecondIsZero(&s[40], &s[55], 63 - 4, false);
+  ButterflyRotation_FirstIsZero(&s[41], &s[54], 63 - 36, false);
+  ButterflyRotation_SecondIsZero(&s[42], &s[53], 63 - 20, false);
+  ButterflyRotation_FirstIsZero(&s[43], &s[52], 63 - 52, false);
+  ButterflyRotation_SecondIsZero(&s[44], &s[51], 63 - 12, false);
+  ButterflyRotation_FirstIsZero(&s[45], &s[50], 63 - 44, false);
+  ButterflyRotation_SecondIsZero(&s[46], &s[49], 63 - 28, false);
+  ButterflyRotation_FirstIsZero(&s[47], &s[48], 63 - 60, false);
+
+  // stage 4.
+  HadamardRotation(&s[32], &s[33], false, min, max);
+  HadamardRotation(&s[34], &s[35], true, min, max);
+  HadamardRotation(&s[36], &s[37], false, min, max);
+  HadamardRotation(&s[38], &s[39], true, min, max);
+  HadamardRotation(&s[40], &s[41], false, min, max);
+  HadamardRotation(&s[42], &s[43], true, min, max);
+  HadamardRotation(&s[44], &s[45], false, min, max);
+  HadamardRotation(&s[46], &s[47], true, min, max);
+  HadamardRotation(&s[48], &s[49], false, min, max);
+  HadamardRotation(&s[50], &s[51], true, min, max);
+  HadamardRotation(&s[52], &s[53], false, min, max);
+  HadamardRotation(&s[54], &s[55], true, min, max);
+  HadamardRotation(&s[56], &s[57], false, min, max);
+  HadamardRotation(&s[58], &s[59], true, min, max);
+  HadamardRotation(&s[60], &s[61], false, min, max);
+  HadamardRotation(&s[62], &s[63], true, min, max);
+
+  // stage 7.
+  ButterflyRotation_16(&s[62], &s[33], 60 - 0, true);
+  ButterflyRotation_16(&s[61], &s[34], 60 - 0 + 64, true);
+  ButterflyRotation_16(&s[58], &s[37], 60 - 32, true);
+  ButterflyRotation_16(&s[57], &s[38], 60 - 32 + 64, true);
+  ButterflyRotation_16(&s[54], &s[41], 60 - 16, true);
+  ButterflyRotation_16(&s[53], &s[42], 60 - 16 + 64, true);
+  ButterflyRotation_16(&s[50], &s[45], 60 - 48, true);
+  ButterflyRotation_16(&s[49], &s[46], 60 - 48 + 64, true);
+
+  // stage 11.
+  HadamardRotation(&s[32], &s[35], false, min, max);
+  HadamardRotation(&s[33], &s[34], false, min, max);
+  HadamardRotation(&s[36], &s[39], true, min, max);
+  HadamardRotation(&s[37], &s[38], true, min, max);
+  HadamardRotation(&s[40], &s[43], false, min, max);
+  HadamardRotation(&s[41], &s[42], false, min, max);
+  HadamardRotation(&s[44], &s[47], true, min, max);
+  HadamardRotation(&s[45], &s[46], true, min, max);
+  HadamardRotation(&s[48], &s[51], false, min, max);
+  HadamardRotation(&s[49], &s[50], false, min, max);
+  HadamardRotation(&s[52], &s[55], true, min, max);
+  HadamardRotation(&s[53], &s[54], true, min, max);
+  HadamardRotation(&s[56], &s[59], false, min, max);
+  HadamardRotation(&s[57], &s[58], false, min, max);
+  HadamardRotation(&s[60], &s[63], true, min, max);
+  HadamardRotation(&s[61], &s[62], true, min, max);
+
+  // stage 16.
+  ButterflyRotation_16(&s[61], &s[34], 56, true);
+  ButterflyRotation_16(&s[60], &s[35], 56, true);
+  ButterflyRotation_16(&s[59], &s[36], 56 + 64, true);
+  ButterflyRotation_16(&s[58], &s[37], 56 + 64, true);
+  ButterflyRotation_16(&s[53], &s[42], 56 - 32, true);
+  ButterflyRotation_16(&s[52], &s[43], 56 - 32, true);
+  ButterflyRotation_16(&s[51], &s[44], 56 - 32 + 64, true);
+  ButterflyRotation_16(&s[50], &s[45], 56 - 32 + 64, true);
+
+  // stage 21.
+  HadamardRotation(&s[32], &s[39], false, min, max);
+  HadamardRotation(&s[33], &s[38], false, min, max);
+  HadamardRotation(&s[34], &s[37], false, min, max);
+  HadamardRotation(&s[35], &s[36], false, min, max);
+  HadamardRotation(&s[40], &s[47], true, min, max);
+  HadamardRotation(&s[41], &s[46], true, min, max);
+  HadamardRotation(&s[42], &s[45], true, min, max);
+  HadamardRotation(&s[43], &s[44], true, min, max);
+  HadamardRotation(&s[48], &s[55], false, min, max);
+  HadamardRotation(&s[49], &s[54], false, min, max);
+  HadamardRotation(&s[50], &s[53], false, min, max);
+  HadamardRotation(&s[51], &s[52], false, min, max);
+  HadamardRotation(&s[56], &s[63], true, min, max);
+  HadamardRotation(&s[57], &s[62], true, min, max);
+  HadamardRotation(&s[58], &s[61], true, min, max);
+  HadamardRotation(&s[59], &s[60], true, min, max);
+
+  // stage 25.
+  ButterflyRotation_16(&s[59], &s[36], 48, true);
+  ButterflyRotation_16(&s[58], &s[37], 48, true);
+  ButterflyRotation_16(&s[57], &s[38], 48, true);
+  ButterflyRotation_16(&s[56], &s[39], 48, true);
+  ButterflyRotation_16(&s[55], &s[40], 112, true);
+  ButterflyRotation_16(&s[54], &s[41], 112, true);
+  ButterflyRotation_16(&s[53], &s[42], 112, true);
+  ButterflyRotation_16(&s[52], &s[43], 112, true);
+
+  // stage 28.
+  HadamardRotation(&s[32], &s[47], false, min, max);
+  HadamardRotation(&s[33], &s[46], false, min, max);
+  HadamardRotation(&s[34], &s[45], false, min, max);
+  HadamardRotation(&s[35], &s[44], false, min, max);
+  HadamardRotation(&s[36], &s[43], false, min, max);
+  HadamardRotation(&s[37], &s[42], false, min, max);
+  HadamardRotation(&s[38], &s[41], false, min, max);
+  HadamardRotation(&s[39], &s[40], false, min, max);
+  HadamardRotation(&s[48], &s[63], true, min, max);
+  HadamardRotation(&s[49], &s[62], true, min, max);
+  HadamardRotation(&s[50], &s[61], true, min, max);
+  HadamardRotation(&s[51], &s[60], true, min, max);
+  HadamardRotation(&s[52], &s[59], true, min, max);
+  HadamardRotation(&s[53], &s[58], true, min, max);
+  HadamardRotation(&s[54], &s[57], true, min, max);
+  HadamardRotation(&s[55], &s[56], true, min, max);
+
+  // stage 30.
+  ButterflyRotation_16(&s[55], &s[40], 32, true);
+  ButterflyRotation_16(&s[54], &s[41], 32, true);
+  ButterflyRotation_16(&s[53], &s[42], 32, true);
+  ButterflyRotation_16(&s[52], &s[43], 32, true);
+  ButterflyRotation_16(&s[51], &s[44], 32, true);
+  ButterflyRotation_16(&s[50], &s[45], 32, true);
+  ButterflyRotation_16(&s[49], &s[46], 32, true);
+  ButterflyRotation_16(&s[48], &s[47], 32, true);
+
+  // stage 31.
+  for (int i = 0; i < 32; i += 4) {
+    HadamardRotation(&s[i], &s[63 - i], false, min, max);
+    HadamardRotation(&s[i + 1], &s[63 - i - 1], false, min, max);
+    HadamardRotation(&s[i + 2], &s[63 - i - 2], false, min, max);
+    HadamardRotation(&s[i + 3], &s[63 - i - 3], false, min, max);
+  }
+  //-- end dct 64 stages
+  if (is_row) {
+    const __m512i v_row_shift_add = _mm512_set1_epi32(row_shift);
+    const __m128i v_row_shift = _mm_cvtsi32_si128(row_shift);
+    for (int idx = 0; idx < 64; idx += 8) {
+      __m512i output[8];
+      Transpose8x8(&s[idx], output);
+      for (auto& o : output) {
+        o = ShiftResidual(o, v_row_shift_add, v_row_shift);
+      }
+      StoreRows8x8<num_lanes>(dst, step, idx, output);
+    }
+  } else {
+    StoreDst<num_lanes, 64>(dst, step, 0, &s[0]);
+  }
+}
+
+//------------------------------------------------------------------------------
+// row/column transform loops
+
+template <int tx_width>
+LIBGAV1_ALWAYS_INLINE void ApplyRounding(int32_t* source, int num_rows) {
+  // The last 32 values of every row are always zero if the |tx_width| is 64.
+  constexpr int non_zero_width = (tx_width < 64) ? tx_width : 32;
+  int i = 0;
+  do {
+    for (int j = 0; j < non_zero_width; j += 16) {
+      const __m512i a = LoadUnaligned64(&source[i * tx_width + j]);
+      StoreUnaligned64(&source[i * tx_width + j], ApplyRowMultiplier(a));
+    }
+  } while (++i < num_rows);
+}
+
+// Adds |residual| to 8 10 bit pixels at |dst| and clips to the pixel range.
+LIBGAV1_ALWAYS_INLINE void AddResidual8(uint16_t* LIBGAV1_RESTRICT dst,
+                                        const __m256i residual,
+                                        const __m128i v_max_bitdepth) {
+  const __m256i frame_data = _mm256_cvtepu16_epi32(LoadUnaligned16(dst));
+  const __m256i b = _mm256_add_epi32(residual, frame_data);
+  const __m128i d = _mm_packus_epi32(_mm256_castsi256_si128(b),
+                                     _mm256_extracti128_si256(b, 1));
+  StoreUnaligned16(dst, _mm_min_epu16(d, v_max_bitdepth));
+}
+
+// Adds |residual| to 16 10 bit pixels at |dst| and clips to the pixel range.
+LIBGAV1_ALWAYS_INLINE void AddResidual16(uint16_t* LIBGAV1_RESTRICT dst,
+                                         const __m512i residual,
+                                         const __m512i v_max_bitdepth) {
+  const __m512i frame_data = _mm512_cvtepu16_epi32(LoadUnaligned32(dst));
+  const __m512i b = _mm512_add_epi32(residual, frame_data);
+  const __m512i c = _mm512_max_epi32(_mm512_min_epi32(b, v_max_bitdepth),
+                                     _mm512_setzero_si512());
+  // The values are in the pixel range, so the narrowing does not truncate.
+  StoreUnaligned32(dst, _mm512_cvtepi32_epi16(c));
+}
+
+template <int tx_height>
+LIBGAV1_ALWAYS_INLINE void StoreToFrameWithRound(
+    Array2DView<uint16_t> frame, const int start_x, const int start_y,
+    const int tx_width, const int32_t* LIBGAV1_RESTRICT source) {
+  const int stride = frame.columns();
+  uint16_t* LIBGAV1_RESTRICT dst = frame[start_y] + start_x;
+
+  if (tx_width == 8) {
+    const __m128i v_max_bitdepth = _mm_set1_epi16((1 << kBitdepth10) - 1);
+    for (int i = 0; i < tx_height; ++i) {
+      const __m256i residual = LoadUnaligned32(&source[i * 8]);
+      const __m256i a = RightShiftWithRounding_S32(residual, 4);
+      AddResidual8(dst, a, v_max_bitdepth);
+      dst += stride;
+    }
+  } else {
+    const __m512i v_max_bitdepth = _mm512_set1_epi32((1 << kBitdepth10) - 1);
+    for (int i = 0; i < tx_height; ++i) {
+      const int row = i * tx_width;
+      int j = 0;
+      do {
+        const __m512i residual = LoadUnaligned64(&source[row + j]);
+        const __m512i a = RightShiftWithRounding_S32(residual, 4);
+        AddResidual16(dst + j, a, v_max_bitdepth);
+        j += 16;
+      } while (j < tx_width);
+      dst += stride;
+    }
+  }
+}
+
+void Dct32TransformLoopRow_AVX512(TransformType /*tx_type*/,
+                                  TransformSize tx_size, int adjusted_tx_height,
+                                  void* src_buffer, int /*start_x*/,
+                                  int /*start_y*/, void* /*dst_frame*/) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const bool should_round = kShouldRound[tx_size];
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+
+  if (DctDcOnly<32>(src, adjusted_tx_height, should_round, row_shift)) {
+    return;
+  }
+
+  if (should_round) {
+    ApplyRounding<32>(src, adjusted_tx_height);
+  }
+
+  // |adjusted_tx_height| may be 4, in which case the last iteration also
+  // transforms the 4 following rows, which are zero.
+  assert(adjusted_tx_height % 4 == 0);
+  int i = adjusted_tx_height;
+  auto* data = src;
+  // Process 16 1d dct32 rows in parallel per iteration, then the remainder 8
+  // at a time.
+  for (; i >= 16; i -= 16) {
+    Dct32_AVX512<16>(data, 32, /*is_row=*/true, row_shift);
+    data += 32 * 16;
+  }
+  for (; i > 0; i -= 8) {
+    Dct32_AVX512<8>(data, 32, /*is_row=*/true, row_shift);
+    data += 32 * 8;
+  }
+}
+
+void Dct32TransformLoopColumn_AVX512(TransformType /*tx_type*/,
+                                     TransformSize tx_size,
+                                     int adjusted_tx_height,
+                                     void* LIBGAV1_RESTRICT src_buffer,
+                                     int start_x, int start_y,
+                                     void* LIBGAV1_RESTRICT dst_frame) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  if (!DctDcOnlyColumn<32>(src, adjusted_tx_height, tx_width)) {
+    if (tx_width == 8) {
+      Dct32_AVX512<8>(src, tx_width, /*is_row=*/false, /*row_shift=*/0);
+    } else {
+      // Process 16 1d dct32 columns in parallel per iteration.
+      int i = tx_width;
+      auto* data = src;
+      do {
+        Dct32_AVX512<16>(data, tx_width, /*is_row=*/false, /*row_shift=*/0);
+        data += 16;
+        i -= 16;
+      } while (i != 0);
+    }
+  }
+  auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
+  StoreToFrameWithRound<32>(frame, start_x, start_y, tx_width, src);
+}
+
+void Dct64TransformLoopRow_AVX512(TransformType /*tx_type*/,
+                                  TransformSize tx_size, int adjusted_tx_height,
+                                  void* src_buffer, int /*start_x*/,
+                                  int /*start_y*/, void* /*dst_frame*/) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const bool should_round = kShouldRound[tx_size];
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+
+  if (DctDcOnly<64>(src, adjusted_tx_height, should_round, row_shift)) {
+    return;
+  }
+
+  if (should_round) {
+    ApplyRounding<64>(src, adjusted_tx_height);
+  }
+
+  // |adjusted_tx_height| may be 4, in which case the last iteration also
+  // transforms the 4 following rows, which are zero.
+  assert(adjusted_tx_height % 4 == 0);
+  int i = adjusted_tx_height;
+  auto* data = src;
+  // Process 16 1d dct64 rows in parallel per iteration, then the remainder 8
+  // at a time.
+  for (; i >= 16; i -= 16) {
+    Dct64_AVX512<16>(data, 64, /*is_row=*/true, row_shift);
+    data += 64 * 16;
+  }
+  for (; i > 0; i -= 8) {
+    Dct64_AVX512<8>(data, 64, /*is_row=*/true, row_shift);
+    data += 64 * 8;
+  }
+}
+
+void Dct64TransformLoopColumn_AVX512(TransformType /*tx_type*/,
+                                     TransformSize tx_size,
+                                     int adjusted_tx_height,
+                                     void* LIBGAV1_RESTRICT src_buffer,
+                                     int start_x, int start_y,
+                                     void* LIBGAV1_RESTRICT dst_frame) {
+  auto* src = static_cast<int32_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  if (!DctDcOnlyColumn<64>(src, adjusted_tx_height, tx_width)) {
+    // Process 16 1d dct64 columns in parallel per iteration.
+    int i = tx_width;
+    auto* data = src;
+    do {
+      Dct64_AVX512<16>(data, tx_width, /*is_row=*/false, /*row_shift=*/0);
+      data += 16;
+      i -= 16;
+    } while (i != 0);
+  }
+  auto& frame = *static_cast<Array2DView<uint16_t>*>(dst_frame);
+  StoreToFrameWithRound<64>(frame, start_x, start_y, tx_width, src);
+}
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_10BPP_AVX512(Transform1dSize32_Transform1dDct)
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize32][kRow] =
+      Dct32TransformLoopRow_AVX512;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize32][kColumn] =
+      Dct32TransformLoopColumn_AVX512;
+#endif
+#if DSP_ENABLED_10BPP_AVX512(Transform1dSize64_Transform1dDct)
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize64][kRow] =
+      Dct64TransformLoopRow_AVX512;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize64][kColumn] =
+      Dct64TransformLoopColumn_AVX512;
+#endif
+}
+
+}  // namespace
+
+void InverseTransformInit10bpp_AVX512() { Init10bpp(); }
+
+}  // namespace dsp
+}  // namespace libgav1
+#else   // !(LIBGAV1_TARGETING_AVX512 && LIBGAV1_MAX_BITDEPTH >= 10)
+namespace libgav1 {
+namespace dsp {
+
+void InverseTransformInit10bpp_AVX512() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX512 && LIBGAV1_MAX_BITDEPTH >= 10
@@ -0,0 +1,1022 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/inverse_transform.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX512
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx512.h"
+#include "src/utils/array_2d.h"
+#include "src/utils/common.h"
+#include "src/utils/compiler_attributes.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace low_bitdepth {
+namespace {
+
+// Include the constants and utility functions inside the anonymous namespace.
+#include "src/dsp/inverse_transform.inc"
+
+// Transposes the 8x8 blocks of int16_t values held in each 128-bit lane.
+LIBGAV1_ALWAYS_INLINE void Transpose8x8_U16(const __m512i* const in,
+                                            __m512i* const out) {
+  const __m512i a0 = _mm512_unpacklo_epi16(in[0], in[1]);
+  const __m512i a1 = _mm512_unpacklo_epi16(in[2], in[3]);
+  const __m512i a2 = _mm512_unpacklo_epi16(in[4], in[5]);
+  const __m512i a3 = _mm512_unpacklo_epi16(in[6], in[7]);
+  const __m512i a4 = _mm512_unpackhi_epi16(in[0], in[1]);
+  const __m512i a5 = _mm512_unpackhi_epi16(in[2], in[3]);
+  const __m512i a6 = _mm512_unpackhi_epi16(in[4], in[5]);
+  const __m512i a7 = _mm512_unpackhi_epi16(in[6], in[7]);
+
+  const __m512i b0 = _mm512_unpacklo_epi32(a0, a1);
+  const __m512i b1 = _mm512_unpacklo_epi32(a2, a3);
+  const __m512i b2 = _mm512_unpacklo_epi32(a4, a5);
+  const __m512i b3 = _mm512_unpacklo_epi32(a6, a7);
+  const __m512i b4 = _mm512_unpackhi_epi32(a0, a1);
+  const __m512i b5 = _mm512_unpackhi_epi32(a2, a3);
+  const __m512i b6 = _mm512_unpackhi_epi32(a4, a5);
+  const __m512i b7 = _mm512_unpackhi_epi32(a6, a7);
+
+  out[0] = _mm512_unpacklo_epi64(b0, b1);
+  out[1] = _mm512_unpackhi_epi64(b0, b1);
+  out[2] = _mm512_unpacklo_epi64(b4, b5);
+  out[3] = _mm512_unpackhi_epi64(b4, b5);
+  out[4] = _mm512_unpacklo_epi64(b2, b3);
+  out[5] = _mm512_unpackhi_epi64(b2, b3);
+  out[6] = _mm512_unpacklo_epi64(b6, b7);
+  out[7] = _mm512_unpackhi_epi64(b6, b7);
+}
+
+// Loads |load_count| rows of |num_lanes| int16_t values. Lanes past
+// |num_lanes| are left undefined.
+template <int num_lanes, int load_count>
+LIBGAV1_ALWAYS_INLINE void LoadSrc(const int16_t* LIBGAV1_RESTRICT src,
+                                   int32_t stride, __m512i* x) {
+  for (int i = 0; i < load_count; ++i) {
+    if (num_lanes == 32) {
+      x[i] = LoadUnaligned64(&src[i * stride]);
+    } else if (num_lanes == 16) {
+      x[i] = _mm512_castsi256_si512(LoadUnaligned32(&src[i * stride]));
+    } else {
+      x[i] = _mm512_castsi128_si512(LoadUnaligned16(&src[i * stride]));
+    }
+  }
+}
+
+template <int num_lanes, int store_count>
+LIBGAV1_ALWAYS_INLINE void StoreDst(int16_t* LIBGAV1_RESTRICT dst,
+                                    int32_t stride, const __m512i* s) {
+  for (int i = 0; i < store_count; ++i) {
+    if (num_lanes == 32) {
+      StoreUnaligned64(&dst[i * stride], s[i]);
+    } else if (num_lanes == 16) {
+      StoreUnaligned32(&dst[i * stride], _mm512_castsi512_si256(s[i]));
+    } else {
+      StoreUnaligned16(&dst[i * stride], _mm512_castsi512_si128(s[i]));
+    }
+  }
+}
+
+// Loads an 8x8 block from each of the |num_rows| / 8 row groups starting at
+// |src| and transposes them. Rows [8 * k, 8 * k + 8) end up in 128-bit lane k.
+// Lanes past |num_rows| / 8 are left undefined.
+template <int num_rows>
+LIBGAV1_ALWAYS_INLINE void LoadTransposed8x8(
+    const int16_t* LIBGAV1_RESTRICT src, int32_t stride, __m512i* x) {
+  __m512i input[8];
+  for (int i = 0; i < 8; ++i) {
+    const __m128i a = LoadUnaligned16(&src[i * stride]);
+    if (num_rows == 32) {
+      input[i] = SetrM128ix4(a, LoadUnaligned16(&src[(i + 8) * stride]),
+                             LoadUnaligned16(&src[(i + 16) * stride]),
+                             LoadUnaligned16(&src[(i + 24) * stride]));
+    } else if (num_rows == 16) {
+      input[i] = _mm512_castsi256_si512(
+          SetrM128i(a, LoadUnaligned16(&src[(i + 8) * stride])));
+    } else {
+      input[i] = _mm512_castsi128_si512(a);
+    }
+  }
+  Transpose8x8_U16(input, x);
+}
+
+template <int num_rows>
+LIBGAV1_ALWAYS_INLINE void StoreTransposed8x8(int16_t* LIBGAV1_RESTRICT dst,
+                                              int32_t stride,
+                                              const __m512i* s) {
+  __m512i output[8];
+  Transpose8x8_U16(s, output);
+  for (int i = 0; i < 8; ++i) {
+    StoreUnaligned16(&dst[i * stride], _mm512_castsi512_si128(output[i]));
+    if (num_rows >= 16) {
+      StoreUnaligned16(&dst[(i + 8) * stride],
+                       _mm512_extracti32x4_epi32(output[i], 1));
+    }
+    if (num_rows == 32) {
+      StoreUnaligned16(&dst[(i + 16) * stride],
+                       _mm512_extracti32x4_epi32(output[i], 2));
+      StoreUnaligned16(&dst[(i + 24) * stride],
+                       _mm512_extracti32x4_epi32(output[i], 3));
+    }
+  }
+}
+
+// Butterfly rotate 32 values.
+LIBGAV1_ALWAYS_INLINE void ButterflyRotation_32(__m512i* a, __m512i* b,
+                                                const int angle,
+                                                const bool flip) {
+  const int16_t cos128 = Cos128(angle);
+  const int16_t sin128 = Sin128(angle);
+  const __m512i psin_pcos = _mm512_set1_epi32(
+      static_cast<uint16_t>(cos128) | (static_cast<uint32_t>(sin128) << 16));
+  // -sin cos, -sin cos, -sin cos, -sin cos. There is no 512-bit sign
+  // instruction so the negated pair is built directly.
+  const __m512i msin_pcos = _mm512_set1_epi32(
+      static_cast<uint16_t>(cos128) |
+      (static_cast<uint32_t>(static_cast<uint16_t>(-sin128)) << 16));
+  const __m512i ba = _mm512_unpacklo_epi16(*a, *b);
+  const __m512i ab = _mm512_unpacklo_epi16(*b, *a);
+  const __m512i ba_hi = _mm512_unpackhi_epi16(*a, *b);
+  const __m512i ab_hi = _mm512_unpackhi_epi16(*b, *a);
+  const __m512i x0 = _mm512_madd_epi16(ba, msin_pcos);
+  const __m512i y0 = _mm512_madd_epi16(ab, psin_pcos);
+  const __m512i x0_hi = _mm512_madd_epi16(ba_hi, msin_pcos);
+  const __m512i y0_hi = _mm512_madd_epi16(ab_hi, psin_pcos);
+  const __m512i x1 = RightShiftWithRounding_S32(x0, 12);
+  const __m512i y1 = RightShiftWithRounding_S32(y0, 12);
+  const __m512i x1_hi = RightShiftWithRounding_S32(x0_hi, 12);
+  const __m512i y1_hi = RightShiftWithRounding_S32(y0_hi, 12);
+  const __m512i x = _mm512_packs_epi32(x1, x1_hi);
+  const __m512i y = _mm512_packs_epi32(y1, y1_hi);
+  if (flip) {
+    *a = y;
+    *b = x;
+  } else {
+    *a = x;
+    *b = y;
+  }
+}
+
+LIBGAV1_ALWAYS_INLINE void ButterflyRotation_FirstIsZero(__m512i* a, __m512i* b,
+                                                         const int angle,
+                                                         const bool flip) {
+  const int16_t cos128 = Cos128(angle);
+  const int16_t sin128 = Sin128(angle);
+  const __m512i pcos = _mm512_set1_epi16(cos128 << 3);
+  const __m512i psin = _mm512_set1_epi16(-(sin128 << 3));
+  const __m512i x = _mm512_mulhrs_epi16(*b, psin);
+  const __m512i y = _mm512_mulhrs_epi16(*b, pcos);
+  if (flip) {
+    *a = y;
+    *b = x;
+  } else {
+    *a = x;
+    *b = y;
+  }
+}
+
+LIBGAV1_ALWAYS_INLINE void ButterflyRotation_SecondIsZero(__m512i* a,
+                                                          __m512i* b,
+                                                          const int angle,
+                                                          const bool flip) {
+  const int16_t cos128 = Cos128(angle);
+  const int16_t sin128 = Sin128(angle);
+  const __m512i pcos = _mm512_set1_epi16(cos128 << 3);
+  const __m512i psin = _mm512_set1_epi16(sin128 << 3);
+  const __m512i x = _mm512_mulhrs_epi16(*a, pcos);
+  const __m512i y = _mm512_mulhrs_epi16(*a, psin);
+  if (flip) {
+    *a = y;
+    *b = x;
+  } else {
+    *a = x;
+    *b = y;
+  }
+}
+
+LIBGAV1_ALWAYS_INLINE void HadamardRotation(__m512i* a, __m512i* b, bool flip) {
+  __m512i x, y;
+  if (flip) {
+    y = _mm512_adds_epi16(*b, *a);
+    x = _mm512_subs_epi16(*b, *a);
+  } else {
+    x = _mm512_adds_epi16(*a, *b);
+    y = _mm512_subs_epi16(*a, *b);
+  }
+  *a = x;
+  *b = y;
+}
+
+using ButterflyRotationFunc = void (*)(__m512i* a, __m512i* b, int angle,
+                                       bool flip);
+
+LIBGAV1_ALWAYS_INLINE __m512i ShiftResidual(const __m512i residual,
+                                            const __m512i v_row_shift_add,
+                                            const __m128i v_row_shift) {
+  const __m512i k7ffd = _mm512_set1_epi16(0x7ffd);
+  // The max row_shift is 2, so int16_t values greater than 0x7ffd may
+  // overflow.  Generate a mask for this case.
+  const __mmask32 mask = _mm512_cmpgt_epi16_mask(residual, k7ffd);
+  const __m512i x = _mm512_add_epi16(residual, v_row_shift_add);
+  // Assume int16_t values.
+  const __m512i a = _mm512_sra_epi16(x, v_row_shift);
+  // Assume uint16_t values.
+  const __m512i b = _mm512_srl_epi16(x, v_row_shift);
+  // Select the correct shifted value.
+  return _mm512_mask_blend_epi16(mask, a, b);
+}
+
+//------------------------------------------------------------------------------
+// Discrete Cosine Transforms (DCT).
+
+template <int width>
+LIBGAV1_ALWAYS_INLINE bool DctDcOnly(void* dest, int adjusted_tx_height,
+                                     bool should_round, int row_shift) {
+  if (adjusted_tx_height > 1) return false;
+
+  auto* dst = static_cast<int16_t*>(dest);
+  const __m512i v_src = _mm512_set1_epi16(dst[0]);
+  const __m512i v_kTransformRowMultiplier =
+      _mm512_set1_epi16(kTransformRowMultiplier << 3);
+  const __m512i v_src_round =
+      _mm512_mulhrs_epi16(v_src, v_kTransformRowMultiplier);
+  const __m512i s0 = should_round ? v_src_round : v_src;
+  const int16_t cos128 = Cos128(32);
+  const __m512i xy = _mm512_mulhrs_epi16(s0, _mm512_set1_epi16(cos128 << 3));
+
+  // Expand to 32 bits to prevent int16_t overflows during the shift add.
+  const __m512i v_row_shift_add = _mm512_set1_epi32(row_shift);
+  const __m128i v_row_shift = _mm_cvtsi32_si128(row_shift);
+  const __m512i a = _mm512_cvtepi16_epi32(_mm512_castsi512_si256(xy));
+  const __m512i b = _mm512_add_epi32(a, v_row_shift_add);
+  const __m512i c = _mm512_sra_epi32(b, v_row_shift);
+  // All values are equal, so the lane order of the pack does not matter.
+  const __m512i xy_shifted = _mm512_packs_epi32(c, c);
+
+  for (int i = 0; i < width; i += 32) {
+    StoreUnaligned64(dst, xy_shifted);
+    dst += 32;
+  }
+  return true;
+}
+
+template <int height>
+LIBGAV1_ALWAYS_INLINE bool DctDcOnlyColumn(void* dest, int adjusted_tx_height,
+                                           int width) {
+  if (adjusted_tx_height > 1) return false;
+
+  auto* dst = static_cast<int16_t*>(dest);
+  const int16_t cos128 = Cos128(32);
+
+  // Calculate dc values for first row.
+  if (width == 8) {
+    const __m128i v_src = LoadUnaligned16(dst);
+    const __m128i xy = _mm_mulhrs_epi16(v_src, _mm_set1_epi16(cos128 << 3));
+    StoreUnaligned16(dst, xy);
+  } else if (width == 16) {
+    const __m256i v_src = LoadUnaligned32(dst);
+    const __m256i xy =
+        _mm256_mulhrs_epi16(v_src, _mm256_set1_epi16(cos128 << 3));
+    StoreUnaligned32(dst, xy);
+  } else {
+    int i = 0;
+    do {
+      const __m512i v_src = LoadUnaligned64(&dst[i]);
+      const __m512i xy =
+          _mm512_mulhrs_epi16(v_src, _mm512_set1_epi16(cos128 << 3));
+      StoreUnaligned64(&dst[i], xy);
+      i += 32;
+    } while (i < width);
+  }
+
+  // Copy first row to the rest of the block.
+  for (int y = 1; y < height; ++y) {
+    memcpy(&dst[y * width], dst, width * sizeof(dst[0]));
+  }
+  return true;
+}
+
+template <ButterflyRotationFunc butterfly_rotation,
+          bool is_fast_butterfly = false>
+LIBGAV1_ALWAYS_INLINE void Dct4Stages(__m512i* s) {
+  // stage 12.
+  if (is_fast_butterfly) {
+    ButterflyRotation_SecondIsZero(&s[0], &s[1], 32, true);
+    ButterflyRotation_SecondIsZero(&s[2], &s[3], 48, false);
+  } else {
+    butterfly_rotation(&s[0], &s[1], 32, true);
+    butterfly_rotation(&s[2], &s[3], 48, false);
+  }
+
+  // stage 17.
+  HadamardRotation(&s[0], &s[3], false);
+  HadamardRotation(&s[1], &s[2], false);
+}
+
+template <ButterflyRotationFunc butterfly_rotation,
+          bool is_fast_butterfly = false>
+LIBGAV1_ALWAYS_INLINE void Dct8Stages(__m512i* s) {
+  // stage 8.
+  if (is_fast_butterfly) {
+    ButterflyRotation_SecondIsZero(&s[4], &s[7], 56, false);
+    ButterflyRotation_FirstIsZero(&s[5], &s[6], 24, false);
+  } else {
+    butterfly_rotation(&s[4], &s[7], 56, false);
+    butterfly_rotation(&s[5], &s[6], 24, false);
+  }
+
+  // stage 13.
+  HadamardRotation(&s[4], &s[5], false);
+  HadamardRotation(&s[6], &s[7], true);
+
+  // stage 18.
+  butterfly_rotation(&s[6], &s[5], 32, true);
+
+  // stage 22.
+  HadamardRotation(&s[0], &s[7], false);
+  HadamardRotation(&s[1], &s[6], false);
+  HadamardRotation(&s[2], &s[5], false);
+  HadamardRotation(&s[3], &s[4], false);
+}
+
+template <ButterflyRotationFunc butterfly_rotation,
+          bool is_fast_butterfly = false>
+LIBGAV1_ALWAYS_INLINE void Dct16Stages(__m512i* s) {
+  // stage 5.
+  if (is_fast_butterfly) {
+    ButterflyRotation_SecondIsZero(&s[8], &s[15], 60, false);
+    ButterflyRotation_FirstIsZero(&s[9], &s[14], 28, false);
+    ButterflyRotation_SecondIsZero(&s[10], &s[13], 44, false);
+    ButterflyRotation_FirstIsZero(&s[11], &s[12], 12, false);
+  } else {
+    butterfly_rotation(&s[8], &s[15], 60, false);
+    butterfly_rotation(&s[9], &s[14], 28, false);
+    butterfly_rotation(&s[10], &s[13], 44, false);
+    butterfly_rotation(&s[11], &s[12], 12, false);
+  }
+
+  // stage 9.
+  HadamardRotation(&s[8], &s[9], false);
+  HadamardRotation(&s[10], &s[11], true);
+  HadamardRotation(&s[12], &s[13], false);
+  HadamardRotation(&s[14], &s[15], true);
+
+  // stage 14.
+  butterfly_rotation(&s[14], &s[9], 48, true);
+  butterfly_rotation(&s[13], &s[10], 112, true);
+
+  // stage 19.
+  HadamardRotation(&s[8], &s[11], false);
+  HadamardRotation(&s[9], &s[10], false);
+  HadamardRotation(&s[12], &s[15], true);
+  HadamardRotation(&s[13], &s[14], true);
+
+  // stage 23.
+  butterfly_rotation(&s[13], &s[10], 32, true);
+  butterfly_rotation(&s[12], &s[11], 32, true);
+
+  // stage 26.
+  HadamardRotation(&s[0], &s[15], false);
+  HadamardRotation(&s[1], &s[14], false);
+  HadamardRotation(&s[2], &s[13], false);
+  HadamardRotation(&s[3], &s[12], false);
+  HadamardRotation(&s[4], &s[11], false);
+  HadamardRotation(&s[5], &s[10], false);
+  HadamardRotation(&s[6], &s[9], false);
+  HadamardRotation(&s[7], &s[8], false);
+}
+
+template <ButterflyRotationFunc butterfly_rotation,
+          bool is_fast_butterfly = false>
+LIBGAV1_ALWAYS_INLINE void Dct32Stages(__m512i* s) {
+  // stage 3
+  if (is_fast_butterfly) {
+    ButterflyRotation_SecondIsZero(&s[16], &s[31], 62, false);
+    ButterflyRotation_FirstIsZero(&s[17], &s[30], 30, false);
+    ButterflyRotation_SecondIsZero(&s[18], &s[29], 46, false);
+    ButterflyRotation_FirstIsZero(&s[19], &s[28], 14, false);
+    ButterflyRotation_SecondIsZero(&s[20], &s[27], 54, false);
+    ButterflyRotation_FirstIsZero(&s[21], &s[26], 22, false);
+    ButterflyRotation_SecondIsZero(&s[22], &s[25], 38, false);
+    ButterflyRotation_FirstIsZero(&s[23], &s[24], 6, false);
+  } else {
+    butterfly_rotation(&s[16], &s[31], 62, false);
+    butterfly_rotation(&s[17], &s[30], 30, false);
+    butterfly_rotation(&s[18], &s[29], 46, false);
+    butterfly_rotation(&s[19], &s[28], 14, false);
+    butterfly_rotation(&s[20], &s[27], 54, false);
+    butterfly_rotation(&s[21], &s[26], 22, false);
+    butterfly_rotation(&s[22], &s[25], 38, false);
+    butterfly_rotation(&s[23], &s[24], 6, false);
+  }
+  // stage 6.
+  HadamardRotation(&s[16], &s[17], false);
+  HadamardRotation(&s[18], &s[19], true);
+  HadamardRotation(&s[20], &s[21], false);
+  HadamardRotation(&s[22], &s[23], true);
+  HadamardRotation(&s[24], &s[25], false);
+  HadamardRotation(&s[26], &s[27], true);
+  HadamardRotation(&s[28], &s[29], false);
+  HadamardRotation(&s[30], &s[31], true);
+
+  // stage 10.
+  butterfly_rotation(&s[30], &s[17], 24 + 32, true);
+  butterfly_rotation(&s[29], &s[18], 24 + 64 + 32, true);
+  butterfly_rotation(&s[26], &s[21], 24, true);
+  butterfly_rotation(&s[25], &s[22], 24 + 64, true);
+
+  // stage 15.
+  HadamardRotation(&s[16], &s[19], false);
+  HadamardRotation(&s[17], &s[18], false);
+  HadamardRotation(&s[20], &s[23], true);
+  HadamardRotation(&s[21], &s[22], true);
+  HadamardRotation(&s[24], &s[27], false);
+  HadamardRotation(&s[25], &s[26], false);
+  HadamardRotation(&s[28], &s[31], true);
+  HadamardRotation(&s[29], &s[30], true);
+
+  // stage 20.
+  butterfly_rotation(&s[29], &s[18], 48, true);
+  butterfly_rotation(&s[28], &s[19], 48, true);
+  butterfly_rotation(&s[27], &s[20], 48 + 64, true);
+  butterfly_rotation(&s[26], &s[21], 48 + 64, true);
+
+  // stage 24.
+  HadamardRotation(&s[16], &s[23], false);
+  HadamardRotation(&s[17], &s[22], false);
+  HadamardRotation(&s[18], &s[21], false);
+  HadamardRotation(&s[19], &s[20], false);
+  HadamardRotation(&s[24], &s[31], true);
+  HadamardRotation(&s[25], &s[30], true);
+  HadamardRotation(&s[26], &s[29], true);
+  HadamardRotation(&s[27], &s[28], true);
+
+  // stage 27.
+  butterfly_rotation(&s[27], &s[20], 32, true);
+  butterfly_rotation(&s[26], &s[21], 32, true);
+  butterfly_rotation(&s[25], &s[22], 32, true);
+  butterfly_rotation(&s[24], &s[23], 32, true);
+
+  // stage 29.
+  HadamardRotation(&s[0], &s[31], false);
+  HadamardRotation(&s[1], &s[30], false);
+  HadamardRotation(&s[2], &s[29], false);
+  HadamardRotation(&s[3], &s[28], false);
+  HadamardRotation(&s[4], &s[27], false);
+  HadamardRotation(&s[5], &s[26], false);
+  HadamardRotation(&s[6], &s[25], false);
+  HadamardRotation(&s[7], &s[24], false);
+  HadamardRotation(&s[8], &s[23], false);
+  HadamardRotation(&s[9], &s[22], false);
+  HadamardRotation(&s[10], &s[21], false);
+  HadamardRotation(&s[11], &s[20], false);
+  HadamardRotation(&s[12], &s[19], false);
+  HadamardRotation(&s[13], &s[18], false);
+  HadamardRotation(&s[14], &s[17], false);
+  HadamardRotation(&s[15], &s[16], false);
+}
+
+// Process dct32 rows or columns, depending on the transpose flag. |num_lanes|
+// is the number of rows or columns processed in parallel, either 8, 16 or 32.
+template <int num_lanes>
+LIBGAV1_ALWAYS_INLINE void Dct32_AVX512(void* dest, const int32_t step,
+                                        const bool transpose) {
+  auto* const dst = static_cast<int16_t*>(dest);
+  __m512i s[32], x[32];
+
+  if (transpose) {
+    for (int idx = 0; idx < 32; idx += 8) {
+      LoadTransposed8x8<num_lanes>(&dst[idx], step, &x[idx]);
+    }
+  } else {
+    LoadSrc<num_lanes, 32>(dst, step, x);
+  }
+
+  // stage 1
+  // kBitReverseLookup
+  // 0, 16, 8, 24, 4, 20, 12, 28, 2, 18, 10, 26, 6, 22, 14, 30,
+  s[0] = x[0];
+  s[1] = x[16];
+  s[2] = x[8];
+  s[3] = x[24];
+  s[4] = x[4];
+  s[5] = x[20];
+  s[6] = x[12];
+  s[7] = x[28];
+  s[8] = x[2];
+  s[9] = x[18];
+  s[10] = x[10];
+  s[11] = x[26];
+  s[12] = x[6];
+  s[13] = x[22];
+  s[14] = x[14];
+  s[15] = x[30];
+
+  // 1, 17, 9, 25, 5, 21, 13, 29, 3, 19, 11, 27, 7, 23, 15, 31,
+  s[16] = x[1];
+  s[17] = x[17];
+  s[18] = x[9];
+  s[19] = x[25];
+  s[20] = x[5];
+  s[21] = x[21];
+  s[22] = x[13];
+  s[23] = x[29];
+  s[24] = x[3];
+  s[25] = x[19];
+  s[26] = x[11];
+  s[27] = x[27];
+  s[28] = x[7];
+  s[29] = x[23];
+  s[30] = x[15];
+  s[31] = x[31];
+
+  Dct4Stages<ButterflyRotation_32>(s);
+  Dct8Stages<ButterflyRotation_32>(s);
+  Dct16Stages<ButterflyRotation_32>(s);
+  Dct32Stages<ButterflyRotation_32>(s);
+
+  if (transpose) {
+    for (int idx = 0; idx < 32; idx += 8) {
+      StoreTransposed8x8<num_lanes>(&dst[idx], step, &s[idx]);
+    }
+  } else {
+    StoreDst<num_lanes, 32>(dst, step, s);
+  }
+}
+
+// Allow the compiler to call this function instead of force inlining. Tests
+// show the performance is slightly faster.
+template <int num_lanes>
+void Dct64_AVX512(void* dest, int32_t step, bool transpose) {
+  auto* const dst = static_cast<int16_t*>(dest);
+  __m512i s[64], x[32];
+
+  if (transpose) {
+    // The last 32 values of every row are always zero if the |tx_width| is
+    // 64.
+    for (int idx = 0; idx < 32; idx += 8) {
+      LoadTransposed8x8<num_lanes>(&dst[idx], step, &x[idx]);
+    }
+  } else {
+    // The last 32 values of every column are always zero if the |tx_height| is
+    // 64.
+    LoadSrc<num_lanes, 32>(dst, step, x);
+  }
+
+  // stage 1
+  // kBitReverseLookup
+  // 0, 32, 16, 48, 8, 40, 24, 56, 4, 36, 20, 52, 12, 44, 28, 60,
+  s[0] = x[0];
+  s[2] = x[16];
+  s[4] = x[8];
+  s[6] = x[24];
+  s[8] = x[4];
+  s[10] = x[20];
+  s[12] = x[12];
+  s[14] = x[28];
+
+  // 2, 34, 18, 50, 10, 42, 26, 58, 6, 38, 22, 54, 14, 46, 30, 62,
+  s[16] = x[2];
+  s[18] = x[18];
+  s[20] = x[10];
+  s[22] = x[26];
+  s[24] = x[6];
+  s[26] = x[22];
+  s[28] = x[14];
+  s[30] = x[30];
+
+  // 1, 33, 17, 49, 9, 41, 25, 57, 5, 37, 21, 53, 13, 45, 29, 61,
+  s[32] = x[1];
+  s[34] = x[17];
+  s[36] = x[9];
+  s[38] = x[25];
+  s[40] = x[5];
+  s[42] = x[21];
+  s[44] = x[13];
+  s[46] = x[29];
+
+  // 3, 35, 19, 51, 11, 43, 27, 59, 7, 39, 23, 55, 15, 47, 31, 63
+  s[48] = x[3];
+  s[50] = x[19];
+  s[52] = x[11];
+  s[54] = x[27];
+  s[56] = x[7];
+  s[58] = x[23];
+  s[60] = x[15];
+  s[62] = x[31];
+
+  Dct4Stages<ButterflyRotation_32, /*is_fast_butterfly=*/true>(s);
+  Dct8Stages<ButterflyRotation_32, /*is_fast_butterfly=*/true>(s);
+  Dct16Stages<ButterflyRotation_32, /*is_fast_butterfly=*/true>(s);
+  Dct32Stages<ButterflyRotation_32, /*is_fast_butterfly=*/true>(s);
+
+  //-- start dct 64 stages
+  // stage 2.
+  ButterflyRotation_SecondIsZero(&s[32], &s[63], 63 - 0, false);
+  ButterflyRotation_FirstIsZero(&s[33], &s[62], 63 - 32, false);
+  ButterflyRotation_SecondIsZero(&s[34], &s[61], 63 - 16, false);
+  ButterflyRotation_FirstIsZero(&s[35], &s[60], 63 - 48, false);
+  ButterflyRotation_SecondIsZero(&s[36], &s[59], 63 - 8, false);
+  ButterflyRotation_FirstIsZero(&s[37], &s[58], 63 - 40, false);
+  ButterflyRotation_SecondIsZero(&s[38], &s[57], 63 - 24, false);
+  ButterflyRotation_FirstIsZero(&s[39], &s[56], 63 - 56, false);
+  ButterflyRotation_SecondIsZero(&s[40], &s[55], 63 - 4, false);
+  ButterflyRotation_FirstIsZero(&s[41], &s[54], 63 - 36, false);
+  ButterflyRotation_SecondIsZero(&s[42], &s[53], 63 - 20, false);
+  ButterflyRotation_FirstIsZero(&s[43], &s[52], 63 - 52, false);
+  ButterflyRotation_SecondIsZero(&s[44], &s[51], 63 - 12, false);
+  ButterflyRotation_FirstIsZero(&s[45], &s[50], 63 - 44, false);
+  ButterflyRotation_SecondIsZero(&s[46], &s[49], 63 - 28, false);
+  ButterflyRotation_FirstIsZero(&s[47], &s[48], 63 - 60, false);
+
+  // stage 4.
+  HadamardRotation(&s[32], &s[33], false);
+  HadamardRotation(&s[34], &s[35], true);
+  HadamardRotation(&s[36], &s[37], false);
+  HadamardRotation(&s[38], &s[39], true);
+  HadamardRotation(&s[40], &s[41], false);
+  HadamardRotation(&s[42], &s[43], true);
+  HadamardRotation(&s[44], &s[45], false);
+  HadamardRotation(&s[46], &s[47], true);
+  HadamardRotation(&s[48], &s[49], false);
+  HadamardRotation(&s[50], &s[51], true);
+  HadamardRotation(&s[52], &s[53], false);
+  HadamardRotation(&s[54], &s[55], true);
+  HadamardRotation(&s[56], &s[57], false);
+  HadamardRotation(&s[58], &s[59], true);
+  HadamardRotation(&s[60], &s[61], false);
+  HadamardRotation(&s[62], &s[63], true);
+
+  // stage 7.
+  ButterflyRotation_32(&s[62], &s[33], 60 - 0, true);
+  ButterflyRotation_32(&s[61], &s[34], 60 - 0 + 64, true);
+  ButterflyRotation_32(&s[58], &s[37], 60 - 32, true);
+  ButterflyRotation_32(&s[57], &s[38], 60 - 32 + 64, true);
+  ButterflyRotation_32(&s[54], &s[41], 60 - 16, true);
+  ButterflyRotation_32(&s[53], &s[42], 60 - 16 + 64, true);
+  ButterflyRotation_32(&s[50], &s[45], 60 - 48, true);
+  ButterflyRotation_32(&s[49], &s[46], 60 - 48 + 64, true);
+
+  // stage 11.
+  HadamardRotation(&s[32], &s[35], false);
+  HadamardRotation(&s[33], &s[34], false);
+  HadamardRotation(&s[36], &s[39], true);
+  HadamardRotation(&s[37], &s[38], true);
+  HadamardRotation(&s[40], &s[43], false);
+  HadamardRotation(&s[41], &s[42], false);
+  HadamardRotation(&s[44], &s[47], true);
+  HadamardRotation(&s[45], &s[46], true);
+  HadamardRotation(&s[48], &s[51], false);
+  HadamardRotation(&s[49], &s[50], false);
+  HadamardRotation(&s[52], &s[55], true);
+  HadamardRotation(&s[53], &s[54], true);
+  HadamardRotation(&s[56], &s[59], false);
+  HadamardRotation(&s[57], &s[58], false);
+  HadamardRotation(&s[60], &s[63], true);
+  HadamardRotation(&s[61], &s[62], true);
+
+  // stage 16.
+  ButterflyRotation_32(&s[61], &s[34], 56, true);
+  ButterflyRotation_32(&s[60], &s[35], 56, true);
+  ButterflyRotation_32(&s[59], &s[36], 56 + 64, true);
+  ButterflyRotation_32(&s[58], &s[37], 56 + 64, true);
+  ButterflyRotation_32(&s[53], &s[42], 56 - 32, true);
+  ButterflyRotation_32(&s[52], &s[43], 56 - 32, true);
+  ButterflyRotation_32(&s[51], &s[44], 56 - 32 + 64, true);
+  ButterflyRotation_32(&s[50], &s[45], 56 - 32 + 64, true);
+
+  // stage 21.
+  HadamardRotation(&s[32], &s[39], false);
+  HadamardRotation(&s[33], &s[38], false);
+  HadamardRotation(&s[34], &s[37], false);
+  HadamardRotation(&s[35], &s[36], false);
+  HadamardRotation(&s[40], &s[47], true);
+  HadamardRotation(&s[41], &s[46], true);
+  HadamardRotation(&s[42], &s[45], true);
+  HadamardRotation(&s[43], &s[44], true);
+  HadamardRotation(&s[48], &s[55], false);
+  HadamardRotation(&s[49], &s[54], false);
+  HadamardRotation(&s[50], &s[53], false);
+  HadamardRotation(&s[51], &s[52], false);
+  HadamardRotation(&s[56], &s[63], true);
+  HadamardRotation(&s[57], &s[62], true);
+  HadamardRotation(&s[58], &s[61], true);
+  HadamardRotation(&s[59], &s[60], true);
+
+  // stage 25.
+  ButterflyRotation_32(&s[59], &s[36], 48, true);
+  ButterflyRotation_32(&s[58], &s[37], 48, true);
+  ButterflyRotation_32(&s[57], &s[38], 48, true);
+  ButterflyRotation_32(&s[56], &s[39], 48, true);
+  ButterflyRotation_32(&s[55], &s[40], 112, true);
+  ButterflyRotation_32(&s[54], &s[41], 112, true);
+  ButterflyRotation_32(&s[53], &s[42], 112, true);
+  ButterflyRotation_32(&s[52], &s[43], 112, true);
+
+  // stage 28.
+  HadamardRotation(&s[32], &s[47], false);
+  HadamardRotation(&s[33], &s[46], false);
+  HadamardRotation(&s[34], &s[45], false);
+  HadamardRotation(&s[35], &s[44], false);
+  HadamardRotation(&s[36], &s[43], false);
+  HadamardRotation(&s[37], &s[42], false);
+  HadamardRotation(&s[38], &s[41], false);
+  HadamardRotation(&s[39], &s[40], false);
+  HadamardRotation(&s[48], &s[63], true);
+  HadamardRotation(&s[49], &s[62], true);
+  HadamardRotation(&s[50], &s[61], true);
+  HadamardRotation(&s[51], &s[60], true);
+  HadamardRotation(&s[52], &s[59], true);
+  HadamardRotation(&s[53], &s[58], true);
+  HadamardRotation(&s[54], &s[57], true);
+  HadamardRotation(&s[55], &s[56], true);
+
+  // stage 30.
+  ButterflyRotation_32(&s[55], &s[40], 32, true);
+  ButterflyRotation_32(&s[54], &s[41], 32, true);
+  ButterflyRotation_32(&s[53], &s[42], 32, true);
+  ButterflyRotation_32(&s[52], &s[43], 32, true);
+  ButterflyRotation_32(&s[51], &s[44], 32, true);
+  ButterflyRotation_32(&s[50], &s[45], 32, true);
+  ButterflyRotation_32(&s[49], &s[46], 32, true);
+  ButterflyRotation_32(&s[48], &s[47], 32, true);
+
+  // stage 31.
+  for (int i = 0; i < 32; i += 4) {
+    HadamardRotation(&s[i], &s[63 - i], false);
+    HadamardRotation(&s[i + 1], &s[63 - i - 1], false);
+    HadamardRotation(&s[i + 2], &s[63 - i - 2], false);
+    HadamardRotation(&s[i + 3], &s[63 - i - 3], false);
+  }
+  //-- end dct 64 stages
+  if (transpose) {
+    for (int idx = 0; idx < 64; idx += 8) {
+      StoreTransposed8x8<num_lanes>(&dst[idx], step, &s[idx]);
+    }
+  } else {
+    StoreDst<num_lanes, 64>(dst, step, s);
+  }
+}
+
+//------------------------------------------------------------------------------
+// row/column transform loops
+
+LIBGAV1_ALWAYS_INLINE void StoreToFrameWithRound(
+    Array2DView<uint8_t> frame, const int start_x, const int start_y,
+    const int tx_width, const int tx_height,
+    const int16_t* LIBGAV1_RESTRICT source) {
+  const int stride = frame.columns();
+  uint8_t* LIBGAV1_RESTRICT dst = frame[start_y] + start_x;
+  if (tx_width == 8) {
+    const __m128i v_eight = _mm_set1_epi16(8);
+    for (int i = 0; i < tx_height; ++i) {
+      const __m128i residual = LoadUnaligned16(&source[i * 8]);
+      const __m128i frame_data = LoadLo8(dst);
+      // Saturate to prevent overflowing int16_t
+      const __m128i b = _mm_adds_epi16(residual, v_eight);
+      const __m128i c = _mm_srai_epi16(b, 4);
+      const __m128i d = _mm_cvtepu8_epi16(frame_data);
+      const __m128i e = _mm_adds_epi16(d, c);
+      StoreLo8(dst, _mm_packus_epi16(e, e));
+      dst += stride;
+    }
+  } else if (tx_width == 16) {
+    const __m256i v_eight = _mm256_set1_epi16(8);
+    for (int i = 0; i < tx_height; ++i) {
+      const __m256i residual = LoadUnaligned32(&source[i * 16]);
+      const __m128i frame_data = LoadUnaligned16(dst);
+      // Saturate to prevent overflowing int16_t
+      const __m256i b = _mm256_adds_epi16(residual, v_eight);
+      const __m256i c = _mm256_srai_epi16(b, 4);
+      const __m256i d = _mm256_cvtepu8_epi16(frame_data);
+      const __m256i e = _mm256_adds_epi16(d, c);
+      StoreUnaligned16(dst, _mm_packus_epi16(_mm256_castsi256_si128(e),
+                                             _mm256_extracti128_si256(e, 1)));
+      dst += stride;
+    }
+  } else {
+    const __m512i v_eight = _mm512_set1_epi16(8);
+    const __m512i v_zero = _mm512_setzero_si512();
+    for (int i = 0; i < tx_height; ++i) {
+      const int row = i * tx_width;
+      int j = 0;
+      do {
+        const __m512i residual = LoadUnaligned64(&source[row + j]);
+        const __m256i frame_data = LoadUnaligned32(dst + j);
+        // Saturate to prevent overflowing int16_t
+        const __m512i b = _mm512_adds_epi16(residual, v_eight);
+        const __m512i c = _mm512_srai_epi16(b, 4);
+        const __m512i d = _mm512_cvtepu8_epi16(frame_data);
+        const __m512i e = _mm512_adds_epi16(d, c);
+        // Clamping negative values to zero lets the unsigned saturating
+        // narrow act as packus without the per-lane reordering.
+        StoreUnaligned32(dst + j,
+                         _mm512_cvtusepi16_epi8(_mm512_max_epi16(e, v_zero)));
+        j += 32;
+      } while (j < tx_width);
+      dst += stride;
+    }
+  }
+}
+
+template <int tx_width>
+LIBGAV1_ALWAYS_INLINE void ApplyRounding(int16_t* source, int num_rows) {
+  const __m512i v_kTransformRowMultiplier =
+      _mm512_set1_epi16(kTransformRowMultiplier << 3);
+  // The last 32 values of every row are always zero if the |tx_width| is 64.
+  int i = 0;
+  do {
+    const __m512i a = LoadUnaligned64(&source[i * tx_width]);
+    const __m512i b = _mm512_mulhrs_epi16(a, v_kTransformRowMultiplier);
+    StoreUnaligned64(&source[i * tx_width], b);
+  } while (++i < num_rows);
+}
+
+template <int tx_width>
+LIBGAV1_ALWAYS_INLINE void RowShift(int16_t* source, int num_rows,
+                                    int row_shift) {
+  const __m512i v_row_shift_add = _mm512_set1_epi16(row_shift);
+  const __m128i v_row_shift = _mm_cvtsi32_si128(row_shift);
+  int i = 0;
+  do {
+    for (int j = 0; j < tx_width; j += 32) {
+      const __m512i residual = LoadUnaligned64(&source[i * tx_width + j]);
+      const __m512i shifted_residual =
+          ShiftResidual(residual, v_row_shift_add, v_row_shift);
+      StoreUnaligned64(&source[i * tx_width + j], shifted_residual);
+    }
+  } while (++i < num_rows);
+}
+
+void Dct32TransformLoopRow_AVX512(TransformType /*tx_type*/,
+                                  TransformSize tx_size, int adjusted_tx_height,
+                                  void* src_buffer, int /*start_x*/,
+                                  int /*start_y*/, void* /*dst_frame*/) {
+  auto* src = static_cast<int16_t*>(src_buffer);
+  const bool should_round = kShouldRound[tx_size];
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+
+  if (DctDcOnly<32>(src, adjusted_tx_height, should_round, row_shift)) {
+    return;
+  }
+
+  if (should_round) {
+    ApplyRounding<32>(src, adjusted_tx_height);
+  }
+  // Process 32 1d dct32 rows in parallel per iteration. The remaining rows
+  // are processed 16 and then 8 at a time, which may include rows past
+  // |adjusted_tx_height| (they are zero), as in the SSE4.1 version.
+  int i = 0;
+  for (; i + 32 <= adjusted_tx_height; i += 32) {
+    Dct32_AVX512<32>(&src[i * 32], 32, /*transpose=*/true);
+  }
+  if (i + 16 <= adjusted_tx_height) {
+    Dct32_AVX512<16>(&src[i * 32], 32, /*transpose=*/true);
+    i += 16;
+  }
+  if (i < adjusted_tx_height) {
+    Dct32_AVX512<8>(&src[i * 32], 32, /*transpose=*/true);
+  }
+  // row_shift is always non zero here.
+  RowShift<32>(src, adjusted_tx_height, row_shift);
+}
+
+void Dct32TransformLoopColumn_AVX512(TransformType /*tx_type*/,
+                                     TransformSize tx_size,
+                                     int adjusted_tx_height,
+                                     void* LIBGAV1_RESTRICT src_buffer,
+                                     int start_x, int start_y,
+                                     void* LIBGAV1_RESTRICT dst_frame) {
+  auto* src = static_cast<int16_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  if (!DctDcOnlyColumn<32>(src, adjusted_tx_height, tx_width)) {
+    if (tx_width == 8) {
+      Dct32_AVX512<8>(src, tx_width, /*transpose=*/false);
+    } else if (tx_width == 16) {
+      Dct32_AVX512<16>(src, tx_width, /*transpose=*/false);
+    } else {
+      // Process 32 1d dct32 columns in parallel per iteration.
+      int i = 0;
+      do {
+        Dct32_AVX512<32>(&src[i], tx_width, /*transpose=*/false);
+        i += 32;
+      } while (i < tx_width);
+    }
+  }
+  auto& frame = *static_cast<Array2DView<uint8_t>*>(dst_frame);
+  StoreToFrameWithRound(frame, start_x, start_y, tx_width, 32, src);
+}
+
+void Dct64TransformLoopRow_AVX512(TransformType /*tx_type*/,
+                                  TransformSize tx_size, int adjusted_tx_height,
+                                  void* src_buffer, int /*start_x*/,
+                                  int /*start_y*/, void* /*dst_frame*/) {
+  auto* src = static_cast<int16_t*>(src_buffer);
+  const bool should_round = kShouldRound[tx_size];
+  const uint8_t row_shift = kTransformRowShift[tx_size];
+
+  if (DctDcOnly<64>(src, adjusted_tx_height, should_round, row_shift)) {
+    return;
+  }
+
+  if (should_round) {
+    ApplyRounding<64>(src, adjusted_tx_height);
+  }
+  // Process 32 1d dct64 rows in parallel per iteration. The remaining rows
+  // are processed 16 and then 8 at a time, which may include rows past
+  // |adjusted_tx_height| (they are zero), as in the SSE4.1 version.
+  int i = 0;
+  for (; i + 32 <= adjusted_tx_height; i += 32) {
+    Dct64_AVX512<32>(&src[i * 64], 64, /*transpose=*/true);
+  }
+  if (i + 16 <= adjusted_tx_height) {
+    Dct64_AVX512<16>(&src[i * 64], 64, /*transpose=*/true);
+    i += 16;
+  }
+  if (i < adjusted_tx_height) {
+    Dct64_AVX512<8>(&src[i * 64], 64, /*transpose=*/true);
+  }
+  // row_shift is always non zero here.
+  RowShift<64>(src, adjusted_tx_height, row_shift);
+}
+
+void Dct64TransformLoopColumn_AVX512(TransformType /*tx_type*/,
+                                     TransformSize tx_size,
+                                     int adjusted_tx_height,
+                                     void* LIBGAV1_RESTRICT src_buffer,
+                                     int start_x, int start_y,
+                                     void* LIBGAV1_RESTRICT dst_frame) {
+  auto* src = static_cast<int16_t*>(src_buffer);
+  const int tx_width = kTransformWidth[tx_size];
+
+  if (!DctDcOnlyColumn<64>(src, adjusted_tx_height, tx_width)) {
+    if (tx_width == 16) {
+      Dct64_AVX512<16>(src, tx_width, /*transpose=*/false);
+    } else {
+      // Process 32 1d dct64 columns in parallel per iteration.
+      int i = 0;
+      do {
+        Dct64_AVX512<32>(&src[i], tx_width, /*transpose=*/false);
+        i += 32;
+      } while (i < tx_width);
+    }
+  }
+  auto& frame = *static_cast<Array2DView<uint8_t>*>(dst_frame);
+  StoreToFrameWithRound(frame, start_x, start_y, tx_width, 64, src);
+}
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_8BPP_AVX512(Transform1dSize32_Transform1dDct)
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize32][kRow] =
+      Dct32TransformLoopRow_AVX512;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize32][kColumn] =
+      Dct32TransformLoopColumn_AVX512;
+#endif
+#if DSP_ENABLED_8BPP_AVX512(Transform1dSize64_Transform1dDct)
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize64][kRow] =
+      Dct64TransformLoopRow_AVX512;
+  dsp->inverse_transforms[kTransform1dDct][kTransform1dSize64][kColumn] =
+      Dct64TransformLoopColumn_AVX512;
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+void InverseTransformInit_AVX512() { low_bitdepth::Init8bpp(); }
+
+}  // namespace dsp
+}  // namespace libgav1
+#else   // !LIBGAV1_TARGETING_AVX512
+namespace libgav1 {
+namespace dsp {
+
+void InverseTransformInit_AVX512() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX512
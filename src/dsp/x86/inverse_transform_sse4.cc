@@ -2972,12 +2972,18 @@ void Init8bpp() {
       Dct32TransformLoopRow_SSE4_1;
   dsp->inverse_transforms[kTransform1dDct][kTransform1dSize32][kColumn] =
       Dct32TransformLoopColumn_SSE4_1;
+#else
+  static_cast<void>(Dct32TransformLoopRow_SSE4_1);
+  static_cast<void>(Dct32TransformLoopColumn_SSE4_1);
 #endif
 #if DSP_ENABLED_8BPP_SSE4_1(Transform1dSize64_Transform1dDct)
   dsp->inverse_transforms[kTransform1dDct][kTransform1dSize64][kRow] =
       Dct64TransformLoopRow_SSE4_1;
   dsp->inverse_transforms[kTransform1dDct][kTransform1dSize64][kColumn] =
       Dct64TransformLoopColumn_SSE4_1;
+#else
+  static_cast<void>(Dct64TransformLoopRow_SSE4_1);
+  static_cast<void>(Dct64TransformLoopColumn_SSE4_1);
 #endif
 
   // Maximum transform size for Adst is 16.
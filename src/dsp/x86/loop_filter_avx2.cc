@@ -0,0 +1,704 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/loop_filter.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/utils/common.h"
+#include "src/utils/constants.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace {
+
+// The batched filters work on 16 pixels along the edge at a time, one pixel
+// per 16-bit lane. The same arithmetic is used for 8bpp and 10bpp, the
+// largest intermediate (the 13-tap filter sum) is 16 * 1023 + 8 which fits in
+// int16_t.
+constexpr int kPixelsPerBatch = 16;
+
+//------------------------------------------------------------------------------
+// Load/store helpers.
+
+// Loads |count| (4, 8, 12 or 16) pixels from |src| into 16-bit lanes. Lanes
+// beyond |count| are zeroed.
+inline __m256i LoadPixels(const uint8_t* const src, const int count) {
+  __m128i x;
+  switch (count) {
+    case 4:
+      x = Load4(src);
+      break;
+    case 8:
+      x = LoadLo8(src);
+      break;
+    case 12:
+      x = _mm_unpacklo_epi64(LoadLo8(src), Load4(src + 8));
+      break;
+    default:
+      x = LoadUnaligned16(src);
+      break;
+  }
+  return _mm256_cvtepu8_epi16(x);
+}
+
+inline __m256i LoadPixels(const uint16_t* const src, const int count) {
+  const __m128i zero = _mm_setzero_si128();
+  switch (count) {
+    case 4:
+      return SetrM128i(LoadLo8(src), zero);
+    case 8:
+      return SetrM128i(LoadUnaligned16(src), zero);
+    case 12:
+      return SetrM128i(LoadUnaligned16(src), LoadLo8(src + 8));
+    default:
+      return LoadUnaligned32(src);
+  }
+}
+
+inline void StorePixels(uint8_t* const dst, const __m256i v, const int count) {
+  const __m128i x = _mm_packus_epi16(_mm256_castsi256_si128(v),
+                                     _mm256_extracti128_si256(v, 1));
+  switch (count) {
+    case 4:
+      Store4(dst, x);
+      break;
+    case 8:
+      StoreLo8(dst, x);
+      break;
+    case 12:
+      StoreLo8(dst, x);
+      Store4(dst + 8, _mm_srli_si128(x, 8));
+      break;
+    default:
+      StoreUnaligned16(dst, x);
+      break;
+  }
+}
+
+inline void StorePixels(uint16_t* const dst, const __m256i v,
+                        const int count) {
+  switch (count) {
+    case 4:
+      StoreLo8(dst, _mm256_castsi256_si128(v));
+      break;
+    case 8:
+      StoreUnaligned16(dst, _mm256_castsi256_si128(v));
+      break;
+    case 12:
+      StoreUnaligned16(dst, _mm256_castsi256_si128(v));
+      StoreLo8(dst + 8, _mm256_extracti128_si256(v, 1));
+      break;
+    default:
+      StoreUnaligned32(dst, v);
+      break;
+  }
+}
+
+// Loads 8 pixels from |src| into 16-bit lanes.
+inline __m128i LoadRow8(const uint8_t* const src) {
+  return _mm_cvtepu8_epi16(LoadLo8(src));
+}
+
+inline __m128i LoadRow8(const uint16_t* const src) {
+  return LoadUnaligned16(src);
+}
+
+inline void StoreRow8(uint8_t* const dst, const __m128i x) {
+  StoreLo8(dst, _mm_packus_epi16(x, x));
+}
+
+inline void StoreRow8(uint16_t* const dst, const __m128i x) {
+  StoreUnaligned16(dst, x);
+}
+
+// Transposes the 8x8 blocks of 16-bit values in each 128-bit lane of |in|.
+LIBGAV1_ALWAYS_INLINE void Transpose8x8_U16(const __m256i* const in,
+                                            __m256i* const out) {
+  const __m256i a0 = _mm256_unpacklo_epi16(in[0], in[1]);
+  const __m256i a1 = _mm256_unpacklo_epi16(in[2], in[3]);
+  const __m256i a2 = _mm256_unpacklo_epi16(in[4], in[5]);
+  const __m256i a3 = _mm256_unpacklo_epi16(in[6], in[7]);
+  const __m256i a4 = _mm256_unpackhi_epi16(in[0], in[1]);
+  const __m256i a5 = _mm256_unpackhi_epi16(in[2], in[3]);
+  const __m256i a6 = _mm256_unpackhi_epi16(in[4], in[5]);
+  const __m256i a7 = _mm256_unpackhi_epi16(in[6], in[7]);
+
+  const __m256i b0 = _mm256_unpacklo_epi32(a0, a1);
+  const __m256i b1 = _mm256_unpacklo_epi32(a2, a3);
+  const __m256i b2 = _mm256_unpacklo_epi32(a4, a5);
+  const __m256i b3 = _mm256_unpacklo_epi32(a6, a7);
+  const __m256i b4 = _mm256_unpackhi_epi32(a0, a1);
+  const __m256i b5 = _mm256_unpackhi_epi32(a2, a3);
+  const __m256i b6 = _mm256_unpackhi_epi32(a4, a5);
+  const __m256i b7 = _mm256_unpackhi_epi32(a6, a7);
+
+  out[0] = _mm256_unpacklo_epi64(b0, b1);
+  out[1] = _mm256_unpackhi_epi64(b0, b1);
+  out[2] = _mm256_unpacklo_epi64(b4, b5);
+  out[3] = _mm256_unpackhi_epi64(b4, b5);
+  out[4] = _mm256_unpacklo_epi64(b2, b3);
+  out[5] = _mm256_unpackhi_epi64(b2, b3);
+  out[6] = _mm256_unpacklo_epi64(b6, b7);
+  out[7] = _mm256_unpackhi_epi64(b6, b7);
+}
+
+// Loads an 8 pixel wide column of |count| rows starting at |src| and
+// transposes it so that |column[i]| holds pixel i of each row. Row r is kept
+// in lane r, rows beyond |count| are zeroed.
+template <typename Pixel>
+inline void LoadColumns8(const Pixel* const src, const ptrdiff_t stride,
+                         const int count, __m256i column[8]) {
+  const __m128i zero = _mm_setzero_si128();
+  __m256i rows[8];
+  for (int i = 0; i < 8; ++i) {
+    const __m128i lo = (i < count) ? LoadRow8(src + i * stride) : zero;
+    const __m128i hi =
+        (i + 8 < count) ? LoadRow8(src + (i + 8) * stride) : zero;
+    rows[i] = SetrM128i(lo, hi);
+  }
+  Transpose8x8_U16(rows, column);
+}
+
+// The inverse of LoadColumns8(). Only the first |count| rows are written.
+template <typename Pixel>
+inline void StoreColumns8(Pixel* const dst, const ptrdiff_t stride,
+                          const int count, const __m256i column[8]) {
+  __m256i rows[8];
+  Transpose8x8_U16(column, rows);
+  for (int i = 0; i < 8 && i < count; ++i) {
+    StoreRow8(dst + i * stride, _mm256_castsi256_si128(rows[i]));
+  }
+  for (int i = 0; i < 8 && i + 8 < count; ++i) {
+    StoreRow8(dst + (i + 8) * stride, _mm256_extracti128_si256(rows[i], 1));
+  }
+}
+
+//------------------------------------------------------------------------------
+// Filter masks and kernels.
+
+inline __m256i AbsDiff(const __m256i& a, const __m256i& b) {
+  return _mm256_abs_epi16(_mm256_sub_epi16(a, b));
+}
+
+inline __m256i Clamp(const __m256i& min, const __m256i& max,
+                     const __m256i& val) {
+  return _mm256_min_epi16(_mm256_max_epi16(val, min), max);
+}
+
+inline bool AllZero(const __m256i& mask) {
+  return _mm256_testz_si256(mask, mask) != 0;
+}
+
+// Broadcast, bitdepth-scaled thresholds. |inner| and |outer| are stored plus
+// one so that _mm256_cmpgt_epi16(limit, x) computes x <= limit.
+template <int bitdepth>
+struct Thresholds {
+  Thresholds(const int outer_thresh, const int inner_thresh,
+             const int hev_thresh)
+      : outer(_mm256_set1_epi16(((outer_thresh << (bitdepth - 8)) + 1))),
+        inner(_mm256_set1_epi16(((inner_thresh << (bitdepth - 8)) + 1))),
+        hev(_mm256_set1_epi16(hev_thresh << (bitdepth - 8))),
+        flat(_mm256_set1_epi16((1 << (bitdepth - 8)) + 1)) {}
+
+  const __m256i outer;
+  const __m256i inner;
+  const __m256i hev;
+  const __m256i flat;
+};
+
+// 7.14.6.2. |max_inner| is the largest absolute difference between
+// neighboring pixels on either side of the edge.
+template <int bitdepth>
+inline __m256i NeedsFilter(const __m256i& p1, const __m256i& p0,
+                           const __m256i& q0, const __m256i& q1,
+                           const __m256i& max_inner,
+                           const Thresholds<bitdepth>& thresh) {
+  const __m256i abs_p0q0 = AbsDiff(p0, q0);
+  const __m256i abs_p1q1 = AbsDiff(p1, q1);
+  const __m256i outer = _mm256_add_epi16(_mm256_add_epi16(abs_p0q0, abs_p0q0),
+                                         _mm256_srli_epi16(abs_p1q1, 1));
+  return _mm256_and_si256(_mm256_cmpgt_epi16(thresh.inner, max_inner),
+                          _mm256_cmpgt_epi16(thresh.outer, outer));
+}
+
+// 7.14.6.3. Lanes with |hev| set apply filter 2, the others filter 4.
+template <int bitdepth>
+inline void Filter4(__m256i* const px, const __m256i& hev,
+                    const __m256i& needs_filter) {
+  const __m256i min_signed = _mm256_set1_epi16(-(1 << (bitdepth - 1)));
+  const __m256i max_signed = _mm256_set1_epi16((1 << (bitdepth - 1)) - 1);
+  const __m256i max_pixel = _mm256_set1_epi16((1 << bitdepth) - 1);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i p1 = px[-2];
+  const __m256i p0 = px[-1];
+  const __m256i q0 = px[0];
+  const __m256i q1 = px[1];
+
+  const __m256i p1q1 = _mm256_and_si256(
+      Clamp(min_signed, max_signed, _mm256_sub_epi16(p1, q1)), hev);
+  const __m256i q0p0 = _mm256_sub_epi16(q0, p0);
+  const __m256i a = _mm256_add_epi16(
+      _mm256_add_epi16(q0p0, _mm256_add_epi16(q0p0, q0p0)), p1q1);
+  const __m256i a1 = _mm256_srai_epi16(
+      Clamp(min_signed, max_signed, _mm256_add_epi16(a, _mm256_set1_epi16(4))),
+      3);
+  const __m256i a2 = _mm256_srai_epi16(
+      Clamp(min_signed, max_signed, _mm256_add_epi16(a, _mm256_set1_epi16(3))),
+      3);
+  const __m256i a3 = _mm256_andnot_si256(
+      hev, _mm256_srai_epi16(_mm256_add_epi16(a1, _mm256_set1_epi16(1)), 1));
+
+  const __m256i op1 = Clamp(zero, max_pixel, _mm256_add_epi16(p1, a3));
+  const __m256i op0 = Clamp(zero, max_pixel, _mm256_add_epi16(p0, a2));
+  const __m256i oq0 = Clamp(zero, max_pixel, _mm256_sub_epi16(q0, a1));
+  const __m256i oq1 = Clamp(zero, max_pixel, _mm256_sub_epi16(q1, a3));
+  px[-2] = _mm256_blendv_epi8(p1, op1, needs_filter);
+  px[-1] = _mm256_blendv_epi8(p0, op0, needs_filter);
+  px[0] = _mm256_blendv_epi8(q0, oq0, needs_filter);
+  px[1] = _mm256_blendv_epi8(q1, oq1, needs_filter);
+}
+
+// Replaces |*dst| with the rounded |sum| >> |shift| in lanes set in |mask|.
+inline void BlendFilterSum(const __m256i& sum, const int shift,
+                           const __m256i& mask, __m256i* const dst) {
+  const __m256i rounded = _mm256_srli_epi16(
+      _mm256_add_epi16(sum, _mm256_set1_epi16(1 << (shift - 1))), shift);
+  *dst = _mm256_blendv_epi8(*dst, rounded, mask);
+}
+
+// 7.14.6.4. |in| holds p2..q2 from before Filter4(), the results are blended
+// into |px| in the lanes set in |mask|.
+inline void Filter6(const __m256i in[6], const __m256i& mask,
+                    __m256i* const px) {
+  const __m256i& p2 = in[0];
+  const __m256i& p1 = in[1];
+  const __m256i& p0 = in[2];
+  const __m256i& q0 = in[3];
+  const __m256i& q1 = in[4];
+  const __m256i& q2 = in[5];
+  // p1 = 3 * p2 + 2 * p1 + 2 * p0 + q0
+  __m256i sum = _mm256_add_epi16(_mm256_add_epi16(p2, p2), p2);
+  sum = _mm256_add_epi16(sum, _mm256_slli_epi16(_mm256_add_epi16(p1, p0), 1));
+  sum = _mm256_add_epi16(sum, q0);
+  BlendFilterSum(sum, 3, mask, &px[-2]);
+  // p0 = p1 - 2 * p2 + q0 + q1
+  sum = _mm256_sub_epi16(sum, _mm256_add_epi16(p2, p2));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(q0, q1));
+  BlendFilterSum(sum, 3, mask, &px[-1]);
+  // q0 = p0 - p2 - p1 + q1 + q2
+  sum = _mm256_sub_epi16(sum, _mm256_add_epi16(p2, p1));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(q1, q2));
+  BlendFilterSum(sum, 3, mask, &px[0]);
+  // q1 = q0 - p1 - p0 + 2 * q2
+  sum = _mm256_sub_epi16(sum, _mm256_add_epi16(p1, p0));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(q2, q2));
+  BlendFilterSum(sum, 3, mask, &px[1]);
+}
+
+// 7.14.6.4. |in| holds p3..q3 from before Filter4(), the results are blended
+// into |px| in the lanes set in |mask|.
+inline void Filter8(const __m256i in[8], const __m256i& mask,
+                    __m256i* const px) {
+  const __m256i& p3 = in[0];
+  const __m256i& p2 = in[1];
+  const __m256i& p1 = in[2];
+  const __m256i& p0 = in[3];
+  const __m256i& q0 = in[4];
+  const __m256i& q1 = in[5];
+  const __m256i& q2 = in[6];
+  const __m256i& q3 = in[7];
+  // p2 = 3 * p3 + 2 * p2 + p1 + p0 + q0
+  __m256i sum = _mm256_add_epi16(_mm256_add_epi16(p3, p3), p3);
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(p2, p2));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(p1, p0));
+  sum = _mm256_add_epi16(sum, q0);
+  BlendFilterSum(sum, 3, mask, &px[-3]);
+  // p1 = p2 - p3 - p2 + p1 + q1
+  sum = _mm256_sub_epi16(sum, _mm256_add_epi16(p3, p2));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(p1, q1));
+  BlendFilterSum(sum, 3, mask, &px[-2]);
+  // p0 = p1 - p3 - p1 + p0 + q2
+  sum = _mm256_sub_epi16(sum, _mm256_add_epi16(p3, p1));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(p0, q2));
+  BlendFilterSum(sum, 3, mask, &px[-1]);
+  // q0 = p0 - p3 - p0 + q0 + q3
+  sum = _mm256_sub_epi16(sum, _mm256_add_epi16(p3, p0));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(q0, q3));
+  BlendFilterSum(sum, 3, mask, &px[0]);
+  // q1 = q0 - p2 - q0 + q1 + q3
+  sum = _mm256_sub_epi16(sum, _mm256_add_epi16(p2, q0));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(q1, q3));
+  BlendFilterSum(sum, 3, mask, &px[1]);
+  // q2 = q1 - p1 - q1 + q2 + q3
+  sum = _mm256_sub_epi16(sum, _mm256_add_epi16(p1, q1));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(q2, q3));
+  BlendFilterSum(sum, 3, mask, &px[2]);
+}
+
+// 7.14.6.4. |in| holds p6..q6 from before Filter4(), the results are blended
+// into |px| in the lanes set in |mask|.
+inline void Filter14(const __m256i in[14], const __m256i& mask,
+                     __m256i* const px) {
+  const __m256i& p6 = in[0];
+  const __m256i& p5 = in[1];
+  const __m256i& p4 = in[2];
+  const __m256i& p3 = in[3];
+  const __m256i& p2 = in[4];
+  const __m256i& p1 = in[5];
+  const __m256i& p0 = in[6];
+  const __m256i& q0 = in[7];
+  const __m256i& q1 = in[8];
+  const __m256i& q2 = in[9];
+  const __m256i& q3 = in[10];
+  const __m256i& q4 = in[11];
+  const __m256i& q5 = in[12];
+  const __m256i& q6 = in[13];
+  // p5 = 7 * p6 + 2 * p5 + 2 * p4 + p3 + p2 + p1 + p0 + q0
+  __m256i sum = _mm256_sub_epi16(_mm256_slli_epi16(p6, 3), p6);
+  sum = _mm256_add_epi16(sum, _mm256_slli_epi16(_mm256_add_epi16(p5, p4), 1));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(p3, p2));
+  sum = _mm256_add_epi16(sum, _mm256_add_epi16(p1, p0));
+  sum = _mm256_add_epi16(sum, q0);
+  BlendFilterSum(sum, 4, mask, &px[-6]);
+  // Each following output adds two taps and removes two taps from the
+  // previous sum.
+  const __m256i* const sub_taps[11][2] = {
+      {&p6, &p6}, {&p6, &p5}, {&p6, &p4}, {&p6, &p3}, {&p6, &p2}, {&p6, &p1},
+      {&p5, &p0}, {&p4, &q0}, {&p3, &q1}, {&p2, &q2}, {&p1, &q3}};
+  const __m256i* const add_taps[11][2] = {
+      {&p3, &q1}, {&p2, &q2}, {&p1, &q3}, {&p0, &q4}, {&q0, &q5}, {&q1, &q6},
+      {&q2, &q6}, {&q3, &q6}, {&q4, &q6}, {&q5, &q6}, {&q6, &q6}};
+  for (int i = 0; i < 11; ++i) {
+    sum = _mm256_sub_epi16(
+        sum, _mm256_add_epi16(*sub_taps[i][0], *sub_taps[i][1]));
+    sum = _mm256_add_epi16(
+        sum, _mm256_add_epi16(*add_taps[i][0], *add_taps[i][1]));
+    BlendFilterSum(sum, 4, mask, &px[i - 5]);
+  }
+}
+
+// Applies the loop filter of |size| to the 16 lanes of |px|, which points to
+// q0 with p0 at px[-1] and so on. EdgeFilter::kTaps pixels on each side of
+// the edge are read and EdgeFilter::kOutputs pixels on each side may be
+// modified.
+template <int bitdepth, LoopFilterSize size>
+struct EdgeFilter;
+
+template <int bitdepth>
+struct EdgeFilter<bitdepth, kLoopFilterSize4> {
+  static constexpr int kTaps = 2;
+  static constexpr int kOutputs = 2;
+
+  static void Filter(__m256i* const px, const Thresholds<bitdepth>& thresh) {
+    const __m256i max_p1p0_q1q0 =
+        _mm256_max_epu16(AbsDiff(px[-2], px[-1]), AbsDiff(px[1], px[0]));
+    const __m256i needs_filter =
+        NeedsFilter(px[-2], px[-1], px[0], px[1], max_p1p0_q1q0, thresh);
+    if (AllZero(needs_filter)) return;
+    const __m256i hev = _mm256_cmpgt_epi16(max_p1p0_q1q0, thresh.hev);
+    Filter4<bitdepth>(px, hev, needs_filter);
+  }
+};
+
+template <int bitdepth>
+struct EdgeFilter<bitdepth, kLoopFilterSize6> {
+  static constexpr int kTaps = 3;
+  static constexpr int kOutputs = 2;
+
+  static void Filter(__m256i* const px, const Thresholds<bitdepth>& thresh) {
+    const __m256i in[6] = {px[-3], px[-2], px[-1], px[0], px[1], px[2]};
+    const __m256i max_p1p0_q1q0 =
+        _mm256_max_epu16(AbsDiff(in[1], in[2]), AbsDiff(in[4], in[3]));
+    const __m256i max_inner = _mm256_max_epu16(
+        max_p1p0_q1q0,
+        _mm256_max_epu16(AbsDiff(in[0], in[1]), AbsDiff(in[5], in[4])));
+    const __m256i needs_filter =
+        NeedsFilter(in[1], in[2], in[3], in[4], max_inner, thresh);
+    if (AllZero(needs_filter)) return;
+    const __m256i hev = _mm256_cmpgt_epi16(max_p1p0_q1q0, thresh.hev);
+    Filter4<bitdepth>(px, hev, needs_filter);
+
+    const __m256i max_flat = _mm256_max_epu16(
+        max_p1p0_q1q0,
+        _mm256_max_epu16(AbsDiff(in[0], in[2]), AbsDiff(in[5], in[3])));
+    const __m256i flat = _mm256_and_si256(
+        needs_filter, _mm256_cmpgt_epi16(thresh.flat, max_flat));
+    if (AllZero(flat)) return;
+    Filter6(in, flat, px);
+  }
+};
+
+template <int bitdepth>
+struct EdgeFilter<bitdepth, kLoopFilterSize8> {
+  static constexpr int kTaps = 4;
+  static constexpr int kOutputs = 3;
+
+  static void Filter(__m256i* const px, const Thresholds<bitdepth>& thresh) {
+    const __m256i in[8] = {px[-4], px[-3], px[-2], px[-1],
+                           px[0],  px[1],  px[2],  px[3]};
+    const __m256i max_p1p0_q1q0 =
+        _mm256_max_epu16(AbsDiff(in[2], in[3]), AbsDiff(in[5], in[4]));
+    const __m256i max_inner = _mm256_max_epu16(
+        _mm256_max_epu16(max_p1p0_q1q0,
+                         _mm256_max_epu16(AbsDiff(in[1], in[2]),
+                                          AbsDiff(in[6], in[5]))),
+        _mm256_max_epu16(AbsDiff(in[0], in[1]), AbsDiff(in[7], in[6])));
+    const __m256i needs_filter =
+        NeedsFilter(in[2], in[3], in[4], in[5], max_inner, thresh);
+    if (AllZero(needs_filter)) return;
+    const __m256i hev = _mm256_cmpgt_epi16(max_p1p0_q1q0, thresh.hev);
+    Filter4<bitdepth>(px, hev, needs_filter);
+
+    const __m256i max_flat = _mm256_max_epu16(
+        _mm256_max_epu16(max_p1p0_q1q0,
+                         _mm256_max_epu16(AbsDiff(in[1], in[3]),
+                                          AbsDiff(in[6], in[4]))),
+        _mm256_max_epu16(AbsDiff(in[0], in[3]), AbsDiff(in[7], in[4])));
+    const __m256i flat = _mm256_and_si256(
+        needs_filter, _mm256_cmpgt_epi16(thresh.flat, max_flat));
+    if (AllZero(flat)) return;
+    Filter8(in, flat, px);
+  }
+};
+
+template <int bitdepth>
+struct EdgeFilter<bitdepth, kLoopFilterSize14> {
+  static constexpr int kTaps = 7;
+  static constexpr int kOutputs = 6;
+
+  static void Filter(__m256i* const px, const Thresholds<bitdepth>& thresh) {
+    const __m256i in[14] = {px[-7], px[-6], px[-5], px[-4], px[-3],
+                            px[-2], px[-1], px[0],  px[1],  px[2],
+                            px[3],  px[4],  px[5],  px[6]};
+    const __m256i* const in8 = in + 3;
+    const __m256i max_p1p0_q1q0 =
+        _mm256_max_epu16(AbsDiff(in8[2], in8[3]), AbsDiff(in8[5], in8[4]));
+    const __m256i max_inner = _mm256_max_epu16(
+        _mm256_max_epu16(max_p1p0_q1q0,
+                         _mm256_max_epu16(AbsDiff(in8[1], in8[2]),
+                                          AbsDiff(in8[6], in8[5]))),
+        _mm256_max_epu16(AbsDiff(in8[0], in8[1]), AbsDiff(in8[7], in8[6])));
+    const __m256i needs_filter =
+        NeedsFilter(in8[2], in8[3], in8[4], in8[5], max_inner, thresh);
+    if (AllZero(needs_filter)) return;
+    const __m256i hev = _mm256_cmpgt_epi16(max_p1p0_q1q0, thresh.hev);
+    Filter4<bitdepth>(px, hev, needs_filter);
+
+    const __m256i max_flat = _mm256_max_epu16(
+        _mm256_max_epu16(max_p1p0_q1q0,
+                         _mm256_max_epu16(AbsDiff(in8[1], in8[3]),
+                                          AbsDiff(in8[6], in8[4]))),
+        _mm256_max_epu16(AbsDiff(in8[0], in8[3]), AbsDiff(in8[7], in8[4])));
+    const __m256i flat = _mm256_and_si256(
+        needs_filter, _mm256_cmpgt_epi16(thresh.flat, max_flat));
+    if (AllZero(flat)) return;
+    Filter8(in8, flat, px);
+
+    // IsFlatOuter4().
+    const __m256i max_flat_outer = _mm256_max_epu16(
+        _mm256_max_epu16(
+            _mm256_max_epu16(AbsDiff(in[2], in[6]), AbsDiff(in[11], in[7])),
+            _mm256_max_epu16(AbsDiff(in[1], in[6]), AbsDiff(in[12], in[7]))),
+        _mm256_max_epu16(AbsDiff(in[0], in[6]), AbsDiff(in[13], in[7])));
+    const __m256i flat_outer = _mm256_and_si256(
+        flat, _mm256_cmpgt_epi16(thresh.flat, max_flat_outer));
+    if (AllZero(flat_outer)) return;
+    Filter14(in, flat_outer, px);
+  }
+};
+
+//------------------------------------------------------------------------------
+// Batched edge filters.
+
+template <int bitdepth, typename Pixel, LoopFilterSize size>
+void HorizontalBatch(void* const dest, ptrdiff_t stride,
+                     const int num_segments, const int outer_thresh,
+                     const int inner_thresh, const int hev_thresh) {
+  using Filter = EdgeFilter<bitdepth, size>;
+  constexpr int kTaps = Filter::kTaps;
+  constexpr int kOutputs = Filter::kOutputs;
+  assert(num_segments > 0);
+  const Thresholds<bitdepth> thresh(outer_thresh, inner_thresh, hev_thresh);
+  auto* dst = static_cast<Pixel*>(dest);
+  stride /= sizeof(Pixel);
+
+  int remaining = MultiplyBy4(num_segments);
+  do {
+    const int count =
+        (remaining < kPixelsPerBatch) ? remaining : kPixelsPerBatch;
+    __m256i px[2 * kTaps];
+    for (int i = 0; i < 2 * kTaps; ++i) {
+      px[i] = LoadPixels(dst + (i - kTaps) * stride, count);
+    }
+    Filter::Filter(px + kTaps, thresh);
+    for (int i = kTaps - kOutputs; i < kTaps + kOutputs; ++i) {
+      StorePixels(dst + (i - kTaps) * stride, px[i], count);
+    }
+    dst += kPixelsPerBatch;
+    remaining -= kPixelsPerBatch;
+  } while (remaining > 0);
+}
+
+template <int bitdepth, typename Pixel, LoopFilterSize size>
+void VerticalBatch(void* const dest, ptrdiff_t stride, const int num_segments,
+                   const int outer_thresh, const int inner_thresh,
+                   const int hev_thresh) {
+  using Filter = EdgeFilter<bitdepth, size>;
+  // 8 columns are transposed for the 4, 6 and 8-tap filters, 16 for the
+  // 13-tap filter.
+  constexpr int kColumns = (size == kLoopFilterSize14) ? 16 : 8;
+  static_assert(Filter::kTaps <= kColumns / 2, "");
+  assert(num_segments > 0);
+  const Thresholds<bitdepth> thresh(outer_thresh, inner_thresh, hev_thresh);
+  auto* dst = static_cast<Pixel*>(dest) - kColumns / 2;
+  stride /= sizeof(Pixel);
+
+  int remaining = MultiplyBy4(num_segments);
+  do {
+    const int count =
+        (remaining < kPixelsPerBatch) ? remaining : kPixelsPerBatch;
+    __m256i px[kColumns];
+    for (int i = 0; i < kColumns; i += 8) {
+      LoadColumns8(dst + i, stride, count, px + i);
+    }
+    Filter::Filter(px + kColumns / 2, thresh);
+    for (int i = 0; i < kColumns; i += 8) {
+      StoreColumns8(dst + i, stride, count, px + i);
+    }
+    dst += kPixelsPerBatch * stride;
+    remaining -= kPixelsPerBatch;
+  } while (remaining > 0);
+}
+
+namespace low_bitdepth {
+namespace {
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+  static_cast<void>(dsp);
+#if DSP_ENABLED_8BPP_AVX2(LoopFilterBatchSize4_LoopFilterTypeHorizontal)
+  dsp->loop_filter_batches[kLoopFilterSize4][kLoopFilterTypeHorizontal] =
+      HorizontalBatch<8, uint8_t, kLoopFilterSize4>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(LoopFilterBatchSize6_LoopFilterTypeHorizontal)
+  dsp->loop_filter_batches[kLoopFilterSize6][kLoopFilterTypeHorizontal] =
+      HorizontalBatch<8, uint8_t, kLoopFilterSize6>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(LoopFilterBatchSize8_LoopFilterTypeHorizontal)
+  dsp->loop_filter_batches[kLoopFilterSize8][kLoopFilterTypeHorizontal] =
+      HorizontalBatch<8, uint8_t, kLoopFilterSize8>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(LoopFilterBatchSize14_LoopFilterTypeHorizontal)
+  dsp->loop_filter_batches[kLoopFilterSize14][kLoopFilterTypeHorizontal] =
+      HorizontalBatch<8, uint8_t, kLoopFilterSize14>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(LoopFilterBatchSize4_LoopFilterTypeVertical)
+  dsp->loop_filter_batches[kLoopFilterSize4][kLoopFilterTypeVertical] =
+      VerticalBatch<8, uint8_t, kLoopFilterSize4>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(LoopFilterBatchSize6_LoopFilterTypeVertical)
+  dsp->loop_filter_batches[kLoopFilterSize6][kLoopFilterTypeVertical] =
+      VerticalBatch<8, uint8_t, kLoopFilterSize6>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(LoopFilterBatchSize8_LoopFilterTypeVertical)
+  dsp->loop_filter_batches[kLoopFilterSize8][kLoopFilterTypeVertical] =
+      VerticalBatch<8, uint8_t, kLoopFilterSize8>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(LoopFilterBatchSize14_LoopFilterTypeVertical)
+  dsp->loop_filter_batches[kLoopFilterSize14][kLoopFilterTypeVertical] =
+      VerticalBatch<8, uint8_t, kLoopFilterSize14>;
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+  static_cast<void>(dsp);
+#if DSP_ENABLED_10BPP_AVX2(LoopFilterBatchSize4_LoopFilterTypeHorizontal)
+  dsp->loop_filter_batches[kLoopFilterSize4][kLoopFilterTypeHorizontal] =
+      HorizontalBatch<10, uint16_t, kLoopFilterSize4>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(LoopFilterBatchSize6_LoopFilterTypeHorizontal)
+  dsp->loop_filter_batches[kLoopFilterSize6][kLoopFilterTypeHorizontal] =
+      HorizontalBatch<10, uint16_t, kLoopFilterSize6>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(LoopFilterBatchSize8_LoopFilterTypeHorizontal)
+  dsp->loop_filter_batches[kLoopFilterSize8][kLoopFilterTypeHorizontal] =
+      HorizontalBatch<10, uint16_t, kLoopFilterSize8>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(LoopFilterBatchSize14_LoopFilterTypeHorizontal)
+  dsp->loop_filter_batches[kLoopFilterSize14][kLoopFilterTypeHorizontal] =
+      HorizontalBatch<10, uint16_t, kLoopFilterSize14>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(LoopFilterBatchSize4_LoopFilterTypeVertical)
+  dsp->loop_filter_batches[kLoopFilterSize4][kLoopFilterTypeVertical] =
+      VerticalBatch<10, uint16_t, kLoopFilterSize4>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(LoopFilterBatchSize6_LoopFilterTypeVertical)
+  dsp->loop_filter_batches[kLoopFilterSize6][kLoopFilterTypeVertical] =
+      VerticalBatch<10, uint16_t, kLoopFilterSize6>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(LoopFilterBatchSize8_LoopFilterTypeVertical)
+  dsp->loop_filter_batches[kLoopFilterSize8][kLoopFilterTypeVertical] =
+      VerticalBatch<10, uint16_t, kLoopFilterSize8>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(LoopFilterBatchSize14_LoopFilterTypeVertical)
+  dsp->loop_filter_batches[kLoopFilterSize14][kLoopFilterTypeVertical] =
+      VerticalBatch<10, uint16_t, kLoopFilterSize14>;
+#endif
+}
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+}  // namespace
+
+void LoopFilterInit_AVX2() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif
+}
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !LIBGAV1_TARGETING_AVX2
+namespace libgav1 {
+namespace dsp {
+
+void LoopFilterInit_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2
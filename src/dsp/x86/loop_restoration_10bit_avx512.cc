@@ -0,0 +1,461 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/loop_restoration.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX512 && LIBGAV1_MAX_BITDEPTH >= 10
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "src/dsp/common.h"
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx512.h"
+#include "src/utils/common.h"
+#include "src/utils/constants.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace {
+
+// The Wiener filter follows WienerFilter_AVX2() in
+// loop_restoration_10bit_avx2.cc closely. The intermediate buffer keeps the
+// same stride (a multiple of 16), so the main loops work on 32 pixels and a
+// trailing 16 pixel chunk is handled in the lower half of the registers.
+// |kTail| selects the latter. The tail loads read the same pixels as the AVX2
+// version and leave the upper half undefined, which is never stored.
+
+template <bool kTail>
+inline __m512i WienerLoad(const void* const src) {
+  if (kTail) return _mm512_castsi256_si512(LoadUnaligned32(src));
+  return LoadUnaligned64(src);
+}
+
+template <bool kTail>
+inline void WienerStore(void* const dst, const __m512i d) {
+  if (kTail) {
+    StoreUnaligned32(dst, _mm512_castsi512_si256(d));
+  } else {
+    StoreUnaligned64(dst, d);
+  }
+}
+
+inline __m512i PairCoefficients(const int16_t lo, const int16_t hi) {
+  return _mm512_set1_epi32(static_cast<int32_t>(
+      (static_cast<uint32_t>(static_cast<uint16_t>(hi)) << 16) |
+      static_cast<uint16_t>(lo)));
+}
+
+template <bool kTail>
+inline void WienerHorizontalClip(const __m512i s[2],
+                                 int16_t* const wiener_buffer) {
+  constexpr int offset =
+      1 << (10 + kWienerFilterBits - kInterRoundBitsHorizontal - 1);
+  constexpr int limit = (offset << 2) - 1;
+  const __m512i offsets = _mm512_set1_epi16(-offset);
+  const __m512i limits = _mm512_set1_epi16(limit - offset);
+  const __m512i round = _mm512_set1_epi32(1 << (kInterRoundBitsHorizontal - 1));
+  const __m512i sum0 = _mm512_add_epi32(s[0], round);
+  const __m512i sum1 = _mm512_add_epi32(s[1], round);
+  const __m512i rounded_sum0 =
+      _mm512_srai_epi32(sum0, kInterRoundBitsHorizontal);
+  const __m512i rounded_sum1 =
+      _mm512_srai_epi32(sum1, kInterRoundBitsHorizontal);
+  const __m512i rounded_sum = _mm512_packs_epi32(rounded_sum0, rounded_sum1);
+  const __m512i d0 = _mm512_max_epi16(rounded_sum, offsets);
+  const __m512i d1 = _mm512_min_epi16(d0, limits);
+  WienerStore<kTail>(wiener_buffer, d1);
+}
+
+template <bool kTail>
+inline void WienerHorizontalTap7Kernel(const uint16_t* const src,
+                                       const __m512i filter[2],
+                                       int16_t* const wiener_buffer) {
+  __m512i s[7];
+  for (int i = 0; i < 7; ++i) s[i] = WienerLoad<kTail>(src + i);
+  const __m512i s06 = _mm512_add_epi16(s[0], s[6]);
+  const __m512i s15 = _mm512_add_epi16(s[1], s[5]);
+  const __m512i s24 = _mm512_add_epi16(s[2], s[4]);
+  const __m512i ss0 = _mm512_unpacklo_epi16(s06, s15);
+  const __m512i ss1 = _mm512_unpackhi_epi16(s06, s15);
+  const __m512i ss2 = _mm512_unpacklo_epi16(s24, s[3]);
+  const __m512i ss3 = _mm512_unpackhi_epi16(s24, s[3]);
+  __m512i madds[4];
+  madds[0] = _mm512_madd_epi16(ss0, filter[0]);
+  madds[1] = _mm512_madd_epi16(ss1, filter[0]);
+  madds[2] = _mm512_madd_epi16(ss2, filter[1]);
+  madds[3] = _mm512_madd_epi16(ss3, filter[1]);
+  madds[0] = _mm512_add_epi32(madds[0], madds[2]);
+  madds[1] = _mm512_add_epi32(madds[1], madds[3]);
+  WienerHorizontalClip<kTail>(madds, wiener_buffer);
+}
+
+template <bool kTail>
+inline void WienerHorizontalTap5Kernel(const uint16_t* const src,
+                                       const __m512i filter[1],
+                                       int16_t* const wiener_buffer) {
+  __m512i s[5];
+  for (int i = 0; i < 5; ++i) s[i] = WienerLoad<kTail>(src + i);
+  const __m512i s04 = _mm512_add_epi16(s[0], s[4]);
+  const __m512i s13 = _mm512_add_epi16(s[1], s[3]);
+  const __m512i s2d = _mm512_add_epi16(s[2], s[2]);
+  const __m512i s0m = _mm512_sub_epi16(s04, s2d);
+  const __m512i s1m = _mm512_sub_epi16(s13, s2d);
+  const __m512i ss0 = _mm512_unpacklo_epi16(s0m, s1m);
+  const __m512i ss1 = _mm512_unpackhi_epi16(s0m, s1m);
+  __m512i madds[2];
+  madds[0] = _mm512_madd_epi16(ss0, filter[0]);
+  madds[1] = _mm512_madd_epi16(ss1, filter[0]);
+  const __m512i s2_lo = _mm512_unpacklo_epi16(s[2], _mm512_setzero_si512());
+  const __m512i s2_hi = _mm512_unpackhi_epi16(s[2], _mm512_setzero_si512());
+  const __m512i s2x128_lo = _mm512_slli_epi32(s2_lo, 7);
+  const __m512i s2x128_hi = _mm512_slli_epi32(s2_hi, 7);
+  madds[0] = _mm512_add_epi32(madds[0], s2x128_lo);
+  madds[1] = _mm512_add_epi32(madds[1], s2x128_hi);
+  WienerHorizontalClip<kTail>(madds, wiener_buffer);
+}
+
+template <bool kTail>
+inline void WienerHorizontalTap3Kernel(const uint16_t* const src,
+                                       const __m512i filter[1],
+                                       int16_t* const wiener_buffer) {
+  __m512i s[3];
+  for (int i = 0; i < 3; ++i) s[i] = WienerLoad<kTail>(src + i);
+  const __m512i s02 = _mm512_add_epi16(s[0], s[2]);
+  const __m512i ss0 = _mm512_unpacklo_epi16(s02, s[1]);
+  const __m512i ss1 = _mm512_unpackhi_epi16(s02, s[1]);
+  __m512i madds[2];
+  madds[0] = _mm512_madd_epi16(ss0, filter[0]);
+  madds[1] = _mm512_madd_epi16(ss1, filter[0]);
+  WienerHorizontalClip<kTail>(madds, wiener_buffer);
+}
+
+template <bool kTail>
+inline void WienerHorizontalTap1Kernel(const uint16_t* const src,
+                                       int16_t* const wiener_buffer) {
+  WienerStore<kTail>(wiener_buffer,
+                     _mm512_slli_epi16(WienerLoad<kTail>(src), 4));
+}
+
+template <int taps, bool kTail>
+inline void WienerHorizontalKernel(const uint16_t* const src,
+                                   const __m512i* const filter,
+                                   int16_t* const wiener_buffer) {
+  if (taps == 7) {
+    WienerHorizontalTap7Kernel<kTail>(src, filter, wiener_buffer);
+  } else if (taps == 5) {
+    WienerHorizontalTap5Kernel<kTail>(src, filter, wiener_buffer);
+  } else if (taps == 3) {
+    WienerHorizontalTap3Kernel<kTail>(src, filter, wiener_buffer);
+  } else {
+    WienerHorizontalTap1Kernel<kTail>(src, wiener_buffer);
+  }
+}
+
+template <int taps>
+inline void WienerHorizontal(const uint16_t* src, const ptrdiff_t src_stride,
+                             const ptrdiff_t width, const int height,
+                             const __m512i* const filter,
+                             int16_t** const wiener_buffer) {
+  for (int y = height; y != 0; --y) {
+    ptrdiff_t x = 0;
+    for (; x + 32 <= width; x += 32) {
+      WienerHorizontalKernel<taps, /*kTail=*/false>(src + x, filter,
+                                                    *wiener_buffer + x);
+    }
+    if (x < width) {
+      WienerHorizontalKernel<taps, /*kTail=*/true>(src + x, filter,
+                                                   *wiener_buffer + x);
+    }
+    src += src_stride;
+    *wiener_buffer += width;
+  }
+}
+
+inline __m512i WienerVertical7(const __m512i a[4], const __m512i filter[4]) {
+  const __m512i madd0 = _mm512_madd_epi16(a[0], filter[0]);
+  const __m512i madd1 = _mm512_madd_epi16(a[1], filter[1]);
+  const __m512i madd2 = _mm512_madd_epi16(a[2], filter[2]);
+  const __m512i madd3 = _mm512_madd_epi16(a[3], filter[3]);
+  const __m512i madd01 = _mm512_add_epi32(madd0, madd1);
+  const __m512i madd23 = _mm512_add_epi32(madd2, madd3);
+  const __m512i sum = _mm512_add_epi32(madd01, madd23);
+  return _mm512_srai_epi32(sum, kInterRoundBitsVertical);
+}
+
+inline __m512i WienerVertical5(const __m512i a[3], const __m512i filter[3]) {
+  const __m512i madd0 = _mm512_madd_epi16(a[0], filter[0]);
+  const __m512i madd1 = _mm512_madd_epi16(a[1], filter[1]);
+  const __m512i madd2 = _mm512_madd_epi16(a[2], filter[2]);
+  const __m512i madd01 = _mm512_add_epi32(madd0, madd1);
+  const __m512i sum = _mm512_add_epi32(madd01, madd2);
+  return _mm512_srai_epi32(sum, kInterRoundBitsVertical);
+}
+
+inline __m512i WienerVertical3(const __m512i a[2], const __m512i filter[2]) {
+  const __m512i madd0 = _mm512_madd_epi16(a[0], filter[0]);
+  const __m512i madd1 = _mm512_madd_epi16(a[1], filter[1]);
+  const __m512i sum = _mm512_add_epi32(madd0, madd1);
+  return _mm512_srai_epi32(sum, kInterRoundBitsVertical);
+}
+
+inline __m512i WienerVerticalClip(const __m512i s[2]) {
+  const __m512i d = _mm512_packus_epi32(s[0], s[1]);
+  return _mm512_min_epu16(d, _mm512_set1_epi16(1023));
+}
+
+inline __m512i WienerVerticalFilter7(const __m512i a[7],
+                                     const __m512i filter[4]) {
+  const __m512i round = _mm512_set1_epi16(1 << (kInterRoundBitsVertical - 1));
+  __m512i b[4], c[2];
+  b[0] = _mm512_unpacklo_epi16(a[0], a[1]);
+  b[1] = _mm512_unpacklo_epi16(a[2], a[3]);
+  b[2] = _mm512_unpacklo_epi16(a[4], a[5]);
+  b[3] = _mm512_unpacklo_epi16(a[6], round);
+  c[0] = WienerVertical7(b, filter);
+  b[0] = _mm512_unpackhi_epi16(a[0], a[1]);
+  b[1] = _mm512_unpackhi_epi16(a[2], a[3]);
+  b[2] = _mm512_unpackhi_epi16(a[4], a[5]);
+  b[3] = _mm512_unpackhi_epi16(a[6], round);
+  c[1] = WienerVertical7(b, filter);
+  return WienerVerticalClip(c);
+}
+
+inline __m512i WienerVerticalFilter5(const __m512i a[5],
+                                     const __m512i filter[3]) {
+  const __m512i round = _mm512_set1_epi16(1 << (kInterRoundBitsVertical - 1));
+  __m512i b[3], c[2];
+  b[0] = _mm512_unpacklo_epi16(a[0], a[1]);
+  b[1] = _mm512_unpacklo_epi16(a[2], a[3]);
+  b[2] = _mm512_unpacklo_epi16(a[4], round);
+  c[0] = WienerVertical5(b, filter);
+  b[0] = _mm512_unpackhi_epi16(a[0], a[1]);
+  b[1] = _mm512_unpackhi_epi16(a[2], a[3]);
+  b[2] = _mm512_unpackhi_epi16(a[4], round);
+  c[1] = WienerVertical5(b, filter);
+  return WienerVerticalClip(c);
+}
+
+inline __m512i WienerVerticalFilter3(const __m512i a[3],
+                                     const __m512i filter[2]) {
+  const __m512i round = _mm512_set1_epi16(1 << (kInterRoundBitsVertical - 1));
+  __m512i b[2], c[2];
+  b[0] = _mm512_unpacklo_epi16(a[0], a[1]);
+  b[1] = _mm512_unpacklo_epi16(a[2], round);
+  c[0] = WienerVertical3(b, filter);
+  b[0] = _mm512_unpackhi_epi16(a[0], a[1]);
+  b[1] = _mm512_unpackhi_epi16(a[2], round);
+  c[1] = WienerVertical3(b, filter);
+  return WienerVerticalClip(c);
+}
+
+inline __m512i WienerVerticalFilter1(const __m512i a) {
+  const __m512i b = _mm512_add_epi16(a, _mm512_set1_epi16(8));
+  const __m512i c = _mm512_srai_epi16(b, 4);
+  const __m512i d = _mm512_max_epi16(c, _mm512_setzero_si512());
+  return _mm512_min_epi16(d, _mm512_set1_epi16(1023));
+}
+
+inline __m512i WienerVerticalFilter(const __m512i* const a,
+                                    const __m512i* const filter,
+                                    const int taps) {
+  if (taps == 7) return WienerVerticalFilter7(a, filter);
+  if (taps == 5) return WienerVerticalFilter5(a, filter);
+  if (taps == 3) return WienerVerticalFilter3(a, filter);
+  return WienerVerticalFilter1(a[0]);
+}
+
+// Filters |num_rows| (1 or 2) rows of 32 pixels, or 16 pixels in the tail
+// case.
+template <int taps, bool kTail>
+inline void WienerVerticalKernel(const int16_t* const wiener_buffer,
+                                 const ptrdiff_t wiener_stride,
+                                 const __m512i* const filter,
+                                 const int num_rows, uint16_t* const dst,
+                                 const ptrdiff_t dst_stride) {
+  __m512i a[taps + 1];
+  for (int i = 0; i < taps + num_rows - 1; ++i) {
+    a[i] = WienerLoad<kTail>(wiener_buffer + i * wiener_stride);
+  }
+  for (int i = 0; i < num_rows; ++i) {
+    WienerStore<kTail>(dst + i * dst_stride,
+                       WienerVerticalFilter(a + i, filter, taps));
+  }
+}
+
+template <int taps>
+inline void WienerVertical(const int16_t* wiener_buffer, const ptrdiff_t width,
+                           const int height, const __m512i* const filter,
+                           uint16_t* dst, const ptrdiff_t dst_stride) {
+  for (int y = 0; y < height; y += 2) {
+    const int num_rows = std::min(height - y, 2);
+    ptrdiff_t x = 0;
+    for (; x + 32 <= width; x += 32) {
+      WienerVerticalKernel<taps, /*kTail=*/false>(
+          wiener_buffer + x, width, filter, num_rows, dst + x, dst_stride);
+    }
+    if (x < width) {
+      WienerVerticalKernel<taps, /*kTail=*/true>(
+          wiener_buffer + x, width, filter, num_rows, dst + x, dst_stride);
+    }
+    dst += 2 * dst_stride;
+    wiener_buffer += 2 * width;
+  }
+}
+
+void WienerFilter_AVX512(
+    const RestorationUnitInfo& LIBGAV1_RESTRICT restoration_info,
+    const void* LIBGAV1_RESTRICT const source, const ptrdiff_t stride,
+    const void* LIBGAV1_RESTRICT const top_border,
+    const ptrdiff_t top_border_stride,
+    const void* LIBGAV1_RESTRICT const bottom_border,
+    const ptrdiff_t bottom_border_stride, const int width, const int height,
+    RestorationBuffer* LIBGAV1_RESTRICT const restoration_buffer,
+    void* LIBGAV1_RESTRICT const dest) {
+  const int16_t* const number_leading_zero_coefficients =
+      restoration_info.wiener_info.number_leading_zero_coefficients;
+  const int number_rows_to_skip = std::max(
+      static_cast<int>(number_leading_zero_coefficients[WienerInfo::kVertical]),
+      1);
+  const ptrdiff_t wiener_stride = Align(width, 16);
+  int16_t* const wiener_buffer_vertical = restoration_buffer->wiener_buffer;
+  // The values are saturated to 13 bits before storing.
+  int16_t* wiener_buffer_horizontal =
+      wiener_buffer_vertical + number_rows_to_skip * wiener_stride;
+
+  // horizontal filtering.
+  // Over-reads up to 15 - |kRestorationHorizontalBorder| values.
+  const int height_horizontal =
+      height + kWienerFilterTaps - 1 - 2 * number_rows_to_skip;
+  const int height_extra = (height_horizontal - height) >> 1;
+  assert(height_extra <= 2);
+  const auto* const src = static_cast<const uint16_t*>(source);
+  const auto* const top = static_cast<const uint16_t*>(top_border);
+  const auto* const bottom = static_cast<const uint16_t*>(bottom_border);
+  const int16_t* const filter_horizontal =
+      restoration_info.wiener_info.filter[WienerInfo::kHorizontal];
+  const int horizontal_zeros =
+      number_leading_zero_coefficients[WienerInfo::kHorizontal];
+  const uint16_t* const top_start =
+      top + (2 - height_extra) * top_border_stride - 3 + horizontal_zeros;
+  const uint16_t* const src_start = src - 3 + horizontal_zeros;
+  const uint16_t* const bottom_start = bottom - 3 + horizontal_zeros;
+  if (horizontal_zeros == 0) {
+    __m512i filter[2];
+    filter[0] = PairCoefficients(filter_horizontal[0], filter_horizontal[1]);
+    filter[1] = PairCoefficients(filter_horizontal[2], filter_horizontal[3]);
+    WienerHorizontal<7>(top_start, top_border_stride, wiener_stride,
+                        height_extra, filter, &wiener_buffer_horizontal);
+    WienerHorizontal<7>(src_start, stride, wiener_stride, height, filter,
+                        &wiener_buffer_horizontal);
+    WienerHorizontal<7>(bottom_start, bottom_border_stride, wiener_stride,
+                        height_extra, filter, &wiener_buffer_horizontal);
+  } else if (horizontal_zeros == 1) {
+    const __m512i filter =
+        PairCoefficients(filter_horizontal[1], filter_horizontal[2]);
+    WienerHorizontal<5>(top_start, top_border_stride, wiener_stride,
+                        height_extra, &filter, &wiener_buffer_horizontal);
+    WienerHorizontal<5>(src_start, stride, wiener_stride, height, &filter,
+                        &wiener_buffer_horizontal);
+    WienerHorizontal<5>(bottom_start, bottom_border_stride, wiener_stride,
+                        height_extra, &filter, &wiener_buffer_horizontal);
+  } else if (horizontal_zeros == 2) {
+    // The maximum over-reads happen here.
+    const __m512i filter =
+        PairCoefficients(filter_horizontal[2], filter_horizontal[3]);
+    WienerHorizontal<3>(top_start, top_border_stride, wiener_stride,
+                        height_extra, &filter, &wiener_buffer_horizontal);
+    WienerHorizontal<3>(src_start, stride, wiener_stride, height, &filter,
+                        &wiener_buffer_horizontal);
+    WienerHorizontal<3>(bottom_start, bottom_border_stride, wiener_stride,
+                        height_extra, &filter, &wiener_buffer_horizontal);
+  } else {
+    assert(horizontal_zeros == 3);
+    WienerHorizontal<1>(top_start, top_border_stride, wiener_stride,
+                        height_extra, nullptr, &wiener_buffer_horizontal);
+    WienerHorizontal<1>(src_start, stride, wiener_stride, height, nullptr,
+                        &wiener_buffer_horizontal);
+    WienerHorizontal<1>(bottom_start, bottom_border_stride, wiener_stride,
+                        height_extra, nullptr, &wiener_buffer_horizontal);
+  }
+
+  // vertical filtering.
+  // Over-writes up to 15 values.
+  const int16_t* const filter_vertical =
+      restoration_info.wiener_info.filter[WienerInfo::kVertical];
+  auto* dst = static_cast<uint16_t*>(dest);
+  if (number_leading_zero_coefficients[WienerInfo::kVertical] == 0) {
+    // Because the top row of |source| is a duplicate of the second row, and the
+    // bottom row of |source| is a duplicate of its above row, we can duplicate
+    // the top and bottom row of |wiener_buffer| accordingly.
+    memcpy(wiener_buffer_horizontal, wiener_buffer_horizontal - wiener_stride,
+           sizeof(*wiener_buffer_horizontal) * wiener_stride);
+    memcpy(restoration_buffer->wiener_buffer,
+           restoration_buffer->wiener_buffer + wiener_stride,
+           sizeof(*restoration_buffer->wiener_buffer) * wiener_stride);
+    __m512i filter[4];
+    filter[0] = PairCoefficients(filter_vertical[0], filter_vertical[1]);
+    filter[1] = PairCoefficients(filter_vertical[2], filter_vertical[3]);
+    filter[2] = PairCoefficients(filter_vertical[2], filter_vertical[1]);
+    filter[3] = PairCoefficients(filter_vertical[0], 1);
+    WienerVertical<7>(wiener_buffer_vertical, wiener_stride, height, filter,
+                      dst, stride);
+  } else if (number_leading_zero_coefficients[WienerInfo::kVertical] == 1) {
+    __m512i filter[3];
+    filter[0] = PairCoefficients(filter_vertical[1], filter_vertical[2]);
+    filter[1] = PairCoefficients(filter_vertical[3], filter_vertical[2]);
+    filter[2] = PairCoefficients(filter_vertical[1], 1);
+    WienerVertical<5>(wiener_buffer_vertical + wiener_stride, wiener_stride,
+                      height, filter, dst, stride);
+  } else if (number_leading_zero_coefficients[WienerInfo::kVertical] == 2) {
+    __m512i filter[2];
+    filter[0] = PairCoefficients(filter_vertical[2], filter_vertical[3]);
+    filter[1] = PairCoefficients(filter_vertical[2], 1);
+    WienerVertical<3>(wiener_buffer_vertical + 2 * wiener_stride,
+                      wiener_stride, height, filter, dst, stride);
+  } else {
+    assert(number_leading_zero_coefficients[WienerInfo::kVertical] == 3);
+    WienerVertical<1>(wiener_buffer_vertical + 3 * wiener_stride,
+                      wiener_stride, height, nullptr, dst, stride);
+  }
+}
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_10BPP_AVX512(WienerFilter)
+  dsp->loop_restorations[0] = WienerFilter_AVX512;
+#endif
+}
+
+}  // namespace
+
+void LoopRestorationInit10bpp_AVX512() { Init10bpp(); }
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !(LIBGAV1_TARGETING_AVX512 && LIBGAV1_MAX_BITDEPTH >= 10)
+namespace libgav1 {
+namespace dsp {
+
+void LoopRestorationInit10bpp_AVX512() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX512 && LIBGAV1_MAX_BITDEPTH >= 10
@@ -0,0 +1,509 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/loop_restoration.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX512
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "src/dsp/common.h"
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx512.h"
+#include "src/utils/common.h"
+#include "src/utils/constants.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace low_bitdepth {
+namespace {
+
+// The Wiener filter follows WienerFilter_AVX2() closely. The intermediate
+// buffer keeps the same stride (a multiple of 32) and, within each 32 pixel
+// chunk, the same interleaved layout, so the main loops work on 64 pixels and a
+// trailing 32 pixel chunk is handled with the upper half of the registers
+// masked off. |kTail| selects the latter.
+
+constexpr __mmask64 kTailLoadMask = 0xffffffffffULL;  // 40 bytes.
+
+// In the tail case only the lower half of |d| is stored.
+inline void WienerHorizontalStore(int16_t* const wiener_buffer, const __m512i d,
+                                  const bool tail) {
+  if (tail) {
+    StoreUnaligned32(wiener_buffer, _mm512_castsi512_si256(d));
+  } else {
+    StoreUnaligned64(wiener_buffer, d);
+  }
+}
+
+inline void WienerHorizontalClip(const __m512i s[2], const __m512i s_3x128,
+                                 int16_t* const wiener_buffer,
+                                 const ptrdiff_t offset, const bool tail) {
+  constexpr int offset_bits =
+      1 << (8 + kWienerFilterBits - kInterRoundBitsHorizontal - 1);
+  constexpr int limit =
+      (1 << (8 + 1 + kWienerFilterBits - kInterRoundBitsHorizontal)) - 1;
+  const __m512i offsets = _mm512_set1_epi16(-offset_bits);
+  const __m512i limits = _mm512_set1_epi16(limit - offset_bits);
+  const __m512i round = _mm512_set1_epi16(1 << (kInterRoundBitsHorizontal - 1));
+  // The sum range here is [-128 * 255, 90 * 255].
+  const __m512i madd = _mm512_add_epi16(s[0], s[1]);
+  const __m512i sum = _mm512_add_epi16(madd, round);
+  const __m512i rounded_sum0 =
+      _mm512_srai_epi16(sum, kInterRoundBitsHorizontal);
+  // Add back scaled down offset correction.
+  const __m512i rounded_sum1 = _mm512_add_epi16(rounded_sum0, s_3x128);
+  const __m512i d0 = _mm512_max_epi16(rounded_sum1, offsets);
+  const __m512i d1 = _mm512_min_epi16(d0, limits);
+  WienerHorizontalStore(wiener_buffer + offset, d1, tail);
+}
+
+inline void WienerHorizontalTap7Kernel(const __m512i s[2],
+                                       const __m512i filter[4],
+                                       int16_t* const wiener_buffer,
+                                       const ptrdiff_t offset,
+                                       const bool tail) {
+  const auto s01 = _mm512_alignr_epi8(s[1], s[0], 1);
+  const auto s23 = _mm512_alignr_epi8(s[1], s[0], 5);
+  const auto s45 = _mm512_alignr_epi8(s[1], s[0], 9);
+  const auto s67 = _mm512_alignr_epi8(s[1], s[0], 13);
+  __m512i madds[4];
+  madds[0] = _mm512_maddubs_epi16(s01, filter[0]);
+  madds[1] = _mm512_maddubs_epi16(s23, filter[1]);
+  madds[2] = _mm512_maddubs_epi16(s45, filter[2]);
+  madds[3] = _mm512_maddubs_epi16(s67, filter[3]);
+  madds[0] = _mm512_add_epi16(madds[0], madds[2]);
+  madds[1] = _mm512_add_epi16(madds[1], madds[3]);
+  const __m512i s_3x128 = _mm512_slli_epi16(_mm512_srli_epi16(s23, 8),
+                                            7 - kInterRoundBitsHorizontal);
+  WienerHorizontalClip(madds, s_3x128, wiener_buffer, offset, tail);
+}
+
+inline void WienerHorizontalTap5Kernel(const __m512i s[2],
+                                       const __m512i filter[3],
+                                       int16_t* const wiener_buffer,
+                                       const ptrdiff_t offset,
+                                       const bool tail) {
+  const auto s01 = _mm512_alignr_epi8(s[1], s[0], 1);
+  const auto s23 = _mm512_alignr_epi8(s[1], s[0], 5);
+  const auto s45 = _mm512_alignr_epi8(s[1], s[0], 9);
+  __m512i madds[3];
+  madds[0] = _mm512_maddubs_epi16(s01, filter[0]);
+  madds[1] = _mm512_maddubs_epi16(s23, filter[1]);
+  madds[2] = _mm512_maddubs_epi16(s45, filter[2]);
+  madds[0] = _mm512_add_epi16(madds[0], madds[2]);
+  const __m512i s_3x128 = _mm512_srli_epi16(_mm512_slli_epi16(s23, 8),
+                                            kInterRoundBitsHorizontal + 1);
+  WienerHorizontalClip(madds, s_3x128, wiener_buffer, offset, tail);
+}
+
+inline void WienerHorizontalTap3Kernel(const __m512i s[2],
+                                       const __m512i filter[2],
+                                       int16_t* const wiener_buffer,
+                                       const ptrdiff_t offset,
+                                       const bool tail) {
+  const auto s01 = _mm512_alignr_epi8(s[1], s[0], 1);
+  const auto s23 = _mm512_alignr_epi8(s[1], s[0], 5);
+  __m512i madds[2];
+  madds[0] = _mm512_maddubs_epi16(s01, filter[0]);
+  madds[1] = _mm512_maddubs_epi16(s23, filter[1]);
+  const __m512i s_3x128 = _mm512_slli_epi16(_mm512_srli_epi16(s01, 8),
+                                            7 - kInterRoundBitsHorizontal);
+  WienerHorizontalClip(madds, s_3x128, wiener_buffer, offset, tail);
+}
+
+// Prepares the duplicated source vectors of WienerHorizontalTap7() in
+// loop_restoration_avx2.cc for 64 pixels starting at |src|. |ss[2]| is |ss[0]|
+// shifted by one lane. In the tail case only 40 bytes are read, lane 2 of |s|
+// then holds bytes 32 to 39, and the upper 2 lanes of the results are
+// meaningless.
+template <bool kTail>
+inline void WienerHorizontalLoad(const uint8_t* const src, __m512i ss[3]) {
+  __m512i s, next;
+  if (kTail) {
+    s = _mm512_maskz_loadu_epi8(kTailLoadMask, src);
+    next = _mm512_setzero_si512();
+  } else {
+    s = LoadUnaligned64(src);
+    next = _mm512_castsi128_si512(LoadLo8(src + 64));
+  }
+  ss[0] = _mm512_unpacklo_epi8(s, s);
+  ss[1] = _mm512_unpackhi_epi8(s, s);
+  ss[2] = _mm512_alignr_epi64(_mm512_unpacklo_epi8(next, next), ss[0], 2);
+}
+
+template <int taps>
+inline void WienerHorizontalKernel(const __m512i ss[3], const __m512i* filter,
+                                   int16_t* const wiener_buffer,
+                                   const bool tail) {
+  // In the tail case |wiener_buffer| + 16 receives the second half, matching
+  // the layout of a 32 pixel chunk in the AVX2 version.
+  const ptrdiff_t offset = tail ? 16 : 32;
+  if (taps == 1) {
+    // The duplicated bytes in |ss| hold the zero extended pixels after a shift.
+    WienerHorizontalStore(
+        wiener_buffer, _mm512_slli_epi16(_mm512_srli_epi16(ss[0], 8), 4), tail);
+    WienerHorizontalStore(
+        wiener_buffer + offset,
+        _mm512_slli_epi16(_mm512_srli_epi16(ss[1], 8), 4), tail);
+  } else if (taps == 7) {
+    WienerHorizontalTap7Kernel(ss + 0, filter, wiener_buffer, 0, tail);
+    WienerHorizontalTap7Kernel(ss + 1, filter, wiener_buffer, offset, tail);
+  } else if (taps == 5) {
+    WienerHorizontalTap5Kernel(ss + 0, filter, wiener_buffer, 0, tail);
+    WienerHorizontalTap5Kernel(ss + 1, filter, wiener_buffer, offset, tail);
+  } else {
+    WienerHorizontalTap3Kernel(ss + 0, filter, wiener_buffer, 0, tail);
+    WienerHorizontalTap3Kernel(ss + 1, filter, wiener_buffer, offset, tail);
+  }
+}
+
+template <int taps>
+inline void WienerHorizontal(const uint8_t* src, const ptrdiff_t src_stride,
+                             const ptrdiff_t width, const int height,
+                             const __m512i* filter,
+                             int16_t** const wiener_buffer) {
+  for (int y = height; y != 0; --y) {
+    ptrdiff_t x = 0;
+    for (; x + 64 <= width; x += 64) {
+      __m512i ss[3];
+      WienerHorizontalLoad</*kTail=*/false>(src + x, ss);
+      WienerHorizontalKernel<taps>(ss, filter, *wiener_buffer + x,
+                                   /*tail=*/false);
+    }
+    if (x < width) {
+      __m512i ss[3];
+      WienerHorizontalLoad</*kTail=*/true>(src + x, ss);
+      WienerHorizontalKernel<taps>(ss, filter, *wiener_buffer + x,
+                                   /*tail=*/true);
+    }
+    src += src_stride;
+    *wiener_buffer += width;
+  }
+}
+
+inline __m512i WienerVertical7(const __m512i a[2], const __m512i filter[2]) {
+  const __m512i round = _mm512_set1_epi32(1 << (kInterRoundBitsVertical - 1));
+  const __m512i madd0 = _mm512_madd_epi16(a[0], filter[0]);
+  const __m512i madd1 = _mm512_madd_epi16(a[1], filter[1]);
+  const __m512i sum0 = _mm512_add_epi32(round, madd0);
+  const __m512i sum1 = _mm512_add_epi32(sum0, madd1);
+  return _mm512_srai_epi32(sum1, kInterRoundBitsVertical);
+}
+
+inline __m512i WienerVertical5(const __m512i a[2], const __m512i filter[2]) {
+  const __m512i madd0 = _mm512_madd_epi16(a[0], filter[0]);
+  const __m512i madd1 = _mm512_madd_epi16(a[1], filter[1]);
+  const __m512i sum = _mm512_add_epi32(madd0, madd1);
+  return _mm512_srai_epi32(sum, kInterRoundBitsVertical);
+}
+
+inline __m512i WienerVertical3(const __m512i a, const __m512i filter) {
+  const __m512i round = _mm512_set1_epi32(1 << (kInterRoundBitsVertical - 1));
+  const __m512i madd = _mm512_madd_epi16(a, filter);
+  const __m512i sum = _mm512_add_epi32(round, madd);
+  return _mm512_srai_epi32(sum, kInterRoundBitsVertical);
+}
+
+inline __m512i WienerVerticalFilter7(const __m512i a[7],
+                                     const __m512i filter[2]) {
+  __m512i b[2];
+  const __m512i a06 = _mm512_add_epi16(a[0], a[6]);
+  const __m512i a15 = _mm512_add_epi16(a[1], a[5]);
+  const __m512i a24 = _mm512_add_epi16(a[2], a[4]);
+  b[0] = _mm512_unpacklo_epi16(a06, a15);
+  b[1] = _mm512_unpacklo_epi16(a24, a[3]);
+  const __m512i sum0 = WienerVertical7(b, filter);
+  b[0] = _mm512_unpackhi_epi16(a06, a15);
+  b[1] = _mm512_unpackhi_epi16(a24, a[3]);
+  const __m512i sum1 = WienerVertical7(b, filter);
+  return _mm512_packs_epi32(sum0, sum1);
+}
+
+inline __m512i WienerVerticalFilter5(const __m512i a[5],
+                                     const __m512i filter[2]) {
+  const __m512i round = _mm512_set1_epi16(1 << (kInterRoundBitsVertical - 1));
+  __m512i b[2];
+  const __m512i a04 = _mm512_add_epi16(a[0], a[4]);
+  const __m512i a13 = _mm512_add_epi16(a[1], a[3]);
+  b[0] = _mm512_unpacklo_epi16(a04, a13);
+  b[1] = _mm512_unpacklo_epi16(a[2], round);
+  const __m512i sum0 = WienerVertical5(b, filter);
+  b[0] = _mm512_unpackhi_epi16(a04, a13);
+  b[1] = _mm512_unpackhi_epi16(a[2], round);
+  const __m512i sum1 = WienerVertical5(b, filter);
+  return _mm512_packs_epi32(sum0, sum1);
+}
+
+inline __m512i WienerVerticalFilter3(const __m512i a[3],
+                                     const __m512i filter[1]) {
+  __m512i b;
+  const __m512i a02 = _mm512_add_epi16(a[0], a[2]);
+  b = _mm512_unpacklo_epi16(a02, a[1]);
+  const __m512i sum0 = WienerVertical3(b, filter[0]);
+  b = _mm512_unpackhi_epi16(a02, a[1]);
+  const __m512i sum1 = WienerVertical3(b, filter[0]);
+  return _mm512_packs_epi32(sum0, sum1);
+}
+
+inline __m512i WienerVerticalFilter(const __m512i* a, const __m512i* filter,
+                                    const int taps) {
+  if (taps == 1) {
+    return _mm512_srai_epi16(_mm512_add_epi16(a[0], _mm512_set1_epi16(8)), 4);
+  }
+  if (taps == 7) return WienerVerticalFilter7(a, filter);
+  if (taps == 5) return WienerVerticalFilter5(a, filter);
+  return WienerVerticalFilter3(a, filter);
+}
+
+// Loads 32 values, or 16 values in the tail case. The upper half is left
+// undefined rather than using a masked load, which would not benefit from store
+// forwarding of the horizontal pass results.
+template <bool kTail>
+inline __m512i WienerVerticalLoad(const int16_t* const wiener_buffer) {
+  if (kTail) return _mm512_castsi256_si512(LoadUnaligned32(wiener_buffer));
+  return LoadUnaligned64(wiener_buffer);
+}
+
+template <bool kTail>
+inline void WienerVerticalStore(uint8_t* const dst, const __m512i d0,
+                                const __m512i d1) {
+  const __m512i d = _mm512_packus_epi16(d0, d1);
+  if (kTail) {
+    StoreUnaligned32(dst, _mm512_castsi512_si256(d));
+  } else {
+    StoreUnaligned64(dst, d);
+  }
+}
+
+// Filters |num_rows| (1 or 2) rows of 64 pixels, or 32 pixels in the tail
+// case.
+template <int taps, bool kTail>
+inline void WienerVerticalKernel(const int16_t* const wiener_buffer,
+                                 const ptrdiff_t wiener_stride,
+                                 const __m512i* filter, const int num_rows,
+                                 uint8_t* const dst,
+                                 const ptrdiff_t dst_stride) {
+  constexpr ptrdiff_t kHalf = kTail ? 16 : 32;
+  __m512i a[2][taps + 1];
+  for (int i = 0; i < taps + num_rows - 1; ++i) {
+    a[0][i] = WienerVerticalLoad<kTail>(wiener_buffer + i * wiener_stride);
+    a[1][i] =
+        WienerVerticalLoad<kTail>(wiener_buffer + i * wiener_stride + kHalf);
+  }
+  for (int i = 0; i < num_rows; ++i) {
+    const __m512i d0 = WienerVerticalFilter(a[0] + i, filter, taps);
+    const __m512i d1 = WienerVerticalFilter(a[1] + i, filter, taps);
+    WienerVerticalStore<kTail>(dst + i * dst_stride, d0, d1);
+  }
+}
+
+template <int taps>
+inline void WienerVertical(const int16_t* wiener_buffer, const ptrdiff_t width,
+                           const int height, const __m512i* filter,
+                           uint8_t* dst, const ptrdiff_t dst_stride) {
+  for (int y = 0; y < height; y += 2) {
+    const int num_rows = std::min(height - y, 2);
+    ptrdiff_t x = 0;
+    for (; x + 64 <= width; x += 64) {
+      WienerVerticalKernel<taps, /*kTail=*/false>(
+          wiener_buffer + x, width, filter, num_rows, dst + x, dst_stride);
+    }
+    if (x < width) {
+      WienerVerticalKernel<taps, /*kTail=*/true>(
+          wiener_buffer + x, width, filter, num_rows, dst + x, dst_stride);
+    }
+    dst += 2 * dst_stride;
+    wiener_buffer += 2 * width;
+  }
+}
+
+inline __m512i PairCoefficients(const int16_t lo, const int16_t hi) {
+  return _mm512_set1_epi32(static_cast<int32_t>(
+      (static_cast<uint32_t>(static_cast<uint16_t>(hi)) << 16) |
+      static_cast<uint16_t>(lo)));
+}
+
+void WienerFilter_AVX512(
+    const RestorationUnitInfo& LIBGAV1_RESTRICT restoration_info,
+    const void* LIBGAV1_RESTRICT const source, const ptrdiff_t stride,
+    const void* LIBGAV1_RESTRICT const top_border,
+    const ptrdiff_t top_border_stride,
+    const void* LIBGAV1_RESTRICT const bottom_border,
+    const ptrdiff_t bottom_border_stride, const int width, const int height,
+    RestorationBuffer* LIBGAV1_RESTRICT const restoration_buffer,
+    void* LIBGAV1_RESTRICT const dest) {
+  const int16_t* const number_leading_zero_coefficients =
+      restoration_info.wiener_info.number_leading_zero_coefficients;
+  const int number_rows_to_skip = std::max(
+      static_cast<int>(number_leading_zero_coefficients[WienerInfo::kVertical]),
+      1);
+  const ptrdiff_t wiener_stride = Align(width, 32);
+  int16_t* const wiener_buffer_vertical = restoration_buffer->wiener_buffer;
+  // The values are saturated to 13 bits before storing.
+  int16_t* wiener_buffer_horizontal =
+      wiener_buffer_vertical + number_rows_to_skip * wiener_stride;
+
+  // horizontal filtering.
+  const int height_horizontal =
+      height + kWienerFilterTaps - 1 - 2 * number_rows_to_skip;
+  const int height_extra = (height_horizontal - height) >> 1;
+  assert(height_extra <= 2);
+  const auto* const src = static_cast<const uint8_t*>(source);
+  const auto* const top = static_cast<const uint8_t*>(top_border);
+  const auto* const bottom = static_cast<const uint8_t*>(bottom_border);
+  const __m128i c =
+      LoadLo8(restoration_info.wiener_info.filter[WienerInfo::kHorizontal]);
+  // In order to keep the horizontal pass intermediate values within 16 bits we
+  // offset |filter[3]| by 128. The 128 offset will be added back in the loop.
+  __m128i c_horizontal =
+      _mm_sub_epi16(c, _mm_setr_epi16(0, 0, 0, 128, 0, 0, 0, 0));
+  c_horizontal = _mm_packs_epi16(c_horizontal, c_horizontal);
+  const __m512i coefficients_horizontal = _mm512_broadcastd_epi32(c_horizontal);
+  const int horizontal_zeros =
+      number_leading_zero_coefficients[WienerInfo::kHorizontal];
+  const uint8_t* const top_start =
+      top + (2 - height_extra) * top_border_stride - 3 + horizontal_zeros;
+  const uint8_t* const src_start = src - 3 + horizontal_zeros;
+  const uint8_t* const bottom_start = bottom - 3 + horizontal_zeros;
+  if (horizontal_zeros == 0) {
+    __m512i filter[4];
+    filter[0] = _mm512_shuffle_epi8(coefficients_horizontal,
+                                    _mm512_set1_epi16(0x0100));
+    filter[1] = _mm512_shuffle_epi8(coefficients_horizontal,
+                                    _mm512_set1_epi16(0x0302));
+    filter[2] = _mm512_shuffle_epi8(coefficients_horizontal,
+                                    _mm512_set1_epi16(0x0102));
+    filter[3] = _mm512_shuffle_epi8(
+        coefficients_horizontal,
+        _mm512_set1_epi16(static_cast<int16_t>(0x8000)));
+    WienerHorizontal<7>(top_start, top_border_stride, wiener_stride,
+                        height_extra, filter, &wiener_buffer_horizontal);
+    WienerHorizontal<7>(src_start, stride, wiener_stride, height, filter,
+                        &wiener_buffer_horizontal);
+    WienerHorizontal<7>(bottom_start, bottom_border_stride, wiener_stride,
+                        height_extra, filter, &wiener_buffer_horizontal);
+  } else if (horizontal_zeros == 1) {
+    __m512i filter[3];
+    filter[0] = _mm512_shuffle_epi8(coefficients_horizontal,
+                                    _mm512_set1_epi16(0x0201));
+    filter[1] = _mm512_shuffle_epi8(coefficients_horizontal,
+                                    _mm512_set1_epi16(0x0203));
+    filter[2] = _mm512_shuffle_epi8(
+        coefficients_horizontal,
+        _mm512_set1_epi16(static_cast<int16_t>(0x8001)));
+    WienerHorizontal<5>(top_start, top_border_stride, wiener_stride,
+                        height_extra, filter, &wiener_buffer_horizontal);
+    WienerHorizontal<5>(src_start, stride, wiener_stride, height, filter,
+                        &wiener_buffer_horizontal);
+    WienerHorizontal<5>(bottom_start, bottom_border_stride, wiener_stride,
+                        height_extra, filter, &wiener_buffer_horizontal);
+  } else if (horizontal_zeros == 2) {
+    __m512i filter[2];
+    filter[0] = _mm512_shuffle_epi8(coefficients_horizontal,
+                                    _mm512_set1_epi16(0x0302));
+    filter[1] = _mm512_shuffle_epi8(
+        coefficients_horizontal,
+        _mm512_set1_epi16(static_cast<int16_t>(0x8002)));
+    WienerHorizontal<3>(top_start, top_border_stride, wiener_stride,
+                        height_extra, filter, &wiener_buffer_horizontal);
+    WienerHorizontal<3>(src_start, stride, wiener_stride, height, filter,
+                        &wiener_buffer_horizontal);
+    WienerHorizontal<3>(bottom_start, bottom_border_stride, wiener_stride,
+                        height_extra, filter, &wiener_buffer_horizontal);
+  } else {
+    assert(horizontal_zeros == 3);
+    WienerHorizontal<1>(top_start, top_border_stride, wiener_stride,
+                        height_extra, nullptr, &wiener_buffer_horizontal);
+    WienerHorizontal<1>(src_start, stride, wiener_stride, height, nullptr,
+                        &wiener_buffer_horizontal);
+    WienerHorizontal<1>(bottom_start, bottom_border_stride, wiener_stride,
+                        height_extra, nullptr, &wiener_buffer_horizontal);
+  }
+
+  // vertical filtering.
+  // Over-writes up to 15 values.
+  const int16_t* const filter_vertical =
+      restoration_info.wiener_info.filter[WienerInfo::kVertical];
+  auto* dst = static_cast<uint8_t*>(dest);
+  if (number_leading_zero_coefficients[WienerInfo::kVertical] == 0) {
+    // Because the top row of |source| is a duplicate of the second row, and the
+    // bottom row of |source| is a duplicate of its above row, we can duplicate
+    // the top and bottom row of |wiener_buffer| accordingly.
+    memcpy(wiener_buffer_horizontal, wiener_buffer_horizontal - wiener_stride,
+           sizeof(*wiener_buffer_horizontal) * wiener_stride);
+    memcpy(restoration_buffer->wiener_buffer,
+           restoration_buffer->wiener_buffer + wiener_stride,
+           sizeof(*restoration_buffer->wiener_buffer) * wiener_stride);
+    __m512i filter[2];
+    filter[0] = PairCoefficients(filter_vertical[0], filter_vertical[1]);
+    filter[1] = PairCoefficients(filter_vertical[2], filter_vertical[3]);
+    WienerVertical<7>(wiener_buffer_vertical, wiener_stride, height, filter,
+                      dst, stride);
+  } else if (number_leading_zero_coefficients[WienerInfo::kVertical] == 1) {
+    __m512i filter[2];
+    filter[0] = PairCoefficients(filter_vertical[1], filter_vertical[2]);
+    filter[1] = PairCoefficients(filter_vertical[3], 1);
+    WienerVertical<5>(wiener_buffer_vertical + wiener_stride, wiener_stride,
+                      height, filter, dst, stride);
+  } else if (number_leading_zero_coefficients[WienerInfo::kVertical] == 2) {
+    const __m512i filter =
+        PairCoefficients(filter_vertical[2], filter_vertical[3]);
+    WienerVertical<3>(wiener_buffer_vertical + 2 * wiener_stride,
+                      wiener_stride, height, &filter, dst, stride);
+  } else {
+    assert(number_leading_zero_coefficients[WienerInfo::kVertical] == 3);
+    WienerVertical<1>(wiener_buffer_vertical + 3 * wiener_stride,
+                      wiener_stride, height, nullptr, dst, stride);
+  }
+}
+
+//------------------------------------------------------------------------------
+// SGR
+
+#include "src/dsp/x86/loop_restoration_avx512.inc"
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_8BPP_AVX512(WienerFilter)
+  dsp->loop_restorations[0] = WienerFilter_AVX512;
+#endif
+#if DSP_ENABLED_8BPP_AVX512(SelfGuidedFilter)
+  dsp->loop_restorations[1] = SelfGuidedFilter_AVX512<8, uint8_t>;
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+void LoopRestorationInit_AVX512() { low_bitdepth::Init8bpp(); }
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !LIBGAV1_TARGETING_AVX512
+namespace libgav1 {
+namespace dsp {
+
+void LoopRestorationInit_AVX512() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX512
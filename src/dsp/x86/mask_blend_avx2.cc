@@ -0,0 +1,620 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/mask_blend.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2
+
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/utils/common.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace {
+
+constexpr int kMaskInverse = 64;
+
+// All blends work on 16 outputs at a time, one per 16-bit lane. The
+// predictions (apart from the inter-intra |prediction_1|) are stored
+// contiguously with a stride of |width|, so blocks of width 4 and 8 are
+// handled 4 and 2 rows at a time. The mask loaders below return the mask
+// values for those rows in the same order.
+
+// Sums horizontal pairs of mask values, which already include the second row
+// when |subsampling_y| is 1. The mask values are at most 64 so the row sums
+// fit in 8 bits.
+template <int subsampling_y>
+inline __m256i SubsampleMask(const __m256i mask_val) {
+  const __m256i sum = _mm256_maddubs_epi16(mask_val, _mm256_set1_epi8(1));
+  return RightShiftWithRounding_S16(sum, 1 + subsampling_y);
+}
+
+// 16 mask values from one row.
+template <int subsampling_x, int subsampling_y>
+inline __m256i GetMask16(const uint8_t* LIBGAV1_RESTRICT mask,
+                         const ptrdiff_t stride) {
+  if (subsampling_x == 1) {
+    __m256i mask_val = LoadUnaligned32(mask);
+    if (subsampling_y == 1) {
+      mask_val = _mm256_add_epi8(mask_val, LoadUnaligned32(mask + stride));
+    }
+    return SubsampleMask<subsampling_y>(mask_val);
+  }
+  assert(subsampling_y == 0);
+  return _mm256_cvtepu8_epi16(LoadUnaligned16(mask));
+}
+
+// 8 mask values from each of two rows.
+template <int subsampling_x, int subsampling_y>
+inline __m256i GetMask8x2(const uint8_t* LIBGAV1_RESTRICT mask,
+                          const ptrdiff_t stride) {
+  if (subsampling_x == 1) {
+    const ptrdiff_t row_stride = stride << subsampling_y;
+    __m256i mask_val = SetrM128i(LoadUnaligned16(mask),
+                                 LoadUnaligned16(mask + row_stride));
+    if (subsampling_y == 1) {
+      mask_val = _mm256_add_epi8(
+          mask_val, SetrM128i(LoadUnaligned16(mask + stride),
+                              LoadUnaligned16(mask + row_stride + stride)));
+    }
+    return SubsampleMask<subsampling_y>(mask_val);
+  }
+  assert(subsampling_y == 0);
+  return _mm256_cvtepu8_epi16(LoadHi8(LoadLo8(mask), mask + stride));
+}
+
+// 4 mask values from each of four rows. Width can only be 4 when it is
+// subsampled from a block of width 8, so |subsampling_x| is expected to be 1.
+template <int subsampling_x, int subsampling_y>
+inline __m256i GetMask4x4(const uint8_t* LIBGAV1_RESTRICT mask,
+                          const ptrdiff_t stride) {
+  if (subsampling_x == 1) {
+    const ptrdiff_t row_stride = stride << subsampling_y;
+    const uint8_t* const mask_2 = mask + 2 * row_stride;
+    __m256i mask_val =
+        SetrM128i(LoadHi8(LoadLo8(mask), mask + row_stride),
+                  LoadHi8(LoadLo8(mask_2), mask_2 + row_stride));
+    if (subsampling_y == 1) {
+      mask_val = _mm256_add_epi8(
+          mask_val,
+          SetrM128i(LoadHi8(LoadLo8(mask + stride), mask + row_stride + stride),
+                    LoadHi8(LoadLo8(mask_2 + stride),
+                            mask_2 + row_stride + stride)));
+    }
+    return SubsampleMask<subsampling_y>(mask_val);
+  }
+  assert(subsampling_y == 0);
+  return _mm256_cvtepu8_epi16(
+      _mm_unpacklo_epi64(Load4x2(mask, mask + stride),
+                         Load4x2(mask + 2 * stride, mask + 3 * stride)));
+}
+
+// Packs 16 results to 8 bits, preserving their order.
+inline __m128i PackResult16(const __m256i res) {
+  return _mm_packus_epi16(_mm256_castsi256_si128(res),
+                          _mm256_extracti128_si256(res, 1));
+}
+
+}  // namespace
+
+namespace low_bitdepth {
+namespace {
+
+// int res = (mask_value * prediction_0[x] +
+//      (64 - mask_value) * prediction_1[x]) >> 6;
+// dst[x] = static_cast<Pixel>(
+//     Clip3(RightShiftWithRounding(res, inter_post_round_bits), 0,
+//           (1 << kBitdepth8) - 1));
+// The final clip happens when packing to 8 bits.
+inline __m256i MaskBlend16(const int16_t* LIBGAV1_RESTRICT pred_0,
+                           const int16_t* LIBGAV1_RESTRICT pred_1,
+                           const __m256i& pred_mask_0,
+                           const __m256i& mask_inverter) {
+  const __m256i pred_mask_1 = _mm256_sub_epi16(mask_inverter, pred_mask_0);
+  const __m256i mask_lo = _mm256_unpacklo_epi16(pred_mask_0, pred_mask_1);
+  const __m256i mask_hi = _mm256_unpackhi_epi16(pred_mask_0, pred_mask_1);
+  const __m256i pred_val_0 = LoadUnaligned32(pred_0);
+  const __m256i pred_val_1 = LoadUnaligned32(pred_1);
+  const __m256i pred_lo = _mm256_unpacklo_epi16(pred_val_0, pred_val_1);
+  const __m256i pred_hi = _mm256_unpackhi_epi16(pred_val_0, pred_val_1);
+  const __m256i compound_pred_lo = _mm256_madd_epi16(pred_lo, mask_lo);
+  const __m256i compound_pred_hi = _mm256_madd_epi16(pred_hi, mask_hi);
+  const __m256i res =
+      _mm256_packs_epi32(_mm256_srai_epi32(compound_pred_lo, 6),
+                         _mm256_srai_epi32(compound_pred_hi, 6));
+  return RightShiftWithRounding_S16(res, 4);
+}
+
+template <int subsampling_x, int subsampling_y>
+void MaskBlend_AVX2(const void* LIBGAV1_RESTRICT prediction_0,
+                    const void* LIBGAV1_RESTRICT prediction_1,
+                    const ptrdiff_t /*prediction_stride_1*/,
+                    const uint8_t* LIBGAV1_RESTRICT const mask_ptr,
+                    const ptrdiff_t mask_stride, const int width,
+                    const int height, void* LIBGAV1_RESTRICT dest,
+                    const ptrdiff_t dst_stride) {
+  auto* dst = static_cast<uint8_t*>(dest);
+  const auto* pred_0 = static_cast<const int16_t*>(prediction_0);
+  const auto* pred_1 = static_cast<const int16_t*>(prediction_1);
+  const uint8_t* mask = mask_ptr;
+  const __m256i mask_inverter = _mm256_set1_epi16(kMaskInverse);
+  int y = height;
+
+  if (width == 4) {
+    do {
+      const __m256i pred_mask_0 =
+          GetMask4x4<subsampling_x, subsampling_y>(mask, mask_stride);
+      const __m128i res =
+          PackResult16(MaskBlend16(pred_0, pred_1, pred_mask_0, mask_inverter));
+      Store4(dst, res);
+      Store4(dst + dst_stride, _mm_srli_si128(res, 4));
+      Store4(dst + 2 * dst_stride, _mm_srli_si128(res, 8));
+      Store4(dst + 3 * dst_stride, _mm_srli_si128(res, 12));
+      dst += dst_stride << 2;
+      pred_0 += 16;
+      pred_1 += 16;
+      mask += mask_stride << (2 + subsampling_y);
+      y -= 4;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 8) {
+    do {
+      const __m256i pred_mask_0 =
+          GetMask8x2<subsampling_x, subsampling_y>(mask, mask_stride);
+      const __m128i res =
+          PackResult16(MaskBlend16(pred_0, pred_1, pred_mask_0, mask_inverter));
+      StoreLo8(dst, res);
+      StoreHi8(dst + dst_stride, res);
+      dst += dst_stride << 1;
+      pred_0 += 16;
+      pred_1 += 16;
+      mask += mask_stride << (1 + subsampling_y);
+      y -= 2;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 16) {
+    do {
+      const __m256i pred_mask_0 =
+          GetMask16<subsampling_x, subsampling_y>(mask, mask_stride);
+      StoreUnaligned16(dst, PackResult16(MaskBlend16(
+                                pred_0, pred_1, pred_mask_0, mask_inverter)));
+      dst += dst_stride;
+      pred_0 += 16;
+      pred_1 += 16;
+      mask += mask_stride << subsampling_y;
+    } while (--y != 0);
+    return;
+  }
+
+  do {
+    int x = 0;
+    do {
+      const __m256i pred_mask_00 = GetMask16<subsampling_x, subsampling_y>(
+          mask + (x << subsampling_x), mask_stride);
+      const __m256i pred_mask_01 = GetMask16<subsampling_x, subsampling_y>(
+          mask + ((x + 16) << subsampling_x), mask_stride);
+      const __m256i res_0 =
+          MaskBlend16(pred_0 + x, pred_1 + x, pred_mask_00, mask_inverter);
+      const __m256i res_1 = MaskBlend16(pred_0 + x + 16, pred_1 + x + 16,
+                                        pred_mask_01, mask_inverter);
+      const __m256i res = _mm256_packus_epi16(res_0, res_1);
+      StoreUnaligned32(dst + x, _mm256_permute4x64_epi64(res, 0xd8));
+      x += 32;
+    } while (x < width);
+    dst += dst_stride;
+    pred_0 += width;
+    pred_1 += width;
+    mask += mask_stride << subsampling_y;
+  } while (--y != 0);
+}
+
+// int res = (mask_value * prediction_1[x] +
+//      (64 - mask_value) * prediction_0[x]) >> 6;
+// The pixels and weights are interleaved into the bytes of each 16-bit lane
+// for _mm256_maddubs_epi16.
+inline __m128i InterIntraBlend16(const __m128i& pred_val_0,
+                                 const __m128i& pred_val_1,
+                                 const __m256i& pred_mask_1,
+                                 const __m256i& mask_inverter) {
+  const __m256i pred =
+      _mm256_or_si256(_mm256_cvtepu8_epi16(pred_val_0),
+                      _mm256_slli_epi16(_mm256_cvtepu8_epi16(pred_val_1), 8));
+  const __m256i pred_mask =
+      _mm256_or_si256(_mm256_sub_epi16(mask_inverter, pred_mask_1),
+                      _mm256_slli_epi16(pred_mask_1, 8));
+  const __m256i compound_pred = _mm256_maddubs_epi16(pred, pred_mask);
+  return PackResult16(RightShiftWithRounding_S16(compound_pred, 6));
+}
+
+template <int subsampling_x, int subsampling_y>
+void InterIntraMaskBlend8bpp_AVX2(
+    const uint8_t* LIBGAV1_RESTRICT prediction_0,
+    uint8_t* LIBGAV1_RESTRICT prediction_1, const ptrdiff_t prediction_stride_1,
+    const uint8_t* LIBGAV1_RESTRICT const mask_ptr, const ptrdiff_t mask_stride,
+    const int width, const int height) {
+  const uint8_t* mask = mask_ptr;
+  const __m256i mask_inverter = _mm256_set1_epi16(kMaskInverse);
+  int y = height;
+
+  if (width == 4) {
+    const ptrdiff_t stride = prediction_stride_1;
+    do {
+      const __m256i pred_mask_1 =
+          GetMask4x4<subsampling_x, subsampling_y>(mask, mask_stride);
+      const __m128i pred_val_0 = LoadUnaligned16(prediction_0);
+      const __m128i pred_val_1 = _mm_unpacklo_epi64(
+          Load4x2(prediction_1, prediction_1 + stride),
+          Load4x2(prediction_1 + 2 * stride, prediction_1 + 3 * stride));
+      const __m128i res = InterIntraBlend16(pred_val_0, pred_val_1,
+                                            pred_mask_1, mask_inverter);
+      Store4(prediction_1, res);
+      Store4(prediction_1 + stride, _mm_srli_si128(res, 4));
+      Store4(prediction_1 + 2 * stride, _mm_srli_si128(res, 8));
+      Store4(prediction_1 + 3 * stride, _mm_srli_si128(res, 12));
+      prediction_0 += 16;
+      prediction_1 += stride << 2;
+      mask += mask_stride << (2 + subsampling_y);
+      y -= 4;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 8) {
+    do {
+      const __m256i pred_mask_1 =
+          GetMask8x2<subsampling_x, subsampling_y>(mask, mask_stride);
+      const __m128i pred_val_0 = LoadUnaligned16(prediction_0);
+      const __m128i pred_val_1 = LoadHi8(LoadLo8(prediction_1),
+                                         prediction_1 + prediction_stride_1);
+      const __m128i res = InterIntraBlend16(pred_val_0, pred_val_1,
+                                            pred_mask_1, mask_inverter);
+      StoreLo8(prediction_1, res);
+      StoreHi8(prediction_1 + prediction_stride_1, res);
+      prediction_0 += 16;
+      prediction_1 += prediction_stride_1 << 1;
+      mask += mask_stride << (1 + subsampling_y);
+      y -= 2;
+    } while (y != 0);
+    return;
+  }
+
+  do {
+    int x = 0;
+    do {
+      const __m256i pred_mask_1 = GetMask16<subsampling_x, subsampling_y>(
+          mask + (x << subsampling_x), mask_stride);
+      const __m128i pred_val_0 = LoadUnaligned16(prediction_0 + x);
+      const __m128i pred_val_1 = LoadUnaligned16(prediction_1 + x);
+      StoreUnaligned16(prediction_1 + x,
+                       InterIntraBlend16(pred_val_0, pred_val_1, pred_mask_1,
+                                         mask_inverter));
+      x += 16;
+    } while (x < width);
+    prediction_0 += width;
+    prediction_1 += prediction_stride_1;
+    mask += mask_stride << subsampling_y;
+  } while (--y != 0);
+}
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_8BPP_AVX2(MaskBlend444)
+  dsp->mask_blend[0][0] = MaskBlend_AVX2<0, 0>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(MaskBlend422)
+  dsp->mask_blend[1][0] = MaskBlend_AVX2<1, 0>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(MaskBlend420)
+  dsp->mask_blend[2][0] = MaskBlend_AVX2<1, 1>;
+#endif
+  // The is_inter_intra index of mask_blend[][] is replaced by
+  // inter_intra_mask_blend_8bpp[] in 8-bit.
+#if DSP_ENABLED_8BPP_AVX2(InterIntraMaskBlend8bpp444)
+  dsp->inter_intra_mask_blend_8bpp[0] = InterIntraMaskBlend8bpp_AVX2<0, 0>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(InterIntraMaskBlend8bpp422)
+  dsp->inter_intra_mask_blend_8bpp[1] = InterIntraMaskBlend8bpp_AVX2<1, 0>;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(InterIntraMaskBlend8bpp420)
+  dsp->inter_intra_mask_blend_8bpp[2] = InterIntraMaskBlend8bpp_AVX2<1, 1>;
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+constexpr int kMax10bppSample = (1 << 10) - 1;
+constexpr int kRoundBitsMaskBlend = 4;
+constexpr int kSignBit = 0x8000;
+
+// 16 values from each of the 4, 2 or 1 rows of |pred| covered by one vector.
+template <int width>
+inline __m256i LoadPred16(const uint16_t* LIBGAV1_RESTRICT pred,
+                          const ptrdiff_t stride) {
+  if (width == 4) {
+    const uint16_t* const pred_2 = pred + 2 * stride;
+    return SetrM128i(LoadHi8(LoadLo8(pred), pred + stride),
+                     LoadHi8(LoadLo8(pred_2), pred_2 + stride));
+  }
+  if (width == 8) {
+    return SetrM128i(LoadUnaligned16(pred), LoadUnaligned16(pred + stride));
+  }
+  return LoadUnaligned32(pred);
+}
+
+template <int width>
+inline void StoreResult16(uint16_t* LIBGAV1_RESTRICT dst,
+                          const ptrdiff_t stride, const __m256i& res) {
+  if (width == 4) {
+    const __m128i res_lo = _mm256_castsi256_si128(res);
+    const __m128i res_hi = _mm256_extracti128_si256(res, 1);
+    StoreLo8(dst, res_lo);
+    StoreHi8(dst + stride, res_lo);
+    StoreLo8(dst + 2 * stride, res_hi);
+    StoreHi8(dst + 3 * stride, res_hi);
+    return;
+  }
+  if (width == 8) {
+    StoreUnaligned16(dst, _mm256_castsi256_si128(res));
+    StoreUnaligned16(dst + stride, _mm256_extracti128_si256(res, 1));
+    return;
+  }
+  StoreUnaligned32(dst, res);
+}
+
+template <int width, int subsampling_x, int subsampling_y>
+inline __m256i GetMaskForWidth(const uint8_t* LIBGAV1_RESTRICT mask,
+                               const ptrdiff_t stride) {
+  if (width == 4) return GetMask4x4<subsampling_x, subsampling_y>(mask, stride);
+  if (width == 8) return GetMask8x2<subsampling_x, subsampling_y>(mask, stride);
+  return GetMask16<subsampling_x, subsampling_y>(mask, stride);
+}
+
+// int res = (mask_value * pred_0[x] + (64 - mask_value) * pred_1[x]) >> 6;
+// res -= kCompoundOffset;
+// dst[x] = static_cast<Pixel>(
+//     Clip3(RightShiftWithRounding(res, inter_post_round_bits), 0,
+//           (1 << kBitdepth10) - 1));
+// The unsigned predictions are biased by -32768 so that _mm256_madd_epi16 can
+// be used. The mask weights sum to 64, so the bias is restored along with the
+// offset and rounding terms in |offset|, and both shifts are combined.
+inline __m256i MaskBlend16(const __m256i& pred_val_0, const __m256i& pred_val_1,
+                           const __m256i& pred_mask_0,
+                           const __m256i& mask_inverter,
+                           const __m256i& sign_bit, const __m256i& offset,
+                           const __m256i& max) {
+  const __m256i pred_mask_1 = _mm256_sub_epi16(mask_inverter, pred_mask_0);
+  const __m256i mask_lo = _mm256_unpacklo_epi16(pred_mask_0, pred_mask_1);
+  const __m256i mask_hi = _mm256_unpackhi_epi16(pred_mask_0, pred_mask_1);
+  const __m256i pred_0 = _mm256_xor_si256(pred_val_0, sign_bit);
+  const __m256i pred_1 = _mm256_xor_si256(pred_val_1, sign_bit);
+  const __m256i pred_lo = _mm256_unpacklo_epi16(pred_0, pred_1);
+  const __m256i pred_hi = _mm256_unpackhi_epi16(pred_0, pred_1);
+  const __m256i compound_pred_lo = _mm256_madd_epi16(pred_lo, mask_lo);
+  const __m256i compound_pred_hi = _mm256_madd_epi16(pred_hi, mask_hi);
+  const __m256i res_lo = _mm256_srai_epi32(
+      _mm256_add_epi32(compound_pred_lo, offset), 6 + kRoundBitsMaskBlend);
+  const __m256i res_hi = _mm256_srai_epi32(
+      _mm256_add_epi32(compound_pred_hi, offset), 6 + kRoundBitsMaskBlend);
+  return _mm256_min_epi16(_mm256_packus_epi32(res_lo, res_hi), max);
+}
+
+template <int width, int subsampling_x, int subsampling_y>
+inline void MaskBlend10bpp(const uint16_t* LIBGAV1_RESTRICT pred_0,
+                           const uint16_t* LIBGAV1_RESTRICT pred_1,
+                           const ptrdiff_t pred_stride_1,
+                           const uint8_t* LIBGAV1_RESTRICT mask,
+                           const ptrdiff_t mask_stride, const int block_width,
+                           const int height, uint16_t* LIBGAV1_RESTRICT dst,
+                           const ptrdiff_t dst_stride) {
+  constexpr int rows = (width == 4) ? 4 : (width == 8) ? 2 : 1;
+  const __m256i mask_inverter = _mm256_set1_epi16(kMaskInverse);
+  const __m256i sign_bit = _mm256_set1_epi16(static_cast<int16_t>(kSignBit));
+  const __m256i offset = _mm256_set1_epi32(
+      (kSignBit - kCompoundOffset + ((1 << kRoundBitsMaskBlend) >> 1)) << 6);
+  const __m256i max = _mm256_set1_epi16(kMax10bppSample);
+  int y = height;
+  do {
+    int x = 0;
+    do {
+      const __m256i pred_mask_0 =
+          GetMaskForWidth<width, subsampling_x, subsampling_y>(
+              mask + (x << subsampling_x), mask_stride);
+      const __m256i pred_val_0 = LoadUnaligned32(pred_0 + x * rows);
+      const __m256i pred_val_1 = LoadPred16<width>(pred_1 + x, pred_stride_1);
+      StoreResult16<width>(dst + x, dst_stride,
+                           MaskBlend16(pred_val_0, pred_val_1, pred_mask_0,
+                                       mask_inverter, sign_bit, offset, max));
+      x += 16;
+    } while (x < block_width);
+    dst += dst_stride * rows;
+    pred_0 += block_width * rows;
+    pred_1 += pred_stride_1 * rows;
+    mask += (mask_stride << subsampling_y) * rows;
+    y -= rows;
+  } while (y != 0);
+}
+
+template <int subsampling_x, int subsampling_y>
+void MaskBlend10bpp_AVX2(const void* LIBGAV1_RESTRICT prediction_0,
+                         const void* LIBGAV1_RESTRICT prediction_1,
+                         const ptrdiff_t prediction_stride_1,
+                         const uint8_t* LIBGAV1_RESTRICT const mask_ptr,
+                         const ptrdiff_t mask_stride, const int width,
+                         const int height, void* LIBGAV1_RESTRICT dest,
+                         const ptrdiff_t dest_stride) {
+  auto* dst = static_cast<uint16_t*>(dest);
+  const ptrdiff_t dst_stride = dest_stride / sizeof(dst[0]);
+  const auto* pred_0 = static_cast<const uint16_t*>(prediction_0);
+  const auto* pred_1 = static_cast<const uint16_t*>(prediction_1);
+  if (width == 4) {
+    MaskBlend10bpp<4, subsampling_x, subsampling_y>(
+        pred_0, pred_1, prediction_stride_1, mask_ptr, mask_stride, width,
+        height, dst, dst_stride);
+    return;
+  }
+  if (width == 8) {
+    MaskBlend10bpp<8, subsampling_x, subsampling_y>(
+        pred_0, pred_1, prediction_stride_1, mask_ptr, mask_stride, width,
+        height, dst, dst_stride);
+    return;
+  }
+  MaskBlend10bpp<16, subsampling_x, subsampling_y>(
+      pred_0, pred_1, prediction_stride_1, mask_ptr, mask_stride, width, height,
+      dst, dst_stride);
+}
+
+// dst[x] = static_cast<Pixel>(RightShiftWithRounding(
+//     mask_value * pred_1[x] + (64 - mask_value) * pred_0[x], 6));
+// Both predictions are 10-bit pixels, so the sum fits in an unsigned 16-bit
+// lane.
+inline __m256i InterIntraBlend16(const __m256i& pred_val_0,
+                                 const __m256i& pred_val_1,
+                                 const __m256i& pred_mask_1,
+                                 const __m256i& mask_inverter,
+                                 const __m256i& round) {
+  const __m256i pred_mask_0 = _mm256_sub_epi16(mask_inverter, pred_mask_1);
+  const __m256i compound_pred =
+      _mm256_add_epi16(_mm256_mullo_epi16(pred_val_1, pred_mask_1),
+                       _mm256_mullo_epi16(pred_val_0, pred_mask_0));
+  return _mm256_srli_epi16(_mm256_add_epi16(compound_pred, round), 6);
+}
+
+template <int width, int subsampling_x, int subsampling_y>
+inline void InterIntraMaskBlend10bpp(
+    const uint16_t* LIBGAV1_RESTRICT pred_0,
+    const uint16_t* LIBGAV1_RESTRICT pred_1, const ptrdiff_t pred_stride_1,
+    const uint8_t* LIBGAV1_RESTRICT mask, const ptrdiff_t mask_stride,
+    const int block_width, const int height, uint16_t* LIBGAV1_RESTRICT dst,
+    const ptrdiff_t dst_stride) {
+  constexpr int rows = (width == 4) ? 4 : (width == 8) ? 2 : 1;
+  const __m256i mask_inverter = _mm256_set1_epi16(kMaskInverse);
+  const __m256i round = _mm256_set1_epi16((1 << 6) >> 1);
+  int y = height;
+  do {
+    int x = 0;
+    do {
+      const __m256i pred_mask_1 =
+          GetMaskForWidth<width, subsampling_x, subsampling_y>(
+              mask + (x << subsampling_x), mask_stride);
+      const __m256i pred_val_0 = LoadUnaligned32(pred_0 + x * rows);
+      const __m256i pred_val_1 = LoadPred16<width>(pred_1 + x, pred_stride_1);
+      StoreResult16<width>(dst + x, dst_stride,
+                           InterIntraBlend16(pred_val_0, pred_val_1,
+                                             pred_mask_1, mask_inverter,
+                                             round));
+      x += 16;
+    } while (x < block_width);
+    dst += dst_stride * rows;
+    pred_0 += block_width * rows;
+    pred_1 += pred_stride_1 * rows;
+    mask += (mask_stride << subsampling_y) * rows;
+    y -= rows;
+  } while (y != 0);
+}
+
+template <int subsampling_x, int subsampling_y>
+void InterIntraMaskBlend10bpp_AVX2(
+    const void* LIBGAV1_RESTRICT prediction_0,
+    const void* LIBGAV1_RESTRICT prediction_1,
+    const ptrdiff_t prediction_stride_1,
+    const uint8_t* LIBGAV1_RESTRICT const mask_ptr, const ptrdiff_t mask_stride,
+    const int width, const int height, void* LIBGAV1_RESTRICT dest,
+    const ptrdiff_t dest_stride) {
+  auto* dst = static_cast<uint16_t*>(dest);
+  const ptrdiff_t dst_stride = dest_stride / sizeof(dst[0]);
+  const auto* pred_0 = static_cast<const uint16_t*>(prediction_0);
+  const auto* pred_1 = static_cast<const uint16_t*>(prediction_1);
+  if (width == 4) {
+    InterIntraMaskBlend10bpp<4, subsampling_x, subsampling_y>(
+        pred_0, pred_1, prediction_stride_1, mask_ptr, mask_stride, width,
+        height, dst, dst_stride);
+    return;
+  }
+  if (width == 8) {
+    InterIntraMaskBlend10bpp<8, subsampling_x, subsampling_y>(
+        pred_0, pred_1, prediction_stride_1, mask_ptr, mask_stride, width,
+        height, dst, dst_stride);
+    return;
+  }
+  InterIntraMaskBlend10bpp<16, subsampling_x, subsampling_y>(
+      pred_0, pred_1, prediction_stride_1, mask_ptr, mask_stride, width, height,
+      dst, dst_stride);
+}
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_10BPP_AVX2(MaskBlend444)
+  dsp->mask_blend[0][0] = MaskBlend10bpp_AVX2<0, 0>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(MaskBlend422)
+  dsp->mask_blend[1][0] = MaskBlend10bpp_AVX2<1, 0>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(MaskBlend420)
+  dsp->mask_blend[2][0] = MaskBlend10bpp_AVX2<1, 1>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(MaskBlendInterIntra444)
+  dsp->mask_blend[0][1] = InterIntraMaskBlend10bpp_AVX2<0, 0>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(MaskBlendInterIntra422)
+  dsp->mask_blend[1][1] = InterIntraMaskBlend10bpp_AVX2<1, 0>;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(MaskBlendInterIntra420)
+  dsp->mask_blend[2][1] = InterIntraMaskBlend10bpp_AVX2<1, 1>;
+#endif
+}
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void MaskBlendInit_AVX2() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+}
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !LIBGAV1_TARGETING_AVX2
+
+namespace libgav1 {
+namespace dsp {
+
+void MaskBlendInit_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2
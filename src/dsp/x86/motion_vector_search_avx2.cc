@@ -0,0 +1,277 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/motion_vector_search.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2
+
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/utils/common.h"
+#include "src/utils/constants.h"
+#include "src/utils/types.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace {
+
+constexpr int kProjectionMvDivisionLookup_32bit[kMaxFrameDistance + 1] = {
+    0,    16384, 8192, 5461, 4096, 3276, 2730, 2340, 2048, 1820, 1638,
+    1489, 1365,  1260, 1170, 1092, 1024, 963,  910,  862,  819,  780,
+    744,  712,   682,  655,  630,  606,  585,  564,  546,  528};
+
+inline __m256i MvProjection(const __m256i mv, const __m256i denominator,
+                            const __m256i numerator) {
+  const __m256i m0 = _mm256_madd_epi16(mv, denominator);
+  const __m256i m = _mm256_mullo_epi32(m0, numerator);
+  // Add the sign (0 or -1) to round towards zero.
+  const __m256i sign = _mm256_srai_epi32(m, 31);
+  const __m256i add_sign = _mm256_add_epi32(m, sign);
+  const __m256i sum = _mm256_add_epi32(add_sign, _mm256_set1_epi32(1 << 13));
+  return _mm256_srai_epi32(sum, 14);
+}
+
+inline __m128i MvProjection(const __m128i mv, const __m128i denominator,
+                            const __m128i numerator) {
+  const __m128i m0 = _mm_madd_epi16(mv, denominator);
+  const __m128i m = _mm_mullo_epi32(m0, numerator);
+  // Add the sign (0 or -1) to round towards zero.
+  const __m128i sign = _mm_srai_epi32(m, 31);
+  const __m128i add_sign = _mm_add_epi32(m, sign);
+  const __m128i sum = _mm_add_epi32(add_sign, _mm_set1_epi32(1 << 13));
+  return _mm_srai_epi32(sum, 14);
+}
+
+inline __m256i MvProjectionClip(const __m256i mvs[2],
+                                const __m256i denominators[2],
+                                const __m256i numerator) {
+  const __m256i s0 = MvProjection(mvs[0], denominators[0], numerator);
+  const __m256i s1 = MvProjection(mvs[1], denominators[1], numerator);
+  const __m256i mv = _mm256_packs_epi32(s0, s1);
+  const __m256i projection_mv_clamp = _mm256_set1_epi16(kProjectionMvClamp);
+  const __m256i projection_mv_clamp_negative =
+      _mm256_set1_epi16(-kProjectionMvClamp);
+  const __m256i clamp = _mm256_min_epi16(mv, projection_mv_clamp);
+  return _mm256_max_epi16(clamp, projection_mv_clamp_negative);
+}
+
+inline __m128i MvProjectionClip(const __m128i mvs[2],
+                                const __m128i denominators[2],
+                                const __m128i numerator) {
+  const __m128i s0 = MvProjection(mvs[0], denominators[0], numerator);
+  const __m128i s1 = MvProjection(mvs[1], denominators[1], numerator);
+  const __m128i mv = _mm_packs_epi32(s0, s1);
+  const __m128i projection_mv_clamp = _mm_set1_epi16(kProjectionMvClamp);
+  const __m128i projection_mv_clamp_negative =
+      _mm_set1_epi16(-kProjectionMvClamp);
+  const __m128i clamp = _mm_min_epi16(mv, projection_mv_clamp);
+  return _mm_max_epi16(clamp, projection_mv_clamp_negative);
+}
+
+// Projects 4 compound candidates. Each 128-bit lane holds 2 candidates, and
+// within a lane the packing order of the two projections matches
+// CompoundMotionVector.
+inline __m256i MvProjectionCompoundClip(
+    const MotionVector* LIBGAV1_RESTRICT const temporal_mvs,
+    const int8_t* LIBGAV1_RESTRICT const temporal_reference_offsets,
+    const __m256i numerator) {
+  const auto* const tmvs = reinterpret_cast<const int32_t*>(temporal_mvs);
+  const __m256i temporal_mv = _mm256_cvtepu16_epi32(LoadUnaligned16(tmvs));
+  __m256i mvs[2], denominators[2];
+  mvs[0] = _mm256_unpacklo_epi64(temporal_mv, temporal_mv);
+  mvs[1] = _mm256_unpackhi_epi64(temporal_mv, temporal_mv);
+  const int8_t* const offsets = temporal_reference_offsets;
+  denominators[0] =
+      SetrM128i(_mm_set1_epi32(kProjectionMvDivisionLookup[offsets[0]]),
+                _mm_set1_epi32(kProjectionMvDivisionLookup[offsets[2]]));
+  denominators[1] =
+      SetrM128i(_mm_set1_epi32(kProjectionMvDivisionLookup[offsets[1]]),
+                _mm_set1_epi32(kProjectionMvDivisionLookup[offsets[3]]));
+  return MvProjectionClip(mvs, denominators, numerator);
+}
+
+// Projects 2 compound candidates.
+inline __m128i MvProjectionCompoundClip(
+    const MotionVector* LIBGAV1_RESTRICT const temporal_mvs,
+    const int8_t* LIBGAV1_RESTRICT const temporal_reference_offsets,
+    const __m128i numerator) {
+  const auto* const tmvs = reinterpret_cast<const int32_t*>(temporal_mvs);
+  const __m128i temporal_mv = _mm_cvtepu16_epi32(LoadLo8(tmvs));
+  __m128i mvs[2], denominators[2];
+  mvs[0] = _mm_unpacklo_epi64(temporal_mv, temporal_mv);
+  mvs[1] = _mm_unpackhi_epi64(temporal_mv, temporal_mv);
+  denominators[0] = _mm_set1_epi32(
+      kProjectionMvDivisionLookup[temporal_reference_offsets[0]]);
+  denominators[1] = _mm_set1_epi32(
+      kProjectionMvDivisionLookup[temporal_reference_offsets[1]]);
+  return MvProjectionClip(mvs, denominators, numerator);
+}
+
+// Projects 8 single candidates.
+inline __m256i MvProjectionSingleClip(
+    const MotionVector* LIBGAV1_RESTRICT const temporal_mvs,
+    const int8_t* LIBGAV1_RESTRICT const temporal_reference_offsets,
+    const __m256i numerator) {
+  const __m256i temporal_mv = LoadUnaligned32(temporal_mvs);
+  const __m256i lookup = _mm256_i32gather_epi32(
+      kProjectionMvDivisionLookup_32bit,
+      _mm256_cvtepi8_epi32(LoadLo8(temporal_reference_offsets)), 4);
+  __m256i mvs[2], denominators[2];
+  mvs[0] = _mm256_unpacklo_epi16(temporal_mv, _mm256_setzero_si256());
+  mvs[1] = _mm256_unpackhi_epi16(temporal_mv, _mm256_setzero_si256());
+  denominators[0] = _mm256_unpacklo_epi32(lookup, lookup);
+  denominators[1] = _mm256_unpackhi_epi32(lookup, lookup);
+  return MvProjectionClip(mvs, denominators, numerator);
+}
+
+// Projects 4 single candidates.
+inline __m128i MvProjectionSingleClip(
+    const MotionVector* LIBGAV1_RESTRICT const temporal_mvs,
+    const int8_t* LIBGAV1_RESTRICT const temporal_reference_offsets,
+    const __m128i numerator) {
+  const __m128i temporal_mv = LoadUnaligned16(temporal_mvs);
+  const __m128i lookup = _mm_i32gather_epi32(
+      kProjectionMvDivisionLookup_32bit,
+      _mm_cvtepi8_epi32(Load4(temporal_reference_offsets)), 4);
+  __m128i mvs[2], denominators[2];
+  mvs[0] = _mm_unpacklo_epi16(temporal_mv, _mm_setzero_si128());
+  mvs[1] = _mm_unpackhi_epi16(temporal_mv, _mm_setzero_si128());
+  denominators[0] = _mm_unpacklo_epi32(lookup, lookup);
+  denominators[1] = _mm_unpackhi_epi32(lookup, lookup);
+  return MvProjectionClip(mvs, denominators, numerator);
+}
+
+inline __m256i LowPrecision(const __m256i mv) {
+  const __m256i kRoundDownMask = _mm256_set1_epi16(~1);
+  const __m256i sign = _mm256_srai_epi16(mv, 15);
+  const __m256i sub_sign = _mm256_sub_epi16(mv, sign);
+  return _mm256_and_si256(sub_sign, kRoundDownMask);
+}
+
+inline __m128i LowPrecision(const __m128i mv) {
+  const __m128i kRoundDownMask = _mm_set1_epi16(~1);
+  const __m128i sign = _mm_srai_epi16(mv, 15);
+  const __m128i sub_sign = _mm_sub_epi16(mv, sign);
+  return _mm_and_si128(sub_sign, kRoundDownMask);
+}
+
+inline __m256i ForceInteger(const __m256i mv) {
+  const __m256i kRoundDownMask = _mm256_set1_epi16(~7);
+  const __m256i sign = _mm256_srai_epi16(mv, 15);
+  const __m256i mv1 = _mm256_add_epi16(mv, _mm256_set1_epi16(3));
+  const __m256i mv2 = _mm256_sub_epi16(mv1, sign);
+  return _mm256_and_si256(mv2, kRoundDownMask);
+}
+
+inline __m128i ForceInteger(const __m128i mv) {
+  const __m128i kRoundDownMask = _mm_set1_epi16(~7);
+  const __m128i sign = _mm_srai_epi16(mv, 15);
+  const __m128i mv1 = _mm_add_epi16(mv, _mm_set1_epi16(3));
+  const __m128i mv2 = _mm_sub_epi16(mv1, sign);
+  return _mm_and_si128(mv2, kRoundDownMask);
+}
+
+inline __m256i HighPrecision(const __m256i mv) { return mv; }
+
+inline __m128i HighPrecision(const __m128i mv) { return mv; }
+
+// Callers allow one extra compound candidate and up to three extra single
+// candidates to be written. Compound candidates are processed 4 at a time,
+// finishing with 2 when no more than 2 remain, and single candidates 8 at a
+// time, finishing with 4 when no more than 4 remain.
+template <__m256i (*round256)(__m256i), __m128i (*round128)(__m128i)>
+void MvProjectionCompound_AVX2(
+    const MotionVector* LIBGAV1_RESTRICT temporal_mvs,
+    const int8_t* LIBGAV1_RESTRICT temporal_reference_offsets,
+    const int reference_offsets[2], const int count,
+    CompoundMotionVector* LIBGAV1_RESTRICT candidate_mvs) {
+  // |reference_offsets| non-zero check usually equals true and is ignored.
+  const __m128i offsets = LoadLo8(reference_offsets);
+  const __m128i numerator = _mm_unpacklo_epi32(offsets, offsets);
+  // One more element could be calculated.
+  int i = 0;
+  for (; count - i > 2; i += 4) {
+    const __m256i mv = MvProjectionCompoundClip(
+        temporal_mvs + i, temporal_reference_offsets + i,
+        SetrM128i(numerator, numerator));
+    StoreUnaligned32(candidate_mvs + i, round256(mv));
+  }
+  if (i < count) {
+    const __m128i mv = MvProjectionCompoundClip(
+        temporal_mvs + i, temporal_reference_offsets + i, numerator);
+    StoreUnaligned16(candidate_mvs + i, round128(mv));
+  }
+}
+
+template <__m256i (*round256)(__m256i), __m128i (*round128)(__m128i)>
+void MvProjectionSingle_AVX2(
+    const MotionVector* LIBGAV1_RESTRICT temporal_mvs,
+    const int8_t* LIBGAV1_RESTRICT temporal_reference_offsets,
+    const int reference_offset, const int count,
+    MotionVector* LIBGAV1_RESTRICT candidate_mvs) {
+  // Up to three more elements could be calculated.
+  int i = 0;
+  for (; count - i > 4; i += 8) {
+    const __m256i mv =
+        MvProjectionSingleClip(temporal_mvs + i, temporal_reference_offsets + i,
+                               _mm256_set1_epi32(reference_offset));
+    StoreUnaligned32(candidate_mvs + i, round256(mv));
+  }
+  if (i < count) {
+    const __m128i mv =
+        MvProjectionSingleClip(temporal_mvs + i, temporal_reference_offsets + i,
+                               _mm_set1_epi32(reference_offset));
+    StoreUnaligned16(candidate_mvs + i, round128(mv));
+  }
+}
+
+}  // namespace
+
+void MotionVectorSearchInit_AVX2() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+  dsp->mv_projection_compound[0] =
+      MvProjectionCompound_AVX2<LowPrecision, LowPrecision>;
+  dsp->mv_projection_compound[1] =
+      MvProjectionCompound_AVX2<ForceInteger, ForceInteger>;
+  dsp->mv_projection_compound[2] =
+      MvProjectionCompound_AVX2<HighPrecision, HighPrecision>;
+  dsp->mv_projection_single[0] =
+      MvProjectionSingle_AVX2<LowPrecision, LowPrecision>;
+  dsp->mv_projection_single[1] =
+      MvProjectionSingle_AVX2<ForceInteger, ForceInteger>;
+  dsp->mv_projection_single[2] =
+      MvProjectionSingle_AVX2<HighPrecision, HighPrecision>;
+}
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !LIBGAV1_TARGETING_AVX2
+namespace libgav1 {
+namespace dsp {
+
+void MotionVectorSearchInit_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2
@@ -0,0 +1,547 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/obmc.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2
+
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/utils/common.h"
+#include "src/utils/constants.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace {
+
+#include "src/dsp/obmc.inc"
+
+constexpr int kRoundBitsObmcBlend = 6;
+
+// Byte shuffles which repeat the first 2 or 4 bytes of a vector 8 or 4 times
+// each. They expand per-row masks when a vector covers several rows.
+inline __m128i RepeatMask2x8(const __m128i mask_val) {
+  return _mm_shuffle_epi8(mask_val,
+                          _mm_set_epi32(0x01010101, 0x01010101, 0, 0));
+}
+
+inline __m128i RepeatMask4x4(const __m128i mask_val) {
+  return _mm_shuffle_epi8(
+      mask_val, _mm_set_epi32(0x03030303, 0x02020202, 0x01010101, 0));
+}
+
+}  // namespace
+
+namespace low_bitdepth {
+namespace {
+
+// Narrow blocks are processed 16 pixels at a time, gathering as many rows as
+// needed. The pixels and weights are interleaved into the bytes of each 16-bit
+// lane for _mm256_maddubs_epi16: |mask| applies to the prediction and
+// 64 - |mask| to the obmc prediction.
+inline __m256i GetMasks16(const __m128i mask_val) {
+  const __m256i mask = _mm256_cvtepu8_epi16(mask_val);
+  const __m256i obmc_mask = _mm256_sub_epi16(_mm256_set1_epi16(64), mask);
+  return _mm256_or_si256(mask, _mm256_slli_epi16(obmc_mask, 8));
+}
+
+inline __m128i Blend16(const __m128i pred_val, const __m128i obmc_pred_val,
+                       const __m256i& masks) {
+  const __m256i obmc_terms =
+      _mm256_slli_epi16(_mm256_cvtepu8_epi16(obmc_pred_val), 8);
+  const __m256i terms =
+      _mm256_or_si256(_mm256_cvtepu8_epi16(pred_val), obmc_terms);
+  const __m256i result = RightShiftWithRounding_S16(
+      _mm256_maddubs_epi16(terms, masks), kRoundBitsObmcBlend);
+  return _mm_packus_epi16(_mm256_castsi256_si128(result),
+                          _mm256_extracti128_si256(result, 1));
+}
+
+// 32 pixels of one row. The unpack/pack pair keeps the results in memory
+// order.
+inline __m256i Blend32(const __m256i& pred_val, const __m256i& obmc_pred_val,
+                       const __m256i& masks_lo, const __m256i& masks_hi) {
+  const __m256i terms_lo = _mm256_unpacklo_epi8(pred_val, obmc_pred_val);
+  const __m256i result_lo = RightShiftWithRounding_S16(
+      _mm256_maddubs_epi16(terms_lo, masks_lo), kRoundBitsObmcBlend);
+  const __m256i terms_hi = _mm256_unpackhi_epi8(pred_val, obmc_pred_val);
+  const __m256i result_hi = RightShiftWithRounding_S16(
+      _mm256_maddubs_epi16(terms_hi, masks_hi), kRoundBitsObmcBlend);
+  return _mm256_packus_epi16(result_lo, result_hi);
+}
+
+void OverlapBlendFromLeft_AVX2(
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t prediction_stride,
+    const int width, const int height,
+    const void* LIBGAV1_RESTRICT const obmc_prediction,
+    const ptrdiff_t obmc_prediction_stride) {
+  auto* pred = static_cast<uint8_t*>(prediction);
+  const auto* obmc_pred = static_cast<const uint8_t*>(obmc_prediction);
+  const ptrdiff_t pred_stride = prediction_stride;
+  const ptrdiff_t obmc_pred_stride = obmc_prediction_stride;
+  assert(width >= 2);
+  assert(height >= 4);
+  int y = height;
+
+  if (width == 2) {
+    const __m256i masks = GetMasks16(_mm_broadcastw_epi16(Load2(kObmcMask)));
+    do {
+      const __m128i pred_val =
+          _mm_unpacklo_epi32(Load2x2(pred, pred + pred_stride),
+                             Load2x2(pred + 2 * pred_stride,
+                                     pred + 3 * pred_stride));
+      const __m128i obmc_pred_val = _mm_unpacklo_epi32(
+          Load2x2(obmc_pred, obmc_pred + obmc_pred_stride),
+          Load2x2(obmc_pred + 2 * obmc_pred_stride,
+                  obmc_pred + 3 * obmc_pred_stride));
+      const __m128i result = Blend16(pred_val, obmc_pred_val, masks);
+      Store2(pred, result);
+      Store2(pred + pred_stride, _mm_srli_si128(result, 2));
+      Store2(pred + 2 * pred_stride, _mm_srli_si128(result, 4));
+      Store2(pred + 3 * pred_stride, _mm_srli_si128(result, 6));
+      pred += pred_stride << 2;
+      obmc_pred += obmc_pred_stride << 2;
+      y -= 4;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 4) {
+    const __m256i masks =
+        GetMasks16(_mm_broadcastd_epi32(Load4(kObmcMask + 2)));
+    do {
+      const __m128i pred_val = _mm_unpacklo_epi64(
+          Load4x2(pred, pred + pred_stride),
+          Load4x2(pred + 2 * pred_stride, pred + 3 * pred_stride));
+      const __m128i obmc_pred_val = _mm_unpacklo_epi64(
+          Load4x2(obmc_pred, obmc_pred + obmc_pred_stride),
+          Load4x2(obmc_pred + 2 * obmc_pred_stride,
+                  obmc_pred + 3 * obmc_pred_stride));
+      const __m128i result = Blend16(pred_val, obmc_pred_val, masks);
+      Store4(pred, result);
+      Store4(pred + pred_stride, _mm_srli_si128(result, 4));
+      Store4(pred + 2 * pred_stride, _mm_srli_si128(result, 8));
+      Store4(pred + 3 * pred_stride, _mm_srli_si128(result, 12));
+      pred += pred_stride << 2;
+      obmc_pred += obmc_pred_stride << 2;
+      y -= 4;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 8) {
+    const __m256i masks =
+        GetMasks16(_mm_broadcastq_epi64(LoadLo8(kObmcMask + 6)));
+    do {
+      const __m128i pred_val = LoadHi8(LoadLo8(pred), pred + pred_stride);
+      const __m128i obmc_pred_val =
+          LoadHi8(LoadLo8(obmc_pred), obmc_pred + obmc_pred_stride);
+      const __m128i result = Blend16(pred_val, obmc_pred_val, masks);
+      StoreLo8(pred, result);
+      StoreHi8(pred + pred_stride, result);
+      pred += pred_stride << 1;
+      obmc_pred += obmc_pred_stride << 1;
+      y -= 2;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 16) {
+    const __m256i masks = GetMasks16(LoadUnaligned16(kObmcMask + 14));
+    do {
+      StoreUnaligned16(pred, Blend16(LoadUnaligned16(pred),
+                                     LoadUnaligned16(obmc_pred), masks));
+      pred += pred_stride;
+      obmc_pred += obmc_pred_stride;
+    } while (--y != 0);
+    return;
+  }
+
+  assert(width == 32);
+  const __m256i mask_val = LoadUnaligned32(kObmcMask + 30);
+  // 64 - mask
+  const __m256i obmc_mask_val =
+      _mm256_sub_epi8(_mm256_set1_epi8(64), mask_val);
+  const __m256i masks_lo = _mm256_unpacklo_epi8(mask_val, obmc_mask_val);
+  const __m256i masks_hi = _mm256_unpackhi_epi8(mask_val, obmc_mask_val);
+  do {
+    StoreUnaligned32(pred, Blend32(LoadUnaligned32(pred),
+                                   LoadUnaligned32(obmc_pred), masks_lo,
+                                   masks_hi));
+    pred += pred_stride;
+    obmc_pred += obmc_pred_stride;
+  } while (--y != 0);
+}
+
+// Only the first |compute_height| rows are blended; the remaining mask values
+// are 64. Narrow blocks round the row count up to the number of rows in a
+// vector, which is still within |height| and leaves the extra rows unchanged.
+void OverlapBlendFromTop_AVX2(
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t prediction_stride,
+    const int width, const int height,
+    const void* LIBGAV1_RESTRICT const obmc_prediction,
+    const ptrdiff_t obmc_prediction_stride) {
+  auto* pred = static_cast<uint8_t*>(prediction);
+  const auto* obmc_pred = static_cast<const uint8_t*>(obmc_prediction);
+  const ptrdiff_t pred_stride = prediction_stride;
+  const ptrdiff_t obmc_pred_stride = obmc_prediction_stride;
+  assert(width >= 4);
+  assert(height >= 2);
+  const uint8_t* mask = kObmcMask + height - 2;
+  // Stop when mask value becomes 64.
+  const int compute_height = height - (height >> 2);
+  int y = 0;
+
+  if (width == 4) {
+    if (height == 2) {
+      const __m256i masks = GetMasks16(RepeatMask4x4(Load2(mask)));
+      const __m128i result =
+          Blend16(Load4x2(pred, pred + pred_stride),
+                  Load4x2(obmc_pred, obmc_pred + obmc_pred_stride), masks);
+      Store4(pred, result);
+      Store4(pred + pred_stride, _mm_srli_si128(result, 4));
+      return;
+    }
+    do {
+      const __m256i masks = GetMasks16(RepeatMask4x4(Load4(mask + y)));
+      const __m128i pred_val = _mm_unpacklo_epi64(
+          Load4x2(pred, pred + pred_stride),
+          Load4x2(pred + 2 * pred_stride, pred + 3 * pred_stride));
+      const __m128i obmc_pred_val = _mm_unpacklo_epi64(
+          Load4x2(obmc_pred, obmc_pred + obmc_pred_stride),
+          Load4x2(obmc_pred + 2 * obmc_pred_stride,
+                  obmc_pred + 3 * obmc_pred_stride));
+      const __m128i result = Blend16(pred_val, obmc_pred_val, masks);
+      Store4(pred, result);
+      Store4(pred + pred_stride, _mm_srli_si128(result, 4));
+      Store4(pred + 2 * pred_stride, _mm_srli_si128(result, 8));
+      Store4(pred + 3 * pred_stride, _mm_srli_si128(result, 12));
+      pred += pred_stride << 2;
+      obmc_pred += obmc_pred_stride << 2;
+      y += 4;
+    } while (y < compute_height);
+    return;
+  }
+
+  if (width == 8) {
+    do {
+      const __m256i masks = GetMasks16(RepeatMask2x8(Load2(mask + y)));
+      const __m128i pred_val = LoadHi8(LoadLo8(pred), pred + pred_stride);
+      const __m128i obmc_pred_val =
+          LoadHi8(LoadLo8(obmc_pred), obmc_pred + obmc_pred_stride);
+      const __m128i result = Blend16(pred_val, obmc_pred_val, masks);
+      StoreLo8(pred, result);
+      StoreHi8(pred + pred_stride, result);
+      pred += pred_stride << 1;
+      obmc_pred += obmc_pred_stride << 1;
+      y += 2;
+    } while (y < compute_height);
+    return;
+  }
+
+  if (width == 16) {
+    do {
+      const __m256i masks = GetMasks16(_mm_set1_epi8(mask[y]));
+      StoreUnaligned16(pred, Blend16(LoadUnaligned16(pred),
+                                     LoadUnaligned16(obmc_pred), masks));
+      pred += pred_stride;
+      obmc_pred += obmc_pred_stride;
+    } while (++y < compute_height);
+    return;
+  }
+
+  const __m256i mask_inverter = _mm256_set1_epi8(64);
+  do {
+    const __m256i mask_val = _mm256_set1_epi8(mask[y]);
+    // 64 - mask
+    const __m256i obmc_mask_val = _mm256_sub_epi8(mask_inverter, mask_val);
+    const __m256i masks = _mm256_unpacklo_epi8(mask_val, obmc_mask_val);
+    int x = 0;
+    do {
+      StoreUnaligned32(pred + x, Blend32(LoadUnaligned32(pred + x),
+                                         LoadUnaligned32(obmc_pred + x), masks,
+                                         masks));
+      x += 32;
+    } while (x < width);
+    pred += pred_stride;
+    obmc_pred += obmc_pred_stride;
+  } while (++y < compute_height);
+}
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_8BPP_AVX2(ObmcVertical)
+  dsp->obmc_blend[kObmcDirectionVertical] = OverlapBlendFromTop_AVX2;
+#endif
+#if DSP_ENABLED_8BPP_AVX2(ObmcHorizontal)
+  dsp->obmc_blend[kObmcDirectionHorizontal] = OverlapBlendFromLeft_AVX2;
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+// (mask * pred + (64 - mask) * obmc_pred + 32) >> 6 is computed in 16-bit
+// lanes. With 10-bit pixels the weighted sum is at most 64 * 1023 + 32, which
+// fits in an unsigned 16-bit value.
+inline __m256i Blend16(const __m256i& pred_val, const __m256i& obmc_pred_val,
+                       const __m256i& mask) {
+  const __m256i obmc_mask = _mm256_sub_epi16(_mm256_set1_epi16(64), mask);
+  const __m256i sum =
+      _mm256_add_epi16(_mm256_mullo_epi16(pred_val, mask),
+                       _mm256_mullo_epi16(obmc_pred_val, obmc_mask));
+  return _mm256_srli_epi16(
+      _mm256_add_epi16(sum, _mm256_set1_epi16(1 << (kRoundBitsObmcBlend - 1))),
+      kRoundBitsObmcBlend);
+}
+
+inline __m128i Blend8(const __m128i pred_val, const __m128i obmc_pred_val,
+                      const __m128i mask) {
+  const __m128i obmc_mask = _mm_sub_epi16(_mm_set1_epi16(64), mask);
+  const __m128i sum = _mm_add_epi16(_mm_mullo_epi16(pred_val, mask),
+                                    _mm_mullo_epi16(obmc_pred_val, obmc_mask));
+  return _mm_srli_epi16(
+      _mm_add_epi16(sum, _mm_set1_epi16(1 << (kRoundBitsObmcBlend - 1))),
+      kRoundBitsObmcBlend);
+}
+
+// 4 pixels from each of 4 rows.
+inline __m256i Load4x4(const uint16_t* LIBGAV1_RESTRICT src,
+                       const ptrdiff_t stride) {
+  const uint16_t* const src_2 = src + 2 * stride;
+  return SetrM128i(LoadHi8(LoadLo8(src), src + stride),
+                   LoadHi8(LoadLo8(src_2), src_2 + stride));
+}
+
+inline void Store4x4(uint16_t* LIBGAV1_RESTRICT dst, const ptrdiff_t stride,
+                     const __m256i& val) {
+  const __m128i val_lo = _mm256_castsi256_si128(val);
+  const __m128i val_hi = _mm256_extracti128_si256(val, 1);
+  StoreLo8(dst, val_lo);
+  StoreHi8(dst + stride, val_lo);
+  StoreLo8(dst + 2 * stride, val_hi);
+  StoreHi8(dst + 3 * stride, val_hi);
+}
+
+// 8 pixels from each of 2 rows.
+inline __m256i Load8x2(const uint16_t* LIBGAV1_RESTRICT src,
+                       const ptrdiff_t stride) {
+  return SetrM128i(LoadUnaligned16(src), LoadUnaligned16(src + stride));
+}
+
+inline void Store8x2(uint16_t* LIBGAV1_RESTRICT dst, const ptrdiff_t stride,
+                     const __m256i& val) {
+  StoreUnaligned16(dst, _mm256_castsi256_si128(val));
+  StoreUnaligned16(dst + stride, _mm256_extracti128_si256(val, 1));
+}
+
+void OverlapBlendFromLeft10bpp_AVX2(
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t prediction_stride,
+    const int width, const int height,
+    const void* LIBGAV1_RESTRICT const obmc_prediction,
+    const ptrdiff_t obmc_prediction_stride) {
+  auto* pred = static_cast<uint16_t*>(prediction);
+  const auto* obmc_pred = static_cast<const uint16_t*>(obmc_prediction);
+  const ptrdiff_t pred_stride = prediction_stride / sizeof(pred[0]);
+  const ptrdiff_t obmc_pred_stride =
+      obmc_prediction_stride / sizeof(obmc_pred[0]);
+  assert(width >= 2);
+  assert(height >= 4);
+  int y = height;
+
+  if (width == 2) {
+    const __m128i mask =
+        _mm_cvtepu8_epi16(_mm_broadcastw_epi16(Load2(kObmcMask)));
+    do {
+      const __m128i pred_val = _mm_unpacklo_epi64(
+          Load4x2(pred, pred + pred_stride),
+          Load4x2(pred + 2 * pred_stride, pred + 3 * pred_stride));
+      const __m128i obmc_pred_val = _mm_unpacklo_epi64(
+          Load4x2(obmc_pred, obmc_pred + obmc_pred_stride),
+          Load4x2(obmc_pred + 2 * obmc_pred_stride,
+                  obmc_pred + 3 * obmc_pred_stride));
+      const __m128i result = Blend8(pred_val, obmc_pred_val, mask);
+      Store4(pred, result);
+      Store4(pred + pred_stride, _mm_srli_si128(result, 4));
+      Store4(pred + 2 * pred_stride, _mm_srli_si128(result, 8));
+      Store4(pred + 3 * pred_stride, _mm_srli_si128(result, 12));
+      pred += pred_stride << 2;
+      obmc_pred += obmc_pred_stride << 2;
+      y -= 4;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 4) {
+    const __m256i mask =
+        _mm256_cvtepu8_epi16(_mm_broadcastd_epi32(Load4(kObmcMask + 2)));
+    do {
+      Store4x4(pred, pred_stride,
+               Blend16(Load4x4(pred, pred_stride),
+                       Load4x4(obmc_pred, obmc_pred_stride), mask));
+      pred += pred_stride << 2;
+      obmc_pred += obmc_pred_stride << 2;
+      y -= 4;
+    } while (y != 0);
+    return;
+  }
+
+  if (width == 8) {
+    const __m256i mask =
+        _mm256_cvtepu8_epi16(_mm_broadcastq_epi64(LoadLo8(kObmcMask + 6)));
+    do {
+      Store8x2(pred, pred_stride,
+               Blend16(Load8x2(pred, pred_stride),
+                       Load8x2(obmc_pred, obmc_pred_stride), mask));
+      pred += pred_stride << 1;
+      obmc_pred += obmc_pred_stride << 1;
+      y -= 2;
+    } while (y != 0);
+    return;
+  }
+
+  const uint8_t* mask = kObmcMask + width - 2;
+  int x = 0;
+  do {
+    pred = static_cast<uint16_t*>(prediction) + x;
+    obmc_pred = static_cast<const uint16_t*>(obmc_prediction) + x;
+    const __m256i mask_val = _mm256_cvtepu8_epi16(LoadUnaligned16(mask + x));
+    y = height;
+    do {
+      StoreUnaligned32(pred, Blend16(LoadUnaligned32(pred),
+                                     LoadUnaligned32(obmc_pred), mask_val));
+      pred += pred_stride;
+      obmc_pred += obmc_pred_stride;
+    } while (--y != 0);
+    x += 16;
+  } while (x < width);
+}
+
+void OverlapBlendFromTop10bpp_AVX2(
+    void* LIBGAV1_RESTRICT const prediction, const ptrdiff_t prediction_stride,
+    const int width, const int height,
+    const void* LIBGAV1_RESTRICT const obmc_prediction,
+    const ptrdiff_t obmc_prediction_stride) {
+  auto* pred = static_cast<uint16_t*>(prediction);
+  const auto* obmc_pred = static_cast<const uint16_t*>(obmc_prediction);
+  const ptrdiff_t pred_stride = prediction_stride / sizeof(pred[0]);
+  const ptrdiff_t obmc_pred_stride =
+      obmc_prediction_stride / sizeof(obmc_pred[0]);
+  assert(width >= 4);
+  assert(height >= 2);
+  const uint8_t* mask = kObmcMask + height - 2;
+  // Stop when mask value becomes 64.
+  const int compute_height = height - (height >> 2);
+  int y = 0;
+
+  if (width == 4) {
+    if (height == 2) {
+      const __m128i mask_val = _mm_cvtepu8_epi16(RepeatMask4x4(Load2(mask)));
+      const __m128i result =
+          Blend8(LoadHi8(LoadLo8(pred), pred + pred_stride),
+                 LoadHi8(LoadLo8(obmc_pred), obmc_pred + obmc_pred_stride),
+                 mask_val);
+      StoreLo8(pred, result);
+      StoreHi8(pred + pred_stride, result);
+      return;
+    }
+    do {
+      const __m256i mask_val =
+          _mm256_cvtepu8_epi16(RepeatMask4x4(Load4(mask + y)));
+      Store4x4(pred, pred_stride,
+               Blend16(Load4x4(pred, pred_stride),
+                       Load4x4(obmc_pred, obmc_pred_stride), mask_val));
+      pred += pred_stride << 2;
+      obmc_pred += obmc_pred_stride << 2;
+      y += 4;
+    } while (y < compute_height);
+    return;
+  }
+
+  if (width == 8) {
+    do {
+      const __m256i mask_val =
+          _mm256_cvtepu8_epi16(RepeatMask2x8(Load2(mask + y)));
+      Store8x2(pred, pred_stride,
+               Blend16(Load8x2(pred, pred_stride),
+                       Load8x2(obmc_pred, obmc_pred_stride), mask_val));
+      pred += pred_stride << 1;
+      obmc_pred += obmc_pred_stride << 1;
+      y += 2;
+    } while (y < compute_height);
+    return;
+  }
+
+  do {
+    const __m256i mask_val = _mm256_set1_epi16(mask[y]);
+    int x = 0;
+    do {
+      StoreUnaligned32(pred + x, Blend16(LoadUnaligned32(pred + x),
+                                         LoadUnaligned32(obmc_pred + x),
+                                         mask_val));
+      x += 16;
+    } while (x < width);
+    pred += pred_stride;
+    obmc_pred += obmc_pred_stride;
+  } while (++y < compute_height);
+}
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_10BPP_AVX2(ObmcVertical)
+  dsp->obmc_blend[kObmcDirectionVertical] = OverlapBlendFromTop10bpp_AVX2;
+#endif
+#if DSP_ENABLED_10BPP_AVX2(ObmcHorizontal)
+  dsp->obmc_blend[kObmcDirectionHorizontal] = OverlapBlendFromLeft10bpp_AVX2;
+#endif
+}
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void ObmcInit_AVX2() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+}
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !LIBGAV1_TARGETING_AVX2
+
+namespace libgav1 {
+namespace dsp {
+
+void ObmcInit_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2
@@ -0,0 +1,634 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/warp.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2
+
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/utils/common.h"
+#include "src/utils/constants.h"
+#include "src/utils/memory.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace {
+
+// Number of extra bits of precision in warped filtering.
+constexpr int kWarpedDiffPrecisionBits = 10;
+
+constexpr int kFirstPassOffset = 1 << 14;
+constexpr int kOffsetRemoval =
+    (kFirstPassOffset >> kInterRoundBitsHorizontal) * 128;
+
+// The AVX2 functions process two rows at a time, one per 128-bit lane. The
+// transposes below operate on each lane independently; see the SSE4.1
+// versions in transpose_sse4.h for the element layout.
+LIBGAV1_ALWAYS_INLINE void Transpose8x8To4x16_U8(const __m256i* const in,
+                                                 __m256i* out) {
+  const __m256i a0 = _mm256_unpacklo_epi8(in[0], in[1]);
+  const __m256i a1 = _mm256_unpacklo_epi8(in[2], in[3]);
+  const __m256i a2 = _mm256_unpacklo_epi8(in[4], in[5]);
+  const __m256i a3 = _mm256_unpacklo_epi8(in[6], in[7]);
+
+  const __m256i b0 = _mm256_unpacklo_epi16(a0, a1);
+  const __m256i b1 = _mm256_unpacklo_epi16(a2, a3);
+  const __m256i b2 = _mm256_unpackhi_epi16(a0, a1);
+  const __m256i b3 = _mm256_unpackhi_epi16(a2, a3);
+
+  out[0] = _mm256_unpacklo_epi32(b0, b1);
+  out[1] = _mm256_unpackhi_epi32(b0, b1);
+  out[2] = _mm256_unpacklo_epi32(b2, b3);
+  out[3] = _mm256_unpackhi_epi32(b2, b3);
+}
+
+LIBGAV1_ALWAYS_INLINE void Transpose8x8_U16(const __m256i* const in,
+                                            __m256i* const out) {
+  const __m256i a0 = _mm256_unpacklo_epi16(in[0], in[1]);
+  const __m256i a1 = _mm256_unpacklo_epi16(in[2], in[3]);
+  const __m256i a2 = _mm256_unpacklo_epi16(in[4], in[5]);
+  const __m256i a3 = _mm256_unpacklo_epi16(in[6], in[7]);
+  const __m256i a4 = _mm256_unpackhi_epi16(in[0], in[1]);
+  const __m256i a5 = _mm256_unpackhi_epi16(in[2], in[3]);
+  const __m256i a6 = _mm256_unpackhi_epi16(in[4], in[5]);
+  const __m256i a7 = _mm256_unpackhi_epi16(in[6], in[7]);
+
+  const __m256i b0 = _mm256_unpacklo_epi32(a0, a1);
+  const __m256i b1 = _mm256_unpacklo_epi32(a2, a3);
+  const __m256i b2 = _mm256_unpacklo_epi32(a4, a5);
+  const __m256i b3 = _mm256_unpacklo_epi32(a6, a7);
+  const __m256i b4 = _mm256_unpackhi_epi32(a0, a1);
+  const __m256i b5 = _mm256_unpackhi_epi32(a2, a3);
+  const __m256i b6 = _mm256_unpackhi_epi32(a4, a5);
+  const __m256i b7 = _mm256_unpackhi_epi32(a6, a7);
+
+  out[0] = _mm256_unpacklo_epi64(b0, b1);
+  out[1] = _mm256_unpackhi_epi64(b0, b1);
+  out[2] = _mm256_unpacklo_epi64(b4, b5);
+  out[3] = _mm256_unpackhi_epi64(b4, b5);
+  out[4] = _mm256_unpacklo_epi64(b2, b3);
+  out[5] = _mm256_unpackhi_epi64(b2, b3);
+  out[6] = _mm256_unpacklo_epi64(b6, b7);
+  out[7] = _mm256_unpackhi_epi64(b6, b7);
+}
+
+// This assumes the two filters contain filter[x] and filter[x+2].
+inline __m256i AccumulateFilter(const __m256i sum, const __m256i filter_0,
+                                const __m256i filter_1,
+                                const __m256i& src_window) {
+  const __m256i filter_taps = _mm256_unpacklo_epi8(filter_0, filter_1);
+  const __m256i src =
+      _mm256_unpacklo_epi8(src_window, _mm256_srli_si256(src_window, 2));
+  return _mm256_add_epi16(sum, _mm256_maddubs_epi16(src, filter_taps));
+}
+
+// Applies the horizontal filter to two source rows and stores the results in
+// |intermediate_result_rows|, two consecutive rows of the 16x8
+// |intermediate_result| array. The row in the low lane of |src_rows| uses
+// |sx4_0| and the row in the high lane uses |sx4_1|.
+inline void HorizontalFilter(const int sx4_0, const int sx4_1,
+                             const int16_t alpha, const __m256i src_rows,
+                             int16_t intermediate_result_rows[2][8]) {
+  int sx_0 = sx4_0 - MultiplyBy4(alpha);
+  int sx_1 = sx4_1 - MultiplyBy4(alpha);
+  __m256i filter[8];
+  for (__m256i& f : filter) {
+    const int offset_0 =
+        RightShiftWithRounding(sx_0, kWarpedDiffPrecisionBits) +
+        kWarpedPixelPrecisionShifts;
+    const int offset_1 =
+        RightShiftWithRounding(sx_1, kWarpedDiffPrecisionBits) +
+        kWarpedPixelPrecisionShifts;
+    f = SetrM128i(LoadLo8(kWarpedFilters8[offset_0]),
+                  LoadLo8(kWarpedFilters8[offset_1]));
+    sx_0 += alpha;
+    sx_1 += alpha;
+  }
+  Transpose8x8To4x16_U8(filter, filter);
+  // |filter| now contains two filters per 128-bit lane. See the SSE4.1
+  // version for the pairing of taps, which keeps _mm256_maddubs_epi16 from
+  // overflowing.
+  // k = 0, 2.
+  __m256i src_row_window = src_rows;
+  __m256i sum = _mm256_set1_epi16(-kFirstPassOffset);
+  sum = AccumulateFilter(sum, filter[0], filter[1], src_row_window);
+
+  // k = 1, 3.
+  src_row_window = _mm256_srli_si256(src_row_window, 1);
+  sum = AccumulateFilter(sum, _mm256_srli_si256(filter[0], 8),
+                         _mm256_srli_si256(filter[1], 8), src_row_window);
+  // k = 4, 6.
+  src_row_window = _mm256_srli_si256(src_row_window, 3);
+  sum = AccumulateFilter(sum, filter[2], filter[3], src_row_window);
+
+  // k = 5, 7.
+  src_row_window = _mm256_srli_si256(src_row_window, 1);
+  sum = AccumulateFilter(sum, _mm256_srli_si256(filter[2], 8),
+                         _mm256_srli_si256(filter[3], 8), src_row_window);
+
+  sum = RightShiftWithRounding_S16(sum, kInterRoundBitsHorizontal);
+  StoreUnaligned32(intermediate_result_rows, sum);
+}
+
+// 10bpp version of HorizontalFilter(). |src_rows[0]| holds samples 0-7 and
+// |src_rows[1]| holds samples 8-15 of each row, starting at column ix4 - 7.
+inline void HorizontalFilter(const int sx4_0, const int sx4_1,
+                             const int16_t alpha, const __m256i src_rows[2],
+                             int16_t intermediate_result_rows[2][8]) {
+  int sx_0 = sx4_0 - MultiplyBy4(alpha);
+  int sx_1 = sx4_1 - MultiplyBy4(alpha);
+  __m256i filter[8];
+  for (__m256i& f : filter) {
+    const int offset_0 =
+        RightShiftWithRounding(sx_0, kWarpedDiffPrecisionBits) +
+        kWarpedPixelPrecisionShifts;
+    const int offset_1 =
+        RightShiftWithRounding(sx_1, kWarpedDiffPrecisionBits) +
+        kWarpedPixelPrecisionShifts;
+    f = SetrM128i(LoadUnaligned16(kWarpedFilters[offset_0]),
+                  LoadUnaligned16(kWarpedFilters[offset_1]));
+    sx_0 += alpha;
+    sx_1 += alpha;
+  }
+  // |filter[k]| now contains tap k for each of the 8 output pixels.
+  Transpose8x8_U16(filter, filter);
+
+  // |src_row_window[k]| contains the samples multiplied by tap k.
+  __m256i src_row_window[8];
+  src_row_window[0] = src_rows[0];
+  src_row_window[1] = _mm256_alignr_epi8(src_rows[1], src_rows[0], 2);
+  src_row_window[2] = _mm256_alignr_epi8(src_rows[1], src_rows[0], 4);
+  src_row_window[3] = _mm256_alignr_epi8(src_rows[1], src_rows[0], 6);
+  src_row_window[4] = _mm256_alignr_epi8(src_rows[1], src_rows[0], 8);
+  src_row_window[5] = _mm256_alignr_epi8(src_rows[1], src_rows[0], 10);
+  src_row_window[6] = _mm256_alignr_epi8(src_rows[1], src_rows[0], 12);
+  src_row_window[7] = _mm256_alignr_epi8(src_rows[1], src_rows[0], 14);
+
+  __m256i sum_low = _mm256_setzero_si256();
+  __m256i sum_high = _mm256_setzero_si256();
+  for (int k = 0; k < 8; k += 2) {
+    const __m256i filters_low =
+        _mm256_unpacklo_epi16(filter[k], filter[k + 1]);
+    const __m256i filters_high =
+        _mm256_unpackhi_epi16(filter[k], filter[k + 1]);
+    const __m256i src_low =
+        _mm256_unpacklo_epi16(src_row_window[k], src_row_window[k + 1]);
+    const __m256i src_high =
+        _mm256_unpackhi_epi16(src_row_window[k], src_row_window[k + 1]);
+    sum_low =
+        _mm256_add_epi32(sum_low, _mm256_madd_epi16(filters_low, src_low));
+    sum_high =
+        _mm256_add_epi32(sum_high, _mm256_madd_epi16(filters_high, src_high));
+  }
+  sum_low = RightShiftWithRounding_S32(sum_low, kInterRoundBitsHorizontal);
+  sum_high = RightShiftWithRounding_S32(sum_high, kInterRoundBitsHorizontal);
+  StoreUnaligned32(intermediate_result_rows,
+                   _mm256_packs_epi32(sum_low, sum_high));
+}
+
+// Filters the rows starting at |src_row_0| and |src_row_1|, which point to
+// column ix4 - 7 of their respective source rows. 16 samples are read from
+// each row; the last one is ignored.
+template <typename Pixel>
+inline void HorizontalFilterRows(const Pixel* LIBGAV1_RESTRICT src_row_0,
+                                 const Pixel* LIBGAV1_RESTRICT src_row_1,
+                                 const int sx4_0, const int sx4_1,
+                                 const int16_t alpha,
+                                 int16_t intermediate_result_rows[2][8]) {
+  if (sizeof(Pixel) == 1) {
+    const __m256i src_rows =
+        SetrM128i(LoadUnaligned16(src_row_0), LoadUnaligned16(src_row_1));
+    HorizontalFilter(sx4_0, sx4_1, alpha, src_rows, intermediate_result_rows);
+  } else {
+    const __m256i src_rows[2] = {
+        SetrM128i(LoadUnaligned16(src_row_0), LoadUnaligned16(src_row_1)),
+        SetrM128i(LoadUnaligned16(src_row_0 + 8),
+                  LoadUnaligned16(src_row_1 + 8))};
+    HorizontalFilter(sx4_0, sx4_1, alpha, src_rows, intermediate_result_rows);
+  }
+}
+
+// Loads the vertical filters for two rows of output, transposed so that
+// |filter[k]| holds tap k for each column. The row starting at |sy4_0| is
+// placed in the low lane.
+inline void LoadVerticalFilters(const int sy4_0, const int sy4_1,
+                                const int gamma, __m256i filter[8]) {
+  int sy_0 = sy4_0 - MultiplyBy4(gamma);
+  int sy_1 = sy4_1 - MultiplyBy4(gamma);
+  for (int i = 0; i < 8; ++i) {
+    const int offset_0 =
+        RightShiftWithRounding(sy_0, kWarpedDiffPrecisionBits) +
+        kWarpedPixelPrecisionShifts;
+    const int offset_1 =
+        RightShiftWithRounding(sy_1, kWarpedDiffPrecisionBits) +
+        kWarpedPixelPrecisionShifts;
+    filter[i] = SetrM128i(LoadUnaligned16(kWarpedFilters[offset_0]),
+                          LoadUnaligned16(kWarpedFilters[offset_1]));
+    sy_0 += gamma;
+    sy_1 += gamma;
+  }
+  Transpose8x8_U16(filter, filter);
+}
+
+// Rounds the vertical filter sums and stores the low lane to |dst_row| and
+// the high lane to the following row.
+template <bool is_compound, int bitdepth, typename DestType>
+inline void StoreVerticalFilterOutput(__m256i sum_low, __m256i sum_high,
+                                      DestType* LIBGAV1_RESTRICT dst_row,
+                                      const ptrdiff_t dest_stride) {
+  constexpr int kRoundBitsVertical =
+      is_compound ? kInterRoundBitsCompoundVertical : kInterRoundBitsVertical;
+  sum_low = RightShiftWithRounding_S32(sum_low, kRoundBitsVertical);
+  sum_high = RightShiftWithRounding_S32(sum_high, kRoundBitsVertical);
+  __m256i sum;
+  if (bitdepth == kBitdepth8) {
+    if (is_compound) {
+      sum = _mm256_packs_epi32(sum_low, sum_high);
+    } else {
+      sum = _mm256_packus_epi32(sum_low, sum_high);
+      sum = _mm256_packus_epi16(sum, sum);
+      StoreLo8(dst_row, _mm256_castsi256_si128(sum));
+      StoreLo8(dst_row + dest_stride, _mm256_extracti128_si256(sum, 1));
+      return;
+    }
+  } else if (is_compound) {
+    // The compound range before adding the offset exceeds int16_t, see the
+    // ranges listed in warp.cc.
+    const __m256i compound_offset = _mm256_set1_epi32(kCompoundOffset);
+    sum = _mm256_packus_epi32(_mm256_add_epi32(sum_low, compound_offset),
+                              _mm256_add_epi32(sum_high, compound_offset));
+  } else {
+    sum = _mm256_min_epu16(_mm256_packus_epi32(sum_low, sum_high),
+                           _mm256_set1_epi16((1 << bitdepth) - 1));
+  }
+  StoreUnaligned16(dst_row, _mm256_castsi256_si128(sum));
+  StoreUnaligned16(dst_row + dest_stride, _mm256_extracti128_si256(sum, 1));
+}
+
+template <bool is_compound, int bitdepth, typename DestType>
+inline void VerticalFilter(const int16_t source[16][8], int y4, int gamma,
+                           int delta, DestType* LIBGAV1_RESTRICT dest_row,
+                           ptrdiff_t dest_stride) {
+  int sy4 = (y4 & ((1 << kWarpedModelPrecisionBits) - 1)) - MultiplyBy4(delta);
+  for (int y = 0; y < 8; y += 2) {
+    __m256i filter[8];
+    LoadVerticalFilters(sy4, sy4 + delta, gamma, filter);
+    // Only the 8bpp horizontal filter applies |kFirstPassOffset|.
+    __m256i sum_low =
+        _mm256_set1_epi32((bitdepth == kBitdepth8) ? kOffsetRemoval : 0);
+    __m256i sum_high = sum_low;
+    for (int k = 0; k < 8; k += 2) {
+      const __m256i filters_low =
+          _mm256_unpacklo_epi16(filter[k], filter[k + 1]);
+      const __m256i filters_high =
+          _mm256_unpackhi_epi16(filter[k], filter[k + 1]);
+      // The low lanes hold rows y + k and y + k + 1, the high lanes hold
+      // rows y + k + 1 and y + k + 2.
+      const __m256i intermediate_0 = LoadUnaligned32(source[y + k]);
+      const __m256i intermediate_1 = LoadUnaligned32(source[y + k + 1]);
+      const __m256i intermediate_low =
+          _mm256_unpacklo_epi16(intermediate_0, intermediate_1);
+      const __m256i intermediate_high =
+          _mm256_unpackhi_epi16(intermediate_0, intermediate_1);
+
+      const __m256i product_low =
+          _mm256_madd_epi16(filters_low, intermediate_low);
+      const __m256i product_high =
+          _mm256_madd_epi16(filters_high, intermediate_high);
+      sum_low = _mm256_add_epi32(sum_low, product_low);
+      sum_high = _mm256_add_epi32(sum_high, product_high);
+    }
+    StoreVerticalFilterOutput<is_compound, bitdepth>(sum_low, sum_high,
+                                                     dest_row, dest_stride);
+    dest_row += dest_stride << 1;
+    sy4 += 2 * delta;
+  }
+}
+
+// Returns |low| and |high| packed into the low and high halves of an int32_t,
+// without shifting a negative value.
+inline int32_t PackInt16Pair(int16_t low, int16_t high) {
+  const uint32_t high_bits = static_cast<uint16_t>(high);
+  return static_cast<int32_t>((high_bits << 16) | static_cast<uint16_t>(low));
+}
+
+template <bool is_compound, int bitdepth, typename DestType>
+inline void VerticalFilter(const int16_t* LIBGAV1_RESTRICT source_cols, int y4,
+                           int gamma, int delta,
+                           DestType* LIBGAV1_RESTRICT dest_row,
+                           ptrdiff_t dest_stride) {
+  int sy4 = (y4 & ((1 << kWarpedModelPrecisionBits) - 1)) - MultiplyBy4(delta);
+  for (int y = 0; y < 8; y += 2) {
+    __m256i filter[8];
+    LoadVerticalFilters(sy4, sy4 + delta, gamma, filter);
+    __m256i sum_low = _mm256_setzero_si256();
+    __m256i sum_high = _mm256_setzero_si256();
+    for (int k = 0; k < 8; k += 2) {
+      const __m256i filters_low =
+          _mm256_unpacklo_epi16(filter[k], filter[k + 1]);
+      const __m256i filters_high =
+          _mm256_unpackhi_epi16(filter[k], filter[k + 1]);
+      // Equivalent to unpacking two vectors made by duplicating int16_t
+      // values.
+      const __m256i intermediate =
+          SetrM128i(_mm_set1_epi32(PackInt16Pair(source_cols[y + k],
+                                                 source_cols[y + k + 1])),
+                    _mm_set1_epi32(PackInt16Pair(source_cols[y + k + 1],
+                                                 source_cols[y + k + 2])));
+      const __m256i product_low = _mm256_madd_epi16(filters_low, intermediate);
+      const __m256i product_high =
+          _mm256_madd_epi16(filters_high, intermediate);
+      sum_low = _mm256_add_epi32(sum_low, product_low);
+      sum_high = _mm256_add_epi32(sum_high, product_high);
+    }
+    StoreVerticalFilterOutput<is_compound, bitdepth>(sum_low, sum_high,
+                                                     dest_row, dest_stride);
+    dest_row += dest_stride << 1;
+    sy4 += 2 * delta;
+  }
+}
+
+template <bool is_compound, int bitdepth, typename Pixel, typename DestType>
+inline void WarpRegion1(const Pixel* LIBGAV1_RESTRICT src,
+                        ptrdiff_t source_stride, int source_width,
+                        int source_height, int ix4, int iy4,
+                        DestType* LIBGAV1_RESTRICT dst_row,
+                        ptrdiff_t dest_stride) {
+  // Region 1
+  // Points to the left or right border of the first row of |src|.
+  const Pixel* first_row_border =
+      (ix4 + 7 <= 0) ? src : src + source_width - 1;
+  // Every sample used to calculate the prediction block has the same
+  // value. So the whole prediction block has the same value.
+  const int row = (iy4 + 7 <= 0) ? 0 : source_height - 1;
+  const Pixel row_border_pixel = first_row_border[row * source_stride];
+
+  if (is_compound) {
+    int sum = row_border_pixel
+              << (kInterRoundBitsVertical - kInterRoundBitsCompoundVertical);
+    sum += (bitdepth == kBitdepth8) ? 0 : kCompoundOffset;
+    StoreUnaligned16(dst_row, _mm_set1_epi16(sum));
+  } else {
+    Memset(dst_row, row_border_pixel, 8);
+  }
+  const DestType* const first_dst_row = dst_row;
+  dst_row += dest_stride;
+  for (int y = 1; y < 8; ++y) {
+    memcpy(dst_row, first_dst_row, 8 * sizeof(*dst_row));
+    dst_row += dest_stride;
+  }
+}
+
+template <bool is_compound, int bitdepth, typename Pixel, typename DestType>
+inline void WarpRegion2(const Pixel* LIBGAV1_RESTRICT src,
+                        ptrdiff_t source_stride, int source_width, int y4,
+                        int ix4, int iy4, int gamma, int delta,
+                        int16_t intermediate_result_column[15],
+                        DestType* LIBGAV1_RESTRICT dst_row,
+                        ptrdiff_t dest_stride) {
+  // Region 2.
+  // Points to the left or right border of the first row of |src|.
+  const Pixel* first_row_border =
+      (ix4 + 7 <= 0) ? src : src + source_width - 1;
+  // The input values in this region are generated by extending the border
+  // which makes them identical in the horizontal direction. The horizontal
+  // pass is a simple shift.
+  for (int y = -7; y < 8; ++y) {
+    // We may over-read up to 13 pixels above the top source row, or up
+    // to 13 pixels below the bottom source row. This is proved in
+    // warp.cc.
+    const int row = iy4 + y;
+    int sum = first_row_border[row * source_stride];
+    sum <<= (kFilterBits - kInterRoundBitsHorizontal);
+    intermediate_result_column[y + 7] = sum;
+  }
+  // Region 2 vertical filter.
+  VerticalFilter<is_compound, bitdepth, DestType>(
+      intermediate_result_column, y4, gamma, delta, dst_row, dest_stride);
+}
+
+template <typename Pixel>
+inline void WarpRegion3(const Pixel* LIBGAV1_RESTRICT src,
+                        ptrdiff_t source_stride, int source_height, int alpha,
+                        int beta, int x4, int ix4, int iy4,
+                        int16_t intermediate_result[16][8]) {
+  // Region 3
+  // At this point, we know ix4 - 7 < source_width - 1 and ix4 + 7 > 0.
+  // Every row is clipped to either 0 or source_height - 1.
+  const int row = (iy4 + 7 <= 0) ? 0 : source_height - 1;
+  // NOTE: This may read up to 13 pixels before src_row[0] or up to 14
+  // pixels after src_row[source_width - 1]. We assume the source frame
+  // has left and right borders of at least 13 pixels that extend the
+  // frame boundary pixels. We also assume there is at least one extra
+  // padding pixel after the right border of the last source row.
+  const Pixel* const src_row = src + row * source_stride + ix4 - 7;
+  int sx4 = (x4 & ((1 << kWarpedModelPrecisionBits) - 1)) - beta * 7;
+  for (int y = -7; y < 7; y += 2) {
+    HorizontalFilterRows(src_row, src_row, sx4, sx4 + beta, alpha,
+                         &intermediate_result[y + 7]);
+    sx4 += 2 * beta;
+  }
+  // The last row is duplicated in the high lane. Row 15 of
+  // |intermediate_result| is unused.
+  HorizontalFilterRows(src_row, src_row, sx4, sx4, alpha,
+                       &intermediate_result[14]);
+}
+
+template <typename Pixel>
+inline void WarpRegion4(const Pixel* LIBGAV1_RESTRICT src,
+                        ptrdiff_t source_stride, int alpha, int beta, int x4,
+                        int ix4, int iy4, int16_t intermediate_result[16][8]) {
+  // Region 4.
+  // At this point, we know ix4 - 7 < source_width - 1 and ix4 + 7 > 0.
+
+  // We may over-read up to 13 pixels above the top source row, or up to 13
+  // pixels below the bottom source row, and up to 13 pixels before or 14
+  // pixels after each row. This is proved in warp.cc.
+  const Pixel* src_row = src + (iy4 - 7) * source_stride + ix4 - 7;
+  int sx4 = (x4 & ((1 << kWarpedModelPrecisionBits) - 1)) - beta * 7;
+  for (int y = -7; y < 7; y += 2) {
+    HorizontalFilterRows(src_row, src_row + source_stride, sx4, sx4 + beta,
+                         alpha, &intermediate_result[y + 7]);
+    src_row += source_stride << 1;
+    sx4 += 2 * beta;
+  }
+  // The last row is duplicated in the high lane. Row 15 of
+  // |intermediate_result| is unused.
+  HorizontalFilterRows(src_row, src_row, sx4, sx4, alpha,
+                       &intermediate_result[14]);
+}
+
+template <bool is_compound, int bitdepth, typename Pixel, typename DestType>
+inline void HandleWarpBlock(const Pixel* LIBGAV1_RESTRICT src,
+                            ptrdiff_t source_stride, int source_width,
+                            int source_height,
+                            const int* LIBGAV1_RESTRICT warp_params,
+                            int subsampling_x, int subsampling_y, int src_x,
+                            int src_y, int16_t alpha, int16_t beta,
+                            int16_t gamma, int16_t delta,
+                            DestType* LIBGAV1_RESTRICT dst_row,
+                            ptrdiff_t dest_stride) {
+  union {
+    // Intermediate_result is the output of the horizontal filtering and
+    // rounding. The range is within int16_t. The rows are filtered in pairs
+    // so the 16th row is written but never read.
+    int16_t intermediate_result[16][8];  // 16 rows, 8 columns.
+    // In the simple special cases where the samples in each row are all the
+    // same, store one sample per row in a column vector.
+    int16_t intermediate_result_column[15];
+  };
+
+  const int dst_x =
+      src_x * warp_params[2] + src_y * warp_params[3] + warp_params[0];
+  const int dst_y =
+      src_x * warp_params[4] + src_y * warp_params[5] + warp_params[1];
+  const int x4 = dst_x >> subsampling_x;
+  const int y4 = dst_y >> subsampling_y;
+  const int ix4 = x4 >> kWarpedModelPrecisionBits;
+  const int iy4 = y4 >> kWarpedModelPrecisionBits;
+  // The plane is divided into the same regions as in warp.cc and
+  // warp_sse4.cc. Regions 1 and 2 lie outside the frame horizontally and
+  // region 3 lies outside the frame vertically.
+  if (ix4 - 7 >= source_width - 1 || ix4 + 7 <= 0) {
+    if ((iy4 - 7 >= source_height - 1 || iy4 + 7 <= 0)) {
+      // Outside the frame in both directions. One repeated value.
+      WarpRegion1<is_compound, bitdepth>(src, source_stride, source_width,
+                                         source_height, ix4, iy4, dst_row,
+                                         dest_stride);
+      return;
+    }
+    // Outside the frame horizontally. Rows repeated.
+    WarpRegion2<is_compound, bitdepth>(
+        src, source_stride, source_width, y4, ix4, iy4, gamma, delta,
+        intermediate_result_column, dst_row, dest_stride);
+    return;
+  }
+
+  if ((iy4 - 7 >= source_height - 1 || iy4 + 7 <= 0)) {
+    // Outside the frame vertically.
+    WarpRegion3(src, source_stride, source_height, alpha, beta, x4, ix4, iy4,
+                intermediate_result);
+  } else {
+    // Inside the frame.
+    WarpRegion4(src, source_stride, alpha, beta, x4, ix4, iy4,
+                intermediate_result);
+  }
+  // Region 3 and 4 vertical filter.
+  VerticalFilter<is_compound, bitdepth, DestType>(
+      intermediate_result, y4, gamma, delta, dst_row, dest_stride);
+}
+
+template <bool is_compound, int bitdepth, typename Pixel>
+void Warp_AVX2(const void* LIBGAV1_RESTRICT source, ptrdiff_t source_stride,
+               int source_width, int source_height,
+               const int* LIBGAV1_RESTRICT warp_params, int subsampling_x,
+               int subsampling_y, int block_start_x, int block_start_y,
+               int block_width, int block_height, int16_t alpha, int16_t beta,
+               int16_t gamma, int16_t delta, void* LIBGAV1_RESTRICT dest,
+               ptrdiff_t dest_stride) {
+  const auto* const src = static_cast<const Pixel*>(source);
+  source_stride /= sizeof(Pixel);
+  using DestType =
+      typename std::conditional<is_compound, uint16_t, Pixel>::type;
+  auto* dst = static_cast<DestType*>(dest);
+  if (!is_compound) dest_stride /= sizeof(dst[0]);
+
+  // Warp process applies for each 8x8 block.
+  assert(block_width >= 8);
+  assert(block_height >= 8);
+  const int block_end_x = block_start_x + block_width;
+  const int block_end_y = block_start_y + block_height;
+
+  const int start_x = block_start_x;
+  const int start_y = block_start_y;
+  int src_x = (start_x + 4) << subsampling_x;
+  int src_y = (start_y + 4) << subsampling_y;
+  const int end_x = (block_end_x + 4) << subsampling_x;
+  const int end_y = (block_end_y + 4) << subsampling_y;
+  do {
+    DestType* dst_row = dst;
+    src_x = (start_x + 4) << subsampling_x;
+    do {
+      HandleWarpBlock<is_compound, bitdepth>(
+          src, source_stride, source_width, source_height, warp_params,
+          subsampling_x, subsampling_y, src_x, src_y, alpha, beta, gamma, delta,
+          dst_row, dest_stride);
+      src_x += (8 << subsampling_x);
+      dst_row += 8;
+    } while (src_x < end_x);
+    dst += 8 * dest_stride;
+    src_y += (8 << subsampling_y);
+  } while (src_y < end_y);
+}
+
+}  // namespace
+
+namespace low_bitdepth {
+namespace {
+
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+  dsp->warp = Warp_AVX2</*is_compound=*/false, kBitdepth8, uint8_t>;
+  dsp->warp_compound = Warp_AVX2</*is_compound=*/true, kBitdepth8, uint8_t>;
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+  dsp->warp = Warp_AVX2</*is_compound=*/false, kBitdepth10, uint16_t>;
+  dsp->warp_compound = Warp_AVX2</*is_compound=*/true, kBitdepth10, uint16_t>;
+}
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void WarpInit_AVX2() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif
+}
+
+}  // namespace dsp
+}  // namespace libgav1
+#else   // !LIBGAV1_TARGETING_AVX2
+
+namespace libgav1 {
+namespace dsp {
+
+void WarpInit_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2
@@ -31,10 +31,10 @@
 #include "src/dsp/x86/transpose_sse4.h"
 #include "src/utils/common.h"
 #include "src/utils/constants.h"
+#include "src/utils/memory.h"
 
 namespace libgav1 {
 namespace dsp {
-namespace low_bitdepth {
 namespace {
 
 // Number of extra bits of precision in warped filtering.
@@ -98,13 +98,90 @@ inline void HorizontalFilter(const int sx4, const int16_t alpha,
   StoreUnaligned16(intermediate_result_row, sum);
 }
 
-template <bool is_compound>
+// 10bpp version of HorizontalFilter(). |src_row| holds 16 samples starting at
+// column ix4 - 7. The sums do not fit in 16 bits so no offset is used and the
+// taps are accumulated in 32 bits.
+inline void HorizontalFilter(const int sx4, const int16_t alpha,
+                             const __m128i src_row[2],
+                             int16_t intermediate_result_row[8]) {
+  int sx = sx4 - MultiplyBy4(alpha);
+  __m128i filter[8];
+  for (__m128i& f : filter) {
+    const int offset = RightShiftWithRounding(sx, kWarpedDiffPrecisionBits) +
+                       kWarpedPixelPrecisionShifts;
+    f = LoadUnaligned16(kWarpedFilters[offset]);
+    sx += alpha;
+  }
+  // |filter[k]| now contains tap k for each of the 8 output pixels.
+  Transpose8x8_U16(filter, filter);
+
+  // |src_row_window[k]| contains the samples multiplied by tap k.
+  __m128i src_row_window[8];
+  src_row_window[0] = src_row[0];
+  src_row_window[1] = _mm_alignr_epi8(src_row[1], src_row[0], 2);
+  src_row_window[2] = _mm_alignr_epi8(src_row[1], src_row[0], 4);
+  src_row_window[3] = _mm_alignr_epi8(src_row[1], src_row[0], 6);
+  src_row_window[4] = _mm_alignr_epi8(src_row[1], src_row[0], 8);
+  src_row_window[5] = _mm_alignr_epi8(src_row[1], src_row[0], 10);
+  src_row_window[6] = _mm_alignr_epi8(src_row[1], src_row[0], 12);
+  src_row_window[7] = _mm_alignr_epi8(src_row[1], src_row[0], 14);
+
+  __m128i sum_low = _mm_setzero_si128();
+  __m128i sum_high = _mm_setzero_si128();
+  for (int k = 0; k < 8; k += 2) {
+    const __m128i filters_low = _mm_unpacklo_epi16(filter[k], filter[k + 1]);
+    const __m128i filters_high = _mm_unpackhi_epi16(filter[k], filter[k + 1]);
+    const __m128i src_low =
+        _mm_unpacklo_epi16(src_row_window[k], src_row_window[k + 1]);
+    const __m128i src_high =
+        _mm_unpackhi_epi16(src_row_window[k], src_row_window[k + 1]);
+    sum_low = _mm_add_epi32(sum_low, _mm_madd_epi16(filters_low, src_low));
+    sum_high = _mm_add_epi32(sum_high, _mm_madd_epi16(filters_high, src_high));
+  }
+  sum_low = RightShiftWithRounding_S32(sum_low, kInterRoundBitsHorizontal);
+  sum_high = RightShiftWithRounding_S32(sum_high, kInterRoundBitsHorizontal);
+  StoreUnaligned16(intermediate_result_row,
+                   _mm_packs_epi32(sum_low, sum_high));
+}
+
+template <bool is_compound, int bitdepth>
+inline void StoreVerticalFilterOutput(const __m128i sum_low,
+                                      const __m128i sum_high,
+                                      void* LIBGAV1_RESTRICT dst_row) {
+  if (bitdepth == kBitdepth8) {
+    if (is_compound) {
+      const __m128i sum = _mm_packs_epi32(sum_low, sum_high);
+      StoreUnaligned16(static_cast<int16_t*>(dst_row), sum);
+    } else {
+      const __m128i sum = _mm_packus_epi32(sum_low, sum_high);
+      StoreLo8(static_cast<uint8_t*>(dst_row), _mm_packus_epi16(sum, sum));
+    }
+    return;
+  }
+  if (is_compound) {
+    // The compound range before adding the offset exceeds int16_t, see the
+    // ranges listed in warp.cc.
+    const __m128i compound_offset = _mm_set1_epi32(kCompoundOffset);
+    const __m128i sum =
+        _mm_packus_epi32(_mm_add_epi32(sum_low, compound_offset),
+                         _mm_add_epi32(sum_high, compound_offset));
+    StoreUnaligned16(static_cast<uint16_t*>(dst_row), sum);
+  } else {
+    const __m128i sum = _mm_min_epu16(_mm_packus_epi32(sum_low, sum_high),
+                                      _mm_set1_epi16((1 << bitdepth) - 1));
+    StoreUnaligned16(static_cast<uint16_t*>(dst_row), sum);
+  }
+}
+
+template <bool is_compound, int bitdepth>
 inline void WriteVerticalFilter(const __m128i filter[8],
                                 const int16_t intermediate_result[15][8], int y,
                                 void* LIBGAV1_RESTRICT dst_row) {
   constexpr int kRoundBitsVertical =
       is_compound ? kInterRoundBitsCompoundVertical : kInterRoundBitsVertical;
-  __m128i sum_low = _mm_set1_epi32(kOffsetRemoval);
+  // Only the 8bpp horizontal filter applies |kFirstPassOffset|.
+  __m128i sum_low =
+      _mm_set1_epi32((bitdepth == kBitdepth8) ? kOffsetRemoval : 0);
   __m128i sum_high = sum_low;
   for (int k = 0; k < 8; k += 2) {
     const __m128i filters_low = _mm_unpacklo_epi16(filter[k], filter[k + 1]);
@@ -125,16 +202,10 @@ inline void WriteVerticalFilter(const __m128i filter[8],
   }
   sum_low = RightShiftWithRounding_S32(sum_low, kRoundBitsVertical);
   sum_high = RightShiftWithRounding_S32(sum_high, kRoundBitsVertical);
-  if (is_compound) {
-    const __m128i sum = _mm_packs_epi32(sum_low, sum_high);
-    StoreUnaligned16(static_cast<int16_t*>(dst_row), sum);
-  } else {
-    const __m128i sum = _mm_packus_epi32(sum_low, sum_high);
-    StoreLo8(static_cast<uint8_t*>(dst_row), _mm_packus_epi16(sum, sum));
-  }
+  StoreVerticalFilterOutput<is_compound, bitdepth>(sum_low, sum_high, dst_row);
 }
 
-template <bool is_compound>
+template <bool is_compound, int bitdepth>
 inline void WriteVerticalFilter(const __m128i filter[8],
                                 const int16_t* LIBGAV1_RESTRICT
                                     intermediate_result_column,
@@ -157,16 +228,10 @@ inline void WriteVerticalFilter(const __m128i filter[8],
   }
   sum_low = RightShiftWithRounding_S32(sum_low, kRoundBitsVertical);
   sum_high = RightShiftWithRounding_S32(sum_high, kRoundBitsVertical);
-  if (is_compound) {
-    const __m128i sum = _mm_packs_epi32(sum_low, sum_high);
-    StoreUnaligned16(static_cast<int16_t*>(dst_row), sum);
-  } else {
-    const __m128i sum = _mm_packus_epi32(sum_low, sum_high);
-    StoreLo8(static_cast<uint8_t*>(dst_row), _mm_packus_epi16(sum, sum));
-  }
+  StoreVerticalFilterOutput<is_compound, bitdepth>(sum_low, sum_high, dst_row);
 }
 
-template <bool is_compound, typename DestType>
+template <bool is_compound, int bitdepth, typename DestType>
 inline void VerticalFilter(const int16_t source[15][8], int y4, int gamma,
                            int delta, DestType* LIBGAV1_RESTRICT dest_row,
                            ptrdiff_t dest_stride) {
@@ -181,13 +246,13 @@ inline void VerticalFilter(const int16_t source[15][8], int y4, int gamma,
       sy += gamma;
     }
     Transpose8x8_U16(filter, filter);
-    WriteVerticalFilter<is_compound>(filter, source, y, dest_row);
+    WriteVerticalFilter<is_compound, bitdepth>(filter, source, y, dest_row);
     dest_row += dest_stride;
     sy4 += delta;
   }
 }
 
-template <bool is_compound, typename DestType>
+template <bool is_compound, int bitdepth, typename DestType>
 inline void VerticalFilter(const int16_t* LIBGAV1_RESTRICT source_cols, int y4,
                            int gamma, int delta,
                            DestType* LIBGAV1_RESTRICT dest_row,
@@ -203,21 +268,22 @@ inline void VerticalFilter(const int16_t* LIBGAV1_RESTRICT source_cols, int y4,
       sy += gamma;
     }
     Transpose8x8_U16(filter, filter);
-    WriteVerticalFilter<is_compound>(filter, &source_cols[y], dest_row);
+    WriteVerticalFilter<is_compound, bitdepth>(filter, &source_cols[y],
+                                               dest_row);
     dest_row += dest_stride;
     sy4 += delta;
   }
 }
 
-template <bool is_compound, typename DestType>
-inline void WarpRegion1(const uint8_t* LIBGAV1_RESTRICT src,
+template <bool is_compound, int bitdepth, typename Pixel, typename DestType>
+inline void WarpRegion1(const Pixel* LIBGAV1_RESTRICT src,
                         ptrdiff_t source_stride, int source_width,
                         int source_height, int ix4, int iy4,
                         DestType* LIBGAV1_RESTRICT dst_row,
                         ptrdiff_t dest_stride) {
   // Region 1
   // Points to the left or right border of the first row of |src|.
-  const uint8_t* first_row_border =
+  const Pixel* first_row_border =
       (ix4 + 7 <= 0) ? src : src + source_width - 1;
   // In general, for y in [-7, 8), the row number iy4 + y is clipped:
   //   const int row = Clip3(iy4 + y, 0, source_height - 1);
@@ -229,15 +295,15 @@ inline void WarpRegion1(const uint8_t* LIBGAV1_RESTRICT src,
   // Every sample used to calculate the prediction block has the same
   // value. So the whole prediction block has the same value.
   const int row = (iy4 + 7 <= 0) ? 0 : source_height - 1;
-  const uint8_t row_border_pixel = first_row_border[row * source_stride];
+  const Pixel row_border_pixel = first_row_border[row * source_stride];
 
   if (is_compound) {
-    const __m128i sum =
-        _mm_set1_epi16(row_border_pixel << (kInterRoundBitsVertical -
-                                            kInterRoundBitsCompoundVertical));
-    StoreUnaligned16(dst_row, sum);
+    int sum = row_border_pixel
+              << (kInterRoundBitsVertical - kInterRoundBitsCompoundVertical);
+    sum += (bitdepth == kBitdepth8) ? 0 : kCompoundOffset;
+    StoreUnaligned16(dst_row, _mm_set1_epi16(sum));
   } else {
-    memset(dst_row, row_border_pixel, 8);
+    Memset(dst_row, row_border_pixel, 8);
   }
   const DestType* const first_dst_row = dst_row;
   dst_row += dest_stride;
@@ -247,8 +313,8 @@ inline void WarpRegion1(const uint8_t* LIBGAV1_RESTRICT src,
   }
 }
 
-template <bool is_compound, typename DestType>
-inline void WarpRegion2(const uint8_t* LIBGAV1_RESTRICT src,
+template <bool is_compound, int bitdepth, typename Pixel, typename DestType>
+inline void WarpRegion2(const Pixel* LIBGAV1_RESTRICT src,
                         ptrdiff_t source_stride, int source_width, int y4,
                         int ix4, int iy4, int gamma, int delta,
                         int16_t intermediate_result_column[15],
@@ -256,7 +322,7 @@ inline void WarpRegion2(const uint8_t* LIBGAV1_RESTRICT src,
                         ptrdiff_t dest_stride) {
   // Region 2.
   // Points to the left or right border of the first row of |src|.
-  const uint8_t* first_row_border =
+  const Pixel* first_row_border =
       (ix4 + 7 <= 0) ? src : src + source_width - 1;
   // In general, for y in [-7, 8), the row number iy4 + y is clipped:
   //   const int row = Clip3(iy4 + y, 0, source_height - 1);
@@ -284,12 +350,12 @@ inline void WarpRegion2(const uint8_t* LIBGAV1_RESTRICT src,
     intermediate_result_column[y + 7] = sum;
   }
   // Region 2 vertical filter.
-  VerticalFilter<is_compound, DestType>(intermediate_result_column, y4, gamma,
-                                        delta, dst_row, dest_stride);
+  VerticalFilter<is_compound, bitdepth, DestType>(
+      intermediate_result_column, y4, gamma, delta, dst_row, dest_stride);
 }
 
-template <bool is_compound, typename DestType>
-inline void WarpRegion3(const uint8_t* LIBGAV1_RESTRICT src,
+template <typename Pixel>
+inline void WarpRegion3(const Pixel* LIBGAV1_RESTRICT src,
                         ptrdiff_t source_stride, int source_height, int alpha,
                         int beta, int x4, int ix4, int iy4,
                         int16_t intermediate_result[15][8]) {
@@ -304,25 +370,34 @@ inline void WarpRegion3(const uint8_t* LIBGAV1_RESTRICT src,
   // frame's boundary extension on the top and bottom.
   // Horizontal filter.
   const int row = (iy4 + 7 <= 0) ? 0 : source_height - 1;
-  const uint8_t* const src_row = src + row * source_stride;
+  const Pixel* const src_row = src + row * source_stride;
   // Read 15 samples from &src_row[ix4 - 7]. The 16th sample is also
   // read but is ignored.
   //
-  // NOTE: This may read up to 13 bytes before src_row[0] or up to 14
-  // bytes after src_row[source_width - 1]. We assume the source frame
-  // has left and right borders of at least 13 bytes that extend the
+  // NOTE: This may read up to 13 pixels before src_row[0] or up to 14
+  // pixels after src_row[source_width - 1]. We assume the source frame
+  // has left and right borders of at least 13 pixels that extend the
   // frame boundary pixels. We also assume there is at least one extra
-  // padding byte after the right border of the last source row.
-  const __m128i src_row_v = LoadUnaligned16(&src_row[ix4 - 7]);
+  // padding pixel after the right border of the last source row.
   int sx4 = (x4 & ((1 << kWarpedModelPrecisionBits) - 1)) - beta * 7;
-  for (int y = -7; y < 8; ++y) {
-    HorizontalFilter(sx4, alpha, src_row_v, intermediate_result[y + 7]);
-    sx4 += beta;
+  if (sizeof(Pixel) == 1) {
+    const __m128i src_row_v = LoadUnaligned16(&src_row[ix4 - 7]);
+    for (int y = -7; y < 8; ++y) {
+      HorizontalFilter(sx4, alpha, src_row_v, intermediate_result[y + 7]);
+      sx4 += beta;
+    }
+  } else {
+    const __m128i src_row_v[2] = {LoadUnaligned16(&src_row[ix4 - 7]),
+                                  LoadUnaligned16(&src_row[ix4 + 1])};
+    for (int y = -7; y < 8; ++y) {
+      HorizontalFilter(sx4, alpha, src_row_v, intermediate_result[y + 7]);
+      sx4 += beta;
+    }
   }
 }
 
-template <bool is_compound, typename DestType>
-inline void WarpRegion4(const uint8_t* LIBGAV1_RESTRICT src,
+template <typename Pixel>
+inline void WarpRegion4(const Pixel* LIBGAV1_RESTRICT src,
                         ptrdiff_t source_stride, int alpha, int beta, int x4,
                         int ix4, int iy4, int16_t intermediate_result[15][8]) {
   // Region 4.
@@ -341,24 +416,29 @@ inline void WarpRegion4(const uint8_t* LIBGAV1_RESTRICT src,
     // to 13 pixels below the bottom source row. This is proved in
     // warp.cc.
     const int row = iy4 + y;
-    const uint8_t* const src_row = src + row * source_stride;
+    const Pixel* const src_row = src + row * source_stride;
     // Read 15 samples from &src_row[ix4 - 7]. The 16th sample is also
     // read but is ignored.
     //
-    // NOTE: This may read up to 13 bytes before src_row[0] or up to 14
-    // bytes after src_row[source_width - 1]. We assume the source frame
-    // has left and right borders of at least 13 bytes that extend the
+    // NOTE: This may read up to 13 pixels before src_row[0] or up to 14
+    // pixels after src_row[source_width - 1]. We assume the source frame
+    // has left and right borders of at least 13 pixels that extend the
     // frame boundary pixels. We also assume there is at least one extra
-    // padding byte after the right border of the last source row.
-    const __m128i src_row_v = LoadUnaligned16(&src_row[ix4 - 7]);
-    // Convert src_row_v to int8 (subtract 128).
-    HorizontalFilter(sx4, alpha, src_row_v, intermediate_result[y + 7]);
+    // padding pixel after the right border of the last source row.
+    if (sizeof(Pixel) == 1) {
+      const __m128i src_row_v = LoadUnaligned16(&src_row[ix4 - 7]);
+      HorizontalFilter(sx4, alpha, src_row_v, intermediate_result[y + 7]);
+    } else {
+      const __m128i src_row_v[2] = {LoadUnaligned16(&src_row[ix4 - 7]),
+                                    LoadUnaligned16(&src_row[ix4 + 1])};
+      HorizontalFilter(sx4, alpha, src_row_v, intermediate_result[y + 7]);
+    }
     sx4 += beta;
   }
 }
 
-template <bool is_compound, typename DestType>
-inline void HandleWarpBlock(const uint8_t* LIBGAV1_RESTRICT src,
+template <bool is_compound, int bitdepth, typename Pixel, typename DestType>
+inline void HandleWarpBlock(const Pixel* LIBGAV1_RESTRICT src,
                             ptrdiff_t source_stride, int source_width,
                             int source_height,
                             const int* LIBGAV1_RESTRICT warp_params,
@@ -442,13 +522,13 @@ inline void HandleWarpBlock(const uint8_t* LIBGAV1_RESTRICT src,
   if (ix4 - 7 >= source_width - 1 || ix4 + 7 <= 0) {
     if ((iy4 - 7 >= source_height - 1 || iy4 + 7 <= 0)) {
       // Outside the frame in both directions. One repeated value.
-      WarpRegion1<is_compound, DestType>(src, source_stride, source_width,
+      WarpRegion1<is_compound, bitdepth>(src, source_stride, source_width,
                                          source_height, ix4, iy4, dst_row,
                                          dest_stride);
       return;
     }
     // Outside the frame horizontally. Rows repeated.
-    WarpRegion2<is_compound, DestType>(
+    WarpRegion2<is_compound, bitdepth>(
         src, source_stride, source_width, y4, ix4, iy4, gamma, delta,
         intermediate_result_column, dst_row, dest_stride);
     return;
@@ -456,19 +536,19 @@ inline void HandleWarpBlock(const uint8_t* LIBGAV1_RESTRICT src,
 
   if ((iy4 - 7 >= source_height - 1 || iy4 + 7 <= 0)) {
     // Outside the frame vertically.
-    WarpRegion3<is_compound, DestType>(src, source_stride, source_height, alpha,
-                                       beta, x4, ix4, iy4, intermediate_result);
+    WarpRegion3(src, source_stride, source_height, alpha, beta, x4, ix4, iy4,
+                intermediate_result);
   } else {
     // Inside the frame.
-    WarpRegion4<is_compound, DestType>(src, source_stride, alpha, beta, x4, ix4,
-                                       iy4, intermediate_result);
+    WarpRegion4(src, source_stride, alpha, beta, x4, ix4, iy4,
+                intermediate_result);
   }
   // Region 3 and 4 vertical filter.
-  VerticalFilter<is_compound, DestType>(intermediate_result, y4, gamma, delta,
-                                        dst_row, dest_stride);
+  VerticalFilter<is_compound, bitdepth, DestType>(
+      intermediate_result, y4, gamma, delta, dst_row, dest_stride);
 }
 
-template <bool is_compound>
+template <bool is_compound, int bitdepth, typename Pixel>
 void Warp_SSE4_1(const void* LIBGAV1_RESTRICT source, ptrdiff_t source_stride,
                  int source_width, int source_height,
                  const int* LIBGAV1_RESTRICT warp_params, int subsampling_x,
@@ -476,10 +556,12 @@ void Warp_SSE4_1(const void* LIBGAV1_RESTRICT source, ptrdiff_t source_stride,
                  int block_width, int block_height, int16_t alpha, int16_t beta,
                  int16_t gamma, int16_t delta, void* LIBGAV1_RESTRICT dest,
                  ptrdiff_t dest_stride) {
-  const auto* const src = static_cast<const uint8_t*>(source);
+  const auto* const src = static_cast<const Pixel*>(source);
+  source_stride /= sizeof(Pixel);
   using DestType =
-      typename std::conditional<is_compound, int16_t, uint8_t>::type;
+      typename std::conditional<is_compound, uint16_t, Pixel>::type;
   auto* dst = static_cast<DestType*>(dest);
+  if (!is_compound) dest_stride /= sizeof(dst[0]);
 
   // Warp process applies for each 8x8 block.
   assert(block_width >= 8);
@@ -497,7 +579,7 @@ void Warp_SSE4_1(const void* LIBGAV1_RESTRICT source, ptrdiff_t source_stride,
     DestType* dst_row = dst;
     src_x = (start_x + 4) << subsampling_x;
     do {
-      HandleWarpBlock<is_compound, DestType>(
+      HandleWarpBlock<is_compound, bitdepth>(
           src, source_stride, source_width, source_height, warp_params,
           subsampling_x, subsampling_y, src_x, src_y, alpha, beta, gamma, delta,
           dst_row, dest_stride);
@@ -509,17 +591,43 @@ void Warp_SSE4_1(const void* LIBGAV1_RESTRICT source, ptrdiff_t source_stride,
   } while (src_y < end_y);
 }
 
+}  // namespace
+
+namespace low_bitdepth {
+namespace {
+
 void Init8bpp() {
   Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
   assert(dsp != nullptr);
-  dsp->warp = Warp_SSE4_1</*is_compound=*/false>;
-  dsp->warp_compound = Warp_SSE4_1</*is_compound=*/true>;
+  dsp->warp = Warp_SSE4_1</*is_compound=*/false, kBitdepth8, uint8_t>;
+  dsp->warp_compound = Warp_SSE4_1</*is_compound=*/true, kBitdepth8, uint8_t>;
 }
 
 }  // namespace
 }  // namespace low_bitdepth
 
-void WarpInit_SSE4_1() { low_bitdepth::Init8bpp(); }
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+  dsp->warp = Warp_SSE4_1</*is_compound=*/false, kBitdepth10, uint16_t>;
+  dsp->warp_compound =
+      Warp_SSE4_1</*is_compound=*/true, kBitdepth10, uint16_t>;
+}
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void WarpInit_SSE4_1() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif
+}
 
 }  // namespace dsp
 }  // namespace libgav1
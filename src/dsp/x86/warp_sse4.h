@@ -39,6 +39,14 @@ void WarpInit_SSE4_1();
 #define LIBGAV1_Dsp8bpp_WarpCompound LIBGAV1_CPU_SSE4_1
 #endif
 
+#ifndef LIBGAV1_Dsp10bpp_Warp
+#define LIBGAV1_Dsp10bpp_Warp LIBGAV1_CPU_SSE4_1
+#endif
+
+#ifndef LIBGAV1_Dsp10bpp_WarpCompound
+#define LIBGAV1_Dsp10bpp_WarpCompound LIBGAV1_CPU_SSE4_1
+#endif
+
 #endif  // LIBGAV1_TARGETING_SSE4_1
 
 #endif  // LIBGAV1_SRC_DSP_X86_WARP_SSE4_H_
@@ -0,0 +1,324 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/dsp/weight_mask.h"
+#include "src/utils/cpu.h"
+
+#if LIBGAV1_TARGETING_AVX2
+
+#include <immintrin.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "src/dsp/constants.h"
+#include "src/dsp/dsp.h"
+#include "src/dsp/x86/common_avx2.h"
+#include "src/utils/common.h"
+
+namespace libgav1 {
+namespace dsp {
+namespace {
+
+// Converts 32 scaled differences, given as two vectors of 16-bit lanes, to
+// mask values in memory order.
+template <bool mask_is_inverse>
+inline __m256i GetMask32(const __m256i scaled_difference_0,
+                         const __m256i scaled_difference_1) {
+  const __m256i difference_offset = _mm256_set1_epi8(38);
+  const __m256i mask_ceiling = _mm256_set1_epi8(64);
+  const __m256i packed_difference = _mm256_permute4x64_epi64(
+      _mm256_packus_epi16(scaled_difference_0, scaled_difference_1), 0xd8);
+  const __m256i adjusted_difference =
+      _mm256_adds_epu8(packed_difference, difference_offset);
+  const __m256i mask_value = _mm256_min_epu8(adjusted_difference, mask_ceiling);
+  if (mask_is_inverse) {
+    return _mm256_sub_epi8(mask_ceiling, mask_value);
+  }
+  return mask_value;
+}
+
+// The predictions are stored contiguously with a stride of |width|, so each
+// 32 values cover 4 rows of an 8-wide block or 2 rows of a 16-wide block.
+template <int width, int height, typename PredType, bool mask_is_inverse,
+          __m256i (*scaled_difference16)(const PredType*, const PredType*)>
+inline void ComputeWeightMask(const PredType* LIBGAV1_RESTRICT pred_0,
+                              const PredType* LIBGAV1_RESTRICT pred_1,
+                              uint8_t* LIBGAV1_RESTRICT mask,
+                              const ptrdiff_t mask_stride) {
+  static_assert(width >= 8, "");
+  static_assert(height >= 8, "");
+  if (width == 8) {
+    int y = height;
+    do {
+      const __m256i mask_value = GetMask32<mask_is_inverse>(
+          scaled_difference16(pred_0, pred_1),
+          scaled_difference16(pred_0 + 16, pred_1 + 16));
+      const __m128i mask_lo = _mm256_castsi256_si128(mask_value);
+      const __m128i mask_hi = _mm256_extracti128_si256(mask_value, 1);
+      StoreLo8(mask, mask_lo);
+      StoreHi8(mask + mask_stride, mask_lo);
+      StoreLo8(mask + 2 * mask_stride, mask_hi);
+      StoreHi8(mask + 3 * mask_stride, mask_hi);
+      pred_0 += 32;
+      pred_1 += 32;
+      mask += mask_stride << 2;
+      y -= 4;
+    } while (y != 0);
+    return;
+  }
+  if (width == 16) {
+    int y = height;
+    do {
+      const __m256i mask_value = GetMask32<mask_is_inverse>(
+          scaled_difference16(pred_0, pred_1),
+          scaled_difference16(pred_0 + 16, pred_1 + 16));
+      StoreUnaligned16(mask, _mm256_castsi256_si128(mask_value));
+      StoreUnaligned16(mask + mask_stride,
+                       _mm256_extracti128_si256(mask_value, 1));
+      pred_0 += 32;
+      pred_1 += 32;
+      mask += mask_stride << 1;
+      y -= 2;
+    } while (y != 0);
+    return;
+  }
+  int y = height;
+  do {
+    int x = 0;
+    do {
+      StoreUnaligned32(
+          mask + x, GetMask32<mask_is_inverse>(
+                        scaled_difference16(pred_0 + x, pred_1 + x),
+                        scaled_difference16(pred_0 + x + 16, pred_1 + x + 16)));
+      x += 32;
+    } while (x < width);
+    pred_0 += width;
+    pred_1 += width;
+    mask += mask_stride;
+  } while (--y != 0);
+}
+
+}  // namespace
+
+namespace low_bitdepth {
+namespace {
+
+constexpr int kRoundingBits8bpp = 4;
+constexpr int kScaledDiffShift = 4;
+
+// RightShiftWithRounding(abs(pred_0 - pred_1), 4) >> 4.
+inline __m256i ScaledDifference16(
+    const int16_t* LIBGAV1_RESTRICT prediction_0,
+    const int16_t* LIBGAV1_RESTRICT prediction_1) {
+  const __m256i pred_0 = LoadUnaligned32(prediction_0);
+  const __m256i pred_1 = LoadUnaligned32(prediction_1);
+  const __m256i difference = _mm256_abs_epi16(_mm256_sub_epi16(pred_0, pred_1));
+  const __m256i round = _mm256_set1_epi16((1 << kRoundingBits8bpp) >> 1);
+  return _mm256_srli_epi16(_mm256_add_epi16(difference, round),
+                           kRoundingBits8bpp + kScaledDiffShift);
+}
+
+template <int width, int height, bool mask_is_inverse>
+void WeightMask_AVX2(const void* LIBGAV1_RESTRICT prediction_0,
+                     const void* LIBGAV1_RESTRICT prediction_1,
+                     uint8_t* LIBGAV1_RESTRICT mask, ptrdiff_t mask_stride) {
+  ComputeWeightMask<width, height, int16_t, mask_is_inverse,
+                    ScaledDifference16>(
+      static_cast<const int16_t*>(prediction_0),
+      static_cast<const int16_t*>(prediction_1), mask, mask_stride);
+}
+
+#define INIT_WEIGHT_MASK_8BPP(width, height, w_index, h_index) \
+  dsp->weight_mask[w_index][h_index][0] =                      \
+      WeightMask_AVX2<width, height, false>;                   \
+  dsp->weight_mask[w_index][h_index][1] = WeightMask_AVX2<width, height, true>
+void Init8bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth8);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_8x8)
+  INIT_WEIGHT_MASK_8BPP(8, 8, 0, 0);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_8x16)
+  INIT_WEIGHT_MASK_8BPP(8, 16, 0, 1);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_8x32)
+  INIT_WEIGHT_MASK_8BPP(8, 32, 0, 2);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_16x8)
+  INIT_WEIGHT_MASK_8BPP(16, 8, 1, 0);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_16x16)
+  INIT_WEIGHT_MASK_8BPP(16, 16, 1, 1);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_16x32)
+  INIT_WEIGHT_MASK_8BPP(16, 32, 1, 2);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_16x64)
+  INIT_WEIGHT_MASK_8BPP(16, 64, 1, 3);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_32x8)
+  INIT_WEIGHT_MASK_8BPP(32, 8, 2, 0);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_32x16)
+  INIT_WEIGHT_MASK_8BPP(32, 16, 2, 1);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_32x32)
+  INIT_WEIGHT_MASK_8BPP(32, 32, 2, 2);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_32x64)
+  INIT_WEIGHT_MASK_8BPP(32, 64, 2, 3);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_64x16)
+  INIT_WEIGHT_MASK_8BPP(64, 16, 3, 1);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_64x32)
+  INIT_WEIGHT_MASK_8BPP(64, 32, 3, 2);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_64x64)
+  INIT_WEIGHT_MASK_8BPP(64, 64, 3, 3);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_64x128)
+  INIT_WEIGHT_MASK_8BPP(64, 128, 3, 4);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_128x64)
+  INIT_WEIGHT_MASK_8BPP(128, 64, 4, 3);
+#endif
+#if DSP_ENABLED_8BPP_AVX2(WeightMask_128x128)
+  INIT_WEIGHT_MASK_8BPP(128, 128, 4, 4);
+#endif
+}
+
+}  // namespace
+}  // namespace low_bitdepth
+
+#if LIBGAV1_MAX_BITDEPTH >= 10
+namespace high_bitdepth {
+namespace {
+
+constexpr int kRoundingBits10bpp = 6;
+constexpr int kScaledDiffShift = 4;
+
+// RightShiftWithRounding(abs(pred_0 - pred_1), 6) >> 4. The predictions are
+// unsigned 16-bit values in [3988, 61532], so the difference and the rounded
+// sum stay within 16 bits.
+inline __m256i ScaledDifference16(
+    const uint16_t* LIBGAV1_RESTRICT prediction_0,
+    const uint16_t* LIBGAV1_RESTRICT prediction_1) {
+  const __m256i pred_0 = LoadUnaligned32(prediction_0);
+  const __m256i pred_1 = LoadUnaligned32(prediction_1);
+  const __m256i difference = _mm256_sub_epi16(
+      _mm256_max_epu16(pred_0, pred_1), _mm256_min_epu16(pred_0, pred_1));
+  const __m256i round = _mm256_set1_epi16((1 << kRoundingBits10bpp) >> 1);
+  return _mm256_srli_epi16(_mm256_add_epi16(difference, round),
+                           kRoundingBits10bpp + kScaledDiffShift);
+}
+
+template <int width, int height, bool mask_is_inverse>
+void WeightMask10bpp_AVX2(const void* LIBGAV1_RESTRICT prediction_0,
+                          const void* LIBGAV1_RESTRICT prediction_1,
+                          uint8_t* LIBGAV1_RESTRICT mask,
+                          ptrdiff_t mask_stride) {
+  ComputeWeightMask<width, height, uint16_t, mask_is_inverse,
+                    ScaledDifference16>(
+      static_cast<const uint16_t*>(prediction_0),
+      static_cast<const uint16_t*>(prediction_1), mask, mask_stride);
+}
+
+#define INIT_WEIGHT_MASK_10BPP(width, height, w_index, h_index) \
+  dsp->weight_mask[w_index][h_index][0] =                       \
+      WeightMask10bpp_AVX2<width, height, false>;               \
+  dsp->weight_mask[w_index][h_index][1] =                       \
+      WeightMask10bpp_AVX2<width, height, true>
+void Init10bpp() {
+  Dsp* const dsp = dsp_internal::GetWritableDspTable(kBitdepth10);
+  assert(dsp != nullptr);
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_8x8)
+  INIT_WEIGHT_MASK_10BPP(8, 8, 0, 0);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_8x16)
+  INIT_WEIGHT_MASK_10BPP(8, 16, 0, 1);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_8x32)
+  INIT_WEIGHT_MASK_10BPP(8, 32, 0, 2);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_16x8)
+  INIT_WEIGHT_MASK_10BPP(16, 8, 1, 0);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_16x16)
+  INIT_WEIGHT_MASK_10BPP(16, 16, 1, 1);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_16x32)
+  INIT_WEIGHT_MASK_10BPP(16, 32, 1, 2);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_16x64)
+  INIT_WEIGHT_MASK_10BPP(16, 64, 1, 3);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_32x8)
+  INIT_WEIGHT_MASK_10BPP(32, 8, 2, 0);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_32x16)
+  INIT_WEIGHT_MASK_10BPP(32, 16, 2, 1);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_32x32)
+  INIT_WEIGHT_MASK_10BPP(32, 32, 2, 2);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_32x64)
+  INIT_WEIGHT_MASK_10BPP(32, 64, 2, 3);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_64x16)
+  INIT_WEIGHT_MASK_10BPP(64, 16, 3, 1);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_64x32)
+  INIT_WEIGHT_MASK_10BPP(64, 32, 3, 2);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_64x64)
+  INIT_WEIGHT_MASK_10BPP(64, 64, 3, 3);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_64x128)
+  INIT_WEIGHT_MASK_10BPP(64, 128, 3, 4);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_128x64)
+  INIT_WEIGHT_MASK_10BPP(128, 64, 4, 3);
+#endif
+#if DSP_ENABLED_10BPP_AVX2(WeightMask_128x128)
+  INIT_WEIGHT_MASK_10BPP(128, 128, 4, 4);
+#endif
+}
+
+}  // namespace
+}  // namespace high_bitdepth
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
+void WeightMaskInit_AVX2() {
+  low_bitdepth::Init8bpp();
+#if LIBGAV1_MAX_BITDEPTH >= 10
+  high_bitdepth::Init10bpp();
+#endif
+}
+
+}  // namespace dsp
+}  // namespace libgav1
+
+#else   // !LIBGAV1_TARGETING_AVX2
+
+namespace libgav1 {
+namespace dsp {
+
+void WeightMaskInit_AVX2() {}
+
+}  // namespace dsp
+}  // namespace libgav1
+#endif  // LIBGAV1_TARGETING_AVX2
@@ -747,25 +747,25 @@ bool FilmGrain<bitdepth>::AddNoise(
       const int num_workers = thread_pool_->num_threads();
       BlockingCounter pending_workers(num_workers);
       std::atomic<int> job_counter(0);
+      // The jobs capture |blend_chroma| by reference so that they fit in the
+      // inline storage of Task.
+      const auto blend_chroma = [&]() {
+        BlendNoiseChromaWorker(dsp, planes_to_blend, num_planes, &job_counter,
+                               min_value, max_chroma, source_plane_y,
+                               source_stride_y, source_plane_u, source_plane_v,
+                               source_stride_uv, dest_plane_u, dest_plane_v,
+                               dest_stride_uv);
+      };
       for (int i = 0; i < num_workers; ++i) {
-        thread_pool_->Schedule([this, dsp, &pending_workers, &planes_to_blend,
-                                num_planes, &job_counter, min_value, max_chroma,
-                                source_plane_y, source_stride_y, source_plane_u,
-                                source_plane_v, source_stride_uv, dest_plane_u,
-                                dest_plane_v, dest_stride_uv]() {
-          BlendNoiseChromaWorker(dsp, planes_to_blend, num_planes, &job_counter,
-                                 min_value, max_chroma, source_plane_y,
-                                 source_stride_y, source_plane_u,
-                                 source_plane_v, source_stride_uv, dest_plane_u,
-                                 dest_plane_v, dest_stride_uv);
+        thread_pool_->Schedule([&blend_chroma, &pending_workers]() {
+          blend_chroma();
           pending_workers.Decrement();
         });
       }
-      BlendNoiseChromaWorker(
-          dsp, planes_to_blend, num_planes, &job_counter, min_value, max_chroma,
-          source_plane_y, source_stride_y, source_plane_u, source_plane_v,
-          source_stride_uv, dest_plane_u, dest_plane_v, dest_stride_uv);
+      blend_chroma();
 
+      // A nested thread pool may have no free threads to run the jobs.
+      thread_pool_->RunJobsUntilIdle();
       pending_workers.Wait();
     } else {
       // Single threaded.
@@ -790,20 +790,19 @@ bool FilmGrain<bitdepth>::AddNoise(
       const int num_workers = thread_pool_->num_threads();
       BlockingCounter pending_workers(num_workers);
       std::atomic<int> job_counter(0);
+      const auto blend_luma = [&]() {
+        BlendNoiseLumaWorker(dsp, &job_counter, min_value, max_luma,
+                             source_plane_y, source_stride_y, dest_plane_y,
+                             dest_stride_y);
+      };
       for (int i = 0; i < num_workers; ++i) {
-        thread_pool_->Schedule(
-            [this, dsp, &pending_workers, &job_counter, min_value, max_luma,
-             source_plane_y, source_stride_y, dest_plane_y, dest_stride_y]() {
-              BlendNoiseLumaWorker(dsp, &job_counter, min_value, max_luma,
-                                   source_plane_y, source_stride_y,
-                                   dest_plane_y, dest_stride_y);
-              pending_workers.Decrement();
-            });
+        thread_pool_->Schedule([&blend_luma, &pending_workers]() {
+          blend_luma();
+          pending_workers.Decrement();
+        });
       }
-
-      BlendNoiseLumaWorker(dsp, &job_counter, min_value, max_luma,
-                           source_plane_y, source_stride_y, dest_plane_y,
-                           dest_stride_y);
+      blend_luma();
+      thread_pool_->RunJobsUntilIdle();
       pending_workers.Wait();
     } else {
       dsp.film_grain.blend_noise_luma(
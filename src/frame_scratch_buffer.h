@@ -19,6 +19,7 @@
 
 #include <array>
 #include <condition_variable>  // NOLINT (unapproved c++11 header)
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <mutex>  // NOLINT (unapproved c++11 header)
@@ -47,6 +48,15 @@ namespace libgav1 {
 using IntraPredictionBuffer =
     std::array<AlignedDynamicBuffer<uint8_t, kMaxAlignment>, kMaxPlanes>;
 
+// The state of a 64x64 unit row in the multi-threaded post filter.
+struct PostFilterRowState {
+  // The next filter stage to be applied to the unit row. This is a
+  // PostFilter::Stage value.
+  uint8_t next_stage;
+  // True if the next stage is in the ready queue or is being applied.
+  bool scheduled;
+};
+
 // Buffer to facilitate decoding a frame. This struct is used only within
 // DecoderImpl::DecodeTiles().
 // The alignment requirement is due to the SymbolDecoderContext member
@@ -84,6 +94,11 @@ struct FrameScratchBuffer : public MaxAlignedAllocable {
   // subsampling). The indices of the rows that are stored are specified in
   // |kLoopRestorationBorderRows|.
   YuvBuffer loop_restoration_border;
+  // The size of these buffers is the number of 64x64 unit rows. They are used
+  // by the multi-threaded post filter to track the progress of each unit row
+  // and must be resized before the PostFilter is created.
+  DynamicBuffer<PostFilterRowState> post_filter_row_states;
+  DynamicBuffer<int> post_filter_ready_rows;
   // The size of this dynamic buffer is |tile_rows|.
   DynamicBuffer<IntraPredictionBuffer> intra_prediction_buffers;
   TileScratchBufferPool tile_scratch_buffer_pool;
@@ -100,6 +115,10 @@ struct FrameScratchBuffer : public MaxAlignedAllocable {
   DynamicBuffer<std::condition_variable> superblock_row_progress_condvar;
   // Used to signal tile decoding failure in the combined multithreading mode.
   bool tile_decoding_failed LIBGAV1_GUARDED_BY(superblock_row_mutex);
+  // The estimated size in bytes of the buffers above that grow with the frame
+  // dimensions, as accounted in the memory usage of the decoder. It only grows,
+  // like the buffers.
+  size_t accounted_size = 0;
 };
 
 class FrameScratchBufferPool {
@@ -57,6 +57,12 @@ LIBGAV1_PUBLIC Libgav1StatusCode Libgav1DecoderDequeueFrame(
 LIBGAV1_PUBLIC Libgav1StatusCode
 Libgav1DecoderSignalEOS(Libgav1Decoder* decoder);
 
+LIBGAV1_PUBLIC Libgav1StatusCode Libgav1DecoderReset(
+    Libgav1Decoder* decoder, const Libgav1DecoderSettings* settings);
+
+LIBGAV1_PUBLIC Libgav1StatusCode Libgav1DecoderGetMemoryUsage(
+    const Libgav1Decoder* decoder, size_t* current_bytes, size_t* peak_bytes);
+
 LIBGAV1_PUBLIC int Libgav1DecoderGetMaxBitdepth(void);
 
 #if defined(__cplusplus)
@@ -133,6 +139,30 @@ class LIBGAV1_PUBLIC Decoder {
   // and the decoder is ready to start decoding a new coded video sequence.
   StatusCode SignalEOS();
 
+  // Prepares the decoder for a new, unrelated stream. Discards the enqueued
+  // frames (releasing their input buffers), the reference frames, the output
+  // frames and the sequence header, and switches to |settings| (or keeps the
+  // current settings if |settings| is nullptr).
+  //
+  // The thread pools, frame buffers and scratch buffers are kept if the new
+  // settings only differ from the current ones in blocking_dequeue,
+  // release_input_buffer, output_all_layers, operating_point and
+  // post_filter_mask. Otherwise, and if the decoder is in an error state, the
+  // decoder is recreated as if by Init(). In frame parallel mode, this call
+  // waits until the frames being decoded are done.
+  //
+  // As with SignalEOS(), the pointer obtained by the prior DequeueFrame() call
+  // is no longer valid after this call. Returns kStatusOk on success, an error
+  // status otherwise.
+  StatusCode Reset(const DecoderSettings* settings);
+
+  // Sets |*current_bytes| to the number of bytes currently held by the frame
+  // buffers and scratch buffers of the decoder, and |*peak_bytes| to the
+  // largest such value since Init() or the last SignalEOS() call. Frame buffers
+  // allocated by the application callbacks are not included. Either pointer
+  // may be nullptr.
+  StatusCode GetMemoryUsage(size_t* current_bytes, size_t* peak_bytes) const;
+
   // Returns the maximum bitdepth that is supported by this decoder.
   static int GetMaxBitdepth();
 
@@ -18,8 +18,10 @@
 #define LIBGAV1_SRC_GAV1_DECODER_SETTINGS_H_
 
 #if defined(__cplusplus)
+#include <cstddef>
 #include <cstdint>
 #else
+#include <stddef.h>
 #include <stdint.h>
 #endif  // defined(__cplusplus)
 
@@ -40,10 +42,35 @@ extern "C" {
 typedef void (*Libgav1ReleaseInputBufferCallback)(void* callback_private_data,
                                                   void* buffer_private_data);
 
+// Runs a job passed to Libgav1ScheduleJobCallback.
+typedef void (*Libgav1RunJobFunction)(void* job);
+
+// This callback is invoked by the decoder to run a job on an executor owned by
+// the application. The application must call |run_job|(|job|) exactly once, on
+// any thread, either before returning or later.
+//
+// Jobs may block until other jobs of the same decoder have run, so the
+// executor must be able to run |threads| - 1 jobs of each decoder concurrently.
+typedef void (*Libgav1ScheduleJobCallback)(void* executor_private_data,
+                                           Libgav1RunJobFunction run_job,
+                                           void* job);
+
+typedef enum Libgav1CpuAffinityPolicy {
+  // The decoder threads are not pinned.
+  kLibgav1CpuAffinityNone,
+  // The decoder threads may run on any CPU listed in |affinity_cpus|.
+  kLibgav1CpuAffinityCpuSet,
+  // Each decoder thread is pinned to one CPU, using the CPUs available to the
+  // process in order.
+  kLibgav1CpuAffinityCompact,
+  // The decoder threads may run on any CPU of the NUMA node |numa_node|.
+  kLibgav1CpuAffinityNumaNode
+} Libgav1CpuAffinityPolicy;
+
 typedef struct Libgav1DecoderSettings {
   // Number of threads to use when decoding. Must be greater than 0. The library
-  // will create at most |threads| new threads. Defaults to 1 (no new threads
-  // will be created).
+  // will create at most |threads| new threads, except with adaptive_threading
+  // (see below). Defaults to 1 (no new threads will be created).
   int threads;
   // A boolean. Indicate to the decoder that frame parallel decoding is allowed.
   // Note that this is just a request and the decoder will decide the number of
@@ -83,6 +110,72 @@ typedef struct Libgav1DecoderSettings {
   //   Bit 4: Film grain synthesis.
   //   All the bits other than the last 5 are ignored.
   uint8_t post_filter_mask;
+  // If not NULL, the tile, superblock row, post filter and film grain jobs are
+  // run through this callback instead of threads created by the decoder. This
+  // lets several decoders share one thread pool. |threads| still sets the
+  // number of jobs the work is split into. In frame parallel mode, the decoder
+  // still creates one thread for each frame decoded in parallel.
+  Libgav1ScheduleJobCallback schedule_job;
+  // Passed as the executor_private_data argument to |schedule_job|.
+  void* executor_private_data;
+  // Placement of the threads created by the decoder. Internal frame buffers
+  // are first touched from the same CPUs, so that on NUMA systems their memory
+  // is allocated on the node of the threads that process them. Only supported
+  // on Linux; ignored elsewhere.
+  Libgav1CpuAffinityPolicy affinity_policy;
+  // The CPUs used by kLibgav1CpuAffinityCpuSet. Only read by
+  // Libgav1DecoderCreate().
+  const int* affinity_cpus;
+  int num_affinity_cpus;
+  // The NUMA node used by kLibgav1CpuAffinityNumaNode. If negative, the node
+  // of the thread calling Libgav1DecoderCreate() is used.
+  int numa_node;
+  // A boolean. In frame parallel mode, measure the time spent parsing,
+  // reconstructing and post filtering each frame, and use it to rebalance the
+  // threads between decoding more frames in parallel and using more threads
+  // within each frame. This may improve the throughput of streams whose tile
+  // layout or use of the post filters changes. The decoder may keep more
+  // than |threads| threads alive, but at most |threads| of them run decoding
+  // jobs at any time: a frame starts decoding only when its threads fit in
+  // |threads| along with those of the frames already being decoded.
+  //
+  // If frame_parallel is 0, this setting is ignored.
+  int adaptive_threading;
+  // A boolean. In frame parallel mode, put the threads that are not frame
+  // threads in one pool shared by all the frames being decoded, instead of
+  // dividing them between the frames. A frame that needs fewer threads than
+  // its share, for example because it has few tiles or is waiting for its
+  // reference frames, then leaves them to the other frames.
+  //
+  // If frame_parallel is 0, this setting is ignored. If it is 1,
+  // adaptive_threading is ignored.
+  int share_threads_between_frames;
+  // The limits of the streams that will be decoded. If max_frame_width and
+  // max_frame_height are both greater than 0, Libgav1DecoderCreate() allocates
+  // the internal frame buffers and the scratch buffers needed to decode frames
+  // of up to that size, with a bitdepth of up to max_bitdepth, the chroma
+  // format image_format and up to max_tile_count tiles, and writes to their
+  // pages. Decoding such frames then does not need to grow these buffers.
+  // Larger frames are still decoded, but the buffers are grown as needed.
+  // If get_frame_buffer is not NULL, on_frame_buffer_size_changed (if not
+  // NULL) is called with the limits instead of allocating frame buffers.
+  int max_frame_width;
+  int max_frame_height;
+  int max_bitdepth;
+  Libgav1ImageFormat image_format;
+  int max_tile_count;
+  // If 1, the internal frame buffers (used when get_frame_buffer is NULL) are
+  // backed by 2MB transparent huge pages where the operating system supports
+  // them. Regular pages are used otherwise. Only supported on Linux.
+  int use_huge_pages;
+  // Upper bound, in bytes, on the memory that the decoder plans for its frame
+  // buffers and per frame scratch buffers. 0 means no limit. In frame parallel
+  // mode, fewer frames are decoded at the same time (EnqueueFrame() returns
+  // kLibgav1StatusTryAgain earlier) so that the estimated memory of the frames
+  // in flight fits in the budget. At least one frame is always decoded, even
+  // if that exceeds the budget. Libgav1DecoderGetMemoryUsage() reports the
+  // memory actually used.
+  size_t memory_budget;
 } Libgav1DecoderSettings;
 
 LIBGAV1_PUBLIC void Libgav1DecoderSettingsInitDefault(
@@ -94,12 +187,20 @@ LIBGAV1_PUBLIC void Libgav1DecoderSettingsInitDefault(
 namespace libgav1 {
 
 using ReleaseInputBufferCallback = Libgav1ReleaseInputBufferCallback;
+using RunJobFunction = Libgav1RunJobFunction;
+using ScheduleJobCallback = Libgav1ScheduleJobCallback;
+
+using CpuAffinityPolicy = Libgav1CpuAffinityPolicy;
+constexpr CpuAffinityPolicy kCpuAffinityNone = kLibgav1CpuAffinityNone;
+constexpr CpuAffinityPolicy kCpuAffinityCpuSet = kLibgav1CpuAffinityCpuSet;
+constexpr CpuAffinityPolicy kCpuAffinityCompact = kLibgav1CpuAffinityCompact;
+constexpr CpuAffinityPolicy kCpuAffinityNumaNode = kLibgav1CpuAffinityNumaNode;
 
 // Applications must populate this structure before creating a decoder instance.
 struct DecoderSettings {
   // Number of threads to use when decoding. Must be greater than 0. The library
-  // will create at most |threads| new threads. Defaults to 1 (no new threads
-  // will be created).
+  // will create at most |threads| new threads, except with adaptive_threading
+  // (see below). Defaults to 1 (no new threads will be created).
   int threads = 1;
   // Indicate to the decoder that frame parallel decoding is allowed. Note that
   // this is just a request and the decoder will decide the number of frames to
@@ -139,6 +240,71 @@ struct DecoderSettings {
   //   Bit 4: Film grain synthesis.
   //   All the bits other than the last 5 are ignored.
   uint8_t post_filter_mask = 0x1f;
+  // If not nullptr, the tile, superblock row, post filter and film grain jobs
+  // are run through this callback instead of threads created by the decoder.
+  // This lets several decoders share one thread pool. |threads| still sets the
+  // number of jobs the work is split into. In frame parallel mode, the decoder
+  // still creates one thread for each frame decoded in parallel.
+  ScheduleJobCallback schedule_job = nullptr;
+  // Passed as the executor_private_data argument to |schedule_job|.
+  void* executor_private_data = nullptr;
+  // Placement of the threads created by the decoder. Internal frame buffers
+  // are first touched from the same CPUs, so that on NUMA systems their memory
+  // is allocated on the node of the threads that process them. Only supported
+  // on Linux; ignored elsewhere.
+  CpuAffinityPolicy affinity_policy = kCpuAffinityNone;
+  // The CPUs used by kCpuAffinityCpuSet. Only read by Decoder::Init().
+  const int* affinity_cpus = nullptr;
+  int num_affinity_cpus = 0;
+  // The NUMA node used by kCpuAffinityNumaNode. If negative, the node of the
+  // thread calling Decoder::Init() is used.
+  int numa_node = -1;
+  // In frame parallel mode, measure the time spent parsing, reconstructing and
+  // post filtering each frame, and use it to rebalance the threads between
+  // decoding more frames in parallel and using more threads within each frame.
+  // This may improve the throughput of streams whose tile layout or use of the
+  // post filters changes. The decoder may keep more than |threads| threads
+  // alive, but at most |threads| of them run decoding jobs at any time: a frame
+  // starts decoding only when its threads fit in |threads| along with those of
+  // the frames already being decoded.
+  //
+  // If frame_parallel is false, this setting is ignored.
+  bool adaptive_threading = false;
+  // In frame parallel mode, put the threads that are not frame threads in one
+  // pool shared by all the frames being decoded, instead of dividing them
+  // between the frames. A frame that needs fewer threads than its share, for
+  // example because it has few tiles or is waiting for its reference frames,
+  // then leaves them to the other frames.
+  //
+  // If frame_parallel is false, this setting is ignored. If it is true,
+  // adaptive_threading is ignored.
+  bool share_threads_between_frames = false;
+  // The limits of the streams that will be decoded. If max_frame_width and
+  // max_frame_height are both greater than 0, Decoder::Init() allocates the
+  // internal frame buffers and the scratch buffers needed to decode frames of
+  // up to that size, with a bitdepth of up to max_bitdepth, the chroma format
+  // image_format and up to max_tile_count tiles, and writes to their pages.
+  // Decoding such frames then does not need to grow these buffers. Larger
+  // frames are still decoded, but the buffers are grown as needed. If
+  // get_frame_buffer is not nullptr, on_frame_buffer_size_changed (if not
+  // nullptr) is called with the limits instead of allocating frame buffers.
+  int max_frame_width = 0;
+  int max_frame_height = 0;
+  int max_bitdepth = 8;
+  ImageFormat image_format = kImageFormatYuv420;
+  int max_tile_count = 1;
+  // If true, the internal frame buffers (used when get_frame_buffer is nullptr)
+  // are backed by 2MB transparent huge pages where the operating system
+  // supports them. Regular pages are used otherwise. Only supported on Linux.
+  bool use_huge_pages = false;
+  // Upper bound, in bytes, on the memory that the decoder plans for its frame
+  // buffers and per frame scratch buffers. 0 means no limit. In frame parallel
+  // mode, fewer frames are decoded at the same time (EnqueueFrame() returns
+  // kStatusTryAgain earlier) so that the estimated memory of the frames in
+  // flight fits in the budget. At least one frame is always decoded, even if
+  // that exceeds the budget. Decoder::GetMemoryUsage() reports the memory
+  // actually used.
+  size_t memory_budget = 0;
 };
 
 }  // namespace libgav1
@@ -14,8 +14,13 @@
 
 #include "src/internal_frame_buffer_list.h"
 
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
 #include <cassert>
 #include <cstdint>
+#include <cstdlib>
 #include <memory>
 #include <new>
 #include <utility>
@@ -56,6 +61,15 @@ void ReleaseInternalFrameBuffer(void* callback_private_data,
 
 }  // extern "C"
 
+constexpr size_t InternalFrameBufferList::kHugePageSize;
+
+InternalFrameBufferList::~InternalFrameBufferList() {
+  if (memory_usage_ == nullptr) return;
+  for (const auto& buffer_ptr : buffers_) {
+    memory_usage_->Subtract(buffer_ptr->size);
+  }
+}
+
 StatusCode InternalFrameBufferList::OnFrameBufferSizeChanged(
     int /*bitdepth*/, Libgav1ImageFormat /*image_format*/, int /*width*/,
     int /*height*/, int /*left_border*/, int /*right_border*/,
@@ -95,11 +109,10 @@ StatusCode InternalFrameBufferList::GetFrameBuffer(
   }
 
   if (buffer->size < min_size) {
-    std::unique_ptr<uint8_t[], MallocDeleter> new_data(
-        static_cast<uint8_t*>(malloc(min_size)));
+    std::unique_ptr<uint8_t[], MallocDeleter> new_data =
+        AllocateData(min_size);
     if (new_data == nullptr) return kStatusOutOfMemory;
-    buffer->data = std::move(new_data);
-    buffer->size = min_size;
+    SetData(buffer, std::move(new_data), min_size);
   }
 
   uint8_t* const y_buffer = buffer->data.get();
@@ -114,6 +127,86 @@ StatusCode InternalFrameBufferList::GetFrameBuffer(
   return kStatusOk;
 }
 
+StatusCode InternalFrameBufferList::Preallocate(
+    int num_buffers, int bitdepth, Libgav1ImageFormat image_format, int width,
+    int height, int left_border, int right_border, int top_border,
+    int bottom_border, int stride_alignment) {
+  FrameBufferInfo info;
+  const StatusCode status = ComputeFrameBufferInfo(
+      bitdepth, image_format, width, height, left_border, right_border,
+      top_border, bottom_border, stride_alignment, &info);
+  if (status != kStatusOk) return status;
+
+  if (info.uv_buffer_size > SIZE_MAX / 2 ||
+      info.y_buffer_size > SIZE_MAX - 2 * info.uv_buffer_size) {
+    return kStatusInvalidArgument;
+  }
+  const size_t min_size = info.y_buffer_size + 2 * info.uv_buffer_size;
+
+  int num_free_buffers = 0;
+  for (const auto& buffer_ptr : buffers_) {
+    if (!buffer_ptr->in_use) ++num_free_buffers;
+  }
+  if (num_free_buffers < num_buffers &&
+      !buffers_.reserve(buffers_.size() + num_buffers - num_free_buffers)) {
+    return kStatusOutOfMemory;
+  }
+  for (; num_free_buffers < num_buffers; ++num_free_buffers) {
+    std::unique_ptr<Buffer> new_buffer(new (std::nothrow) Buffer);
+    if (new_buffer == nullptr) return kStatusOutOfMemory;
+    buffers_.push_back_unchecked(std::move(new_buffer));
+  }
+
+  for (auto& buffer_ptr : buffers_) {
+    Buffer* const buffer = buffer_ptr.get();
+    if (buffer->in_use || buffer->size >= min_size) continue;
+    std::unique_ptr<uint8_t[], MallocDeleter> new_data =
+        AllocateData(min_size);
+    if (new_data == nullptr) return kStatusOutOfMemory;
+    PrefaultPages(new_data.get(), min_size);
+    SetData(buffer, std::move(new_data), min_size);
+  }
+  return kStatusOk;
+}
+
+std::unique_ptr<uint8_t[], MallocDeleter> InternalFrameBufferList::AllocateData(
+    size_t size) const {
+  std::unique_ptr<uint8_t[], MallocDeleter> data;
+#if defined(__linux__)
+  if (use_huge_pages_ && size >= kHugePageSize) {
+    // The huge pages can only back the naturally aligned 2MB ranges of the
+    // buffer, so align it and round its size up. The memory is still released
+    // with free().
+    const size_t padded_size = Align(size, kHugePageSize);
+    void* huge_page_data;
+    if (posix_memalign(&huge_page_data, kHugePageSize, padded_size) == 0) {
+      data.reset(static_cast<uint8_t*>(huge_page_data));
+#if defined(MADV_HUGEPAGE)
+      // This fails if the kernel does not support transparent huge pages. The
+      // buffer then simply uses regular pages.
+      madvise(huge_page_data, padded_size, MADV_HUGEPAGE);
+#endif
+    }
+  }
+#endif  // defined(__linux__)
+  if (data == nullptr) data.reset(static_cast<uint8_t*>(malloc(size)));
+  if (data != nullptr && affinity_ != nullptr) {
+    affinity_->FirstTouch(data.get(), size);
+  }
+  return data;
+}
+
+void InternalFrameBufferList::SetData(
+    Buffer* const buffer, std::unique_ptr<uint8_t[], MallocDeleter> data,
+    size_t size) {
+  if (memory_usage_ != nullptr) {
+    memory_usage_->Add(size);
+    memory_usage_->Subtract(buffer->size);
+  }
+  buffer->data = std::move(data);
+  buffer->size = size;
+}
+
 void InternalFrameBufferList::ReleaseFrameBuffer(void* buffer_private_data) {
   auto* const buffer = static_cast<Buffer*>(buffer_private_data);
   buffer->in_use = false;
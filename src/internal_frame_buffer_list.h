@@ -22,7 +22,9 @@
 #include <memory>
 
 #include "src/gav1/frame_buffer.h"
+#include "src/utils/cpu_affinity.h"
 #include "src/utils/memory.h"
+#include "src/utils/memory_usage.h"
 #include "src/utils/vector.h"
 
 namespace libgav1 {
@@ -48,7 +50,7 @@ class InternalFrameBufferList : public Allocable {
   InternalFrameBufferList(const InternalFrameBufferList&) = delete;
   InternalFrameBufferList& operator=(const InternalFrameBufferList&) = delete;
 
-  ~InternalFrameBufferList() = default;
+  ~InternalFrameBufferList();
 
   Libgav1StatusCode OnFrameBufferSizeChanged(int bitdepth,
                                              Libgav1ImageFormat image_format,
@@ -66,6 +68,38 @@ class InternalFrameBufferList : public Allocable {
 
   void ReleaseFrameBuffer(void* buffer_private_data);
 
+  // Makes sure that at least |num_buffers| buffers large enough for frames of
+  // the given parameters exist, and maps their pages. Buffers that are in use
+  // are not counted.
+  Libgav1StatusCode Preallocate(int num_buffers, int bitdepth,
+                                Libgav1ImageFormat image_format, int width,
+                                int height, int left_border, int right_border,
+                                int top_border, int bottom_border,
+                                int stride_alignment);
+
+  // If |affinity| is not nullptr, newly allocated buffers are first touched
+  // from the CPUs of |affinity| so that their pages are placed on the NUMA node
+  // of the threads that will process them. |*affinity| must outlive this
+  // object.
+  void set_cpu_affinity(const CpuAffinity* affinity) { affinity_ = affinity; }
+
+  // If |use_huge_pages| is true, newly allocated buffers of at least
+  // kHugePageSize bytes are aligned to kHugePageSize and, on Linux, backed by
+  // transparent huge pages when the kernel allows it. This reduces the TLB
+  // misses of the motion compensation reads. Otherwise regular pages are used.
+  void set_use_huge_pages(bool use_huge_pages) {
+    use_huge_pages_ = use_huge_pages;
+  }
+
+  // If |memory_usage| is not nullptr, the sizes of the buffers allocated from
+  // now on are added to it, and subtracted when the buffers are freed.
+  // |*memory_usage| must outlive this object.
+  void set_memory_usage(MemoryUsage* memory_usage) {
+    memory_usage_ = memory_usage;
+  }
+
+  static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
  private:
   struct Buffer : public Allocable {
     std::unique_ptr<uint8_t[], MallocDeleter> data;
@@ -73,7 +107,18 @@ class InternalFrameBufferList : public Allocable {
     bool in_use = false;
   };
 
+  // Allocates |size| bytes for the pixels of a buffer, placed according to
+  // |affinity_| and |use_huge_pages_|.
+  std::unique_ptr<uint8_t[], MallocDeleter> AllocateData(size_t size) const;
+  // Replaces the pixels of |buffer| with the |size| bytes of |data| and
+  // updates |memory_usage_|.
+  void SetData(Buffer* buffer, std::unique_ptr<uint8_t[], MallocDeleter> data,
+               size_t size);
+
   Vector<std::unique_ptr<Buffer>> buffers_;
+  const CpuAffinity* affinity_ = nullptr;
+  bool use_huge_pages_ = false;
+  MemoryUsage* memory_usage_ = nullptr;
 };
 
 }  // namespace libgav1
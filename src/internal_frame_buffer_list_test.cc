@@ -14,7 +14,18 @@
 
 #include "src/internal_frame_buffer_list.h"
 
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <chrono>  // NOLINT (unapproved c++11 header)
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
 
 #include "gtest/gtest.h"
 #include "src/gav1/decoder_buffer.h"
@@ -154,5 +165,129 @@ TEST_F(InternalFrameBufferListTest, VaryingBufferSizes) {
   }
 }
 
+TEST(InternalFrameBufferListHugePagesTest, GetFrameBuffer) {
+  InternalFrameBufferList buffer_list;
+  buffer_list.set_use_huge_pages(true);
+  const int width = 1920;
+  const int height = 1080;
+  FrameBuffer frame_buffer;
+  ASSERT_EQ(buffer_list.GetFrameBuffer(
+                /*bitdepth=*/8, kLibgav1ImageFormatYuv420, width, height,
+                /*left_border=*/64, /*right_border=*/64, /*top_border=*/64,
+                /*bottom_border=*/64, /*stride_alignment=*/16, &frame_buffer),
+            kStatusOk);
+  // The buffer is usable whether or not huge pages are available.
+  for (int y = 0; y < height; ++y) {
+    memset(frame_buffer.plane[0] + y * frame_buffer.stride[0], y & 0xff,
+           width);
+  }
+  EXPECT_EQ(frame_buffer.plane[0][(height - 1) * frame_buffer.stride[0]],
+            (height - 1) & 0xff);
+  buffer_list.ReleaseFrameBuffer(frame_buffer.private_data);
+}
+
+#if defined(__linux__)
+// Counts the data TLB read misses of the calling thread, if the kernel allows
+// it.
+class DtlbMissCounter {
+ public:
+  DtlbMissCounter() {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                  (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+  ~DtlbMissCounter() {
+    if (fd_ >= 0) close(fd_);
+  }
+
+  bool available() const { return fd_ >= 0; }
+  void Start() {
+    if (fd_ < 0) return;
+    ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+  }
+  int64_t Stop() {
+    if (fd_ < 0) return -1;
+    ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+    int64_t count;
+    if (read(fd_, &count, sizeof(count)) != sizeof(count)) return -1;
+    return count;
+  }
+
+ private:
+  int fd_;
+};
+#else
+class DtlbMissCounter {
+ public:
+  bool available() const { return false; }
+  void Start() {}
+  int64_t Stop() { return -1; }
+};
+#endif  // defined(__linux__)
+
+// Compares the time and the data TLB misses of reads that mimic the reference
+// block fetches of motion compensation, from a 4K 10-bit frame buffer backed by
+// regular and by huge pages.
+TEST(InternalFrameBufferListHugePagesTest, DISABLED_MotionCompensationReads) {
+  using Clock = std::chrono::steady_clock;
+  constexpr int kWidth = 3840;
+  constexpr int kHeight = 2160;
+  constexpr int kBlockSize = 16;
+  // The interpolation filters read 7 extra rows and columns.
+  constexpr int kFetchSize = kBlockSize + 7;
+  constexpr int kNumBlocks = 1 << 20;
+  for (const bool use_huge_pages : {false, true}) {
+    InternalFrameBufferList buffer_list;
+    buffer_list.set_use_huge_pages(use_huge_pages);
+    FrameBuffer frame_buffer;
+    ASSERT_EQ(buffer_list.GetFrameBuffer(
+                  /*bitdepth=*/10, kLibgav1ImageFormatYuv420, kWidth, kHeight,
+                  /*left_border=*/64, /*right_border=*/64, /*top_border=*/64,
+                  /*bottom_border=*/64, /*stride_alignment=*/16,
+                  &frame_buffer),
+              kStatusOk);
+    const ptrdiff_t stride = frame_buffer.stride[0] / sizeof(uint16_t);
+    auto* const plane = reinterpret_cast<uint16_t*>(frame_buffer.plane[0]);
+    for (int y = 0; y < kHeight; ++y) {
+      for (int x = 0; x < kWidth; ++x) plane[y * stride + x] = x ^ y;
+    }
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int> x_dist(0, kWidth - kFetchSize);
+    std::uniform_int_distribution<int> y_dist(0, kHeight - kFetchSize);
+    DtlbMissCounter counter;
+    uint32_t sum = 0;
+    const Clock::time_point start = Clock::now();
+    counter.Start();
+    for (int i = 0; i < kNumBlocks; ++i) {
+      const uint16_t* src = plane + y_dist(rng) * stride + x_dist(rng);
+      for (int y = 0; y < kFetchSize; ++y, src += stride) {
+        for (int x = 0; x < kFetchSize; ++x) sum += src[x];
+      }
+    }
+    const int64_t dtlb_misses = counter.Stop();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - start);
+    printf("%s pages: %lld us, dTLB read misses: ",
+           use_huge_pages ? "huge" : "regular",
+           static_cast<long long>(elapsed.count()));
+    if (counter.available()) {
+      printf("%lld", static_cast<long long>(dtlb_misses));
+    } else {
+      printf("unavailable");
+    }
+    printf(" (checksum %u)\n", sum);
+    buffer_list.ReleaseFrameBuffer(frame_buffer.private_data);
+  }
+}
+
 }  // namespace
 }  // namespace libgav1
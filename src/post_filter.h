@@ -19,10 +19,11 @@
 
 #include <algorithm>
 #include <array>
-#include <atomic>
+#include <condition_variable>  // NOLINT (unapproved c++11 header)
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <mutex>  // NOLINT (unapproved c++11 header)
 #include <type_traits>
 
 #include "src/dsp/common.h"
@@ -33,6 +34,7 @@
 #include "src/utils/array_2d.h"
 #include "src/utils/block_parameters_holder.h"
 #include "src/utils/common.h"
+#include "src/utils/compiler_attributes.h"
 #include "src/utils/constants.h"
 #include "src/utils/memory.h"
 #include "src/utils/threadpool.h"
@@ -99,6 +101,12 @@ class PostFilter {
   // * |frame_buffer_| points to the decoded frame buffer. When
   //   ApplyFilteringThreaded() is called, |frame_buffer_| is modified by each
   //   of the filters as described below.
+  // * The frame is processed in rows of 64x64 units. Each unit row goes
+  //   through the filters (see |Stage|) in order, and a filter is applied to a
+  //   unit row as soon as the unit rows above and below it have progressed far
+  //   enough, so the filters are pipelined across the rows instead of being
+  //   separated by a barrier. For example, CDEF of unit row N starts as soon
+  //   as the deblocked pixels of unit rows N - 1, N and N + 1 are final.
   // Filter behavior (multi-threaded):
   // * Deblock: In-place filtering. The output is written to |source_buffer_|.
   //            If cdef and loop restoration are both on, then 4 rows (as
@@ -236,6 +244,34 @@ class PostFilter {
                           int bottom);
 
  private:
+  // The filter stages of the multi-threaded post filter, in the order in which
+  // they are applied to each 64x64 unit row. The stages that are not enabled
+  // for the frame are skipped. The dependencies of a stage on the neighboring
+  // unit rows (in addition to the previous stages of the same unit row) are:
+  //   kStageDeblockVertical: None.
+  //   kStageDeblockHorizontal: kStageDeblockVertical of the unit row above.
+  //   kStageSetupBorders: kStageDeblockHorizontal of the unit row below, which
+  //       modifies the bottom rows of this unit row.
+  //   kStageCdef: kStageSetupBorders of the unit rows above and below, which
+  //       copy the deblocked rows read by CDEF before they are overwritten.
+  //   kStageSuperRes: kStageCdef (or kStageSetupBorders if CDEF is off) of the
+  //       unit row above, since the output is shifted up by one row and
+  //       overwrites its last row.
+  //   kStageLoopRestoration: kStageSuperRes of the unit row above, since the
+  //       loop restoration stripe of this unit row starts 8 rows above it.
+  enum Stage : uint8_t {
+    kStageDeblockVertical,
+    kStageDeblockHorizontal,
+    // Copies the deblocked rows needed by CDEF, SuperRes and Loop Restoration
+    // into |cdef_border_|, |superres_line_buffer_| and
+    // |loop_restoration_border_|.
+    kStageSetupBorders,
+    kStageCdef,
+    kStageSuperRes,
+    kStageLoopRestoration,
+    kStageDone
+  };
+
   // The type of the HorizontalDeblockFilter and VerticalDeblockFilter member
   // functions.
   using DeblockFilter = void (PostFilter::*)(int row4x4_start, int row4x4_end,
@@ -289,12 +325,22 @@ class PostFilter {
     } while (--height != 0);
   }
 
-  // Worker function used for multi-threaded implementation of Deblocking, CDEF
-  // and Loop Restoration.
-  using WorkerFunction = void (PostFilter::*)(std::atomic<int>* row4x4_atomic);
-  // Schedules |worker| jobs to the |thread_pool_|, runs them in the calling
-  // thread and returns once all the jobs are completed.
-  void RunJobs(WorkerFunction worker);
+  // Functions for the multi-threaded post filter.
+
+  // Returns the first filter stage after |stage| that is enabled for the
+  // frame, or kStageDone.
+  Stage NextStage(Stage stage) const;
+  // Returns true if the next stage of the unit row at |row_index| has not been
+  // scheduled yet and its dependencies on the neighboring unit rows are
+  // satisfied. |mutex_| must be held when calling this function.
+  bool CanApplyStage(int row_index) const;
+  // Applies |stage| to the unit row at |row_index|.
+  void ApplyStage(Stage stage, int row_index);
+  // This function is run by the worker threads and the calling thread of
+  // ApplyFilteringThreaded(). It applies the ready stages until all the unit
+  // rows are done, and marks the stages of the neighboring unit rows that it
+  // unblocks as ready.
+  void ApplyStagesWorker();
 
   // Functions for the Deblocking filter.
 
@@ -305,12 +351,14 @@ class PostFilter {
                                             uint8_t* level_u, uint8_t* level_v,
                                             int* step,
                                             int* filter_length) const;
+  // |dp| points to the DeblockParameters of the 4x4 block at |row4x4|,
+  // |column4x4| (at the chroma deblock position for the UV version).
   bool GetVerticalDeblockFilterEdgeInfo(int row4x4, int column4x4,
-                                        BlockParameters* const* bp_ptr,
+                                        const DeblockParameters* dp,
                                         uint8_t* level, int* step,
                                         int* filter_length) const;
   void GetVerticalDeblockFilterEdgeInfoUV(int column4x4,
-                                          BlockParameters* const* bp_ptr,
+                                          const DeblockParameters* dp,
                                           uint8_t* level_u, uint8_t* level_v,
                                           int* step, int* filter_length) const;
   void HorizontalDeblockFilter(int row4x4_start, int row4x4_end,
@@ -325,19 +373,6 @@ class PostFilter {
   static_assert(std::is_same<decltype(&PostFilter::VerticalDeblockFilter),
                              DeblockFilter>::value,
                 "");
-  // Worker function used for multi-threaded deblocking.
-  template <LoopFilterType loop_filter_type>
-  void DeblockFilterWorker(std::atomic<int>* row4x4_atomic);
-  static_assert(
-      std::is_same<
-          decltype(&PostFilter::DeblockFilterWorker<kLoopFilterTypeVertical>),
-          WorkerFunction>::value,
-      "");
-  static_assert(
-      std::is_same<
-          decltype(&PostFilter::DeblockFilterWorker<kLoopFilterTypeHorizontal>),
-          WorkerFunction>::value,
-      "");
 
   // Functions for the cdef filter.
 
@@ -370,11 +405,9 @@ class PostFilter {
   // Applies CDEF filtering for the superblock row starting at |row4x4| with a
   // height of 4*|sb4x4|.
   void ApplyCdefForOneSuperBlockRow(int row4x4, int sb4x4, bool is_last_row);
-  // Worker function used for multi-threaded CDEF.
-  void ApplyCdefWorker(std::atomic<int>* row4x4_atomic);
-  static_assert(std::is_same<decltype(&PostFilter::ApplyCdefWorker),
-                             WorkerFunction>::value,
-                "");
+  // Applies CDEF filtering for the 64x64 unit row starting at |row4x4|. Used
+  // by the multi-threaded post filter.
+  void ApplyCdefForOneUnitRow(int row4x4);
 
   // Functions for the SuperRes filter.
 
@@ -393,7 +426,14 @@ class PostFilter {
   // of 4*|sb4x4|.
   void ApplySuperResForOneSuperBlockRow(int row4x4, int sb4x4,
                                         bool is_last_row);
-  void ApplySuperResThreaded();
+  // Copies the last input row of the 64x64 unit row starting at |row4x4| into
+  // |superres_line_buffer_|, since the SuperRes output of the unit row below
+  // overwrites it.
+  void SetupSuperResLineBuffer(int row4x4);
+  // Applies SuperRes for the 64x64 unit row starting at |row4x4|. The last
+  // input row is read from |superres_line_buffer_|. Used by the multi-threaded
+  // post filter.
+  void ApplySuperResForOneUnitRow(int row4x4);
 
   // Functions for the Loop Restoration filter.
 
@@ -441,11 +481,6 @@ class PostFilter {
   // Helper function that calls the right variant of
   // ApplyLoopRestorationForOneSuperBlockRow based on the bitdepth.
   void ApplyLoopRestoration(int row4x4_start, int sb4x4);
-  // Worker function used for multithreaded Loop Restoration.
-  void ApplyLoopRestorationWorker(std::atomic<int>* row4x4_atomic);
-  static_assert(std::is_same<decltype(&PostFilter::ApplyLoopRestorationWorker),
-                             WorkerFunction>::value,
-                "");
 
   // The lookup table for picking the deblock filter, according to deblock
   // filter type.
@@ -516,6 +551,21 @@ class PostFilter {
   //   (2). Cdef is on, or multi-threading is enabled for post filter.
   YuvBuffer& loop_restoration_border_;
   ThreadPool* const thread_pool_;
+  // The state of each 64x64 unit row in the multi-threaded post filter.
+  PostFilterRowState* const row_states_;
+  // A circular queue of the unit rows whose next stage is ready to be applied.
+  // A unit row is in the queue at most once.
+  int* const ready_rows_;
+
+  // Used by the multi-threaded post filter.
+  std::mutex mutex_;
+  // Notified when a stage becomes ready or when all the unit rows are done.
+  std::condition_variable ready_condvar_;
+  int num_unit_rows_ = 0;
+  int ready_rows_start_ LIBGAV1_GUARDED_BY(mutex_) = 0;
+  int num_ready_rows_ LIBGAV1_GUARDED_BY(mutex_) = 0;
+  // The number of unit rows whose next stage is not kStageDone.
+  int num_pending_rows_ LIBGAV1_GUARDED_BY(mutex_) = 0;
 
   // Tracks the progress of the post filters.
   int progress_row_ = -1;
@@ -531,6 +581,9 @@ class PostFilter {
 
   template <int bitdepth, typename Pixel>
   friend class PostFilterHelperFuncTest;
+
+  template <int bitdepth, typename Pixel>
+  friend class PostFilterDeblockTest;
 };
 
 extern template void PostFilter::ExtendFrame<uint8_t>(uint8_t* frame_start,
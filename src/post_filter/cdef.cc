@@ -656,19 +656,15 @@ void PostFilter::ApplyCdefForOneSuperBlockRow(int row4x4_start, int sb4x4,
   } while (row4x4 < row4x4_limit);
 }
 
-void PostFilter::ApplyCdefWorker(std::atomic<int>* row4x4_atomic) {
-  int row4x4;
+void PostFilter::ApplyCdefForOneUnitRow(int row4x4) {
   uint16_t cdef_block[kCdefUnitSizeWithBorders * kCdefUnitSizeWithBorders * 2];
   // Each border_column buffer has to store 64 rows and 2 columns for each
   // plane. For 10bit, that is 64*2*2 = 256 bytes.
   alignas(kMaxAlignment) uint8_t border_columns[2][kMaxPlanes][256];
-  while ((row4x4 = row4x4_atomic->fetch_add(
-              kStep64x64, std::memory_order_relaxed)) < frame_header_.rows4x4) {
-    const int block_height4x4 =
-        std::min(kStep64x64, frame_header_.rows4x4 - row4x4);
-    ApplyCdefForOneSuperBlockRowHelper(cdef_block, border_columns, row4x4,
-                                       block_height4x4);
-  }
+  const int block_height4x4 =
+      std::min(kStep64x64, frame_header_.rows4x4 - row4x4);
+  ApplyCdefForOneSuperBlockRowHelper(cdef_block, border_columns, row4x4,
+                                     block_height4x4);
 }
 
 }  // namespace libgav1
@@ -11,7 +11,6 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
-#include <atomic>
 
 #include "src/post_filter.h"
 
@@ -45,15 +44,82 @@ constexpr dsp::LoopFilterSize GetLoopFilterSizeUV(int filter_length) {
   return static_cast<dsp::LoopFilterSize>(filter_length != 4);
 }
 
-bool NonBlockBorderNeedsFilter(const BlockParameters& bp, int filter_id,
+bool NonBlockBorderNeedsFilter(const DeblockParameters& dp, int filter_id,
                                uint8_t* const level) {
-  if (bp.deblock_filter_level[filter_id] == 0 || (bp.skip && bp.is_inter)) {
-    return false;
-  }
-  *level = bp.deblock_filter_level[filter_id];
+  if (dp.filter_level[filter_id] == 0 || dp.skip) return false;
+  *level = dp.filter_level[filter_id];
   return true;
 }
 
+// Accumulates adjacent 4-pixel edge segments which share a filter size and
+// level so that they can be filtered with a single Dsp::loop_filter_batches
+// call. Segments must be added in an order in which they could be filtered one
+// at a time; a pending run is flushed as soon as a segment that does not
+// extend it is added.
+class EdgeBatch {
+ public:
+  EdgeBatch(const dsp::Dsp& dsp, LoopFilterType type, ptrdiff_t stride,
+            ptrdiff_t segment_step, const uint8_t* outer_thresh,
+            const uint8_t* inner_thresh)
+      : loop_filters_(dsp.loop_filters),
+        loop_filter_batches_(dsp.loop_filter_batches),
+        type_(type),
+        stride_(stride),
+        segment_step_(segment_step),
+        outer_thresh_(outer_thresh),
+        inner_thresh_(inner_thresh) {}
+  EdgeBatch(const EdgeBatch&) = delete;
+  EdgeBatch& operator=(const EdgeBatch&) = delete;
+  ~EdgeBatch() { assert(num_segments_ == 0); }
+
+  void Add(uint8_t* dst, dsp::LoopFilterSize size, uint8_t level) {
+    assert(level > 0 && level <= kMaxLoopFilterValue);
+    if (num_segments_ != 0 &&
+        (dst != dst_ + num_segments_ * segment_step_ || size != size_ ||
+         level != level_)) {
+      Flush();
+    }
+    if (num_segments_ == 0) {
+      dst_ = dst;
+      size_ = size;
+      level_ = level;
+    }
+    ++num_segments_;
+  }
+
+  void Flush() {
+    if (num_segments_ == 0) return;
+    const int outer_thresh = outer_thresh_[level_];
+    const int inner_thresh = inner_thresh_[level_];
+    const int hev_thresh = HevThresh(level_);
+    const dsp::LoopFilterBatchFunc batch = loop_filter_batches_[size_][type_];
+    if (batch != nullptr) {
+      batch(dst_, stride_, num_segments_, outer_thresh, inner_thresh,
+            hev_thresh);
+    } else {
+      const dsp::LoopFilterFunc filter = loop_filters_[size_][type_];
+      uint8_t* dst = dst_;
+      for (int i = 0; i < num_segments_; ++i, dst += segment_step_) {
+        filter(dst, stride_, outer_thresh, inner_thresh, hev_thresh);
+      }
+    }
+    num_segments_ = 0;
+  }
+
+ private:
+  const dsp::LoopFilterFuncs& loop_filters_;
+  const dsp::LoopFilterBatchFuncs& loop_filter_batches_;
+  const LoopFilterType type_;
+  const ptrdiff_t stride_;
+  const ptrdiff_t segment_step_;
+  const uint8_t* const outer_thresh_;
+  const uint8_t* const inner_thresh_;
+  uint8_t* dst_ = nullptr;
+  dsp::LoopFilterSize size_ = dsp::kLoopFilterSize4;
+  uint8_t level_ = 0;
+  int num_segments_ = 0;
+};
+
 // 7.14.5.
 void ComputeDeblockFilterLevelsHelper(
     const ObuFrameHeader& frame_header, int segment_id, int level_index,
@@ -126,20 +192,21 @@ bool PostFilter::GetHorizontalDeblockFilterEdgeInfo(int row4x4, int column4x4,
   *step = kTransformHeight[inter_transform_sizes_[row4x4][column4x4]];
   if (row4x4 == 0) return false;
 
-  const BlockParameters* bp = block_parameters_.Find(row4x4, column4x4);
+  const DeblockParameters& dp =
+      block_parameters_.FindDeblockParameters(row4x4, column4x4);
   const int row4x4_prev = row4x4 - 1;
   assert(row4x4_prev >= 0);
-  const BlockParameters* bp_prev =
-      block_parameters_.Find(row4x4_prev, column4x4);
 
-  if (bp == bp_prev) {
+  if (dp.row_offset != 0) {
     // Not a border.
-    if (!NonBlockBorderNeedsFilter(*bp, 1, level)) return false;
+    if (!NonBlockBorderNeedsFilter(dp, 1, level)) return false;
   } else {
-    const uint8_t level_this = bp->deblock_filter_level[1];
+    const uint8_t level_this = dp.filter_level[1];
     *level = level_this;
     if (level_this == 0) {
-      const uint8_t level_prev = bp_prev->deblock_filter_level[1];
+      const uint8_t level_prev =
+          block_parameters_.FindDeblockParameters(row4x4_prev, column4x4)
+              .filter_level[1];
       if (level_prev == 0) return false;
       *level = level_prev;
     }
@@ -157,10 +224,11 @@ void PostFilter::GetHorizontalDeblockFilterEdgeInfoUV(
   const int subsampling_y = subsampling_y_[kPlaneU];
   row4x4 = GetDeblockPosition(row4x4, subsampling_y);
   column4x4 = GetDeblockPosition(column4x4, subsampling_x);
-  const BlockParameters* bp = block_parameters_.Find(row4x4, column4x4);
+  const DeblockParameters& dp =
+      block_parameters_.FindDeblockParameters(row4x4, column4x4);
   *level_u = 0;
   *level_v = 0;
-  *step = kTransformHeight[bp->uv_transform_size];
+  *step = kTransformHeight[dp.uv_transform_size];
   if (row4x4 == subsampling_y) {
     return;
   }
@@ -174,62 +242,60 @@ void PostFilter::GetHorizontalDeblockFilterEdgeInfoUV(
       kDeblockFilterLevelIndex[kPlaneV][kLoopFilterTypeHorizontal];
   const int row4x4_prev = row4x4 - (1 << subsampling_y);
   assert(row4x4_prev >= 0);
-  const BlockParameters* bp_prev =
-      block_parameters_.Find(row4x4_prev, column4x4);
 
-  if (bp == bp_prev) {
+  if (dp.row_offset >= (1 << subsampling_y)) {
     // Not a border.
-    const bool skip = bp->skip && bp->is_inter;
     need_filter_u =
-        need_filter_u && bp->deblock_filter_level[filter_id_u] != 0 && !skip;
+        need_filter_u && dp.filter_level[filter_id_u] != 0 && !dp.skip;
     need_filter_v =
-        need_filter_v && bp->deblock_filter_level[filter_id_v] != 0 && !skip;
+        need_filter_v && dp.filter_level[filter_id_v] != 0 && !dp.skip;
     if (!need_filter_u && !need_filter_v) return;
-    if (need_filter_u) *level_u = bp->deblock_filter_level[filter_id_u];
-    if (need_filter_v) *level_v = bp->deblock_filter_level[filter_id_v];
+    if (need_filter_u) *level_u = dp.filter_level[filter_id_u];
+    if (need_filter_v) *level_v = dp.filter_level[filter_id_v];
     *filter_length = *step;
     return;
   }
 
   // It is a border.
+  const DeblockParameters& dp_prev =
+      block_parameters_.FindDeblockParameters(row4x4_prev, column4x4);
   if (need_filter_u) {
-    const uint8_t level_u_this = bp->deblock_filter_level[filter_id_u];
+    const uint8_t level_u_this = dp.filter_level[filter_id_u];
     *level_u = level_u_this;
     if (level_u_this == 0) {
-      *level_u = bp_prev->deblock_filter_level[filter_id_u];
+      *level_u = dp_prev.filter_level[filter_id_u];
     }
   }
   if (need_filter_v) {
-    const uint8_t level_v_this = bp->deblock_filter_level[filter_id_v];
+    const uint8_t level_v_this = dp.filter_level[filter_id_v];
     *level_v = level_v_this;
     if (level_v_this == 0) {
-      *level_v = bp_prev->deblock_filter_level[filter_id_v];
+      *level_v = dp_prev.filter_level[filter_id_v];
     }
   }
-  const int step_prev = kTransformHeight[bp_prev->uv_transform_size];
+  const int step_prev = kTransformHeight[dp_prev.uv_transform_size];
   *filter_length = std::min(*step, step_prev);
 }
 
-bool PostFilter::GetVerticalDeblockFilterEdgeInfo(
-    int row4x4, int column4x4, BlockParameters* const* bp_ptr, uint8_t* level,
-    int* step, int* filter_length) const {
-  const BlockParameters* bp = *bp_ptr;
+bool PostFilter::GetVerticalDeblockFilterEdgeInfo(int row4x4, int column4x4,
+                                                  const DeblockParameters* dp,
+                                                  uint8_t* level, int* step,
+                                                  int* filter_length) const {
   *step = kTransformWidth[inter_transform_sizes_[row4x4][column4x4]];
   if (column4x4 == 0) return false;
 
   const int filter_id = 0;
   const int column4x4_prev = column4x4 - 1;
   assert(column4x4_prev >= 0);
-  const BlockParameters* bp_prev = *(bp_ptr - 1);
-  if (bp == bp_prev) {
+  if (dp->column_offset != 0) {
     // Not a border.
-    if (!NonBlockBorderNeedsFilter(*bp, filter_id, level)) return false;
+    if (!NonBlockBorderNeedsFilter(*dp, filter_id, level)) return false;
   } else {
     // It is a border.
-    const uint8_t level_this = bp->deblock_filter_level[filter_id];
+    const uint8_t level_this = dp->filter_level[filter_id];
     *level = level_this;
     if (level_this == 0) {
-      const uint8_t level_prev = bp_prev->deblock_filter_level[filter_id];
+      const uint8_t level_prev = (dp - 1)->filter_level[filter_id];
       if (level_prev == 0) return false;
       *level = level_prev;
     }
@@ -241,14 +307,13 @@ bool PostFilter::GetVerticalDeblockFilterEdgeInfo(
 }
 
 void PostFilter::GetVerticalDeblockFilterEdgeInfoUV(
-    int column4x4, BlockParameters* const* bp_ptr, uint8_t* level_u,
+    int column4x4, const DeblockParameters* dp, uint8_t* level_u,
     uint8_t* level_v, int* step, int* filter_length) const {
   const int subsampling_x = subsampling_x_[kPlaneU];
   column4x4 = GetDeblockPosition(column4x4, subsampling_x);
-  const BlockParameters* bp = *bp_ptr;
   *level_u = 0;
   *level_v = 0;
-  *step = kTransformWidth[bp->uv_transform_size];
+  *step = kTransformWidth[dp->uv_transform_size];
   if (column4x4 == subsampling_x) {
     return;
   }
@@ -260,237 +325,258 @@ void PostFilter::GetVerticalDeblockFilterEdgeInfoUV(
       kDeblockFilterLevelIndex[kPlaneU][kLoopFilterTypeVertical];
   const int filter_id_v =
       kDeblockFilterLevelIndex[kPlaneV][kLoopFilterTypeVertical];
-  const BlockParameters* bp_prev = *(bp_ptr - (ptrdiff_t{1} << subsampling_x));
 
-  if (bp == bp_prev) {
+  if (dp->column_offset >= (1 << subsampling_x)) {
     // Not a border.
-    const bool skip = bp->skip && bp->is_inter;
     need_filter_u =
-        need_filter_u && bp->deblock_filter_level[filter_id_u] != 0 && !skip;
+        need_filter_u && dp->filter_level[filter_id_u] != 0 && !dp->skip;
     need_filter_v =
-        need_filter_v && bp->deblock_filter_level[filter_id_v] != 0 && !skip;
+        need_filter_v && dp->filter_level[filter_id_v] != 0 && !dp->skip;
     if (!need_filter_u && !need_filter_v) return;
-    if (need_filter_u) *level_u = bp->deblock_filter_level[filter_id_u];
-    if (need_filter_v) *level_v = bp->deblock_filter_level[filter_id_v];
+    if (need_filter_u) *level_u = dp->filter_level[filter_id_u];
+    if (need_filter_v) *level_v = dp->filter_level[filter_id_v];
     *filter_length = *step;
     return;
   }
 
   // It is a border.
+  const DeblockParameters* const dp_prev = dp - (ptrdiff_t{1} << subsampling_x);
   if (need_filter_u) {
-    const uint8_t level_u_this = bp->deblock_filter_level[filter_id_u];
+    const uint8_t level_u_this = dp->filter_level[filter_id_u];
     *level_u = level_u_this;
     if (level_u_this == 0) {
-      *level_u = bp_prev->deblock_filter_level[filter_id_u];
+      *level_u = dp_prev->filter_level[filter_id_u];
     }
   }
   if (need_filter_v) {
-    const uint8_t level_v_this = bp->deblock_filter_level[filter_id_v];
+    const uint8_t level_v_this = dp->filter_level[filter_id_v];
     *level_v = level_v_this;
     if (level_v_this == 0) {
-      *level_v = bp_prev->deblock_filter_level[filter_id_v];
+      *level_v = dp_prev->filter_level[filter_id_v];
     }
   }
-  const int step_prev = kTransformWidth[bp_prev->uv_transform_size];
+  const int step_prev = kTransformWidth[dp_prev->uv_transform_size];
   *filter_length = std::min(*step, step_prev);
 }
 
+// The edges are visited in superblock wide (kNum4x4InLoopFilterUnit) column
+// strips, one row at a time, so that adjacent segments of the same horizontal
+// edge can be batched. Horizontal edges only interact with edges in the same
+// 4-pixel column so this is equivalent to filtering each column top to bottom.
 void PostFilter::HorizontalDeblockFilter(int row4x4_start, int row4x4_end,
                                          int column4x4_start,
                                          int column4x4_end) {
-  const int height4x4 = row4x4_end - row4x4_start;
-  const int width4x4 = column4x4_end - column4x4_start;
+  const int width = frame_header_.width;
+  const int height = frame_header_.height;
+  const int height4x4 =
+      std::min(row4x4_end, DivideBy4(height + 3)) - row4x4_start;
+  const int width4x4 =
+      std::min(column4x4_end, DivideBy4(width + 3)) - column4x4_start;
   if (height4x4 <= 0 || width4x4 <= 0) return;
 
-  const int column_step = 1;
   const int src_step = 4 << pixel_size_log2_;
   const ptrdiff_t src_stride = frame_buffer_.stride(kPlaneY);
+  const ptrdiff_t row_stride = MultiplyBy4(src_stride);
   uint8_t* src = GetSourceBuffer(kPlaneY, row4x4_start, column4x4_start);
   int row_step;
   uint8_t level;
   int filter_length;
 
-  const int width = frame_header_.width;
-  const int height = frame_header_.height;
-  for (int column4x4 = 0;
-       column4x4 < width4x4 && MultiplyBy4(column4x4_start + column4x4) < width;
-       column4x4 += column_step, src += src_step) {
+  EdgeBatch batch(dsp_, kLoopFilterTypeHorizontal, src_stride, src_step,
+                  outer_thresh_, inner_thresh_);
+  for (int column4x4 = 0; column4x4 < width4x4;
+       column4x4 += kNum4x4InLoopFilterUnit,
+           src += kNum4x4InLoopFilterUnit * src_step) {
+    const int num_columns = std::min(
+        width4x4 - column4x4, static_cast<int>(kNum4x4InLoopFilterUnit));
+    // The next row containing a horizontal edge for each column of the strip.
+    int next_row4x4[kNum4x4InLoopFilterUnit] = {};
     uint8_t* src_row = src;
-    for (int row4x4 = 0;
-         row4x4 < height4x4 && MultiplyBy4(row4x4_start + row4x4) < height;
-         row4x4 += row_step) {
-      const bool need_filter = GetHorizontalDeblockFilterEdgeInfo(
-          row4x4_start + row4x4, column4x4_start + column4x4, &level, &row_step,
-          &filter_length);
-      if (need_filter) {
-        assert(level > 0 && level <= kMaxLoopFilterValue);
-        const dsp::LoopFilterSize size = GetLoopFilterSizeY(filter_length);
-        dsp_.loop_filters[size][kLoopFilterTypeHorizontal](
-            src_row, src_stride, outer_thresh_[level], inner_thresh_[level],
-            HevThresh(level));
+    for (int row4x4 = 0; row4x4 < height4x4;
+         ++row4x4, src_row += row_stride) {
+      for (int i = 0; i < num_columns; ++i) {
+        if (next_row4x4[i] != row4x4) continue;
+        const bool need_filter = GetHorizontalDeblockFilterEdgeInfo(
+            row4x4_start + row4x4, column4x4_start + column4x4 + i, &level,
+            &row_step, &filter_length);
+        next_row4x4[i] += DivideBy4(row_step);
+        if (need_filter) {
+          batch.Add(src_row + i * src_step, GetLoopFilterSizeY(filter_length),
+                    level);
+        }
       }
-      // TODO(chengchen): use shifts instead of multiplication.
-      src_row += row_step * src_stride;
-      row_step = DivideBy4(row_step);
     }
   }
+  batch.Flush();
 
   if (needs_chroma_deblock_) {
     const int8_t subsampling_x = subsampling_x_[kPlaneU];
     const int8_t subsampling_y = subsampling_y_[kPlaneU];
     const int column_step = 1 << subsampling_x;
+    const int row_step_uv = 1 << subsampling_y;
     const ptrdiff_t src_stride_u = frame_buffer_.stride(kPlaneU);
     const ptrdiff_t src_stride_v = frame_buffer_.stride(kPlaneV);
+    const ptrdiff_t row_stride_u = MultiplyBy4(src_stride_u);
+    const ptrdiff_t row_stride_v = MultiplyBy4(src_stride_v);
     uint8_t* src_u = GetSourceBuffer(kPlaneU, row4x4_start, column4x4_start);
     uint8_t* src_v = GetSourceBuffer(kPlaneV, row4x4_start, column4x4_start);
-    int row_step;
     uint8_t level_u;
     uint8_t level_v;
-    int filter_length;
 
-    for (int column4x4 = 0; column4x4 < width4x4 &&
-                            MultiplyBy4(column4x4_start + column4x4) < width;
-         column4x4 += column_step, src_u += src_step, src_v += src_step) {
+    EdgeBatch batch_u(dsp_, kLoopFilterTypeHorizontal, src_stride_u, src_step,
+                      outer_thresh_, inner_thresh_);
+    EdgeBatch batch_v(dsp_, kLoopFilterTypeHorizontal, src_stride_v, src_step,
+                      outer_thresh_, inner_thresh_);
+    const int num_strip_columns = kNum4x4InLoopFilterUnit >> subsampling_x;
+    for (int column4x4 = 0; column4x4 < width4x4;
+         column4x4 += kNum4x4InLoopFilterUnit,
+             src_u += num_strip_columns * src_step,
+             src_v += num_strip_columns * src_step) {
+      const int num_columns =
+          std::min((width4x4 - column4x4 + column_step - 1) >> subsampling_x,
+                   num_strip_columns);
+      int next_row4x4[kNum4x4InLoopFilterUnit] = {};
       uint8_t* src_row_u = src_u;
       uint8_t* src_row_v = src_v;
-      for (int row4x4 = 0;
-           row4x4 < height4x4 && MultiplyBy4(row4x4_start + row4x4) < height;
-           row4x4 += row_step) {
-        GetHorizontalDeblockFilterEdgeInfoUV(
-            row4x4_start + row4x4, column4x4_start + column4x4, &level_u,
-            &level_v, &row_step, &filter_length);
-        if (level_u != 0) {
-          const dsp::LoopFilterSize size = GetLoopFilterSizeUV(filter_length);
-          dsp_.loop_filters[size][kLoopFilterTypeHorizontal](
-              src_row_u, src_stride_u, outer_thresh_[level_u],
-              inner_thresh_[level_u], HevThresh(level_u));
-        }
-        if (level_v != 0) {
+      for (int row4x4 = 0; row4x4 < height4x4; row4x4 += row_step_uv,
+               src_row_u += row_stride_u, src_row_v += row_stride_v) {
+        for (int i = 0; i < num_columns; ++i) {
+          if (next_row4x4[i] != row4x4) continue;
+          GetHorizontalDeblockFilterEdgeInfoUV(
+              row4x4_start + row4x4,
+              column4x4_start + column4x4 + (i << subsampling_x), &level_u,
+              &level_v, &row_step, &filter_length);
+          next_row4x4[i] += DivideBy4(row_step << subsampling_y);
+          if (level_u == 0 && level_v == 0) continue;
           const dsp::LoopFilterSize size = GetLoopFilterSizeUV(filter_length);
-          dsp_.loop_filters[size][kLoopFilterTypeHorizontal](
-              src_row_v, src_stride_v, outer_thresh_[level_v],
-              inner_thresh_[level_v], HevThresh(level_v));
+          if (level_u != 0) {
+            batch_u.Add(src_row_u + i * src_step, size, level_u);
+          }
+          if (level_v != 0) {
+            batch_v.Add(src_row_v + i * src_step, size, level_v);
+          }
         }
-        src_row_u += row_step * src_stride_u;
-        src_row_v += row_step * src_stride_v;
-        row_step = DivideBy4(row_step << subsampling_y);
       }
     }
+    batch_u.Flush();
+    batch_v.Flush();
   }
 }
 
+// The edges are visited in superblock high (kNum4x4InLoopFilterUnit) row
+// strips, one column at a time, so that adjacent segments of the same vertical
+// edge can be batched. Vertical edges only interact with edges in the same
+// 4-pixel row so this is equivalent to filtering each row left to right.
 void PostFilter::VerticalDeblockFilter(int row4x4_start, int row4x4_end,
                                        int column4x4_start, int column4x4_end) {
-  const int height4x4 = row4x4_end - row4x4_start;
-  const int width4x4 = column4x4_end - column4x4_start;
+  const int width = frame_header_.width;
+  const int height = frame_header_.height;
+  const int height4x4 =
+      std::min(row4x4_end, DivideBy4(height + 3)) - row4x4_start;
+  const int width4x4 =
+      std::min(column4x4_end, DivideBy4(width + 3)) - column4x4_start;
   if (height4x4 <= 0 || width4x4 <= 0) return;
 
-  const ptrdiff_t row_stride = MultiplyBy4(frame_buffer_.stride(kPlaneY));
   const ptrdiff_t src_stride = frame_buffer_.stride(kPlaneY);
+  const ptrdiff_t row_stride = MultiplyBy4(src_stride);
+  const int src_step = 4 << pixel_size_log2_;
   uint8_t* src = GetSourceBuffer(kPlaneY, row4x4_start, column4x4_start);
   int column_step;
   uint8_t level;
   int filter_length;
 
-  BlockParameters* const* bp_row_base =
-      block_parameters_.Address(row4x4_start, column4x4_start);
-  const int bp_stride = block_parameters_.columns4x4();
-  const int column_step_shift = pixel_size_log2_;
-  const int width = frame_header_.width;
-  const int height = frame_header_.height;
-  for (int row4x4 = 0;
-       row4x4 < height4x4 && MultiplyBy4(row4x4_start + row4x4) < height;
-       ++row4x4, src += row_stride, bp_row_base += bp_stride) {
-    uint8_t* src_row = src;
-    BlockParameters* const* bp = bp_row_base;
-    for (int column4x4 = 0; column4x4 < width4x4 &&
-                            MultiplyBy4(column4x4_start + column4x4) < width;
-         column4x4 += column_step, bp += column_step) {
-      const bool need_filter = GetVerticalDeblockFilterEdgeInfo(
-          row4x4_start + row4x4, column4x4_start + column4x4, bp, &level,
-          &column_step, &filter_length);
-      if (need_filter) {
-        assert(level > 0 && level <= kMaxLoopFilterValue);
-        const dsp::LoopFilterSize size = GetLoopFilterSizeY(filter_length);
-        dsp_.loop_filters[size][kLoopFilterTypeVertical](
-            src_row, src_stride, outer_thresh_[level], inner_thresh_[level],
-            HevThresh(level));
+  const DeblockParameters* dp_base =
+      block_parameters_.DeblockParametersAddress(row4x4_start, column4x4_start);
+  const int dp_stride = block_parameters_.columns4x4();
+  EdgeBatch batch(dsp_, kLoopFilterTypeVertical, src_stride, row_stride,
+                  outer_thresh_, inner_thresh_);
+  for (int row4x4 = 0; row4x4 < height4x4;
+       row4x4 += kNum4x4InLoopFilterUnit,
+           src += kNum4x4InLoopFilterUnit * row_stride,
+           dp_base += kNum4x4InLoopFilterUnit * dp_stride) {
+    const int num_rows = std::min(height4x4 - row4x4,
+                                  static_cast<int>(kNum4x4InLoopFilterUnit));
+    // The next column containing a vertical edge for each row of the strip.
+    int next_column4x4[kNum4x4InLoopFilterUnit] = {};
+    uint8_t* src_column = src;
+    for (int column4x4 = 0; column4x4 < width4x4;
+         ++column4x4, src_column += src_step) {
+      for (int i = 0; i < num_rows; ++i) {
+        if (next_column4x4[i] != column4x4) continue;
+        const bool need_filter = GetVerticalDeblockFilterEdgeInfo(
+            row4x4_start + row4x4 + i, column4x4_start + column4x4,
+            dp_base + i * dp_stride + column4x4, &level, &column_step,
+            &filter_length);
+        next_column4x4[i] += DivideBy4(column_step);
+        if (need_filter) {
+          batch.Add(src_column + i * row_stride,
+                    GetLoopFilterSizeY(filter_length), level);
+        }
       }
-      src_row += column_step << column_step_shift;
-      column_step = DivideBy4(column_step);
     }
   }
+  batch.Flush();
 
   if (needs_chroma_deblock_) {
     const int8_t subsampling_x = subsampling_x_[kPlaneU];
     const int8_t subsampling_y = subsampling_y_[kPlaneU];
     const int row_step = 1 << subsampling_y;
+    const int column_step_uv = 1 << subsampling_x;
     uint8_t* src_u = GetSourceBuffer(kPlaneU, row4x4_start, column4x4_start);
     uint8_t* src_v = GetSourceBuffer(kPlaneV, row4x4_start, column4x4_start);
     const ptrdiff_t src_stride_u = frame_buffer_.stride(kPlaneU);
     const ptrdiff_t src_stride_v = frame_buffer_.stride(kPlaneV);
     const ptrdiff_t row_stride_u = MultiplyBy4(frame_buffer_.stride(kPlaneU));
     const ptrdiff_t row_stride_v = MultiplyBy4(frame_buffer_.stride(kPlaneV));
-    const LoopFilterType type = kLoopFilterTypeVertical;
-    int column_step;
     uint8_t level_u;
     uint8_t level_v;
-    int filter_length;
-
-    BlockParameters* const* bp_row_base = block_parameters_.Address(
-        GetDeblockPosition(row4x4_start, subsampling_y),
-        GetDeblockPosition(column4x4_start, subsampling_x));
-    const int bp_stride = block_parameters_.columns4x4() << subsampling_y;
-    for (int row4x4 = 0;
-         row4x4 < height4x4 && MultiplyBy4(row4x4_start + row4x4) < height;
-         row4x4 += row_step, src_u += row_stride_u, src_v += row_stride_v,
-             bp_row_base += bp_stride) {
-      uint8_t* src_row_u = src_u;
-      uint8_t* src_row_v = src_v;
-      BlockParameters* const* bp = bp_row_base;
-      for (int column4x4 = 0; column4x4 < width4x4 &&
-                              MultiplyBy4(column4x4_start + column4x4) < width;
-           column4x4 += column_step, bp += column_step) {
-        GetVerticalDeblockFilterEdgeInfoUV(column4x4_start + column4x4, bp,
-                                           &level_u, &level_v, &column_step,
-                                           &filter_length);
-        if (level_u != 0) {
-          const dsp::LoopFilterSize size = GetLoopFilterSizeUV(filter_length);
-          dsp_.loop_filters[size][type](
-              src_row_u, src_stride_u, outer_thresh_[level_u],
-              inner_thresh_[level_u], HevThresh(level_u));
-        }
-        if (level_v != 0) {
+
+    const DeblockParameters* dp_base_uv =
+        block_parameters_.DeblockParametersAddress(
+            GetDeblockPosition(row4x4_start, subsampling_y),
+            GetDeblockPosition(column4x4_start, subsampling_x));
+    const int dp_stride_uv = block_parameters_.columns4x4() << subsampling_y;
+    EdgeBatch batch_u(dsp_, kLoopFilterTypeVertical, src_stride_u,
+                      row_stride_u, outer_thresh_, inner_thresh_);
+    EdgeBatch batch_v(dsp_, kLoopFilterTypeVertical, src_stride_v,
+                      row_stride_v, outer_thresh_, inner_thresh_);
+    const int num_strip_rows = kNum4x4InLoopFilterUnit >> subsampling_y;
+    for (int row4x4 = 0; row4x4 < height4x4;
+         row4x4 += kNum4x4InLoopFilterUnit,
+         src_u += num_strip_rows * row_stride_u,
+         src_v += num_strip_rows * row_stride_v,
+         dp_base_uv += num_strip_rows * dp_stride_uv) {
+      const int num_rows = std::min(
+          (height4x4 - row4x4 + row_step - 1) >> subsampling_y, num_strip_rows);
+      int next_column4x4[kNum4x4InLoopFilterUnit] = {};
+      uint8_t* src_column_u = src_u;
+      uint8_t* src_column_v = src_v;
+      for (int column4x4 = 0; column4x4 < width4x4;
+           column4x4 += column_step_uv, src_column_u += src_step,
+               src_column_v += src_step) {
+        for (int i = 0; i < num_rows; ++i) {
+          if (next_column4x4[i] != column4x4) continue;
+          GetVerticalDeblockFilterEdgeInfoUV(
+              column4x4_start + column4x4,
+              dp_base_uv + i * dp_stride_uv + column4x4, &level_u, &level_v,
+              &column_step, &filter_length);
+          next_column4x4[i] += DivideBy4(column_step << subsampling_x);
+          if (level_u == 0 && level_v == 0) continue;
           const dsp::LoopFilterSize size = GetLoopFilterSizeUV(filter_length);
-          dsp_.loop_filters[size][type](
-              src_row_v, src_stride_v, outer_thresh_[level_v],
-              inner_thresh_[level_v], HevThresh(level_v));
+          if (level_u != 0) {
+            batch_u.Add(src_column_u + i * row_stride_u, size, level_u);
+          }
+          if (level_v != 0) {
+            batch_v.Add(src_column_v + i * row_stride_v, size, level_v);
+          }
         }
-        src_row_u += column_step << column_step_shift;
-        src_row_v += column_step << column_step_shift;
-        column_step = DivideBy4(column_step << subsampling_x);
       }
     }
+    batch_u.Flush();
+    batch_v.Flush();
   }
 }
 
-template <LoopFilterType loop_filter_type>
-void PostFilter::DeblockFilterWorker(std::atomic<int>* row4x4_atomic) {
-  const int rows4x4 = frame_header_.rows4x4;
-  const int columns4x4 = frame_header_.columns4x4;
-  int row4x4;
-  while ((row4x4 = row4x4_atomic->fetch_add(
-              kNum4x4InLoopFilterUnit, std::memory_order_relaxed)) < rows4x4) {
-    (this->*deblock_filter_func_[loop_filter_type])(
-        row4x4, row4x4 + kNum4x4InLoopFilterUnit, 0, columns4x4);
-  }
-}
-
-template void PostFilter::DeblockFilterWorker<kLoopFilterTypeVertical>(
-    std::atomic<int>* row4x4_atomic);
-template void PostFilter::DeblockFilterWorker<kLoopFilterTypeHorizontal>(
-    std::atomic<int>* row4x4_atomic);
-
 void PostFilter::ApplyDeblockFilter(LoopFilterType loop_filter_type,
                                     int row4x4_start, int column4x4_start,
                                     int column4x4_end, int sb4x4) {
@@ -15,7 +15,6 @@
 #include "src/post_filter.h"
 
 #include <algorithm>
-#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -90,7 +89,9 @@ PostFilter::PostFilter(const ObuFrameHeader& frame_header,
       cdef_border_(frame_scratch_buffer->cdef_border),
       loop_restoration_border_(frame_scratch_buffer->loop_restoration_border),
       thread_pool_(
-          frame_scratch_buffer->threading_strategy.post_filter_thread_pool()) {
+          frame_scratch_buffer->threading_strategy.post_filter_thread_pool()),
+      row_states_(frame_scratch_buffer->post_filter_row_states.get()),
+      ready_rows_(frame_scratch_buffer->post_filter_ready_rows.get()) {
   const int8_t zero_delta_lf[kFrameLfCount] = {};
   ComputeDeblockFilterLevels(zero_delta_lf, deblock_filter_levels_);
   if (DoSuperRes()) {
@@ -535,50 +536,187 @@ void PostFilter::SetupLoopRestorationBorder(int row4x4_start, int sb4x4) {
   }
 }
 
-void PostFilter::RunJobs(WorkerFunction worker) {
-  std::atomic<int> row4x4(0);
-  const int num_workers = thread_pool_->num_threads();
-  BlockingCounter pending_workers(num_workers);
-  for (int i = 0; i < num_workers; ++i) {
-    thread_pool_->Schedule([this, &row4x4, &pending_workers, worker]() {
-      (this->*worker)(&row4x4);
-      pending_workers.Decrement();
-    });
+PostFilter::Stage PostFilter::NextStage(Stage stage) const {
+  while (stage != kStageDone) {
+    stage = static_cast<Stage>(stage + 1);
+    switch (stage) {
+      case kStageDeblockVertical:
+      case kStageDeblockHorizontal:
+        if (DoDeblock()) return stage;
+        break;
+      case kStageSetupBorders:
+        if (DoCdef() || DoSuperRes() || DoRestoration()) return stage;
+        break;
+      case kStageCdef:
+        if (DoCdef()) return stage;
+        break;
+      case kStageSuperRes:
+        if (DoSuperRes()) return stage;
+        break;
+      case kStageLoopRestoration:
+        if (DoRestoration()) return stage;
+        break;
+      case kStageDone:
+        break;
+    }
   }
-  // Run the jobs on the current thread.
-  (this->*worker)(&row4x4);
-  // Wait for the threadpool jobs to finish.
-  pending_workers.Wait();
+  return kStageDone;
 }
 
-void PostFilter::ApplyFilteringThreaded() {
-  if (DoDeblock()) {
-    RunJobs(&PostFilter::DeblockFilterWorker<kLoopFilterTypeVertical>);
-    RunJobs(&PostFilter::DeblockFilterWorker<kLoopFilterTypeHorizontal>);
+bool PostFilter::CanApplyStage(int row_index) const {
+  const PostFilterRowState& state = row_states_[row_index];
+  if (state.scheduled || state.next_stage == kStageDone) return false;
+  // Returns true if the unit row at |index| does not exist or has completed
+  // |stage|.
+  const auto completed = [this](int index, Stage stage) {
+    return index < 0 || index >= num_unit_rows_ ||
+           row_states_[index].next_stage > stage;
+  };
+  switch (state.next_stage) {
+    case kStageDeblockVertical:
+      return true;
+    case kStageDeblockHorizontal:
+      return completed(row_index - 1, kStageDeblockVertical);
+    case kStageSetupBorders:
+      return completed(row_index + 1, kStageDeblockHorizontal);
+    case kStageCdef:
+      return completed(row_index - 1, kStageSetupBorders) &&
+             completed(row_index + 1, kStageSetupBorders);
+    case kStageSuperRes:
+      return completed(row_index - 1, kStageCdef);
+    case kStageLoopRestoration:
+      return completed(row_index - 1, kStageSuperRes);
+    default:
+      assert(false);
+      return false;
   }
-  if (DoCdef() && DoRestoration()) {
-    for (int row4x4 = 0; row4x4 < frame_header_.rows4x4;
-         row4x4 += kNum4x4InLoopFilterUnit) {
-      SetupLoopRestorationBorder(row4x4, kNum4x4InLoopFilterUnit);
-    }
+}
+
+void PostFilter::ApplyStage(Stage stage, int row_index) {
+  const int row4x4 = row_index * kNum4x4InLoopFilterUnit;
+  switch (stage) {
+    case kStageDeblockVertical:
+      VerticalDeblockFilter(row4x4, row4x4 + kNum4x4InLoopFilterUnit, 0,
+                            frame_header_.columns4x4);
+      break;
+    case kStageDeblockHorizontal:
+      HorizontalDeblockFilter(row4x4, row4x4 + kNum4x4InLoopFilterUnit, 0,
+                              frame_header_.columns4x4);
+      break;
+    case kStageSetupBorders:
+      if (DoCdef()) {
+        SetupCdefBorder(row4x4);
+        if (DoRestoration()) {
+          SetupLoopRestorationBorder(row4x4, kNum4x4InLoopFilterUnit);
+        }
+      } else if (DoSuperRes()) {
+        SetupSuperResLineBuffer(row4x4);
+      } else if (DoRestoration()) {
+        SetupLoopRestorationBorder(row4x4);
+      }
+      break;
+    case kStageCdef:
+      ApplyCdefForOneUnitRow(row4x4);
+      if (DoSuperRes()) SetupSuperResLineBuffer(row4x4);
+      break;
+    case kStageSuperRes:
+      ApplySuperResForOneUnitRow(row4x4);
+      // Without CDEF, the loop restoration border is copied from the output of
+      // SuperRes.
+      if (!DoCdef() && DoRestoration()) SetupLoopRestorationBorder(row4x4);
+      break;
+    case kStageLoopRestoration:
+      CopyBordersForOneSuperBlockRow(row4x4, kNum4x4InLoopRestorationUnit,
+                                     /*for_loop_restoration=*/true);
+      ApplyLoopRestoration(row4x4, kNum4x4InLoopRestorationUnit);
+      if (row_index == num_unit_rows_ - 1) {
+        // Loop restoration operates with a lag of 8 rows. So make sure to cover
+        // all the rows of the last unit row.
+        CopyBordersForOneSuperBlockRow(row4x4 + kNum4x4InLoopRestorationUnit,
+                                       kNum4x4InLoopRestorationUnit,
+                                       /*for_loop_restoration=*/true);
+        ApplyLoopRestoration(row4x4 + kNum4x4InLoopRestorationUnit,
+                             kNum4x4InLoopRestorationUnit);
+      }
+      break;
+    case kStageDone:
+      assert(false);
+      break;
   }
-  if (DoCdef()) {
-    for (int row4x4 = 0; row4x4 < frame_header_.rows4x4;
-         row4x4 += kNum4x4InLoopFilterUnit) {
-      SetupCdefBorder(row4x4);
+}
+
+void PostFilter::ApplyStagesWorker() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    if (num_ready_rows_ == 0) {
+      if (num_pending_rows_ == 0) break;
+      ready_condvar_.wait(lock);
+      continue;
+    }
+    const int row_index = ready_rows_[ready_rows_start_];
+    if (++ready_rows_start_ == num_unit_rows_) ready_rows_start_ = 0;
+    --num_ready_rows_;
+    const auto stage = static_cast<Stage>(row_states_[row_index].next_stage);
+    lock.unlock();
+    ApplyStage(stage, row_index);
+    lock.lock();
+    PostFilterRowState& state = row_states_[row_index];
+    state.next_stage = NextStage(stage);
+    state.scheduled = false;
+    if (state.next_stage == kStageDone && --num_pending_rows_ == 0) {
+      ready_condvar_.notify_all();
+      break;
+    }
+    // Completing |stage| may unblock the next stage of this unit row and of
+    // the unit rows above and below it.
+    int num_new_ready_rows = 0;
+    for (int index = std::max(row_index - 1, 0);
+         index <= std::min(row_index + 1, num_unit_rows_ - 1); ++index) {
+      if (!CanApplyStage(index)) continue;
+      row_states_[index].scheduled = true;
+      int end = ready_rows_start_ + num_ready_rows_;
+      if (end >= num_unit_rows_) end -= num_unit_rows_;
+      ready_rows_[end] = index;
+      ++num_ready_rows_;
+      ++num_new_ready_rows;
     }
-    RunJobs(&PostFilter::ApplyCdefWorker);
+    // This thread applies one of the new ready stages itself.
+    while (--num_new_ready_rows > 0) ready_condvar_.notify_one();
   }
-  if (DoSuperRes()) ApplySuperResThreaded();
-  if (DoRestoration()) {
-    if (!DoCdef()) {
-      int row4x4 = 0;
-      do {
-        SetupLoopRestorationBorder(row4x4);
-        row4x4 += kNum4x4InLoopFilterUnit;
-      } while (row4x4 < frame_header_.rows4x4);
+}
+
+void PostFilter::ApplyFilteringThreaded() {
+  const Stage first_stage =
+      DoDeblock() ? kStageDeblockVertical : NextStage(kStageDeblockHorizontal);
+  if (first_stage != kStageDone) {
+    num_unit_rows_ = RightShiftWithCeiling(frame_header_.rows4x4, 4);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ready_rows_start_ = 0;
+      num_ready_rows_ = 0;
+      num_pending_rows_ = num_unit_rows_;
+      for (int i = 0; i < num_unit_rows_; ++i) {
+        row_states_[i].next_stage = first_stage;
+        row_states_[i].scheduled = false;
+      }
+      for (int i = 0; i < num_unit_rows_; ++i) {
+        if (!CanApplyStage(i)) continue;
+        row_states_[i].scheduled = true;
+        ready_rows_[num_ready_rows_++] = i;
+      }
+    }
+    const int num_workers = thread_pool_->num_threads();
+    BlockingCounter pending_workers(num_workers);
+    for (int i = 0; i < num_workers; ++i) {
+      thread_pool_->Schedule([this, &pending_workers]() {
+        ApplyStagesWorker();
+        pending_workers.Decrement();
+      });
     }
-    RunJobs(&PostFilter::ApplyLoopRestorationWorker);
+    // Run the jobs on the current thread.
+    ApplyStagesWorker();
+    // Wait for the threadpool jobs to finish.
+    pending_workers.Wait();
   }
   ExtendBordersForReferenceFrame();
 }
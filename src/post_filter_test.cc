@@ -22,6 +22,7 @@
 #include <cstring>
 #include <ostream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "absl/time/clock.h"
@@ -29,13 +30,16 @@
 #include "gtest/gtest.h"
 #include "src/dsp/cdef.h"
 #include "src/dsp/dsp.h"
+#include "src/dsp/loop_filter.h"
 #include "src/dsp/super_res.h"
 #include "src/frame_scratch_buffer.h"
 #include "src/obu_parser.h"
 #include "src/threading_strategy.h"
 #include "src/utils/array_2d.h"
+#include "src/utils/block_parameters_holder.h"
 #include "src/utils/common.h"
 #include "src/utils/constants.h"
+#include "src/utils/cpu.h"
 #include "src/utils/memory.h"
 #include "src/utils/types.h"
 #include "src/yuv_buffer.h"
@@ -490,10 +494,18 @@ void PostFilterSuperResTest<bitdepth, Pixel>::TestApplySuperRes(
         Align(SubsampledValue(frame_header.upscaled_width, 1), 16) *
         pixel_size));
   }
+  const int num_unit_rows = RightShiftWithCeiling(frame_header.rows4x4, 4);
+  if (multi_threaded) {
+    ASSERT_TRUE(
+        frame_scratch_buffer.post_filter_row_states.Resize(num_unit_rows));
+    ASSERT_TRUE(
+        frame_scratch_buffer.post_filter_ready_rows.Resize(num_unit_rows));
+  }
   ASSERT_TRUE(frame_scratch_buffer.superres_line_buffer.Realloc(
       sequence_header.color_config.bitdepth,
       sequence_header.color_config.is_monochrome,
-      MultiplyBy4(frame_header.columns4x4), (multi_threaded ? kNumThreads : 1),
+      MultiplyBy4(frame_header.columns4x4),
+      (multi_threaded ? num_unit_rows : 1),
       sequence_header.color_config.subsampling_x,
       /*subsampling_y=*/0, 2 * kSuperResHorizontalBorder,
       2 * (kSuperResHorizontalBorder + kSuperResHorizontalPadding), 0, 0,
@@ -539,7 +551,8 @@ void PostFilterSuperResTest<bitdepth, Pixel>::TestApplySuperRes(
   }
 
   if (multi_threaded) {
-    post_filter.ApplySuperResThreaded();
+    // Only SuperRes is applied, since the filter mask is set to 0x04.
+    post_filter.ApplyFilteringThreaded();
   } else {
     std::array<uint8_t*, kMaxPlanes> buffers = {
         post_filter.cdef_buffer_[kPlaneY], post_filter.cdef_buffer_[kPlaneU],
@@ -877,8 +890,12 @@ void PostFilterApplyCdefTest<bitdepth, Pixel>::TestMultiThread(
   ASSERT_TRUE(frame_scratch_buffer_.threading_strategy.Reset(frame_header_,
                                                              num_threads));
   if (num_threads > 1) {
-    const int num_units =
-        MultiplyBy4(RightShiftWithCeiling(frame_header_.rows4x4, 4));
+    const int num_unit_rows = RightShiftWithCeiling(frame_header_.rows4x4, 4);
+    ASSERT_TRUE(
+        frame_scratch_buffer_.post_filter_row_states.Resize(num_unit_rows));
+    ASSERT_TRUE(
+        frame_scratch_buffer_.post_filter_ready_rows.Resize(num_unit_rows));
+    const int num_units = MultiplyBy4(num_unit_rows);
     ASSERT_TRUE(frame_scratch_buffer_.cdef_border.Realloc(
         bitdepth, /*is_monochrome=*/false,
         MultiplyBy4(frame_header_.columns4x4), num_units,
@@ -953,4 +970,427 @@ INSTANTIATE_TEST_SUITE_P(PostFilterApplyCdefTestInstance,
                          testing::ValuesIn(kTestParamApplyCdef));
 #endif  // LIBGAV1_MAX_BITDEPTH >= 10
 
+namespace {
+
+BlockSize GetBlockSize(int width4x4, int height4x4) {
+  for (int i = kBlock4x4; i < kMaxBlockSizes; ++i) {
+    if (kNum4x4BlocksWide[i] == width4x4 && kNum4x4BlocksHigh[i] == height4x4) {
+      return static_cast<BlockSize>(i);
+    }
+  }
+  return kBlockInvalid;
+}
+
+// Returns a random transform size that fits in a |width| x |height| block
+// with neither dimension larger than |max_size|.
+TransformSize GetRandomTransformSize(libvpx_test::ACMRandom* rnd, int width,
+                                     int height, int max_size) {
+  TransformSize sizes[kNumTransformSizes];
+  int num_sizes = 0;
+  for (int i = 0; i < kNumTransformSizes; ++i) {
+    if (kTransformWidth[i] <= std::min(width, max_size) &&
+        kTransformHeight[i] <= std::min(height, max_size)) {
+      sizes[num_sizes++] = static_cast<TransformSize>(i);
+    }
+  }
+  return sizes[rnd->Rand8() % num_sizes];
+}
+
+}  // namespace
+
+// Runs the deblocking filter on a randomly partitioned frame and compares the
+// result with a reference which filters one edge segment at a time and decides
+// whether two 4x4 blocks belong to the same block by comparing their
+// BlockParameters pointers, as the deblocking filter did before the
+// DeblockParameters array was added.
+template <int bitdepth, typename Pixel>
+class PostFilterDeblockTest : public testing::TestWithParam<FrameSizeParam>,
+                              public test_utils::MaxAlignedAllocable {
+ public:
+  PostFilterDeblockTest() = default;
+  PostFilterDeblockTest(const PostFilterDeblockTest&) = delete;
+  PostFilterDeblockTest& operator=(const PostFilterDeblockTest&) = delete;
+  ~PostFilterDeblockTest() override = default;
+
+ protected:
+  // The reference planes are copied with this many pixels of border on each
+  // side so that the reference filters never read out of bounds.
+  static constexpr int kReferenceBorder = 8;
+
+  void SetUp() override {
+    test_utils::ResetDspTable(bitdepth);
+    dsp::LoopFilterInit_C();
+    const uint32_t cpu_features = GetCpuInfo();
+    if ((cpu_features & kSSE4_1) != 0) dsp::LoopFilterInit_SSE4_1();
+    if ((cpu_features & kAVX2) != 0) dsp::LoopFilterInit_AVX2();
+    dsp::LoopFilterInit_NEON();
+
+    dsp_ = dsp::GetDspTable(bitdepth);
+    ASSERT_NE(dsp_, nullptr);
+  }
+
+  // Sets sequence_header_ and frame_header_, partitions the frame and
+  // allocates yuv_buffer_.
+  void SetInput(libvpx_test::ACMRandom* rnd);
+  void Partition(libvpx_test::ACMRandom* rnd, int row4x4, int column4x4,
+                 int size4x4);
+  void AddBlock(libvpx_test::ACMRandom* rnd, int row4x4, int column4x4,
+                int width4x4, int height4x4);
+  // Fills yuv_buffer_ with blocky random content that the filters will
+  // modify and copies it to reference_.
+  void SetInputBuffer(libvpx_test::ACMRandom* rnd, PostFilter* post_filter);
+  // Returns the filter level of the edge of |plane| at the luma position
+  // |row4x4|, |column4x4| and sets |step| and |filter_length|. Returns 0 if
+  // the edge is not filtered.
+  uint8_t GetReferenceEdgeInfo(Plane plane, LoopFilterType type, int row4x4,
+                               int column4x4, int* step,
+                               int* filter_length) const;
+  void ReferenceDeblock(const PostFilter& post_filter);
+  void Test();
+
+  ObuSequenceHeader sequence_header_;
+  ObuFrameHeader frame_header_ = {};
+  FrameScratchBuffer frame_scratch_buffer_;
+  YuvBuffer yuv_buffer_;
+  const dsp::Dsp* dsp_;
+  FrameSizeParam param_ = GetParam();
+  int num_blocks_ = 0;
+  // The deblocking filter levels of each block, looked up by the
+  // BlockParameters pointer.
+  std::unordered_map<const BlockParameters*,
+                     std::array<uint8_t, kFrameLfCount>>
+      filter_levels_;
+  std::vector<Pixel> reference_[kMaxPlanes];
+  int reference_stride_[kMaxPlanes];
+};
+
+template <int bitdepth, typename Pixel>
+void PostFilterDeblockTest<bitdepth, Pixel>::SetInput(
+    libvpx_test::ACMRandom* rnd) {
+  sequence_header_.color_config.bitdepth = bitdepth;
+  sequence_header_.color_config.subsampling_x = param_.subsampling_x;
+  sequence_header_.color_config.subsampling_y = param_.subsampling_y;
+  sequence_header_.color_config.is_monochrome = false;
+  sequence_header_.use_128x128_superblock =
+      static_cast<bool>(rnd->Rand16() & 1);
+
+  frame_header_.width = param_.width;
+  frame_header_.upscaled_width = param_.upscaled_width;
+  frame_header_.height = param_.height;
+  frame_header_.columns4x4 = DivideBy4(Align(frame_header_.width, 8));
+  frame_header_.rows4x4 = DivideBy4(Align(frame_header_.height, 8));
+  frame_header_.tile_info.tile_count = 1;
+  frame_header_.refresh_frame_flags = 0;
+  // The per block levels are random. The frame levels only need to enable
+  // the filter for all the planes.
+  for (auto& level : frame_header_.loop_filter.level) {
+    level = 1 + (rnd->Rand8() % kMaxLoopFilterValue);
+  }
+  frame_header_.loop_filter.sharpness = rnd->Rand8() & 7;
+
+  const int rows4x4 = frame_header_.rows4x4;
+  const int columns4x4 = frame_header_.columns4x4;
+  ASSERT_TRUE(
+      frame_scratch_buffer_.block_parameters_holder.Reset(rows4x4, columns4x4));
+  ASSERT_TRUE(
+      frame_scratch_buffer_.inter_transform_sizes.Reset(rows4x4, columns4x4));
+  filter_levels_.clear();
+  num_blocks_ = 0;
+  const int sb4x4 = sequence_header_.use_128x128_superblock ? 32 : 16;
+  for (int row4x4 = 0; row4x4 < rows4x4; row4x4 += sb4x4) {
+    for (int column4x4 = 0; column4x4 < columns4x4; column4x4 += sb4x4) {
+      Partition(rnd, row4x4, column4x4, sb4x4);
+    }
+  }
+
+  ASSERT_TRUE(yuv_buffer_.Realloc(
+      sequence_header_.color_config.bitdepth,
+      sequence_header_.color_config.is_monochrome, frame_header_.upscaled_width,
+      frame_header_.height, sequence_header_.color_config.subsampling_x,
+      sequence_header_.color_config.subsampling_y, kBorderPixels, kBorderPixels,
+      kBorderPixels, kBorderPixels, nullptr, nullptr, nullptr))
+      << "Failed to allocate source buffer.";
+}
+
+// Recursively partitions the square block of |size4x4| 4x4 blocks at
+// |row4x4|, |column4x4| with random square, horizontal and vertical
+// partitions.
+template <int bitdepth, typename Pixel>
+void PostFilterDeblockTest<bitdepth, Pixel>::Partition(
+    libvpx_test::ACMRandom* rnd, int row4x4, int column4x4, int size4x4) {
+  if (row4x4 >= frame_header_.rows4x4 ||
+      column4x4 >= frame_header_.columns4x4) {
+    return;
+  }
+  const int half4x4 = size4x4 >> 1;
+  switch (size4x4 == 1 ? 0 : rnd->Rand8() % 5) {
+    case 0:
+      AddBlock(rnd, row4x4, column4x4, size4x4, size4x4);
+      break;
+    case 1:
+      AddBlock(rnd, row4x4, column4x4, size4x4, half4x4);
+      AddBlock(rnd, row4x4 + half4x4, column4x4, size4x4, half4x4);
+      break;
+    case 2:
+      AddBlock(rnd, row4x4, column4x4, half4x4, size4x4);
+      AddBlock(rnd, row4x4, column4x4 + half4x4, half4x4, size4x4);
+      break;
+    default:
+      Partition(rnd, row4x4, column4x4, half4x4);
+      Partition(rnd, row4x4, column4x4 + half4x4, half4x4);
+      Partition(rnd, row4x4 + half4x4, column4x4, half4x4);
+      Partition(rnd, row4x4 + half4x4, column4x4 + half4x4, half4x4);
+      break;
+  }
+}
+
+// Adds a block with random deblocking parameters which is tiled by a random
+// luma transform size. The same values are stored in the BlockParameters (and
+// |filter_levels_|) read by the reference and in the DeblockParameters read by
+// the PostFilter.
+template <int bitdepth, typename Pixel>
+void PostFilterDeblockTest<bitdepth, Pixel>::AddBlock(
+    libvpx_test::ACMRandom* rnd, int row4x4, int column4x4, int width4x4,
+    int height4x4) {
+  const int rows4x4 = frame_header_.rows4x4;
+  const int columns4x4 = frame_header_.columns4x4;
+  if (row4x4 >= rows4x4 || column4x4 >= columns4x4) return;
+  const BlockSize block_size = GetBlockSize(width4x4, height4x4);
+  ASSERT_NE(block_size, kBlockInvalid);
+  BlockParametersHolder& holder = frame_scratch_buffer_.block_parameters_holder;
+  BlockParameters* const bp = holder.Get(row4x4, column4x4, block_size);
+  ASSERT_NE(bp, nullptr);
+  ++num_blocks_;
+  bp->size = block_size;
+  bp->skip = (rnd->Rand8() & 1) != 0;
+  bp->is_inter = (rnd->Rand8() & 1) != 0;
+  const int width = MultiplyBy4(width4x4);
+  const int height = MultiplyBy4(height4x4);
+  bp->uv_transform_size = GetRandomTransformSize(
+      rnd, std::max(width >> param_.subsampling_x, 4),
+      std::max(height >> param_.subsampling_y, 4), 32);
+  DeblockParameters params;
+  std::array<uint8_t, kFrameLfCount>& levels = filter_levels_[bp];
+  for (int i = 0; i < kFrameLfCount; ++i) {
+    // A zero level is common so that both sides of the borders are used.
+    levels[i] = ((rnd->Rand8() & 3) == 0) ? 0 : rnd->Rand8() & 63;
+    params.filter_level[i] = levels[i];
+  }
+  params.uv_transform_size = bp->uv_transform_size;
+  params.skip = bp->skip && bp->is_inter;
+  holder.FillDeblockParameters(row4x4, column4x4, block_size, params);
+
+  const TransformSize tx_size = GetRandomTransformSize(rnd, width, height, 64);
+  const int rows = std::min(height4x4, rows4x4 - row4x4);
+  const int columns = std::min(width4x4, columns4x4 - column4x4);
+  for (int y = 0; y < rows; ++y) {
+    for (int x = 0; x < columns; ++x) {
+      frame_scratch_buffer_.inter_transform_sizes[row4x4 + y][column4x4 + x] =
+          tx_size;
+    }
+  }
+}
+
+template <int bitdepth, typename Pixel>
+void PostFilterDeblockTest<bitdepth, Pixel>::SetInputBuffer(
+    libvpx_test::ACMRandom* rnd, PostFilter* post_filter) {
+  const int mid = 1 << (bitdepth - 1);
+  const int shift = bitdepth - 8;
+  for (int plane = kPlaneY; plane < kMaxPlanes; ++plane) {
+    const int subsampling_x = (plane == 0) ? 0 : param_.subsampling_x;
+    const int subsampling_y = (plane == 0) ? 0 : param_.subsampling_y;
+    const int plane_width =
+        MultiplyBy4(frame_header_.columns4x4) >> subsampling_x;
+    const int plane_height =
+        MultiplyBy4(frame_header_.rows4x4) >> subsampling_y;
+    auto* src =
+        reinterpret_cast<Pixel*>(post_filter->GetUnfilteredBuffer(plane));
+    const int src_stride = yuv_buffer_.stride(plane) / sizeof(src[0]);
+    reference_stride_[plane] = plane_width + 2 * kReferenceBorder;
+    reference_[plane].resize(reference_stride_[plane] *
+                             (plane_height + 2 * kReferenceBorder));
+    // Each 8x8 area gets a random level close to the middle of the range,
+    // plus a little noise, so that most of the edges between them pass the
+    // filter masks.
+    std::vector<int> base(DivideBy8(plane_width + 2 * kReferenceBorder));
+    Pixel* ref = reference_[plane].data();
+    src -= kReferenceBorder * src_stride + kReferenceBorder;
+    for (int y = 0; y < plane_height + 2 * kReferenceBorder; ++y) {
+      if ((y & 7) == 0) {
+        for (auto& b : base) b = mid + ((rnd->Rand8() % 33 - 16) << shift);
+      }
+      for (int x = 0; x < reference_stride_[plane]; ++x) {
+        src[x] = base[DivideBy8(x)] + ((rnd->Rand8() & 3) << shift);
+        ref[x] = src[x];
+      }
+      src += src_stride;
+      ref += reference_stride_[plane];
+    }
+  }
+}
+
+template <int bitdepth, typename Pixel>
+uint8_t PostFilterDeblockTest<bitdepth, Pixel>::GetReferenceEdgeInfo(
+    Plane plane, LoopFilterType type, int row4x4, int column4x4, int* step,
+    int* filter_length) const {
+  const int subsampling_x = (plane == kPlaneY) ? 0 : param_.subsampling_x;
+  const int subsampling_y = (plane == kPlaneY) ? 0 : param_.subsampling_y;
+  row4x4 = GetDeblockPosition(row4x4, subsampling_y);
+  column4x4 = GetDeblockPosition(column4x4, subsampling_x);
+  const bool vertical = type == kLoopFilterTypeVertical;
+  const uint8_t* const tx_length =
+      vertical ? kTransformWidth : kTransformHeight;
+  const BlockParametersHolder& holder =
+      frame_scratch_buffer_.block_parameters_holder;
+  const Array2D<TransformSize>& inter_transform_sizes =
+      frame_scratch_buffer_.inter_transform_sizes;
+  const BlockParameters* const bp = holder.Find(row4x4, column4x4);
+  *step = tx_length[(plane == kPlaneY)
+                        ? inter_transform_sizes[row4x4][column4x4]
+                        : bp->uv_transform_size];
+  const int row4x4_prev = vertical ? row4x4 : row4x4 - (1 << subsampling_y);
+  const int column4x4_prev =
+      vertical ? column4x4 - (1 << subsampling_x) : column4x4;
+  if (row4x4_prev < 0 || column4x4_prev < 0) return 0;
+  if (frame_header_.loop_filter.level[plane + 1] == 0 && plane != kPlaneY) {
+    return 0;
+  }
+
+  const BlockParameters* const bp_prev =
+      holder.Find(row4x4_prev, column4x4_prev);
+  const int step_prev =
+      tx_length[(plane == kPlaneY)
+                    ? inter_transform_sizes[row4x4_prev][column4x4_prev]
+                    : bp_prev->uv_transform_size];
+  *filter_length = std::min(*step, step_prev);
+  const int filter_id = kDeblockFilterLevelIndex[plane][type];
+  const uint8_t level = filter_levels_.at(bp)[filter_id];
+  if (bp == bp_prev) {
+    // Not a border.
+    return (bp->skip && bp->is_inter) ? 0 : level;
+  }
+  return (level != 0) ? level : filter_levels_.at(bp_prev)[filter_id];
+}
+
+// Applies the vertical and then the horizontal edges of each plane to
+// |reference_| in raster order (Section 7.14.1).
+template <int bitdepth, typename Pixel>
+void PostFilterDeblockTest<bitdepth, Pixel>::ReferenceDeblock(
+    const PostFilter& post_filter) {
+  const int height4x4 = DivideBy4(frame_header_.height + 3);
+  const int width4x4 = DivideBy4(frame_header_.width + 3);
+  for (int plane = kPlaneY; plane < kMaxPlanes; ++plane) {
+    const int subsampling_x = (plane == 0) ? 0 : param_.subsampling_x;
+    const int subsampling_y = (plane == 0) ? 0 : param_.subsampling_y;
+    const ptrdiff_t stride = reference_stride_[plane];
+    Pixel* const ref = reference_[plane].data() + kReferenceBorder * stride +
+                       kReferenceBorder;
+    for (int type = kLoopFilterTypeVertical; type < kNumLoopFilterTypes;
+         ++type) {
+      const bool vertical = type == kLoopFilterTypeVertical;
+      const int outer_end = vertical ? height4x4 : width4x4;
+      const int inner_end = vertical ? width4x4 : height4x4;
+      const int outer_step = 1 << (vertical ? subsampling_y : subsampling_x);
+      const int inner_subsampling = vertical ? subsampling_x : subsampling_y;
+      for (int i = 0; i < outer_end; i += outer_step) {
+        int step;
+        for (int j = 0; j < inner_end;
+             j += DivideBy4(step << inner_subsampling)) {
+          const int row4x4 = vertical ? i : j;
+          const int column4x4 = vertical ? j : i;
+          int filter_length;
+          const uint8_t level = GetReferenceEdgeInfo(
+              static_cast<Plane>(plane), static_cast<LoopFilterType>(type),
+              row4x4, column4x4, &step, &filter_length);
+          if (level == 0) continue;
+          dsp::LoopFilterSize size;
+          if (filter_length == 4) {
+            size = dsp::kLoopFilterSize4;
+          } else if (plane != kPlaneY) {
+            size = dsp::kLoopFilterSize6;
+          } else {
+            size = (filter_length == 8) ? dsp::kLoopFilterSize8
+                                        : dsp::kLoopFilterSize14;
+          }
+          Pixel* const dst = ref +
+                             MultiplyBy4(row4x4 >> subsampling_y) * stride +
+                             MultiplyBy4(column4x4 >> subsampling_x);
+          dsp_->loop_filters[size][type](
+              dst, stride * sizeof(Pixel), post_filter.outer_thresh_[level],
+              post_filter.inner_thresh_[level], DivideBy16(level));
+        }
+      }
+    }
+  }
+}
+
+template <int bitdepth, typename Pixel>
+void PostFilterDeblockTest<bitdepth, Pixel>::Test() {
+  libvpx_test::ACMRandom rnd(libvpx_test::ACMRandom::DeterministicSeed());
+  for (int i = 0; i < 4; ++i) {
+    SetInput(&rnd);
+    ASSERT_GT(num_blocks_, 0);
+    PostFilter post_filter(frame_header_, sequence_header_,
+                           &frame_scratch_buffer_, &yuv_buffer_, dsp_,
+                           /*do_post_filter_mask=*/0x01);
+    ASSERT_TRUE(post_filter.DoDeblock());
+    SetInputBuffer(&rnd, &post_filter);
+    ReferenceDeblock(post_filter);
+
+    const int sb4x4 = sequence_header_.use_128x128_superblock ? 32 : 16;
+    for (int row4x4 = 0; row4x4 < frame_header_.rows4x4; row4x4 += sb4x4) {
+      post_filter.ApplyFilteringForOneSuperBlockRow(
+          row4x4, sb4x4, row4x4 + sb4x4 >= frame_header_.rows4x4,
+          /*do_deblock=*/true);
+    }
+
+    for (int plane = kPlaneY; plane < kMaxPlanes; ++plane) {
+      const int subsampling_x = (plane == 0) ? 0 : param_.subsampling_x;
+      const int subsampling_y = (plane == 0) ? 0 : param_.subsampling_y;
+      const int plane_width =
+          MultiplyBy4(frame_header_.columns4x4) >> subsampling_x;
+      const int plane_height =
+          MultiplyBy4(frame_header_.rows4x4) >> subsampling_y;
+      const auto* src = reinterpret_cast<const Pixel*>(
+          post_filter.GetUnfilteredBuffer(plane));
+      const int src_stride = yuv_buffer_.stride(plane) / sizeof(src[0]);
+      const Pixel* ref = reference_[plane].data() +
+                         kReferenceBorder * reference_stride_[plane] +
+                         kReferenceBorder;
+      for (int y = 0; y < plane_height; ++y) {
+        for (int x = 0; x < plane_width; ++x) {
+          ASSERT_EQ(src[x], ref[x]) << "plane: " << plane << " y: " << y
+                                    << " x: " << x << " iteration: " << i;
+        }
+        src += src_stride;
+        ref += reference_stride_[plane];
+      }
+    }
+  }
+}
+
+const FrameSizeParam kTestParamDeblock[] = {
+    FrameSizeParam(352, 352, 288, 0, 0), FrameSizeParam(251, 251, 187, 0, 0),
+    FrameSizeParam(352, 352, 288, 1, 0), FrameSizeParam(251, 251, 187, 1, 0),
+    FrameSizeParam(352, 352, 288, 1, 1), FrameSizeParam(251, 251, 187, 1, 1),
+};
+
+using PostFilterDeblockTest8bpp = PostFilterDeblockTest<8, uint8_t>;
+
+TEST_P(PostFilterDeblockTest8bpp, MatchesBlockParametersReference) { Test(); }
+
+INSTANTIATE_TEST_SUITE_P(PostFilterDeblockTestInstance,
+                         PostFilterDeblockTest8bpp,
+                         testing::ValuesIn(kTestParamDeblock));
+
+#if LIBGAV1_MAX_BITDEPTH >= 10
+using PostFilterDeblockTest10bpp = PostFilterDeblockTest<10, uint16_t>;
+
+TEST_P(PostFilterDeblockTest10bpp, MatchesBlockParametersReference) { Test(); }
+
+INSTANTIATE_TEST_SUITE_P(PostFilterDeblockTestInstance,
+                         PostFilterDeblockTest10bpp,
+                         testing::ValuesIn(kTestParamDeblock));
+#endif  // LIBGAV1_MAX_BITDEPTH >= 10
+
 }  // namespace libgav1
@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cassert>
 #include <memory>
+#include <mutex>  // NOLINT (unapproved c++11 header)
 
 #include "src/frame_scratch_buffer.h"
 #include "src/utils/constants.h"
@@ -64,6 +65,22 @@ int ComputeFrameThreadCount(int thread_count, int tile_count,
              : std::max(2, thread_count / (1 + tile_columns));
 }
 
+// The weight of the most recent frame in the moving averages of the stage
+// costs.
+constexpr double kStageCostUpdateWeight = 0.25;
+
+// An intra-frame thread is only worth using if the threads of a frame are
+// predicted to be busy for at least this fraction of the frame time. Otherwise
+// the thread is more useful decoding another frame.
+constexpr double kMinParallelEfficiency = 0.6;
+
+// Hysteresis for changing the split of the threads: the current split is kept
+// unless its efficiency is below kMinParallelEfficiency by more than this
+// factor, or more threads per frame are predicted to make the frames faster by
+// more than this factor. This avoids recreating the thread pools because of
+// noise in the measurements.
+constexpr double kRebalanceThreshold = 1.1;
+
 }  // namespace
 
 bool ThreadingStrategy::Reset(const ObuFrameHeader& frame_header,
@@ -82,15 +99,10 @@ bool ThreadingStrategy::Reset(const ObuFrameHeader& frame_header,
   // |thread_count|-1 threads in the threadpool.
   thread_count = std::min(thread_count, static_cast<int>(kMaxThreads)) - 1;
 
-  if (thread_pool_ == nullptr || thread_pool_->num_threads() != thread_count) {
-    thread_pool_ = ThreadPool::Create("libgav1", thread_count);
-    if (thread_pool_ == nullptr) {
-      LIBGAV1_DLOG(ERROR, "Failed to create a thread pool with %d threads.",
-                   thread_count);
-      tile_thread_count_ = 0;
-      max_tile_index_for_row_threads_ = 0;
-      return false;
-    }
+  if (!CreateThreadPool("libgav1", thread_count)) {
+    tile_thread_count_ = 0;
+    max_tile_index_for_row_threads_ = 0;
+    return false;
   }
 
   // Prefer tile threads first (but only if there is more than one tile).
@@ -150,7 +162,7 @@ bool ThreadingStrategy::Reset(const ObuFrameHeader& frame_header,
 }
 
 bool ThreadingStrategy::Reset(int thread_count) {
-  assert(thread_count > 0);
+  assert(thread_count >= 0);
   frame_parallel_ = true;
 
   // In frame parallel mode, we simply access the underlying |thread_pool_|
@@ -160,36 +172,196 @@ bool ThreadingStrategy::Reset(int thread_count) {
   tile_thread_count_ = 0;
   max_tile_index_for_row_threads_ = 0;
 
-  if (thread_pool_ == nullptr || thread_pool_->num_threads() != thread_count) {
-    thread_pool_ = ThreadPool::Create("libgav1-fp", thread_count);
-    if (thread_pool_ == nullptr) {
-      LIBGAV1_DLOG(ERROR, "Failed to create a thread pool with %d threads.",
-                   thread_count);
-      return false;
-    }
+  if (thread_count == 0) {
+    thread_pool_.reset(nullptr);
+    return true;
+  }
+  return CreateThreadPool("libgav1-fp", thread_count);
+}
+
+bool ThreadingStrategy::Reset(ThreadPool* const shared_pool) {
+  assert(shared_pool != nullptr);
+  frame_parallel_ = true;
+  tile_thread_count_ = 0;
+  max_tile_index_for_row_threads_ = 0;
+  if (thread_pool_ != nullptr && thread_pool_->parent() == shared_pool) {
+    return true;
+  }
+  thread_pool_ = ThreadPool::CreateNested(shared_pool);
+  if (thread_pool_ == nullptr) {
+    LIBGAV1_DLOG(ERROR, "Failed to create a nested thread pool.");
+    return false;
   }
   return true;
 }
 
+bool ThreadingStrategy::CreateThreadPool(const char name_prefix[],
+                                         int thread_count) {
+  const ThreadPool::Type type = (external_scheduler_ != nullptr)
+                                    ? ThreadPool::kTypeExternal
+                                    : ThreadPool::kTypeSharedQueue;
+  if (thread_pool_ != nullptr && thread_pool_->num_threads() == thread_count &&
+      thread_pool_->type() == type) {
+    return true;
+  }
+  thread_pool_ =
+      (external_scheduler_ != nullptr)
+          ? ThreadPool::CreateExternal(*external_scheduler_, thread_count)
+          : ThreadPool::Create(name_prefix, thread_count,
+                               ThreadPool::kTypeSharedQueue, cpu_affinity_);
+  if (thread_pool_ == nullptr) {
+    LIBGAV1_DLOG(ERROR, "Failed to create a thread pool with %d threads.",
+                 thread_count);
+    return false;
+  }
+  return true;
+}
+
+void AdaptiveThreadAllocator::Init(int thread_count, int max_frame_threads,
+                                   int frame_threads, int threads_per_frame) {
+  assert(frame_threads > 0 && frame_threads <= max_frame_threads);
+  assert(frame_threads * (1 + threads_per_frame) <= thread_count);
+  std::lock_guard<std::mutex> lock(mutex_);
+  thread_count_ = thread_count;
+  max_frame_threads_ = max_frame_threads;
+  tile_count_ = 1;
+  has_costs_ = false;
+  parse_cost_ = 0;
+  reconstruction_cost_ = 0;
+  post_filter_cost_ = 0;
+  frame_threads_.store(frame_threads, std::memory_order_relaxed);
+  threads_per_frame_.store(threads_per_frame, std::memory_order_relaxed);
+}
+
+double AdaptiveThreadAllocator::PredictFrameTime(int threads_per_frame) const {
+  if (threads_per_frame == 0) {
+    return parse_cost_ + reconstruction_cost_ + post_filter_cost_;
+  }
+  const int parse_parallelism = std::min(threads_per_frame + 1, tile_count_);
+  const int reconstruction_parallelism =
+      std::min(threads_per_frame, tile_count_);
+  return parse_cost_ / parse_parallelism +
+         std::max(reconstruction_cost_ / reconstruction_parallelism,
+                  post_filter_cost_);
+}
+
+void AdaptiveThreadAllocator::AddFrame(const FrameStageCosts& costs,
+                                       int tile_count, int threads_per_frame) {
+  assert(tile_count > 0);
+  assert(threads_per_frame >= 0);
+  // Convert the measured times into the times the stages would take on a
+  // single thread, using the same model as PredictFrameTime().
+  const double parse =
+      static_cast<double>(costs.parse) *
+      std::min(threads_per_frame + 1, tile_count);
+  const double reconstruction =
+      static_cast<double>(costs.reconstruction) *
+      std::max(1, std::min(threads_per_frame, tile_count));
+  const auto post_filter = static_cast<double>(costs.post_filter);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (thread_count_ == 0) return;
+  tile_count_ = tile_count;
+  if (!has_costs_) {
+    parse_cost_ = parse;
+    reconstruction_cost_ = reconstruction;
+    post_filter_cost_ = post_filter;
+    has_costs_ = true;
+  } else {
+    parse_cost_ += kStageCostUpdateWeight * (parse - parse_cost_);
+    reconstruction_cost_ +=
+        kStageCostUpdateWeight * (reconstruction - reconstruction_cost_);
+    post_filter_cost_ +=
+        kStageCostUpdateWeight * (post_filter - post_filter_cost_);
+  }
+  if (parse_cost_ + reconstruction_cost_ + post_filter_cost_ <= 0) return;
+
+  const double serial_time = PredictFrameTime(0);
+  if (serial_time <= 0) return;
+
+  // The fraction of the time the threads of a frame are busy.
+  const auto efficiency = [this, serial_time](int threads_per_frame) {
+    return serial_time /
+           ((1 + threads_per_frame) * PredictFrameTime(threads_per_frame));
+  };
+  // Find the largest number of intra-frame threads that are kept busy for at
+  // least kMinParallelEfficiency of the frame time, as long as at least two
+  // frames can still be decoded in parallel (see ComputeFrameThreadCount()).
+  int best_threads_per_frame = 0;
+  for (int threads_per_frame = 1;
+       thread_count_ / (1 + threads_per_frame) >= 2; ++threads_per_frame) {
+    if (efficiency(threads_per_frame) >= kMinParallelEfficiency) {
+      best_threads_per_frame = threads_per_frame;
+    }
+  }
+  // Release the threads that mostly idle, but only add threads if that makes
+  // the frames noticeably faster.
+  const int current_threads_per_frame =
+      threads_per_frame_.load(std::memory_order_relaxed);
+  if (best_threads_per_frame == current_threads_per_frame) return;
+  if (efficiency(current_threads_per_frame) >=
+          kMinParallelEfficiency / kRebalanceThreshold &&
+      (best_threads_per_frame < current_threads_per_frame ||
+       PredictFrameTime(best_threads_per_frame) * kRebalanceThreshold >=
+           PredictFrameTime(current_threads_per_frame))) {
+    return;
+  }
+  frame_threads_.store(
+      std::min(max_frame_threads_,
+               thread_count_ / (1 + best_threads_per_frame)),
+      std::memory_order_relaxed);
+  threads_per_frame_.store(best_threads_per_frame, std::memory_order_relaxed);
+}
+
 bool InitializeThreadPoolsForFrameParallel(
     int thread_count, int tile_count, int tile_columns,
+    const ExternalScheduler* const external_scheduler,
+    const CpuAffinity* const cpu_affinity,
+    AdaptiveThreadAllocator* const adaptive_thread_allocator,
+    std::unique_ptr<ThreadPool>* const shared_thread_pool,
     std::unique_ptr<ThreadPool>* const frame_thread_pool,
     FrameScratchBufferPool* const frame_scratch_buffer_pool) {
   assert(*frame_thread_pool == nullptr);
+  assert(adaptive_thread_allocator == nullptr || shared_thread_pool == nullptr);
+  assert(shared_thread_pool == nullptr || *shared_thread_pool == nullptr);
   thread_count = std::min(thread_count, static_cast<int>(kMaxThreads));
   const int frame_threads =
       ComputeFrameThreadCount(thread_count, tile_count, tile_columns);
   if (frame_threads == 0) return true;
-  *frame_thread_pool = ThreadPool::Create(frame_threads);
+  int remaining_threads = thread_count - frame_threads;
+  const int threads_per_frame = remaining_threads / frame_threads;
+  // The adaptive split uses the same number of threads for every frame.
+  const int extra_threads = (adaptive_thread_allocator != nullptr)
+                                ? 0
+                                : remaining_threads % frame_threads;
+  const int frame_thread_pool_size =
+      (adaptive_thread_allocator != nullptr) ? thread_count : frame_threads;
+  *frame_thread_pool =
+      ThreadPool::Create(/*name_prefix=*/"", frame_thread_pool_size,
+                         ThreadPool::kTypeSharedQueue, cpu_affinity);
   if (*frame_thread_pool == nullptr) {
     LIBGAV1_DLOG(ERROR, "Failed to create frame thread pool with %d threads.",
-                 frame_threads);
+                 frame_thread_pool_size);
     return false;
   }
-  int remaining_threads = thread_count - frame_threads;
+  if (adaptive_thread_allocator != nullptr) {
+    adaptive_thread_allocator->Init(thread_count, frame_thread_pool_size,
+                                    frame_threads, threads_per_frame);
+  }
   if (remaining_threads == 0) return true;
-  int threads_per_frame = remaining_threads / frame_threads;
-  const int extra_threads = remaining_threads % frame_threads;
+  if (shared_thread_pool != nullptr) {
+    *shared_thread_pool =
+        (external_scheduler != nullptr)
+            ? ThreadPool::CreateExternal(*external_scheduler,
+                                         remaining_threads)
+            : ThreadPool::Create("libgav1-fp", remaining_threads,
+                                 ThreadPool::kTypeWorkStealing, cpu_affinity);
+    if (*shared_thread_pool == nullptr) {
+      LIBGAV1_DLOG(ERROR,
+                   "Failed to create shared thread pool with %d threads.",
+                   remaining_threads);
+      return false;
+    }
+  }
   Vector<std::unique_ptr<FrameScratchBuffer>> frame_scratch_buffers;
   if (!frame_scratch_buffers.reserve(frame_threads)) return false;
   // Create the tile thread pools.
@@ -199,11 +371,24 @@ bool InitializeThreadPoolsForFrameParallel(
     if (frame_scratch_buffer == nullptr) {
       return false;
     }
+    if (shared_thread_pool != nullptr) {
+      // All the frame threads share the remaining threads.
+      if (!frame_scratch_buffer->threading_strategy.Reset(
+              shared_thread_pool->get())) {
+        return false;
+      }
+      frame_scratch_buffers.push_back_unchecked(
+          std::move(frame_scratch_buffer));
+      continue;
+    }
     // If the number of tile threads cannot be divided equally amongst all the
     // frame threads, assign one extra thread to the first |extra_threads| frame
     // threads.
     const int current_frame_thread_count =
         threads_per_frame + static_cast<int>(i < extra_threads);
+    frame_scratch_buffer->threading_strategy.set_external_scheduler(
+        external_scheduler);
+    frame_scratch_buffer->threading_strategy.set_cpu_affinity(cpu_affinity);
     if (!frame_scratch_buffer->threading_strategy.Reset(
             current_frame_thread_count)) {
       return false;
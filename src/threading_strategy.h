@@ -17,7 +17,10 @@
 #ifndef LIBGAV1_SRC_THREADING_STRATEGY_H_
 #define LIBGAV1_SRC_THREADING_STRATEGY_H_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <mutex>  // NOLINT (unapproved c++11 header)
 
 #include "src/obu_parser.h"
 #include "src/utils/compiler_attributes.h"
@@ -55,11 +58,35 @@ class ThreadingStrategy {
   // Creates or re-allocates a thread pool with |thread_count| threads. This
   // function is used only in frame parallel mode. This function is idempotent
   // if the |thread_count| doesn't change between calls (it will only create new
-  // threads on the first call and do nothing on the subsequent calls).
+  // threads on the first call and do nothing on the subsequent calls). If
+  // |thread_count| is 0, the thread pool is released.
   // Note: During the lifetime of a ThreadingStrategy object, only one of the
   // Reset() variants will be used.
   LIBGAV1_MUST_USE_RESULT bool Reset(int thread_count);
 
+  // Creates a thread pool of type ThreadPool::kTypeNested whose jobs run on
+  // the threads of |shared_pool|. This function is used only in frame parallel
+  // mode, when all the frames share |shared_pool|. This function is idempotent
+  // if |shared_pool| doesn't change between calls. |*shared_pool| must outlive
+  // this object.
+  // Note: During the lifetime of a ThreadingStrategy object, only one of the
+  // Reset() variants will be used.
+  LIBGAV1_MUST_USE_RESULT bool Reset(ThreadPool* shared_pool);
+
+  // If |scheduler| is not nullptr, the thread pools created by the subsequent
+  // Reset() calls run their jobs through |scheduler| instead of creating
+  // threads. |*scheduler| must outlive this object.
+  void set_external_scheduler(const ExternalScheduler* scheduler) {
+    external_scheduler_ = scheduler;
+  }
+
+  // If |affinity| is not nullptr, the worker threads of the thread pools
+  // created by the subsequent Reset() calls are pinned according to it.
+  // |*affinity| must outlive this object.
+  void set_cpu_affinity(const CpuAffinity* affinity) {
+    cpu_affinity_ = affinity;
+  }
+
   // Returns a pointer to the ThreadPool that is to be used for Tile
   // multi-threading.
   ThreadPool* tile_thread_pool() const {
@@ -94,12 +121,95 @@ class ThreadingStrategy {
   ThreadPool* film_grain_thread_pool() const { return thread_pool_.get(); }
 
  private:
+  // Creates |thread_pool_| with |thread_count| threads, using
+  // |external_scheduler_| if it is set. |name_prefix| is used for the names of
+  // the threads.
+  LIBGAV1_MUST_USE_RESULT bool CreateThreadPool(const char name_prefix[],
+                                                int thread_count);
+
+  const ExternalScheduler* external_scheduler_ = nullptr;
+  const CpuAffinity* cpu_affinity_ = nullptr;
   std::unique_ptr<ThreadPool> thread_pool_;
   int tile_thread_count_ = 0;
   int max_tile_index_for_row_threads_ = 0;
   bool frame_parallel_ = false;
 };
 
+// The wall clock time spent in each stage of the decoding of one frame, in
+// microseconds.
+struct FrameStageCosts {
+  // Entropy decoding of the tiles.
+  int64_t parse = 0;
+  // Prediction and reconstruction, including the deblocking filter applied in
+  // the tile decoding jobs.
+  int64_t reconstruction = 0;
+  // The post filters applied by the frame thread.
+  int64_t post_filter = 0;
+};
+
+// Splits the threads between frame threads and intra-frame threads in frame
+// parallel mode, based on the stage costs measured on the recently decoded
+// frames. The time to decode a frame with a given number of intra-frame
+// threads is predicted with a simple model of the frame parallel decoding
+// path:
+//   * The tiles are parsed in parallel, by the frame thread and its workers.
+//   * The tiles are reconstructed in parallel by the workers (or by the frame
+//     thread if there are none).
+//   * The post filters run on the frame thread, overlapped with the
+//     reconstruction when there are workers.
+// Each frame gets as many intra-frame threads as it keeps busy most of the
+// time, so that the frames that reference it can proceed as early as
+// possible. The remaining threads decode more frames in parallel. This lets the
+// split follow changes in the tile layout or in the use of the post filters.
+class AdaptiveThreadAllocator {
+ public:
+  AdaptiveThreadAllocator() = default;
+
+  // Not copyable or movable.
+  AdaptiveThreadAllocator(const AdaptiveThreadAllocator&) = delete;
+  AdaptiveThreadAllocator& operator=(const AdaptiveThreadAllocator&) = delete;
+
+  // Sets the total number of threads, the largest number of frames that may
+  // be decoded in parallel, and the initial split (|frame_threads| frame
+  // threads with |threads_per_frame| intra-frame threads each). The recorded
+  // costs are discarded.
+  void Init(int thread_count, int max_frame_threads, int frame_threads,
+            int threads_per_frame);
+
+  // The number of frames to be decoded in parallel.
+  int frame_threads() const {
+    return frame_threads_.load(std::memory_order_relaxed);
+  }
+  // The number of intra-frame worker threads for each frame.
+  int threads_per_frame() const {
+    return threads_per_frame_.load(std::memory_order_relaxed);
+  }
+
+  // Records the |costs| of a frame with |tile_count| tiles that was decoded
+  // with |threads_per_frame| intra-frame worker threads and updates the split.
+  // May be called concurrently from several frame threads.
+  void AddFrame(const FrameStageCosts& costs, int tile_count,
+                int threads_per_frame);
+
+ private:
+  // Returns the predicted time to decode one frame with |threads_per_frame|
+  // intra-frame worker threads. |mutex_| must be held.
+  double PredictFrameTime(int threads_per_frame) const;
+
+  std::mutex mutex_;
+  int thread_count_ LIBGAV1_GUARDED_BY(mutex_) = 0;
+  int max_frame_threads_ LIBGAV1_GUARDED_BY(mutex_) = 0;
+  // The tile count of the last decoded frame.
+  int tile_count_ LIBGAV1_GUARDED_BY(mutex_) = 1;
+  // Moving averages of the time each stage would take on a single thread.
+  bool has_costs_ LIBGAV1_GUARDED_BY(mutex_) = false;
+  double parse_cost_ LIBGAV1_GUARDED_BY(mutex_) = 0;
+  double reconstruction_cost_ LIBGAV1_GUARDED_BY(mutex_) = 0;
+  double post_filter_cost_ LIBGAV1_GUARDED_BY(mutex_) = 0;
+  std::atomic<int> frame_threads_{0};
+  std::atomic<int> threads_per_frame_{0};
+};
+
 // Initializes the |frame_thread_pool| and the necessary worker threadpools (the
 // threading_strategy objects in each of the frame scratch buffer in
 // |frame_scratch_buffer_pool|) as follows:
@@ -121,8 +231,26 @@ class ThreadingStrategy {
 //    * |frame_thread_pool| is nullptr. |frame_scratch_buffer_pool| is not
 //      modified. This means that frame threading will not be used and the
 //      decoder will continue to operate normally in non frame parallel mode.
+// If |adaptive_thread_allocator| is not nullptr, it is initialized with the
+// split described above and |frame_thread_pool| is created with enough
+// threads for any split it may choose later (|thread_count| threads). The
+// number of threads that are running jobs at any time is then still limited to
+// |thread_count| by the decoder, which starts a frame only when its frame
+// thread and intra-frame threads fit in |thread_count| along with those of the
+// frames being decoded.
+// If |shared_thread_pool| is not nullptr, the remaining threads are not divided
+// between the frame threads. Instead, they are all put in |shared_thread_pool|
+// and the threading_strategy of each frame scratch buffer gets a nested thread
+// pool on top of it, so that the threads which are not needed by one frame
+// help decoding the others. |shared_thread_pool| is nullptr on return if there
+// are no remaining threads. At most one of |adaptive_thread_allocator| and
+// |shared_thread_pool| may be non-null.
 LIBGAV1_MUST_USE_RESULT bool InitializeThreadPoolsForFrameParallel(
     int thread_count, int tile_count, int tile_columns,
+    const ExternalScheduler* external_scheduler,
+    const CpuAffinity* cpu_affinity,
+    AdaptiveThreadAllocator* adaptive_thread_allocator,
+    std::unique_ptr<ThreadPool>* shared_thread_pool,
     std::unique_ptr<ThreadPool>* frame_thread_pool,
     FrameScratchBufferPool* frame_scratch_buffer_pool);
 
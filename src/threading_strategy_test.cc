@@ -14,6 +14,7 @@
 
 #include "src/threading_strategy.h"
 
+#include <cstdint>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -178,7 +179,9 @@ void VerifyFrameParallel(int thread_count, int tile_count, int tile_columns,
   std::unique_ptr<ThreadPool> frame_thread_pool;
   FrameScratchBufferPool frame_scratch_buffer_pool;
   ASSERT_TRUE(InitializeThreadPoolsForFrameParallel(
-      thread_count, tile_count, tile_columns, &frame_thread_pool,
+      thread_count, tile_count, tile_columns, /*external_scheduler=*/nullptr,
+      /*cpu_affinity=*/nullptr, /*adaptive_thread_allocator=*/nullptr,
+      /*shared_thread_pool=*/nullptr, &frame_thread_pool,
       &frame_scratch_buffer_pool));
   if (expected_frame_threads == 0) {
     EXPECT_EQ(frame_thread_pool, nullptr);
@@ -255,6 +258,8 @@ TEST(FrameParallelStrategyTest, ThreadCountDoesNotExceedkMaxThreads) {
   FrameScratchBufferPool frame_scratch_buffer_pool;
   ASSERT_TRUE(InitializeThreadPoolsForFrameParallel(
       /*thread_count=*/kMaxThreads + 10, /*tile_count=*/2, /*tile_columns=*/2,
+      /*external_scheduler=*/nullptr, /*cpu_affinity=*/nullptr,
+      /*adaptive_thread_allocator=*/nullptr, /*shared_thread_pool=*/nullptr,
       &frame_thread_pool, &frame_scratch_buffer_pool));
   EXPECT_NE(frame_thread_pool.get(), nullptr);
   std::vector<std::unique_ptr<FrameScratchBuffer>> frame_scratch_buffers;
@@ -277,5 +282,137 @@ TEST(FrameParallelStrategyTest, ThreadCountDoesNotExceedkMaxThreads) {
   }
 }
 
+TEST(FrameParallelStrategyTest, AdaptiveThreadAllocatorInitialSplit) {
+  std::unique_ptr<ThreadPool> frame_thread_pool;
+  FrameScratchBufferPool frame_scratch_buffer_pool;
+  AdaptiveThreadAllocator allocator;
+  ASSERT_TRUE(InitializeThreadPoolsForFrameParallel(
+      /*thread_count=*/7, /*tile_count=*/1, /*tile_columns=*/1,
+      /*external_scheduler=*/nullptr, /*cpu_affinity=*/nullptr, &allocator,
+      /*shared_thread_pool=*/nullptr, &frame_thread_pool,
+      &frame_scratch_buffer_pool));
+  ASSERT_NE(frame_thread_pool.get(), nullptr);
+  // The frame thread pool is large enough for any split.
+  EXPECT_EQ(frame_thread_pool->num_threads(), 7);
+  EXPECT_EQ(allocator.frame_threads(), 3);
+  // The extra thread is not used since all the frames get the same number of
+  // threads.
+  EXPECT_EQ(allocator.threads_per_frame(), 1);
+  std::vector<std::unique_ptr<FrameScratchBuffer>> frame_scratch_buffers;
+  for (int i = 0; i < 3; ++i) {
+    SCOPED_TRACE(absl::StrCat("i: ", i));
+    frame_scratch_buffers.push_back(frame_scratch_buffer_pool.Get());
+    ThreadPool* const thread_pool =
+        frame_scratch_buffers.back()->threading_strategy.thread_pool();
+    ASSERT_NE(thread_pool, nullptr);
+    EXPECT_EQ(thread_pool->num_threads(), 1);
+  }
+  for (auto& frame_scratch_buffer : frame_scratch_buffers) {
+    frame_scratch_buffer_pool.Release(std::move(frame_scratch_buffer));
+  }
+}
+
+TEST(FrameParallelStrategyTest, SharedThreadPool) {
+  // Declared before |frame_scratch_buffer_pool| since the thread pools of the
+  // frame scratch buffers run their jobs on it.
+  std::unique_ptr<ThreadPool> shared_thread_pool;
+  std::unique_ptr<ThreadPool> frame_thread_pool;
+  FrameScratchBufferPool frame_scratch_buffer_pool;
+  ASSERT_TRUE(InitializeThreadPoolsForFrameParallel(
+      /*thread_count=*/14, /*tile_count=*/2, /*tile_columns=*/2,
+      /*external_scheduler=*/nullptr, /*cpu_affinity=*/nullptr,
+      /*adaptive_thread_allocator=*/nullptr, &shared_thread_pool,
+      &frame_thread_pool, &frame_scratch_buffer_pool));
+  ASSERT_NE(frame_thread_pool.get(), nullptr);
+  EXPECT_EQ(frame_thread_pool->num_threads(), 4);
+  // The threads that are not frame threads are all shared.
+  ASSERT_NE(shared_thread_pool.get(), nullptr);
+  EXPECT_EQ(shared_thread_pool->num_threads(), 10);
+  std::vector<std::unique_ptr<FrameScratchBuffer>> frame_scratch_buffers;
+  for (int i = 0; i < 4; ++i) {
+    SCOPED_TRACE(absl::StrCat("i: ", i));
+    frame_scratch_buffers.push_back(frame_scratch_buffer_pool.Get());
+    ThreadingStrategy& threading_strategy =
+        frame_scratch_buffers.back()->threading_strategy;
+    ThreadPool* const thread_pool = threading_strategy.thread_pool();
+    ASSERT_NE(thread_pool, nullptr);
+    EXPECT_EQ(thread_pool->type(), ThreadPool::kTypeNested);
+    EXPECT_EQ(thread_pool->parent(), shared_thread_pool.get());
+    EXPECT_EQ(thread_pool->num_threads(), 10);
+    // Reset() keeps the nested thread pool if the shared pool is unchanged.
+    ASSERT_TRUE(threading_strategy.Reset(shared_thread_pool.get()));
+    EXPECT_EQ(threading_strategy.thread_pool(), thread_pool);
+  }
+  for (auto& frame_scratch_buffer : frame_scratch_buffers) {
+    frame_scratch_buffer_pool.Release(std::move(frame_scratch_buffer));
+  }
+}
+
+FrameStageCosts MakeCosts(int64_t parse, int64_t reconstruction,
+                          int64_t post_filter) {
+  FrameStageCosts costs;
+  costs.parse = parse;
+  costs.reconstruction = reconstruction;
+  costs.post_filter = post_filter;
+  return costs;
+}
+
+TEST(AdaptiveThreadAllocatorTest, SingleTileWithoutPostFilters) {
+  AdaptiveThreadAllocator allocator;
+  allocator.Init(/*thread_count=*/8, /*max_frame_threads=*/8,
+                 /*frame_threads=*/4, /*threads_per_frame=*/1);
+  // With a single tile and no post filters, a worker thread only takes the
+  // reconstruction off the frame thread, which then idles. All the threads
+  // should be used as frame threads.
+  allocator.AddFrame(MakeCosts(1000, 3000, 0), /*tile_count=*/1,
+                     /*threads_per_frame=*/1);
+  EXPECT_EQ(allocator.frame_threads(), 8);
+  EXPECT_EQ(allocator.threads_per_frame(), 0);
+}
+
+TEST(AdaptiveThreadAllocatorTest, SingleTileWithPostFilters) {
+  AdaptiveThreadAllocator allocator;
+  allocator.Init(/*thread_count=*/8, /*max_frame_threads=*/8,
+                 /*frame_threads=*/8, /*threads_per_frame=*/0);
+  // One worker thread reconstructs the frame while the frame thread applies
+  // the post filters. More workers cannot help with a single tile.
+  allocator.AddFrame(MakeCosts(300, 1000, 1000), /*tile_count=*/1,
+                     /*threads_per_frame=*/0);
+  EXPECT_EQ(allocator.frame_threads(), 4);
+  EXPECT_EQ(allocator.threads_per_frame(), 1);
+}
+
+TEST(AdaptiveThreadAllocatorTest, TileLayoutChange) {
+  AdaptiveThreadAllocator allocator;
+  allocator.Init(/*thread_count=*/16, /*max_frame_threads=*/16,
+                 /*frame_threads=*/8, /*threads_per_frame=*/1);
+  // Reconstruction dominates and the frame has 8 tiles to work on in
+  // parallel.
+  allocator.AddFrame(MakeCosts(100, 8000, 100), /*tile_count=*/8,
+                     /*threads_per_frame=*/1);
+  EXPECT_EQ(allocator.frame_threads(), 2);
+  EXPECT_EQ(allocator.threads_per_frame(), 7);
+  // The stream switches to a single tile without post filters. The moving
+  // averages converge after a few frames.
+  for (int i = 0; i < 16; ++i) {
+    allocator.AddFrame(MakeCosts(1000, 8000, 0), /*tile_count=*/1,
+                       allocator.threads_per_frame());
+  }
+  EXPECT_EQ(allocator.frame_threads(), 16);
+  EXPECT_EQ(allocator.threads_per_frame(), 0);
+}
+
+TEST(AdaptiveThreadAllocatorTest, SmallChangesAreIgnored) {
+  AdaptiveThreadAllocator allocator;
+  allocator.Init(/*thread_count=*/16, /*max_frame_threads=*/16,
+                 /*frame_threads=*/2, /*threads_per_frame=*/6);
+  // 7 threads per frame would be slightly faster since there are 8 tiles, but
+  // the post filters limit the gain to less than 10%.
+  allocator.AddFrame(MakeCosts(0, 1167, 1100), /*tile_count=*/8,
+                     /*threads_per_frame=*/6);
+  EXPECT_EQ(allocator.frame_threads(), 2);
+  EXPECT_EQ(allocator.threads_per_frame(), 6);
+}
+
 }  // namespace
 }  // namespace libgav1
@@ -329,9 +329,10 @@ class Tile : public MaxAlignedAllocable {
                        int max_value, int value);
   void ReadQuantizerIndexDelta(const Block& block);  // 5.11.12.
   void ReadLoopFilterDelta(const Block& block);      // 5.11.13.
-  // Populates |BlockParameters::deblock_filter_level| for the given |block|
-  // using |deblock_filter_levels_|.
-  void PopulateDeblockFilterLevel(const Block& block);
+  // Populates the DeblockParameters of the 4x4 blocks covered by |block| in
+  // |block_parameters_holder_|, using |deblock_filter_levels_| for the filter
+  // levels.
+  void PopulateDeblockParameters(const Block& block);
   void PopulateCdefSkip(const Block& block);
   void ReadPredictionModeY(const Block& block, bool intra_y_mode);
   void ReadIntraAngleInfo(const Block& block,
@@ -2111,22 +2111,27 @@ bool Tile::ComputePrediction(const Block& block) {
 
 #undef CALL_BITDEPTH_FUNCTION
 
-void Tile::PopulateDeblockFilterLevel(const Block& block) {
+void Tile::PopulateDeblockParameters(const Block& block) {
   if (!post_filter_.DoDeblock()) return;
-  BlockParameters& bp = *block.bp;
+  const BlockParameters& bp = *block.bp;
+  DeblockParameters params;
   const int mode_id =
       static_cast<int>(kPredictionModeDeltasMask.Contains(bp.y_mode));
   for (int i = 0; i < kFrameLfCount; ++i) {
     if (delta_lf_all_zero_) {
-      bp.deblock_filter_level[i] = post_filter_.GetZeroDeltaDeblockFilterLevel(
+      params.filter_level[i] = post_filter_.GetZeroDeltaDeblockFilterLevel(
           bp.prediction_parameters->segment_id, i, bp.reference_frame[0],
           mode_id);
     } else {
-      bp.deblock_filter_level[i] =
+      params.filter_level[i] =
           deblock_filter_levels_[bp.prediction_parameters->segment_id][i]
                                 [bp.reference_frame[0]][mode_id];
     }
   }
+  params.uv_transform_size = bp.uv_transform_size;
+  params.skip = bp.skip && bp.is_inter;
+  block_parameters_holder_.FillDeblockParameters(block.row4x4, block.column4x4,
+                                                 block.size, params);
 }
 
 void Tile::PopulateCdefSkip(const Block& block) {
@@ -2203,7 +2208,6 @@ bool Tile::ProcessBlock(int row4x4, int column4x4, BlockSize block_size,
                               : std::move(prediction_parameters_);
   if (bp.prediction_parameters == nullptr) return false;
   if (!DecodeModeInfo(block)) return false;
-  PopulateDeblockFilterLevel(block);
   if (!ReadPaletteTokens(block)) return false;
   DecodeTransformSize(block);
   // Part of Section 5.11.37 in the spec (implemented as a simple lookup).
@@ -2211,6 +2215,7 @@ bool Tile::ProcessBlock(int row4x4, int column4x4, BlockSize block_size,
       frame_header_.segmentation.lossless[bp.prediction_parameters->segment_id]
           ? kTransformSize4x4
           : kUVTransformSize[block.residual_size[kPlaneU]];
+  PopulateDeblockParameters(block);
   if (bp.skip) ResetEntropyContext(block);
   PopulateCdefSkip(block);
   if (split_parse_and_decode_) {
@@ -17,6 +17,7 @@
 #ifndef LIBGAV1_SRC_TILE_SCRATCH_BUFFER_H_
 #define LIBGAV1_SRC_TILE_SCRATCH_BUFFER_H_
 
+#include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
@@ -159,6 +160,26 @@ class TileScratchBufferPool {
     buffers_.Push(std::move(scratch_buffer));
   }
 
+  // Makes sure that the pool holds at least |count| buffers and maps their
+  // pages. |count| must not be greater than kMaxThreads. Returns true on
+  // success.
+  LIBGAV1_MUST_USE_RESULT bool Preallocate(int count) {
+    assert(count <= kMaxThreads);
+    std::unique_ptr<TileScratchBuffer> scratch_buffers[kMaxThreads];
+    bool ok = true;
+    int i = 0;
+    for (; i < count; ++i) {
+      scratch_buffers[i] = Get();
+      if (scratch_buffers[i] == nullptr) {
+        ok = false;
+        break;
+      }
+      PrefaultPages(scratch_buffers[i].get(), sizeof(TileScratchBuffer));
+    }
+    while (--i >= 0) Release(std::move(scratch_buffers[i]));
+    return ok;
+  }
+
  private:
   std::mutex mutex_;
   // We will never need more than kMaxThreads scratch buffers since that is the
@@ -15,10 +15,12 @@
 #include "src/utils/block_parameters_holder.h"
 
 #include <algorithm>
+#include <new>
 
 #include "src/utils/common.h"
 #include "src/utils/constants.h"
 #include "src/utils/logging.h"
+#include "src/utils/memory.h"
 #include "src/utils/types.h"
 
 namespace libgav1 {
@@ -28,9 +30,27 @@ bool BlockParametersHolder::Reset(int rows4x4, int columns4x4) {
   columns4x4_ = columns4x4;
   index_ = 0;
   return block_parameters_cache_.Reset(rows4x4_, columns4x4_) &&
+         deblock_parameters_.Reset(rows4x4_, columns4x4_,
+                                   /*zero_initialize=*/false) &&
          block_parameters_.Resize(rows4x4_ * columns4x4_);
 }
 
+bool BlockParametersHolder::Preallocate() {
+  const int size = rows4x4_ * columns4x4_;
+  auto* const block_parameters = block_parameters_.get();
+  for (int i = 0; i < size; ++i) {
+    if (block_parameters[i] == nullptr) {
+      block_parameters[i].reset(new (std::nothrow) BlockParameters);
+      if (block_parameters[i] == nullptr) return false;
+    }
+  }
+  PrefaultPages(block_parameters_cache_.data(),
+                block_parameters_cache_.size() * sizeof(BlockParameters*));
+  PrefaultPages(deblock_parameters_.data(),
+                deblock_parameters_.size() * sizeof(DeblockParameters));
+  return true;
+}
+
 BlockParameters* BlockParametersHolder::Get(int row4x4, int column4x4,
                                             BlockSize block_size) {
   const size_t index = index_.fetch_add(1, std::memory_order_relaxed);
@@ -80,4 +100,24 @@ void BlockParametersHolder::FillCache(int row4x4, int column4x4,
   }
 }
 
+void BlockParametersHolder::FillDeblockParameters(int row4x4, int column4x4,
+                                                  BlockSize block_size,
+                                                  DeblockParameters params) {
+  const int rows = std::min(static_cast<int>(kNum4x4BlocksHigh[block_size]),
+                            rows4x4_ - row4x4);
+  const int columns = std::min(static_cast<int>(kNum4x4BlocksWide[block_size]),
+                               columns4x4_ - column4x4);
+  DeblockParameters* dst = &deblock_parameters_[row4x4][column4x4];
+  int y = 0;
+  do {
+    params.row_offset = y;
+    int x = 0;
+    do {
+      params.column_offset = x;
+      dst[x] = params;
+    } while (++x < columns);
+    dst += columns4x4_;
+  } while (++y < rows);
+}
+
 }  // namespace libgav1
@@ -28,7 +28,8 @@
 
 namespace libgav1 {
 
-// Holds the BlockParameters pointers to each 4x4 block in the frame.
+// Holds the BlockParameters pointers and the DeblockParameters of each 4x4
+// block in the frame.
 class BlockParametersHolder {
  public:
   BlockParametersHolder() = default;
@@ -39,6 +40,12 @@ class BlockParametersHolder {
 
   LIBGAV1_MUST_USE_RESULT bool Reset(int rows4x4, int columns4x4);
 
+  // Allocates all the BlockParameters objects that Get() can return until the
+  // next call to Reset(), which Get() otherwise allocates on demand, and maps
+  // the pages of the cache and deblocking parameter matrices. Returns false on
+  // memory allocation failure.
+  LIBGAV1_MUST_USE_RESULT bool Preallocate();
+
   // Returns a pointer to a BlockParameters object that can be used safely until
   // the next call to Reset(). Returns nullptr on memory allocation failure. It
   // also fills the cache matrix for the block starting at |row4x4|, |column4x4|
@@ -60,6 +67,22 @@ class BlockParametersHolder {
     return block_parameters_cache_.data() + row4x4 * columns4x4_ + column4x4;
   }
 
+  // Sets the DeblockParameters of every 4x4 block covered by the block
+  // starting at |row4x4|, |column4x4| of size |block_size| to |params|, with
+  // the offsets of each 4x4 block within the block filled in.
+  void FillDeblockParameters(int row4x4, int column4x4, BlockSize block_size,
+                             DeblockParameters params);
+
+  const DeblockParameters& FindDeblockParameters(int row4x4,
+                                                 int column4x4) const {
+    return deblock_parameters_[row4x4][column4x4];
+  }
+
+  const DeblockParameters* DeblockParametersAddress(int row4x4,
+                                                    int column4x4) const {
+    return deblock_parameters_.data() + row4x4 * columns4x4_ + column4x4;
+  }
+
   int columns4x4() const { return columns4x4_; }
 
  private:
@@ -85,6 +108,11 @@ class BlockParametersHolder {
   // FillCache() and used by Find() to perform look ups using exactly one look
   // up (instead of traversing the entire tree).
   Array2D<BlockParameters*> block_parameters_cache_;
+
+  // This is a 2d array of size |rows4x4_| * |columns4x4_| filled in by
+  // FillDeblockParameters(). It is only valid when the deblocking filter is
+  // enabled for the frame.
+  Array2D<DeblockParameters> deblock_parameters_;
 };
 
 }  // namespace libgav1
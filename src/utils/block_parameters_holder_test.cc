@@ -14,13 +14,103 @@
 
 #include "src/utils/block_parameters_holder.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "gtest/gtest.h"
 #include "src/utils/constants.h"
 #include "src/utils/types.h"
+#include "tests/third_party/libvpx/acm_random.h"
 
 namespace libgav1 {
 namespace {
 
+BlockSize GetBlockSize(int width4x4, int height4x4) {
+  for (int i = kBlock4x4; i < kMaxBlockSizes; ++i) {
+    if (kNum4x4BlocksWide[i] == width4x4 && kNum4x4BlocksHigh[i] == height4x4) {
+      return static_cast<BlockSize>(i);
+    }
+  }
+  return kBlockInvalid;
+}
+
+// Gets a BlockParameters object with random contents from |holder| for the
+// block at |row4x4|, |column4x4| of size |width4x4| x |height4x4| and fills
+// its DeblockParameters. Returns the number of blocks added (0 or 1).
+int AddBlock(BlockParametersHolder* holder, libvpx_test::ACMRandom* rnd,
+             int rows4x4, int columns4x4, int row4x4, int column4x4,
+             int width4x4, int height4x4) {
+  if (row4x4 >= rows4x4 || column4x4 >= columns4x4) return 0;
+  const BlockSize block_size = GetBlockSize(width4x4, height4x4);
+  BlockParameters* const bp = holder->Get(row4x4, column4x4, block_size);
+  EXPECT_NE(bp, nullptr);
+  if (bp == nullptr) return 0;
+  bp->size = block_size;
+  bp->skip = (rnd->Rand8() & 1) != 0;
+  bp->is_inter = (rnd->Rand8() & 1) != 0;
+  bp->uv_transform_size =
+      static_cast<TransformSize>(rnd->Rand8() % kNumTransformSizes);
+  DeblockParameters params;
+  for (auto& level : params.filter_level) level = rnd->Rand8() & 63;
+  params.uv_transform_size = bp->uv_transform_size;
+  params.skip = bp->skip && bp->is_inter;
+  holder->FillDeblockParameters(row4x4, column4x4, block_size, params);
+  return 1;
+}
+
+// Recursively partitions the square block of |size4x4| 4x4 blocks at
+// |row4x4|, |column4x4| with random square, horizontal and vertical
+// partitions, splitting it further 40% of the time. Returns the number of
+// blocks added.
+int Partition(BlockParametersHolder* holder, libvpx_test::ACMRandom* rnd,
+              int rows4x4, int columns4x4, int row4x4, int column4x4,
+              int size4x4) {
+  if (row4x4 >= rows4x4 || column4x4 >= columns4x4) return 0;
+  const int half4x4 = size4x4 >> 1;
+  switch (size4x4 == 1 ? 0 : rnd->Rand8() % 5) {
+    case 0:
+      return AddBlock(holder, rnd, rows4x4, columns4x4, row4x4, column4x4,
+                      size4x4, size4x4);
+    case 1:
+      return AddBlock(holder, rnd, rows4x4, columns4x4, row4x4, column4x4,
+                      size4x4, half4x4) +
+             AddBlock(holder, rnd, rows4x4, columns4x4, row4x4 + half4x4,
+                      column4x4, size4x4, half4x4);
+    case 2:
+      return AddBlock(holder, rnd, rows4x4, columns4x4, row4x4, column4x4,
+                      half4x4, size4x4) +
+             AddBlock(holder, rnd, rows4x4, columns4x4, row4x4,
+                      column4x4 + half4x4, half4x4, size4x4);
+    default:
+      return Partition(holder, rnd, rows4x4, columns4x4, row4x4, column4x4,
+                       half4x4) +
+             Partition(holder, rnd, rows4x4, columns4x4, row4x4,
+                       column4x4 + half4x4, half4x4) +
+             Partition(holder, rnd, rows4x4, columns4x4, row4x4 + half4x4,
+                       column4x4, half4x4) +
+             Partition(holder, rnd, rows4x4, columns4x4, row4x4 + half4x4,
+                       column4x4 + half4x4, half4x4);
+  }
+}
+
+// Partitions a frame of |rows4x4| x |columns4x4| 4x4 blocks into 64x64
+// superblocks and those randomly into smaller blocks. Returns the number of
+// blocks.
+int PartitionFrame(BlockParametersHolder* holder, libvpx_test::ACMRandom* rnd,
+                   int rows4x4, int columns4x4) {
+  int num_blocks = 0;
+  for (int row4x4 = 0; row4x4 < rows4x4; row4x4 += 16) {
+    for (int column4x4 = 0; column4x4 < columns4x4; column4x4 += 16) {
+      num_blocks += Partition(holder, rnd, rows4x4, columns4x4, row4x4,
+                              column4x4, 16);
+    }
+  }
+  return num_blocks;
+}
+
 TEST(BlockParametersHolder, TestBasic) {
   BlockParametersHolder holder;
   ASSERT_TRUE(holder.Reset(20, 20));
@@ -72,5 +162,99 @@ TEST(BlockParametersHolder, TestBasic) {
   EXPECT_NE(bp4, nullptr);
 }
 
+TEST(BlockParametersHolder, DeblockParameters) {
+  constexpr int kRows4x4 = 37;
+  constexpr int kColumns4x4 = 45;
+  libvpx_test::ACMRandom rnd(libvpx_test::ACMRandom::DeterministicSeed());
+  BlockParametersHolder holder;
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(holder.Reset(kRows4x4, kColumns4x4));
+    PartitionFrame(&holder, &rnd, kRows4x4, kColumns4x4);
+    for (int row4x4 = 0; row4x4 < kRows4x4; ++row4x4) {
+      for (int column4x4 = 0; column4x4 < kColumns4x4; ++column4x4) {
+        const BlockParameters* const bp = holder.Find(row4x4, column4x4);
+        const DeblockParameters& dp =
+            holder.FindDeblockParameters(row4x4, column4x4);
+        EXPECT_EQ(&dp, holder.DeblockParametersAddress(row4x4, column4x4));
+        EXPECT_EQ(dp.uv_transform_size, bp->uv_transform_size);
+        EXPECT_EQ(dp.skip, bp->skip && bp->is_inter);
+        // The offsets must identify the 4x4 blocks of the same block, which
+        // the deblocking filter uses in place of comparing the pointers.
+        for (int distance = 1; distance <= 2; ++distance) {
+          if (row4x4 >= distance) {
+            EXPECT_EQ(dp.row_offset >= distance,
+                      holder.Find(row4x4 - distance, column4x4) == bp)
+                << "(" << row4x4 << ", " << column4x4 << ")";
+          }
+          if (column4x4 >= distance) {
+            EXPECT_EQ(dp.column_offset >= distance,
+                      holder.Find(row4x4, column4x4 - distance) == bp)
+                << "(" << row4x4 << ", " << column4x4 << ")";
+          }
+        }
+      }
+    }
+  }
+}
+
+// Compares the time taken to scan the vertical block edges of a 4K frame the
+// way the deblocking filter does, once following the BlockParameters pointers
+// and once reading the dense DeblockParameters, along with the size of the
+// data each scan touches.
+TEST(BlockParametersHolder, DISABLED_DeblockScanSpeed) {
+  constexpr int kRows4x4 = 2160 / 4;
+  constexpr int kColumns4x4 = 3840 / 4;
+  constexpr int kNumRuns = 100;
+  libvpx_test::ACMRandom rnd(libvpx_test::ACMRandom::DeterministicSeed());
+  BlockParametersHolder holder;
+  ASSERT_TRUE(holder.Reset(kRows4x4, kColumns4x4));
+  const int num_blocks = PartitionFrame(&holder, &rnd, kRows4x4, kColumns4x4);
+
+  int64_t sum_pointers = 0;
+  absl::Time start = absl::Now();
+  for (int run = 0; run < kNumRuns; ++run) {
+    for (int row4x4 = 0; row4x4 < kRows4x4; ++row4x4) {
+      BlockParameters* const* bp = holder.Address(row4x4, 0);
+      for (int column4x4 = 1; column4x4 < kColumns4x4; ++column4x4) {
+        const BlockParameters* const bp_this = bp[column4x4];
+        if (bp_this != bp[column4x4 - 1]) {
+          sum_pointers += kTransformWidth[bp_this->uv_transform_size];
+        } else if (!(bp_this->skip && bp_this->is_inter)) {
+          ++sum_pointers;
+        }
+      }
+    }
+  }
+  const absl::Duration pointers_time = absl::Now() - start;
+
+  int64_t sum_dense = 0;
+  start = absl::Now();
+  for (int run = 0; run < kNumRuns; ++run) {
+    for (int row4x4 = 0; row4x4 < kRows4x4; ++row4x4) {
+      const DeblockParameters* dp = holder.DeblockParametersAddress(row4x4, 0);
+      for (int column4x4 = 1; column4x4 < kColumns4x4; ++column4x4) {
+        const DeblockParameters& dp_this = dp[column4x4];
+        if (dp_this.column_offset == 0) {
+          sum_dense += kTransformWidth[dp_this.uv_transform_size];
+        } else if (!dp_this.skip) {
+          ++sum_dense;
+        }
+      }
+    }
+  }
+  const absl::Duration dense_time = absl::Now() - start;
+  EXPECT_EQ(sum_pointers, sum_dense);
+
+  const size_t num_4x4_blocks = size_t{kRows4x4} * kColumns4x4;
+  printf("%d blocks, %zu 4x4 blocks\n", num_blocks, num_4x4_blocks);
+  printf("BlockParameters pointers: %7d us, %8zu bytes\n",
+         static_cast<int>(absl::ToInt64Microseconds(pointers_time)),
+         num_4x4_blocks * sizeof(BlockParameters*) +
+             num_blocks * sizeof(BlockParameters));
+  printf("DeblockParameters:        %7d us, %8zu bytes\n",
+         static_cast<int>(absl::ToInt64Microseconds(dense_time)),
+         num_4x4_blocks * sizeof(DeblockParameters));
+}
+
 }  // namespace
 }  // namespace libgav1
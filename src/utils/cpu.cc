@@ -71,6 +71,14 @@ uint32_t GetCpuInfo() {
       if (max_cpuid_value >= 7) {
         CpuId(7, info);
         if ((info[1] & (1 << 5)) != 0) features |= kAVX2;
+        // Bits 16 (AVX512F), 17 (AVX512DQ), 30 (AVX512BW) & 31 (AVX512VL).
+        const uint32_t avx512_mask = (1u << 16) | (1u << 17) | (1u << 30) |
+                                     (1u << 31);
+        // Opmask, ZMM_Hi256 and Hi16_ZMM state enabled by the OS.
+        if ((info[1] & avx512_mask) == avx512_mask &&
+            (Xgetbv() & 0xe6) == 0xe6) {
+          features |= kAVX512;
+        }
       }
     }
   }
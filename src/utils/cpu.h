@@ -44,8 +44,20 @@ namespace libgav1 {
 #define LIBGAV1_ENABLE_AVX2 0
 #endif  // LIBGAV1_ENABLE_SSE4_1
 
+#if LIBGAV1_ENABLE_AVX2
+#if !defined(LIBGAV1_ENABLE_AVX512)
+#define LIBGAV1_ENABLE_AVX512 1
+#endif  // !defined(LIBGAV1_ENABLE_AVX512)
+#else   // !LIBGAV1_ENABLE_AVX2
+// Disable AVX512 when AVX2 is disabled as it may rely on shared components.
+#undef LIBGAV1_ENABLE_AVX512
+#define LIBGAV1_ENABLE_AVX512 0
+#endif  // LIBGAV1_ENABLE_AVX2
+
 #else  // !LIBGAV1_X86
 
+#undef LIBGAV1_ENABLE_AVX512
+#define LIBGAV1_ENABLE_AVX512 0
 #undef LIBGAV1_ENABLE_AVX2
 #define LIBGAV1_ENABLE_AVX2 0
 #undef LIBGAV1_ENABLE_SSE4_1
@@ -57,6 +69,14 @@ namespace libgav1 {
 // (at least) that instruction set. This prevents disabling other instruction
 // sets if the current instruction set isn't a global target, e.g., building
 // *_avx2.cc w/-mavx2, but the remaining files without the flag.
+// The AVX512 tier requires the F, BW, DQ and VL subsets.
+#if LIBGAV1_ENABLE_AVX512 && defined(__AVX512F__) && defined(__AVX512BW__) && \
+    defined(__AVX512DQ__) && defined(__AVX512VL__)
+#define LIBGAV1_TARGETING_AVX512 1
+#else
+#define LIBGAV1_TARGETING_AVX512 0
+#endif
+
 #if LIBGAV1_ENABLE_AVX2 && defined(__AVX2__)
 #define LIBGAV1_TARGETING_AVX2 1
 #else
@@ -97,6 +117,9 @@ enum CpuFeatures : uint8_t {
 #define LIBGAV1_CPU_AVX2 (1 << 4)
   kNEON = 1 << 5,
 #define LIBGAV1_CPU_NEON (1 << 5)
+  // AVX-512 F, BW, DQ and VL.
+  kAVX512 = 1 << 6,
+#define LIBGAV1_CPU_AVX512 (1 << 6)
 };
 
 // Returns a bit-wise OR of CpuFeatures supported by this platform.
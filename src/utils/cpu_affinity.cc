@@ -0,0 +1,198 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/utils/cpu_affinity.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace libgav1 {
+namespace {
+
+#if defined(__linux__)
+
+constexpr size_t kPageSize = 4096;
+
+bool GetThreadAffinity(CpuSet* const cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  // A pid of 0 refers to the calling thread.
+  if (sched_getaffinity(0, sizeof(set), &set) != 0) return false;
+  cpus->Clear();
+  for (int cpu = 0; cpu < CPU_SETSIZE && cpu < CpuSet::kMaxCpus; ++cpu) {
+    if (CPU_ISSET(cpu, &set)) cpus->Add(cpu);
+  }
+  return true;
+}
+
+bool SetThreadAffinity(const CpuSet& cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu = 0; cpu < CPU_SETSIZE && cpu < CpuSet::kMaxCpus; ++cpu) {
+    if (cpus.Contains(cpu)) CPU_SET(cpu, &set);
+  }
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+// Returns the NUMA node of the CPU running the calling thread, or 0 if it
+// cannot be determined.
+int GetCurrentNumaNode() {
+#if defined(SYS_getcpu)
+  unsigned int cpu;
+  unsigned int node;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+    return static_cast<int>(node);
+  }
+#endif
+  return 0;
+}
+
+bool GetNumaNodeCpus(int node, CpuSet* const cpus) {
+  char path[64];
+  snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist",
+           node);
+  FILE* const file = fopen(path, "r");
+  if (file == nullptr) return false;
+  char list[1024];
+  const bool ok = fgets(list, sizeof(list), file) != nullptr;
+  fclose(file);
+  return ok && cpus->ParseList(list);
+}
+
+#endif  // defined(__linux__)
+
+}  // namespace
+
+#if !LIBGAV1_CXX17
+constexpr int CpuSet::kMaxCpus;
+constexpr int CpuSet::kNumWords;
+#endif
+
+int CpuSet::Count() const {
+  int count = 0;
+  for (const auto word : words_) {
+    for (uint64_t w = word; w != 0; w &= w - 1) ++count;
+  }
+  return count;
+}
+
+int CpuSet::Nth(int n) const {
+  for (int cpu = 0; cpu < kMaxCpus; ++cpu) {
+    if (Contains(cpu) && n-- == 0) return cpu;
+  }
+  return -1;
+}
+
+bool CpuSet::ParseList(const char* list) {
+  Clear();
+  const char* p = list;
+  while (*p != '\0' && *p != '\n') {
+    char* end;
+    const long first = strtol(p, &end, 10);  // NOLINT(runtime/int)
+    if (end == p || first < 0 || first >= kMaxCpus) return false;
+    long last = first;  // NOLINT(runtime/int)
+    p = end;
+    if (*p == '-') {
+      ++p;
+      last = strtol(p, &end, 10);
+      if (end == p || last < first || last >= kMaxCpus) return false;
+      p = end;
+    }
+    for (long cpu = first; cpu <= last; ++cpu) {  // NOLINT(runtime/int)
+      Add(static_cast<int>(cpu));
+    }
+    if (*p == ',') {
+      ++p;
+    } else if (*p != '\0' && *p != '\n') {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CpuAffinity::Init(Policy policy, const int* cpus, int num_cpus,
+                       int numa_node) {
+  policy_ = kPolicyNone;
+  cpus_.Clear();
+  num_compact_workers_ = 0;
+  if (policy == kPolicyNone) return true;
+  if (policy == kPolicyCpuSet) {
+    if (cpus == nullptr || num_cpus <= 0) return false;
+    for (int i = 0; i < num_cpus; ++i) {
+      if (cpus[i] < 0 || cpus[i] >= CpuSet::kMaxCpus) return false;
+      cpus_.Add(cpus[i]);
+    }
+  } else if (policy != kPolicyCompact && policy != kPolicyNumaNode) {
+    return false;
+  }
+#if defined(__linux__)
+  CpuSet available;
+  if (!GetThreadAffinity(&available)) return true;
+  if (policy == kPolicyCompact) {
+    cpus_ = available;
+  } else if (policy == kPolicyNumaNode) {
+    if (numa_node < 0) numa_node = GetCurrentNumaNode();
+    if (!GetNumaNodeCpus(numa_node, &cpus_)) {
+      cpus_.Clear();
+      return true;
+    }
+  }
+  // Drop the CPUs that the calling thread is not allowed to run on. Pinning a
+  // thread to any of them would fail.
+  cpus_.Intersect(available);
+  if (!cpus_.Empty()) policy_ = policy;
+#else
+  static_cast<void>(numa_node);
+  cpus_.Clear();
+#endif  // defined(__linux__)
+  return true;
+}
+
+bool CpuAffinity::PinWorker() const {
+  if (policy_ == kPolicyNone) return true;
+#if defined(__linux__)
+  if (policy_ != kPolicyCompact) return SetThreadAffinity(cpus_);
+  const int index =
+      num_compact_workers_.fetch_add(1, std::memory_order_relaxed);
+  CpuSet cpu;
+  cpu.Add(cpus_.Nth(index % cpus_.Count()));
+  return SetThreadAffinity(cpu);
+#else
+  return false;
+#endif
+}
+
+void CpuAffinity::FirstTouch(void* data, size_t size) const {
+  if (policy_ == kPolicyNone) return;
+#if defined(__linux__)
+  CpuSet saved;
+  if (!GetThreadAffinity(&saved) || !SetThreadAffinity(cpus_)) return;
+  auto* const bytes = static_cast<volatile uint8_t*>(data);
+  for (size_t offset = 0; offset < size; offset += kPageSize) {
+    bytes[offset] = 0;
+  }
+  SetThreadAffinity(saved);
+#else
+  static_cast<void>(data);
+  static_cast<void>(size);
+#endif
+}
+
+}  // namespace libgav1
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2021 The libgav1 Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIBGAV1_SRC_UTILS_CPU_AFFINITY_H_
+#define LIBGAV1_SRC_UTILS_CPU_AFFINITY_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "src/utils/compiler_attributes.h"
+
+namespace libgav1 {
+
+// A set of logical CPUs, indexed from 0.
+class CpuSet {
+ public:
+  static constexpr int kMaxCpus = 1024;
+
+  void Clear() {
+    for (auto& word : words_) word = 0;
+  }
+  // |cpu| must be in the range [0, kMaxCpus).
+  void Add(int cpu) { words_[cpu >> 6] |= uint64_t{1} << (cpu & 63); }
+  bool Contains(int cpu) const {
+    return cpu >= 0 && cpu < kMaxCpus &&
+           ((words_[cpu >> 6] >> (cpu & 63)) & 1) != 0;
+  }
+  // Removes the CPUs which are not in |other|.
+  void Intersect(const CpuSet& other) {
+    for (int i = 0; i < kNumWords; ++i) words_[i] &= other.words_[i];
+  }
+  int Count() const;
+  bool Empty() const { return Count() == 0; }
+  // Returns the |n|th CPU of the set (counting from 0), or -1 if the set has
+  // |n| or fewer CPUs.
+  int Nth(int n) const;
+
+  // Parses a list in the format of the Linux sysfs cpulist files, for example
+  // "0-3,8,10-11". Returns false if |list| is malformed.
+  LIBGAV1_MUST_USE_RESULT bool ParseList(const char* list);
+
+ private:
+  static constexpr int kNumWords = kMaxCpus / 64;
+
+  uint64_t words_[kNumWords] = {};
+};
+
+// The placement of the worker threads of a thread pool, and of the memory
+// they process.
+class CpuAffinity {
+ public:
+  enum Policy : uint8_t {
+    // The threads are not pinned.
+    kPolicyNone,
+    // All the threads may run on any CPU of an explicit set.
+    kPolicyCpuSet,
+    // Each thread is pinned to one CPU, using the CPUs available to the
+    // process in order.
+    kPolicyCompact,
+    // All the threads may run on any CPU of one NUMA node.
+    kPolicyNumaNode
+  };
+
+  CpuAffinity() = default;
+
+  // Not copyable or movable.
+  CpuAffinity(const CpuAffinity&) = delete;
+  CpuAffinity& operator=(const CpuAffinity&) = delete;
+
+  // Resolves |policy| to a set of CPUs. |cpus| and |num_cpus| are only used by
+  // kPolicyCpuSet. |numa_node| is only used by kPolicyNumaNode; if it is
+  // negative, the node of the CPU running the calling thread is used. Returns
+  // false if the arguments are invalid. The set is limited to the CPUs that
+  // the calling thread is allowed to run on. If affinity is not supported on
+  // the platform or the resulting set is empty, the policy is reset to
+  // kPolicyNone and true is returned.
+  LIBGAV1_MUST_USE_RESULT bool Init(Policy policy, const int* cpus,
+                                    int num_cpus, int numa_node);
+
+  Policy policy() const { return policy_; }
+  const CpuSet& cpus() const { return cpus_; }
+
+  // Pins the calling thread, which is a worker thread of a thread pool,
+  // according to the policy. With kPolicyCompact, the workers of all the
+  // thread pools sharing this object are assigned consecutive CPUs of the set.
+  // Returns false on failure.
+  bool PinWorker() const;
+
+  // Writes to every page of |data| from a CPU of the set, so that with the
+  // first-touch NUMA allocation policy of the OS the pages are placed on the
+  // memory node of the threads that will process them. The affinity of the
+  // calling thread is restored afterwards. Does nothing if the policy is
+  // kPolicyNone.
+  void FirstTouch(void* data, size_t size) const;
+
+ private:
+  Policy policy_ = kPolicyNone;
+  CpuSet cpus_;
+  // The number of workers pinned with kPolicyCompact.
+  mutable std::atomic<int> num_compact_workers_{0};
+};
+
+}  // namespace libgav1
+
+#endif  // LIBGAV1_SRC_UTILS_CPU_AFFINITY_H_
@@ -0,0 +1,167 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/utils/cpu_affinity.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "src/utils/threadpool.h"
+
+namespace libgav1 {
+namespace {
+
+TEST(CpuSetTest, ParseList) {
+  CpuSet cpus;
+  ASSERT_TRUE(cpus.ParseList("0-3,8,10-11\n"));
+  EXPECT_EQ(cpus.Count(), 7);
+  EXPECT_TRUE(cpus.Contains(0));
+  EXPECT_TRUE(cpus.Contains(3));
+  EXPECT_FALSE(cpus.Contains(4));
+  EXPECT_TRUE(cpus.Contains(8));
+  EXPECT_FALSE(cpus.Contains(9));
+  EXPECT_TRUE(cpus.Contains(11));
+  EXPECT_EQ(cpus.Nth(0), 0);
+  EXPECT_EQ(cpus.Nth(4), 8);
+  EXPECT_EQ(cpus.Nth(6), 11);
+  EXPECT_EQ(cpus.Nth(7), -1);
+
+  ASSERT_TRUE(cpus.ParseList(""));
+  EXPECT_TRUE(cpus.Empty());
+
+  EXPECT_FALSE(cpus.ParseList("3-1"));
+  EXPECT_FALSE(cpus.ParseList("1,,2"));
+  EXPECT_FALSE(cpus.ParseList("a"));
+  EXPECT_FALSE(cpus.ParseList("4096"));
+}
+
+TEST(CpuSetTest, Intersect) {
+  CpuSet a;
+  CpuSet b;
+  ASSERT_TRUE(a.ParseList("0-7"));
+  ASSERT_TRUE(b.ParseList("4-100"));
+  a.Intersect(b);
+  EXPECT_EQ(a.Count(), 4);
+  EXPECT_EQ(a.Nth(0), 4);
+}
+
+TEST(CpuAffinityTest, InvalidArguments) {
+  CpuAffinity affinity;
+  EXPECT_FALSE(affinity.Init(CpuAffinity::kPolicyCpuSet, nullptr, 0, -1));
+  const int bad_cpus[] = {0, -1};
+  EXPECT_FALSE(affinity.Init(CpuAffinity::kPolicyCpuSet, bad_cpus, 2, -1));
+  EXPECT_FALSE(
+      affinity.Init(static_cast<CpuAffinity::Policy>(100), nullptr, 0, -1));
+  ASSERT_TRUE(affinity.Init(CpuAffinity::kPolicyNone, nullptr, 0, -1));
+  EXPECT_EQ(affinity.policy(), CpuAffinity::kPolicyNone);
+  EXPECT_TRUE(affinity.PinWorker());
+}
+
+#if defined(__linux__)
+
+// Returns the CPUs the calling thread may run on.
+CpuSet GetAllowedCpus() {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CpuSet cpus;
+  if (sched_getaffinity(0, sizeof(set), &set) != 0) return cpus;
+  for (int cpu = 0; cpu < CPU_SETSIZE && cpu < CpuSet::kMaxCpus; ++cpu) {
+    if (CPU_ISSET(cpu, &set)) cpus.Add(cpu);
+  }
+  return cpus;
+}
+
+TEST(CpuAffinityTest, CompactPinsWorkers) {
+  const CpuSet allowed = GetAllowedCpus();
+  ASSERT_FALSE(allowed.Empty());
+  CpuAffinity affinity;
+  ASSERT_TRUE(affinity.Init(CpuAffinity::kPolicyCompact, nullptr, 0, -1));
+  ASSERT_EQ(affinity.policy(), CpuAffinity::kPolicyCompact);
+  EXPECT_EQ(affinity.cpus().Count(), allowed.Count());
+
+  constexpr int kNumThreads = 4;
+  std::unique_ptr<ThreadPool> pool = ThreadPool::Create(
+      "affinity", kNumThreads, ThreadPool::kTypeSharedQueue, &affinity);
+  ASSERT_NE(pool, nullptr);
+  std::atomic<int> num_pinned(0);
+  for (int i = 0; i < 64; ++i) {
+    pool->Schedule([&num_pinned]() {
+      if (GetAllowedCpus().Count() == 1) ++num_pinned;
+    });
+  }
+  pool.reset();
+  EXPECT_EQ(num_pinned, 64);
+}
+
+TEST(CpuAffinityTest, CpuSetRestrictsWorkers) {
+  const CpuSet allowed = GetAllowedCpus();
+  const int cpu = allowed.Nth(0);
+  ASSERT_GE(cpu, 0);
+  CpuAffinity affinity;
+  ASSERT_TRUE(affinity.Init(CpuAffinity::kPolicyCpuSet, &cpu, 1, -1));
+  ASSERT_EQ(affinity.policy(), CpuAffinity::kPolicyCpuSet);
+
+  std::unique_ptr<ThreadPool> pool = ThreadPool::Create(
+      "affinity", 2, ThreadPool::kTypeWorkStealing, &affinity);
+  ASSERT_NE(pool, nullptr);
+  std::atomic<int> num_on_cpu(0);
+  for (int i = 0; i < 16; ++i) {
+    pool->Schedule([&num_on_cpu, cpu]() {
+      const CpuSet cpus = GetAllowedCpus();
+      if (cpus.Count() == 1 && cpus.Contains(cpu)) ++num_on_cpu;
+    });
+  }
+  pool.reset();
+  EXPECT_EQ(num_on_cpu, 16);
+}
+
+TEST(CpuAffinityTest, CpuSetDropsUnavailableCpus) {
+  const CpuSet allowed = GetAllowedCpus();
+  int unavailable = CpuSet::kMaxCpus - 1;
+  while (unavailable >= 0 && allowed.Contains(unavailable)) --unavailable;
+  ASSERT_GE(unavailable, 0);
+  CpuAffinity affinity;
+  ASSERT_TRUE(affinity.Init(CpuAffinity::kPolicyCpuSet, &unavailable, 1, -1));
+  EXPECT_EQ(affinity.policy(), CpuAffinity::kPolicyNone);
+  EXPECT_TRUE(affinity.cpus().Empty());
+  EXPECT_TRUE(affinity.PinWorker());
+
+  const int cpus[] = {allowed.Nth(0), unavailable};
+  ASSERT_TRUE(affinity.Init(CpuAffinity::kPolicyCpuSet, cpus, 2, -1));
+  EXPECT_EQ(affinity.policy(), CpuAffinity::kPolicyCpuSet);
+  EXPECT_EQ(affinity.cpus().Count(), 1);
+  EXPECT_TRUE(affinity.cpus().Contains(cpus[0]));
+}
+
+TEST(CpuAffinityTest, FirstTouchRestoresAffinity) {
+  const CpuSet allowed = GetAllowedCpus();
+  const int cpu = allowed.Nth(0);
+  ASSERT_GE(cpu, 0);
+  CpuAffinity affinity;
+  ASSERT_TRUE(affinity.Init(CpuAffinity::kPolicyCpuSet, &cpu, 1, -1));
+  std::unique_ptr<uint8_t[]> data(new uint8_t[3 * 4096 + 17]);
+  affinity.FirstTouch(data.get(), 3 * 4096 + 17);
+  EXPECT_EQ(GetAllowedCpus().Count(), allowed.Count());
+}
+
+#endif  // defined(__linux__)
+
+}  // namespace
+}  // namespace libgav1
@@ -244,5 +244,17 @@ TEST(CpuTest, GetNumberOfPerformanceCoresOnline) {
 #endif  // defined(__linux__)
 }
 
+TEST(CpuTest, FeatureHierarchy) {
+  const uint32_t cpu_features = GetCpuInfo();
+  // The wider x86 tiers are only reported with the tiers they build on, the
+  // dsp Init functions rely on this ordering.
+  if ((cpu_features & kAVX512) != 0) {
+    EXPECT_NE(cpu_features & kAVX2, 0u);
+  }
+  if ((cpu_features & kAVX2) != 0) {
+    EXPECT_NE(cpu_features & kAVX, 0u);
+  }
+}
+
 }  // namespace
 }  // namespace libgav1
@@ -17,18 +17,118 @@
 #ifndef LIBGAV1_SRC_UTILS_EXECUTOR_H_
 #define LIBGAV1_SRC_UTILS_EXECUTOR_H_
 
-#include <functional>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "src/utils/compiler_attributes.h"
 
 namespace libgav1 {
 
+// A move-only callable with inline storage, used for the jobs scheduled on an
+// Executor. Unlike std::function<void()>, constructing, moving or running a
+// Task never touches the heap. Callables larger than kStorageSize do not
+// compile; such callables should capture a pointer to their state instead.
+// A std::function<void()> fits and may be used for such cases as well, at the
+// cost of its own allocation.
+class Task {
+ public:
+  // Large enough for the closures scheduled by the decoder. The largest one is
+  // the super-res job, which captures the source and destination pointers and
+  // row counts of every plane.
+  static constexpr size_t kStorageSize = 80;
+
+  Task() = default;
+  Task(std::nullptr_t) {}  // NOLINT(runtime/explicit)
+
+  template <typename Callable,
+            typename = typename std::enable_if<!std::is_same<
+                typename std::decay<Callable>::type, Task>::value>::type>
+  Task(Callable&& callable) {  // NOLINT(runtime/explicit)
+    using Type = typename std::decay<Callable>::type;
+    static_assert(sizeof(Type) <= kStorageSize,
+                  "The callable is too large for Task.");
+    static_assert(alignof(Type) <= alignof(std::max_align_t),
+                  "The callable is over-aligned for Task.");
+    new (storage_) Type(std::forward<Callable>(callable));
+    ops_ = &TaskOps<Type>::kOps;
+  }
+
+  Task(Task&& other) noexcept { MoveFrom(&other); }
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      Destroy();
+      MoveFrom(&other);
+    }
+    return *this;
+  }
+  Task& operator=(std::nullptr_t) {
+    Destroy();
+    return *this;
+  }
+
+  // Not copyable.
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+
+  ~Task() { Destroy(); }
+
+  explicit operator bool() const { return ops_ != nullptr; }
+
+  // It is an error to call a Task that holds no callable.
+  void operator()() { ops_->invoke(storage_); }
+
+ private:
+  struct Ops {
+    void (*invoke)(void* storage);
+    // Move-constructs the callable in |to| and destroys the one in |from|.
+    void (*relocate)(void* from, void* to);
+    void (*destroy)(void* storage);
+  };
+
+  template <typename Type>
+  struct TaskOps {
+    static void Invoke(void* storage) { (*static_cast<Type*>(storage))(); }
+    static void Relocate(void* from, void* to) {
+      Type* const callable = static_cast<Type*>(from);
+      new (to) Type(std::move(*callable));
+      callable->~Type();
+    }
+    static void Destroy(void* storage) { static_cast<Type*>(storage)->~Type(); }
+
+    static constexpr Ops kOps = {Invoke, Relocate, Destroy};
+  };
+
+  void MoveFrom(Task* other) {
+    if (other->ops_ == nullptr) return;
+    other->ops_->relocate(other->storage_, storage_);
+    ops_ = other->ops_;
+    other->ops_ = nullptr;
+  }
+
+  void Destroy() {
+    if (ops_ == nullptr) return;
+    ops_->destroy(storage_);
+    ops_ = nullptr;
+  }
+
+  alignas(std::max_align_t) unsigned char storage_[kStorageSize];
+  const Ops* ops_ = nullptr;
+};
+
+#if !LIBGAV1_CXX17
+template <typename Type>
+constexpr Task::Ops Task::TaskOps<Type>::kOps;
+#endif
+
 class Executor {
  public:
   virtual ~Executor();
 
-  // Schedules the specified "callback" for execution in this executor.
-  // Depending on the subclass implementation, this may block in some
-  // situations.
-  virtual void Schedule(std::function<void()> callback) = 0;
+  // Schedules the specified "task" for execution in this executor. Depending
+  // on the subclass implementation, this may block in some situations.
+  virtual void Schedule(Task task) = 0;
 };
 
 }  // namespace libgav1
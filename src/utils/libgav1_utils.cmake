@@ -31,6 +31,8 @@ list(APPEND libgav1_utils_sources
             "${libgav1_source}/utils/constants.h"
             "${libgav1_source}/utils/cpu.cc"
             "${libgav1_source}/utils/cpu.h"
+            "${libgav1_source}/utils/cpu_affinity.cc"
+            "${libgav1_source}/utils/cpu_affinity.h"
             "${libgav1_source}/utils/dynamic_buffer.h"
             "${libgav1_source}/utils/entropy_decoder.cc"
             "${libgav1_source}/utils/entropy_decoder.h"
@@ -39,6 +41,7 @@ list(APPEND libgav1_utils_sources
             "${libgav1_source}/utils/logging.cc"
             "${libgav1_source}/utils/logging.h"
             "${libgav1_source}/utils/memory.h"
+            "${libgav1_source}/utils/memory_usage.h"
             "${libgav1_source}/utils/queue.h"
             "${libgav1_source}/utils/raw_bit_reader.cc"
             "${libgav1_source}/utils/raw_bit_reader.h"
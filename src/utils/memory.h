@@ -107,6 +107,19 @@ inline void Memset(int16_t* const dst, int value, size_t count) {
   }
 }
 
+// Reads and writes back one byte of every 4096-byte page of |data| so that
+// the pages are mapped before the buffer is first used. The contents of the
+// buffer are preserved.
+inline void PrefaultPages(void* const data, size_t size) {
+  constexpr size_t kPageSize = 4096;
+  if (size == 0) return;
+  auto* const bytes = static_cast<volatile uint8_t*>(data);
+  for (size_t offset = 0; offset < size; offset += kPageSize) {
+    bytes[offset] = bytes[offset];
+  }
+  bytes[size - 1] = bytes[size - 1];
+}
+
 struct MallocDeleter {
   void operator()(void* ptr) const { free(ptr); }
 };
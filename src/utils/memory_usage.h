@@ -0,0 +1,61 @@
+/*
+ * Copyright 2021 The libgav1 Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIBGAV1_SRC_UTILS_MEMORY_USAGE_H_
+#define LIBGAV1_SRC_UTILS_MEMORY_USAGE_H_
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+
+namespace libgav1 {
+
+// Tracks the number of bytes held by the large buffers of a decoder and the
+// largest value that number has reached. Add() and Subtract() may be called
+// concurrently from any thread.
+class MemoryUsage {
+ public:
+  MemoryUsage() = default;
+
+  // Not copyable or movable.
+  MemoryUsage(const MemoryUsage&) = delete;
+  MemoryUsage& operator=(const MemoryUsage&) = delete;
+
+  void Add(size_t size) {
+    const size_t current =
+        current_.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t peak = peak_.load(std::memory_order_relaxed);
+    while (peak < current && !peak_.compare_exchange_weak(
+                                 peak, current, std::memory_order_relaxed)) {
+    }
+  }
+
+  void Subtract(size_t size) {
+    assert(current_.load(std::memory_order_relaxed) >= size);
+    current_.fetch_sub(size, std::memory_order_relaxed);
+  }
+
+  size_t current() const { return current_.load(std::memory_order_relaxed); }
+  size_t peak() const { return peak_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<size_t> current_{0};
+  std::atomic<size_t> peak_{0};
+};
+
+}  // namespace libgav1
+
+#endif  // LIBGAV1_SRC_UTILS_MEMORY_USAGE_H_
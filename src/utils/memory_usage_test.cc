@@ -0,0 +1,70 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/utils/memory_usage.h"
+
+#include <cstddef>
+#include <thread>  // NOLINT (unapproved c++11 header)
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace libgav1 {
+namespace {
+
+TEST(MemoryUsageTest, CurrentAndPeak) {
+  MemoryUsage usage;
+  EXPECT_EQ(usage.current(), 0);
+  EXPECT_EQ(usage.peak(), 0);
+
+  usage.Add(100);
+  usage.Add(50);
+  EXPECT_EQ(usage.current(), 150);
+  EXPECT_EQ(usage.peak(), 150);
+
+  usage.Subtract(120);
+  EXPECT_EQ(usage.current(), 30);
+  EXPECT_EQ(usage.peak(), 150);
+
+  usage.Add(100);
+  EXPECT_EQ(usage.current(), 130);
+  EXPECT_EQ(usage.peak(), 150);
+
+  usage.Add(40);
+  EXPECT_EQ(usage.current(), 170);
+  EXPECT_EQ(usage.peak(), 170);
+}
+
+TEST(MemoryUsageTest, ConcurrentUpdates) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumIterations = 10000;
+  MemoryUsage usage;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&usage]() {
+      for (int j = 0; j < kNumIterations; ++j) {
+        usage.Add(16);
+        usage.Subtract(16);
+      }
+      usage.Add(1);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(usage.current(), static_cast<size_t>(kNumThreads));
+  EXPECT_GE(usage.peak(), static_cast<size_t>(kNumThreads));
+  EXPECT_LE(usage.peak(), static_cast<size_t>(kNumThreads * 17));
+}
+
+}  // namespace
+}  // namespace libgav1
@@ -17,6 +17,7 @@
 #ifndef LIBGAV1_SRC_UTILS_SEGMENTATION_MAP_H_
 #define LIBGAV1_SRC_UTILS_SEGMENTATION_MAP_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 
@@ -36,8 +37,9 @@ class SegmentationMap {
   SegmentationMap& operator=(const SegmentationMap&) = delete;
 
   // Allocates an internal buffer of the given dimensions to hold the
-  // segmentation map. The memory in the buffer is not initialized. Returns
-  // true on success, false on failure (for example, out of memory).
+  // segmentation map. The memory in the buffer is not initialized. The buffer
+  // is only reallocated if it is too small. Returns true on success, false on
+  // failure (for example, out of memory).
   LIBGAV1_MUST_USE_RESULT bool Allocate(int32_t rows4x4, int32_t columns4x4);
 
   int8_t segment_id(int row4x4, int column4x4) const {
@@ -59,6 +61,8 @@ class SegmentationMap {
  private:
   int32_t rows4x4_ = 0;
   int32_t columns4x4_ = 0;
+  // Number of elements allocated in segment_id_buffer_.
+  size_t allocated_size_ = 0;
 
   // segment_id_ is a rows4x4_ by columns4x4_ 2D array. The underlying data
   // buffer is dynamically allocated and owned by segment_id_buffer_.
@@ -35,6 +35,23 @@ TEST(SegmentationMapTest, Clear) {
   }
 }
 
+TEST(SegmentationMapTest, AllocateSmaller) {
+  SegmentationMap segmentation_map;
+  ASSERT_TRUE(segmentation_map.Allocate(60, 80));
+  // The smaller map reuses the buffer but must use its own row stride.
+  constexpr int32_t kRows4x4 = 30;
+  constexpr int32_t kColumns4x4 = 50;
+  ASSERT_TRUE(segmentation_map.Allocate(kRows4x4, kColumns4x4));
+  for (int row4x4 = 0; row4x4 < kRows4x4; ++row4x4) {
+    segmentation_map.FillBlock(row4x4, 0, kColumns4x4, 1, row4x4);
+  }
+  for (int row4x4 = 0; row4x4 < kRows4x4; ++row4x4) {
+    for (int column4x4 = 0; column4x4 < kColumns4x4; ++column4x4) {
+      EXPECT_EQ(segmentation_map.segment_id(row4x4, column4x4), row4x4);
+    }
+  }
+}
+
 TEST(SegmentationMapTest, FillBlock) {
   constexpr int32_t kRows4x4 = 60;
   constexpr int32_t kColumns4x4 = 80;
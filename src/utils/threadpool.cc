@@ -30,7 +30,9 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <mutex>  // NOLINT (unapproved c++11 header)
 #include <new>
+#include <thread>  // NOLINT (unapproved c++11 header)
 #include <utility>
 
 #if defined(__ANDROID__)
@@ -66,6 +68,40 @@ constexpr Duration kBusyWaitDuration =
 }  // namespace
 #endif  // defined(__ANDROID__)
 
+namespace {
+
+// The number of times an idle work-stealing worker rescans the queues before
+// it parks on the condition variable.
+constexpr int kWorkStealingSpinCount = 64;
+
+// The pool and the worker index of the current thread, if it is a worker of a
+// work-stealing pool. Used to push jobs scheduled by a worker to its own queue.
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local int current_worker_index = -1;
+
+// xorshift32.
+inline uint32_t NextRandom(uint32_t* state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+}  // namespace
+
+struct ThreadPool::WorkerQueue : public Allocable {
+  std::mutex mutex;
+  UnboundedQueue<Task> jobs;
+};
+
+struct ThreadPool::ExternalJob : public Allocable {
+  ThreadPool* pool;
+  Task task;
+  ExternalJob* next;
+};
+
 // static
 std::unique_ptr<ThreadPool> ThreadPool::Create(int num_threads) {
   return Create(/*name_prefix=*/"", num_threads);
@@ -74,22 +110,71 @@ std::unique_ptr<ThreadPool> ThreadPool::Create(int num_threads) {
 // static
 std::unique_ptr<ThreadPool> ThreadPool::Create(const char name_prefix[],
                                                int num_threads) {
-  if (name_prefix == nullptr || num_threads <= 0) return nullptr;
+  return Create(name_prefix, num_threads, kTypeSharedQueue);
+}
+
+// static
+std::unique_ptr<ThreadPool> ThreadPool::Create(const char name_prefix[],
+                                               int num_threads, Type type) {
+  return Create(name_prefix, num_threads, type, /*affinity=*/nullptr);
+}
+
+// static
+std::unique_ptr<ThreadPool> ThreadPool::Create(const char name_prefix[],
+                                               int num_threads, Type type,
+                                               const CpuAffinity* affinity) {
+  if (name_prefix == nullptr || num_threads <= 0 || type == kTypeExternal ||
+      type == kTypeNested) {
+    return nullptr;
+  }
   std::unique_ptr<WorkerThread*[]> threads(new (std::nothrow)
                                                WorkerThread*[num_threads]);
   if (threads == nullptr) return nullptr;
   std::unique_ptr<ThreadPool> pool(new (std::nothrow) ThreadPool(
-      name_prefix, std::move(threads), num_threads));
+      name_prefix, std::move(threads), num_threads, type));
+  if (pool != nullptr) pool->affinity_ = affinity;
   if (pool != nullptr && !pool->StartWorkers()) {
     pool = nullptr;
   }
   return pool;
 }
 
+// static
+std::unique_ptr<ThreadPool> ThreadPool::CreateExternal(
+    const ExternalScheduler& scheduler, int num_threads) {
+  if (scheduler.schedule_job == nullptr || num_threads <= 0) return nullptr;
+  // No worker threads are created, but |threads_| must have an entry for the
+  // terminating null pointer.
+  std::unique_ptr<WorkerThread*[]> threads(new (std::nothrow) WorkerThread*[1]);
+  if (threads == nullptr) return nullptr;
+  std::unique_ptr<ThreadPool> pool(new (std::nothrow) ThreadPool(
+      /*name_prefix=*/"", std::move(threads), num_threads, kTypeExternal));
+  if (pool != nullptr) pool->external_scheduler_ = scheduler;
+  return pool;
+}
+
+// static
+std::unique_ptr<ThreadPool> ThreadPool::CreateNested(ThreadPool* parent) {
+  if (parent == nullptr) return nullptr;
+  // No worker threads are created, but |threads_| must have an entry for the
+  // terminating null pointer.
+  std::unique_ptr<WorkerThread*[]> threads(new (std::nothrow) WorkerThread*[1]);
+  if (threads == nullptr) return nullptr;
+  std::unique_ptr<ThreadPool> pool(new (std::nothrow) ThreadPool(
+      /*name_prefix=*/"", std::move(threads), parent->num_threads(),
+      kTypeNested));
+  if (pool == nullptr || !pool->queue_.Init()) return nullptr;
+  pool->parent_ = parent;
+  std::lock_guard<std::mutex> lock(parent->nested_pools_mutex_);
+  pool->next_nested_pool_ = parent->nested_pools_;
+  parent->nested_pools_ = pool.get();
+  return pool;
+}
+
 ThreadPool::ThreadPool(const char name_prefix[],
                        std::unique_ptr<WorkerThread*[]> threads,
-                       int num_threads)
-    : threads_(std::move(threads)), num_threads_(num_threads) {
+                       int num_threads, Type type)
+    : threads_(std::move(threads)), num_threads_(num_threads), type_(type) {
   threads_[0] = nullptr;
   assert(name_prefix != nullptr);
   const size_t name_prefix_len =
@@ -100,7 +185,19 @@ ThreadPool::ThreadPool(const char name_prefix[],
 
 ThreadPool::~ThreadPool() { Shutdown(); }
 
-void ThreadPool::Schedule(std::function<void()> closure) {
+void ThreadPool::Schedule(Task closure) {
+  if (type_ == kTypeWorkStealing) {
+    ScheduleWorkStealing(std::move(closure));
+    return;
+  }
+  if (type_ == kTypeExternal) {
+    ScheduleExternal(std::move(closure));
+    return;
+  }
+  if (type_ == kTypeNested) {
+    ScheduleNested(std::move(closure));
+    return;
+  }
   LockMutex();
   if (!queue_.GrowIfNeeded()) {
     // queue_ is full and we can't grow it. Run |closure| directly.
@@ -113,6 +210,194 @@ void ThreadPool::Schedule(std::function<void()> closure) {
   SignalOne();
 }
 
+void ThreadPool::ScheduleWorkStealing(Task closure) {
+  // Jobs scheduled by a worker go to its own queue. Jobs scheduled from other
+  // threads are distributed round-robin.
+  int index = current_worker_index;
+  if (current_pool != this) {
+    const uint32_t next = next_queue_.fetch_add(1, std::memory_order_relaxed);
+    index = static_cast<int>(next % static_cast<uint32_t>(num_threads_));
+  }
+  WorkerQueue& queue = worker_queues_[index];
+  queue.mutex.lock();
+  if (!queue.jobs.GrowIfNeeded()) {
+    // The queue is full and we can't grow it. Run |closure| directly.
+    queue.mutex.unlock();
+    closure();
+    return;
+  }
+  queue.jobs.Push(std::move(closure));
+  queue.mutex.unlock();
+  // This increment and the load of |num_sleeping_| pair with the increment of
+  // |num_sleeping_| and the load of |pending_jobs_| in the worker (both are
+  // sequentially consistent), so either the parking worker sees the job or
+  // this thread sees the parking worker.
+  pending_jobs_.fetch_add(1);
+  if (num_sleeping_.load() > 0) {
+    LockMutex();
+    UnlockMutex();
+    SignalOne();
+  }
+}
+
+void ThreadPool::ScheduleExternal(Task closure) {
+  LockMutex();
+  ExternalJob* job = free_external_jobs_;
+  if (job != nullptr) {
+    free_external_jobs_ = job->next;
+  } else {
+    job = new (std::nothrow) ExternalJob;
+    if (job == nullptr) {
+      // Run |closure| directly, as when a job queue cannot grow.
+      UnlockMutex();
+      closure();
+      return;
+    }
+    job->pool = this;
+  }
+  ++pending_external_jobs_;
+  UnlockMutex();
+  job->task = std::move(closure);
+  external_scheduler_.schedule_job(external_scheduler_.private_data,
+                                   RunExternalJob, job);
+}
+
+// static
+void ThreadPool::RunExternalJob(void* job) {
+  auto* const external_job = static_cast<ExternalJob*>(job);
+  ThreadPool* const pool = external_job->pool;
+  external_job->task();
+  external_job->task = nullptr;
+  pool->LockMutex();
+  external_job->next = pool->free_external_jobs_;
+  pool->free_external_jobs_ = external_job;
+  if (--pool->pending_external_jobs_ == 0) pool->SignalAll();
+  // |pool| may be destroyed as soon as the mutex is released.
+  pool->UnlockMutex();
+}
+
+void ThreadPool::ShutdownExternal() {
+  LockMutex();
+  exit_threads_ = true;
+  while (pending_external_jobs_ != 0) Wait();
+  ExternalJob* job = free_external_jobs_;
+  free_external_jobs_ = nullptr;
+  UnlockMutex();
+  while (job != nullptr) {
+    ExternalJob* const next = job->next;
+    delete job;
+    job = next;
+  }
+}
+
+void ThreadPool::ScheduleNested(Task closure) {
+  LockMutex();
+  if (!queue_.GrowIfNeeded()) {
+    // queue_ is full and we can't grow it. Run |closure| directly.
+    UnlockMutex();
+    closure();
+    return;
+  }
+  queue_.Push(std::move(closure));
+  ++unfinished_nested_jobs_;
+  nested_generation_.fetch_add(1, std::memory_order_release);
+  UnlockMutex();
+  SignalAll();
+  // There is one job on |parent_| for each queued job, but it does not
+  // necessarily run the job of this pool.
+  ThreadPool* const parent = parent_;
+  parent->Schedule([parent]() { parent->RunHighestPriorityNestedJob(); });
+}
+
+void ThreadPool::RunNestedJob(Task job) {
+  std::move(job)();
+  job = nullptr;
+  LockMutex();
+  --unfinished_nested_jobs_;
+  nested_generation_.fetch_add(1, std::memory_order_release);
+  SignalAll();
+  // ShutdownNested() may return as soon as the mutex is released.
+  UnlockMutex();
+}
+
+void ThreadPool::RunHighestPriorityNestedJob() {
+  ThreadPool* pool = nullptr;
+  Task job;
+  {
+    std::lock_guard<std::mutex> lock(nested_pools_mutex_);
+    int64_t best_priority = 0;
+    for (ThreadPool* nested_pool = nested_pools_; nested_pool != nullptr;
+         nested_pool = nested_pool->next_nested_pool_) {
+      const int64_t priority = nested_pool->priority();
+      if (pool != nullptr && priority >= best_priority) continue;
+      nested_pool->LockMutex();
+      const bool has_jobs = !nested_pool->queue_.Empty();
+      nested_pool->UnlockMutex();
+      if (has_jobs) {
+        pool = nested_pool;
+        best_priority = priority;
+      }
+    }
+    if (pool == nullptr) return;
+    pool->LockMutex();
+    // The job may have been run by RunJobsUntil() in the meantime.
+    if (!pool->queue_.Empty()) {
+      job = std::move(pool->queue_.Front());
+      pool->queue_.Pop();
+    }
+    pool->UnlockMutex();
+  }
+  // |pool| is not destroyed before the job finishes since its
+  // |unfinished_nested_jobs_| is not 0.
+  if (job) pool->RunNestedJob(std::move(job));
+}
+
+void ThreadPool::RunNestedJobOrWait(uint32_t generation) {
+  LockMutex();
+  if (!queue_.Empty()) {
+    Task job = std::move(queue_.Front());
+    queue_.Pop();
+    UnlockMutex();
+    RunNestedJob(std::move(job));
+    return;
+  }
+  while (nested_generation_.load(std::memory_order_relaxed) == generation) {
+    Wait();
+  }
+  UnlockMutex();
+}
+
+void ThreadPool::RunJobsUntilIdle() {
+  RunJobsUntil([this]() {
+    LockMutex();
+    const bool idle = unfinished_nested_jobs_ == 0;
+    UnlockMutex();
+    return idle;
+  });
+}
+
+void ThreadPool::ShutdownNested() {
+  LockMutex();
+  exit_threads_ = true;
+  while (!queue_.Empty()) {
+    Task job = std::move(queue_.Front());
+    queue_.Pop();
+    UnlockMutex();
+    std::move(job)();
+    job = nullptr;
+    LockMutex();
+    --unfinished_nested_jobs_;
+  }
+  // Wait until the jobs run by the threads of |parent_| have finished.
+  while (unfinished_nested_jobs_ != 0) Wait();
+  UnlockMutex();
+  if (parent_ == nullptr) return;
+  std::lock_guard<std::mutex> lock(parent_->nested_pools_mutex_);
+  ThreadPool** link = &parent_->nested_pools_;
+  while (*link != this) link = &(*link)->next_nested_pool_;
+  *link = next_nested_pool_;
+}
+
 int ThreadPool::num_threads() const { return num_threads_; }
 
 // A simple implementation that mirrors the non-portable Thread.  We may
@@ -121,7 +406,7 @@ int ThreadPool::num_threads() const { return num_threads_; }
 class ThreadPool::WorkerThread : public Allocable {
  public:
   // Creates and starts a thread that runs pool->WorkerFunction().
-  explicit WorkerThread(ThreadPool* pool);
+  WorkerThread(ThreadPool* pool, int index);
 
   // Not copyable or movable.
   WorkerThread(const WorkerThread&) = delete;
@@ -147,6 +432,7 @@ class ThreadPool::WorkerThread : public Allocable {
   void Run();
 
   ThreadPool* pool_;
+  const int index_;
 #if defined(_MSC_VER)
   HANDLE handle_;
 #else
@@ -154,7 +440,8 @@ class ThreadPool::WorkerThread : public Allocable {
 #endif
 };
 
-ThreadPool::WorkerThread::WorkerThread(ThreadPool* pool) : pool_(pool) {}
+ThreadPool::WorkerThread::WorkerThread(ThreadPool* pool, int index)
+    : pool_(pool), index_(index) {}
 
 #if defined(_MSC_VER)
 
@@ -235,13 +522,26 @@ void ThreadPool::WorkerThread::SetupName() {
 
 void ThreadPool::WorkerThread::Run() {
   SetupName();
+  if (pool_->affinity_ != nullptr) pool_->affinity_->PinWorker();
+  if (pool_->type_ == kTypeWorkStealing) {
+    pool_->WorkStealingWorkerFunction(index_);
+    return;
+  }
   pool_->WorkerFunction();
 }
 
 bool ThreadPool::StartWorkers() {
-  if (!queue_.Init()) return false;
+  if (type_ == kTypeWorkStealing) {
+    worker_queues_.reset(new (std::nothrow) WorkerQueue[num_threads_]);
+    if (worker_queues_ == nullptr) return false;
+    for (int i = 0; i < num_threads_; ++i) {
+      if (!worker_queues_[i].jobs.Init()) return false;
+    }
+  } else if (!queue_.Init()) {
+    return false;
+  }
   for (int i = 0; i < num_threads_; ++i) {
-    threads_[i] = new (std::nothrow) WorkerThread(this);
+    threads_[i] = new (std::nothrow) WorkerThread(this, i);
     if (threads_[i] == nullptr) return false;
     if (!threads_[i]->Start()) {
       delete threads_[i];
@@ -293,7 +593,7 @@ void ThreadPool::WorkerFunction() {
       Wait();
     } else {
       // Take a job from the queue.
-      std::function<void()> job = std::move(queue_.Front());
+      Task job = std::move(queue_.Front());
       queue_.Pop();
 
       UnlockMutex();
@@ -309,7 +609,83 @@ void ThreadPool::WorkerFunction() {
   UnlockMutex();
 }
 
+bool ThreadPool::TakeJob(int worker_index, uint32_t* random_state, Task* job) {
+  if (pending_jobs_.load(std::memory_order_acquire) == 0) return false;
+  // Both the owner and the thieves take the oldest job of a queue. Jobs
+  // scheduled by the decoder may wait for jobs that were scheduled before them
+  // (e.g. frame jobs in frame parallel mode), so the FIFO order is kept.
+  const int start = (num_threads_ == 1)
+                        ? 0
+                        : static_cast<int>(NextRandom(random_state) %
+                                           static_cast<uint32_t>(num_threads_));
+  for (int i = -1; i < num_threads_; ++i) {
+    int victim;
+    if (i < 0) {
+      victim = worker_index;
+    } else {
+      victim = start + i;
+      if (victim >= num_threads_) victim -= num_threads_;
+      if (victim == worker_index) continue;
+    }
+    WorkerQueue& queue = worker_queues_[victim];
+    queue.mutex.lock();
+    if (!queue.jobs.Empty()) {
+      *job = std::move(queue.jobs.Front());
+      queue.jobs.Pop();
+      queue.mutex.unlock();
+      pending_jobs_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+    queue.mutex.unlock();
+  }
+  return false;
+}
+
+void ThreadPool::WorkStealingWorkerFunction(int worker_index) {
+  current_pool = this;
+  current_worker_index = worker_index;
+  uint32_t random_state = static_cast<uint32_t>(worker_index) * 0x9e3779b9U + 1;
+  Task job;
+  int spin_count = 0;
+  while (true) {
+    if (TakeJob(worker_index, &random_state, &job)) {
+      std::move(job)();
+      job = nullptr;
+      spin_count = 0;
+      continue;
+    }
+    if (spin_count < kWorkStealingSpinCount) {
+      ++spin_count;
+      std::this_thread::yield();
+      continue;
+    }
+    spin_count = 0;
+    LockMutex();
+    num_sleeping_.fetch_add(1);
+    if (pending_jobs_.load() == 0) {
+      if (exit_threads_) {
+        num_sleeping_.fetch_sub(1);
+        UnlockMutex();
+        break;  // All queues are empty and exit was requested.
+      }
+      Wait();
+    }
+    num_sleeping_.fetch_sub(1);
+    UnlockMutex();
+  }
+  current_pool = nullptr;
+  current_worker_index = -1;
+}
+
 void ThreadPool::Shutdown() {
+  if (type_ == kTypeExternal) {
+    ShutdownExternal();
+    return;
+  }
+  if (type_ == kTypeNested) {
+    ShutdownNested();
+    return;
+  }
   // Tell worker threads how to exit.
   LockMutex();
   exit_threads_ = true;
@@ -17,8 +17,10 @@
 #ifndef LIBGAV1_SRC_UTILS_THREADPOOL_H_
 #define LIBGAV1_SRC_UTILS_THREADPOOL_H_
 
-#include <functional>
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <mutex>  // NOLINT (unapproved c++11 header)
 
 #if defined(__APPLE__)
 #include <TargetConditionals.h>
@@ -34,7 +36,6 @@
 
 #if LIBGAV1_THREADPOOL_USE_STD_MUTEX
 #include <condition_variable>  // NOLINT (unapproved c++11 header)
-#include <mutex>               // NOLINT (unapproved c++11 header)
 #else
 // absl::Mutex & absl::CondVar are significantly faster than the pthread
 // variants on platforms other than Android. iOS may deadlock on Shutdown()
@@ -44,18 +45,40 @@
 #endif
 
 #include "src/utils/compiler_attributes.h"
+#include "src/utils/cpu_affinity.h"
 #include "src/utils/executor.h"
 #include "src/utils/memory.h"
 #include "src/utils/unbounded_queue.h"
 
 namespace libgav1 {
 
+// A job scheduler owned by the application (see the schedule_job field of
+// DecoderSettings). |schedule_job| must arrange for |run_job|(|job|) to be
+// called exactly once, on any thread.
+struct ExternalScheduler {
+  using RunJobFunction = void (*)(void* job);
+  using ScheduleJobFunction = void (*)(void* private_data,
+                                       RunJobFunction run_job, void* job);
+
+  ScheduleJobFunction schedule_job = nullptr;
+  void* private_data = nullptr;
+};
+
 // An implementation of ThreadPool using POSIX threads (pthreads) or Windows
 // threads.
 //
 // - The pool allocates a fixed number of worker threads on instantiation.
 // - The worker threads will pick up work jobs as they arrive.
 // - If all workers are busy, work jobs are queued for later execution.
+// - With kTypeSharedQueue all jobs go through one mutex-guarded queue. With
+//   kTypeWorkStealing every worker owns a queue, idle workers steal from
+//   randomly chosen victims and park after a short spin.
+// - With kTypeExternal the pool creates no threads and forwards all the jobs
+//   to an ExternalScheduler.
+// - With kTypeNested the pool creates no threads either. Its jobs run on the
+//   threads of a parent pool, which may be shared by several nested pools, and
+//   on the threads waiting for them in RunJobsUntil(). The parent runs the
+//   queued jobs of the nested pool with the highest priority first.
 //
 // The thread pool is shut down when the pool is destroyed.
 //
@@ -68,6 +91,18 @@ namespace libgav1 {
 //   } // ThreadPool gets destroyed only when all jobs are done.
 class ThreadPool : public Executor, public Allocable {
  public:
+  enum Type : uint8_t {
+    // A single job queue shared by all the workers.
+    kTypeSharedQueue,
+    // Per-worker job queues with randomized stealing. Reduces lock contention
+    // when many threads schedule and run short jobs.
+    kTypeWorkStealing,
+    // Jobs are run by an ExternalScheduler. See CreateExternal().
+    kTypeExternal,
+    // Jobs are run by a parent pool. See CreateNested().
+    kTypeNested
+  };
+
   // Creates the thread pool with the specified number of worker threads.
   // If num_threads is 1, the closures are run in FIFO order.
   static std::unique_ptr<ThreadPool> Create(int num_threads);
@@ -76,6 +111,33 @@ class ThreadPool : public Executor, public Allocable {
   static std::unique_ptr<ThreadPool> Create(const char name_prefix[],
                                             int num_threads);
 
+  // Like the above factory method, but also selects the implementation type.
+  // |type| must not be kTypeExternal.
+  static std::unique_ptr<ThreadPool> Create(const char name_prefix[],
+                                            int num_threads, Type type);
+
+  // Like the above factory method, but also pins the worker threads according
+  // to |affinity| if it is not nullptr. Pinning failures are ignored.
+  // |*affinity| must outlive the thread pool.
+  static std::unique_ptr<ThreadPool> Create(const char name_prefix[],
+                                            int num_threads, Type type,
+                                            const CpuAffinity* affinity);
+
+  // Creates a pool of type kTypeExternal that runs its jobs through
+  // |scheduler|. |num_threads| is the number of jobs the scheduler is expected
+  // to run concurrently; it is only reported by num_threads() and used by the
+  // callers to split the work. The destructor waits until all the scheduled
+  // jobs have run.
+  static std::unique_ptr<ThreadPool> CreateExternal(
+      const ExternalScheduler& scheduler, int num_threads);
+
+  // Creates a pool of type kTypeNested whose jobs are run by the threads of
+  // |parent|, and by the threads calling RunJobsUntil(). num_threads() returns
+  // the number of threads of |parent|. The destructor runs the jobs which are
+  // still queued and waits until the running jobs have finished. |*parent|
+  // must outlive the returned pool.
+  static std::unique_ptr<ThreadPool> CreateNested(ThreadPool* parent);
+
   // The destructor will shut down the thread pool and all jobs are executed.
   // Note that after shutdown, the thread pool does not accept further jobs.
   ~ThreadPool() override;
@@ -90,23 +152,92 @@ class ThreadPool : public Executor, public Allocable {
   // alternatives:
   //   1. Return a failure status.
   //   2. Have the current thread wait until the queue is not full.
-  void Schedule(std::function<void()> closure) override;
+  void Schedule(Task closure) override;
 
   int num_threads() const;
+  Type type() const { return type_; }
+  // The parent pool of a kTypeNested pool, nullptr for the other types.
+  const ThreadPool* parent() const { return parent_; }
+
+  // The priority of the jobs of a kTypeNested pool. When a thread of the
+  // parent pool becomes free, it runs the oldest queued job of the nested pool
+  // with the lowest |priority| value. The decoder uses the decode order of the
+  // frames, so that the jobs of the oldest frame run first. Defaults to 0. May
+  // be changed at any time; the jobs which are already queued get the new
+  // priority.
+  void set_priority(int64_t priority) {
+    priority_.store(priority, std::memory_order_relaxed);
+  }
+  int64_t priority() const { return priority_.load(std::memory_order_relaxed); }
+
+  // For kTypeNested pools, runs the queued jobs of this pool on the calling
+  // thread until |done|() returns true. This lets a thread which waits for the
+  // jobs it scheduled make progress even if all the threads of the parent pool
+  // are busy or blocked. |done| is evaluated again whenever a job is scheduled
+  // on this pool or finishes, so it must only become true as a result of the
+  // jobs of this pool. Does nothing for the other types.
+  template <typename Predicate>
+  void RunJobsUntil(Predicate done) {
+    if (type_ != kTypeNested) return;
+    while (true) {
+      const uint32_t generation =
+          nested_generation_.load(std::memory_order_acquire);
+      if (done()) return;
+      RunNestedJobOrWait(generation);
+    }
+  }
+
+  // For kTypeNested pools, runs the queued jobs of this pool on the calling
+  // thread until all the jobs scheduled on this pool have finished. Does
+  // nothing for the other types.
+  void RunJobsUntilIdle();
 
  private:
   class WorkerThread;
+  struct WorkerQueue;
+  struct ExternalJob;
 
   // Creates the thread pool with the specified number of worker threads.
   // If num_threads is 1, the closures are run in FIFO order.
   ThreadPool(const char name_prefix[], std::unique_ptr<WorkerThread*[]> threads,
-             int num_threads);
+             int num_threads, Type type);
 
   // Starts the worker pool.
   LIBGAV1_MUST_USE_RESULT bool StartWorkers();
 
   void WorkerFunction();
 
+  // Work-stealing counterparts of Schedule() and WorkerFunction().
+  void ScheduleWorkStealing(Task closure);
+  void WorkStealingWorkerFunction(int worker_index);
+  // Pops the oldest job from the queue of |worker_index|, or failing that,
+  // steals the oldest job of another worker. Returns false if no job was
+  // found.
+  bool TakeJob(int worker_index, uint32_t* random_state, Task* job);
+
+  // kTypeExternal counterparts of Schedule() and Shutdown().
+  void ScheduleExternal(Task closure);
+  void ShutdownExternal();
+  // The RunJobFunction passed to |external_scheduler_|.
+  static void RunExternalJob(void* job);
+
+  // kTypeNested counterparts of Schedule() and Shutdown().
+  void ScheduleNested(Task closure);
+  void ShutdownNested();
+  // Runs |job|, which was popped from |queue_|, and wakes up the threads in
+  // RunJobsUntil(). This pool may be destroyed as soon as the function
+  // returns.
+  void RunNestedJob(Task job);
+  // Runs the oldest queued job, or if there is none, waits until a job is
+  // scheduled or finishes, unless that already happened after
+  // |nested_generation_| was |generation|.
+  void RunNestedJobOrWait(uint32_t generation);
+  // The job scheduled on a parent pool for each job of its nested pools. Runs
+  // the oldest queued job of the nested pool with the highest priority, if
+  // there is one. Nested pools may run their own jobs in RunJobsUntil(), so
+  // the job may find nothing to do.
+  void RunHighestPriorityNestedJob();
+
   // Shuts down the thread pool, i.e. worker threads finish their work and
   // pick up new jobs until the queue is empty. This call will block until
   // the shutdown is complete.
@@ -147,13 +278,53 @@ class ThreadPool : public Executor, public Allocable {
 
 #endif  // LIBGAV1_THREADPOOL_USE_STD_MUTEX
 
-  UnboundedQueue<std::function<void()>> queue_ LIBGAV1_GUARDED_BY(queue_mutex_);
+  UnboundedQueue<Task> queue_ LIBGAV1_GUARDED_BY(queue_mutex_);
   // If not all the worker threads are created, the first entry after the
   // created worker threads is a null pointer.
   const std::unique_ptr<WorkerThread*[]> threads_;
 
   bool exit_threads_ LIBGAV1_GUARDED_BY(queue_mutex_) = false;
   const int num_threads_ = 0;
+  const Type type_;
+  const CpuAffinity* affinity_ = nullptr;
+
+  // The following members are only used by kTypeWorkStealing. The job queues
+  // are guarded by their own mutexes; |queue_mutex_| and |condition_| are only
+  // used to park and wake up idle workers.
+  std::unique_ptr<WorkerQueue[]> worker_queues_;
+  // The number of jobs that have been scheduled but not yet taken by a worker.
+  std::atomic<int> pending_jobs_{0};
+  // The number of workers waiting on |condition_|.
+  std::atomic<int> num_sleeping_{0};
+  // Used to distribute jobs scheduled from outside the pool.
+  std::atomic<uint32_t> next_queue_{0};
+
+  // The following members are only used by kTypeExternal.
+  ExternalScheduler external_scheduler_;
+  // Job nodes which are not in use. They are reused so that scheduling does
+  // not allocate in steady state.
+  ExternalJob* free_external_jobs_ LIBGAV1_GUARDED_BY(queue_mutex_) = nullptr;
+  // The number of jobs passed to |external_scheduler_| that have not finished.
+  int pending_external_jobs_ LIBGAV1_GUARDED_BY(queue_mutex_) = 0;
+
+  // The following members are only used by kTypeNested. The jobs are queued in
+  // |queue_|.
+  ThreadPool* parent_ = nullptr;
+  std::atomic<int64_t> priority_{0};
+  // Incremented whenever a job is scheduled or finishes. Only modified while
+  // holding |queue_mutex_|.
+  std::atomic<uint32_t> nested_generation_{0};
+  // The number of jobs scheduled on this pool that have not finished.
+  int unfinished_nested_jobs_ LIBGAV1_GUARDED_BY(queue_mutex_) = 0;
+  // The next pool in the list of nested pools of |parent_|, guarded by
+  // parent_->nested_pools_mutex_.
+  ThreadPool* next_nested_pool_ = nullptr;
+
+  // The nested pools whose parent is this pool. The mutex is acquired before
+  // the |queue_mutex_| of the nested pools.
+  std::mutex nested_pools_mutex_;
+  ThreadPool* nested_pools_ LIBGAV1_GUARDED_BY(nested_pools_mutex_) = nullptr;
+
   // name_prefix_ is a C string, whose length is restricted to 16 characters,
   // including the terminating null byte ('\0'). This restriction comes from
   // the Linux pthread_setname_np() function.
@@ -14,16 +14,21 @@
 
 #include "src/utils/threadpool.h"
 
+#include <atomic>
 #include <cassert>
 #include <cstdint>
+#include <cstdio>
 #include <memory>
+#include <vector>
 
 #include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "gtest/gtest.h"
+#include "src/utils/blocking_counter.h"
 #include "src/utils/compiler_attributes.h"
 #include "src/utils/executor.h"
+#include "tests/allocation_counter.h"
 
 namespace libgav1 {
 namespace {
@@ -129,5 +134,265 @@ TEST(ThreadPoolTest, OneThreadRunsClosuresFIFO) {
   }
 }
 
+class ThreadPoolTypeTest : public testing::TestWithParam<ThreadPool::Type> {
+ protected:
+  const ThreadPool::Type type_ = GetParam();
+};
+
+TEST_P(ThreadPoolTypeTest, ThreadedIntegerIncrement) {
+  std::unique_ptr<ThreadPool> thread_pool =
+      ThreadPool::Create("test", 16, type_);
+  ASSERT_NE(thread_pool, nullptr);
+  EXPECT_EQ(thread_pool->num_threads(), 16);
+  EXPECT_EQ(thread_pool->type(), type_);
+  std::atomic<int> count(0);
+  for (int i = 0; i < 10000; ++i) {
+    thread_pool->Schedule([&count]() { ++count; });
+  }
+  thread_pool.reset(nullptr);
+  EXPECT_EQ(count.load(), 10000);
+}
+
+TEST_P(ThreadPoolTypeTest, OneThreadRunsClosuresFIFO) {
+  int count = 0;  // Declare first so that it outlives the thread pool.
+  std::unique_ptr<ThreadPool> pool = ThreadPool::Create("test", 1, type_);
+  ASSERT_NE(pool, nullptr);
+  for (int i = 0; i < 1000; ++i) {
+    pool->Schedule([&count, i]() {
+      EXPECT_EQ(count, i);
+      count++;
+    });
+  }
+}
+
+// Jobs that schedule more jobs, like the superblock row jobs of the decoder.
+void ScheduleTree(ThreadPool* pool, int depth, std::atomic<int>* count,
+                  BlockingCounter* done) {
+  ++*count;
+  if (depth == 0) {
+    done->Decrement();
+    return;
+  }
+  for (int i = 0; i < 2; ++i) {
+    pool->Schedule([pool, depth, count, done]() {
+      ScheduleTree(pool, depth - 1, count, done);
+    });
+  }
+}
+
+TEST_P(ThreadPoolTypeTest, NestedSchedule) {
+  constexpr int kDepth = 12;
+  std::unique_ptr<ThreadPool> pool = ThreadPool::Create("test", 8, type_);
+  ASSERT_NE(pool, nullptr);
+  std::atomic<int> count(0);
+  BlockingCounter done(1 << kDepth);
+  ScheduleTree(pool.get(), kDepth, &count, &done);
+  done.Wait();
+  EXPECT_EQ(count.load(), (2 << kDepth) - 1);
+}
+
+// Many producers scheduling short jobs into a pool with many workers. This is
+// the pattern which makes the single shared queue contend.
+TEST_P(ThreadPoolTypeTest, DISABLED_ContentionSpeed) {
+  constexpr int kNumThreads = 32;
+  constexpr int kNumProducers = 8;
+  constexpr int kJobsPerProducer = 100000;
+  std::unique_ptr<ThreadPool> pool =
+      ThreadPool::Create("test", kNumThreads, type_);
+  ASSERT_NE(pool, nullptr);
+  std::unique_ptr<ThreadPool> producers =
+      ThreadPool::Create("producer", kNumProducers);
+  ASSERT_NE(producers, nullptr);
+  std::atomic<int> count(0);
+  const absl::Time start = absl::Now();
+  for (int i = 0; i < kNumProducers; ++i) {
+    producers->Schedule([&pool, &count]() {
+      for (int j = 0; j < kJobsPerProducer; ++j) {
+        pool->Schedule([&count]() { ++count; });
+      }
+    });
+  }
+  // Destroying the pools waits for all the jobs to finish.
+  producers.reset(nullptr);
+  pool.reset(nullptr);
+  const absl::Duration elapsed_time = absl::Now() - start;
+  EXPECT_EQ(count.load(), kNumProducers * kJobsPerProducer);
+  printf("Mode %s[%d threads]: %5d us\n",
+         (type_ == ThreadPool::kTypeWorkStealing) ? "WorkStealing"
+                                                  : "SharedQueue",
+         kNumThreads,
+         static_cast<int>(absl::ToInt64Microseconds(elapsed_time)));
+}
+
+// Once the job queues have grown to their working size, scheduling and running
+// jobs with captures like those of the decoder does not allocate.
+TEST_P(ThreadPoolTypeTest, ScheduleDoesNotAllocate) {
+  constexpr int kNumThreads = 8;
+  constexpr int kWarmUpJobs = 1000;
+  constexpr int kJobs = 64;
+  std::unique_ptr<ThreadPool> pool =
+      ThreadPool::Create("test", kNumThreads, type_);
+  ASSERT_NE(pool, nullptr);
+  std::atomic<int> sum(0);
+  const auto run_jobs = [&pool, &sum](int num_jobs) {
+    BlockingCounter pending_jobs(num_jobs);
+    const int a = 1;
+    const int b = 2;
+    const int c = 3;
+    const int* const p = &a;
+    for (int i = 0; i < num_jobs; ++i) {
+      // Similar to the superblock row jobs in DecoderImpl.
+      pool->Schedule([&sum, &pending_jobs, i, a, b, c, p]() {
+        sum += i + a + b + c + *p;
+        pending_jobs.Decrement();
+      });
+    }
+    pending_jobs.Wait();
+  };
+  run_jobs(kWarmUpJobs);
+  run_jobs(kWarmUpJobs);
+
+  test_utils::StartCountingAllocations();
+  for (int i = 0; i < 100; ++i) run_jobs(kJobs);
+  EXPECT_EQ(test_utils::StopCountingAllocations(), 0);
+}
+
+// Runs the jobs of a kTypeExternal pool on another ThreadPool.
+void ScheduleOnThreadPool(void* private_data,
+                          ExternalScheduler::RunJobFunction run_job,
+                          void* job) {
+  static_cast<ThreadPool*>(private_data)->Schedule([run_job, job]() {
+    run_job(job);
+  });
+}
+
+TEST(ThreadPoolTest, External) {
+  std::unique_ptr<ThreadPool> host_pool = ThreadPool::Create(4);
+  ASSERT_NE(host_pool, nullptr);
+  ExternalScheduler scheduler;
+  EXPECT_EQ(ThreadPool::CreateExternal(scheduler, 2), nullptr);
+  scheduler.schedule_job = ScheduleOnThreadPool;
+  scheduler.private_data = host_pool.get();
+  EXPECT_EQ(ThreadPool::Create("test", 2, ThreadPool::kTypeExternal), nullptr);
+  std::unique_ptr<ThreadPool> pool = ThreadPool::CreateExternal(scheduler, 2);
+  ASSERT_NE(pool, nullptr);
+  EXPECT_EQ(pool->num_threads(), 2);
+  EXPECT_EQ(pool->type(), ThreadPool::kTypeExternal);
+  std::atomic<int> count(0);
+  for (int i = 0; i < 1000; ++i) {
+    pool->Schedule([&count]() { ++count; });
+  }
+  // The destructor waits for the jobs running on |host_pool|.
+  pool.reset(nullptr);
+  EXPECT_EQ(count.load(), 1000);
+}
+
+TEST(ThreadPoolTest, Nested) {
+  std::unique_ptr<ThreadPool> parent = ThreadPool::Create(4);
+  ASSERT_NE(parent, nullptr);
+  EXPECT_EQ(ThreadPool::CreateNested(nullptr), nullptr);
+  EXPECT_EQ(ThreadPool::Create("test", 2, ThreadPool::kTypeNested), nullptr);
+  std::unique_ptr<ThreadPool> pools[2];
+  std::atomic<int> counts[2];
+  for (int i = 0; i < 2; ++i) {
+    pools[i] = ThreadPool::CreateNested(parent.get());
+    ASSERT_NE(pools[i], nullptr);
+    EXPECT_EQ(pools[i]->num_threads(), 4);
+    EXPECT_EQ(pools[i]->type(), ThreadPool::kTypeNested);
+    EXPECT_EQ(pools[i]->parent(), parent.get());
+    counts[i] = 0;
+  }
+  for (int j = 0; j < 1000; ++j) {
+    for (int i = 0; i < 2; ++i) {
+      std::atomic<int>* const count = &counts[i];
+      pools[i]->Schedule([count]() { ++*count; });
+    }
+  }
+  pools[0]->RunJobsUntilIdle();
+  EXPECT_EQ(counts[0].load(), 1000);
+  // The destructor waits for the jobs running on |parent|.
+  pools[1].reset(nullptr);
+  EXPECT_EQ(counts[1].load(), 1000);
+}
+
+TEST(ThreadPoolTest, NestedRunJobsUntilWithBlockedParent) {
+  // Declared first so that it outlives the job blocking |parent|.
+  BlockingCounter blocker(1);
+  std::unique_ptr<ThreadPool> parent = ThreadPool::Create(1);
+  ASSERT_NE(parent, nullptr);
+  std::unique_ptr<ThreadPool> pool = ThreadPool::CreateNested(parent.get());
+  ASSERT_NE(pool, nullptr);
+  // Block the only thread of |parent| until the jobs of |pool| have run.
+  parent->Schedule([&blocker]() { blocker.Wait(); });
+  std::atomic<int> count(0);
+  for (int i = 0; i < 100; ++i) {
+    pool->Schedule([&count]() { ++count; });
+  }
+  pool->RunJobsUntil([&count]() { return count.load() == 100; });
+  EXPECT_EQ(count.load(), 100);
+  blocker.Decrement();
+}
+
+TEST(ThreadPoolTest, NestedPriority) {
+  // Declared first so that they outlive the jobs running on |parent|.
+  BlockingCounter blocker(1);
+  BlockingCounter pending_jobs(20);
+  absl::Mutex mutex;
+  std::vector<int> order;
+  std::unique_ptr<ThreadPool> parent = ThreadPool::Create(1);
+  ASSERT_NE(parent, nullptr);
+  std::unique_ptr<ThreadPool> pools[2];
+  for (int i = 0; i < 2; ++i) {
+    pools[i] = ThreadPool::CreateNested(parent.get());
+    ASSERT_NE(pools[i], nullptr);
+    EXPECT_EQ(pools[i]->priority(), 0);
+  }
+  // The jobs of |pools[1]| are scheduled last but run first.
+  pools[0]->set_priority(2);
+  pools[1]->set_priority(1);
+  // Queue all the jobs before the thread of |parent| can run any of them.
+  parent->Schedule([&blocker]() { blocker.Wait(); });
+  for (int i = 0; i < 2; ++i) {
+    for (int j = 0; j < 10; ++j) {
+      pools[i]->Schedule([&mutex, &order, &pending_jobs, i]() {
+        {
+          absl::MutexLock lock(&mutex);
+          order.push_back(i);
+        }
+        pending_jobs.Decrement();
+      });
+    }
+  }
+  blocker.Decrement();
+  pending_jobs.Wait();
+  absl::MutexLock lock(&mutex);
+  ASSERT_EQ(order.size(), 20);
+  for (int j = 0; j < 20; ++j) {
+    EXPECT_EQ(order[j], (j < 10) ? 1 : 0) << "j: " << j;
+  }
+}
+
+TEST(TaskTest, MoveAndDestroy) {
+  std::shared_ptr<int> value = std::make_shared<int>(0);
+  Task task([value]() { ++*value; });
+  EXPECT_TRUE(static_cast<bool>(task));
+  EXPECT_EQ(value.use_count(), 2);
+  Task moved(std::move(task));
+  EXPECT_FALSE(static_cast<bool>(task));
+  EXPECT_EQ(value.use_count(), 2);
+  moved();
+  moved();
+  EXPECT_EQ(*value, 2);
+  task = std::move(moved);
+  EXPECT_EQ(value.use_count(), 2);
+  task = nullptr;
+  EXPECT_FALSE(static_cast<bool>(task));
+  EXPECT_EQ(value.use_count(), 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(ThreadPoolTypes, ThreadPoolTypeTest,
+                         testing::Values(ThreadPool::kTypeSharedQueue,
+                                         ThreadPool::kTypeWorkStealing));
+
 }  // namespace
 }  // namespace libgav1
@@ -156,12 +156,6 @@ struct BlockParameters : public Allocable {
   TransformSize uv_transform_size;
   InterpolationFilter interpolation_filter[2];
   ReferenceFrameType reference_frame[2];
-  // The index of this array is as follows:
-  //  0 - Y plane vertical filtering.
-  //  1 - Y plane horizontal filtering.
-  //  2 - U plane (both directions).
-  //  3 - V plane (both directions).
-  uint8_t deblock_filter_level[kFrameLfCount];
   CompoundMotionVector mv;
   // When |Tile::split_parse_and_decode_| is true, each block gets its own
   // instance of |prediction_parameters|. When it is false, all the blocks point
@@ -171,6 +165,28 @@ struct BlockParameters : public Allocable {
   std::unique_ptr<PredictionParameters> prediction_parameters;
 };
 
+// The fields of a block that are read by the deblocking filter. A copy is
+// stored for every 4x4 block of the frame in BlockParametersHolder so that the
+// filter can scan them linearly instead of following a BlockParameters pointer
+// for each edge.
+struct DeblockParameters {
+  // The index of this array is as follows:
+  //  0 - Y plane vertical filtering.
+  //  1 - Y plane horizontal filtering.
+  //  2 - U plane (both directions).
+  //  3 - V plane (both directions).
+  uint8_t filter_level[kFrameLfCount];
+  TransformSize uv_transform_size;
+  // True if the block is an inter block with |skip| set.
+  bool skip;
+  // The position of the 4x4 block relative to the top left 4x4 block of the
+  // block that contains it. The 4x4 block that is |n| rows above (columns to
+  // the left of) this one belongs to the same block if and only if
+  // |row_offset| (|column_offset|) is at least |n|.
+  uint8_t row_offset;
+  uint8_t column_offset;
+};
+
 // Used to store the left and top block parameters that are used for computing
 // the cdf context of the subsequent blocks.
 struct BlockCdfContext {
@@ -0,0 +1,69 @@
+// Copyright 2021 The libgav1 Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tests/allocation_counter.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<bool> count_allocations(false);
+std::atomic<int> num_allocations(0);
+
+void* CountedAllocate(size_t size) {
+  if (count_allocations.load(std::memory_order_relaxed)) ++num_allocations;
+  return malloc((size == 0) ? 1 : size);
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+  void* const p = CountedAllocate(size);
+  if (p == nullptr) abort();
+  return p;
+}
+void* operator new[](size_t size) {
+  void* const p = CountedAllocate(size);
+  if (p == nullptr) abort();
+  return p;
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return CountedAllocate(size);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return CountedAllocate(size);
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { free(p); }
+
+namespace libgav1 {
+namespace test_utils {
+
+void StartCountingAllocations() {
+  num_allocations = 0;
+  count_allocations = true;
+}
+
+int StopCountingAllocations() {
+  count_allocations = false;
+  return num_allocations.load();
+}
+
+}  // namespace test_utils
+}  // namespace libgav1
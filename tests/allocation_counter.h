@@ -0,0 +1,33 @@
+/*
+ * Copyright 2021 The libgav1 Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIBGAV1_TESTS_ALLOCATION_COUNTER_H_
+#define LIBGAV1_TESTS_ALLOCATION_COUNTER_H_
+
+namespace libgav1 {
+namespace test_utils {
+
+// allocation_counter.cc replaces the global operator new and operator delete.
+// Test binaries that link it can count the calls to operator new, from all
+// threads, between StartCountingAllocations() and StopCountingAllocations().
+// StopCountingAllocations() returns the number of calls.
+void StartCountingAllocations();
+int StopCountingAllocations();
+
+}  // namespace test_utils
+}  // namespace libgav1
+
+#endif  // LIBGAV1_TESTS_ALLOCATION_COUNTER_H_
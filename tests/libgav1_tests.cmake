@@ -55,6 +55,10 @@ if((CMAKE_CXX_COMPILER_ID
   return()
 endif()
 
+list(APPEND libgav1_tests_allocation_counter_sources
+            "${libgav1_root}/tests/allocation_counter.h"
+            "${libgav1_root}/tests/allocation_counter.cc")
+
 list(APPEND libgav1_tests_block_utils_sources
             "${libgav1_root}/tests/block_utils.h"
             "${libgav1_root}/tests/block_utils.cc")
@@ -87,6 +91,12 @@ list(APPEND libgav1_common_avx2_test_sources
             "${libgav1_source}/dsp/x86/common_avx2.inc"
             "${libgav1_source}/dsp/x86/common_avx2_test.cc"
             "${libgav1_source}/dsp/x86/common_sse4.inc")
+list(APPEND libgav1_common_avx512_test_sources
+            "${libgav1_source}/dsp/x86/common_avx2.inc"
+            "${libgav1_source}/dsp/x86/common_avx512.h"
+            "${libgav1_source}/dsp/x86/common_avx512.inc"
+            "${libgav1_source}/dsp/x86/common_avx512_test.cc"
+            "${libgav1_source}/dsp/x86/common_sse4.inc")
 list(APPEND libgav1_common_neon_test_sources
             "${libgav1_source}/dsp/arm/common_neon_test.cc")
 list(APPEND libgav1_common_sse4_test_sources
@@ -96,6 +106,8 @@ list(APPEND libgav1_common_sse4_test_sources
 list(APPEND libgav1_convolve_test_sources
             "${libgav1_source}/dsp/convolve_test.cc")
 list(APPEND libgav1_cpu_test_sources "${libgav1_source}/utils/cpu_test.cc")
+list(APPEND libgav1_cpu_affinity_test_sources
+            "${libgav1_source}/utils/cpu_affinity_test.cc")
 list(APPEND libgav1_c_decoder_test_sources "${libgav1_source}/c_decoder_test.c")
 list(APPEND libgav1_c_version_test_sources "${libgav1_source}/c_version_test.c")
 list(APPEND libgav1_decoder_test_sources "${libgav1_source}/decoder_test.cc")
@@ -147,6 +159,8 @@ list(APPEND libgav1_weight_mask_test_sources
             "${libgav1_source}/dsp/weight_mask_test.cc")
 list(
   APPEND libgav1_memory_test_sources "${libgav1_source}/utils/memory_test.cc")
+list(APPEND libgav1_memory_usage_test_sources
+            "${libgav1_source}/utils/memory_usage_test.cc")
 list(APPEND libgav1_obmc_test_sources "${libgav1_source}/dsp/obmc_test.cc")
 list(APPEND libgav1_obu_parser_test_sources
             "${libgav1_source}/obu_parser_test.cc")
@@ -261,6 +275,7 @@ macro(libgav1_add_tests_targets)
                          OBJLIB_DEPS
                          libgav1_utils
                          LIB_DEPS
+                         absl::time
                          ${libgav1_common_test_absl_deps}
                          libgav1_gtest
                          libgav1_gtest_main)
@@ -298,6 +313,24 @@ macro(libgav1_add_tests_targets)
                            libgav1_gtest_main)
   endif()
 
+  if(libgav1_have_avx512)
+    libgav1_add_executable(TEST
+                           NAME
+                           common_avx512_test
+                           SOURCES
+                           ${libgav1_common_avx512_test_sources}
+                           DEFINES
+                           ${libgav1_defines}
+                           INCLUDES
+                           ${libgav1_test_include_paths}
+                           OBJLIB_DEPS
+                           libgav1_utils
+                           LIB_DEPS
+                           ${libgav1_common_test_absl_deps}
+                           libgav1_gtest
+                           libgav1_gtest_main)
+  endif()
+
   if(libgav1_have_neon)
     libgav1_add_executable(TEST
                            NAME
@@ -364,6 +397,22 @@ macro(libgav1_add_tests_targets)
                          libgav1_gtest
                          libgav1_gtest_main)
 
+  libgav1_add_executable(TEST
+                         NAME
+                         cpu_affinity_test
+                         SOURCES
+                         ${libgav1_cpu_affinity_test_sources}
+                         DEFINES
+                         ${libgav1_defines}
+                         INCLUDES
+                         ${libgav1_test_include_paths}
+                         OBJLIB_DEPS
+                         libgav1_utils
+                         LIB_DEPS
+                         ${libgav1_common_test_absl_deps}
+                         libgav1_gtest
+                         libgav1_gtest_main)
+
   libgav1_add_executable(TEST
                          NAME
                          entropy_decoder_test
@@ -456,6 +505,19 @@ macro(libgav1_add_tests_targets)
                          libgav1_gtest
                          libgav1_gtest_main)
 
+  libgav1_add_executable(TEST
+                         NAME
+                         memory_usage_test
+                         SOURCES
+                         ${libgav1_memory_usage_test_sources}
+                         DEFINES
+                         ${libgav1_defines}
+                         INCLUDES
+                         ${libgav1_test_include_paths}
+                         LIB_DEPS
+                         libgav1_gtest
+                         libgav1_gtest_main)
+
   libgav1_add_executable(TEST
                          NAME
                          queue_test
@@ -549,6 +611,7 @@ macro(libgav1_add_tests_targets)
                          ${libgav1_test_include_paths}
                          OBJLIB_DEPS
                          libgav1_utils
+                         libgav1_tests_allocation_counter
                          LIB_DEPS
                          absl::synchronization
                          libgav1_gtest
@@ -621,6 +684,18 @@ macro(libgav1_add_tests_targets)
                          libgav1_gtest
                          libgav1_gtest_main)
 
+  libgav1_add_library(TEST
+                      NAME
+                      libgav1_tests_allocation_counter
+                      TYPE
+                      OBJECT
+                      SOURCES
+                      ${libgav1_tests_allocation_counter_sources}
+                      DEFINES
+                      ${libgav1_defines}
+                      INCLUDES
+                      ${libgav1_test_include_paths})
+
   libgav1_add_library(TEST
                       NAME
                       libgav1_tests_block_utils
@@ -681,6 +756,7 @@ macro(libgav1_add_tests_targets)
                          libgav1_dsp
                          libgav1_utils
                          LIB_DEPS
+                         absl::time
                          ${libgav1_common_test_absl_deps}
                          libgav1_gtest
                          libgav1_gtest_main)
@@ -761,6 +837,8 @@ macro(libgav1_add_tests_targets)
                          ${libgav1_defines}
                          INCLUDES
                          ${libgav1_test_include_paths}
+                         OBJLIB_DEPS
+                         libgav1_tests_allocation_counter
                          LIB_DEPS
                          ${libgav1_dependency}
                          ${libgav1_common_test_absl_deps}